@@ -21,6 +21,7 @@ class KnotCtlType(enum.IntEnum):
     DATA = 1
     EXTRA = 2
     BLOCK = 3
+    BIN = 4
 
 
 class KnotCtlDataIdx(enum.IntEnum):
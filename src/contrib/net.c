@@ -767,6 +767,26 @@ ssize_t net_stream_recv(int sock, uint8_t *buffer, size_t size, int timeout_ms)
 	return net_base_recv(sock, buffer, size, NULL, timeout_ms);
 }
 
+ssize_t net_stream_send_nowait(int sock, const uint8_t *buffer, size_t size)
+{
+	if (sock < 0 || buffer == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	for (;;) {
+		ssize_t ret = send(sock, buffer, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (ret >= 0) {
+			return ret;
+		} else if (errno == EINTR) {
+			continue;
+		} else if (io_should_wait(errno)) {
+			return 0;
+		} else {
+			return KNOT_ECONN;
+		}
+	}
+}
+
 /* -- DNS specific I/O ----------------------------------------------------- */
 
 ssize_t net_dns_tcp_send(int sock, const uint8_t *buffer, size_t size, int timeout_ms,
@@ -227,6 +227,14 @@ ssize_t net_stream_send(int sock, const uint8_t *buffer, size_t size, int timeou
  */
 ssize_t net_stream_recv(int sock, uint8_t *buffer, size_t size, int timeout_ms);
 
+/*!
+ * \brief Send as much data as possible on a SOCK_STREAM socket without waiting.
+ *
+ * \return Number of bytes sent (zero if the socket isn't writable)
+ *         or negative error code.
+ */
+ssize_t net_stream_send_nowait(int sock, const uint8_t *buffer, size_t size);
+
 /*!
  * \brief Send a DNS message on a TCP socket.
  *
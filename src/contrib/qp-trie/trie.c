@@ -475,6 +475,47 @@ trie_val_t* trie_get_try_wildcard(trie_t *tbl, const trie_key_t *key, uint32_t l
 	return trie_get_try(tbl, wild_key, wild_len);
 }
 
+/*! \brief Test if the leaf key is a prefix of the key; the first *matched bytes are known to be equal. */
+static bool key_is_prefix(const tkey_t *lkey, const trie_key_t *key, uint32_t len,
+                          uint32_t *matched)
+{
+	if (lkey->len > len)
+		return false;
+	assert(*matched <= lkey->len);
+	if (memcmp(lkey->chars + *matched, key + *matched, lkey->len - *matched) != 0)
+		return false;
+	*matched = lkey->len;
+	return true;
+}
+
+trie_val_t* trie_get_longest_prefix(trie_t *tbl, const trie_key_t *key, uint32_t len)
+{
+	assert(tbl);
+	if (!tbl->weight)
+		return NULL;
+	// Prefixes of the key on the path are the BMP_NOBYTE leaves, ordered by length.
+	// Once one of them doesn't match, no longer one can match either.
+	trie_val_t *found = NULL;
+	uint32_t matched = 0;
+	node_t *t = &tbl->root;
+	while (isbranch(t)) {
+		__builtin_prefetch(twigs(t));
+		if (hastwig(t, BMP_NOBYTE)) {
+			node_t *prefix = twig(t, 0);
+			if (!key_is_prefix(tkey(prefix), key, len, &matched))
+				return found;
+			found = tvalp(prefix);
+		}
+		bitmap_t b = twigbit(t, key, len);
+		if (!hastwig(t, b))
+			return found;
+		t = twig(t, twigoff(t, b));
+	}
+	if (key_is_prefix(tkey(t), key, len, &matched))
+		found = tvalp(t);
+	return found;
+}
+
 /*! \brief Delete leaf t with parent p; b is the bit for t under p.
  * Optionally return the deleted value via val.  The function can't fail. */
 static void del_found(trie_t *tbl, node_t *t, node_t *p, bitmap_t b, trie_val_t *val)
@@ -1000,6 +1041,40 @@ int trie_apply(trie_t *tbl, int (*f)(trie_val_t *, void *), void *d)
 	return apply_nodes(&tbl->root, f, d);
 }
 
+size_t trie_split(trie_t *tbl, trie_part_t **parts, size_t max_parts, size_t min_parts)
+{
+	assert(tbl && parts);
+	if (!tbl->weight || max_parts == 0)
+		return 0;
+	parts[0] = (trie_part_t *)&tbl->root;
+	size_t count = 1;
+	bool expanded = true;
+	while (count < min_parts && expanded) {
+		expanded = false;
+		// Expand one level; walk backwards so that new twigs aren't revisited.
+		for (size_t i = count; i-- > 0 && count < min_parts; ) {
+			node_t *t = (node_t *)parts[i];
+			if (!isbranch(t))
+				continue;
+			uint n = branch_weight(t);
+			if (count + n - 1 > max_parts)
+				continue;
+			memmove(parts + i + n, parts + i + 1, sizeof(*parts) * (count - i - 1));
+			for (uint j = 0; j < n; ++j)
+				parts[i + j] = (trie_part_t *)twig(t, j);
+			count += n - 1;
+			expanded = true;
+		}
+	}
+	return count;
+}
+
+int trie_part_apply(trie_part_t *part, int (*f)(trie_val_t *, void *), void *d)
+{
+	assert(part && f);
+	return apply_nodes((node_t *)part, f, d);
+}
+
 /* These are all thin wrappers around static Tns* functions. */
 trie_it_t* trie_it_begin(trie_t *tbl)
 {
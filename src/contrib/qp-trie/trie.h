@@ -30,6 +30,9 @@ typedef struct trie trie_t;
 /*! \brief Opaque type for holding a QP-trie iterator. */
 typedef struct trie_it trie_it_t;
 
+/*! \brief Opaque type for a subtree of a QP-trie, see trie_split(). */
+typedef struct trie_part trie_part_t;
+
 /*! \brief Callback for cloning trie values. */
 typedef trie_val_t (*trie_dup_cb)(const trie_val_t val, knot_mm_t *mm);
 
@@ -73,6 +76,18 @@ trie_val_t* trie_get_try(trie_t *tbl, const trie_key_t *key, uint32_t len);
  */
 trie_val_t* trie_get_try_wildcard(trie_t *tbl, const trie_key_t *key, uint32_t len);
 
+/*!
+ * \brief Search for the longest stored key which is a prefix of the given key.
+ *
+ * The search needs just a single descent in the trie. For keys in
+ * knot_dname_lf() format it returns the closest stored ancestor name.
+ *
+ * \note A label containing a zero byte can match a key ending within the label.
+ *
+ * \return Value of the longest prefix, NULL if there is none.
+ */
+trie_val_t* trie_get_longest_prefix(trie_t *tbl, const trie_key_t *key, uint32_t len);
+
 /*! \brief Search the trie, inserting NULL trie_val_t on failure. */
 trie_val_t* trie_get_ins(trie_t *tbl, const trie_key_t *key, uint32_t len);
 
@@ -95,6 +110,26 @@ int trie_get_leq(trie_t *tbl, const trie_key_t *key, uint32_t len, trie_val_t **
  */
 int trie_apply(trie_t *tbl, int (*f)(trie_val_t *, void *), void *d);
 
+/*!
+ * \brief Split the trie into disjoint subtrees covering all the elements.
+ *
+ * Branches are expanded level by level until there are at least \a min_parts
+ * subtrees, no more branches can be expanded, or another expansion would
+ * exceed \a max_parts.  The subtrees are stored in ascending key order.
+ *
+ * \note Any modification of the trie invalidates the parts, see trie_it_begin().
+ *
+ * \return Number of subtrees stored into \a parts.
+ */
+size_t trie_split(trie_t *tbl, trie_part_t **parts, size_t max_parts, size_t min_parts);
+
+/*!
+ * \brief Apply a function to every trie_val_t in a subtree, in order.
+ *
+ * \return KNOT_EOK if success or KNOT_E* if error.
+ */
+int trie_part_apply(trie_part_t *part, int (*f)(trie_val_t *, void *), void *d);
+
 /*!
  * \brief Remove an item, returning KNOT_EOK if succeeded or KNOT_ENOENT if not found.
  *
@@ -0,0 +1,278 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "contrib/stream_writer.h"
+#include "contrib/threads.h"
+#include "libknot/errcode.h"
+
+struct stream_writer {
+	int fd;
+	bool direct;           /*!< O_DIRECT is set on the file descriptor. */
+	size_t align;          /*!< Buffer alignment (page size). */
+
+	uint8_t *mem;          /*!< Backing storage of all buffers. */
+	size_t buf_size;
+	unsigned buf_count;
+	size_t *lens;          /*!< Data lengths of the submitted buffers. */
+
+	unsigned cur;          /*!< Buffer being filled by the producer. */
+	size_t cur_len;        /*!< Data length in the current buffer. */
+
+	pthread_mutex_t lock;
+	pthread_cond_t submitted;
+	pthread_cond_t released;
+	unsigned head;         /*!< Oldest submitted buffer. */
+	unsigned pending;      /*!< Number of submitted buffers not written yet. */
+	bool finishing;
+	int error;
+	uint64_t written;
+
+	pthread_t thread;
+};
+
+static uint8_t *buf_at(stream_writer_t *w, unsigned idx)
+{
+	return w->mem + (size_t)idx * w->buf_size;
+}
+
+static void direct_disable(stream_writer_t *w)
+{
+#ifdef O_DIRECT
+	if (w->direct) {
+		int flags = fcntl(w->fd, F_GETFL);
+		if (flags != -1) {
+			(void)fcntl(w->fd, F_SETFL, flags & ~O_DIRECT);
+		}
+		w->direct = false;
+	}
+#endif
+}
+
+static void direct_enable(stream_writer_t *w)
+{
+#ifdef O_DIRECT
+	int flags = fcntl(w->fd, F_GETFL);
+	if (flags != -1 && fcntl(w->fd, F_SETFL, flags | O_DIRECT) == 0) {
+		w->direct = true;
+	}
+#endif
+}
+
+static int write_all(stream_writer_t *w, struct iovec *iov, int iovcnt)
+{
+	while (iovcnt > 0) {
+		ssize_t ret = writev(w->fd, iov, iovcnt);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			} else if (errno == EINVAL && w->direct) {
+				// Unsupported by the file system.
+				direct_disable(w);
+				continue;
+			}
+			return knot_map_errno();
+		}
+		w->written += ret;
+
+		size_t done = ret;
+		while (iovcnt > 0 && done >= iov->iov_len) {
+			done -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0 && done > 0) {
+			iov->iov_base = (uint8_t *)iov->iov_base + done;
+			iov->iov_len -= done;
+			// The rest is no longer aligned.
+			direct_disable(w);
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static void *writer_thread(void *arg)
+{
+	stream_writer_t *w = arg;
+	struct iovec iov[w->buf_count];
+
+	pthread_mutex_lock(&w->lock);
+	while (true) {
+		while (w->pending == 0 && !w->finishing) {
+			pthread_cond_wait(&w->submitted, &w->lock);
+		}
+		if (w->pending == 0) {
+			break;
+		}
+
+		// Write all the submitted buffers at once.
+		unsigned count = w->pending;
+		bool aligned = true;
+		for (unsigned i = 0; i < count; i++) {
+			unsigned idx = (w->head + i) % w->buf_count;
+			iov[i].iov_base = buf_at(w, idx);
+			iov[i].iov_len = w->lens[idx];
+			aligned &= (iov[i].iov_len % w->align == 0);
+		}
+		int error = w->error;
+		pthread_mutex_unlock(&w->lock);
+
+		if (error == KNOT_EOK) {
+			if (!aligned) {
+				direct_disable(w);
+			}
+			error = write_all(w, iov, count);
+		}
+
+		pthread_mutex_lock(&w->lock);
+		w->error = error;
+		w->head = (w->head + count) % w->buf_count;
+		w->pending -= count;
+		pthread_cond_signal(&w->released);
+	}
+	pthread_mutex_unlock(&w->lock);
+
+	return NULL;
+}
+
+static int submit(stream_writer_t *w)
+{
+	pthread_mutex_lock(&w->lock);
+	w->lens[w->cur] = w->cur_len;
+	w->pending++;
+	pthread_cond_signal(&w->submitted);
+
+	// Wait for the next buffer in the ring to be written.
+	while (w->pending == w->buf_count) {
+		pthread_cond_wait(&w->released, &w->lock);
+	}
+	int ret = w->error;
+	pthread_mutex_unlock(&w->lock);
+
+	w->cur = (w->cur + 1) % w->buf_count;
+	w->cur_len = 0;
+
+	return ret;
+}
+
+stream_writer_t *stream_writer_new(int fd, size_t buf_size, unsigned buf_count,
+                                   bool direct)
+{
+	if (fd < 0 || buf_size == 0 || buf_count < 2) {
+		return NULL;
+	}
+
+	stream_writer_t *w = calloc(1, sizeof(*w));
+	if (w == NULL) {
+		return NULL;
+	}
+
+	long page = sysconf(_SC_PAGESIZE);
+	w->align = (page > 0) ? page : 4096;
+	w->fd = fd;
+	w->buf_size = (buf_size + w->align - 1) / w->align * w->align;
+	w->buf_count = buf_count;
+	w->lens = calloc(buf_count, sizeof(*w->lens));
+	if (w->lens == NULL ||
+	    posix_memalign((void **)&w->mem, w->align, w->buf_size * buf_count) != 0) {
+		free(w->lens);
+		free(w);
+		return NULL;
+	}
+
+	pthread_mutex_init(&w->lock, NULL);
+	pthread_cond_init(&w->submitted, NULL);
+	pthread_cond_init(&w->released, NULL);
+
+	if (direct) {
+		direct_enable(w);
+	}
+
+	if (thread_create_nosignal(&w->thread, writer_thread, w) != 0) {
+		direct_disable(w);
+		pthread_cond_destroy(&w->released);
+		pthread_cond_destroy(&w->submitted);
+		pthread_mutex_destroy(&w->lock);
+		free(w->mem);
+		free(w->lens);
+		free(w);
+		return NULL;
+	}
+
+	return w;
+}
+
+int stream_writer_write(stream_writer_t *w, const void *data, size_t len)
+{
+	if (w == NULL || (data == NULL && len > 0)) {
+		return KNOT_EINVAL;
+	}
+
+	const uint8_t *pos = data;
+	while (len > 0) {
+		size_t chunk = w->buf_size - w->cur_len;
+		if (chunk > len) {
+			chunk = len;
+		}
+		memcpy(buf_at(w, w->cur) + w->cur_len, pos, chunk);
+		w->cur_len += chunk;
+		pos += chunk;
+		len -= chunk;
+
+		if (w->cur_len == w->buf_size) {
+			int ret = submit(w);
+			if (ret != KNOT_EOK) {
+				return ret;
+			}
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+int stream_writer_finish(stream_writer_t *w, uint64_t *written)
+{
+	if (w == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	if (w->cur_len > 0) {
+		(void)submit(w);
+	}
+
+	pthread_mutex_lock(&w->lock);
+	w->finishing = true;
+	pthread_cond_signal(&w->submitted);
+	pthread_mutex_unlock(&w->lock);
+
+	pthread_join(w->thread, NULL);
+	assert(w->pending == 0);
+
+	// Leave the descriptor as it was given.
+	direct_disable(w);
+
+	int ret = w->error;
+	if (written != NULL) {
+		*written = w->written;
+	}
+
+	pthread_cond_destroy(&w->released);
+	pthread_cond_destroy(&w->submitted);
+	pthread_mutex_destroy(&w->lock);
+	free(w->mem);
+	free(w->lens);
+	free(w);
+
+	return ret;
+}
@@ -0,0 +1,58 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+/*!
+ * \brief Asynchronous buffered file writer.
+ *
+ * The producer copies data into large page-aligned buffers, full buffers are
+ * written by a background thread using writev(), so formatting and disk I/O
+ * overlap. If requested and supported, the file is written with O_DIRECT
+ * to avoid polluting the page cache; the unaligned tail is written normally.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*! \brief Default size of one buffer. */
+#define STREAM_WRITER_BUF_SIZE	(1024 * 1024)
+/*! \brief Default number of buffers. */
+#define STREAM_WRITER_BUF_COUNT	4
+
+typedef struct stream_writer stream_writer_t;
+
+/*!
+ * \brief Create a writer for the given file descriptor and start its thread.
+ *
+ * \param fd         File descriptor opened for writing (not closed by the writer).
+ * \param buf_size   Size of one buffer (rounded up to the page size).
+ * \param buf_count  Number of buffers (at least 2).
+ * \param direct     Try to bypass the page cache.
+ *
+ * \return Writer or NULL on error.
+ */
+stream_writer_t *stream_writer_new(int fd, size_t buf_size, unsigned buf_count,
+                                   bool direct);
+
+/*!
+ * \brief Append data to the stream.
+ *
+ * Blocks only if all buffers are waiting to be written.
+ *
+ * \return KNOT_EOK, or an error of a preceding write.
+ */
+int stream_writer_write(stream_writer_t *w, const void *data, size_t len);
+
+/*!
+ * \brief Write all pending data, stop the thread, and free the writer.
+ *
+ * \param w        Writer.
+ * \param written  Optional output of the total number of bytes written.
+ *
+ * \return KNOT_E*
+ */
+int stream_writer_finish(stream_writer_t *w, uint64_t *written);
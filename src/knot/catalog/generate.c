@@ -62,6 +62,79 @@ static bool same_group(zone_t *old_z, zone_t *new_z)
 	}
 }
 
+/*! \brief Catalog zone removal of a member zone not present in the new zonedb. */
+static void generate_removed(struct knot_zonedb *db_new, zone_t *zone)
+{
+	knot_dname_t *cg = zone->catalog_gen;
+	if (cg == NULL || knot_zonedb_find(db_new, zone->name) != NULL) {
+		return;
+	}
+
+	zone_t *catz = knot_zonedb_find(db_new, cg);
+	if (catz == NULL || catz->contents == NULL) {
+		return;
+	}
+
+	assert(catz->cat_members != NULL); // if this failed to allocate, catz wasn't added to zonedb
+	knot_dname_t *owner = catalog_member_owner(zone->name, cg, zone->timers.catalog_member);
+	if (owner == NULL) {
+		catz->cat_members->error = KNOT_ENOENT;
+		return;
+	}
+	int ret = catalog_update_add(catz->cat_members, zone->name, owner,
+	                             cg, CAT_UPD_REM, NULL, 0, NULL);
+	free(owner);
+	if (ret != KNOT_EOK) {
+		catz->cat_members->error = ret;
+	} else {
+		zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
+	}
+}
+
+/*! \brief Catalog zone addition or property change of a member zone in the new zonedb. */
+static void generate_member(struct knot_zonedb *db_new, struct knot_zonedb *db_old,
+                            zone_t *zone)
+{
+	knot_dname_t *cg = zone->catalog_gen;
+	if (cg == NULL) {
+		return;
+	}
+
+	zone_t *catz = knot_zonedb_find(db_new, cg);
+	zone_t *old = knot_zonedb_find(db_old, zone->name);
+	knot_dname_t *owner = catalog_member_owner(zone->name, cg, zone->timers.catalog_member);
+	size_t cgroup_size = zone->catalog_group == NULL ? 0 : strlen(zone->catalog_group);
+	if (catz == NULL) {
+		log_zone_error(zone->name, "member zone belongs to non-existing catalog zone");
+	} else if (catz->cat_members == NULL) {
+		log_zone_error(zone->name, "member zone belongs to non-generated catalog zone");
+	} else if (catz->contents == NULL || old == NULL) {
+		assert(catz->cat_members != NULL);
+		if (owner == NULL) {
+			catz->cat_members->error = KNOT_ENOENT;
+			return;
+		}
+		int ret = catalog_update_add(catz->cat_members, zone->name, owner,
+		                             cg, CAT_UPD_ADD, zone->catalog_group,
+		                             cgroup_size, NULL);
+		if (ret != KNOT_EOK) {
+			catz->cat_members->error = ret;
+		} else {
+			zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
+		}
+	} else if (!same_group(zone, old)) {
+		int ret = catalog_update_add(catz->cat_members, zone->name, owner,
+		                             cg, CAT_UPD_PROP, zone->catalog_group,
+		                             cgroup_size, NULL);
+		if (ret != KNOT_EOK) {
+			catz->cat_members->error = ret;
+		} else {
+			zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
+		}
+	}
+	free(owner);
+}
+
 void catalogs_generate(struct knot_zonedb *db_new, struct knot_zonedb *db_old)
 {
 	// general comment: catz->contents!=NULL means incremental update of catalog
@@ -69,28 +142,7 @@ void catalogs_generate(struct knot_zonedb *db_new, struct knot_zonedb *db_old)
 	if (db_old != NULL) {
 		knot_zonedb_iter_t *it = knot_zonedb_iter_begin(db_old);
 		while (!knot_zonedb_iter_finished(it)) {
-			zone_t *zone = knot_zonedb_iter_val(it);
-			knot_dname_t *cg = zone->catalog_gen;
-			if (cg != NULL && knot_zonedb_find(db_new, zone->name) == NULL) {
-				zone_t *catz = knot_zonedb_find(db_new, cg);
-				if (catz != NULL && catz->contents != NULL) {
-					assert(catz->cat_members != NULL); // if this failed to allocate, catz wasn't added to zonedb
-					knot_dname_t *owner = catalog_member_owner(zone->name, cg, zone->timers.catalog_member);
-					if (owner == NULL) {
-						catz->cat_members->error = KNOT_ENOENT;
-						knot_zonedb_iter_next(it);
-						continue;
-					}
-					int ret = catalog_update_add(catz->cat_members, zone->name, owner,
-					                             cg, CAT_UPD_REM, NULL, 0, NULL);
-					free(owner);
-					if (ret != KNOT_EOK) {
-						catz->cat_members->error = ret;
-					} else {
-						zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
-					}
-				}
-			}
+			generate_removed(db_new, knot_zonedb_iter_val(it));
 			knot_zonedb_iter_next(it);
 		}
 		knot_zonedb_iter_free(it);
@@ -98,51 +150,41 @@ void catalogs_generate(struct knot_zonedb *db_new, struct knot_zonedb *db_old)
 
 	knot_zonedb_iter_t *it = knot_zonedb_iter_begin(db_new);
 	while (!knot_zonedb_iter_finished(it)) {
-		zone_t *zone = knot_zonedb_iter_val(it);
-		knot_dname_t *cg = zone->catalog_gen;
-		if (cg == NULL) {
-			knot_zonedb_iter_next(it);
-			continue;
-		}
-		zone_t *catz = knot_zonedb_find(db_new, cg);
-		zone_t *old = knot_zonedb_find(db_old, zone->name);
-		knot_dname_t *owner = catalog_member_owner(zone->name, cg, zone->timers.catalog_member);
-		size_t cgroup_size = zone->catalog_group == NULL ? 0 : strlen(zone->catalog_group);
-		if (catz == NULL) {
-			log_zone_error(zone->name, "member zone belongs to non-existing catalog zone");
-		} else if (catz->cat_members == NULL) {
-			log_zone_error(zone->name, "member zone belongs to non-generated catalog zone");
-		} else if (catz->contents == NULL || old == NULL) {
-			assert(catz->cat_members != NULL);
-			if (owner == NULL) {
-				catz->cat_members->error = KNOT_ENOENT;
-				knot_zonedb_iter_next(it);
-				continue;
-			}
-			int ret = catalog_update_add(catz->cat_members, zone->name, owner,
-			                             cg, CAT_UPD_ADD, zone->catalog_group,
-			                             cgroup_size, NULL);
-			if (ret != KNOT_EOK) {
-				catz->cat_members->error = ret;
-			} else {
-				zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
-			}
-		} else if (!same_group(zone, old)) {
-			int ret = catalog_update_add(catz->cat_members, zone->name, owner,
-			                             cg, CAT_UPD_PROP, zone->catalog_group,
-			                             cgroup_size, NULL);
-			if (ret != KNOT_EOK) {
-				catz->cat_members->error = ret;
-			} else {
-				zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
-			}
-		}
-		free(owner);
+		generate_member(db_new, db_old, knot_zonedb_iter_val(it));
 		knot_zonedb_iter_next(it);
 	}
 	knot_zonedb_iter_free(it);
 }
 
+void catalogs_generate_changed(struct knot_zonedb *db_new, struct knot_zonedb *db_old,
+                               trie_t *changed)
+{
+	// A new catalog zone must be generated from all its members.
+	trie_it_t *it = trie_it_begin(changed);
+	for (; !trie_it_finished(it); trie_it_next(it)) {
+		zone_t *zone = knot_zonedb_find(db_new, (const knot_dname_t *)trie_it_key(it, NULL));
+		if (zone != NULL && zone->cat_members != NULL && zone->contents == NULL) {
+			trie_it_free(it);
+			catalogs_generate(db_new, db_old);
+			return;
+		}
+	}
+	trie_it_free(it);
+
+	it = trie_it_begin(changed);
+	for (; !trie_it_finished(it); trie_it_next(it)) {
+		const knot_dname_t *name = (const knot_dname_t *)trie_it_key(it, NULL);
+		zone_t *old = knot_zonedb_find(db_old, name);
+		zone_t *zone = knot_zonedb_find(db_new, name);
+		if (old != NULL && zone == NULL) {
+			generate_removed(db_new, old);
+		} else if (zone != NULL) {
+			generate_member(db_new, db_old, zone);
+		}
+	}
+	trie_it_free(it);
+}
+
 static void set_rdata(knot_rrset_t *rrset, uint8_t *data, uint16_t len)
 {
 	knot_rdata_init(rrset->rrs.rdata, len, data);
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "knot/catalog/catalog_update.h"
+#include "contrib/qp-trie/trie.h"
 
 #define CATALOG_SOA_REFRESH	3600
 #define CATALOG_SOA_RETRY	600
@@ -18,6 +19,16 @@ struct knot_zonedb;
  */
 void catalogs_generate(struct knot_zonedb *db_new, struct knot_zonedb *db_old);
 
+/*!
+ * \brief Like catalogs_generate(), but only for the given changed zones.
+ *
+ * \param db_new   New zonedb.
+ * \param db_old   Old zonedb.
+ * \param changed  Names (as keys) of the zones that differ between the zonedbs.
+ */
+void catalogs_generate_changed(struct knot_zonedb *db_new, struct knot_zonedb *db_old,
+                               trie_t *changed);
+
 struct zone_contents;
 
 /*!
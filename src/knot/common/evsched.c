@@ -3,49 +3,204 @@
  *  For more information, see <https://www.knot-dns.cz/>
  */
 
-#include <sys/time.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <assert.h>
 
 #include "libknot/libknot.h"
 #include "knot/server/dthreads.h"
 #include "knot/common/evsched.h"
+#include "contrib/time.h"
 
-/*! \brief Some implementations of timercmp >= are broken, this is for compat.*/
-static inline int timercmp_ge(struct timeval *a, struct timeval *b) {
-	return !timercmp(a, b, <);
+/*! \brief Event positions outside of the wheel slots. */
+#define EVSCHED_NONE	-1	/*!< Not scheduled. */
+#define EVSCHED_DUE	-2	/*!< Expired, waiting for dispatch. */
+
+#define BITMAP_WORDS	(EVSCHED_SLOTS / 64)
+
+/*! \brief Get current monotonic time in milliseconds. */
+static uint64_t now_ms(void)
+{
+	struct timespec ts = time_now();
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*! \brief Move all events from one list to the end of another one. */
+static void list_move(list_t *to, list_t *from)
+{
+	if (EMPTY_LIST(*from)) {
+		return;
+	}
+
+	node_t *first = HEAD(*from), *last = TAIL(*from);
+	first->prev = to->tail.prev;
+	to->tail.prev->next = first;
+	last->next = &to->tail;
+	to->tail.prev = last;
+
+	init_list(from);
+}
+
+static void slot_add(evsched_t *sched, unsigned level, unsigned slot, event_t *ev)
+{
+	evsched_level_t *lvl = &sched->levels[level];
+	add_tail(&lvl->slots[slot], &ev->n);
+	lvl->used[slot / 64] |= (uint64_t)1 << (slot % 64);
+	ev->pos = level * EVSCHED_SLOTS + slot;
+}
+
+/*!
+ * \brief Place the event into the wheel according to its time.
+ *
+ * The level is given by the distance from the wheel time, events too far
+ * in the future are kept in the top level and redistributed again later.
+ */
+static void event_place(evsched_t *sched, event_t *ev)
+{
+	if (ev->when <= sched->now) {
+		add_tail(&sched->due, &ev->n);
+		ev->pos = EVSCHED_DUE;
+		return;
+	}
+
+	uint64_t delta = ev->when - sched->now;
+	unsigned level = 0;
+	while (level < EVSCHED_LEVELS - 1 &&
+	       delta >= (uint64_t)1 << (EVSCHED_LEVEL_BITS * (level + 1))) {
+		level++;
+	}
+
+	unsigned slot = (ev->when >> (EVSCHED_LEVEL_BITS * level)) & (EVSCHED_SLOTS - 1);
+	slot_add(sched, level, slot, ev);
 }
 
-static int compare_event_heap_nodes(void *e1, void *e2)
+static void event_remove(evsched_t *sched, event_t *ev)
 {
-	if (timercmp(&((event_t *)e1)->tv, &((event_t *)e2)->tv, <)) return -1;
-	if (timercmp(&((event_t *)e1)->tv, &((event_t *)e2)->tv, >)) return 1;
-	return 0;
+	rem_node(&ev->n);
+
+	if (ev->pos >= 0) {
+		evsched_level_t *lvl = &sched->levels[ev->pos / EVSCHED_SLOTS];
+		unsigned slot = ev->pos % EVSCHED_SLOTS;
+		if (EMPTY_LIST(lvl->slots[slot])) {
+			lvl->used[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+		}
+	}
+
+	ev->pos = EVSCHED_NONE;
+	sched->count--;
+}
+
+/*! \brief Find the first non-empty slot from the given one, -1 if none. */
+static int bitmap_next(const uint64_t *used, unsigned from)
+{
+	for (unsigned word = from / 64; word < BITMAP_WORDS; word++) {
+		uint64_t bits = used[word];
+		if (word == from / 64) {
+			bits &= ~(uint64_t)0 << (from % 64);
+		}
+		if (bits != 0) {
+			return word * 64 + __builtin_ctzll(bits);
+		}
+	}
+
+	return -1;
 }
 
 /*!
- * \brief Get time T (now) + dt milliseconds.
+ * \brief Get the time the wheel reaches a slot, the slot of the current wheel
+ *        time belongs to the next rotation.
  */
-static struct timeval timeval_in(uint32_t dt)
+static uint64_t slot_time(uint64_t now, unsigned level, unsigned slot)
 {
-	struct timeval tv = { 0 };
-	gettimeofday(&tv, NULL);
+	unsigned shift = EVSCHED_LEVEL_BITS * level;
+	uint64_t span = (uint64_t)EVSCHED_SLOTS << shift;
+	uint64_t time = (now & ~(span - 1)) + ((uint64_t)slot << shift);
+	if (time <= now) {
+		time += span;
+	}
+	return time;
+}
+
+/*!
+ * \brief Find the earliest non-empty slot of the wheel.
+ *
+ * \return Time the slot is reached, UINT64_MAX if the wheel is empty.
+ */
+static uint64_t next_slot(evsched_t *sched, unsigned *level, unsigned *slot)
+{
+	uint64_t next = UINT64_MAX;
+
+	for (unsigned l = 0; l < EVSCHED_LEVELS; l++) {
+		const uint64_t *used = sched->levels[l].used;
+		unsigned cur = (sched->now >> (EVSCHED_LEVEL_BITS * l)) & (EVSCHED_SLOTS - 1);
+
+		int found = bitmap_next(used, (cur + 1) % EVSCHED_SLOTS);
+		if (found < 0 && cur + 1 < EVSCHED_SLOTS) {
+			found = bitmap_next(used, 0);
+		}
+		if (found < 0) {
+			continue;
+		}
+
+		uint64_t time = slot_time(sched->now, l, found);
+		if (time < next) {
+			next = time;
+			*level = l;
+			*slot = found;
+		}
+	}
 
-	/* Add number of seconds. */
-	tv.tv_sec += dt / 1000;
+	return next;
+}
 
-	/* Add the number of microseconds. */
-	tv.tv_usec += (dt % 1000) * 1000;
+/*!
+ * \brief Advance the wheel to the given time, collect expired events.
+ */
+static void wheel_advance(evsched_t *sched, uint64_t now)
+{
+	unsigned level, slot;
+	uint64_t next;
+	while ((next = next_slot(sched, &level, &slot)) <= now) {
+		/* Take all slots reached at this time at once, moving the wheel
+		 * time to it would postpone the others by a whole rotation. */
+		list_t reached;
+		init_list(&reached);
+		for (unsigned l = level; l < EVSCHED_LEVELS; l++) {
+			evsched_level_t *lvl = &sched->levels[l];
+			unsigned s = (next >> (EVSCHED_LEVEL_BITS * l)) & (EVSCHED_SLOTS - 1);
+			uint64_t bit = (uint64_t)1 << (s % 64);
+			if ((lvl->used[s / 64] & bit) == 0 ||
+			    slot_time(sched->now, l, s) != next) {
+				continue;
+			}
+			lvl->used[s / 64] &= ~bit;
+			list_move(&reached, &lvl->slots[s]);
+		}
 
-	/* Check for overflow. */
-	while (tv.tv_usec > 999999) {
-		tv.tv_sec += 1;
-		tv.tv_usec -= 1 * 1000 * 1000;
+		/* First level events expire now, the others are redistributed
+		 * into lower levels. */
+		sched->now = next;
+		event_t *ev, *nxt;
+		WALK_LIST_DELSAFE(ev, nxt, reached) {
+			event_place(sched, ev);
+		}
 	}
 
-	return tv;
+	sched->now = now;
+}
+
+/*!
+ * \brief Dispatch all expired events at once.
+ */
+static void dispatch_due(evsched_t *sched)
+{
+	while (!EMPTY_LIST(sched->due) && !sched->paused) {
+		event_t *ev = HEAD(sched->due);
+		event_remove(sched, ev);
+		ev->cb(ev);
+	}
 }
 
 /*! \brief Event scheduler loop. */
@@ -57,33 +212,45 @@ static int evsched_run(dthread_t *thread)
 	}
 
 	/* Run event loop. */
-	pthread_mutex_lock(&sched->heap_lock);
+	pthread_mutex_lock(&sched->lock);
 	while (!dt_is_cancelled(thread)) {
-		if (!!EMPTY_HEAP(&sched->heap) || sched->paused) {
-			pthread_cond_wait(&sched->notify, &sched->heap_lock);
+		if (sched->count == 0 || sched->paused) {
+			sched->wakeup = UINT64_MAX;
+			pthread_cond_wait(&sched->notify, &sched->lock);
+			continue;
+		}
+
+		uint64_t now = now_ms();
+		wheel_advance(sched, now);
+
+		if (!EMPTY_LIST(sched->due)) {
+			dispatch_due(sched);
 			continue;
 		}
 
-		/* Get current time. */
-		struct timeval dt;
-		gettimeofday(&dt, 0);
-
-		/* Get next event. */
-		event_t *ev = *((event_t**)HHEAD(&sched->heap));
-		assert(ev != NULL);
-
-		if (timercmp_ge(&dt, &ev->tv)) {
-			heap_delmin(&sched->heap);
-			ev->cb(ev);
-		} else {
-			/* Wait for next event or interrupt. Unlock calendar. */
-			struct timespec ts;
-			ts.tv_sec = ev->tv.tv_sec;
-			ts.tv_nsec = ev->tv.tv_usec * 1000L;
-			pthread_cond_timedwait(&sched->notify, &sched->heap_lock, &ts);
+		/* Wait for next event or interrupt. Unlock calendar. */
+		unsigned level, slot;
+		sched->wakeup = next_slot(sched, &level, &slot);
+		assert(sched->wakeup > now);
+		uint64_t wait = sched->wakeup - now;
+
+		struct timespec ts;
+#if defined(__APPLE__)
+		/* No monotonic condition clock, a wall clock step may only make
+		 * the wait shorter or longer, the wheel itself is unaffected. */
+		clock_gettime(CLOCK_REALTIME, &ts);
+#else
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+		ts.tv_sec += wait / 1000;
+		ts.tv_nsec += (wait % 1000) * 1000000L;
+		if (ts.tv_nsec >= 1000000000L) {
+			ts.tv_sec += 1;
+			ts.tv_nsec -= 1000000000L;
 		}
+		pthread_cond_timedwait(&sched->notify, &sched->lock, &ts);
 	}
-	pthread_mutex_unlock(&sched->heap_lock);
+	pthread_mutex_unlock(&sched->lock);
 
 	return KNOT_EOK;
 }
@@ -94,9 +261,23 @@ int evsched_init(evsched_t *sched, void *ctx)
 	sched->ctx = ctx;
 
 	/* Initialize event calendar. */
-	pthread_mutex_init(&sched->heap_lock, 0);
-	pthread_cond_init(&sched->notify, 0);
-	heap_init(&sched->heap, compare_event_heap_nodes, 0);
+	pthread_mutex_init(&sched->lock, 0);
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+	pthread_cond_init(&sched->notify, &attr);
+	pthread_condattr_destroy(&attr);
+
+	init_list(&sched->due);
+	for (unsigned l = 0; l < EVSCHED_LEVELS; l++) {
+		for (unsigned s = 0; s < EVSCHED_SLOTS; s++) {
+			init_list(&sched->levels[l].slots[s]);
+		}
+	}
+	sched->now = now_ms();
+	sched->wakeup = UINT64_MAX;
 
 	sched->thread = dt_create(1, evsched_run, NULL, sched);
 
@@ -115,16 +296,20 @@ void evsched_deinit(evsched_t *sched)
 	}
 
 	/* Deinitialize event calendar. */
-	pthread_mutex_destroy(&sched->heap_lock);
+	pthread_mutex_destroy(&sched->lock);
 	pthread_cond_destroy(&sched->notify);
 
-	while (!EMPTY_HEAP(&sched->heap)) {
-		event_t *e = (event_t *)*HHEAD(&sched->heap);
-		heap_delmin(&sched->heap);
-		evsched_event_free(e);
+	event_t *ev, *nxt;
+	WALK_LIST_DELSAFE(ev, nxt, sched->due) {
+		evsched_event_free(ev);
+	}
+	for (unsigned l = 0; l < EVSCHED_LEVELS; l++) {
+		for (unsigned s = 0; s < EVSCHED_SLOTS; s++) {
+			WALK_LIST_DELSAFE(ev, nxt, sched->levels[l].slots[s]) {
+				evsched_event_free(ev);
+			}
+		}
 	}
-
-	heap_deinit(&sched->heap);
 
 	if (sched->thread != NULL) {
 		dt_delete(&sched->thread);
@@ -152,7 +337,7 @@ event_t *evsched_event_create(evsched_t *sched, event_cb_t cb, void *data)
 	e->sched = sched;
 	e->cb = cb;
 	e->data = data;
-	e->hpos.pos = 0;
+	e->pos = EVSCHED_NONE;
 
 	return e;
 }
@@ -166,33 +351,53 @@ void evsched_event_free(event_t *ev)
 	free(ev);
 }
 
+/*! \brief Place the event at the given relative time, the calendar is locked. */
+static void event_schedule(evsched_t *sched, event_t *ev, uint32_t dt)
+{
+	uint64_t new_time = now_ms() + dt;
+
+	/* Make sure it's not already enqueued. */
+	if (ev->pos != EVSCHED_NONE) {
+		event_remove(sched, ev);
+	}
+
+	ev->when = new_time;
+	event_place(sched, ev);
+	sched->count++;
+
+	/* Wake up the scheduler only if the event is earlier than expected. */
+	if (new_time < sched->wakeup) {
+		pthread_cond_signal(&sched->notify);
+	}
+}
+
 int evsched_schedule(event_t *ev, uint32_t dt)
 {
 	if (ev == NULL || ev->sched == NULL) {
 		return KNOT_EINVAL;
 	}
 
-	struct timeval new_time = timeval_in(dt);
-
 	evsched_t *sched = ev->sched;
 
 	/* Lock calendar. */
-	pthread_mutex_lock(&sched->heap_lock);
+	pthread_mutex_lock(&sched->lock);
 
-	ev->tv = new_time;
+	event_schedule(sched, ev, dt);
 
-	/* Make sure it's not already enqueued. */
-	int found = heap_find(&sched->heap, (heap_val_t *)ev);
-	if (found > 0) {
-		/* "Replacing" with itself -- just repositioning it. */
-		heap_replace(&sched->heap, found, (heap_val_t *)ev);
-	} else {
-		heap_insert(&sched->heap, (heap_val_t *)ev);
+	/* Unlock calendar. */
+	pthread_mutex_unlock(&sched->lock);
+
+	return KNOT_EOK;
+}
+
+int evsched_schedule_again(event_t *ev, uint32_t dt)
+{
+	if (ev == NULL || ev->sched == NULL) {
+		return KNOT_EINVAL;
 	}
 
-	/* Unlock calendar. */
-	pthread_cond_signal(&sched->notify);
-	pthread_mutex_unlock(&sched->heap_lock);
+	/* The calendar is locked by the scheduler thread running the callback. */
+	event_schedule(ev->sched, ev, dt);
 
 	return KNOT_EOK;
 }
@@ -206,19 +411,17 @@ int evsched_cancel(event_t *ev)
 	evsched_t *sched = ev->sched;
 
 	/* Lock calendar. */
-	pthread_mutex_lock(&sched->heap_lock);
+	pthread_mutex_lock(&sched->lock);
 
-	int found = heap_find(&sched->heap, (heap_val_t *)ev);
-	if (found > 0) {
-		heap_delete(&sched->heap, found);
-		pthread_cond_signal(&sched->notify);
+	if (ev->pos != EVSCHED_NONE) {
+		event_remove(sched, ev);
 	}
 
 	/* Unlock calendar. */
-	pthread_mutex_unlock(&sched->heap_lock);
+	pthread_mutex_unlock(&sched->lock);
 
 	/* Reset event timer. */
-	memset(&ev->tv, 0, sizeof(struct timeval));
+	ev->when = 0;
 
 	return KNOT_EOK;
 }
@@ -230,10 +433,10 @@ void evsched_start(evsched_t *sched)
 
 void evsched_stop(evsched_t *sched)
 {
-	pthread_mutex_lock(&sched->heap_lock);
+	pthread_mutex_lock(&sched->lock);
 	dt_stop(sched->thread);
 	pthread_cond_signal(&sched->notify);
-	pthread_mutex_unlock(&sched->heap_lock);
+	pthread_mutex_unlock(&sched->lock);
 }
 
 void evsched_join(evsched_t *sched)
@@ -243,15 +446,15 @@ void evsched_join(evsched_t *sched)
 
 void evsched_pause(evsched_t *sched)
 {
-	pthread_mutex_lock(&sched->heap_lock);
+	pthread_mutex_lock(&sched->lock);
 	sched->paused = true;
-	pthread_mutex_unlock(&sched->heap_lock);
+	pthread_mutex_unlock(&sched->lock);
 }
 
 void evsched_resume(evsched_t *sched)
 {
-	pthread_mutex_lock(&sched->heap_lock);
+	pthread_mutex_lock(&sched->lock);
 	sched->paused = false;
 	pthread_cond_signal(&sched->notify);
-	pthread_mutex_unlock(&sched->heap_lock);
+	pthread_mutex_unlock(&sched->lock);
 }
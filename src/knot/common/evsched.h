@@ -5,6 +5,12 @@
 
 /*!
  * \brief Event scheduler.
+ *
+ * Events are kept in a hierarchical timing wheel driven by the monotonic
+ * clock. The first level has slots of one millisecond, each next level has
+ * slots spanning the whole previous level. Inserting and canceling an event
+ * takes constant time, events from a higher level slot are redistributed
+ * into lower levels when the wheel time reaches the slot.
  */
 
 #pragma once
@@ -12,10 +18,16 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <sys/time.h>
 
 #include "knot/server/dthreads.h"
-#include "contrib/ucw/heap.h"
+#include "contrib/ucw/lists.h"
+
+/*! \brief Number of timing wheel levels. */
+#define EVSCHED_LEVELS		4
+/*! \brief Number of bits of the time indexing one level. */
+#define EVSCHED_LEVEL_BITS	8
+/*! \brief Number of slots in one level. */
+#define EVSCHED_SLOTS		(1 << EVSCHED_LEVEL_BITS)
 
 /* Forward decls. */
 struct evsched;
@@ -40,21 +52,34 @@ typedef void (*event_cb_t)(struct event *);
  * \brief Event structure.
  */
 typedef struct event {
-	struct heap_val hpos;
-	struct timeval tv; /*!< Event scheduled time. */
+	node_t n;          /*!< Node in a wheel slot or in the list of due events. */
+	int pos;           /*!< Position in the wheel, negative if not in a slot. */
+	uint64_t when;     /*!< Event scheduled time (monotonic, milliseconds). */
 	void *data;        /*!< Usable data ptr. */
 	event_cb_t cb;     /*!< Event callback. */
 	struct evsched *sched; /*!< Scheduler for this event. */
 } event_t;
 
+/*!
+ * \brief One level of the timing wheel.
+ */
+typedef struct {
+	list_t slots[EVSCHED_SLOTS]; /*!< Events by the level-specific time bits. */
+	uint64_t used[EVSCHED_SLOTS / 64]; /*!< Bitmap of non-empty slots. */
+} evsched_level_t;
+
 /*!
  * \brief Event scheduler structure.
  */
 typedef struct evsched {
 	volatile bool paused;      /*!< Temporarily stop processing events. */
-	pthread_mutex_t heap_lock; /*!< Event heap locking. */
-	pthread_cond_t notify;     /*!< Event heap notification. */
-	struct heap heap;          /*!< Event heap. */
+	pthread_mutex_t lock;      /*!< Event wheel locking. */
+	pthread_cond_t notify;     /*!< Event wheel notification. */
+	uint64_t now;              /*!< Wheel time, earlier slots are processed. */
+	uint64_t wakeup;           /*!< Time the scheduler thread sleeps until. */
+	size_t count;              /*!< Number of scheduled events. */
+	list_t due;                /*!< Expired events to be dispatched. */
+	evsched_level_t levels[EVSCHED_LEVELS]; /*!< Timing wheel. */
 	void *ctx;                 /*!< Scheduler context. */
 	dt_unit_t *thread;
 } evsched_t;
@@ -111,6 +136,20 @@ void evsched_event_free(event_t *ev);
  */
 int evsched_schedule(event_t *ev, uint32_t dt);
 
+/*!
+ * \brief Schedule the event again from within its own callback.
+ *
+ * \note The callbacks are run with the scheduler locked, so evsched_schedule()
+ *       can't be used there.
+ *
+ * \param ev Event being dispatched.
+ * \param dt Time difference in milliseconds from now (dt is relative).
+ *
+ * \retval KNOT_EOK on success.
+ * \retval KNOT_EINVAL
+ */
+int evsched_schedule_again(event_t *ev, uint32_t dt);
+
 /*!
  * \brief Cancel a scheduled event.
  *
@@ -4,6 +4,7 @@
  */
 
 #include <inttypes.h>
+#include <stddef.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -109,6 +110,19 @@ int stats_xdp(stats_dump_ctr_f fcn, stats_dump_ctx_t *ctx)
 	return KNOT_EOK;
 }
 
+static uint64_t udp_stats_sum(const server_t *server, size_t offset)
+{
+	uint64_t sum = 0;
+	for (unsigned i = 0; i < server->stats.udp_count; i++) {
+		knot_atomic_uint64_t *ctr = (knot_atomic_uint64_t *)
+		                            ((uint8_t *)&server->stats.udp[i] + offset);
+		sum += ATOMIC_GET(*ctr);
+	}
+	return sum;
+}
+
+#define UDP_SUM(server, ctr) udp_stats_sum(server, offsetof(server_udp_stats_t, ctr))
+
 #define DUMP_VAL(params, it, val) { \
 	(params).item = (it); \
 	(params).value = (val); \
@@ -129,6 +143,31 @@ int stats_server(stats_dump_ctr_f fcn, stats_dump_ctx_t *ctx)
 	DUMP_VAL(params, "zone-count", knot_zonedb_size(ctx->server->zone_db));
 	DUMP_VAL(params, "tcp-io-timeout", ctx->server->stats.tcp_io_timeout);
 	DUMP_VAL(params, "tcp-idle-timeout", ctx->server->stats.tcp_idle_timeout);
+	DUMP_VAL(params, "udp-recv-batches", UDP_SUM(ctx->server, recv_batches));
+	DUMP_VAL(params, "udp-recv-full-batches", UDP_SUM(ctx->server, recv_full_batches));
+	DUMP_VAL(params, "udp-recv-msgs", UDP_SUM(ctx->server, recv_msgs));
+	DUMP_VAL(params, "udp-gro-segments", UDP_SUM(ctx->server, gro_segments));
+	DUMP_VAL(params, "udp-gso-sends", UDP_SUM(ctx->server, gso_sends));
+	DUMP_VAL(params, "udp-gso-segments", UDP_SUM(ctx->server, gso_segments));
+	DUMP_VAL(params, "io-uring-submits", ctx->server->stats.io_uring_submits);
+
+	// NOTIFY latency histogram in milliseconds.
+	char id[32];
+	params.id = id;
+	params.item_begin = true;
+	for (unsigned i = 0; i < SERVER_NOTIFY_LATENCY_BUCKETS; i++) {
+		if (i == 0) {
+			(void)snprintf(id, sizeof(id), "0-1");
+		} else if (i == SERVER_NOTIFY_LATENCY_BUCKETS - 1) {
+			(void)snprintf(id, sizeof(id), "%u-", 1U << (i - 1));
+		} else {
+			(void)snprintf(id, sizeof(id), "%u-%u", 1U << (i - 1), 1U << i);
+		}
+		DUMP_VAL(params, "notify-latency", ctx->server->stats.notify_latency[i]);
+		params.value_pos++;
+	}
+	params.id = NULL;
+	params.value_pos = 0;
 
 	return KNOT_EOK;
 }
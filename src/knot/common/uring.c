@@ -0,0 +1,166 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "knot/common/uring.h"
+#include "libknot/errcode.h"
+
+static void buf_add(uring_t *u, unsigned bid, unsigned offset)
+{
+	io_uring_buf_ring_add(u->br, u->bufs + (size_t)bid * u->buf_size, u->buf_size,
+	                      bid, io_uring_buf_ring_mask(u->buf_count), offset);
+}
+
+int uring_init(uring_t *u, unsigned entries, unsigned buf_count, unsigned buf_size)
+{
+	if (u == NULL || (buf_count & (buf_count - 1)) != 0) {
+		return KNOT_EINVAL;
+	}
+
+	memset(u, 0, sizeof(*u));
+
+	int ret = io_uring_queue_init(entries, &u->ring, 0);
+	if (ret < 0) {
+		return knot_map_errno_code(-ret);
+	}
+
+	if (buf_count == 0) {
+		return KNOT_EOK;
+	}
+
+	u->buf_count = buf_count;
+	u->buf_size = buf_size;
+	u->bufs = malloc((size_t)buf_count * buf_size);
+	if (u->bufs == NULL) {
+		io_uring_queue_exit(&u->ring);
+		return KNOT_ENOMEM;
+	}
+
+	u->br = io_uring_setup_buf_ring(&u->ring, buf_count, URING_BGID, 0, &ret);
+	if (u->br == NULL) {
+		free(u->bufs);
+		io_uring_queue_exit(&u->ring);
+		return knot_map_errno_code(-ret);
+	}
+
+	for (unsigned i = 0; i < buf_count; i++) {
+		buf_add(u, i, i);
+	}
+	io_uring_buf_ring_advance(u->br, buf_count);
+
+	return KNOT_EOK;
+}
+
+int uring_probe(uring_t *u, const int *ops, size_t count)
+{
+	struct io_uring_probe *probe = io_uring_get_probe_ring(&u->ring);
+	if (probe == NULL) {
+		return KNOT_ENOTSUP;
+	}
+
+	int ret = KNOT_EOK;
+	for (size_t i = 0; i < count; i++) {
+		if (!io_uring_opcode_supported(probe, ops[i])) {
+			ret = KNOT_ENOTSUP;
+			break;
+		}
+	}
+	io_uring_free_probe(probe);
+
+	return ret;
+}
+
+void uring_deinit(uring_t *u)
+{
+	if (u == NULL) {
+		return;
+	}
+
+	if (u->br != NULL) {
+		(void)io_uring_free_buf_ring(&u->ring, u->br, u->buf_count, URING_BGID);
+	}
+	io_uring_queue_exit(&u->ring);
+	free(u->bufs);
+	memset(u, 0, sizeof(*u));
+}
+
+struct io_uring_sqe *uring_sqe(uring_t *u)
+{
+	struct io_uring_sqe *sqe = io_uring_get_sqe(&u->ring);
+	if (sqe == NULL) {
+		(void)io_uring_submit(&u->ring);
+		u->submits++;
+		sqe = io_uring_get_sqe(&u->ring);
+		assert(sqe != NULL);
+	}
+
+	return sqe;
+}
+
+uint8_t *uring_cqe_buf(uring_t *u, const struct io_uring_cqe *cqe)
+{
+	if (!(cqe->flags & IORING_CQE_F_BUFFER)) {
+		return NULL;
+	}
+
+	unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+	assert(bid < u->buf_count);
+	return u->bufs + (size_t)bid * u->buf_size;
+}
+
+void uring_cqe_buf_recycle(uring_t *u, const struct io_uring_cqe *cqe)
+{
+	if (!(cqe->flags & IORING_CQE_F_BUFFER)) {
+		return;
+	}
+
+	unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+	assert(bid < u->buf_count);
+	buf_add(u, bid, u->buf_recycled++);
+}
+
+int uring_wait(uring_t *u, struct io_uring_cqe **cqes, int timeout_ms)
+{
+	if (u->buf_recycled > 0) {
+		io_uring_buf_ring_advance(u->br, u->buf_recycled);
+		u->buf_recycled = 0;
+	}
+
+	struct __kernel_timespec ts = {
+		.tv_sec = timeout_ms / 1000,
+		.tv_nsec = (timeout_ms % 1000) * 1000000L
+	};
+
+	/* Submit the queue and wait for completions in one system call. */
+	struct io_uring_cqe *cqe;
+	int ret = io_uring_submit_and_wait_timeout(&u->ring, &cqe, 1, &ts, NULL);
+	u->submits++;
+
+	/* Overflown completion queue or a temporary lack of kernel resources,
+	 * the unsubmitted requests are submitted again with the next call. */
+	bool transient = (ret == -EBUSY || ret == -EAGAIN);
+	if (ret < 0 && ret != -ETIME && ret != -EINTR && !transient) {
+		return knot_map_errno_code(-ret);
+	}
+
+	unsigned count = io_uring_peek_batch_cqe(&u->ring, cqes, URING_MAX_CQES);
+	if (count == 0 && transient) {
+		usleep(URING_BACKOFF_US);
+	}
+
+	return count;
+}
+
+void uring_cancel_all(uring_t *u)
+{
+	struct io_uring_sqe *sqe = uring_sqe(u);
+	io_uring_prep_cancel64(sqe, 0, IORING_ASYNC_CANCEL_ANY);
+	io_uring_sqe_set_data64(sqe, uring_data(URING_NONE, 0));
+}
@@ -0,0 +1,143 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+/*!
+ * \brief io_uring submission/completion loop with a provided receive buffer ring.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <liburing.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define URING_BGID	0   /*!< Identifier of the provided buffer group. */
+#define URING_MAX_CQES	64  /*!< Maximum number of completions reaped at once. */
+#define URING_BACKOFF_US	1000 /*!< Wait after a failed submission without completions. */
+#define URING_NONE	0   /*!< Completion type to be ignored. */
+
+/*! \brief io_uring instance with a ring of provided receive buffers. */
+typedef struct {
+	struct io_uring ring;          /*!< Submission and completion queues. */
+	struct io_uring_buf_ring *br;  /*!< Ring of receive buffers registered in the kernel. */
+	uint8_t *bufs;                 /*!< Backing storage of the receive buffers. */
+	unsigned buf_count;            /*!< Number of receive buffers (power of two). */
+	unsigned buf_size;             /*!< Size of one receive buffer. */
+	unsigned buf_recycled;         /*!< Recycled buffers not yet published to the kernel. */
+	uint64_t submits;              /*!< Number of submit (system) calls. */
+} uring_t;
+
+/*!
+ * \brief Encodes the completion type and object index into the user data.
+ */
+inline static uint64_t uring_data(unsigned type, uint32_t idx)
+{
+	return ((uint64_t)type << 32) | idx;
+}
+
+inline static unsigned uring_data_type(uint64_t data)
+{
+	return data >> 32;
+}
+
+inline static uint32_t uring_data_idx(uint64_t data)
+{
+	return (uint32_t)data;
+}
+
+/*!
+ * \brief Returns true if the multishot request remains armed after the completion.
+ */
+inline static bool uring_cqe_more(const struct io_uring_cqe *cqe)
+{
+	return cqe->flags & IORING_CQE_F_MORE;
+}
+
+/*!
+ * \brief Returns true if the request failed for a temporary reason (e.g. out
+ *        of receive buffers) and can be armed again.
+ */
+inline static bool uring_res_temporary(int res)
+{
+	return res >= 0 || res == -ENOBUFS || res == -ENOMEM ||
+	       res == -EAGAIN || res == -EINTR;
+}
+
+/*!
+ * \brief Initializes the ring and registers the receive buffers.
+ *
+ * \param u          Ring to be initialized.
+ * \param entries    Submission queue size.
+ * \param buf_count  Number of receive buffers (power of two, zero for none).
+ * \param buf_size   Size of one receive buffer.
+ *
+ * \return Error code, KNOT_EOK if successful.
+ */
+int uring_init(uring_t *u, unsigned entries, unsigned buf_count, unsigned buf_size);
+
+/*!
+ * \brief Checks that the kernel supports the request opcodes.
+ *
+ * \param u      Initialized ring.
+ * \param ops    IORING_OP_* opcodes.
+ * \param count  Number of opcodes.
+ *
+ * \return KNOT_EOK if all supported, KNOT_ENOTSUP if not, or error code.
+ */
+int uring_probe(uring_t *u, const int *ops, size_t count);
+
+/*!
+ * \brief Unregisters the receive buffers and closes the ring.
+ */
+void uring_deinit(uring_t *u);
+
+/*!
+ * \brief Returns a cleared submission queue entry, submits the queue if full.
+ */
+struct io_uring_sqe *uring_sqe(uring_t *u);
+
+/*!
+ * \brief Returns the receive buffer used by the completion or NULL.
+ */
+uint8_t *uring_cqe_buf(uring_t *u, const struct io_uring_cqe *cqe);
+
+/*!
+ * \brief Returns the receive buffer used by the completion back to the kernel.
+ *
+ * \note The buffer is published with the next uring_wait().
+ */
+void uring_cqe_buf_recycle(uring_t *u, const struct io_uring_cqe *cqe);
+
+/*!
+ * \brief Submits the queued requests and waits for completions.
+ *
+ * \param u           Ring.
+ * \param cqes        Output array of at least URING_MAX_CQES completions.
+ * \param timeout_ms  Maximum time to wait for the first completion.
+ *
+ * \note Transient submission failures (overflown completion queue, lack of
+ *       kernel resources) aren't reported, the caller just gets the pending
+ *       completions, if any, after a short back off.
+ *
+ * \return Number of completions (to be confirmed by uring_seen()) or error code.
+ */
+int uring_wait(uring_t *u, struct io_uring_cqe **cqes, int timeout_ms);
+
+/*!
+ * \brief Queues cancellation of all requests in flight.
+ *
+ * The cancel request itself completes with the URING_NONE type.
+ */
+void uring_cancel_all(uring_t *u);
+
+/*!
+ * \brief Confirms the processed completions.
+ */
+inline static void uring_seen(uring_t *u, unsigned count)
+{
+	io_uring_cq_advance(&u->ring, count);
+}
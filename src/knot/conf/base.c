@@ -12,6 +12,7 @@
 #include "knot/conf/tools.h"
 #include "knot/common/log.h"
 #include "knot/nameserver/query_module.h"
+#include "knot/updates/acl.h"
 #include "libknot/libknot.h"
 #include "libknot/yparser/ypformat.h"
 #include "libknot/yparser/yptrafo.h"
@@ -108,13 +109,15 @@ static void init_cache(
 {
 	/*
 	 * For UDP, TCP, XDP, and background workers, cache the number of running
-	 * workers. Cache the setting of TCP reuseport too. These values
-	 * can't change in runtime, while config data can.
+	 * workers. Cache the setting of TCP reuseport, UDP segmentation, and
+	 * io_uring too. These values can't change in runtime, while config data can.
 	 */
 
 	static bool   first_init = true;
 	static bool   running_tcp_reuseport;
 	static bool   running_socket_affinity;
+	static bool   running_udp_segmentation;
+	static bool   running_io_uring;
 	static bool   running_xdp_udp;
 	static bool   running_xdp_tcp;
 	static uint16_t running_xdp_quic;
@@ -133,6 +136,8 @@ static void init_cache(
 	if (first_init || reinit_cache) {
 		running_tcp_reuseport = conf_get_bool(conf, C_SRV, C_TCP_REUSEPORT);
 		running_socket_affinity = conf_get_bool(conf, C_SRV, C_SOCKET_AFFINITY);
+		running_udp_segmentation = conf_get_bool(conf, C_SRV, C_UDP_SEGMENTATION);
+		running_io_uring = conf_get_bool(conf, C_SRV, C_IO_URING);
 		running_xdp_udp = conf_get_bool(conf, C_XDP, C_UDP);
 		running_xdp_tcp = conf_get_bool(conf, C_XDP, C_TCP);
 		running_xdp_quic = 0;
@@ -175,6 +180,9 @@ static void init_cache(
 	val = conf_get(conf, C_SRV, C_TCP_RMT_IO_TIMEOUT);
 	conf->cache.srv_tcp_remote_io_timeout = infinite_adjust(conf_int(&val));
 
+	val = conf_get(conf, C_SRV, C_REFRESH_INFLIGHT);
+	conf->cache.srv_refresh_inflight = conf_int(&val);
+
 	val = conf_get(conf, C_SRV, C_TCP_FASTOPEN);
 	conf->cache.srv_tcp_fastopen = conf_bool(&val);
 
@@ -188,6 +196,10 @@ static void init_cache(
 
 	conf->cache.srv_socket_affinity = running_socket_affinity;
 
+	conf->cache.srv_udp_segmentation = running_udp_segmentation;
+
+	conf->cache.srv_io_uring = running_io_uring;
+
 	val = conf_get(conf, C_SRV, C_DBUS_EVENT);
 	while (val.code == KNOT_EOK) {
 		conf->cache.srv_dbus_event |= conf_opt(&val);
@@ -540,6 +552,8 @@ void conf_free(
 		trie_free(conf->io.zones);
 	}
 
+	acl_cache_free(conf->acl_cache);
+
 	conf_mod_load_purge(conf, false);
 	conf_deactivate_modules(conf->query_modules, &conf->query_plan);
 	free(conf->query_modules);
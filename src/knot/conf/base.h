@@ -95,6 +95,7 @@ knot_dynarray_declare(mod, module_t *, DYNARRAY_VISIBILITY_NORMAL, 16)
 knot_dynarray_declare(old_schema, yp_item_t *, DYNARRAY_VISIBILITY_NORMAL, 16)
 
 struct knot_catalog;
+struct acl_cache;
 
 /*! Configuration context. */
 typedef struct {
@@ -138,6 +139,7 @@ typedef struct {
 		int srv_tcp_idle_timeout;
 		int srv_tcp_io_timeout;
 		int srv_tcp_remote_io_timeout;
+		size_t srv_refresh_inflight;
 		size_t srv_udp_threads;
 		size_t srv_tcp_threads;
 		size_t srv_xdp_threads;
@@ -168,6 +170,8 @@ typedef struct {
 		bool srv_tcp_reuseport;
 		bool srv_tcp_fastopen;
 		bool srv_socket_affinity;
+		bool srv_udp_segmentation;
+		bool srv_io_uring;
 		bool srv_ecs;
 		bool srv_ans_rotate;
 		bool srv_auto_acl;
@@ -185,6 +189,8 @@ typedef struct {
 	struct query_plan *query_plan;
 	/*! Zone catalog database. */
 	struct catalog *catalog;
+	/*! Compiled zone ACLs (optional). */
+	struct acl_cache *acl_cache;
 } conf_t;
 
 /*!
@@ -152,6 +152,12 @@ static const knot_lookup_t journal_content[] = {
 	{ 0, NULL }
 };
 
+static const knot_lookup_t journal_compression[] = {
+	{ JOURNAL_COMPRESSION_NONE, "none" },
+	{ JOURNAL_COMPRESSION_ZSTD, "zstd" },
+	{ 0, NULL }
+};
+
 static const knot_lookup_t zonefile_load[] = {
 	{ ZONEFILE_LOAD_NONE,  "none" },
 	{ ZONEFILE_LOAD_DIFF,  "difference" },
@@ -224,6 +230,7 @@ static const yp_item_t desc_server[] = {
 	{ C_RMT_POOL_LIMIT,       YP_TINT,  YP_VINT = { 0, INT32_MAX, 0 } },
 	{ C_RMT_POOL_TIMEOUT,     YP_TINT,  YP_VINT = { 1, INT32_MAX, 5, YP_STIME } },
 	{ C_RMT_RETRY_DELAY,      YP_TINT,  YP_VINT = { 0, INT32_MAX, 0 } },
+	{ C_REFRESH_INFLIGHT,     YP_TINT,  YP_VINT = { 0, INT32_MAX, 0 } },
 	{ C_SOCKET_AFFINITY,      YP_TBOOL, YP_VNONE },
 	{ C_UDP_MAX_PAYLOAD,      YP_TINT,  YP_VINT = { KNOT_EDNS_MIN_DNSSEC_PAYLOAD,
 	                                                KNOT_EDNS_MAX_UDP_PAYLOAD,
@@ -234,6 +241,8 @@ static const yp_item_t desc_server[] = {
 	{ C_UDP_MAX_PAYLOAD_IPV6, YP_TINT,  YP_VINT = { KNOT_EDNS_MIN_DNSSEC_PAYLOAD,
 	                                                KNOT_EDNS_MAX_UDP_PAYLOAD,
 	                                                1232, YP_SSIZE } },
+	{ C_UDP_SEGMENTATION,     YP_TBOOL, YP_VNONE },
+	{ C_IO_URING,             YP_TBOOL, YP_VNONE },
 	{ C_CERT_FILE,            YP_TSTR,  YP_VNONE, YP_FNONE },
 	{ C_KEY_FILE,             YP_TSTR,  YP_VNONE, YP_FNONE },
 	{ C_CA_FILE,              YP_TSTR,  YP_VNONE, YP_FMULTI },
@@ -470,14 +479,19 @@ static const yp_item_t desc_policy[] = {
 	{ C_ZONEFILE_SYNC,       YP_TINT,  YP_VINT = { -1, INT32_MAX, 0, YP_STIME } }, \
 	{ C_ZONEFILE_LOAD,       YP_TOPT,  YP_VOPT = { zonefile_load, ZONEFILE_LOAD_WHOLE } }, \
 	{ C_ZONEFILE_SKIP,       YP_TSTR,  YP_VNONE, YP_FMULTI, { check_zonefile_skip } }, \
+	{ C_ZONEFILE_SNAPSHOT,   YP_TBOOL, YP_VNONE }, \
 	{ C_JOURNAL_CONTENT,     YP_TOPT,  YP_VOPT = { journal_content, JOURNAL_CONTENT_CHANGES }, FLAGS }, \
 	{ C_JOURNAL_MAX_USAGE,   YP_TINT,  YP_VINT = { KILO(40), SSIZE_MAX, MEGA(100), YP_SSIZE } }, \
 	{ C_JOURNAL_MAX_DEPTH,   YP_TINT,  YP_VINT = { 2, SSIZE_MAX, 20 } }, \
+	{ C_JOURNAL_COMPRESSION, YP_TOPT,  YP_VOPT = { journal_compression, JOURNAL_COMPRESSION_NONE } }, \
 	{ C_IXFR_BENEVOLENT,     YP_TBOOL, YP_VNONE }, \
 	{ C_IXFR_BY_ONE,         YP_TBOOL, YP_VNONE }, \
 	{ C_IXFR_FROM_AXFR,      YP_TBOOL, YP_VNONE }, \
 	{ C_ZONE_MAX_SIZE,       YP_TINT,  YP_VINT = { 0, SSIZE_MAX, SSIZE_MAX, YP_SSIZE }, FLAGS }, \
 	{ C_ADJUST_THR,          YP_TINT,  YP_VINT = { 1, UINT16_MAX, 1 } }, \
+	{ C_ANSWER_CACHE,        YP_TINT,  YP_VINT = { 0, UINT32_MAX, 0 } }, \
+	{ C_AXFR_CACHE,          YP_TBOOL, YP_VNONE }, \
+	{ C_IXFR_CACHE,          YP_TINT,  YP_VINT = { 0, UINT16_MAX, 0 } }, \
 	{ C_DNSSEC_SIGNING,      YP_TBOOL, YP_VNONE, FLAGS }, \
 	{ C_DNSSEC_VALIDATION,   YP_TBOOL, YP_VNONE, FLAGS }, \
 	{ C_DNSSEC_POLICY,       YP_TREF,  YP_VREF = { C_POLICY }, FLAGS, { check_ref_dflt } }, \
@@ -13,11 +13,13 @@
 #define C_ADDR			"\x07""address"
 #define C_ADJUST_THR		"\x0E""adjust-threads"
 #define C_ALG			"\x09""algorithm"
+#define C_ANSWER_CACHE		"\x0C""answer-cache"
 #define C_ANS_ROTATION		"\x0F""answer-rotation"
 #define C_ANY			"\x03""any"
 #define C_APPEND		"\x06""append"
 #define C_ASYNC_START		"\x0B""async-start"
 #define C_AUTO_ACL		"\x0D""automatic-acl"
+#define C_AXFR_CACHE		"\x0A""axfr-cache"
 #define C_BACKEND		"\x07""backend"
 #define C_BACKLOG		"\x07""backlog"
 #define C_BG_WORKERS		"\x12""background-workers"
@@ -63,9 +65,12 @@
 #define C_ID			"\x02""id"
 #define C_IDENT			"\x08""identity"
 #define C_INCL			"\x07""include"
+#define C_IO_URING		"\x08""io-uring"
 #define C_IXFR_BENEVOLENT	"\x0F""ixfr-benevolent"
 #define C_IXFR_BY_ONE		"\x0B""ixfr-by-one"
+#define C_IXFR_CACHE		"\x0A""ixfr-cache"
 #define C_IXFR_FROM_AXFR	"\x0E""ixfr-from-axfr"
+#define C_JOURNAL_COMPRESSION	"\x13""journal-compression"
 #define C_JOURNAL_CONTENT	"\x0F""journal-content"
 #define C_JOURNAL_DB		"\x0A""journal-db"
 #define C_JOURNAL_DB_MAX_SIZE	"\x13""journal-db-max-size"
@@ -115,6 +120,7 @@
 #define C_QUIC_MAX_CLIENTS	"\x10""quic-max-clients"
 #define C_QUIC_OUTBUF_MAX_SIZE	"\x14""quic-outbuf-max-size"
 #define C_QUIC_PORT		"\x09""quic-port"
+#define C_REFRESH_INFLIGHT	"\x10""refresh-inflight"
 #define C_REFRESH_MAX_INTERVAL	"\x14""refresh-max-interval"
 #define C_REFRESH_MIN_INTERVAL	"\x14""refresh-min-interval"
 #define C_REPRO_SIGNING		"\x14""reproducible-signing"
@@ -168,6 +174,7 @@
 #define C_UDP_MAX_PAYLOAD	"\x0F""udp-max-payload"
 #define C_UDP_MAX_PAYLOAD_IPV4	"\x14""udp-max-payload-ipv4"
 #define C_UDP_MAX_PAYLOAD_IPV6	"\x14""udp-max-payload-ipv6"
+#define C_UDP_SEGMENTATION	"\x10""udp-segmentation"
 #define C_UDP_WORKERS		"\x0B""udp-workers"
 #define C_UNSAFE_OPERATION	"\x10""unsafe-operation"
 #define C_UPDATE_OWNER		"\x0C""update-owner"
@@ -181,6 +188,7 @@
 #define C_ZONE			"\x04""zone"
 #define C_ZONEFILE_LOAD		"\x0D""zonefile-load"
 #define C_ZONEFILE_SKIP		"\x0D""zonefile-skip"
+#define C_ZONEFILE_SNAPSHOT	"\x11""zonefile-snapshot"
 #define C_ZONEFILE_SYNC		"\x0D""zonefile-sync"
 #define C_ZONEMD_GENERATE	"\x0F""zonemd-generate"
 #define C_ZONEMD_VERIFY		"\x0D""zonemd-verify"
@@ -241,6 +249,11 @@ enum {
 	JOURNAL_CONTENT_ALL     = 2,
 };
 
+enum {
+	JOURNAL_COMPRESSION_NONE = 0,
+	JOURNAL_COMPRESSION_ZSTD = 1,
+};
+
 enum {
 	JOURNAL_MODE_ROBUST = 0, // Robust journal DB disk synchronization.
 	JOURNAL_MODE_ASYNC  = 1, // Asynchronous journal DB disk synchronization.
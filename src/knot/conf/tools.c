@@ -628,6 +628,14 @@ int check_server(
 		return KNOT_EINVAL;
 	}
 
+#ifndef ENABLE_IO_URING
+	conf_val_t io_uring = conf_get_txn(args->extra->conf, args->extra->txn,
+	                                   C_SRV, C_IO_URING);
+	if (conf_bool(&io_uring)) {
+		CONF_LOG(LOG_WARNING, "io_uring not available, using epoll");
+	}
+#endif
+
 	conf_val_t listls_val = conf_get_txn(args->extra->conf, args->extra->txn,
 	                                     C_SRV, C_LISTEN_TLS);
 	size_t listls_count = conf_val_count(&listls_val);
@@ -1095,6 +1103,13 @@ static int check_zone_or_tpl(
 		}
 	}
 
+#ifndef ENABLE_JOURNAL_COMPRESSION
+	conf_val_t compression = conf_get_wrap(args, C_JOURNAL_COMPRESSION);
+	if (conf_opt(&compression) != JOURNAL_COMPRESSION_NONE) {
+		CONF_LOG(LOG_WARNING, "journal compression not available, storing uncompressed");
+	}
+#endif
+
 	conf_val_t signing = conf_get_wrap(args, C_DNSSEC_SIGNING);
 	if (conf_bool(&signing)) {
 		conf_val_t validation = conf_get_wrap(args, C_DNSSEC_VALIDATION);
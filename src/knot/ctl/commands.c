@@ -52,6 +52,9 @@ typedef struct {
 	char ttl[16];
 	char type[32];
 	char rdata[2 * 65536];
+	bool binary; // Send the records in wire format in binary units.
+	size_t bin_len;
+	uint8_t bin[KNOT_CTL_BIN_MAX];
 } send_ctx_t;
 
 static struct {
@@ -1023,6 +1026,9 @@ static int init_send_ctx(send_ctx_t *ctx, const knot_dname_t *zone_name,
 
 	ctx->args = args;
 
+	ctx->binary = false;
+	ctx->bin_len = 0;
+
 	// Set the dump style.
 	ctx->style.show_ttl = true;
 	ctx->style.original_ttl = true;
@@ -1054,8 +1060,68 @@ static int init_send_ctx(send_ctx_t *ctx, const knot_dname_t *zone_name,
 	return KNOT_EOK;
 }
 
+static int send_bin_flush(send_ctx_t *ctx)
+{
+	if (ctx->bin_len == 0) {
+		return KNOT_EOK;
+	}
+
+	int ret = knot_ctl_send_bin(ctx->args->ctl, ctx->bin, ctx->bin_len);
+	ctx->bin_len = 0;
+
+	return ret;
+}
+
+static int send_bin_put(const knot_rrset_t *rrset, send_ctx_t *ctx)
+{
+	while (true) {
+		int ret = knot_rrset_to_wire_extra(rrset, ctx->bin + ctx->bin_len,
+		                                   sizeof(ctx->bin) - ctx->bin_len,
+		                                   0, NULL, KNOT_PF_ORIGTTL);
+		if (ret >= 0) {
+			ctx->bin_len += ret;
+			return KNOT_EOK;
+		} else if (ret != KNOT_ESPACE || ctx->bin_len == 0) {
+			return ret;
+		}
+
+		// Retry with an empty unit.
+		ret = send_bin_flush(ctx);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+}
+
+static int send_rrset_bin(knot_rrset_t *rrset, send_ctx_t *ctx)
+{
+	int ret = send_bin_put(rrset, ctx);
+	if (ret != KNOT_ESPACE) {
+		return ret;
+	}
+
+	// The rrset doesn't fit into one unit, split it into single records.
+	knot_rrset_t rr = *rrset;
+	rr.rrs.count = 1;
+	rr.rrs.rdata = rrset->rrs.rdata;
+	for (size_t i = 0; i < rrset->rrs.count; ++i) {
+		rr.rrs.size = knot_rdata_size(rr.rrs.rdata->len);
+		ret = send_bin_put(&rr, ctx);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+		rr.rrs.rdata = knot_rdataset_next(rr.rrs.rdata);
+	}
+
+	return KNOT_EOK;
+}
+
 static int send_rrset(knot_rrset_t *rrset, send_ctx_t *ctx)
 {
+	if (ctx->binary) {
+		return send_rrset_bin(rrset, ctx);
+	}
+
 	if (rrset->type != KNOT_RRTYPE_RRSIG) {
 		int ret = snprintf(ctx->ttl, sizeof(ctx->ttl), "%u", rrset->ttl);
 		if (ret <= 0 || ret >= sizeof(ctx->ttl)) {
@@ -1094,7 +1160,8 @@ static int send_rrset(knot_rrset_t *rrset, send_ctx_t *ctx)
 static int send_node(zone_node_t *node, void *ctx_void)
 {
 	send_ctx_t *ctx = ctx_void;
-	if (knot_dname_to_str(ctx->owner, node->owner, sizeof(ctx->owner)) == NULL) {
+	if (!ctx->binary &&
+	    knot_dname_to_str(ctx->owner, node->owner, sizeof(ctx->owner)) == NULL) {
 		return KNOT_EINVAL;
 	}
 
@@ -1164,6 +1231,7 @@ static int zone_read(zone_t *zone, ctl_args_t *args)
 	if (ret != KNOT_EOK) {
 		return ret;
 	}
+	ctx->binary = ctl_has_flag(args->data[KNOT_CTL_IDX_FLAGS], CTL_FLAG_BINARY);
 
 	rcu_read_lock();
 	zone_contents_t *contents = zone->contents;
@@ -1191,6 +1259,10 @@ static int zone_read(zone_t *zone, ctl_args_t *args)
 	}
 	rcu_read_unlock();
 
+	if (ret == KNOT_EOK) {
+		ret = send_bin_flush(ctx);
+	}
+
 	return ret;
 }
 
@@ -1207,6 +1279,9 @@ static int zone_flag_txn_get(zone_t *zone, ctl_args_t *args, const char *flag)
 		return ret;
 	}
 	ctx->data[KNOT_CTL_IDX_FLAGS] = flag;
+	// The binary format has no room for the diff sign.
+	ctx->binary = (flag == NULL) &&
+	              ctl_has_flag(args->data[KNOT_CTL_IDX_FLAGS], CTL_FLAG_BINARY);
 
 	if (args->data[KNOT_CTL_IDX_OWNER] != NULL) {
 		knot_dname_storage_t owner;
@@ -1235,6 +1310,10 @@ static int zone_flag_txn_get(zone_t *zone, ctl_args_t *args, const char *flag)
 		zone_tree_it_free(&it);
 	}
 
+	if (ret == KNOT_EOK) {
+		ret = send_bin_flush(ctx);
+	}
+
 	return ret;
 }
 
@@ -1530,6 +1609,100 @@ static int zone_txn_unset(zone_t *zone, ctl_args_t *args)
 	return ret;
 }
 
+static int txn_bin_apply(zone_update_t *update, knot_rrset_t *rrset, bool add)
+{
+	if (knot_rrset_empty(rrset)) {
+		return KNOT_EOK;
+	}
+
+	int ret = add ? zone_update_add(update, rrset) : zone_update_remove(update, rrset);
+	knot_rrset_clear(rrset, NULL);
+
+	return ret;
+}
+
+static int zone_txn_bin_l(zone_t *zone, ctl_args_t *args, bool add)
+{
+	if (zone->control_update == NULL) {
+		return KNOT_TXN_ENOTEXISTS;
+	}
+
+	size_t len;
+	const uint8_t *wire = knot_ctl_bin(args->ctl, &len);
+
+	knot_rrset_t rrset, rr;
+	knot_rrset_init_empty(&rrset);
+
+	int ret = KNOT_EOK;
+	size_t pos = 0;
+	while (ret == KNOT_EOK && pos < len) {
+		knot_rrset_init_empty(&rr);
+		ret = knot_rrset_rr_from_wire(wire, &pos, len, &rr, NULL, true);
+		if (ret != KNOT_EOK) {
+			break;
+		}
+
+		if (rr.rclass != KNOT_CLASS_IN) {
+			ret = KNOT_ENOTSUP;
+		} else if (knot_dname_in_bailiwick(rr.owner, zone->name) < 0) {
+			ret = KNOT_EOUTOFZONE;
+		} else if (!knot_rrset_empty(&rrset) && rr.type == rrset.type &&
+		           rr.ttl == rrset.ttl && knot_dname_is_equal(rr.owner, rrset.owner)) {
+			// Join consecutive records of the same rrset.
+			ret = knot_rdataset_merge(&rrset.rrs, &rr.rrs, NULL);
+		} else {
+			ret = txn_bin_apply(zone->control_update, &rrset, add);
+			rrset = rr;
+			continue;
+		}
+		knot_rrset_clear(&rr, NULL);
+	}
+	if (ret == KNOT_EOK) {
+		ret = txn_bin_apply(zone->control_update, &rrset, add);
+	}
+	knot_rrset_clear(&rrset, NULL);
+
+	return ret;
+}
+
+static int zones_apply_bin(ctl_args_t *args, bool add)
+{
+	// The binary units follow, only one specific zone is allowed.
+	zone_t *zone = NULL;
+	int ret = KNOT_EINVAL;
+	if (args->data[KNOT_CTL_IDX_ZONE] != NULL) {
+		ret = get_zone(args, &zone);
+	}
+
+	while (ret == KNOT_EOK) {
+		ret = knot_ctl_receive(args->ctl, &args->type, &args->data);
+		if (ret != KNOT_EOK) {
+			return ret;
+		} else if (args->type != KNOT_CTL_TYPE_BIN) {
+			return KNOT_EOK;
+		}
+
+		pthread_mutex_lock(&zone->cu_lock);
+		ret = zone_txn_bin_l(zone, args, add);
+		pthread_mutex_unlock(&zone->cu_lock);
+	}
+
+	// The remaining binary units are skipped by the caller.
+	knot_dname_txt_storage_t name;
+	if (zone != NULL) {
+		args->data[KNOT_CTL_IDX_ZONE] = knot_dname_to_str(name, zone->name, sizeof(name));
+	}
+	if (args->data[KNOT_CTL_IDX_ZONE] != NULL) {
+		log_ctl_zone_str_error(args->data[KNOT_CTL_IDX_ZONE],
+		                       "control, error (%s)", knot_strerror(ret));
+	} else {
+		log_ctl_error("control, error (%s)", knot_strerror(ret));
+	}
+	ctl_send_error(args, knot_strerror(ret));
+
+	return ret;
+}
+
 static bool zone_exists(const knot_dname_t *zone, void *data)
 {
 	assert(zone);
@@ -1939,8 +2112,14 @@ static int ctl_zone(ctl_args_t *args, ctl_cmd_t cmd)
 	case CTL_ZONE_GET:
 		return zones_apply(args, zone_txn_get);
 	case CTL_ZONE_SET:
+		if (ctl_has_flag(args->data[KNOT_CTL_IDX_FLAGS], CTL_FLAG_BINARY)) {
+			return zones_apply_bin(args, true);
+		}
 		return zones_apply(args, zone_txn_set);
 	case CTL_ZONE_UNSET:
+		if (ctl_has_flag(args->data[KNOT_CTL_IDX_FLAGS], CTL_FLAG_BINARY)) {
+			return zones_apply_bin(args, false);
+		}
 		return zones_apply(args, zone_txn_unset);
 	case CTL_ZONE_PURGE:
 		if (MATCH_AND_FILTER(args, CTL_FILTER_PURGE_ORPHAN)) {
@@ -1977,6 +2156,39 @@ static int check_no_zone_txn(server_t *server, const char *action)
 	return KNOT_EOK;
 }
 
+static int queue_wait_status(worker_pool_t *workers, char *buff, size_t buff_len)
+{
+	static const char *prio_names[WORKER_PRIO_COUNT] = { "high", "normal" };
+	static const char *bucket_names[WORKER_WAIT_BUCKETS] = {
+		"<1ms", "<10ms", "<100ms", "<1s", "<10s", ">=10s"
+	};
+
+	size_t len = 0;
+	for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+		uint64_t hist[WORKER_WAIT_BUCKETS];
+		worker_pool_wait_hist(workers, prio, hist);
+
+		int ret = snprintf(buff + len, buff_len - len, "%s%s priority:",
+		                   (prio > 0) ? "\n" : "", prio_names[prio]);
+		if (ret <= 0 || ret >= buff_len - len) {
+			return -1;
+		}
+		len += ret;
+
+		for (unsigned i = 0; i < WORKER_WAIT_BUCKETS; i++) {
+			ret = snprintf(buff + len, buff_len - len, " %s %"PRIu64"%s",
+			               bucket_names[i], hist[i],
+			               (i + 1 < WORKER_WAIT_BUCKETS) ? "," : "");
+			if (ret <= 0 || ret >= buff_len - len) {
+				return -1;
+			}
+			len += ret;
+		}
+	}
+
+	return len;
+}
+
 static int server_status(ctl_args_t *args)
 {
 	const char *type = args->data[KNOT_CTL_IDX_TYPE];
@@ -1992,12 +2204,14 @@ static int server_status(ctl_args_t *args)
 		ret = snprintf(buff, sizeof(buff), "%s", PACKAGE_VERSION);
 	} else if (strcasecmp(type, CMD_STATUS_WORKERS) == 0) {
 		int running_bkg_wrk, wrk_queue;
-		worker_pool_status(args->server->workers, false, &running_bkg_wrk, &wrk_queue);
+		worker_pool_status(args->server->workers, &running_bkg_wrk, &wrk_queue);
 		ret = snprintf(buff, sizeof(buff), "UDP workers: %zu, TCP workers: %zu, "
 		               "XDP workers: %zu, background workers: %zu (running: %d, pending: %d)",
 		               conf()->cache.srv_udp_threads, conf()->cache.srv_tcp_threads,
 		               conf()->cache.srv_xdp_threads, conf()->cache.srv_bg_threads,
 		               running_bkg_wrk, wrk_queue);
+	} else if (strcasecmp(type, CMD_STATUS_QUEUE) == 0) {
+		ret = queue_wait_status(args->server->workers, buff, sizeof(buff));
 	} else if (strcasecmp(type, CMD_STATUS_CONFIG) == 0) {
 		ret = snprintf(buff, sizeof(buff), "%s", configure_summary);
 	} else if (strcasecmp(type, CMD_STATUS_CERT) == 0) {
@@ -10,6 +10,7 @@
 
 #define CTL_FLAG_FORCE			"F"
 #define CTL_FLAG_BLOCKING		"B"
+#define CTL_FLAG_BINARY			"W"
 
 #define CTL_FILTER_DIFF_ADD_R		"+"
 #define CTL_FILTER_DIFF_REM_R		"-"
@@ -64,6 +65,7 @@
 #define CMD_STATUS_WORKERS              "workers"
 #define CMD_STATUS_CONFIG               "configure"
 #define CMD_STATUS_CERT                 "cert-key"
+#define CMD_STATUS_QUEUE                "queue-wait"
 
 /*! 'zone-key-rollover' command key types. */
 #define CMD_ROLLOVER_KSK                "ksk"
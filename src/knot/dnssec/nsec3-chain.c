@@ -213,29 +213,25 @@ static zone_node_t *create_nsec3_node(const knot_dname_t *owner,
 /*!
  * \brief Create new NSEC3 node for given regular node.
  *
- * \param node       Node for which the NSEC3 node is created.
- * \param apex       Zone apex node.
- * \param params     NSEC3 hash function parameters.
- * \param ttl        TTL of the new NSEC3 node.
+ * \param node         Node for which the NSEC3 node is created.
+ * \param nsec3_owner  Hashed owner of the node.
+ * \param apex         Zone apex node.
+ * \param params       NSEC3 hash function parameters.
+ * \param ttl          TTL of the new NSEC3 node.
  *
  * \return Error code, KNOT_EOK if successful.
  */
 static zone_node_t *create_nsec3_node_for_node(const zone_node_t *node,
+                                               const knot_dname_t *nsec3_owner,
                                                zone_node_t *apex,
                                                const dnssec_nsec3_params_t *params,
                                                uint32_t ttl)
 {
 	assert(node);
+	assert(nsec3_owner);
 	assert(apex);
 	assert(params);
 
-	knot_dname_storage_t nsec3_owner;
-	int ret = knot_create_nsec3_owner(nsec3_owner, sizeof(nsec3_owner),
-	                                  node->owner, apex->owner, params);
-	if (ret != KNOT_EOK) {
-		return NULL;
-	}
-
 	dnssec_nsec_bitmap_t *rr_types = dnssec_nsec_bitmap_new();
 	if (!rr_types) {
 		return NULL;
@@ -387,6 +383,38 @@ static int reconnect_nsec3_nodes2(zone_node_t *a, zone_node_t *b,
 	return ret;
 }
 
+/*!
+ * \brief Create NSEC3 nodes for a batch of regular nodes, hashing their owners at once.
+ */
+static int create_nsec3_batch(const zone_node_t **nodes, size_t count,
+                              zone_node_t *apex,
+                              const dnssec_nsec3_params_t *params,
+                              uint32_t ttl,
+                              zone_tree_t *nsec3_nodes)
+{
+	const knot_dname_t *owners[KNOT_NSEC3_HASH_BATCH];
+	for (size_t i = 0; i < count; i++) {
+		owners[i] = nodes[i]->owner;
+	}
+
+	knot_dname_storage_t nsec3_owners[KNOT_NSEC3_HASH_BATCH];
+	int result = knot_create_nsec3_owners(nsec3_owners, owners, count,
+	                                      apex->owner, params);
+
+	for (size_t i = 0; i < count && result == KNOT_EOK; i++) {
+		zone_node_t *nsec3_node;
+		nsec3_node = create_nsec3_node_for_node(nodes[i], nsec3_owners[i],
+		                                        apex, params, ttl);
+		if (!nsec3_node) {
+			return KNOT_ENOMEM;
+		}
+
+		result = zone_tree_insert(nsec3_nodes, &nsec3_node);
+	}
+
+	return result;
+}
+
 /*!
  * \brief Create NSEC3 node for each regular node in the zone.
  *
@@ -412,74 +440,102 @@ static int create_nsec3_nodes(const zone_contents_t *zone,
 	zone_tree_delsafe_it_t it = { 0 };
 	int result = zone_tree_delsafe_it_begin(zone->nodes, &it, false); // delsafe - removing nodes that contain only NSEC+RRSIG
 
-	while (!zone_tree_delsafe_it_finished(&it)) {
-		zone_node_t *node = zone_tree_delsafe_it_val(&it);
-
-		/*!
-		 * Remove possible NSEC from the node. (Do not allow both NSEC
-		 * and NSEC3 in the zone at once.)
-		 */
-		result = knot_nsec_changeset_remove(node, update);
-		if (result != KNOT_EOK) {
-			break;
-		}
-		if (node->flags & NODE_FLAGS_NONAUTH || nsec3_empty(node, params) || node->flags & NODE_FLAGS_DELETED) {
-			zone_tree_delsafe_it_next(&it);
-			continue;
-		}
+	/*!
+	 * Remove possible NSEC from the nodes first. (Do not allow both NSEC
+	 * and NSEC3 in the zone at once.) As this may remove whole nodes,
+	 * the NSEC3 nodes are created in a separate pass.
+	 */
+	while (!zone_tree_delsafe_it_finished(&it) && result == KNOT_EOK) {
+		result = knot_nsec_changeset_remove(zone_tree_delsafe_it_val(&it), update);
+		zone_tree_delsafe_it_next(&it);
+	}
+	zone_tree_delsafe_it_free(&it);
+	if (result != KNOT_EOK) {
+		return result;
+	}
 
-		zone_node_t *nsec3_node;
-		nsec3_node = create_nsec3_node_for_node(node, zone->apex,
-							params, ttl);
-		if (!nsec3_node) {
-			result = KNOT_ENOMEM;
-			break;
-		}
+	zone_tree_it_t it2 = { 0 };
+	result = zone_tree_it_begin(zone->nodes, &it2);
 
-		result = zone_tree_insert(nsec3_nodes, &nsec3_node);
-		if (result != KNOT_EOK) {
-			break;
+	const zone_node_t *batch[KNOT_NSEC3_HASH_BATCH];
+	size_t count = 0;
+	while (!zone_tree_it_finished(&it2) && result == KNOT_EOK) {
+		zone_node_t *node = zone_tree_it_val(&it2);
+		if (!(node->flags & NODE_FLAGS_NONAUTH || nsec3_empty(node, params) || node->flags & NODE_FLAGS_DELETED)) {
+			batch[count++] = node;
+			if (count == KNOT_NSEC3_HASH_BATCH) {
+				result = create_nsec3_batch(batch, count, zone->apex,
+				                            params, ttl, nsec3_nodes);
+				count = 0;
+			}
 		}
-
-		zone_tree_delsafe_it_next(&it);
+		zone_tree_it_next(&it2);
 	}
-
-	zone_tree_delsafe_it_free(&it);
+	if (result == KNOT_EOK && count > 0) {
+		result = create_nsec3_batch(batch, count, zone->apex, params,
+		                            ttl, nsec3_nodes);
+	}
+	zone_tree_it_free(&it2);
 
 	return result;
 }
 
+/*! \brief State of a node whose NSEC3 shall be fixed. */
+typedef struct {
+	const knot_dname_t *owner;
+	const zone_node_t *old_n;
+	const zone_node_t *new_n;
+	bool had_no_nsec;
+	bool shall_no_nsec;
+} nsec3_fix_t;
+
 /*!
- * \brief For given dname, check if anything changed in zone_update, and recreate (possibly unconnected) NSEC3 nodes appropriately.
+ * \brief For given dname, check if anything changed in zone_update.
  *
  * \param update    Zone update structure holding zone contents changes.
  * \param params    NSEC3 params.
- * \param ttl       TTL for newly created NSEC3 records.
  * \param for_node  Domain name of the node in question.
+ * \param fix       Output state of the node.
  *
- * \retval KNOT_ENORECORD if the NSEC3 chain shall be rather recreated completely.
- * \return KNOT_EOK, KNOT_E* if any error.
+ * \return True if the NSEC3 node shall be fixed.
  */
-static int fix_nsec3_for_node(zone_update_t *update, const dnssec_nsec3_params_t *params,
-                              uint32_t ttl, const knot_dname_t *for_node)
+static bool fix_nsec3_needed(zone_update_t *update, const dnssec_nsec3_params_t *params,
+                             const knot_dname_t *for_node, nsec3_fix_t *fix)
 {
-	// check if we need to do something
 	const zone_node_t *old_n = zone_contents_find_node(update->zone->contents, for_node);
 	const zone_node_t *new_n = zone_contents_find_node(update->new_cont, for_node);
 
-	bool had_no_nsec = (old_n == NULL || old_n->nsec3_node == NULL || !(old_n->flags & NODE_FLAGS_NSEC3_NODE));
-	bool shall_no_nsec = (new_n == NULL || new_n->flags & NODE_FLAGS_NONAUTH || nsec3_empty(new_n, params) || new_n->flags & NODE_FLAGS_DELETED);
+	*fix = (nsec3_fix_t) {
+		.owner = for_node,
+		.old_n = old_n,
+		.new_n = new_n,
+		.had_no_nsec = (old_n == NULL || old_n->nsec3_node == NULL || !(old_n->flags & NODE_FLAGS_NSEC3_NODE)),
+		.shall_no_nsec = (new_n == NULL || new_n->flags & NODE_FLAGS_NONAUTH || nsec3_empty(new_n, params) || new_n->flags & NODE_FLAGS_DELETED),
+	};
 
-	if (had_no_nsec == shall_no_nsec && node_bitmap_equal(old_n, new_n)) {
-		return KNOT_EOK;
-	}
+	return !(fix->had_no_nsec == fix->shall_no_nsec && node_bitmap_equal(old_n, new_n));
+}
 
-	knot_dname_storage_t for_node_hashed;
-	int ret = knot_create_nsec3_owner(for_node_hashed, sizeof(for_node_hashed),
-	                                  for_node, update->new_cont->apex->owner, params);
-	if (ret != KNOT_EOK) {
-		return ret;
-	}
+/*!
+ * \brief Recreate (possibly unconnected) NSEC3 node for a changed node appropriately.
+ *
+ * \param update           Zone update structure holding zone contents changes.
+ * \param params           NSEC3 params.
+ * \param ttl              TTL for newly created NSEC3 records.
+ * \param fix              State of the node from fix_nsec3_needed().
+ * \param for_node_hashed  Hashed owner of the node.
+ *
+ * \retval KNOT_ENORECORD if the NSEC3 chain shall be rather recreated completely.
+ * \return KNOT_EOK, KNOT_E* if any error.
+ */
+static int fix_nsec3_for_node(zone_update_t *update, const dnssec_nsec3_params_t *params,
+                              uint32_t ttl, const nsec3_fix_t *fix,
+                              const knot_dname_t *for_node_hashed)
+{
+	const zone_node_t *new_n = fix->new_n;
+	bool had_no_nsec = fix->had_no_nsec;
+	bool shall_no_nsec = fix->shall_no_nsec;
+	int ret = KNOT_EOK;
 
 	// saved hash of next node
 	uint8_t *next_hash = NULL;
@@ -504,7 +560,8 @@ static int fix_nsec3_for_node(zone_update_t *update, const dnssec_nsec3_params_t
 
 	// add NSEC3 with correct bitmap
 	if (!shall_no_nsec && ret == KNOT_EOK) {
-		zone_node_t *new_nsec3_n = create_nsec3_node_for_node(new_n, update->new_cont->apex, params, ttl);
+		zone_node_t *new_nsec3_n = create_nsec3_node_for_node(new_n, for_node_hashed,
+		                                                      update->new_cont->apex, params, ttl);
 		if (new_nsec3_n == NULL) {
 			return KNOT_ENOMEM;
 		}
@@ -533,6 +590,25 @@ static int fix_nsec3_for_node(zone_update_t *update, const dnssec_nsec3_params_t
 	return ret;
 }
 
+static int fix_nsec3_batch(zone_update_t *update, const dnssec_nsec3_params_t *params,
+                           uint32_t ttl, const nsec3_fix_t *batch, size_t count)
+{
+	const knot_dname_t *owners[KNOT_NSEC3_HASH_BATCH];
+	for (size_t i = 0; i < count; i++) {
+		owners[i] = batch[i].owner;
+	}
+
+	knot_dname_storage_t hashed[KNOT_NSEC3_HASH_BATCH];
+	int ret = knot_create_nsec3_owners(hashed, owners, count,
+	                                   update->new_cont->apex->owner, params);
+
+	for (size_t i = 0; i < count && ret == KNOT_EOK; i++) {
+		ret = fix_nsec3_for_node(update, params, ttl, &batch[i], hashed[i]);
+	}
+
+	return ret;
+}
+
 static int fix_nsec3_nodes(zone_update_t *update, const dnssec_nsec3_params_t *params,
                            uint32_t ttl)
 {
@@ -541,11 +617,21 @@ static int fix_nsec3_nodes(zone_update_t *update, const dnssec_nsec3_params_t *p
 	zone_tree_it_t it = { 0 };
 	int ret = zone_tree_it_begin(update->a_ctx->node_ptrs, &it);
 
+	// Changes of NSEC3 nodes don't affect the checks of the regular ones.
+	nsec3_fix_t batch[KNOT_NSEC3_HASH_BATCH];
+	size_t count = 0;
 	while (!zone_tree_it_finished(&it) && ret == KNOT_EOK) {
 		zone_node_t *n = zone_tree_it_val(&it);
-		ret = fix_nsec3_for_node(update, params, ttl, n->owner);
+		if (fix_nsec3_needed(update, params, n->owner, &batch[count]) &&
+		    ++count == KNOT_NSEC3_HASH_BATCH) {
+			ret = fix_nsec3_batch(update, params, ttl, batch, count);
+			count = 0;
+		}
 		zone_tree_it_next(&it);
 	}
+	if (ret == KNOT_EOK && count > 0) {
+		ret = fix_nsec3_batch(update, params, ttl, batch, count);
+	}
 	zone_tree_it_free(&it);
 
 	return ret;
@@ -672,7 +758,7 @@ int knot_nsec3_fix_chain(zone_update_t *update,
 
 	// ensure that nsec3 node for zone root is in list of changed nodes
 	const zone_node_t *nsec3_for_root = NULL, *unused;
-	ret = zone_contents_find_nsec3_for_name(update->new_cont, update->zone->name, &nsec3_for_root, &unused);
+	ret = zone_contents_find_nsec3_for_name(update->new_cont, update->zone->name, &nsec3_for_root, &unused, NULL);
 	if (ret >= 0) {
 		assert(ret == ZONE_NAME_FOUND);
 		assert(!(nsec3_for_root->flags & NODE_FLAGS_DELETED));
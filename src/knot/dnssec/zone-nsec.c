@@ -72,6 +72,40 @@ int knot_create_nsec3_owner(uint8_t *out, size_t out_size,
 	return ret;
 }
 
+int knot_create_nsec3_owners(knot_dname_storage_t *out, const knot_dname_t **owners,
+                             size_t count, const knot_dname_t *zone_apex,
+                             const dnssec_nsec3_params_t *params)
+{
+	if (out == NULL || owners == NULL || count > KNOT_NSEC3_HASH_BATCH ||
+	    zone_apex == NULL || params == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	size_t hash_size = dnssec_nsec3_hash_length(params->algorithm);
+	if (hash_size == 0) {
+		return KNOT_EINVAL;
+	}
+
+	dnssec_binary_t data[KNOT_NSEC3_HASH_BATCH];
+	for (size_t i = 0; i < count; i++) {
+		data[i].data = (uint8_t *)owners[i];
+		data[i].size = knot_dname_size(owners[i]);
+	}
+
+	uint8_t hashes[KNOT_NSEC3_HASH_BATCH * hash_size];
+	int ret = dnssec_nsec3_hash_many(data, count, params, hashes);
+	if (ret != DNSSEC_EOK) {
+		return knot_error_from_libdnssec(ret);
+	}
+
+	for (size_t i = 0; i < count && ret == KNOT_EOK; i++) {
+		ret = knot_nsec3_hash_to_dname(out[i], sizeof(out[i]), hashes + i * hash_size,
+		                               hash_size, zone_apex);
+	}
+
+	return ret;
+}
+
 knot_dname_t *node_nsec3_hash(zone_node_t *node, const zone_contents_t *zone)
 {
 	if (node->nsec3_hash == NULL && knot_is_nsec3_enabled(zone)) {
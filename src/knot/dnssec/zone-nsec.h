@@ -48,6 +48,9 @@ inline static size_t zone_nsec3_name_len(const zone_contents_t *zone)
 int knot_nsec3_hash_to_dname(uint8_t *out, size_t out_size, const uint8_t *hash,
                              size_t hash_size, const knot_dname_t *zone_apex);
 
+/*! \brief Number of names hashed at once when building NSEC3 chain. */
+#define KNOT_NSEC3_HASH_BATCH 16
+
 /*!
  * \brief Create NSEC3 owner name from regular owner name.
  *
@@ -63,6 +66,21 @@ int knot_create_nsec3_owner(uint8_t *out, size_t out_size,
                             const knot_dname_t *owner, const knot_dname_t *zone_apex,
                             const dnssec_nsec3_params_t *params);
 
+/*!
+ * \brief Create NSEC3 owner names from several regular owner names at once.
+ *
+ * \param out        Output name buffers.
+ * \param owners     Node owner names.
+ * \param count      Number of names (at most KNOT_NSEC3_HASH_BATCH).
+ * \param zone_apex  Zone apex name.
+ * \param params     Params for NSEC3 hashing function.
+ *
+ * \return Error code, KNOT_EOK if successful.
+ */
+int knot_create_nsec3_owners(knot_dname_storage_t *out, const knot_dname_t **owners,
+                             size_t count, const knot_dname_t *zone_apex,
+                             const dnssec_nsec3_params_t *params);
+
 /*!
  * \brief Return (and compute of needed) the corresponding NSEC3 node's name.
  *
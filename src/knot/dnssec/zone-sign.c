@@ -18,6 +18,8 @@
 #include "knot/dnssec/zone-sign.h"
 #include "libknot/libknot.h"
 #include "libknot/dynarray.h"
+#include "contrib/spinlock.h"
+#include "contrib/time.h"
 #include "contrib/wire_ctx.h"
 
 typedef struct {
@@ -522,17 +524,37 @@ static int sign_node_rrsets(const zone_node_t *node,
 	return result;
 }
 
+/*! \brief Number of tree parts per signing thread, see zone_tree_sign(). */
+#define SIGN_PARTS_PER_THREAD 16
+
+/*!
+ * \brief Contiguous range of tree parts owned by one signing thread.
+ *
+ * The owner takes parts from the front, other threads steal from the back.
+ */
+typedef struct {
+	knot_spin_t lock;
+	size_t next;
+	size_t end;
+} sign_range_t;
+
 /*!
  * \brief Struct to carry data for 'sign_data' callback function.
  */
 typedef struct {
 	zone_tree_t *tree;
+	trie_part_t **parts;
+	sign_range_t *ranges;
 	zone_sign_ctx_t *sign_ctx;
 	changeset_t changeset;
 	dnssec_validation_hint_t *hint;
 	size_t num_threads;
 	size_t thread_index;
-	size_t rrset_index;
+	size_t nodes;
+	size_t rrsets;
+	size_t parts_done;
+	size_t parts_stolen;
+	double duration_ms;
 	int errcode;
 	int thread_init_errcode;
 	pthread_t thread;
@@ -555,17 +577,68 @@ static int sign_node(zone_node_t *node, void *data)
 		return KNOT_EOK;
 	}
 
-	if (args->rrset_index++ % args->num_threads != args->thread_index) {
-		return KNOT_EOK;
-	}
+	args->nodes++;
+	args->rrsets += node->rrset_count;
 
 	return sign_node_rrsets(node, args->sign_ctx, &args->changeset, args->hint);
 }
 
+static bool range_take_front(sign_range_t *range, size_t *part)
+{
+	bool found = false;
+	knot_spin_lock(&range->lock);
+	if (range->next < range->end) {
+		*part = range->next++;
+		found = true;
+	}
+	knot_spin_unlock(&range->lock);
+	return found;
+}
+
+static bool range_take_back(sign_range_t *range, size_t *part)
+{
+	bool found = false;
+	knot_spin_lock(&range->lock);
+	if (range->next < range->end) {
+		*part = --range->end;
+		found = true;
+	}
+	knot_spin_unlock(&range->lock);
+	return found;
+}
+
+static bool take_part(node_sign_args_t *args, size_t *part)
+{
+	if (range_take_front(&args->ranges[args->thread_index], part)) {
+		return true;
+	}
+
+	// Own range exhausted, steal from the other threads.
+	for (size_t i = 1; i < args->num_threads; i++) {
+		size_t victim = (args->thread_index + i) % args->num_threads;
+		if (range_take_back(&args->ranges[victim], part)) {
+			args->parts_stolen++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static void *tree_sign_thread(void *_arg)
 {
 	node_sign_args_t *arg = _arg;
-	arg->errcode = zone_tree_apply(arg->tree, sign_node, _arg);
+	struct timespec started = time_now();
+
+	size_t part;
+	while (arg->errcode == KNOT_EOK && take_part(arg, &part)) {
+		arg->errcode = zone_tree_part_apply(arg->tree, arg->parts[part],
+		                                    sign_node, arg);
+		arg->parts_done++;
+	}
+
+	struct timespec finished = time_now();
+	arg->duration_ms = time_diff_ms(&started, &finished);
 	return NULL;
 }
 
@@ -575,9 +648,32 @@ static int set_signed(zone_node_t *node, _unused_ void *data)
 	return KNOT_EOK;
 }
 
+static void log_sign_threads(const kdnssec_ctx_t *dnssec_ctx, node_sign_args_t *args)
+{
+	for (size_t i = 0; i < args[0].num_threads; i++) {
+		node_sign_args_t *arg = &args[i];
+		if (arg->thread_init_errcode != 0) {
+			continue;
+		}
+		double secs = arg->duration_ms / 1000.0;
+		log_zone_debug(dnssec_ctx->zone->dname,
+		               "DNSSEC, %s thread %zu, nodes %zu, RRsets %zu, "
+		               "parts %zu (stolen %zu), %0.2f seconds, %0.0f RRsets/s",
+		               dnssec_ctx->validation_mode ? "validation" : "signing",
+		               arg->thread_index, arg->nodes, arg->rrsets,
+		               arg->parts_done, arg->parts_stolen, secs,
+		               secs > 0 ? arg->rrsets / secs : 0.0);
+	}
+}
+
 /*!
  * \brief Update RRSIGs in a given zone tree by updating changeset.
  *
+ * The tree is split into parts (subtrees) which are distributed in contiguous
+ * ranges among the threads. A thread which finishes its own range steals
+ * parts from the ends of the ranges of the other threads, so every node
+ * is visited just once and uneven parts are balanced.
+ *
  * \param tree        Zone tree to be signed.
  * \param num_threads Number of threads to use for parallel signing.
  * \param zone_keys   Zone keys.
@@ -596,13 +692,34 @@ static int zone_tree_sign(zone_tree_t *tree,
 	assert(dnssec_ctx);
 	assert(update || dnssec_ctx->validation_mode);
 
+	if (zone_tree_is_empty(tree)) {
+		return KNOT_EOK;
+	}
+
+	size_t max_parts = num_threads * SIGN_PARTS_PER_THREAD * 2;
+	trie_part_t **parts = malloc(max_parts * sizeof(*parts));
+	sign_range_t *ranges = calloc(num_threads, sizeof(*ranges));
+	if (parts == NULL || ranges == NULL) {
+		free(parts);
+		free(ranges);
+		return KNOT_ENOMEM;
+	}
+	size_t num_parts = zone_tree_split(tree, parts, max_parts,
+	                                   num_threads * SIGN_PARTS_PER_THREAD);
+
 	int ret = KNOT_EOK;
 	node_sign_args_t args[num_threads];
 	memset(args, 0, sizeof(args));
 
 	// init context structures
 	for (size_t i = 0; i < num_threads; i++) {
+		knot_spin_init(&ranges[i].lock);
+		ranges[i].next = num_parts * i / num_threads;
+		ranges[i].end = num_parts * (i + 1) / num_threads;
+
 		args[i].tree = tree;
+		args[i].parts = parts;
+		args[i].ranges = ranges;
 		args[i].sign_ctx = dnssec_ctx->validation_mode
 		                 ? zone_validation_ctx(dnssec_ctx)
 		                 : zone_sign_ctx(zone_keys, dnssec_ctx);
@@ -617,7 +734,6 @@ static int zone_tree_sign(zone_tree_t *tree,
 		args[i].hint = &update->validation_hint;
 		args[i].num_threads = num_threads;
 		args[i].thread_index = i;
-		args[i].rrset_index = 0;
 		args[i].errcode = KNOT_EOK;
 		args[i].thread_init_errcode = -1;
 	}
@@ -625,7 +741,10 @@ static int zone_tree_sign(zone_tree_t *tree,
 		for (size_t i = 0; i < num_threads; i++) {
 			changeset_clear(&args[i].changeset);
 			zone_sign_ctx_free(args[i].sign_ctx);
+			knot_spin_destroy(&ranges[i].lock);
 		}
+		free(parts);
+		free(ranges);
 		return ret;
 	}
 
@@ -645,6 +764,8 @@ static int zone_tree_sign(zone_tree_t *tree,
 				args[i].thread_init_errcode = pthread_join(args[i].thread, NULL);
 			}
 		}
+
+		log_sign_threads(dnssec_ctx, args);
 	}
 
 	// collect return code and results
@@ -662,8 +783,12 @@ static int zone_tree_sign(zone_tree_t *tree,
 		assert(!dnssec_ctx->validation_mode || changeset_empty(&args[i].changeset));
 		changeset_clear(&args[i].changeset);
 		zone_sign_ctx_free(args[i].sign_ctx);
+		knot_spin_destroy(&ranges[i].lock);
 	}
 
+	free(parts);
+	free(ranges);
+
 	return ret;
 }
 
@@ -17,6 +17,7 @@
 #include "knot/zone/zone.h"
 
 #define ZONE_EVENT_IMMEDIATE 1 /* Fast-track to worker queue. */
+#define ZONE_EVENT_RETRY_MS 1000 /* Delay of the next try if not passed to a worker. */
 
 typedef int (*zone_event_cb)(conf_t *conf, zone_t *zone);
 
@@ -24,23 +25,24 @@ typedef struct event_info {
 	zone_event_type_t type;
 	const zone_event_cb callback;
 	const char *name;
+	worker_prio_t prio;
 } event_info_t;
 
 static const event_info_t EVENT_INFO[] = {
-	{ ZONE_EVENT_LOAD,         event_load,        "load" },
-	{ ZONE_EVENT_REFRESH,      event_refresh,     "refresh" },
-	{ ZONE_EVENT_UPDATE,       event_update,      "update" },
-	{ ZONE_EVENT_EXPIRE,       event_expire,      "expiration" },
-	{ ZONE_EVENT_FLUSH,        event_flush,       "flush" },
-	{ ZONE_EVENT_BACKUP,       event_backup,      "backup/restore" },
-	{ ZONE_EVENT_NOTIFY,       event_notify,      "notify" },
-	{ ZONE_EVENT_DNSSEC,       event_dnssec,      "re-sign" },
-	{ ZONE_EVENT_VALIDATE,     event_validate,    "DNSSEC-validate" },
-	{ ZONE_EVENT_UFREEZE,      event_ufreeze,     "update-freeze" },
-	{ ZONE_EVENT_UTHAW,        event_uthaw,       "update-thaw" },
-	{ ZONE_EVENT_DS_CHECK,     event_ds_check,    "DS-check" },
-	{ ZONE_EVENT_DS_PUSH,      event_ds_push,     "DS-push" },
-	{ ZONE_EVENT_DNSKEY_SYNC,  event_dnskey_sync, "DNSKEY-sync" },
+	{ ZONE_EVENT_LOAD,         event_load,        "load",            WORKER_PRIO_NORMAL },
+	{ ZONE_EVENT_REFRESH,      event_refresh,     "refresh",         WORKER_PRIO_HIGH },
+	{ ZONE_EVENT_UPDATE,       event_update,      "update",          WORKER_PRIO_HIGH },
+	{ ZONE_EVENT_EXPIRE,       event_expire,      "expiration",      WORKER_PRIO_HIGH },
+	{ ZONE_EVENT_FLUSH,        event_flush,       "flush",           WORKER_PRIO_NORMAL },
+	{ ZONE_EVENT_BACKUP,       event_backup,      "backup/restore",  WORKER_PRIO_NORMAL },
+	{ ZONE_EVENT_NOTIFY,       event_notify,      "notify",          WORKER_PRIO_HIGH },
+	{ ZONE_EVENT_DNSSEC,       event_dnssec,      "re-sign",         WORKER_PRIO_NORMAL },
+	{ ZONE_EVENT_VALIDATE,     event_validate,    "DNSSEC-validate", WORKER_PRIO_NORMAL },
+	{ ZONE_EVENT_UFREEZE,      event_ufreeze,     "update-freeze",   WORKER_PRIO_HIGH },
+	{ ZONE_EVENT_UTHAW,        event_uthaw,       "update-thaw",     WORKER_PRIO_HIGH },
+	{ ZONE_EVENT_DS_CHECK,     event_ds_check,    "DS-check",        WORKER_PRIO_NORMAL },
+	{ ZONE_EVENT_DS_PUSH,      event_ds_push,     "DS-push",         WORKER_PRIO_NORMAL },
+	{ ZONE_EVENT_DNSKEY_SYNC,  event_dnskey_sync, "DNSKEY-sync",     WORKER_PRIO_NORMAL },
 	{ 0 }
 };
 
@@ -62,6 +64,22 @@ static bool valid_event(zone_event_type_t type)
 	return (type > ZONE_EVENT_INVALID && type < ZONE_EVENT_COUNT);
 }
 
+/*!
+ * \brief Worker priority of the event, blocking events are always urgent.
+ */
+static worker_prio_t event_priority(zone_events_t *events, zone_event_type_t type)
+{
+	if (!valid_event(type)) {
+		return WORKER_PRIO_NORMAL;
+	}
+
+	if (events->blocking[type] != NULL) {
+		return WORKER_PRIO_HIGH;
+	}
+
+	return get_event_info(type)->prio;
+}
+
 bool ufreeze_applies(zone_event_type_t type)
 {
 	switch (type) {
@@ -249,6 +267,28 @@ static void event_wrap(worker_task_t *task)
 	reschedule(events, true); // unlocks events->mx
 }
 
+/*!
+ * \brief Pass the events task to a worker, release the events if it fails.
+ *
+ * \note Expects events->mx locked and events->running set.
+ */
+static int assign_task(zone_events_t *events, zone_event_type_t type)
+{
+	int ret = worker_pool_assign(events->pool, &events->task,
+	                             event_priority(events, type));
+	if (ret != KNOT_EOK) {
+		events->running = 0;
+		events->type = ZONE_EVENT_INVALID;
+
+		zone_t *zone = events->task.ctx;
+		log_zone_error(zone->name, "zone event '%s' not started, retrying (%s)",
+		               valid_event(type) ? get_event_info(type)->name : "none",
+		               knot_strerror(ret));
+	}
+
+	return ret;
+}
+
 /*!
  * \brief Called by scheduler thread if the event occurs.
  */
@@ -262,7 +302,9 @@ static void event_dispatch(event_t *event)
 	pthread_mutex_lock(&events->mx);
 	if (!events->running && !events->frozen) {
 		events->running = time(NULL);
-		worker_pool_assign(events->pool, &events->task);
+		if (assign_task(events, get_next_event(events)) != KNOT_EOK) {
+			evsched_schedule_again(event, ZONE_EVENT_RETRY_MS);
+		}
 	}
 	pthread_mutex_unlock(&events->mx);
 }
@@ -429,8 +471,11 @@ void zone_events_enqueue(zone_t *zone, zone_event_type_t type)
 		events->running = time(NULL);
 		events->type = type;
 		event_set_time(events, type, ZONE_EVENT_IMMEDIATE);
-		worker_pool_assign(events->pool, &events->task);
+		int ret = assign_task(events, type);
 		pthread_mutex_unlock(&events->mx);
+		if (ret != KNOT_EOK) {
+			evsched_schedule(events->event, ZONE_EVENT_RETRY_MS);
+		}
 		return;
 	}
 
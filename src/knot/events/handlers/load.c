@@ -114,7 +114,10 @@ int event_load(conf_t *conf, zone_t *zone)
 				}
 			}
 
-			ret = zone_load_contents(conf, zone->name, &zf_conts, mode, false);
+			ret = zone_load_snapshot(conf, zone->name, &skip, &zf_conts);
+			if (ret != KNOT_EOK) {
+				ret = zone_load_contents(conf, zone->name, &zf_conts, mode, false);
+			}
 		}
 		if (ret != KNOT_EOK) {
 			assert(!zf_conts);
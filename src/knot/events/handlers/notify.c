@@ -4,16 +4,30 @@
  */
 
 #include <assert.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 #include <urcu.h>
 
+#include "contrib/conn_pool.h"
+#include "contrib/macros.h"
+#include "contrib/net.h"
 #include "contrib/openbsd/siphash.h"
+#include "contrib/sockaddr.h"
+#include "contrib/time.h"
 #include "knot/common/log.h"
+#include "knot/common/unreachable.h"
 #include "knot/conf/conf.h"
 #include "knot/query/query.h"
 #include "knot/query/requestor.h"
 #include "knot/server/server.h"
 #include "knot/zone/zone.h"
 #include "libknot/errcode.h"
+#include "libknot/wire.h"
 
 static notifailed_rmt_hash notifailed_hash(conf_val_t *rmt_id)
 {
@@ -129,6 +143,430 @@ static int send_notify(conf_t *conf, zone_t *zone, const knot_rrset_t *soa,
 	return ret;
 }
 
+/*!
+ * \brief State of a NOTIFY exchange with one remote.
+ */
+typedef enum {
+	NOTIFY_CONNECT,
+	NOTIFY_SEND,
+	NOTIFY_RECV,
+	NOTIFY_DONE,
+} notify_state_t;
+
+/*!
+ * \brief NOTIFY to one remote, sent concurrently with the other remotes.
+ */
+typedef struct {
+	conf_val_t id;                 //!< Remote identifier.
+	notifailed_rmt_hash rmt_hash;  //!< Remote hash for the failed remotes.
+	size_t addr_count;             //!< Number of remote addresses.
+	size_t addr_idx;               //!< Current remote address.
+	conf_remote_t remote;          //!< Current remote address parameters.
+	query_edns_data_t edns;        //!< EDNS data of the query.
+	knot_request_t *req;           //!< Request with the query and response.
+	unsigned flags;                //!< Requestor flags (for logging).
+	bool sync;                     //!< Notified by the blocking requestor (QUIC, TLS).
+	notify_state_t state;          //!< Exchange state.
+	uint8_t len[2];                //!< Response length prefix.
+	size_t done;                   //!< Bytes sent or received in the current state.
+	uint64_t deadline;             //!< Timeout of the current state.
+	int ret;                       //!< Result of the exchange.
+} notify_target_t;
+
+/*!
+ * \brief Parameters shared by the concurrent NOTIFY exchanges.
+ */
+typedef struct {
+	conf_t *conf;
+	zone_t *zone;
+	const knot_rrset_t *soa;
+	int timeout;
+	bool retry;
+	bool tfo;
+	struct timespec begin;
+} notify_fanout_t;
+
+static uint64_t now_ms(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void notify_latency(server_t *server, const struct timespec *begin)
+{
+	struct timespec end = time_now();
+	uint64_t ms = time_diff_ms(begin, &end);
+
+	unsigned bucket = 0;
+	while (bucket < SERVER_NOTIFY_LATENCY_BUCKETS - 1 && ms >= (1ULL << bucket)) {
+		bucket++;
+	}
+	ATOMIC_ADD(server->stats.notify_latency[bucket], 1);
+}
+
+static int notify_socket(const conf_remote_t *remote, bool tfo, bool *connected)
+{
+	int sock = (remote->via.ss_family != AF_UNSPEC) ?
+	           net_bound_socket(SOCK_STREAM, &remote->via, 0, 0) :
+	           net_unbound_socket(SOCK_STREAM, &remote->addr);
+	if (sock < 0) {
+		return sock;
+	}
+
+#ifdef TCP_FASTOPEN_CONNECT
+	/* The SYN carries the query if possible, connect() doesn't block. */
+	if (tfo) {
+		int on = 1;
+		(void)setsockopt(sock, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &on, sizeof(on));
+	}
+#endif
+
+	int ret = connect(sock, (const struct sockaddr *)&remote->addr,
+	                  sockaddr_len(&remote->addr));
+	if (ret != 0 && errno != EINPROGRESS) {
+		ret = knot_map_errno();
+		close(sock);
+		return ret;
+	}
+	*connected = (ret == 0);
+
+	return sock;
+}
+
+static int notify_put_query(knot_request_t *req, const zone_t *zone,
+                            const knot_rrset_t *soa)
+{
+	struct notify_data data = { .zone = zone->name, .soa = soa };
+	knot_layer_t layer = { .data = &data };
+	(void)notify_produce(&layer, req->query);
+
+	int ret = knot_pkt_reserve(req->query, knot_tsig_wire_size(req->tsig.key));
+	if (ret == KNOT_EOK && !req->edns->no_edns) {
+		ret = query_put_edns(req->query, req->edns, false);
+	}
+	if (ret == KNOT_EOK) {
+		ret = tsig_sign_packet(&req->tsig, req->query);
+	}
+
+	return ret;
+}
+
+/*!
+ * \brief Prepare the query for the current remote address and start connecting.
+ */
+static int target_connect(notify_fanout_t *fo, notify_target_t *t)
+{
+	t->remote = conf_remote(fo->conf, &t->id, t->addr_idx);
+	t->edns = query_edns_data_init(fo->conf, &t->remote, 0);
+	t->flags = 0;
+	t->done = 0;
+
+	knot_pkt_t *pkt = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	if (pkt == NULL) {
+		return KNOT_ENOMEM;
+	}
+	t->req = knot_request_make(NULL, &t->remote, pkt, NULL, &t->edns, 0);
+	if (t->req == NULL) {
+		knot_pkt_free(pkt);
+		return KNOT_ENOMEM;
+	}
+
+	int ret = notify_put_query(t->req, fo->zone, fo->soa);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	t->deadline = now_ms() + fo->timeout;
+
+	t->req->fd = (int)conn_pool_get(global_conn_pool, &t->req->source,
+	                                 &t->req->remote);
+	if (t->req->fd >= 0) {
+		t->flags |= KNOT_REQUESTOR_REUSED;
+		t->state = NOTIFY_SEND;
+		return KNOT_EOK;
+	}
+
+	if (knot_unreachable_is(global_unreachables, &t->req->remote,
+	                        &t->req->source)) {
+		return KNOT_EUNREACH;
+	}
+
+	bool connected = false;
+	ret = notify_socket(&t->remote, fo->tfo, &connected);
+	if (ret < 0) {
+		return ret;
+	}
+	t->req->fd = ret;
+	t->state = connected ? NOTIFY_SEND : NOTIFY_CONNECT;
+
+	return KNOT_EOK;
+}
+
+/*!
+ * \brief Start the exchange with the first usable remote address left.
+ */
+static void target_start(notify_fanout_t *fo, notify_target_t *t)
+{
+	for (; t->addr_idx < t->addr_count; t->addr_idx++) {
+		t->ret = target_connect(fo, t);
+		if (t->ret == KNOT_EOK) {
+			return;
+		}
+
+		NOTIFY_OUT_LOG(LOG_WARNING, fo->zone->name, &t->remote, t->flags,
+		               "%sfailed (%s)", fo->retry ? "retry, " : "",
+		               knot_strerror(t->ret));
+		knot_request_free(t->req, NULL);
+		t->req = NULL;
+	}
+
+	t->state = NOTIFY_DONE;
+}
+
+/*!
+ * \brief Give up the current remote address and continue with the next one.
+ */
+static void target_fail(notify_fanout_t *fo, notify_target_t *t, int ret)
+{
+	if (ret == KNOT_ETIMEOUT && t->state != NOTIFY_RECV) {
+		knot_unreachable_add(global_unreachables, &t->req->remote,
+		                     &t->req->source);
+	}
+
+	NOTIFY_OUT_LOG(LOG_WARNING, fo->zone->name, &t->remote, t->flags,
+	               "%sfailed (%s)", fo->retry ? "retry, " : "", knot_strerror(ret));
+	knot_request_free(t->req, NULL);
+	t->req = NULL;
+
+	t->addr_idx++;
+	target_start(fo, t);
+	if (t->state == NOTIFY_DONE && t->ret == KNOT_EOK) {
+		t->ret = ret;
+	}
+}
+
+static int target_consume(notify_target_t *t)
+{
+	knot_request_t *req = t->req;
+
+	int ret = knot_pkt_parse(req->resp, 0);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	if (knot_wire_get_id(req->query->wire) != knot_wire_get_id(req->resp->wire)) {
+		return KNOT_EMALF;
+	}
+	if (knot_wire_get_tc(req->resp->wire)) {
+		return KNOT_EFEWDATA;
+	}
+	ret = tsig_verify_packet(&req->tsig, req->resp);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	if (tsig_unsigned_count(&req->tsig) != 0) {
+		return KNOT_TSIG_EBADSIG;
+	}
+
+	return KNOT_EOK;
+}
+
+static void target_answered(notify_fanout_t *fo, notify_target_t *t)
+{
+	int ret = target_consume(t);
+	if (ret != KNOT_EOK) {
+		target_fail(fo, t, ret);
+		return;
+	}
+
+	const char *log_retry = fo->retry ? "retry, " : "";
+	uint32_t serial = knot_soa_serial(fo->soa->rrs.rdata);
+	knot_pkt_t *resp = t->req->resp;
+
+	if (knot_pkt_ext_rcode(resp) == 0) {
+		NOTIFY_OUT_LOG(LOG_INFO, fo->zone->name, &t->remote, t->flags,
+		               "%sserial %u", log_retry, serial);
+		fo->zone->timers.last_notified_serial = (serial | LAST_NOTIFIED_SERIAL_VALID);
+		notify_latency(fo->zone->server, &fo->begin);
+	} else {
+		NOTIFY_OUT_LOG(LOG_WARNING, fo->zone->name, &t->remote, t->flags,
+		               "%sserver responded with error '%s'",
+		               log_retry, knot_pkt_ext_rcode_name(resp));
+	}
+
+	t->req->flags |= KNOT_REQUEST_KEEP;
+	knot_request_free(t->req, NULL);
+	t->req = NULL;
+	t->ret = KNOT_EOK;
+	t->state = NOTIFY_DONE;
+}
+
+static int target_send(notify_target_t *t)
+{
+	knot_pkt_t *query = t->req->query;
+	uint8_t prefix[2];
+	knot_wire_write_u16(prefix, query->size);
+
+	struct iovec iov[2] = {
+		{ .iov_base = prefix + MIN(t->done, 2), .iov_len = 2 - MIN(t->done, 2) },
+		{ .iov_base = query->wire + (t->done > 2 ? t->done - 2 : 0),
+		  .iov_len = query->size - (t->done > 2 ? t->done - 2 : 0) },
+	};
+	struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 2 };
+
+	ssize_t ret = sendmsg(t->req->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (ret < 0) {
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ?
+		       KNOT_EOK : KNOT_ECONN;
+	}
+	t->done += ret;
+
+	return KNOT_EOK;
+}
+
+static int target_recv(notify_target_t *t)
+{
+	knot_pkt_t *resp = t->req->resp;
+	uint8_t *dst;
+	size_t len;
+	if (t->done < 2) {
+		dst = t->len + t->done;
+		len = 2 - t->done;
+	} else {
+		size_t msg_len = knot_wire_read_u16(t->len);
+		if (msg_len > resp->max_size) {
+			return KNOT_ESPACE;
+		}
+		dst = resp->wire + t->done - 2;
+		len = msg_len - (t->done - 2);
+	}
+
+	ssize_t ret = recv(t->req->fd, dst, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (ret < 0) {
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ?
+		       KNOT_EOK : KNOT_ECONN;
+	} else if (ret == 0) {
+		return KNOT_ECONN;
+	}
+	t->done += ret;
+
+	return KNOT_EOK;
+}
+
+/*!
+ * \brief Advance the exchange with the remote after a socket event.
+ */
+static void target_io(notify_fanout_t *fo, notify_target_t *t)
+{
+	int ret = KNOT_EOK;
+
+	switch (t->state) {
+	case NOTIFY_CONNECT:;
+		int err = 0;
+		socklen_t err_len = sizeof(err);
+		if (getsockopt(t->req->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) != 0) {
+			err = errno;
+		}
+		if (err != 0) {
+			ret = knot_map_errno_code(err);
+			break;
+		}
+		t->state = NOTIFY_SEND;
+		t->deadline = now_ms() + fo->timeout;
+		// FALLTHROUGH
+	case NOTIFY_SEND:
+		ret = target_send(t);
+		if (ret == KNOT_EOK && t->done == 2 + t->req->query->size) {
+			t->state = NOTIFY_RECV;
+			t->done = 0;
+			t->deadline = now_ms() + fo->timeout;
+		}
+		break;
+	case NOTIFY_RECV:
+		ret = target_recv(t);
+		if (ret == KNOT_EOK && t->done >= 2 &&
+		    t->done == 2 + knot_wire_read_u16(t->len)) {
+			t->req->resp->size = t->done - 2;
+			target_answered(fo, t);
+		}
+		break;
+	default:
+		assert(0);
+	}
+
+	if (ret != KNOT_EOK) {
+		target_fail(fo, t, ret);
+	}
+}
+
+/*!
+ * \brief Send the NOTIFYs to all the remotes at once and wait for the answers.
+ *
+ * A remote whose address fails or times out continues with its next address
+ * independently of the other remotes.
+ */
+static void notify_fanout(notify_fanout_t *fo, notify_target_t *targets, size_t count)
+{
+	struct pollfd *fds = calloc(count, sizeof(*fds));
+	notify_target_t **polled = calloc(count, sizeof(*polled));
+	if (fds == NULL || polled == NULL) {
+		for (size_t i = 0; i < count; i++) {
+			targets[i].ret = KNOT_ENOMEM;
+		}
+		free(fds);
+		free(polled);
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (!targets[i].sync) {
+			target_start(fo, &targets[i]);
+		}
+	}
+
+	while (true) {
+		uint64_t now = now_ms();
+		uint64_t next = UINT64_MAX;
+		nfds_t nfds = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			notify_target_t *t = &targets[i];
+			if (t->state != NOTIFY_DONE && t->deadline <= now) {
+				target_fail(fo, t, KNOT_ETIMEOUT);
+			}
+			if (t->state == NOTIFY_DONE) {
+				continue;
+			}
+
+			fds[nfds].fd = t->req->fd;
+			fds[nfds].events = (t->state == NOTIFY_RECV) ? POLLIN : POLLOUT;
+			fds[nfds].revents = 0;
+			polled[nfds++] = t;
+			next = MIN(next, t->deadline);
+		}
+		if (nfds == 0) {
+			break;
+		}
+
+		int ret = poll(fds, nfds, next > now ? next - now : 0);
+		if (ret < 0 && errno != EINTR) {
+			for (nfds_t i = 0; i < nfds; i++) {
+				target_fail(fo, polled[i], knot_map_errno());
+			}
+			continue;
+		}
+
+		for (nfds_t i = 0; i < nfds && ret > 0; i++) {
+			if (fds[i].revents != 0) {
+				target_io(fo, polled[i]);
+			}
+		}
+	}
+
+	free(fds);
+	free(polled);
+}
+
 int event_notify(conf_t *conf, zone_t *zone)
 {
 	assert(zone);
@@ -153,44 +591,82 @@ int event_notify(conf_t *conf, zone_t *zone)
 	pthread_mutex_lock(&zone->preferred_lock);
 	bool retry = (zone->notifailed.size > 0);
 
-	// send NOTIFY to each remote, use working address
+	// collect the remotes to be notified
+	size_t count = 0;
 	conf_val_t notify = conf_zone_get(conf, C_NOTIFY, zone->name);
 	conf_mix_iter_t iter;
 	conf_mix_iter_init(conf, &notify, &iter);
-	while (iter.id->code == KNOT_EOK) {
+	for (; iter.id->code == KNOT_EOK; conf_mix_iter_next(&iter)) {
+		count++;
+	}
+
+	notify_target_t *targets = calloc(count, sizeof(*targets));
+	if (targets == NULL && count > 0) {
+		pthread_mutex_unlock(&zone->preferred_lock);
+		knot_rrset_free(soa_cpy, NULL);
+		return KNOT_ENOMEM;
+	}
+
+	count = 0;
+	notify = conf_zone_get(conf, C_NOTIFY, zone->name);
+	conf_mix_iter_init(conf, &notify, &iter);
+	for (; iter.id->code == KNOT_EOK; conf_mix_iter_next(&iter)) {
 		notifailed_rmt_hash rmt_hash = notifailed_hash(iter.id);
 		if (retry && notifailed_rmt_dynarray_bsearch(&zone->notifailed, &rmt_hash) == NULL) {
-			conf_mix_iter_next(&iter);
 			continue;
 		}
-		pthread_mutex_unlock(&zone->preferred_lock);
 
 		conf_val_t addr = conf_id_get(conf, C_RMT, C_ADDR, iter.id);
-		size_t addr_count = conf_val_count(&addr);
-
-		int ret = KNOT_EOK;
+		conf_remote_t first = conf_remote(conf, iter.id, 0);
+		targets[count++] = (notify_target_t) {
+			.id = *iter.id,
+			.rmt_hash = rmt_hash,
+			.addr_count = conf_val_count(&addr),
+			.sync = first.quic || first.tls,
+			.state = NOTIFY_DONE,
+			.ret = KNOT_ENOMASTER,
+		};
+	}
+	pthread_mutex_unlock(&zone->preferred_lock);
 
-		for (int i = 0; i < addr_count; i++) {
-			conf_remote_t slave = conf_remote(conf, iter.id, i);
-			ret = send_notify(conf, zone, soa_cpy, &slave, timeout, retry);
-			if (ret == KNOT_EOK) {
+	// send NOTIFY to all the remotes at once, use working address
+	notify_fanout_t fanout = {
+		.conf = conf,
+		.zone = zone,
+		.soa = soa_cpy,
+		.timeout = timeout,
+		.retry = retry,
+		.tfo = conf->cache.srv_tcp_fastopen,
+		.begin = time_now(),
+	};
+	notify_fanout(&fanout, targets, count);
+
+	// QUIC and TLS remotes one by one
+	for (size_t i = 0; i < count; i++) {
+		notify_target_t *t = &targets[i];
+		for (size_t j = 0; t->sync && j < t->addr_count; j++) {
+			conf_remote_t slave = conf_remote(conf, &t->id, j);
+			t->ret = send_notify(conf, zone, soa_cpy, &slave, timeout, retry);
+			if (t->ret == KNOT_EOK) {
 				break;
 			}
 		}
+	}
 
-		pthread_mutex_lock(&zone->preferred_lock);
-		if (ret != KNOT_EOK) {
+	pthread_mutex_lock(&zone->preferred_lock);
+	for (size_t i = 0; i < count; i++) {
+		notify_target_t *t = &targets[i];
+		if (t->ret != KNOT_EOK) {
 			failed = true;
 			if (!retry) {
-				notifailed_rmt_dynarray_add(&zone->notifailed, &rmt_hash);
+				notifailed_rmt_dynarray_add(&zone->notifailed, &t->rmt_hash);
 			}
 		} else {
-			notifailed_rmt_dynarray_remove(&zone->notifailed, &rmt_hash);
+			notifailed_rmt_dynarray_remove(&zone->notifailed, &t->rmt_hash);
 			notifailed_rmt_dynarray_sort(&zone->notifailed);
 		}
-
-		conf_mix_iter_next(&iter);
 	}
+	free(targets);
 
 	if (failed) {
 		notifailed_rmt_dynarray_sort_dedup(&zone->notifailed);
@@ -14,6 +14,7 @@
 #include "knot/dnssec/zone-events.h"
 #include "knot/events/handlers.h"
 #include "knot/events/replan.h"
+#include "knot/events/soa_check.h"
 #include "knot/nameserver/ixfr.h"
 #include "knot/query/layer.h"
 #include "knot/query/query.h"
@@ -106,6 +107,7 @@ struct refresh_data {
 	bool fallback_axfr;               //!< Flag allowing fallback to AXFR,
 	bool ixfr_by_one;                 //!< Allow only single changeset within IXFR.
 	bool ixfr_from_axfr;              //!< Diff computation of incremental update from AXFR allowed.
+	enum xfr_type checked_xfr;        //!< Transfer type if the SOA was checked already.
 	uint32_t expire_timer;            //!< Result: expire timer from answer EDNS.
 
 	// internal state, initialize with zeroes:
@@ -1258,7 +1260,11 @@ static int refresh_begin(knot_layer_t *layer, void *_data)
 	struct refresh_data *data = _data;
 	data->layer = layer;
 
-	if (data->soa) {
+	if (data->soa && data->checked_xfr != XFR_TYPE_UNDETERMINED) {
+		data->state = STATE_TRANSFER;
+		data->xfr_type = data->checked_xfr;
+		data->initial_soa_copy = NULL;
+	} else if (data->soa) {
 		data->state = STATE_SOA_QUERY;
 		data->xfr_type = XFR_TYPE_IXFR;
 		data->initial_soa_copy = NULL;
@@ -1338,6 +1344,8 @@ typedef struct {
 	bool ixfr_by_one;
 	bool ixfr_from_axfr;
 	bool more_xfr;
+	enum xfr_type checked_xfr;              // Transfer type decided by the SOA check.
+	struct sockaddr_storage checked_remote; // Remote answered the SOA check.
 } try_refresh_ctx_t;
 
 static int try_refresh(conf_t *conf, zone_t *zone, const conf_remote_t *master,
@@ -1352,6 +1360,14 @@ static int try_refresh(conf_t *conf, zone_t *zone, const conf_remote_t *master,
 
 	try_refresh_ctx_t *trctx = ctx;
 
+	// Skip the SOA query if the remote has just answered it.
+	enum xfr_type checked_xfr = XFR_TYPE_UNDETERMINED;
+	if (trctx->checked_xfr != XFR_TYPE_UNDETERMINED &&
+	    sockaddr_cmp(&master->addr, &trctx->checked_remote, false) == 0) {
+		checked_xfr = trctx->checked_xfr;
+		trctx->checked_xfr = XFR_TYPE_UNDETERMINED;
+	}
+
 	knot_rrset_t *soa = NULL;
 	if (zone->contents) {
 		rcu_read_lock();
@@ -1375,6 +1391,7 @@ static int try_refresh(conf_t *conf, zone_t *zone, const conf_remote_t *master,
 		.fallback_axfr = false, // will be set upon IXFR consume
 		.ixfr_by_one = trctx->ixfr_by_one,
 		.ixfr_from_axfr = trctx->ixfr_from_axfr,
+		.checked_xfr = checked_xfr,
 	};
 
 	knot_requestor_t requestor;
@@ -1430,6 +1447,136 @@ static int try_refresh(conf_t *conf, zone_t *zone, const conf_remote_t *master,
 	return ret;
 }
 
+/*!
+ * \brief Hand the SOA query over to the non-blocking SOA checker.
+ *
+ * Only plain DNS remotes without master pinning are supported, the refresh
+ * event is scheduled again once the check finishes.
+ */
+static int refresh_soa_check_start(conf_t *conf, zone_t *zone, const try_refresh_ctx_t *trctx)
+{
+	soa_check_t *checker = zone->server->soa_check;
+	if (checker == NULL || conf->cache.srv_refresh_inflight == 0 ||
+	    zone->contents == NULL || trctx->force_axfr) {
+		return KNOT_ENOTSUP;
+	}
+
+	conf_val_t val = conf_zone_get(conf, C_MASTER_PIN_TOL, zone->name);
+	if (conf_int(&val) > 0) {
+		return KNOT_ENOTSUP;
+	}
+
+	size_t count = 0;
+	conf_val_t masters = conf_zone_get(conf, C_MASTER, zone->name);
+	conf_mix_iter_t iter;
+	conf_mix_iter_init(conf, &masters, &iter);
+	while (iter.id->code == KNOT_EOK) {
+		conf_val_t addr = conf_id_get(conf, C_RMT, C_ADDR, iter.id);
+		count += conf_val_count(&addr);
+		conf_mix_iter_next(&iter);
+	}
+	if (count == 0) {
+		return KNOT_ENOTSUP;
+	}
+
+	soa_check_target_t *targets = calloc(count, sizeof(*targets));
+	if (targets == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	// The notifying remote first, the other ones in the configured order.
+	size_t idx = 0;
+	int ret = KNOT_EOK;
+	conf_val_reset(&masters);
+	conf_mix_iter_init(conf, &masters, &iter);
+	pthread_mutex_lock(&zone->preferred_lock);
+	while (iter.id->code == KNOT_EOK && ret == KNOT_EOK) {
+		conf_val_t addr = conf_id_get(conf, C_RMT, C_ADDR, iter.id);
+		size_t addr_count = conf_val_count(&addr);
+		for (size_t i = 0; i < addr_count; i++) {
+			soa_check_target_t *target = &targets[idx++];
+			target->id = conf_str(iter.id);
+			target->remote = conf_remote(conf, iter.id, i);
+			target->edns = query_edns_data_init(conf, &target->remote,
+			                                    QUERY_EDNS_OPT_EXPIRE);
+			if (target->remote.quic || target->remote.tls) {
+				ret = KNOT_ENOTSUP;
+			} else if (zone->preferred_master != NULL &&
+			           sockaddr_net_match(&target->remote.addr, zone->preferred_master, -1)) {
+				soa_check_target_t preferred = *target;
+				memmove(&targets[1], &targets[0], (idx - 1) * sizeof(*targets));
+				targets[0] = preferred;
+			}
+		}
+		conf_mix_iter_next(&iter);
+	}
+	pthread_mutex_unlock(&zone->preferred_lock);
+
+	if (ret == KNOT_EOK) {
+		ret = soa_check_submit(checker, zone, targets, count,
+		                       conf->cache.srv_tcp_remote_io_timeout);
+	}
+	free(targets);
+
+	return ret;
+}
+
+/*!
+ * \brief Process a finished SOA check like the SOA query of the refresh.
+ *
+ * \return True if the refresh is finished, false if the regular refresh follows.
+ */
+static bool refresh_soa_check_finish(conf_t *conf, zone_t *zone, const soa_check_result_t *result,
+                             try_refresh_ctx_t *trctx, int *ret)
+{
+	if (result->ret != KNOT_EOK) {
+		*ret = result->ret; // All the remotes failed, already logged.
+		return true;
+	} else if (result->fallback || zone->contents == NULL || trctx->force_axfr) {
+		return false;
+	}
+
+	knot_pkt_t *pkt = knot_pkt_new(result->wire, result->size, NULL);
+	if (pkt == NULL || knot_pkt_parse(pkt, 0) != KNOT_EOK) {
+		knot_pkt_free(pkt);
+		return false;
+	}
+
+	conf_remote_t remote = { .key.name = result->key_name };
+	memcpy(&remote.addr, &result->remote, sockaddr_len(&result->remote));
+
+	zone_master_fallback_t fallback = { true, true, false, 0 };
+	knot_layer_t layer = { .flags = KNOT_REQUESTOR_UDP };
+	struct refresh_data data = {
+		.layer = &layer,
+		.zone = zone,
+		.conf = conf,
+		.remote = &remote,
+		.expire_timer = EXPIRE_TIMER_INVALID,
+		.fallback = &fallback,
+		.state = STATE_SOA_QUERY,
+		.xfr_type = XFR_TYPE_IXFR,
+	};
+	layer.data = &data;
+
+	int state = soa_query_consume(&layer, pkt);
+	knot_pkt_free(pkt);
+
+	switch (state) {
+	case KNOT_STATE_DONE:
+		*ret = KNOT_EOK;
+		return true;
+	case KNOT_STATE_RESET:
+		// Outdated, transfer from the remote which answered.
+		trctx->checked_xfr = data.xfr_type;
+		memcpy(&trctx->checked_remote, &result->remote, sizeof(result->remote));
+		zone_set_preferred_master(zone, &result->remote);
+		return false;
+	default:
+		return false;
+	}
+}
+
 int event_refresh(conf_t *conf, zone_t *zone)
 {
 	assert(zone);
@@ -1451,7 +1598,24 @@ int event_refresh(conf_t *conf, zone_t *zone)
 	val = conf_zone_get(conf, C_IXFR_FROM_AXFR, zone->name);
 	trctx.ixfr_from_axfr = conf_bool(&val);
 
-	int ret = zone_master_try(conf, zone, try_refresh, &trctx, "refresh");
+	int ret = KNOT_EOK;
+	bool finished = false;
+	soa_check_result_t *checked = soa_check_take(zone);
+	if (checked != NULL) {
+		finished = refresh_soa_check_finish(conf, zone, checked, &trctx, &ret);
+		soa_check_result_free(checked);
+	} else {
+		ret = refresh_soa_check_start(conf, zone, &trctx);
+		if (ret == KNOT_EOK || ret == KNOT_EEXIST) {
+			// The refresh continues once the SOA check finishes.
+			zone_clear_preferred_master(zone);
+			return KNOT_EOK;
+		}
+	}
+
+	if (!finished) {
+		ret = zone_master_try(conf, zone, try_refresh, &trctx, "refresh");
+	}
 	zone_clear_preferred_master(zone);
 	if (ret != KNOT_EOK) {
 		const knot_rdataset_t *soa = zone_soa(zone);
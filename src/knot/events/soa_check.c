@@ -0,0 +1,703 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "knot/common/log.h"
+#include "knot/events/events.h"
+#include "knot/events/soa_check.h"
+#include "knot/nameserver/log.h"
+#include "knot/nameserver/tsig_ctx.h"
+#include "libknot/libknot.h"
+#include "contrib/macros.h"
+#include "contrib/net.h"
+#include "contrib/sockaddr.h"
+#include "contrib/ucw/lists.h"
+
+/*! \brief Queries sent from a socket before it's replaced (new source port). */
+#define SOCKET_QUERIES		16
+/*! \brief Maximum number of sockets of the checker. */
+#define MAX_SOCKETS		256
+/*! \brief Maximum number of replies read from a socket in one round. */
+#define RECV_BATCH		256
+/*! \brief [ms] Pause of sending if the local socket buffer is full. */
+#define SEND_BACKOFF_MS		10
+
+#define SOA_CHECK_LOG(priority, zone, target, msg...) \
+	ns_log(priority, (zone)->name, LOG_OPERATION_REFRESH, LOG_DIRECTION_NONE, \
+	       &(target)->remote.addr, KNOTD_QUERY_PROTO_UDP, false, \
+	       (target)->remote.key.name, msg)
+
+typedef struct {
+	int fd;
+	struct sockaddr_storage source;  //!< Source address or just the family.
+	unsigned sent;                   //!< Number of queries sent from the socket.
+	unsigned waiting;                //!< Number of queries in flight from the socket.
+	bool retired;                    //!< Not used for new queries, closed when idle.
+} check_sock_t;
+
+/*!
+ * \brief SOA check of one zone.
+ *
+ * Queued items wait in the queue for a free slot, sent ones are linked in the
+ * list of items in flight (ordered by deadline) and in the message ID table.
+ */
+typedef struct soa_check_item {
+	node_t n;
+	struct soa_check_item *id_next;  //!< Next item with the same message ID.
+	zone_t *zone;
+	soa_check_target_t *targets;
+	size_t count;
+	size_t cur;                      //!< Currently queried target.
+	bool sent;
+	uint16_t id;                     //!< Message ID of the query in flight.
+	check_sock_t *sock;              //!< Socket of the query in flight.
+	uint64_t deadline;
+	int timeout_ms;
+	tsig_ctx_t tsig;
+} item_t;
+
+struct soa_check {
+	pthread_mutex_t lock;
+	pthread_t thread;
+	bool stopping;
+	int wake[2];                     //!< Pipe waking up the thread.
+
+	size_t limit;                    //!< Maximum number of queries in flight.
+	size_t inflight;                 //!< Number of queries in flight.
+	list_t queue;                    //!< Items waiting for sending.
+	list_t sent;                     //!< Items in flight ordered by deadline.
+	item_t *by_id[UINT16_MAX + 1];   //!< Items in flight by message ID.
+
+	check_sock_t *socks[MAX_SOCKETS];
+	size_t nsocks;
+	uint64_t backoff;                //!< Don't send until this time (local congestion).
+
+	uint8_t qbuf[KNOT_WIRE_MAX_PKTSIZE];  //!< Query being sent.
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];   //!< Reply being processed.
+};
+
+static uint64_t now_ms(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void wake_up(soa_check_t *c)
+{
+	uint8_t byte = 0;
+	(void)write(c->wake[1], &byte, sizeof(byte));
+}
+
+static void targets_free(soa_check_target_t *targets, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		free((char *)targets[i].id);
+		knot_tsig_key_deinit(&targets[i].remote.key);
+	}
+	free(targets);
+}
+
+static void item_free(item_t *item)
+{
+	tsig_cleanup(&item->tsig);
+	targets_free(item->targets, item->count);
+	free(item);
+}
+
+static void item_unlink(soa_check_t *c, item_t *item)
+{
+	if (item->n.prev != NULL) {
+		rem_node(&item->n);
+	}
+
+	if (!item->sent) {
+		return;
+	}
+
+	item_t **pos = &c->by_id[item->id];
+	while (*pos != item) {
+		pos = &(*pos)->id_next;
+	}
+	*pos = item->id_next;
+	item->sent = false;
+	item->sock->waiting--;
+	c->inflight--;
+}
+
+static int sock_open(soa_check_t *c, const conf_remote_t *remote,
+                     const struct sockaddr_storage *source, check_sock_t **out)
+{
+	if (c->nsocks == MAX_SOCKETS) {
+		return KNOT_ESPACE;
+	}
+
+	check_sock_t *sock = calloc(1, sizeof(*sock));
+	if (sock == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	sock->fd = (remote->via.ss_family != AF_UNSPEC) ?
+	           net_bound_socket(SOCK_DGRAM, source, 0, 0) :
+	           net_unbound_socket(SOCK_DGRAM, &remote->addr);
+	if (sock->fd < 0) {
+		int ret = sock->fd;
+		free(sock);
+		return ret;
+	}
+	sock->source = *source;
+	c->socks[c->nsocks++] = sock;
+
+	*out = sock;
+	return KNOT_EOK;
+}
+
+/*!
+ * \brief Close the replaced sockets without queries in flight.
+ *
+ * \param all  Close also the current sockets without queries in flight.
+ */
+static void sock_cleanup(soa_check_t *c, bool all)
+{
+	for (size_t i = c->nsocks; i > 0; i--) {
+		check_sock_t *sock = c->socks[i - 1];
+		if ((sock->retired || all) && sock->waiting == 0) {
+			close(sock->fd);
+			free(sock);
+			c->socks[i - 1] = c->socks[--c->nsocks];
+		}
+	}
+}
+
+/*!
+ * \brief Get the socket for a query from the source address.
+ *
+ * The socket of each source is replaced after a few queries, so that an
+ * off-path attacker has to guess the source port together with the message ID.
+ */
+static int sock_get(soa_check_t *c, const conf_remote_t *remote, check_sock_t **out)
+{
+	struct sockaddr_storage source = { 0 };
+	if (remote->via.ss_family != AF_UNSPEC) {
+		memcpy(&source, &remote->via, sockaddr_len(&remote->via));
+	} else {
+		source.ss_family = remote->addr.ss_family;
+	}
+
+	check_sock_t *cur = NULL;
+	for (size_t i = 0; i < c->nsocks && cur == NULL; i++) {
+		if (!c->socks[i]->retired &&
+		    sockaddr_cmp(&c->socks[i]->source, &source, false) == 0) {
+			cur = c->socks[i];
+		}
+	}
+
+	if (cur == NULL) {
+		return sock_open(c, remote, &source, out);
+	}
+
+	check_sock_t *sock = NULL;
+	if (cur->sent >= SOCKET_QUERIES &&
+	    sock_open(c, remote, &source, &sock) == KNOT_EOK) {
+		cur->retired = true;
+		cur = sock;
+	} // Otherwise keep using the current socket.
+
+	*out = cur;
+	return KNOT_EOK;
+}
+
+static int item_send(soa_check_t *c, item_t *item)
+{
+	soa_check_target_t *target = &item->targets[item->cur];
+
+	check_sock_t *sock = NULL;
+	int ret = sock_get(c, &target->remote, &sock);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	knot_pkt_t *query = knot_pkt_new(c->qbuf, sizeof(c->qbuf), NULL);
+	if (query == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	query_init_pkt(query);
+	ret = knot_pkt_put_question(query, item->zone->name, KNOT_CLASS_IN,
+	                            KNOT_RRTYPE_SOA);
+	if (ret == KNOT_EOK) {
+		ret = knot_pkt_reserve(query, knot_tsig_wire_size(&target->remote.key));
+	}
+	if (ret == KNOT_EOK && !target->edns.no_edns) {
+		ret = query_put_edns(query, &target->edns, false);
+	}
+	if (ret == KNOT_EOK) {
+		tsig_cleanup(&item->tsig);
+		tsig_init(&item->tsig, target->remote.key.name != NULL ?
+		                       &target->remote.key : NULL);
+		ret = tsig_sign_packet(&item->tsig, query);
+	}
+	if (ret != KNOT_EOK) {
+		knot_pkt_free(query);
+		return ret;
+	}
+
+	// A pending ICMP error of another remote fails the first attempt.
+	ssize_t sent = -1;
+	for (int attempt = 0; attempt < 2 && sent < 0; attempt++) {
+		sent = sendto(sock->fd, query->wire, query->size, 0,
+		              (struct sockaddr *)&target->remote.addr,
+		              sockaddr_len(&target->remote.addr));
+	}
+	item->id = knot_wire_get_id(query->wire);
+	knot_pkt_free(query);
+	if (sent < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+			return KNOT_EBUSY; // Local congestion, not a remote failure.
+		}
+		return knot_map_errno();
+	}
+
+	sock->sent++;
+	sock->waiting++;
+	item->sock = sock;
+	item->sent = true;
+	item->id_next = c->by_id[item->id];
+	c->by_id[item->id] = item;
+	c->inflight++;
+
+	// Keep the list ordered, usually all the queries have the same timeout.
+	item->deadline = (item->timeout_ms < 0) ? UINT64_MAX : now_ms() + item->timeout_ms;
+	node_t *prev = (node_t *)TAIL(c->sent);
+	while (prev->prev != NULL && ((item_t *)prev)->deadline > item->deadline) {
+		prev = prev->prev;
+	}
+	insert_node(&item->n, prev);
+
+	return KNOT_EOK;
+}
+
+static void item_complete(soa_check_t *c, item_t *item, soa_check_result_t *result)
+{
+	zone_t *zone = item->zone;
+
+	item_unlink(c, item);
+	zone->soa_check_item = NULL;
+	item_free(item);
+
+	pthread_mutex_lock(&zone->preferred_lock);
+	soa_check_result_free(zone->soa_check_result);
+	zone->soa_check_result = result;
+	pthread_mutex_unlock(&zone->preferred_lock);
+
+	zone_events_schedule_now(zone, ZONE_EVENT_REFRESH);
+}
+
+static void item_fail(soa_check_t *c, item_t *item, int error)
+{
+	soa_check_result_t *result = calloc(1, sizeof(*result));
+	if (result != NULL) {
+		result->ret = error;
+	}
+
+	// Without the result, the refresh event starts over.
+	item_complete(c, item, result);
+}
+
+/*!
+ * \brief Query the targets from the current one until a query is sent.
+ */
+static void item_start(soa_check_t *c, item_t *item, int error, bool skip_remote)
+{
+	while (true) {
+		if (error != KNOT_EOK) {
+			const soa_check_target_t *target = &item->targets[item->cur];
+			char addr_str[SOCKADDR_STRLEN] = { 0 };
+			sockaddr_tostr(addr_str, sizeof(addr_str), &target->remote.addr);
+			log_zone_info(item->zone->name, "refresh, remote %s, address %s, failed (%s)",
+			              target->id, addr_str, knot_strerror(error));
+
+			// Next address of the same remote or the next remote.
+			do {
+				item->cur++;
+			} while (skip_remote && item->cur < item->count &&
+			         strcmp(item->targets[item->cur].id, target->id) == 0);
+
+			if (item->cur == item->count ||
+			    strcmp(item->targets[item->cur].id, target->id) != 0) {
+				log_zone_warning(item->zone->name, "refresh, remote %s not usable",
+				                 target->id);
+			}
+			if (item->cur == item->count) {
+				item_fail(c, item, KNOT_ENOMASTER);
+				return;
+			}
+		}
+
+		error = item_send(c, item);
+		if (error == KNOT_EOK) {
+			return;
+		} else if (error == KNOT_EBUSY || error == KNOT_ESPACE) {
+			// Local congestion or all the sockets in use, not a remote failure.
+			// Retry the same target later, before the other queued items.
+			add_head(&c->queue, &item->n);
+			c->backoff = now_ms() + SEND_BACKOFF_MS;
+			return;
+		}
+		skip_remote = false;
+	}
+}
+
+static void item_answered(soa_check_t *c, item_t *item, knot_pkt_t *pkt)
+{
+	soa_check_target_t *target = &item->targets[item->cur];
+
+	soa_check_result_t *result = calloc(1, sizeof(*result));
+	if (result == NULL) {
+		item_fail(c, item, KNOT_ENOMEM);
+		return;
+	}
+
+	memcpy(&result->remote, &target->remote.addr, sockaddr_len(&target->remote.addr));
+	if (target->remote.key.name != NULL) {
+		result->key_name = knot_dname_copy(target->remote.key.name, NULL);
+	}
+
+	if (knot_wire_get_tc(pkt->wire)) {
+		result->fallback = true;
+	} else {
+		result->wire = malloc(pkt->size);
+		if (result->wire == NULL) {
+			soa_check_result_free(result);
+			item_fail(c, item, KNOT_ENOMEM);
+			return;
+		}
+		memcpy(result->wire, pkt->wire, pkt->size);
+		result->size = pkt->size;
+	}
+
+	item_complete(c, item, result);
+}
+
+static void process_reply(soa_check_t *c, check_sock_t *sock,
+                          const struct sockaddr_storage *from, uint8_t *wire,
+                          size_t size)
+{
+	if (size < KNOT_WIRE_HEADER_SIZE || !knot_wire_get_qr(wire)) {
+		return;
+	}
+
+	knot_pkt_t *pkt = knot_pkt_new(wire, size, NULL);
+	if (pkt == NULL) {
+		return;
+	}
+	int ret = knot_pkt_parse(pkt, 0);
+	const knot_dname_t *qname = knot_pkt_qname(pkt);
+	if (qname == NULL || knot_pkt_qtype(pkt) != KNOT_RRTYPE_SOA) {
+		knot_pkt_free(pkt);
+		return; // Unrelated or broken, the query times out eventually.
+	}
+
+	item_t *item = c->by_id[knot_wire_get_id(wire)];
+	while (item != NULL &&
+	       (item->sock != sock ||
+	        sockaddr_cmp(from, &item->targets[item->cur].remote.addr, false) != 0 ||
+	        !knot_dname_is_case_equal(qname, item->zone->name))) {
+		item = item->id_next;
+	}
+	if (item == NULL) {
+		knot_pkt_free(pkt);
+		return;
+	}
+
+	if (ret == KNOT_EOK) {
+		ret = tsig_verify_packet(&item->tsig, pkt);
+	} else {
+		ret = KNOT_EMALF;
+	}
+
+	// Same as in the refresh event, a responding remote isn't retried.
+	if (ret == KNOT_EOK && knot_pkt_ext_rcode(pkt) != KNOT_RCODE_NOERROR) {
+		SOA_CHECK_LOG(LOG_WARNING, item->zone, &item->targets[item->cur],
+		              "server responded with error '%s'",
+		              knot_pkt_ext_rcode_name(pkt));
+		ret = KNOT_EDENIED;
+	}
+
+	if (ret == KNOT_EOK) {
+		item_answered(c, item, pkt);
+	} else {
+		item_unlink(c, item);
+		item_start(c, item, ret, true);
+	}
+
+	knot_pkt_free(pkt);
+}
+
+static void receive_all(soa_check_t *c, check_sock_t *sock)
+{
+	for (int i = 0; i < RECV_BATCH; i++) {
+		struct sockaddr_storage from;
+		socklen_t from_len = sizeof(from);
+		ssize_t got = recvfrom(sock->fd, c->buf, sizeof(c->buf), 0,
+		                       (struct sockaddr *)&from, &from_len);
+		if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return;
+		} else if (got < 0) {
+			continue; // ICMP error, the query times out.
+		}
+		process_reply(c, sock, &from, c->buf, got);
+	}
+}
+
+static void expire_queries(soa_check_t *c, uint64_t now)
+{
+	while (!EMPTY_LIST(c->sent)) {
+		item_t *item = HEAD(c->sent);
+		if (item->deadline > now) {
+			break;
+		}
+		item_unlink(c, item);
+		item_start(c, item, KNOT_ETIMEOUT, false);
+	}
+}
+
+static void send_queued(soa_check_t *c, uint64_t now)
+{
+	if (now < c->backoff) {
+		return;
+	}
+	c->backoff = 0;
+
+	while (c->backoff == 0 && c->inflight < c->limit && !EMPTY_LIST(c->queue)) {
+		item_t *item = HEAD(c->queue);
+		rem_node(&item->n);
+		item_start(c, item, KNOT_EOK, false);
+	}
+}
+
+static void *checker_main(void *arg)
+{
+	soa_check_t *c = arg;
+
+	struct pollfd fds[1 + MAX_SOCKETS];
+
+	pthread_mutex_lock(&c->lock);
+	while (!c->stopping) {
+		uint64_t now = now_ms();
+		send_queued(c, now);
+		expire_queries(c, now);
+		sock_cleanup(c, c->nsocks == MAX_SOCKETS); // Make room for new sources.
+
+		int timeout = -1;
+		if (!EMPTY_LIST(c->sent)) {
+			item_t *first = HEAD(c->sent);
+			timeout = first->deadline > now ? MIN(first->deadline - now, INT_MAX) : 0;
+		}
+		if (c->backoff != 0 && !EMPTY_LIST(c->queue)) {
+			int backoff = c->backoff > now ? c->backoff - now : 0;
+			timeout = (timeout < 0) ? backoff : MIN(timeout, backoff);
+		}
+
+		fds[0].fd = c->wake[0];
+		fds[0].events = POLLIN;
+		size_t nfds = 1;
+		for (size_t i = 0; i < c->nsocks; i++, nfds++) {
+			fds[nfds].fd = c->socks[i]->fd;
+			fds[nfds].events = POLLIN;
+		}
+
+		pthread_mutex_unlock(&c->lock);
+		int ready = poll(fds, nfds, timeout);
+		pthread_mutex_lock(&c->lock);
+
+		if (ready <= 0) {
+			continue;
+		}
+		if (fds[0].revents & POLLIN) {
+			uint8_t drain[64];
+			while (read(c->wake[0], drain, sizeof(drain)) > 0);
+		}
+		for (size_t i = 1; i < nfds; i++) {
+			if (fds[i].revents & (POLLIN | POLLERR)) {
+				receive_all(c, c->socks[i - 1]);
+			}
+		}
+	}
+	pthread_mutex_unlock(&c->lock);
+
+	return NULL;
+}
+
+soa_check_t *soa_check_new(size_t limit)
+{
+	soa_check_t *c = calloc(1, sizeof(*c));
+	if (c == NULL) {
+		return NULL;
+	}
+
+	if (pipe(c->wake) != 0) {
+		free(c);
+		return NULL;
+	}
+	(void)fcntl(c->wake[0], F_SETFL, O_NONBLOCK);
+	(void)fcntl(c->wake[1], F_SETFL, O_NONBLOCK);
+
+	pthread_mutex_init(&c->lock, NULL);
+	init_list(&c->queue);
+	init_list(&c->sent);
+	c->limit = limit;
+
+	if (pthread_create(&c->thread, NULL, checker_main, c) != 0) {
+		pthread_mutex_destroy(&c->lock);
+		close(c->wake[0]);
+		close(c->wake[1]);
+		free(c);
+		return NULL;
+	}
+
+	return c;
+}
+
+void soa_check_free(soa_check_t *checker)
+{
+	if (checker == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&checker->lock);
+	checker->stopping = true;
+	pthread_mutex_unlock(&checker->lock);
+	wake_up(checker);
+	pthread_join(checker->thread, NULL);
+
+	item_t *item, *next;
+	WALK_LIST_DELSAFE(item, next, checker->queue) {
+		item->zone->soa_check_item = NULL;
+		item_free(item);
+	}
+	WALK_LIST_DELSAFE(item, next, checker->sent) {
+		item->zone->soa_check_item = NULL;
+		item_free(item);
+	}
+
+	for (size_t i = 0; i < checker->nsocks; i++) {
+		close(checker->socks[i]->fd);
+		free(checker->socks[i]);
+	}
+	close(checker->wake[0]);
+	close(checker->wake[1]);
+	pthread_mutex_destroy(&checker->lock);
+	free(checker);
+}
+
+void soa_check_set_limit(soa_check_t *checker, size_t limit)
+{
+	if (checker == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&checker->lock);
+	checker->limit = limit;
+	pthread_mutex_unlock(&checker->lock);
+	wake_up(checker);
+}
+
+int soa_check_submit(soa_check_t *checker, zone_t *zone,
+                     const soa_check_target_t *targets, size_t count,
+                     int timeout_ms)
+{
+	if (checker == NULL || zone == NULL || targets == NULL || count == 0) {
+		return KNOT_EINVAL;
+	}
+
+	item_t *item = calloc(1, sizeof(*item));
+	if (item == NULL) {
+		return KNOT_ENOMEM;
+	}
+	item->targets = calloc(count, sizeof(*item->targets));
+	if (item->targets == NULL) {
+		free(item);
+		return KNOT_ENOMEM;
+	}
+	item->zone = zone;
+	item->timeout_ms = timeout_ms;
+
+	// Keep own copies, the configuration may be reloaded meanwhile.
+	for (size_t i = 0; i < count; i++) {
+		soa_check_target_t *target = &item->targets[i];
+		*target = targets[i];
+		memset(&target->remote.key, 0, sizeof(target->remote.key));
+		target->id = strdup(targets[i].id);
+		item->count++;
+		if (target->id == NULL ||
+		    (targets[i].remote.key.name != NULL &&
+		     knot_tsig_key_copy(&target->remote.key, &targets[i].remote.key) != KNOT_EOK)) {
+			item_free(item);
+			return KNOT_ENOMEM;
+		}
+	}
+
+	pthread_mutex_lock(&checker->lock);
+	if (zone->soa_check_item != NULL) {
+		pthread_mutex_unlock(&checker->lock);
+		item_free(item);
+		return KNOT_EEXIST;
+	}
+	zone->soa_check_item = item;
+	add_tail(&checker->queue, &item->n);
+	pthread_mutex_unlock(&checker->lock);
+
+	wake_up(checker);
+
+	return KNOT_EOK;
+}
+
+void soa_check_cancel(soa_check_t *checker, zone_t *zone)
+{
+	if (checker == NULL || zone == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&checker->lock);
+	item_t *item = zone->soa_check_item;
+	if (item != NULL) {
+		item_unlink(checker, item);
+		zone->soa_check_item = NULL;
+		item_free(item);
+	}
+	pthread_mutex_unlock(&checker->lock);
+}
+
+soa_check_result_t *soa_check_take(zone_t *zone)
+{
+	pthread_mutex_lock(&zone->preferred_lock);
+	soa_check_result_t *result = zone->soa_check_result;
+	zone->soa_check_result = NULL;
+	pthread_mutex_unlock(&zone->preferred_lock);
+
+	return result;
+}
+
+void soa_check_result_free(soa_check_result_t *result)
+{
+	if (result == NULL) {
+		return;
+	}
+
+	knot_dname_free(result->key_name, NULL);
+	free(result->wire);
+	free(result);
+}
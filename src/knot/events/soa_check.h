@@ -0,0 +1,103 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include "knot/conf/conf.h"
+#include "knot/query/query.h"
+#include "knot/zone/zone.h"
+
+/*!
+ * \brief Non-blocking SOA checker of zone refreshes.
+ *
+ * A single thread keeps the SOA queries of many zones in flight over UDP
+ * sockets, which are regularly replaced to vary the source port, and matches the replies by message ID, remote address, and
+ * zone name. The outcome is handed back to the zone's refresh event, so that
+ * a worker only deals with an answered query and the subsequent transfer.
+ */
+typedef struct soa_check soa_check_t;
+
+/*!
+ * \brief One address of a primary server to be queried.
+ */
+typedef struct {
+	const char *id;           //!< Remote identifier (for logging).
+	conf_remote_t remote;     //!< Remote address, source address, and TSIG key.
+	query_edns_data_t edns;   //!< EDNS data of the query.
+} soa_check_target_t;
+
+/*!
+ * \brief Outcome of a zone SOA check.
+ */
+typedef struct soa_check_result {
+	int ret;                         //!< KNOT_EOK if answered, error code otherwise.
+	bool fallback;                   //!< The answer needs the regular refresh (e.g. truncated).
+	struct sockaddr_storage remote;  //!< Address of the answering remote.
+	knot_dname_t *key_name;          //!< TSIG key name of the answering remote.
+	uint8_t *wire;                   //!< Answer message.
+	size_t size;                     //!< Answer message size.
+} soa_check_result_t;
+
+/*!
+ * \brief Create the SOA checker and start its thread.
+ *
+ * \param limit  Maximum number of queries in flight.
+ *
+ * \return SOA checker or NULL.
+ */
+soa_check_t *soa_check_new(size_t limit);
+
+/*!
+ * \brief Stop the thread and free the SOA checker with all pending checks.
+ */
+void soa_check_free(soa_check_t *checker);
+
+/*!
+ * \brief Update the maximum number of queries in flight.
+ */
+void soa_check_set_limit(soa_check_t *checker, size_t limit);
+
+/*!
+ * \brief Start a SOA check of the zone.
+ *
+ * The targets are queried one by one until one of them answers. The result
+ * is then stored in the zone and the refresh event is scheduled.
+ *
+ * \param checker     SOA checker.
+ * \param zone        Zone to be checked.
+ * \param targets     Remote addresses in the order of preference.
+ * \param count       Number of targets.
+ * \param timeout_ms  Timeout of a query.
+ *
+ * \retval KNOT_EOK     The check was started.
+ * \retval KNOT_EEXIST  The zone is already being checked.
+ * \return KNOT_E*
+ */
+int soa_check_submit(soa_check_t *checker, zone_t *zone,
+                     const soa_check_target_t *targets, size_t count,
+                     int timeout_ms);
+
+/*!
+ * \brief Drop a pending check of the zone, if any.
+ *
+ * After return, the checker doesn't refer to the zone.
+ */
+void soa_check_cancel(soa_check_t *checker, zone_t *zone);
+
+/*!
+ * \brief Take the stored result of a finished check of the zone.
+ *
+ * \return Result to be freed by the caller, NULL if none.
+ */
+soa_check_result_t *soa_check_take(zone_t *zone);
+
+/*!
+ * \brief Free the check result.
+ */
+void soa_check_result_free(soa_check_result_t *result);
@@ -3,10 +3,16 @@
  *  For more information, see <https://www.knot-dns.cz/>
  */
 
+#ifdef ENABLE_JOURNAL_COMPRESSION
+#include <zstd.h>
+#endif
+
 #include "knot/journal/journal_basic.h"
 #include "knot/journal/journal_metadata.h"
 #include "libknot/error.h"
 
+#define JOURNAL_ZSTD_LEVEL 3
+
 MDB_val journal_changeset_id_to_key(bool zone_in_journal, uint32_t serial, const knot_dname_t *zone)
 {
 	if (zone_in_journal) {
@@ -43,11 +49,15 @@ void journal_del_zone(knot_lmdb_txn_t *txn, const knot_dname_t *zone)
 	free(prefix.mv_data);
 }
 
-void journal_make_header(void *chunk, uint32_t ch_serial_to, uint64_t now)
+void journal_make_header(void *chunk, uint32_t ch_serial_to, uint64_t now,
+                         uint32_t flags, uint64_t raw_size)
 {
+	// older versions stored # of chunks in the second field, so the flags are kept
+	// in the trailing reserved field, tagged with a magic value
+	uint64_t flags_word = (flags != 0) ? ((uint64_t)JOURNAL_CHUNK_MAGIC << 32) | flags : 0;
 	knot_lmdb_make_key_part(chunk, JOURNAL_HEADER_SIZE, "IILLL", ch_serial_to,
 	                        (uint32_t)0 /* we no longer care for # of chunks */,
-	                        (uint64_t)0, now, (uint64_t)0);
+	                        raw_size, now, flags_word);
 }
 
 uint32_t journal_next_serial(const MDB_val *chunk)
@@ -60,6 +70,46 @@ uint64_t journal_ch_timestamp(const MDB_val *chunk)
 	return knot_wire_read_u64(chunk->mv_data + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint64_t));
 }
 
+uint32_t journal_chunk_flags(const MDB_val *chunk)
+{
+	uint64_t flags_word = knot_wire_read_u64(chunk->mv_data + JOURNAL_HEADER_SIZE - sizeof(uint64_t));
+	return ((flags_word >> 32) == JOURNAL_CHUNK_MAGIC) ? (uint32_t)flags_word : 0;
+}
+
+uint64_t journal_chunk_raw_size(const MDB_val *chunk)
+{
+	if (journal_chunk_flags(chunk) & JOURNAL_CHUNK_ZSTD) {
+		return knot_wire_read_u64(chunk->mv_data + sizeof(uint32_t) + sizeof(uint32_t));
+	} else {
+		return chunk->mv_size - JOURNAL_HEADER_SIZE;
+	}
+}
+
+size_t journal_compress(const void *src, size_t src_size, void *dst, size_t dst_size)
+{
+#ifdef ENABLE_JOURNAL_COMPRESSION
+	size_t ret = ZSTD_compress(dst, dst_size, src, src_size, JOURNAL_ZSTD_LEVEL);
+	return ZSTD_isError(ret) ? 0 : ret;
+#else
+	return 0;
+#endif
+}
+
+int journal_decompress(const MDB_val *chunk, void *dst, size_t dst_size)
+{
+#ifdef ENABLE_JOURNAL_COMPRESSION
+	uint64_t raw_size = journal_chunk_raw_size(chunk);
+	if (chunk->mv_size < JOURNAL_HEADER_SIZE || raw_size > dst_size) {
+		return KNOT_EMALF;
+	}
+	size_t ret = ZSTD_decompress(dst, raw_size, chunk->mv_data + JOURNAL_HEADER_SIZE,
+	                             chunk->mv_size - JOURNAL_HEADER_SIZE);
+	return (ZSTD_isError(ret) || ret != raw_size) ? KNOT_EMALF : KNOT_EOK;
+#else
+	return KNOT_ENOTSUP;
+#endif
+}
+
 bool journal_serial_to(knot_lmdb_txn_t *txn, bool zij, uint32_t serial,
                        const knot_dname_t *zone, uint32_t *serial_to)
 {
@@ -89,3 +139,13 @@ size_t journal_conf_max_changesets(zone_journal_t j)
 	conf_val_t val = conf_zone_get(j.conf, C_JOURNAL_MAX_DEPTH, j.zone);
 	return conf_int(&val);
 }
+
+bool journal_conf_compression(zone_journal_t j)
+{
+#ifdef ENABLE_JOURNAL_COMPRESSION
+	conf_val_t val = conf_zone_get(j.conf, C_JOURNAL_COMPRESSION, j.zone);
+	return conf_opt(&val) == JOURNAL_COMPRESSION_ZSTD;
+#else
+	return false;
+#endif
+}
@@ -19,6 +19,12 @@ typedef struct {
 #define JOURNAL_CHUNK_MAX (70 * 1024) // must be at least 64k + 6B
 #define JOURNAL_CHUNK_THRESH (15 * 1024)
 #define JOURNAL_HEADER_SIZE (32)
+#define JOURNAL_CHUNK_MAGIC (0x4b434846) // tags the chunk flags in the chunk header
+
+/*! \brief Flags stored in the chunk header. */
+enum journal_chunk_flags {
+	JOURNAL_CHUNK_ZSTD = (1 << 0), // The chunk payload is compressed with zstd.
+};
 
 /*! \brief Convert journal_mode to LMDB environment flags. */
 inline static unsigned journal_env_flags(int journal_mode, bool readonly)
@@ -73,11 +79,14 @@ void journal_del_zone(knot_lmdb_txn_t *txn, const knot_dname_t *zone);
 /*!
  * \brief Initialise chunk header.
  *
- * \param chunk   Pointer to the changeset chunk. It must be at least JOURNAL_HEADER_SIZE, perhaps more.
- * \param ch      Serial-to of the changeset being serialized.
- * \param now     Current timestamp.
+ * \param chunk      Pointer to the changeset chunk. It must be at least JOURNAL_HEADER_SIZE, perhaps more.
+ * \param ch         Serial-to of the changeset being serialized.
+ * \param now        Current timestamp.
+ * \param flags      Chunk flags, see enum journal_chunk_flags.
+ * \param raw_size   Uncompressed size of the payload (ignored if not compressed).
  */
-void journal_make_header(void *chunk, uint32_t ch_serial_to, uint64_t now);
+void journal_make_header(void *chunk, uint32_t ch_serial_to, uint64_t now,
+                         uint32_t flags, uint64_t raw_size);
 
 /*!
  * \brief Obtain serial-to of the serialized changeset.
@@ -97,6 +106,42 @@ uint32_t journal_next_serial(const MDB_val *chunk);
  */
 uint64_t journal_ch_timestamp(const MDB_val *chunk);
 
+/*!
+ * \brief Obtain flags of the chunk, see enum journal_chunk_flags.
+ *
+ * \note Chunks written before compression was introduced have no flags set,
+ *       the flags are valid only if tagged with JOURNAL_CHUNK_MAGIC.
+ */
+uint32_t journal_chunk_flags(const MDB_val *chunk);
+
+/*!
+ * \brief Obtain the uncompressed size of the chunk payload (without header).
+ */
+uint64_t journal_chunk_raw_size(const MDB_val *chunk);
+
+/*!
+ * \brief Compress the chunk payload.
+ *
+ * \param src        Serialized payload.
+ * \param src_size   Payload size.
+ * \param dst        Output buffer.
+ * \param dst_size   Output buffer size.
+ *
+ * \return Size of the compressed payload, 0 if it doesn't fit or not supported.
+ */
+size_t journal_compress(const void *src, size_t src_size, void *dst, size_t dst_size);
+
+/*!
+ * \brief Decompress the chunk payload.
+ *
+ * \param chunk      Compressed chunk including header.
+ * \param dst        Output buffer, at least journal_chunk_raw_size() large.
+ * \param dst_size   Output buffer size.
+ *
+ * \return KNOT_EOK, KNOT_EMALF, KNOT_ENOTSUP.
+ */
+int journal_decompress(const MDB_val *chunk, void *dst, size_t dst_size);
+
 /*!
  * \brief Obtain serial-to of a changeset stored in journal.
  *
@@ -125,3 +170,6 @@ size_t journal_conf_max_usage(zone_journal_t j);
 
 /*! \brief Return configured maximal depth of journal. */
 size_t journal_conf_max_changesets(zone_journal_t j);
+
+/*! \brief Return true if the journal chunks shall be compressed according to conf. */
+bool journal_conf_compression(zone_journal_t j);
@@ -380,6 +380,50 @@ int journal_info(zone_journal_t j, bool *exists, uint32_t *first_serial, bool *h
 	return txn.ret;
 }
 
+static void chunk_sizes(knot_lmdb_txn_t *txn, bool zij, uint32_t serial, const knot_dname_t *zone,
+                        uint64_t *stored, uint64_t *raw, uint32_t *serial_to)
+{
+	MDB_val prefix = journal_changeset_id_to_key(zij, serial, zone);
+	knot_lmdb_foreach(txn, &prefix) {
+		if (!journal_correct_prefix(&prefix, &txn->cur_key)) {
+			continue;
+		}
+		*stored += txn->cur_val.mv_size;
+		*raw += JOURNAL_HEADER_SIZE + journal_chunk_raw_size(&txn->cur_val);
+		*serial_to = journal_next_serial(&txn->cur_val);
+	}
+	free(prefix.mv_data);
+}
+
+int journal_chunk_sizes(zone_journal_t j, bool *compressed, uint64_t *stored, uint64_t *raw)
+{
+	*compressed = false;
+	*stored = 0;
+	*raw = 0;
+
+	int ret = knot_lmdb_open(j.db);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	knot_lmdb_txn_t txn = { 0 };
+	journal_metadata_t md = { 0 };
+	knot_lmdb_begin(j.db, &txn, false);
+	journal_load_metadata(&txn, j.zone, &md);
+	*compressed = (md.flags & JOURNAL_COMPRESSED);
+
+	uint32_t serial = md.first_serial, unused;
+	chunk_sizes(&txn, true, 0, j.zone, stored, raw, &unused);
+	if (md.flags & JOURNAL_MERGED_SERIAL_VALID) {
+		chunk_sizes(&txn, false, md.merged_serial, j.zone, stored, raw, &unused);
+	}
+	for (uint32_t i = 0; i < md.changeset_count && txn.ret == KNOT_EOK; i++) {
+		chunk_sizes(&txn, false, serial, j.zone, stored, raw, &serial);
+	}
+
+	knot_lmdb_abort(&txn);
+	return txn.ret;
+}
+
 int journals_walk(knot_lmdb_db_t *db, journals_walk_cb_t cb, void *ctx)
 {
 	int ret = knot_lmdb_exists(db);
@@ -21,6 +21,7 @@ enum journal_metadata_flags {
 	JOURNAL_LAST_FLUSHED_VALID   = (1 << 0), // deprecated
 	JOURNAL_SERIAL_TO_VALID      = (1 << 1),
 	JOURNAL_MERGED_SERIAL_VALID  = (1 << 2),
+	JOURNAL_COMPRESSED           = (1 << 3), // some chunks may be compressed
 };
 
 typedef int (*journals_walk_cb_t)(const knot_dname_t *zone, void *ctx);
@@ -157,6 +158,18 @@ int journal_info(zone_journal_t j, bool *exists, uint32_t *first_serial, bool *h
                  uint32_t *serial_to, bool *has_merged, uint32_t *merged_serial,
                  uint64_t *occupied, uint64_t *occupied_total);
 
+/*!
+ * \brief Sum the sizes of all the zone's changeset chunks in the DB.
+ *
+ * \param j            Zone journal.
+ * \param compressed   Output: bool if compression has been used for the zone.
+ * \param stored       Output: size of the chunks as stored.
+ * \param raw          Output: size of the chunks if they were uncompressed.
+ *
+ * \return KNOT_E*
+ */
+int journal_chunk_sizes(zone_journal_t j, bool *compressed, uint64_t *stored, uint64_t *raw);
+
 /*! \brief Return true if this zone exists in journal DB. */
 inline static bool journal_is_existing(zone_journal_t j) {
 	bool ex = false;
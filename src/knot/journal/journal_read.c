@@ -20,6 +20,7 @@ struct journal_read {
 	MDB_val key_prefix;
 	const knot_dname_t *zone;
 	wire_ctx_t wire;
+	uint8_t *raw; // buffer for decompressed chunks
 	uint64_t timestamp;
 	uint32_t next;
 	uint32_t changesets_read;
@@ -31,10 +32,28 @@ int journal_read_get_error(const journal_read_t *ctx, int another_error)
 	return (ctx == NULL || ctx->txn.ret == KNOT_EOK ? another_error : ctx->txn.ret);
 }
 
-static void update_ctx_wire(journal_read_t *ctx)
+static bool update_ctx_wire(journal_read_t *ctx)
 {
-	ctx->wire = wire_ctx_init_const(ctx->txn.cur_val.mv_data, ctx->txn.cur_val.mv_size);
-	wire_ctx_skip(&ctx->wire, JOURNAL_HEADER_SIZE);
+	const MDB_val *chunk = &ctx->txn.cur_val;
+	if (!(journal_chunk_flags(chunk) & JOURNAL_CHUNK_ZSTD)) {
+		ctx->wire = wire_ctx_init_const(chunk->mv_data, chunk->mv_size);
+		wire_ctx_skip(&ctx->wire, JOURNAL_HEADER_SIZE);
+		return true;
+	}
+
+	if (ctx->raw == NULL) {
+		ctx->raw = malloc(JOURNAL_CHUNK_MAX);
+		if (ctx->raw == NULL) {
+			ctx->txn.ret = KNOT_ENOMEM;
+			return false;
+		}
+	}
+	ctx->txn.ret = journal_decompress(chunk, ctx->raw, JOURNAL_CHUNK_MAX);
+	if (ctx->txn.ret != KNOT_EOK) {
+		return false;
+	}
+	ctx->wire = wire_ctx_init_const(ctx->raw, journal_chunk_raw_size(chunk));
+	return true;
 }
 
 static bool go_correct_prefix(journal_read_t *ctx)
@@ -67,8 +86,7 @@ static bool go_next_changeset(journal_read_t *ctx, bool go_zone, const knot_dnam
 	}
 	ctx->next = journal_next_serial(&ctx->txn.cur_val);
 	ctx->timestamp = journal_ch_timestamp(&ctx->txn.cur_val);
-	update_ctx_wire(ctx);
-	return true;
+	return update_ctx_wire(ctx);
 }
 
 int journal_read_begin(zone_journal_t j, bool read_zone, uint32_t serial_from, journal_read_t **ctx)
@@ -108,6 +126,7 @@ void journal_read_end(journal_read_t *ctx)
 {
 	if (ctx != NULL) {
 		free(ctx->key_prefix.mv_data);
+		free(ctx->raw);
 		knot_lmdb_abort(&ctx->txn);
 		free(ctx);
 	}
@@ -127,7 +146,7 @@ static bool make_data_available(journal_read_t *ctx)
 			ctx->txn.ret = KNOT_EMALF;
 			return false;
 		}
-		update_ctx_wire(ctx);
+		return update_ctx_wire(ctx);
 	}
 	return true;
 }
@@ -14,34 +14,59 @@
 #include "libknot/error.h"
 
 static void journal_write_serialize(knot_lmdb_txn_t *txn, serialize_ctx_t *ser,
-                                    const knot_dname_t *apex, bool zij, uint32_t ch_from, uint32_t ch_to)
+                                    const knot_dname_t *apex, bool zij, uint32_t ch_from,
+                                    uint32_t ch_to, bool compress)
 {
 	MDB_val chunk;
 	uint32_t i = 0;
 	uint64_t now = knot_time();
+	uint8_t *raw = NULL, *packed = NULL;
+	if (compress) {
+		raw = malloc(2 * JOURNAL_CHUNK_MAX);
+		if (raw == NULL) {
+			txn->ret = KNOT_ENOMEM;
+		} else {
+			packed = raw + JOURNAL_CHUNK_MAX;
+		}
+	}
 	while (serialize_unfinished(ser) && txn->ret == KNOT_EOK) {
+		size_t size;
 		serialize_prepare(ser, JOURNAL_CHUNK_THRESH - JOURNAL_HEADER_SIZE,
-		                  JOURNAL_CHUNK_MAX - JOURNAL_HEADER_SIZE, &chunk.mv_size);
-		if (chunk.mv_size == 0) {
+		                  JOURNAL_CHUNK_MAX - JOURNAL_HEADER_SIZE, &size);
+		if (size == 0) {
 			break; // beware! If this is omitted, it creates empty chunk => EMALF when reading.
 		}
-		chunk.mv_size += JOURNAL_HEADER_SIZE;
+		chunk.mv_size = size + JOURNAL_HEADER_SIZE;
 		chunk.mv_data = NULL;
 		MDB_val key = journal_make_chunk_key(apex, ch_from, zij, i);
-		if (knot_lmdb_insert(txn, &key, &chunk)) {
-			journal_make_header(chunk.mv_data, ch_to, now);
-			serialize_chunk(ser, chunk.mv_data + JOURNAL_HEADER_SIZE, chunk.mv_size - JOURNAL_HEADER_SIZE);
+		if (raw != NULL) {
+			// store the compressed payload only if it's actually smaller
+			serialize_chunk(ser, raw, size);
+			size_t packed_size = journal_compress(raw, size, packed, size - 1);
+			uint32_t flags = (packed_size > 0) ? JOURNAL_CHUNK_ZSTD : 0;
+			if (packed_size > 0) {
+				chunk.mv_size = packed_size + JOURNAL_HEADER_SIZE;
+			}
+			if (knot_lmdb_insert(txn, &key, &chunk)) {
+				journal_make_header(chunk.mv_data, ch_to, now, flags, size);
+				memcpy(chunk.mv_data + JOURNAL_HEADER_SIZE, (packed_size > 0) ? packed : raw,
+				       chunk.mv_size - JOURNAL_HEADER_SIZE);
+			}
+		} else if (knot_lmdb_insert(txn, &key, &chunk)) {
+			journal_make_header(chunk.mv_data, ch_to, now, 0, size);
+			serialize_chunk(ser, chunk.mv_data + JOURNAL_HEADER_SIZE, size);
 		}
 		free(key.mv_data);
 		i++;
 	}
+	free(raw);
 	int ret = serialize_deinit(ser);
 	if (txn->ret == KNOT_EOK) {
 		txn->ret = ret;
 	}
 }
 
-void journal_write_changeset(knot_lmdb_txn_t *txn, const changeset_t *ch)
+void journal_write_changeset(knot_lmdb_txn_t *txn, const changeset_t *ch, bool compress)
 {
 	serialize_ctx_t *ser = serialize_init(ch);
 	if (ser == NULL) {
@@ -49,30 +74,32 @@ void journal_write_changeset(knot_lmdb_txn_t *txn, const changeset_t *ch)
 		return;
 	}
 	if (ch->remove == NULL) {
-		journal_write_serialize(txn, ser, ch->soa_to->owner, true, 0, changeset_to(ch));
+		journal_write_serialize(txn, ser, ch->soa_to->owner, true, 0, changeset_to(ch), compress);
 	} else {
-		journal_write_serialize(txn, ser, ch->soa_to->owner, false, changeset_from(ch), changeset_to(ch));
+		journal_write_serialize(txn, ser, ch->soa_to->owner, false, changeset_from(ch),
+		                        changeset_to(ch), compress);
 	}
 }
 
-void journal_write_zone(knot_lmdb_txn_t *txn, const zone_contents_t *z)
+void journal_write_zone(knot_lmdb_txn_t *txn, const zone_contents_t *z, bool compress)
 {
 	serialize_ctx_t *ser = serialize_zone_init(z);
 	if (ser == NULL) {
 		txn->ret = KNOT_ENOMEM;
 		return;
 	}
-	journal_write_serialize(txn, ser, z->apex->owner, true, 0, zone_contents_serial(z));
+	journal_write_serialize(txn, ser, z->apex->owner, true, 0, zone_contents_serial(z), compress);
 }
 
-void journal_write_zone_diff(knot_lmdb_txn_t *txn, const zone_diff_t *z)
+void journal_write_zone_diff(knot_lmdb_txn_t *txn, const zone_diff_t *z, bool compress)
 {
 	serialize_ctx_t *ser = serialize_zone_diff_init(z);
 	if (ser == NULL) {
 		txn->ret = KNOT_ENOMEM;
 		return;
 	}
-	journal_write_serialize(txn, ser, z->apex->owner, false, zone_diff_from(z), zone_diff_to(z));
+	journal_write_serialize(txn, ser, z->apex->owner, false, zone_diff_from(z),
+	                        zone_diff_to(z), compress);
 }
 
 static bool delete_one(knot_lmdb_txn_t *txn, bool del_zij, uint32_t del_serial,
@@ -125,7 +152,7 @@ void journal_merge(zone_journal_t j, knot_lmdb_txn_t *txn, bool merge_zij,
 		assert(del_next_serial == *original_serial_to);
 	}
 
-	journal_write_changeset(txn, &merge);
+	journal_write_changeset(txn, &merge, journal_conf_compression(j));
 	journal_read_clear_changeset(&merge);
 }
 
@@ -242,10 +269,11 @@ int journal_insert_zone(zone_journal_t j, const zone_contents_t *z)
 	update_last_inserter(&txn, j.zone);
 	journal_del_zone_txn(&txn, j.zone);
 
-	journal_write_zone(&txn, z);
+	bool compress = journal_conf_compression(j);
+	journal_write_zone(&txn, z, compress);
 
 	journal_metadata_t md = { 0 };
-	md.flags = JOURNAL_SERIAL_TO_VALID;
+	md.flags = JOURNAL_SERIAL_TO_VALID | (compress ? JOURNAL_COMPRESSED : 0);
 	md.serial_to = zone_contents_serial(z);
 	md.first_serial = md.serial_to;
 	journal_store_metadata(&txn, j.zone, &md);
@@ -318,15 +346,20 @@ int journal_insert(zone_journal_t j, const changeset_t *ch, const changeset_t *e
 		journal_fix_occupation(j, &txn, &md, INT64_MAX, 1);
 	}
 
+	bool compress = journal_conf_compression(j);
+	if (compress) {
+		md.flags |= JOURNAL_COMPRESSED;
+	}
+
 	if (zdiff == NULL) {
-		journal_write_changeset(&txn, ch);
+		journal_write_changeset(&txn, ch, compress);
 	} else {
-		journal_write_zone_diff(&txn, zdiff);
+		journal_write_zone_diff(&txn, zdiff, compress);
 	}
 	journal_metadata_after_insert(&md, ch_from, ch_to);
 
 	if (extra != NULL) {
-		journal_write_changeset(&txn, extra);
+		journal_write_changeset(&txn, extra, compress);
 		journal_metadata_after_extra(&md, extra_from, extra_to);
 	}
 
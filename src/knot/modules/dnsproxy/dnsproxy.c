@@ -6,6 +6,7 @@
 #include "contrib/net.h"
 #include "knot/include/module.h"
 #include "knot/conf/schema.h"
+#include "knot/modules/dnsproxy/fwd.h"
 #include "knot/query/capture.h" // Forces static module!
 #include "knot/query/requestor.h" // Forces static module!
 #include "libknot/xdp.h"
@@ -16,6 +17,7 @@
 #define MOD_TIMEOUT		"\x07""timeout"
 #define MOD_FALLBACK		"\x08""fallback"
 #define MOD_CATCH_NXDOMAIN	"\x0E""catch-nxdomain"
+#define MOD_ASYNC		"\x05""async"
 
 const yp_item_t dnsproxy_conf[] = {
 	{ MOD_REMOTE,         YP_TREF,  YP_VREF = { C_RMT }, YP_FNONE,
@@ -25,6 +27,7 @@ const yp_item_t dnsproxy_conf[] = {
 	{ MOD_FALLBACK,       YP_TBOOL, YP_VBOOL = { true } },
 	{ MOD_TCP_FASTOPEN,   YP_TBOOL, YP_VNONE },
 	{ MOD_CATCH_NXDOMAIN, YP_TBOOL, YP_VNONE },
+	{ MOD_ASYNC,          YP_TBOOL, YP_VNONE },
 	{ NULL }
 };
 
@@ -47,12 +50,18 @@ typedef struct {
 	bool tfo;
 	bool catch_nxdomain;
 	int timeout;
+	fwd_engine_t *engine;
 } dnsproxy_t;
 
-static int fwd(dnsproxy_t *proxy, knot_pkt_t *pkt, knotd_qdata_t *qdata, int addr_pos)
+static int fwd(dnsproxy_t *proxy, knot_pkt_t *pkt, knotd_qdata_t *qdata,
+               knotd_mod_t *mod, int addr_pos)
 {
 	/* Copy the query as the requestor modifies and frees it. */
-	knot_pkt_t *query = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	size_t max_size = qdata->query->size;
+	if (qdata->query->tsig_rr != NULL) {
+		max_size += knot_rrset_size(qdata->query->tsig_rr);
+	}
+	knot_pkt_t *query = knot_pkt_new(NULL, max_size, qdata->mm);
 	int ret = knot_pkt_copy(query, qdata->query);
 	if (ret != KNOT_EOK) {
 		knot_pkt_free(query);
@@ -87,11 +96,12 @@ static int fwd(dnsproxy_t *proxy, knot_pkt_t *pkt, knotd_qdata_t *qdata, int add
 	}
 #endif
 
-	knot_request_flag_t flags = KNOT_REQUEST_NONE;
+	/* Reuse the upstream TCP connections. */
+	knot_request_flag_t flags = KNOT_REQUEST_KEEP;
 	if (udp) {
 		flags = KNOT_REQUEST_UDP;
 	} else if (proxy->tfo) {
-		flags = KNOT_REQUEST_TFO;
+		flags |= KNOT_REQUEST_TFO;
 	}
 
 	if (query->tsig_rr != NULL) {
@@ -112,7 +122,13 @@ static int fwd(dnsproxy_t *proxy, knot_pkt_t *pkt, knotd_qdata_t *qdata, int add
 	}
 
 	/* Forward request. */
+	unsigned thread_id = qdata->params->thread_id;
+	knotd_mod_stats_incr(mod, thread_id, FWD_CTR_INFLIGHT, 0, 1);
 	ret = knot_requestor_exec(&re, req, proxy->timeout);
+	knotd_mod_stats_decr(mod, thread_id, FWD_CTR_INFLIGHT, 0, 1);
+	if (ret == KNOT_ETIMEOUT) {
+		knotd_mod_stats_incr(mod, thread_id, FWD_CTR_TIMEOUT, 0, 1);
+	}
 
 	if (pkt->tsig_rr != NULL) {
 		knot_tsig_append(pkt->wire, &pkt->size, pkt->max_size, pkt->tsig_rr);
@@ -145,12 +161,21 @@ static knotd_state_t dnsproxy_fwd(knotd_state_t state, knot_pkt_t *pkt,
 		}
 	}
 
+	/* Don't wait for the upstream, the forwarding thread answers. */
+	if (proxy->engine != NULL &&
+	    fwd_engine_query(proxy->engine, qdata) == KNOT_EOK) {
+		return KNOTD_STATE_NOOP;
+	} /* Otherwise (e.g. full query table) forward synchronously. */
+
 	int ret = KNOT_EOK;
 
 	/* Try to forward the packet. */
 	assert(proxy->remote.count > 0);
 	for (int i = 0; i < proxy->remote.count; i++) {
-		ret = fwd(proxy, pkt, qdata, i);
+		if (i > 0) {
+			knotd_mod_stats_incr(mod, qdata->params->thread_id, FWD_CTR_RETRY, 0, 1);
+		}
+		ret = fwd(proxy, pkt, qdata, mod, i);
 		if (ret == KNOT_EOK) {
 			break;
 		}
@@ -166,6 +191,17 @@ static knotd_state_t dnsproxy_fwd(knotd_state_t state, knot_pkt_t *pkt,
 	return (proxy->fallback ? KNOTD_STATE_DONE : KNOTD_STATE_FINAL);
 }
 
+static void ctx_free(dnsproxy_t *ctx)
+{
+	if (ctx != NULL) {
+		fwd_engine_free(ctx->engine);
+		knotd_conf_free(&ctx->remote);
+		knotd_conf_free(&ctx->via);
+		knotd_conf_free(&ctx->addr);
+	}
+	free(ctx);
+}
+
 int dnsproxy_load(knotd_mod_t *mod)
 {
 	dnsproxy_t *proxy = calloc(1, sizeof(*proxy));
@@ -193,6 +229,38 @@ int dnsproxy_load(knotd_mod_t *mod)
 	conf = knotd_conf_mod(mod, MOD_CATCH_NXDOMAIN);
 	proxy->catch_nxdomain = conf.single.boolean;
 
+	int ret = knotd_mod_stats_add(mod, "in-flight", 1, NULL);
+	if (ret == KNOT_EOK) {
+		ret = knotd_mod_stats_add(mod, "timed-out", 1, NULL);
+	}
+	if (ret == KNOT_EOK) {
+		ret = knotd_mod_stats_add(mod, "retried", 1, NULL);
+	}
+	if (ret != KNOT_EOK) {
+		ctx_free(proxy);
+		return ret;
+	}
+
+	conf = knotd_conf_mod(mod, MOD_ASYNC);
+	if (conf.single.boolean) {
+		/* PROXY v2 clients must be answered via the proxy. */
+		knotd_conf_t proxy_allow = knotd_conf(mod, C_SRV, C_PROXY_ALLOWLIST, NULL);
+		bool proxied = proxy_allow.count > 0;
+		knotd_conf_free(&proxy_allow);
+		knotd_conf_t udp_workers = knotd_conf_env(mod, KNOTD_CONF_ENV_WORKERS_UDP);
+		if (proxied) {
+			knotd_mod_log(mod, LOG_WARNING, "asynchronous forwarding not "
+			              "available with proxy-allowlist");
+		} else if (udp_workers.single.integer > 0) {
+			proxy->engine = fwd_engine_new(mod, &proxy->remote, &proxy->via,
+			                               proxy->timeout, udp_workers.single.integer);
+			if (proxy->engine == NULL) {
+				ctx_free(proxy);
+				return KNOT_ENOMEM;
+			}
+		}
+	}
+
 	knotd_mod_ctx_set(mod, proxy);
 
 	if (proxy->fallback) {
@@ -204,13 +272,7 @@ int dnsproxy_load(knotd_mod_t *mod)
 
 void dnsproxy_unload(knotd_mod_t *mod)
 {
-	dnsproxy_t *ctx = knotd_mod_ctx(mod);
-	if (ctx != NULL) {
-		knotd_conf_free(&ctx->remote);
-		knotd_conf_free(&ctx->via);
-		knotd_conf_free(&ctx->addr);
-	}
-	free(ctx);
+	ctx_free(knotd_mod_ctx(mod));
 }
 
 KNOTD_MOD_API(dnsproxy, KNOTD_MOD_FLAG_SCOPE_ANY,
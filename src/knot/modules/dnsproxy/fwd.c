@@ -0,0 +1,487 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "knot/modules/dnsproxy/fwd.h"
+#include "knot/common/fdset.h"
+#include "libdnssec/random.h"
+#include "libknot/libknot.h"
+#include "contrib/atomic.h"
+#include "contrib/net.h"
+#include "contrib/sockaddr.h"
+#include "contrib/threads.h"
+#include "contrib/time.h"
+
+#define FWD_SLOTS	1024  /*!< Outstanding queries per UDP worker. */
+#define FWD_SOCK_QUERIES	64    /*!< Queries sent from one upstream socket (source port). */
+#define FWD_POLL_MS	10    /*!< [ms] Granularity of timeout checking. */
+
+typedef struct fwd_table fwd_table_t;
+
+/*! \brief Upstream socket, replaced by a new one after some queries. */
+typedef struct {
+	fwd_table_t *table;
+	int fd;
+	unsigned sent;                   /*!< Number of queries sent from the socket. */
+	unsigned waiting;                /*!< Outstanding queries sent from the socket. */
+	bool retired;                    /*!< Replaced, closed once no query waits for it. */
+} fwd_sock_t;
+
+/*! \brief Outstanding query. */
+typedef struct {
+	uint8_t *wire;                   /*!< Query with the upstream message ID. */
+	uint16_t len;                    /*!< Query size. */
+	uint16_t id;                     /*!< Upstream message ID. */
+	uint16_t client_id;              /*!< Original message ID. */
+	int client_fd;                   /*!< Socket the query was received on. */
+	struct sockaddr_storage remote;  /*!< Client address. */
+	struct sockaddr_storage local;   /*!< Address the query was received on. */
+	struct timespec sent;            /*!< Time of sending to the current upstream. */
+	unsigned addr_pos;               /*!< Current upstream address index. */
+	fwd_sock_t *sock;                /*!< Socket the query was sent from. */
+} fwd_query_t;
+
+/*! \brief Outstanding queries of one UDP worker. */
+struct fwd_table {
+	pthread_mutex_t lock;
+	fwd_query_t queries[FWD_SLOTS];
+	uint16_t free[FWD_SLOTS];        /*!< Stack of free slots. */
+	unsigned nfree;
+	uint16_t id_slots[UINT16_MAX + 1]; /*!< Slot + 1 of the query with the upstream ID. */
+	fwd_sock_t **socks;              /*!< Current upstream sockets, one per address. */
+	unsigned thread_id;
+};
+
+struct fwd_engine {
+	knotd_mod_t *mod;
+	const knotd_conf_t *remote;
+	const knotd_conf_t *via;
+	int timeout;
+	unsigned addr_count;
+	unsigned table_count;
+	fwd_table_t *tables;
+	fdset_t set;                     /*!< Upstream sockets, fwd_sock_t as context. */
+	pthread_t thread;
+	bool thread_running;
+	knot_atomic_bool stop;
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+};
+
+static size_t question_size(const uint8_t *wire)
+{
+	return knot_dname_size(wire + KNOT_WIRE_HEADER_SIZE) + 2 * sizeof(uint16_t);
+}
+
+/*! \brief Send a message to the client from the address the query was received on. */
+static void reply(const fwd_query_t *q, uint8_t *wire, size_t len)
+{
+	union {
+		struct cmsghdr cmsg;
+		uint8_t buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+	} cmsg = { 0 };
+	size_t cmsg_len = 0;
+
+	if (q->local.ss_family == AF_INET6) {
+		cmsg.cmsg.cmsg_level = IPPROTO_IPV6;
+		cmsg.cmsg.cmsg_type = IPV6_PKTINFO;
+		cmsg.cmsg.cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+		memcpy(&((struct in6_pktinfo *)CMSG_DATA(&cmsg.cmsg))->ipi6_addr,
+		       &((const struct sockaddr_in6 *)&q->local)->sin6_addr,
+		       sizeof(struct in6_addr));
+		cmsg_len = CMSG_SPACE(sizeof(struct in6_pktinfo));
+	} else {
+		cmsg.cmsg.cmsg_level = IPPROTO_IP;
+#if defined(IP_PKTINFO)
+		cmsg.cmsg.cmsg_type = IP_PKTINFO;
+		cmsg.cmsg.cmsg_len = CMSG_LEN(sizeof(struct in_pktinfo));
+		memcpy(&((struct in_pktinfo *)CMSG_DATA(&cmsg.cmsg))->ipi_spec_dst,
+		       &((const struct sockaddr_in *)&q->local)->sin_addr,
+		       sizeof(struct in_addr));
+		cmsg_len = CMSG_SPACE(sizeof(struct in_pktinfo));
+#elif defined(IP_SENDSRCADDR)
+		cmsg.cmsg.cmsg_type = IP_SENDSRCADDR;
+		cmsg.cmsg.cmsg_len = CMSG_LEN(sizeof(struct in_addr));
+		memcpy((struct in_addr *)CMSG_DATA(&cmsg.cmsg),
+		       &((const struct sockaddr_in *)&q->local)->sin_addr,
+		       sizeof(struct in_addr));
+		cmsg_len = CMSG_SPACE(sizeof(struct in_addr));
+#endif
+	}
+
+	struct iovec iov = { .iov_base = wire, .iov_len = len };
+	struct msghdr msg = {
+		.msg_name = (void *)&q->remote,
+		.msg_namelen = sockaddr_len(&q->remote),
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = (cmsg_len > 0) ? &cmsg.cmsg : NULL,
+		.msg_controllen = cmsg_len,
+	};
+
+	(void)sendmsg(q->client_fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+/*! \brief Answer the client with SERVFAIL built from the query header and question. */
+static void reply_servfail(fwd_query_t *q)
+{
+	size_t len = KNOT_WIRE_HEADER_SIZE + question_size(q->wire);
+	assert(len <= q->len);
+
+	knot_wire_set_id(q->wire, q->client_id);
+	knot_wire_set_qr(q->wire);
+	knot_wire_clear_aa(q->wire);
+	knot_wire_clear_tc(q->wire);
+	knot_wire_clear_ad(q->wire);
+	knot_wire_set_rcode(q->wire, KNOT_RCODE_SERVFAIL);
+	knot_wire_set_ancount(q->wire, 0);
+	knot_wire_set_nscount(q->wire, 0);
+	knot_wire_set_arcount(q->wire, 0);
+
+	reply(q, q->wire, len);
+}
+
+static void release(fwd_engine_t *engine, fwd_table_t *table, uint16_t slot)
+{
+	fwd_query_t *q = &table->queries[slot];
+	table->id_slots[q->id] = 0;
+	q->sock->waiting--;
+	free(q->wire);
+	q->wire = NULL;
+	table->free[table->nfree++] = slot;
+
+	knotd_mod_stats_decr(engine->mod, table->thread_id, FWD_CTR_INFLIGHT, 0, 1);
+}
+
+/*! \brief Relay the upstream response to the client if it answers an outstanding query. */
+static void handle_response(fwd_engine_t *engine, fwd_sock_t *sock,
+                            uint8_t *wire, size_t len)
+{
+	if (len < KNOT_WIRE_HEADER_SIZE || !knot_wire_get_qr(wire)) {
+		return;
+	}
+
+	fwd_table_t *table = sock->table;
+	uint16_t id = knot_wire_get_id(wire);
+
+	pthread_mutex_lock(&table->lock);
+
+	unsigned slot = table->id_slots[id];
+	if (slot-- == 0 || table->queries[slot].sock != sock) {
+		pthread_mutex_unlock(&table->lock);
+		return; // Late or spoofed response.
+	}
+	fwd_query_t *q = &table->queries[slot];
+	size_t qsize = question_size(q->wire);
+	if (len < KNOT_WIRE_HEADER_SIZE + qsize ||
+	    memcmp(wire + KNOT_WIRE_HEADER_SIZE, q->wire + KNOT_WIRE_HEADER_SIZE, qsize) != 0) {
+		pthread_mutex_unlock(&table->lock);
+		return;
+	}
+
+	knot_wire_set_id(wire, q->client_id);
+	reply(q, wire, len);
+	release(engine, table, slot);
+
+	pthread_mutex_unlock(&table->lock);
+}
+
+/*! \brief Open a new upstream socket (with a new source port) for the address. */
+static fwd_sock_t *sock_open(fwd_engine_t *engine, fwd_table_t *table, unsigned addr_pos)
+{
+	fwd_sock_t *sock = calloc(1, sizeof(*sock));
+	if (sock == NULL) {
+		return NULL;
+	}
+	sock->table = table;
+
+	const struct sockaddr_storage *src = NULL;
+	if (addr_pos < engine->via->count) { // Simplified via address selection!
+		src = &engine->via->multi[addr_pos].addr;
+	}
+	sock->fd = net_connected_socket(SOCK_DGRAM, &engine->remote->multi[addr_pos].addr,
+	                                src, false);
+	if (sock->fd < 0 || fdset_add(&engine->set, sock->fd, FDSET_POLLIN, sock) < 0) {
+		if (sock->fd >= 0) {
+			close(sock->fd);
+		}
+		free(sock);
+		return NULL;
+	}
+
+	return sock;
+}
+
+/*!
+ * \brief Replace the upstream sockets used for enough queries.
+ *
+ * Each socket has its own ephemeral source port, so an off-path attacker
+ * has to guess it together with the message ID. The old socket is kept
+ * until the queries sent from it are answered or retried.
+ */
+static void rotate(fwd_engine_t *engine, fwd_table_t *table)
+{
+	for (unsigned pos = 0; pos < engine->addr_count; pos++) {
+		fwd_sock_t *sock = table->socks[pos];
+		if (sock->sent < FWD_SOCK_QUERIES) {
+			continue;
+		}
+
+		fwd_sock_t *new_sock = sock_open(engine, table, pos);
+		if (new_sock == NULL) {
+			continue; // Keep using the old one.
+		}
+		table->socks[pos] = new_sock;
+		sock->retired = true;
+	}
+}
+
+/*! \brief Close the replaced sockets no query waits for. */
+static void close_retired(fwd_engine_t *engine)
+{
+	for (unsigned i = fdset_get_length(&engine->set); i > 0; i--) {
+		fwd_sock_t *sock = engine->set.ctx[i - 1];
+		pthread_mutex_lock(&sock->table->lock);
+		bool unused = sock->retired && sock->waiting == 0;
+		pthread_mutex_unlock(&sock->table->lock);
+		if (unused) {
+			(void)fdset_remove(&engine->set, i - 1);
+			free(sock);
+		}
+	}
+}
+
+/*! \brief Send the query from the current socket of its upstream address. */
+static bool send_query(fwd_table_t *table, fwd_query_t *q)
+{
+	fwd_sock_t *sock = table->socks[q->addr_pos];
+	if (send(sock->fd, q->wire, q->len, MSG_DONTWAIT) != q->len) {
+		return false;
+	}
+	if (q->sock != NULL) {
+		q->sock->waiting--;
+	}
+	q->sock = sock;
+	sock->sent++;
+	sock->waiting++;
+
+	return true;
+}
+
+/*! \brief Retry expired queries on the next upstream address or give them up. */
+static void sweep(fwd_engine_t *engine, fwd_table_t *table, const struct timespec *now)
+{
+	pthread_mutex_lock(&table->lock);
+
+	for (unsigned slot = 0; slot < FWD_SLOTS && table->nfree < FWD_SLOTS; slot++) {
+		fwd_query_t *q = &table->queries[slot];
+		if (q->wire == NULL || time_diff_ms(&q->sent, now) < engine->timeout) {
+			continue;
+		}
+
+		if (q->addr_pos + 1 < engine->addr_count) {
+			q->addr_pos++;
+			q->sent = *now;
+			knotd_mod_stats_incr(engine->mod, table->thread_id, FWD_CTR_RETRY, 0, 1);
+			if (send_query(table, q)) {
+				continue;
+			}
+		}
+
+		knotd_mod_stats_incr(engine->mod, table->thread_id, FWD_CTR_TIMEOUT, 0, 1);
+		reply_servfail(q);
+		release(engine, table, slot);
+	}
+
+	rotate(engine, table);
+
+	pthread_mutex_unlock(&table->lock);
+}
+
+static void *fwd_thread(void *arg)
+{
+	fwd_engine_t *engine = arg;
+
+	while (!ATOMIC_GET(engine->stop)) {
+		fdset_it_t it;
+		(void)fdset_poll(&engine->set, &it, 0, FWD_POLL_MS);
+		for (; !fdset_it_is_done(&it); fdset_it_next(&it)) {
+			/* Receiving also clears a socket error (e.g. ICMP unreachable). */
+			int fd = fdset_it_get_fd(&it);
+			fwd_sock_t *sock = fdset_it_get_ctx(&it);
+			ssize_t len;
+			while ((len = recv(fd, engine->buf, sizeof(engine->buf), MSG_DONTWAIT)) > 0) {
+				handle_response(engine, sock, engine->buf, len);
+			}
+		}
+		fdset_it_commit(&it);
+
+		struct timespec now = time_now();
+		for (unsigned i = 0; i < engine->table_count; i++) {
+			sweep(engine, &engine->tables[i], &now);
+		}
+		close_retired(engine);
+	}
+
+	return NULL;
+}
+
+fwd_engine_t *fwd_engine_new(knotd_mod_t *mod, const knotd_conf_t *remote,
+                             const knotd_conf_t *via, int timeout, unsigned tables)
+{
+	assert(remote && via && remote->count > 0);
+
+	fwd_engine_t *engine = calloc(1, sizeof(*engine));
+	if (engine == NULL) {
+		return NULL;
+	}
+	engine->mod = mod;
+	engine->remote = remote;
+	engine->via = via;
+	engine->timeout = timeout;
+	engine->addr_count = remote->count;
+
+	if (fdset_init(&engine->set, 2 * tables * remote->count) != KNOT_EOK) {
+		free(engine);
+		return NULL;
+	}
+
+	engine->tables = calloc(tables, sizeof(*engine->tables));
+	if (engine->tables == NULL) {
+		fwd_engine_free(engine);
+		return NULL;
+	}
+
+	for (unsigned i = 0; i < tables; i++) {
+		fwd_table_t *table = &engine->tables[i];
+		pthread_mutex_init(&table->lock, NULL);
+		table->thread_id = i;
+		for (unsigned slot = FWD_SLOTS; slot > 0; slot--) {
+			table->free[table->nfree++] = slot - 1;
+		}
+		engine->table_count++;
+
+		table->socks = calloc(remote->count, sizeof(*table->socks));
+		if (table->socks == NULL) {
+			fwd_engine_free(engine);
+			return NULL;
+		}
+		for (unsigned pos = 0; pos < remote->count; pos++) {
+			table->socks[pos] = sock_open(engine, table, pos);
+			if (table->socks[pos] == NULL) {
+				fwd_engine_free(engine);
+				return NULL;
+			}
+		}
+	}
+
+	if (thread_create_nosignal(&engine->thread, fwd_thread, engine) != 0) {
+		fwd_engine_free(engine);
+		return NULL;
+	}
+	engine->thread_running = true;
+
+	return engine;
+}
+
+void fwd_engine_free(fwd_engine_t *engine)
+{
+	if (engine == NULL) {
+		return;
+	}
+
+	if (engine->thread_running) {
+		ATOMIC_SET(engine->stop, true);
+		pthread_join(engine->thread, NULL);
+	}
+
+	for (unsigned i = 0; i < engine->table_count; i++) {
+		fwd_table_t *table = &engine->tables[i];
+		for (unsigned slot = 0; slot < FWD_SLOTS; slot++) {
+			free(table->queries[slot].wire);
+		}
+		free(table->socks);
+		pthread_mutex_destroy(&table->lock);
+	}
+	free(engine->tables);
+
+	for (unsigned i = 0; i < fdset_get_length(&engine->set); i++) {
+		close(fdset_get_fd(&engine->set, i));
+		free(engine->set.ctx[i]);
+	}
+	fdset_clear(&engine->set);
+
+	free(engine);
+}
+
+int fwd_engine_query(fwd_engine_t *engine, knotd_qdata_t *qdata)
+{
+	assert(engine && qdata);
+
+	const knotd_qdata_params_t *params = qdata->params;
+	const knot_pkt_t *query = qdata->query;
+	if (params->proto != KNOTD_QUERY_PROTO_UDP || params->xdp_msg != NULL ||
+	    params->thread_id >= engine->table_count || query->tsig_rr != NULL ||
+	    (params->remote->ss_family != AF_INET && params->remote->ss_family != AF_INET6)) {
+		return KNOT_ENOTSUP;
+	}
+
+	uint8_t *wire = malloc(query->size);
+	if (wire == NULL) {
+		return KNOT_ENOMEM;
+	}
+	memcpy(wire, query->wire, query->size);
+
+	fwd_table_t *table = &engine->tables[params->thread_id];
+	pthread_mutex_lock(&table->lock);
+
+	if (table->nfree == 0) {
+		pthread_mutex_unlock(&table->lock);
+		free(wire);
+		return KNOT_ELIMIT;
+	}
+	uint16_t slot = table->free[table->nfree - 1];
+
+	/* Random upstream ID not used by another outstanding query. */
+	uint16_t id;
+	do {
+		id = dnssec_random_uint16_t();
+	} while (table->id_slots[id] != 0);
+	knot_wire_set_id(wire, id);
+
+	fwd_query_t *q = &table->queries[slot];
+	q->wire = wire;
+	q->len = query->size;
+	q->id = id;
+	q->addr_pos = 0;
+	q->sock = NULL;
+	if (!send_query(table, q)) {
+		q->wire = NULL;
+		pthread_mutex_unlock(&table->lock);
+		free(wire);
+		return knot_map_errno();
+	}
+
+	q->client_id = knot_wire_get_id(query->wire);
+	q->client_fd = params->socket;
+	memcpy(&q->remote, params->remote, sizeof(q->remote));
+	memcpy(&q->local, params->local, sizeof(q->local));
+	q->sent = time_now();
+	table->id_slots[id] = slot + 1;
+	table->nfree--;
+
+	knotd_mod_stats_incr(engine->mod, table->thread_id, FWD_CTR_INFLIGHT, 0, 1);
+
+	pthread_mutex_unlock(&table->lock);
+
+	return KNOT_EOK;
+}
@@ -0,0 +1,59 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+/*!
+ * \brief Asynchronous forwarding of UDP queries.
+ *
+ * Each UDP worker has its own table of outstanding queries and its own
+ * non-blocking upstream sockets. A query is sent upstream and the worker
+ * continues without answering; the upstream response is relayed back to
+ * the client by the forwarding thread, which also retries timed out
+ * queries on the next upstream address.
+ */
+
+#pragma once
+
+#include "knot/include/module.h"
+
+/*! \brief Module statistics counters. */
+enum {
+	FWD_CTR_INFLIGHT = 0, /*!< Queries waiting for the upstream. */
+	FWD_CTR_TIMEOUT  = 1, /*!< Queries not answered by any upstream. */
+	FWD_CTR_RETRY    = 2, /*!< Queries retried on the next upstream address. */
+};
+
+typedef struct fwd_engine fwd_engine_t;
+
+/*!
+ * \brief Create the forwarding engine and start the forwarding thread.
+ *
+ * \param mod      Module (for statistics), may be NULL.
+ * \param remote   Upstream addresses (must outlive the engine).
+ * \param via      Source addresses (the N-th for the N-th upstream address,
+ *                 must outlive the engine).
+ * \param timeout  [ms] Upstream response timeout.
+ * \param tables   Number of outstanding query tables (UDP workers).
+ *
+ * \return Engine or NULL if error.
+ */
+fwd_engine_t *fwd_engine_new(knotd_mod_t *mod, const knotd_conf_t *remote,
+                             const knotd_conf_t *via, int timeout, unsigned tables);
+
+/*!
+ * \brief Stop the forwarding thread, drop outstanding queries, free the engine.
+ */
+void fwd_engine_free(fwd_engine_t *engine);
+
+/*!
+ * \brief Forward the query without waiting for the upstream response.
+ *
+ * Only plain UDP queries without TSIG are handled.
+ *
+ * \retval KNOT_EOK      The query is forwarded, the worker must not answer it.
+ * \retval KNOT_ENOTSUP  The query can't be forwarded asynchronously.
+ * \retval KNOT_ELIMIT   Too many outstanding queries of the worker.
+ * \return KNOT_E*       Forwarding failed.
+ */
+int fwd_engine_query(fwd_engine_t *engine, knotd_qdata_t *qdata);
@@ -11,6 +11,7 @@
 #include "libdnssec/error.h"
 #include "knot/include/module.h"
 #include "knot/modules/onlinesign/nsec_next.h"
+#include "knot/modules/onlinesign/rrsig_cache.h"
 // Next dependencies force static module!
 #include "knot/dnssec/ds_query.h"
 #include "knot/dnssec/key-events.h"
@@ -23,6 +24,7 @@
 
 #define MOD_POLICY	"\x06""policy"
 #define MOD_NSEC_BITMAP	"\x0B""nsec-bitmap"
+#define MOD_RRSIG_CACHE	"\x0B""rrsig-cache"
 
 int policy_check(knotd_conf_check_args_t *args)
 {
@@ -49,6 +51,7 @@ int bitmap_check(knotd_conf_check_args_t *args)
 const yp_item_t online_sign_conf[] = {
 	{ MOD_POLICY,      YP_TREF, YP_VREF = { C_POLICY }, YP_FNONE, { policy_check } },
 	{ MOD_NSEC_BITMAP, YP_TSTR, YP_VNONE, YP_FMULTI, { bitmap_check } },
+	{ MOD_RRSIG_CACHE, YP_TINT, YP_VINT = { 0, 65536, 128 } },
 	{ NULL }
 };
 
@@ -76,6 +79,11 @@ typedef struct {
 
 	uint16_t *nsec_force_types;
 
+	uint64_t keys_generation;  // Incremented on each keyset reload.
+	rrsig_cache_t **rrsig_caches; // One per worker thread, allocated on first use.
+	unsigned rrsig_cache_count;
+	unsigned rrsig_cache_size; // Slots of each cache.
+
 	bool zone_doomed;
 } online_sign_ctx_t;
 
@@ -219,46 +227,88 @@ static knot_rrset_t *synth_nsec(knot_pkt_t *pkt, knotd_qdata_t *qdata, knotd_mod
 	return nsec;
 }
 
+/*!
+ * \brief Get the RRSIG cache of the current worker thread, create it if needed.
+ */
+static rrsig_cache_t *thread_cache(online_sign_ctx_t *ctx, knotd_qdata_t *qdata)
+{
+	unsigned thread_id = qdata->params->thread_id;
+	if (thread_id >= ctx->rrsig_cache_count) {
+		return NULL;
+	}
+
+	// Only the owning thread accesses its cache, a failed allocation is retried.
+	rrsig_cache_t **cache = &ctx->rrsig_caches[thread_id];
+	if (*cache == NULL) {
+		*cache = rrsig_cache_new(ctx->rrsig_cache_size);
+	}
+	return *cache;
+}
+
+/*!
+ * \brief Cached RRSIGs are reused for a fraction of the signature lifetime so
+ *        that they never get close to their expiration.
+ */
+static knot_time_t cache_expire(knotd_mod_t *mod, knot_time_t now)
+{
+	return now + mod->dnssec->policy->rrsig_lifetime / 4;
+}
+
 static knot_rrset_t *sign_rrset(const knot_dname_t *owner,
                                 const knot_rrset_t *cover,
                                 knotd_mod_t *mod,
                                 zone_sign_ctx_t *sign_ctx,
+                                rrsig_cache_t *cache,
                                 knot_mm_t *mm)
 {
+	// resulting RRSIG
+
+	knot_rrset_t *rrsig = knot_rrset_new(owner, KNOT_RRTYPE_RRSIG, cover->rclass,
+	                                     cover->ttl, mm);
+	if (!rrsig) {
+		return NULL;
+	}
+
+	online_sign_ctx_t *ctx = knotd_mod_ctx(mod);
+	pthread_rwlock_rdlock(&ctx->signing_mutex);
+	knot_time_t now = knot_time();
+	if (cache != NULL &&
+	    rrsig_cache_get(cache, owner, cover, ctx->keys_generation, now,
+	                    &rrsig->rrs, mm) == KNOT_EOK) {
+		pthread_rwlock_unlock(&ctx->signing_mutex);
+		return rrsig;
+	}
+
 	// copy of RR set with replaced owner name
 
 	knot_rrset_t *copy = knot_rrset_new(owner, cover->type, cover->rclass,
 	                                    cover->ttl, NULL);
 	if (!copy) {
+		pthread_rwlock_unlock(&ctx->signing_mutex);
+		knot_rrset_free(rrsig, mm);
 		return NULL;
 	}
 
 	if (knot_rdataset_copy(&copy->rrs, &cover->rrs, NULL) != KNOT_EOK) {
+		pthread_rwlock_unlock(&ctx->signing_mutex);
 		knot_rrset_free(copy, NULL);
+		knot_rrset_free(rrsig, mm);
 		return NULL;
 	}
 
-	// resulting RRSIG
-
-	knot_rrset_t *rrsig = knot_rrset_new(owner, KNOT_RRTYPE_RRSIG, copy->rclass,
-	                                     copy->ttl, mm);
-	if (!rrsig) {
-		knot_rrset_free(copy, NULL);
-		return NULL;
-	}
-
-	online_sign_ctx_t *ctx = knotd_mod_ctx(mod);
-	pthread_rwlock_rdlock(&ctx->signing_mutex);
 	int ret = knot_sign_rrset2(rrsig, copy, sign_ctx, mm);
+	if (ret == KNOT_EOK && cache != NULL) {
+		// Failure to cache isn't fatal.
+		(void)rrsig_cache_put(cache, owner, cover, ctx->keys_generation,
+		                      cache_expire(mod, now), &rrsig->rrs);
+	}
 	pthread_rwlock_unlock(&ctx->signing_mutex);
+	knot_rrset_free(copy, NULL);
 	if (ret != KNOT_EOK) {
-		knot_rrset_free(copy, NULL);
 		knot_rrset_free(rrsig, mm);
 		return NULL;
 	}
 
-	knot_rrset_free(copy, NULL);
-
 	return rrsig;
 }
 
@@ -307,6 +357,8 @@ static knotd_in_state_t sign_section(knotd_in_state_t state, knot_pkt_t *pkt,
 		return KNOTD_IN_STATE_ERROR;
 	}
 
+	rrsig_cache_t *cache = thread_cache(knotd_mod_ctx(mod), qdata);
+
 	uint16_t count_unsigned = section->count;
 	for (int i = 0; i < count_unsigned; i++) {
 		const knot_rrset_t *rr = knot_pkt_rr(section, i);
@@ -320,7 +372,7 @@ static knotd_in_state_t sign_section(knotd_in_state_t state, knot_pkt_t *pkt,
 		knot_dname_unpack(owner, pkt->wire + rr_pos, sizeof(owner), pkt->wire);
 		knot_dname_to_lower(owner);
 
-		knot_rrset_t *rrsig = sign_rrset(owner, rr, mod, sign_ctx, &pkt->mm);
+		knot_rrset_t *rrsig = sign_rrset(owner, rr, mod, sign_ctx, cache, &pkt->mm);
 		if (!rrsig) {
 			state = KNOTD_IN_STATE_ERROR;
 			break;
@@ -504,6 +556,7 @@ static knotd_in_state_t pre_routine(knotd_in_state_t state, knot_pkt_t *pkt,
 		pthread_rwlock_wrlock(&ctx->signing_mutex);
 		knotd_mod_dnssec_unload_keyset(mod);
 		ret = knotd_mod_dnssec_load_keyset(mod, true);
+		ctx->keys_generation++; // Invalidates cached RRSIGs.
 		if (ret != KNOT_EOK) {
 			ctx->zone_doomed = true;
 			state = KNOTD_IN_STATE_ERROR;
@@ -594,6 +647,11 @@ static void online_sign_ctx_free(online_sign_ctx_t *ctx)
 	pthread_mutex_destroy(&ctx->event_mutex);
 	pthread_rwlock_destroy(&ctx->signing_mutex);
 
+	for (unsigned i = 0; i < ctx->rrsig_cache_count; i++) {
+		rrsig_cache_free(ctx->rrsig_caches[i]);
+	}
+	free(ctx->rrsig_caches);
+
 	free(ctx->nsec_force_types);
 	free(ctx);
 }
@@ -636,6 +694,18 @@ static int online_sign_ctx_new(online_sign_ctx_t **ctx_ptr, knotd_mod_t *mod)
 
 	ctx->event_rollover = knot_time_min(ctx->event_rollover, knot_get_next_zone_key_event(mod->keyset));
 
+	knotd_conf_t conf = knotd_conf_mod(mod, MOD_RRSIG_CACHE);
+	ctx->rrsig_cache_size = conf.single.integer;
+	if (ctx->rrsig_cache_size > 0) {
+		unsigned threads = knotd_mod_threads(mod);
+		ctx->rrsig_caches = calloc(threads, sizeof(*ctx->rrsig_caches));
+		if (ctx->rrsig_caches == NULL) {
+			free(ctx);
+			return KNOT_ENOMEM;
+		}
+		ctx->rrsig_cache_count = threads;
+	}
+
 	pthread_mutex_init(&ctx->event_mutex, NULL);
 	pthread_rwlock_init(&ctx->signing_mutex, NULL);
 
@@ -0,0 +1,133 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/modules/onlinesign/rrsig_cache.h"
+#include "libdnssec/random.h"
+#include "contrib/openbsd/siphash.h"
+
+typedef struct {
+	uint64_t hash;            /*!< Hash of owner, type, TTL and rdata. */
+	uint64_t generation;      /*!< Signing keys generation. */
+	knot_time_t expire;       /*!< Entry validity. */
+	knot_dname_t *owner;      /*!< Owner of the covered RR set. */
+	uint16_t type;            /*!< Type of the covered RR set. */
+	uint32_t ttl;             /*!< TTL of the covered RR set. */
+	knot_rdataset_t rrsigs;   /*!< Cached RRSIGs. */
+} rrsig_cache_entry_t;
+
+struct rrsig_cache {
+	SIPHASH_KEY key;
+	unsigned mask;
+	rrsig_cache_entry_t slots[];
+};
+
+static uint64_t entry_hash(const rrsig_cache_t *cache, const knot_dname_t *owner,
+                           const knot_rrset_t *cover)
+{
+	SIPHASH_CTX ctx;
+	SipHash24_Init(&ctx, &cache->key);
+	SipHash24_Update(&ctx, owner, knot_dname_size(owner));
+	SipHash24_Update(&ctx, &cover->type, sizeof(cover->type));
+	SipHash24_Update(&ctx, &cover->ttl, sizeof(cover->ttl));
+	SipHash24_Update(&ctx, cover->rrs.rdata, cover->rrs.size);
+	return SipHash24_End(&ctx);
+}
+
+static void entry_clear(rrsig_cache_entry_t *entry)
+{
+	knot_dname_free(entry->owner, NULL);
+	knot_rdataset_clear(&entry->rrsigs, NULL);
+	memset(entry, 0, sizeof(*entry));
+}
+
+rrsig_cache_t *rrsig_cache_new(unsigned size)
+{
+	unsigned slots = 1;
+	while (slots < size) {
+		slots <<= 1;
+	}
+
+	rrsig_cache_t *cache = calloc(1, sizeof(*cache) + slots * sizeof(rrsig_cache_entry_t));
+	if (cache == NULL) {
+		return NULL;
+	}
+
+	dnssec_random_buffer((uint8_t *)&cache->key, sizeof(cache->key));
+	cache->mask = slots - 1;
+
+	return cache;
+}
+
+void rrsig_cache_free(rrsig_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	for (unsigned i = 0; i <= cache->mask; i++) {
+		entry_clear(&cache->slots[i]);
+	}
+	free(cache);
+}
+
+int rrsig_cache_get(rrsig_cache_t *cache, const knot_dname_t *owner,
+                    const knot_rrset_t *cover, uint64_t generation,
+                    knot_time_t now, knot_rdataset_t *rrsigs, knot_mm_t *mm)
+{
+	if (cache == NULL || owner == NULL || cover == NULL || rrsigs == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	uint64_t hash = entry_hash(cache, owner, cover);
+	rrsig_cache_entry_t *entry = &cache->slots[hash & cache->mask];
+
+	if (entry->owner == NULL || entry->hash != hash ||
+	    entry->generation != generation || entry->type != cover->type ||
+	    entry->ttl != cover->ttl || !knot_dname_is_equal(entry->owner, owner)) {
+		return KNOT_ENOENT;
+	}
+
+	if (knot_time_cmp(entry->expire, now) <= 0) {
+		entry_clear(entry);
+		return KNOT_ENOENT;
+	}
+
+	return knot_rdataset_copy(rrsigs, &entry->rrsigs, mm);
+}
+
+int rrsig_cache_put(rrsig_cache_t *cache, const knot_dname_t *owner,
+                    const knot_rrset_t *cover, uint64_t generation,
+                    knot_time_t expire, const knot_rdataset_t *rrsigs)
+{
+	if (cache == NULL || owner == NULL || cover == NULL || rrsigs == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	uint64_t hash = entry_hash(cache, owner, cover);
+	rrsig_cache_entry_t *entry = &cache->slots[hash & cache->mask];
+	entry_clear(entry);
+
+	entry->owner = knot_dname_copy(owner, NULL);
+	if (entry->owner == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	int ret = knot_rdataset_copy(&entry->rrsigs, rrsigs, NULL);
+	if (ret != KNOT_EOK) {
+		entry_clear(entry);
+		return ret;
+	}
+
+	entry->hash = hash;
+	entry->generation = generation;
+	entry->expire = expire;
+	entry->type = cover->type;
+	entry->ttl = cover->ttl;
+
+	return KNOT_EOK;
+}
@@ -0,0 +1,71 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+/*!
+ * \brief Cache of generated RRSIGs.
+ *
+ * Direct-mapped table of RRSIG rdatasets, keyed by the owner name, type,
+ * TTL and a hash of the covered rdata. The cache isn't synchronized, each
+ * worker thread is supposed to have its own instance.
+ */
+
+#pragma once
+
+#include "contrib/time.h"
+#include "libknot/dname.h"
+#include "libknot/rrset.h"
+
+typedef struct rrsig_cache rrsig_cache_t;
+
+/*!
+ * \brief Create an empty cache.
+ *
+ * \param size  Number of slots (rounded up to a power of two).
+ *
+ * \return Cache or NULL if error.
+ */
+rrsig_cache_t *rrsig_cache_new(unsigned size);
+
+/*!
+ * \brief Free the cache including all stored RRSIGs.
+ */
+void rrsig_cache_free(rrsig_cache_t *cache);
+
+/*!
+ * \brief Look up the RRSIGs covering the given RR set.
+ *
+ * \param cache       Cache.
+ * \param owner       Owner name of the covered RR set (lower-case).
+ * \param cover       Covered RR set (its owner is ignored).
+ * \param generation  Current signing keys generation.
+ * \param now         Current time.
+ * \param rrsigs      Output rdataset, filled with a copy of the cached RRSIGs.
+ * \param mm          Memory context for the output rdataset.
+ *
+ * \retval KNOT_EOK     Cache hit.
+ * \retval KNOT_ENOENT  No valid entry found.
+ * \return KNOT_E*      Other error.
+ */
+int rrsig_cache_get(rrsig_cache_t *cache, const knot_dname_t *owner,
+                    const knot_rrset_t *cover, uint64_t generation,
+                    knot_time_t now, knot_rdataset_t *rrsigs, knot_mm_t *mm);
+
+/*!
+ * \brief Store the RRSIGs covering the given RR set.
+ *
+ * A previous entry occupying the same slot is replaced.
+ *
+ * \param cache       Cache.
+ * \param owner       Owner name of the covered RR set (lower-case).
+ * \param cover       Covered RR set (its owner is ignored).
+ * \param generation  Signing keys generation used for the RRSIGs.
+ * \param expire      Time when the entry stops being valid.
+ * \param rrsigs      RRSIGs to be stored (copied).
+ *
+ * \return KNOT_E*
+ */
+int rrsig_cache_put(rrsig_cache_t *cache, const knot_dname_t *owner,
+                    const knot_rrset_t *cover, uint64_t generation,
+                    knot_time_t expire, const knot_rdataset_t *rrsigs);
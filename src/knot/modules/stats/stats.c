@@ -21,6 +21,7 @@
 #define MOD_QTYPE	"\x0A""query-type"
 #define MOD_QSIZE	"\x0A""query-size"
 #define MOD_RSIZE	"\x0A""reply-size"
+#define MOD_NSEC3_CACHE	"\x0B""nsec3-cache"
 
 #define OTHER		"other"
 
@@ -38,6 +39,7 @@ const yp_item_t stats_conf[] = {
 	{ MOD_QTYPE,      YP_TBOOL, YP_VNONE },
 	{ MOD_QSIZE,      YP_TBOOL, YP_VNONE },
 	{ MOD_RSIZE,      YP_TBOOL, YP_VNONE },
+	{ MOD_NSEC3_CACHE, YP_TBOOL, YP_VNONE },
 	{ NULL }
 };
 
@@ -55,6 +57,7 @@ enum {
 	CTR_QTYPE,
 	CTR_QSIZE,
 	CTR_RSIZE,
+	CTR_NSEC3_CACHE,
 };
 
 typedef struct {
@@ -71,6 +74,7 @@ typedef struct {
 	bool qtype;
 	bool qsize;
 	bool rsize;
+	bool nsec3_cache;
 } stats_t;
 
 typedef struct {
@@ -279,6 +283,21 @@ enum {
 	QTYPE__COUNT = QTYPE_MAX3 - QTYPE_SHIFT3 + 1
 };
 
+enum {
+	NSEC3_CACHE_HIT = 0,
+	NSEC3_CACHE_MISS,
+	NSEC3_CACHE__COUNT
+};
+
+static char *nsec3_cache_to_str(uint32_t idx, uint32_t count)
+{
+	switch (idx) {
+	case NSEC3_CACHE_HIT:  return strdup("hit");
+	case NSEC3_CACHE_MISS: return strdup("miss");
+	default:               assert(0); return NULL;
+	}
+}
+
 static char *qtype_to_str(uint32_t idx, uint32_t count)
 {
 	if (idx == QTYPE_OTHER) {
@@ -355,6 +374,7 @@ static const ctr_desc_t ctr_descs[] = {
 	item(QTYPE,      qtype,      QTYPE__COUNT),
 	item(QSIZE,      qsize,      QSIZE_MAX_IDX + 1),
 	item(RSIZE,      rsize,      RSIZE_MAX_IDX + 1),
+	item(NSEC3_CACHE, nsec3_cache, NSEC3_CACHE__COUNT),
 	{ NULL }
 };
 
@@ -638,6 +658,19 @@ static knotd_state_t update_counters(knotd_state_t state, knot_pkt_t *pkt,
 		knotd_mod_stats_incr(mod, tid, CTR_RSIZE, MIN(idx, RSIZE_MAX_IDX), 1);
 	}
 
+	// Count the NSEC3 hash cache usage.
+	if (stats->nsec3_cache) {
+		knotd_qdata_extra_t *extra = qdata->extra;
+		if (extra->nsec3_cache_hits > 0) {
+			knotd_mod_stats_incr(mod, tid, CTR_NSEC3_CACHE, NSEC3_CACHE_HIT,
+			                     extra->nsec3_cache_hits);
+		}
+		if (extra->nsec3_cache_misses > 0) {
+			knotd_mod_stats_incr(mod, tid, CTR_NSEC3_CACHE, NSEC3_CACHE_MISS,
+			                     extra->nsec3_cache_misses);
+		}
+	}
+
 	return state;
 }
 
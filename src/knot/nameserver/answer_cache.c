@@ -0,0 +1,121 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/nameserver/answer_cache.h"
+#include "libdnssec/random.h"
+#include "contrib/openbsd/siphash.h"
+#include "contrib/spinlock.h"
+
+typedef struct {
+	uint16_t key_len;
+	uint16_t wire_len;
+	uint8_t data[]; // Key followed by the wire.
+} cache_entry_t;
+
+typedef struct {
+	knot_spin_t lock;
+	cache_entry_t *entry;
+} cache_slot_t;
+
+struct answer_cache {
+	SIPHASH_KEY hash_key;
+	size_t size;
+	cache_slot_t slots[];
+};
+
+static cache_slot_t *get_slot(answer_cache_t *cache, const uint8_t *key, size_t key_len)
+{
+	SIPHASH_CTX hash;
+	SipHash24_Init(&hash, &cache->hash_key);
+	SipHash24_Update(&hash, key, key_len);
+	uint64_t idx = SipHash24_End(&hash) % cache->size;
+
+	return &cache->slots[idx];
+}
+
+answer_cache_t *answer_cache_new(size_t slots)
+{
+	if (slots == 0) {
+		return NULL;
+	}
+
+	answer_cache_t *cache = calloc(1, sizeof(*cache) + slots * sizeof(cache_slot_t));
+	if (cache == NULL) {
+		return NULL;
+	}
+
+	(void)dnssec_random_buffer((uint8_t *)&cache->hash_key, sizeof(cache->hash_key));
+	cache->size = slots;
+	for (size_t i = 0; i < slots; i++) {
+		knot_spin_init(&cache->slots[i].lock);
+	}
+
+	return cache;
+}
+
+void answer_cache_free(answer_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < cache->size; i++) {
+		knot_spin_destroy(&cache->slots[i].lock);
+		free(cache->slots[i].entry);
+	}
+	free(cache);
+}
+
+size_t answer_cache_get(answer_cache_t *cache, const uint8_t *key, size_t key_len,
+                        uint8_t *wire, size_t max_len)
+{
+	assert(cache && key && wire);
+
+	cache_slot_t *slot = get_slot(cache, key, key_len);
+	size_t len = 0;
+
+	knot_spin_lock(&slot->lock);
+	cache_entry_t *entry = slot->entry;
+	if (entry != NULL && entry->key_len == key_len && entry->wire_len <= max_len &&
+	    memcmp(entry->data, key, key_len) == 0) {
+		len = entry->wire_len;
+		memcpy(wire, entry->data + key_len, len);
+	}
+	knot_spin_unlock(&slot->lock);
+
+	return len;
+}
+
+void answer_cache_put(answer_cache_t *cache, const uint8_t *key, size_t key_len,
+                      const uint8_t *wire, size_t wire_len)
+{
+	assert(cache && key && wire);
+
+	if (key_len > ANSWER_CACHE_MAX_KEY || wire_len > ANSWER_CACHE_MAX_WIRE) {
+		return;
+	}
+
+	cache_entry_t *entry = malloc(sizeof(*entry) + key_len + wire_len);
+	if (entry == NULL) {
+		return;
+	}
+	entry->key_len = key_len;
+	entry->wire_len = wire_len;
+	memcpy(entry->data, key, key_len);
+	memcpy(entry->data + key_len, wire, wire_len);
+
+	cache_slot_t *slot = get_slot(cache, key, key_len);
+
+	knot_spin_lock(&slot->lock);
+	cache_entry_t *old = slot->entry;
+	slot->entry = entry;
+	knot_spin_unlock(&slot->lock);
+
+	free(old);
+}
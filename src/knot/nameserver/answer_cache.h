@@ -0,0 +1,64 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*! \brief Maximal size of a cached answer. */
+#define ANSWER_CACHE_MAX_WIRE 4096
+
+/*! \brief Maximal size of a cache key. */
+#define ANSWER_CACHE_MAX_KEY 300
+
+/*!
+ * \brief Cache of rendered answers bound to one version of zone contents.
+ *
+ * The cache is a fixed-size hash table, a colliding entry replaces the
+ * previous one. Concurrent readers and writers are allowed.
+ */
+typedef struct answer_cache answer_cache_t;
+
+/*!
+ * \brief Create an answer cache.
+ *
+ * \param slots  Number of cache slots.
+ *
+ * \return New cache or NULL if no memory.
+ */
+answer_cache_t *answer_cache_new(size_t slots);
+
+/*!
+ * \brief Free the answer cache.
+ */
+void answer_cache_free(answer_cache_t *cache);
+
+/*!
+ * \brief Look up a cached answer.
+ *
+ * \param cache    Answer cache.
+ * \param key      Cache key.
+ * \param key_len  Cache key length.
+ * \param wire     Output buffer for the answer.
+ * \param max_len  Output buffer size.
+ *
+ * \return Answer size, 0 if not found or doesn't fit.
+ */
+size_t answer_cache_get(answer_cache_t *cache, const uint8_t *key, size_t key_len,
+                        uint8_t *wire, size_t max_len);
+
+/*!
+ * \brief Store an answer into the cache.
+ *
+ * \param cache     Answer cache.
+ * \param key       Cache key.
+ * \param key_len   Cache key length.
+ * \param wire      Answer to be stored.
+ * \param wire_len  Answer size.
+ */
+void answer_cache_put(answer_cache_t *cache, const uint8_t *key, size_t key_len,
+                      const uint8_t *wire, size_t wire_len);
@@ -8,6 +8,7 @@
 #include "contrib/mempattern.h"
 #include "contrib/sockaddr.h"
 #include "knot/nameserver/axfr.h"
+#include "knot/nameserver/axfr_cache.h"
 #include "knot/nameserver/internet.h"
 #include "knot/nameserver/log.h"
 #include "knot/nameserver/xfr.h"
@@ -28,15 +29,16 @@ struct axfr_proc {
 	trie_it_t *i;
 	zone_tree_it_t it;
 	unsigned cur_rrset;
+	axfr_cache_t *cache;     //!< Shared rendered messages (optional).
+	unsigned cache_reused;   //!< Messages rendered by other transfers.
 };
 
-static int axfr_put_rrsets(knot_pkt_t *pkt, zone_node_t *node,
-                           struct axfr_proc *state)
+int axfr_put_node(knot_pkt_t *pkt, zone_node_t *node, unsigned *cur_rrset)
 {
 	assert(node != NULL);
 
 	/* Append all RRs. */
-	for (unsigned i = state->cur_rrset; i < node->rrset_count; ++i) {
+	for (unsigned i = *cur_rrset; i < node->rrset_count; ++i) {
 		knot_rrset_t rrset = node_rrset_at(node, i);
 		if (rrset.type == KNOT_RRTYPE_SOA) {
 			continue;
@@ -45,18 +47,18 @@ static int axfr_put_rrsets(knot_pkt_t *pkt, zone_node_t *node,
 		int ret = knot_pkt_put(pkt, 0, &rrset, KNOT_PF_NOTRUNC | KNOT_PF_ORIGTTL);
 		if (ret != KNOT_EOK) {
 			/* If something failed, remember the current RR for later. */
-			state->cur_rrset = i;
+			*cur_rrset = i;
 			return ret;
 		}
 		if (pkt->size > KNOT_WIRE_PTR_MAX) {
 			// optimization: once the XFR DNS message is > 16 KiB, compression
 			// is limited. Better wrap to next message.
-			state->cur_rrset = i + 1;
+			*cur_rrset = i + 1;
 			return KNOT_ESPACE;
 		}
 	}
 
-	state->cur_rrset = 0;
+	*cur_rrset = 0;
 
 	return KNOT_EOK;
 }
@@ -73,7 +75,7 @@ static int axfr_process_node_tree(knot_pkt_t *pkt, const void *item,
 	/* Put responses. */
 	while (ret == KNOT_EOK && !zone_tree_it_finished(&axfr->it)) {
 		zone_node_t *node = zone_tree_it_val(&axfr->it);
-		ret = axfr_put_rrsets(pkt, node, axfr);
+		ret = axfr_put_node(pkt, node, &axfr->cur_rrset);
 		if (ret == KNOT_EOK) {
 			zone_tree_it_next(&axfr->it);
 		}
@@ -92,6 +94,7 @@ static void axfr_query_cleanup(knotd_qdata_t *qdata)
 
 	zone_tree_it_free(&axfr->it);
 	ptrlist_free(&axfr->proc.nodes, qdata->mm);
+	axfr_cache_unref(axfr->cache);
 	mm_free(qdata->mm, axfr);
 
 	/* Allow zone changes (finished). */
@@ -100,7 +103,9 @@ static void axfr_query_cleanup(knotd_qdata_t *qdata)
 
 static void axfr_answer_finished(knotd_qdata_t *qdata, knot_pkt_t *pkt, int state)
 {
-	struct xfr_proc *xfr = qdata->extra->ext;
+	struct axfr_proc *axfr = qdata->extra->ext;
+	struct xfr_proc *xfr = &axfr->proc;
+	char cache_log[32] = "";
 
 	switch (state) {
 	case KNOT_STATE_PRODUCE:
@@ -109,8 +114,12 @@ static void axfr_answer_finished(knotd_qdata_t *qdata, knot_pkt_t *pkt, int stat
 	case KNOT_STATE_DONE:
 		xfr_stats_add(&xfr->stats, pkt->size);
 		xfr_stats_end(&xfr->stats);
+		if (axfr->cache != NULL) {
+			(void)snprintf(cache_log, sizeof(cache_log), " reused %u cached messages,",
+			               axfr->cache_reused);
+		}
 		xfr_log_finished(ZONE_NAME(qdata), LOG_OPERATION_AXFR, LOG_DIRECTION_OUT,
-				 REMOTE(qdata), PROTO(qdata), KEY(qdata), "", &xfr->stats);
+				 REMOTE(qdata), PROTO(qdata), KEY(qdata), cache_log, &xfr->stats);
 		break;
 	default:
 		break;
@@ -164,6 +173,10 @@ static int axfr_query_init(knotd_qdata_t *qdata)
 	if (!zone_tree_is_empty(contents->nsec3_nodes)) {
 		ptrlist_add(&axfr->proc.nodes, contents->nsec3_nodes, mm);
 	}
+	/* Share the rendered messages with other transfers if enabled. */
+	if (contents->axfr_cache != NULL) {
+		axfr->cache = axfr_cache_ref(contents->axfr_cache);
+	}
 
 	/* Set up cleanup callback. */
 	qdata->extra->ext = axfr;
@@ -218,8 +231,21 @@ knot_layer_state_t axfr_process_query(knot_pkt_t *pkt, knotd_qdata_t *qdata)
 		return KNOT_STATE_FAIL;
 	}
 
+	/* Fall back to rendering if the cached messages don't fit the response. */
+	unsigned msg_idx = axfr->proc.stats.messages;
+	if (axfr->cache != NULL && msg_idx == 0 && !axfr_cache_usable(axfr->cache, pkt)) {
+		axfr_cache_unref(axfr->cache);
+		axfr->cache = NULL;
+	}
+
 	/* Answer current packet (or continue). */
-	ret = xfr_process_list(pkt, &axfr_process_node_tree, qdata);
+	if (axfr->cache != NULL) {
+		bool rendered = false;
+		ret = axfr_cache_write(axfr->cache, msg_idx, pkt, &rendered);
+		axfr->cache_reused += rendered ? 0 : 1;
+	} else {
+		ret = xfr_process_list(pkt, &axfr_process_node_tree, qdata);
+	}
 	switch (ret) {
 	case KNOT_ESPACE: /* Couldn't write more, send packet and continue. */
 		return KNOT_STATE_PRODUCE; /* Check for more. */
@@ -6,8 +6,22 @@
 #pragma once
 
 #include "knot/nameserver/process_query.h"
+#include "knot/zone/node.h"
 #include "libknot/packet/pkt.h"
 
+/*!
+ * \brief Put all but SOA RRSets of a node into the AXFR message.
+ *
+ * \param pkt        Message being filled.
+ * \param node       Zone node.
+ * \param cur_rrset  In/out: index of the RRSet to continue with, reset
+ *                   to zero once the node is finished.
+ *
+ * \retval KNOT_ESPACE  if the message is full.
+ * \return KNOT_EOK or an error.
+ */
+int axfr_put_node(knot_pkt_t *pkt, zone_node_t *node, unsigned *cur_rrset);
+
 /*!
  * \brief Process an AXFR query message.
  */
@@ -0,0 +1,283 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/nameserver/axfr.h"
+#include "knot/nameserver/axfr_cache.h"
+#include "knot/nameserver/xfr.h"
+#include "knot/zone/contents.h"
+#include "libknot/libknot.h"
+
+typedef struct {
+	uint16_t ancount;
+	uint16_t len;
+	uint8_t wire[]; // Answer section.
+} axfr_msg_t;
+
+struct axfr_cache {
+	pthread_mutex_t lock;
+	pthread_cond_t rendered;
+	unsigned refs;
+
+	const zone_contents_t *contents;
+	size_t base_size;        // Header and question size.
+
+	axfr_msg_t **msgs;
+	size_t count;
+	size_t capacity;
+	bool rendering;          // Some transfer is rendering the next message.
+	bool complete;           // The last message has been rendered.
+	int error;               // Rendering failed, the stream is unusable.
+
+	// Renderer state, used only by the transfer with 'rendering' set.
+	knot_pkt_t *pkt;
+	zone_tree_it_t it;
+	unsigned tree;           // 0 - nodes, 1 - NSEC3 nodes, 2 - done.
+	unsigned cur_rrset;
+};
+
+static void renderer_free(axfr_cache_t *cache)
+{
+	zone_tree_it_free(&cache->it);
+	knot_pkt_free(cache->pkt);
+	cache->pkt = NULL;
+}
+
+static int msg_append(axfr_cache_t *cache, axfr_msg_t *msg)
+{
+	if (cache->count == cache->capacity) {
+		size_t capacity = (cache->capacity == 0) ? 16 : 2 * cache->capacity;
+		axfr_msg_t **msgs = realloc(cache->msgs, capacity * sizeof(*msgs));
+		if (msgs == NULL) {
+			return KNOT_ENOMEM;
+		}
+		cache->msgs = msgs;
+		cache->capacity = capacity;
+	}
+
+	cache->msgs[cache->count++] = msg;
+
+	return KNOT_EOK;
+}
+
+/*! \brief Render the next message, the same way as an uncached AXFR does. */
+static int render_msg(axfr_cache_t *cache, axfr_msg_t **out)
+{
+	const zone_contents_t *contents = cache->contents;
+
+	if (cache->pkt == NULL) {
+		cache->pkt = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+		if (cache->pkt == NULL) {
+			return KNOT_ENOMEM;
+		}
+	}
+
+	knot_pkt_t *pkt = cache->pkt;
+	knot_pkt_clear(pkt);
+	int ret = knot_pkt_put_question(pkt, contents->apex->owner, KNOT_CLASS_IN,
+	                                KNOT_RRTYPE_AXFR);
+	if (ret == KNOT_EOK) {
+		ret = knot_pkt_reserve(pkt, AXFR_CACHE_RESERVE);
+	}
+	if (ret == KNOT_EOK) {
+		ret = knot_pkt_begin(pkt, KNOT_ANSWER);
+	}
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	assert(pkt->size == cache->base_size);
+
+	knot_rrset_t soa_rr = node_rrset(contents->apex, KNOT_RRTYPE_SOA);
+
+	/* Prepend SOA on first message. */
+	if (cache->count == 0) {
+		ret = knot_pkt_put(pkt, 0, &soa_rr, KNOT_PF_NOTRUNC);
+	}
+
+	while (ret == KNOT_EOK && cache->tree < 2) {
+		zone_tree_t *tree = (cache->tree == 0) ? contents->nodes : contents->nsec3_nodes;
+		if (zone_tree_is_empty(tree)) {
+			cache->tree++;
+			continue;
+		}
+
+		ret = zone_tree_it_begin(tree, &cache->it); // does nothing if already iterating
+		while (ret == KNOT_EOK && !zone_tree_it_finished(&cache->it)) {
+			ret = axfr_put_node(pkt, zone_tree_it_val(&cache->it), &cache->cur_rrset);
+			if (ret == KNOT_EOK) {
+				zone_tree_it_next(&cache->it);
+			}
+		}
+
+		if (ret == KNOT_EOK) {
+			zone_tree_it_free(&cache->it);
+			cache->tree++;
+		}
+	}
+
+	/* Append SOA on last message. */
+	if (ret == KNOT_EOK) {
+		ret = knot_pkt_put(pkt, 0, &soa_rr, KNOT_PF_NOTRUNC);
+	}
+
+	if (ret == KNOT_ESPACE && pkt->rrset_count < 1) {
+		return KNOT_ENOXFR;
+	} else if (ret != KNOT_EOK && ret != KNOT_ESPACE) {
+		return ret;
+	}
+
+	size_t len = pkt->size - cache->base_size;
+	axfr_msg_t *msg = malloc(sizeof(*msg) + len);
+	if (msg == NULL) {
+		return KNOT_ENOMEM;
+	}
+	msg->ancount = knot_wire_get_ancount(pkt->wire);
+	msg->len = len;
+	memcpy(msg->wire, pkt->wire + cache->base_size, len);
+
+	*out = msg;
+
+	return ret;
+}
+
+axfr_cache_t *axfr_cache_new(const zone_contents_t *contents)
+{
+	if (contents == NULL || contents->apex == NULL) {
+		return NULL;
+	}
+
+	axfr_cache_t *cache = calloc(1, sizeof(*cache));
+	if (cache == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_init(&cache->lock, NULL);
+	pthread_cond_init(&cache->rendered, NULL);
+	cache->refs = 1;
+	cache->contents = contents;
+	cache->base_size = KNOT_WIRE_HEADER_SIZE + knot_dname_size(contents->apex->owner) +
+	                   2 * sizeof(uint16_t);
+
+	return cache;
+}
+
+axfr_cache_t *axfr_cache_ref(axfr_cache_t *cache)
+{
+	assert(cache);
+
+	pthread_mutex_lock(&cache->lock);
+	cache->refs++;
+	pthread_mutex_unlock(&cache->lock);
+
+	return cache;
+}
+
+void axfr_cache_unref(axfr_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&cache->lock);
+	assert(cache->refs > 0);
+	bool last = (--cache->refs == 0);
+	pthread_mutex_unlock(&cache->lock);
+	if (!last) {
+		return;
+	}
+
+	renderer_free(cache);
+	for (size_t i = 0; i < cache->count; i++) {
+		free(cache->msgs[i]);
+	}
+	free(cache->msgs);
+	pthread_cond_destroy(&cache->rendered);
+	pthread_mutex_destroy(&cache->lock);
+	free(cache);
+}
+
+bool axfr_cache_usable(axfr_cache_t *cache, const knot_pkt_t *pkt)
+{
+	assert(cache && pkt);
+
+	pthread_mutex_lock(&cache->lock);
+	bool failed = (cache->error != KNOT_EOK);
+	pthread_mutex_unlock(&cache->lock);
+
+	/* Every cached message fits if the response has at least as much space. */
+	return !failed && pkt->size == cache->base_size &&
+	       pkt->max_size >= pkt->reserved + KNOT_WIRE_MAX_PKTSIZE - AXFR_CACHE_RESERVE;
+}
+
+int axfr_cache_write(axfr_cache_t *cache, size_t idx, knot_pkt_t *pkt, bool *rendered)
+{
+	assert(cache && pkt && rendered);
+
+	*rendered = false;
+
+	pthread_mutex_lock(&cache->lock);
+	while (idx >= cache->count && !cache->complete && cache->error == KNOT_EOK) {
+		if (cache->rendering) {
+			pthread_cond_wait(&cache->rendered, &cache->lock);
+			continue;
+		}
+
+		/* Render the next message outside the lock, readers of the
+		 * already rendered messages aren't blocked meanwhile. */
+		cache->rendering = true;
+		pthread_mutex_unlock(&cache->lock);
+		axfr_msg_t *msg = NULL;
+		int ret = render_msg(cache, &msg);
+		pthread_mutex_lock(&cache->lock);
+		cache->rendering = false;
+
+		if (ret == KNOT_EOK || ret == KNOT_ESPACE) {
+			int app_ret = msg_append(cache, msg);
+			if (app_ret != KNOT_EOK) {
+				free(msg);
+				ret = app_ret;
+			} else {
+				*rendered = true;
+			}
+		}
+		if (ret == KNOT_EOK) {
+			cache->complete = true;
+			renderer_free(cache);
+		} else if (ret != KNOT_ESPACE) {
+			cache->error = ret;
+			renderer_free(cache);
+		}
+		pthread_cond_broadcast(&cache->rendered);
+	}
+
+	const axfr_msg_t *msg = NULL;
+	int ret = cache->error;
+	if (idx < cache->count) {
+		msg = cache->msgs[idx];
+		ret = (cache->complete && idx + 1 == cache->count) ? KNOT_EOK : KNOT_ESPACE;
+	} else if (ret == KNOT_EOK) {
+		ret = KNOT_EINVAL; // Index past the last message.
+	}
+	pthread_mutex_unlock(&cache->lock);
+
+	if (msg == NULL) {
+		return ret;
+	}
+
+	/* The compression pointers refer to the question of the same length. */
+	if (pkt->size != cache->base_size) {
+		return KNOT_ERANGE;
+	}
+	int put_ret = xfr_put_rendered(pkt, msg->wire, msg->len, msg->ancount);
+	if (put_ret != KNOT_EOK) {
+		return (put_ret == KNOT_ESPACE) ? KNOT_ERANGE : put_ret;
+	}
+
+	return ret;
+}
@@ -0,0 +1,75 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "libknot/packet/pkt.h"
+
+struct zone_contents;
+
+/*! \brief Space left in each cached message for OPT and TSIG. */
+#define AXFR_CACHE_RESERVE 2048
+
+/*!
+ * \brief Stream of rendered AXFR messages bound to one version of zone contents.
+ *
+ * Only the answer sections are stored. The messages are rendered lazily,
+ * by the first transfer needing them, and shared by all transfers of the
+ * same contents. The cache is reference counted, one reference is held
+ * by the zone contents and one by each ongoing transfer.
+ */
+typedef struct axfr_cache axfr_cache_t;
+
+/*!
+ * \brief Create an AXFR cache.
+ *
+ * \note The contents must not change and must outlive all transfers
+ *       using the cache (ensured by holding the xfrout_lock).
+ *
+ * \param contents  Zone contents to be transferred.
+ *
+ * \return New cache with one reference or NULL if no memory.
+ */
+axfr_cache_t *axfr_cache_new(const struct zone_contents *contents);
+
+/*!
+ * \brief Take a reference to the AXFR cache.
+ *
+ * \return The cache.
+ */
+axfr_cache_t *axfr_cache_ref(axfr_cache_t *cache);
+
+/*!
+ * \brief Drop a reference to the AXFR cache, free it if it was the last one.
+ */
+void axfr_cache_unref(axfr_cache_t *cache);
+
+/*!
+ * \brief Check if the cached messages can be written to the response.
+ *
+ * \param cache  AXFR cache.
+ * \param pkt    Response with the question and OPT and TSIG space reserved.
+ */
+bool axfr_cache_usable(axfr_cache_t *cache, const knot_pkt_t *pkt);
+
+/*!
+ * \brief Write a cached message to the response, render it if not yet done.
+ *
+ * The response must contain just the header and the question, which are
+ * kept including the message ID. OPT and TSIG are to be added afterwards.
+ *
+ * \param cache     AXFR cache.
+ * \param idx       Message index.
+ * \param pkt       Response.
+ * \param rendered  Output: set if the message was rendered by this call.
+ *
+ * \retval KNOT_ESPACE  if more messages follow.
+ * \retval KNOT_EOK     if this was the last message.
+ * \return KNOT_E*      on error.
+ */
+int axfr_cache_write(axfr_cache_t *cache, size_t idx, knot_pkt_t *pkt, bool *rendered);
@@ -11,6 +11,7 @@
 #include "knot/nameserver/axfr.h"
 #include "knot/nameserver/internet.h"
 #include "knot/nameserver/ixfr.h"
+#include "knot/nameserver/ixfr_cache.h"
 #include "knot/nameserver/log.h"
 #include "knot/nameserver/xfr.h"
 #include "knot/zone/serial.h"
@@ -119,6 +120,88 @@ static int ixfr_load_chsets(journal_read_t **journal_read, zone_t *zone,
 	return journal_read_begin(zone_journal(zone), false, serial_from, journal_read);
 }
 
+/*! \brief Start reading the changes requested by the query from the journal. */
+static int ixfr_journal_begin(struct ixfr_proc *ixfr)
+{
+	knotd_qdata_t *qdata = ixfr->qdata;
+	const knot_pktsection_t *authority = knot_pkt_section(qdata->query, KNOT_AUTHORITY);
+
+	int ret = ixfr_load_chsets(&ixfr->journal_ctx, (zone_t *)qdata->extra->zone,
+	                           qdata->extra->contents, knot_pkt_rr(authority, 0));
+	if (ret == KNOT_EOK) {
+		ptrlist_add(&ixfr->proc.nodes, ixfr->journal_ctx, qdata->mm);
+	}
+
+	return ret;
+}
+
+/*! \brief Stop reading the journal, reset the reading state. */
+static void ixfr_journal_end(struct ixfr_proc *ixfr)
+{
+	ptrlist_free(&ixfr->proc.nodes, ixfr->qdata->mm);
+	journal_read_end(ixfr->journal_ctx);
+	ixfr->journal_ctx = NULL;
+	knot_rrset_clear(&ixfr->cur_rr, NULL);
+	ixfr->in_remove_section = false;
+	ixfr->soa_last = ixfr->soa_from;
+}
+
+/*! \brief Render the whole transfer into the shared stream, the same way as xfr_process_list(). */
+static int ixfr_render_stream(struct ixfr_proc *ixfr, const zone_contents_t *contents)
+{
+	knot_pkt_t *pkt = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	if (pkt == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	knot_rrset_t soa_rr = node_rrset(contents->apex, KNOT_RRTYPE_SOA);
+	bool changes_done = false;
+
+	int ret = KNOT_ESPACE;
+	for (unsigned msg = 0; ret == KNOT_ESPACE; msg++) {
+		knot_pkt_clear(pkt);
+		ret = knot_pkt_put_question(pkt, contents->apex->owner, KNOT_CLASS_IN,
+		                            KNOT_RRTYPE_IXFR);
+		if (ret == KNOT_EOK) {
+			ret = knot_pkt_reserve(pkt, IXFR_CACHE_RESERVE);
+		}
+		if (ret == KNOT_EOK) {
+			ret = knot_pkt_begin(pkt, KNOT_ANSWER);
+		}
+
+		/* Prepend SOA on first message. */
+		if (ret == KNOT_EOK && msg == 0) {
+			ret = knot_pkt_put(pkt, 0, &soa_rr, KNOT_PF_NOTRUNC);
+		}
+		if (ret == KNOT_EOK && !changes_done) {
+			ret = ixfr_put_chg_part(pkt, ixfr, ixfr->journal_ctx);
+			changes_done = (ret == KNOT_EOK);
+		}
+		/* Append SOA on last message. */
+		if (ret == KNOT_EOK) {
+			ret = knot_pkt_put(pkt, 0, &soa_rr, KNOT_PF_NOTRUNC);
+		}
+
+		if (ret == KNOT_ESPACE && pkt->rrset_count < 1) {
+			ret = KNOT_ENOXFR;
+		} else if (ret == KNOT_EOK || ret == KNOT_ESPACE) {
+			int add_ret = ixfr_stream_add(ixfr->cache, pkt);
+			if (add_ret != KNOT_EOK) {
+				ret = add_ret;
+			}
+		}
+	}
+
+	knot_pkt_free(pkt);
+
+	/* Let the uncached transfer report the inconsistency. */
+	if (ret == KNOT_EOK && ixfr->soa_last != ixfr->soa_to) {
+		ret = KNOT_ERROR;
+	}
+
+	return ret;
+}
+
 static knot_layer_state_t ixfr_query_check(knotd_qdata_t *qdata)
 {
 	NS_NEED_ZONE(qdata, KNOT_RCODE_NOTAUTH);
@@ -145,6 +228,7 @@ static void ixfr_answer_cleanup(knotd_qdata_t *qdata)
 	knot_rrset_clear(&ixfr->cur_rr, NULL);
 	ptrlist_free(&ixfr->proc.nodes, qdata->mm);
 	journal_read_end(ixfr->journal_ctx);
+	ixfr_stream_unref(ixfr->cache);
 	mm_free(qdata->mm, qdata->extra->ext);
 
 	/* Allow zone changes (finished). */
@@ -153,7 +237,9 @@ static void ixfr_answer_cleanup(knotd_qdata_t *qdata)
 
 static void ixfr_answer_finished(knotd_qdata_t *qdata, knot_pkt_t *pkt, int state)
 {
-	struct xfr_proc *xfr = qdata->extra->ext;
+	struct ixfr_proc *ixfr = qdata->extra->ext;
+	struct xfr_proc *xfr = &ixfr->proc;
+	char cache_log[32] = "";
 
 	switch (state) {
 	case KNOT_STATE_PRODUCE:
@@ -162,8 +248,12 @@ static void ixfr_answer_finished(knotd_qdata_t *qdata, knot_pkt_t *pkt, int stat
 	case KNOT_STATE_DONE:
 		xfr_stats_add(&xfr->stats, pkt->size);
 		xfr_stats_end(&xfr->stats);
+		if (ixfr->cache != NULL) {
+			(void)snprintf(cache_log, sizeof(cache_log), " reused %u cached messages,",
+			               ixfr->cache_rendered ? 0 : xfr->stats.messages);
+		}
 		xfr_log_finished(ZONE_NAME(qdata), LOG_OPERATION_IXFR, LOG_DIRECTION_OUT,
-				 REMOTE(qdata), PROTO(qdata), KEY(qdata), "", &xfr->stats);
+				 REMOTE(qdata), PROTO(qdata), KEY(qdata), cache_log, &xfr->stats);
 		break;
 	default:
 		break;
@@ -205,25 +295,56 @@ static int ixfr_answer_init(knotd_qdata_t *qdata, uint32_t *serial_from)
 	}
 	memset(xfer, 0, sizeof(*xfer));
 
-	int ret = ixfr_load_chsets(&xfer->journal_ctx, (zone_t *)qdata->extra->zone,
-	                           qdata->extra->contents, their_soa);
-	if (ret != KNOT_EOK) {
-		mm_free(mm, xfer);
-		return ret;
-	}
-
 	xfr_stats_begin(&xfer->proc.stats);
 	xfer->state = IXFR_SOA_DEL;
 	init_list(&xfer->proc.nodes);
 	knot_rrset_init_empty(&xfer->cur_rr);
 	xfer->qdata = qdata;
 
-	ptrlist_add(&xfer->proc.nodes, xfer->journal_ctx, mm);
-
 	xfer->soa_from = knot_soa_serial(their_soa->rrs.rdata);
 	xfer->soa_to = zone_contents_serial(qdata->extra->contents);
 	xfer->soa_last = xfer->soa_from;
 
+	/* Share the rendered messages with other transfers if enabled. */
+	ixfr_cache_t *cache = qdata->extra->contents->ixfr_cache;
+	if (serial_compare(xfer->soa_to, xfer->soa_from) != SERIAL_GREATER) {
+		cache = NULL;
+	}
+	if (cache != NULL) {
+		xfer->cache = ixfr_cache_get(cache, xfer->soa_from);
+	}
+
+	int ret = KNOT_EOK;
+	if (xfer->cache == NULL) {
+		ret = ixfr_journal_begin(xfer);
+		/* Cache only the serial ranges available in the journal. */
+		if (ret == KNOT_EOK && cache != NULL) {
+			xfer->cache = ixfr_cache_add(cache, xfer->soa_from, &xfer->cache_rendered);
+			if (xfer->cache != NULL && !xfer->cache_rendered) {
+				ixfr_journal_end(xfer); // Rendered by another transfer meanwhile.
+			}
+		}
+	}
+	if (xfer->cache_rendered) {
+		if (ret == KNOT_EOK) {
+			ret = ixfr_render_stream(xfer, qdata->extra->contents);
+		}
+		ixfr_cache_done(cache, xfer->cache, ret);
+		ixfr_journal_end(xfer);
+		if (ret != KNOT_EOK) { // Retry uncached to get the proper reaction.
+			ixfr_stream_unref(xfer->cache);
+			xfer->cache = NULL;
+			xfer->cache_rendered = false;
+			ret = ixfr_journal_begin(xfer);
+		}
+	}
+	if (ret != KNOT_EOK) {
+		ixfr_journal_end(xfer);
+		ixfr_stream_unref(xfer->cache);
+		mm_free(mm, xfer);
+		return ret;
+	}
+
 	qdata->extra->ext = xfer;
 	qdata->extra->ext_cleanup = &ixfr_answer_cleanup;
 	qdata->extra->ext_finished = &ixfr_answer_finished;
@@ -321,13 +442,29 @@ knot_layer_state_t ixfr_process_query(knot_pkt_t *pkt, knotd_qdata_t *qdata)
 		return KNOT_STATE_FAIL;
 	}
 
+	/* Read the journal if the cached messages don't fit the response. */
+	unsigned msg_idx = ixfr->proc.stats.messages;
+	if (ixfr->cache != NULL && msg_idx == 0 && !ixfr_stream_usable(ixfr->cache, pkt)) {
+		ixfr_stream_unref(ixfr->cache);
+		ixfr->cache = NULL;
+		ret = ixfr_journal_begin(ixfr);
+		if (ret != KNOT_EOK) {
+			IXFROUT_LOG(LOG_ERR, qdata, "failed (%s)", knot_strerror(ret));
+			return KNOT_STATE_FAIL;
+		}
+	}
+
 	/* Answer current packet (or continue). */
-	ret = xfr_process_list(pkt, &ixfr_process_journal, qdata);
+	if (ixfr->cache != NULL) {
+		ret = ixfr_stream_write(ixfr->cache, msg_idx, pkt);
+	} else {
+		ret = xfr_process_list(pkt, &ixfr_process_journal, qdata);
+	}
 	switch (ret) {
 	case KNOT_ESPACE: /* Couldn't write more, send packet and continue. */
 		return KNOT_STATE_PRODUCE; /* Check for more. */
 	case KNOT_EOK:    /* Last response. */
-		if (ixfr->soa_last != ixfr->soa_to) {
+		if (ixfr->cache == NULL && ixfr->soa_last != ixfr->soa_to) {
 			IXFROUT_LOG(LOG_ERR, qdata, "failed (inconsistent history)");
 			return KNOT_STATE_FAIL;
 		}
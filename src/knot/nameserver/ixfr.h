@@ -6,6 +6,7 @@
 #pragma once
 
 #include "knot/journal/journal_read.h"
+#include "knot/nameserver/ixfr_cache.h"
 #include "knot/nameserver/process_query.h"
 #include "knot/nameserver/xfr.h"
 #include "libknot/packet/pkt.h"
@@ -34,6 +35,10 @@ struct ixfr_proc {
 	/* Currently processed RRSet. */
 	knot_rrset_t cur_rr;
 
+	/* Shared rendered messages (optional). */
+	ixfr_stream_t *cache;
+	bool cache_rendered;     /* The messages were rendered by this transfer. */
+
 	/* Processing context. */
 	knotd_qdata_t *qdata;
 	knot_mm_t *mm;
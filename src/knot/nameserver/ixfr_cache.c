@@ -0,0 +1,310 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "knot/nameserver/ixfr_cache.h"
+#include "knot/nameserver/xfr.h"
+#include "libknot/libknot.h"
+
+typedef struct {
+	uint16_t ancount;
+	uint16_t len;
+	uint8_t wire[]; // Answer section.
+} ixfr_msg_t;
+
+struct ixfr_stream {
+	pthread_mutex_t lock;
+	unsigned refs;
+
+	uint32_t serial_from;
+	uint64_t last_use;       // Cache use counter value at the last lookup.
+	bool rendering;          // Some transfer is rendering the stream.
+
+	size_t base_size;        // Header and question size.
+	ixfr_msg_t **msgs;
+	size_t count;
+	size_t capacity;
+};
+
+struct ixfr_cache {
+	pthread_mutex_t lock;
+	pthread_cond_t rendered;
+	uint64_t uses;
+
+	size_t max_streams;
+	size_t count;
+	ixfr_stream_t *streams[];
+};
+
+static ixfr_stream_t *stream_new(uint32_t serial_from)
+{
+	ixfr_stream_t *stream = calloc(1, sizeof(*stream));
+	if (stream == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_init(&stream->lock, NULL);
+	stream->refs = 1;
+	stream->serial_from = serial_from;
+	stream->rendering = true;
+
+	return stream;
+}
+
+static ixfr_stream_t *stream_ref(ixfr_stream_t *stream)
+{
+	pthread_mutex_lock(&stream->lock);
+	stream->refs++;
+	pthread_mutex_unlock(&stream->lock);
+
+	return stream;
+}
+
+void ixfr_stream_unref(ixfr_stream_t *stream)
+{
+	if (stream == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&stream->lock);
+	assert(stream->refs > 0);
+	bool last = (--stream->refs == 0);
+	pthread_mutex_unlock(&stream->lock);
+	if (!last) {
+		return;
+	}
+
+	for (size_t i = 0; i < stream->count; i++) {
+		free(stream->msgs[i]);
+	}
+	free(stream->msgs);
+	pthread_mutex_destroy(&stream->lock);
+	free(stream);
+}
+
+/*! \brief Remove the stream at the given position, keep the order of the others. */
+static void cache_remove(ixfr_cache_t *cache, size_t pos)
+{
+	assert(pos < cache->count);
+
+	ixfr_stream_unref(cache->streams[pos]);
+	memmove(&cache->streams[pos], &cache->streams[pos + 1],
+	        (cache->count - pos - 1) * sizeof(cache->streams[0]));
+	cache->count--;
+}
+
+/*! \brief Make space for a new stream, drop the least recently used one. */
+static bool cache_evict(ixfr_cache_t *cache)
+{
+	ssize_t victim = -1;
+	for (size_t i = 0; i < cache->count; i++) {
+		const ixfr_stream_t *stream = cache->streams[i];
+		if (!stream->rendering &&
+		    (victim < 0 || stream->last_use < cache->streams[victim]->last_use)) {
+			victim = i;
+		}
+	}
+	if (victim < 0) {
+		return false; // All streams are being rendered.
+	}
+
+	cache_remove(cache, victim);
+
+	return true;
+}
+
+ixfr_cache_t *ixfr_cache_new(size_t max_streams)
+{
+	if (max_streams == 0) {
+		return NULL;
+	}
+
+	ixfr_cache_t *cache = calloc(1, sizeof(*cache) + max_streams * sizeof(cache->streams[0]));
+	if (cache == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_init(&cache->lock, NULL);
+	pthread_cond_init(&cache->rendered, NULL);
+	cache->max_streams = max_streams;
+
+	return cache;
+}
+
+void ixfr_cache_free(ixfr_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < cache->count; i++) {
+		ixfr_stream_unref(cache->streams[i]);
+	}
+	pthread_cond_destroy(&cache->rendered);
+	pthread_mutex_destroy(&cache->lock);
+	free(cache);
+}
+
+/*! \brief Find a referenced rendered stream, the cache must be locked. */
+static ixfr_stream_t *cache_lookup(ixfr_cache_t *cache, uint32_t serial_from)
+{
+	ixfr_stream_t *stream = NULL;
+	for (size_t i = 0; i < cache->count; i++) {
+		if (cache->streams[i]->serial_from != serial_from) {
+			continue;
+		}
+		stream = cache->streams[i];
+		stream->last_use = ++cache->uses;
+		stream_ref(stream);
+		break;
+	}
+	if (stream == NULL) {
+		return NULL;
+	}
+
+	while (stream->rendering) {
+		pthread_cond_wait(&cache->rendered, &cache->lock);
+	}
+	// The failed stream has been removed from the cache meanwhile.
+	if (stream->count == 0) {
+		ixfr_stream_unref(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+ixfr_stream_t *ixfr_cache_get(ixfr_cache_t *cache, uint32_t serial_from)
+{
+	assert(cache);
+
+	pthread_mutex_lock(&cache->lock);
+	ixfr_stream_t *stream = cache_lookup(cache, serial_from);
+	pthread_mutex_unlock(&cache->lock);
+
+	return stream;
+}
+
+ixfr_stream_t *ixfr_cache_add(ixfr_cache_t *cache, uint32_t serial_from, bool *render)
+{
+	assert(cache && render);
+
+	*render = false;
+
+	pthread_mutex_lock(&cache->lock);
+	// Another transfer may have added the stream meanwhile.
+	ixfr_stream_t *stream = cache_lookup(cache, serial_from);
+	if (stream != NULL) {
+		pthread_mutex_unlock(&cache->lock);
+		return stream;
+	}
+
+	if (cache->count == cache->max_streams && !cache_evict(cache)) {
+		pthread_mutex_unlock(&cache->lock);
+		return NULL;
+	}
+
+	stream = stream_new(serial_from);
+	if (stream != NULL) {
+		stream->last_use = ++cache->uses;
+		cache->streams[cache->count++] = stream_ref(stream);
+		*render = true;
+	}
+	pthread_mutex_unlock(&cache->lock);
+
+	return stream;
+}
+
+void ixfr_cache_done(ixfr_cache_t *cache, ixfr_stream_t *stream, int ret)
+{
+	assert(cache && stream && stream->rendering);
+
+	pthread_mutex_lock(&cache->lock);
+	if (ret != KNOT_EOK) {
+		// Waiting transfers fall back to reading the journal.
+		for (size_t i = 0; i < stream->count; i++) {
+			free(stream->msgs[i]);
+		}
+		stream->count = 0;
+		for (size_t i = 0; i < cache->count; i++) {
+			if (cache->streams[i] == stream) {
+				cache_remove(cache, i);
+				break;
+			}
+		}
+	}
+	stream->rendering = false;
+	pthread_cond_broadcast(&cache->rendered);
+	pthread_mutex_unlock(&cache->lock);
+}
+
+int ixfr_stream_add(ixfr_stream_t *stream, const knot_pkt_t *pkt)
+{
+	assert(stream && stream->rendering && pkt);
+
+	size_t base_size = KNOT_WIRE_HEADER_SIZE + pkt->qname_size + 2 * sizeof(uint16_t);
+	assert(stream->count == 0 || stream->base_size == base_size);
+	assert(pkt->size >= base_size);
+
+	if (stream->count == stream->capacity) {
+		size_t capacity = (stream->capacity == 0) ? 4 : 2 * stream->capacity;
+		ixfr_msg_t **msgs = realloc(stream->msgs, capacity * sizeof(*msgs));
+		if (msgs == NULL) {
+			return KNOT_ENOMEM;
+		}
+		stream->msgs = msgs;
+		stream->capacity = capacity;
+	}
+
+	size_t len = pkt->size - base_size;
+	ixfr_msg_t *msg = malloc(sizeof(*msg) + len);
+	if (msg == NULL) {
+		return KNOT_ENOMEM;
+	}
+	msg->ancount = knot_wire_get_ancount(pkt->wire);
+	msg->len = len;
+	memcpy(msg->wire, pkt->wire + base_size, len);
+
+	stream->base_size = base_size;
+	stream->msgs[stream->count++] = msg;
+
+	return KNOT_EOK;
+}
+
+bool ixfr_stream_usable(const ixfr_stream_t *stream, const knot_pkt_t *pkt)
+{
+	assert(stream && !stream->rendering && pkt);
+
+	/* Every cached message fits if the response has at least as much space. */
+	return stream->count > 0 && pkt->size == stream->base_size &&
+	       pkt->max_size >= pkt->reserved + KNOT_WIRE_MAX_PKTSIZE - IXFR_CACHE_RESERVE;
+}
+
+int ixfr_stream_write(const ixfr_stream_t *stream, size_t idx, knot_pkt_t *pkt)
+{
+	assert(stream && !stream->rendering && pkt);
+
+	if (idx >= stream->count) {
+		return KNOT_EINVAL;
+	}
+
+	/* The compression pointers refer to the question of the same length. */
+	if (pkt->size != stream->base_size) {
+		return KNOT_ERANGE;
+	}
+
+	const ixfr_msg_t *msg = stream->msgs[idx];
+	int ret = xfr_put_rendered(pkt, msg->wire, msg->len, msg->ancount);
+	if (ret != KNOT_EOK) {
+		return (ret == KNOT_ESPACE) ? KNOT_ERANGE : ret;
+	}
+
+	return (idx + 1 == stream->count) ? KNOT_EOK : KNOT_ESPACE;
+}
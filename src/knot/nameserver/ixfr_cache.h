@@ -0,0 +1,125 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libknot/packet/pkt.h"
+
+/*! \brief Space left in each cached message for OPT and TSIG. */
+#define IXFR_CACHE_RESERVE 2048
+
+/*!
+ * \brief Cache of rendered IXFR message streams bound to one version of zone contents.
+ *
+ * The contents determine the target serial, so the streams are identified
+ * by the starting serial only. A stream is rendered at once by the first
+ * transfer needing it, concurrent transfers of the same serial range wait
+ * for it. The least recently used stream is replaced if the cache is full.
+ */
+typedef struct ixfr_cache ixfr_cache_t;
+
+/*!
+ * \brief Rendered IXFR messages for one serial range, reference counted.
+ *
+ * Only the answer sections are stored.
+ */
+typedef struct ixfr_stream ixfr_stream_t;
+
+/*!
+ * \brief Create an IXFR cache.
+ *
+ * \param max_streams  Maximal number of cached serial ranges.
+ *
+ * \return New cache or NULL if no memory.
+ */
+ixfr_cache_t *ixfr_cache_new(size_t max_streams);
+
+/*!
+ * \brief Free the IXFR cache, the streams are freed once not used.
+ */
+void ixfr_cache_free(ixfr_cache_t *cache);
+
+/*!
+ * \brief Get a referenced rendered stream of the given serial range.
+ *
+ * If another transfer is rendering the stream, the call waits until it's done.
+ *
+ * \param cache        IXFR cache.
+ * \param serial_from  Starting serial of the transfer.
+ *
+ * \return Stream or NULL if not cached or rendering failed.
+ */
+ixfr_stream_t *ixfr_cache_get(ixfr_cache_t *cache, uint32_t serial_from);
+
+/*!
+ * \brief Add a stream of the given serial range, get a referenced one.
+ *
+ * To be called once the serial range is known to be available so that
+ * invalid queries don't replace the cached streams. If the stream isn't
+ * cached yet, an empty one is inserted in place of the least recently used
+ * one and the caller is responsible for rendering it with ixfr_stream_add()
+ * and finishing it with ixfr_cache_done(). Otherwise it's like ixfr_cache_get().
+ *
+ * \param cache        IXFR cache.
+ * \param serial_from  Starting serial of the transfer.
+ * \param render       Output: set if the stream is to be rendered by the caller.
+ *
+ * \return Stream or NULL if rendering failed, the cache is busy, or no memory.
+ */
+ixfr_stream_t *ixfr_cache_add(ixfr_cache_t *cache, uint32_t serial_from, bool *render);
+
+/*!
+ * \brief Finish the rendering of the stream.
+ *
+ * Waiting transfers are woken up. A failed stream is removed from the cache.
+ *
+ * \param cache   IXFR cache.
+ * \param stream  Stream obtained for rendering.
+ * \param ret     Rendering result.
+ */
+void ixfr_cache_done(ixfr_cache_t *cache, ixfr_stream_t *stream, int ret);
+
+/*!
+ * \brief Drop a reference to the stream, free it if it was the last one.
+ */
+void ixfr_stream_unref(ixfr_stream_t *stream);
+
+/*!
+ * \brief Append a rendered message to the stream being rendered.
+ *
+ * \param stream  Stream obtained for rendering.
+ * \param pkt     Message with the question and IXFR_CACHE_RESERVE reserved.
+ *
+ * \return KNOT_EOK, KNOT_ENOMEM.
+ */
+int ixfr_stream_add(ixfr_stream_t *stream, const knot_pkt_t *pkt);
+
+/*!
+ * \brief Check if the stream messages can be written to the response.
+ *
+ * \param stream  Rendered stream.
+ * \param pkt     Response with the question and OPT and TSIG space reserved.
+ */
+bool ixfr_stream_usable(const ixfr_stream_t *stream, const knot_pkt_t *pkt);
+
+/*!
+ * \brief Write a stream message to the response.
+ *
+ * The response must contain just the header and the question, which are
+ * kept including the message ID. OPT and TSIG are to be added afterwards.
+ *
+ * \param stream  Rendered stream.
+ * \param idx     Message index.
+ * \param pkt     Response.
+ *
+ * \retval KNOT_ESPACE  if more messages follow.
+ * \retval KNOT_EOK     if this was the last message.
+ * \return KNOT_E*      on error.
+ */
+int ixfr_stream_write(const ixfr_stream_t *stream, size_t idx, knot_pkt_t *pkt);
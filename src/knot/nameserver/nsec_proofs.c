@@ -204,7 +204,15 @@ static int put_covering_nsec3(const zone_contents_t *zone,
 	const zone_node_t *prev = NULL;
 	const zone_node_t *node = NULL;
 
-	int match = zone_contents_find_nsec3_for_name(zone, name, &node, &prev);
+	bool cache_hit = false;
+	int match = zone_contents_find_nsec3_for_name(zone, name, &node, &prev, &cache_hit);
+	if (zone->nsec3_cache != NULL && match >= 0) {
+		if (cache_hit) {
+			qdata->extra->nsec3_cache_hits++;
+		} else {
+			qdata->extra->nsec3_cache_misses++;
+		}
+	}
 	if (match < 0) {
 		// ignore if missing
 		return KNOT_EOK;
@@ -8,6 +8,7 @@
 #include "libdnssec/tsig.h"
 #include "knot/common/log.h"
 #include "knot/dnssec/rrset-sign.h"
+#include "knot/nameserver/answer_cache.h"
 #include "knot/nameserver/process_query.h"
 #include "knot/nameserver/query_module.h"
 #include "knot/nameserver/chaos.h"
@@ -453,8 +454,9 @@ static int prepare_answer(knot_pkt_t *query, knot_pkt_t *resp, knot_layer_t *ctx
 		return KNOT_ERROR;
 	}
 
-	/* Update maximal answer size. */
+	/* Update maximal answer size, UDP answer can't exceed its buffer. */
 	if (qdata->params->proto == KNOTD_QUERY_PROTO_UDP) {
+		uint16_t buffer_size = resp->max_size;
 		resp->max_size = KNOT_WIRE_MIN_PKTSIZE;
 		if (knot_pkt_has_edns(query)) {
 			uint16_t server_size;
@@ -472,6 +474,7 @@ static int prepare_answer(knot_pkt_t *query, knot_pkt_t *resp, knot_layer_t *ctx
 			uint16_t transfer = MIN(client_size, server_size);
 			resp->max_size = MAX(resp->max_size, transfer);
 		}
+		resp->max_size = MIN(resp->max_size, buffer_size);
 	} else {
 		resp->max_size = KNOT_WIRE_MAX_PKTSIZE;
 	}
@@ -509,6 +512,109 @@ static int prepare_answer(knot_pkt_t *query, knot_pkt_t *resp, knot_layer_t *ctx
 	return KNOT_EOK;
 }
 
+/*! \brief Check if the query plan has no hooks inside the answering stages. */
+static bool plan_without_answer_hooks(struct query_plan *plan)
+{
+	if (plan == NULL) {
+		return true;
+	}
+
+	for (int stage = KNOTD_STAGE_PREANSWER; stage <= KNOTD_STAGE_ADDITIONAL; stage++) {
+		if (!EMPTY_LIST(plan->stage[stage])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*!
+ * \brief Compose the answer cache key for the query.
+ *
+ * The key covers everything the cached answer depends on apart from the zone
+ * contents, which own the cache: QNAME, QTYPE, header flags, address family
+ * (the OPT payload), maximal response size, and EDNS presence with the DO bit.
+ *
+ * \return Key length, 0 if the answer isn't cacheable.
+ */
+static size_t answer_cache_key(knotd_qdata_t *qdata, const knot_pkt_t *resp,
+                               struct query_plan *plan, struct query_plan *zone_plan,
+                               uint8_t key[ANSWER_CACHE_MAX_KEY])
+{
+	const knot_pkt_t *query = qdata->query;
+	const zone_contents_t *contents = qdata->extra->contents;
+
+	if (contents == NULL || contents->answer_cache == NULL ||
+	    qdata->params->proto != KNOTD_QUERY_PROTO_UDP ||
+	    qdata->type != KNOTD_QUERY_TYPE_NORMAL ||
+	    knot_pkt_qclass(query) != KNOT_CLASS_IN ||
+	    query->tsig_rr != NULL || qdata->extra->zone->is_catalog_flag ||
+	    conf()->cache.srv_ans_rotate || zone_plan != NULL ||
+	    !plan_without_answer_hooks(plan)) {
+		return 0;
+	}
+
+	/* EDNS options in the query would require a specific OPT in the answer. */
+	if (knot_pkt_has_edns(query) && query->opt_rr->rrs.rdata->len > 0) {
+		return 0;
+	}
+
+	uint8_t *pos = key;
+	memcpy(pos, query->lower_qname, query->qname_size);
+	pos += query->qname_size;
+	knot_wire_write_u16(pos, knot_pkt_qtype(query));
+	pos += sizeof(uint16_t);
+	knot_wire_write_u16(pos, resp->max_size);
+	pos += sizeof(uint16_t);
+	*pos++ = knot_wire_get_flags1(query->wire);
+	*pos++ = knot_wire_get_flags2(query->wire);
+	*pos++ = knotd_qdata_remote_addr(qdata)->ss_family;
+	*pos++ = knot_pkt_has_edns(query) | (knot_pkt_has_dnssec(query) << 1);
+	assert(pos - key <= ANSWER_CACHE_MAX_KEY);
+
+	return pos - key;
+}
+
+/*! \brief Put a cached answer to the response, patching ID and QNAME case. */
+static knot_layer_state_t answer_from_cache(knotd_qdata_t *qdata, knot_pkt_t *pkt,
+                                            struct query_plan *plan,
+                                            const uint8_t *key, size_t key_len)
+{
+	answer_cache_t *cache = qdata->extra->contents->answer_cache;
+	size_t len = answer_cache_get(cache, key, key_len, pkt->wire, pkt->max_size);
+	if (len == 0) {
+		return KNOT_STATE_PRODUCE;
+	}
+
+	const knot_pkt_t *query = qdata->query;
+	knot_wire_set_id(pkt->wire, knot_wire_get_id(query->wire));
+	memcpy(pkt->wire + KNOT_WIRE_HEADER_SIZE, query->wire + KNOT_WIRE_HEADER_SIZE,
+	       query->qname_size);
+	pkt->size = len;
+	qdata->rcode = knot_wire_get_rcode(pkt->wire);
+
+	/* Remaining module hooks may inspect the response sections. */
+	if (plan != NULL && knot_pkt_parse(pkt, 0) != KNOT_EOK) {
+		return KNOT_STATE_FAIL;
+	}
+
+	return KNOT_STATE_FINAL;
+}
+
+/*! \brief Store the final response into the answer cache if suitable. */
+static void answer_to_cache(knotd_qdata_t *qdata, const knot_pkt_t *pkt,
+                            const uint8_t *key, size_t key_len)
+{
+	if ((qdata->rcode != KNOT_RCODE_NOERROR && qdata->rcode != KNOT_RCODE_NXDOMAIN) ||
+	    qdata->rcode_ede != KNOT_EDNS_EDE_NONE || knot_wire_get_tc(pkt->wire) ||
+	    qdata->extra->ext_finished != NULL) {
+		return;
+	}
+
+	answer_cache_put(qdata->extra->contents->answer_cache, key, key_len,
+	                 pkt->wire, pkt->size);
+}
+
 static void set_rcode_to_packet(knot_pkt_t *pkt, knotd_qdata_t *qdata)
 {
 	uint8_t ext_rcode = KNOT_EDNS_RCODE_HI(qdata->rcode);
@@ -602,6 +708,9 @@ static int process_query_out(knot_layer_t *ctx, knot_pkt_t *pkt)
 	struct query_plan *zone_plan = NULL;
 	struct query_step *step;
 
+	uint8_t cache_key[ANSWER_CACHE_MAX_KEY];
+	size_t cache_key_len = 0;
+
 	int next_state = KNOT_STATE_PRODUCE;
 
 	/* Check parse state. */
@@ -626,6 +735,17 @@ static int process_query_out(knot_layer_t *ctx, knot_pkt_t *pkt)
 	PROCESS_BEGIN(plan, step, next_state, qdata);
 	PROCESS_BEGIN(zone_plan, step, next_state, qdata);
 
+	/* Try to reuse an already rendered answer. */
+	if (next_state == KNOT_STATE_PRODUCE) {
+		cache_key_len = answer_cache_key(qdata, pkt, plan, zone_plan, cache_key);
+		if (cache_key_len > 0) {
+			next_state = answer_from_cache(qdata, pkt, plan, cache_key, cache_key_len);
+			if (next_state != KNOT_STATE_PRODUCE) {
+				goto finish;
+			}
+		}
+	}
+
 	/* Answer based on qclass. */
 	if (next_state == KNOT_STATE_PRODUCE) {
 		switch (knot_pkt_qclass(pkt)) {
@@ -683,6 +803,9 @@ finish:
 		break;
 	default:
 		set_rcode_to_packet(pkt, qdata);
+		if (next_state == KNOT_STATE_DONE && cache_key_len > 0) {
+			answer_to_cache(qdata, pkt, cache_key, cache_key_len);
+		}
 	}
 
 	/* After query processing code. */
@@ -740,15 +863,31 @@ bool process_query_acl_check(conf_t *conf, acl_action_t action,
 		       action == ACL_ACTION_TRANSFER);
 		const yp_name_t *item = (action == ACL_ACTION_NOTIFY) ? C_MASTER : C_NOTIFY;
 		conf_val_t rmts = conf_zone_get(conf, item, zone_name);
-		allowed = rmt_allowed(conf, &rmts, query_source, &tsig, tls_session,
-		                      qdata->params->proto);
+		const acl_set_t *set = acl_cache_rmt(conf->acl_cache, &rmts);
+		if (set != NULL) {
+			allowed = acl_set_allowed(set, action, query_source, &tsig,
+			                          zone_name, query, tls_session,
+			                          qdata->params->proto, false);
+		} else {
+			allowed = rmt_allowed(conf, &rmts, query_source, &tsig,
+			                      tls_session, qdata->params->proto);
+		}
 		automatic = allowed;
 	}
 	if (!allowed) {
 		conf_val_t acl = conf_zone_get(conf, C_ACL, zone_name);
-		allowed = acl_allowed(conf, &acl, action, query_source, &tsig,
-		                      zone_name, query, tls_session,
-		                      qdata->params->proto);
+		const acl_set_t *set = acl_cache_acl(conf->acl_cache, &acl);
+		if (set != NULL) {
+			bool forward = (action == ACL_ACTION_UPDATE) &&
+			               acl_update_forwarded(conf, zone_name);
+			allowed = acl_set_allowed(set, action, query_source, &tsig,
+			                          zone_name, query, tls_session,
+			                          qdata->params->proto, forward);
+		} else {
+			allowed = acl_allowed(conf, &acl, action, query_source, &tsig,
+			                      zone_name, query, tls_session,
+			                      qdata->params->proto);
+		}
 	}
 
 	if (log_enabled_debug()) {
@@ -26,6 +26,9 @@ typedef struct knotd_qdata_extra {
 
 	uint8_t cname_chain; /*!< Length of the CNAME chain so far. */
 
+	uint8_t nsec3_cache_hits;   /*!< NSEC3 hashes found in the contents cache. */
+	uint8_t nsec3_cache_misses; /*!< NSEC3 hashes computed despite the cache. */
+
 	/* Extensions. */
 	void *ext;
 	void (*ext_cleanup)(knotd_qdata_t *); /*!< Extensions cleanup callback. */
@@ -57,6 +57,30 @@ int xfr_process_list(knot_pkt_t *pkt, xfr_put_cb put, knotd_qdata_t *qdata)
 	return ret;
 }
 
+int xfr_put_rendered(knot_pkt_t *pkt, const uint8_t *answer, size_t len,
+                     uint16_t ancount)
+{
+	if (pkt == NULL || answer == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	if (pkt->size + len > pkt->max_size - pkt->reserved) {
+		return KNOT_ESPACE;
+	}
+
+	int ret = knot_pkt_begin(pkt, KNOT_ANSWER);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	/* Keep the header and question, including the message ID and QNAME case. */
+	memcpy(pkt->wire + pkt->size, answer, len);
+	pkt->size += len;
+	knot_wire_set_ancount(pkt->wire, ancount);
+
+	return KNOT_EOK;
+}
+
 void xfr_stats_begin(struct xfr_stats *stats)
 {
 	assert(stats);
@@ -52,6 +52,23 @@ struct xfr_proc {
  */
 typedef int (*xfr_put_cb)(knot_pkt_t *pkt, const void *item, struct xfr_proc *xfer);
 
+/*!
+ * \brief Append a pre-rendered answer section to the response.
+ *
+ * The response must contain just the header and the question of the same
+ * size as the one the answer was rendered with, as the compression pointers
+ * may refer to it.
+ *
+ * \param pkt      Response.
+ * \param answer   Rendered answer section.
+ * \param len      Answer section size.
+ * \param ancount  Number of answer RRs.
+ *
+ * \return KNOT_EOK, KNOT_ESPACE if the answer doesn't fit.
+ */
+int xfr_put_rendered(knot_pkt_t *pkt, const uint8_t *answer, size_t len,
+                     uint16_t ancount);
+
 /*!
  * \brief Put all items from xfr_proc.nodes to packet using a callback function.
  *
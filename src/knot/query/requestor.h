@@ -33,6 +33,7 @@ typedef enum {
 	KNOT_REQUESTOR_QUIC   = 1 << 2, /*!< QUIC used indication (RO). */
 	KNOT_REQUESTOR_TLS    = 1 << 3, /*!< DoT used indication (RO). */
 	KNOT_REQUESTOR_IOFAIL = 1 << 4, /*!< Encountered error sending/recving data. */
+	KNOT_REQUESTOR_UDP    = 1 << 5, /*!< UDP used indication (non-blocking SOA check). */
 } knot_requestor_flag_t;
 
 /*! \brief Requestor structure.
@@ -73,7 +74,9 @@ typedef struct knot_request {
 static inline knotd_query_proto_t flags2proto(unsigned layer_flags)
 {
 	knotd_query_proto_t proto = KNOTD_QUERY_PROTO_TCP;
-	if ((layer_flags & KNOT_REQUESTOR_QUIC)) {
+	if ((layer_flags & KNOT_REQUESTOR_UDP)) {
+		proto = KNOTD_QUERY_PROTO_UDP;
+	} else if ((layer_flags & KNOT_REQUESTOR_QUIC)) {
 		proto = KNOTD_QUERY_PROTO_QUIC;
 	} else if ((layer_flags & KNOT_REQUESTOR_TLS)) {
 		proto = KNOTD_QUERY_PROTO_TLS;
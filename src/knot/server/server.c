@@ -28,6 +28,7 @@
 #include "knot/conf/migration.h"
 #include "knot/conf/module.h"
 #include "knot/dnssec/kasp/kasp_db.h"
+#include "knot/events/soa_check.h"
 #include "knot/journal/journal_basic.h"
 #include "knot/server/server.h"
 #include "knot/server/udp-handler.h"
@@ -203,6 +204,22 @@ static bool enable_pktinfo(int sock, int family)
 	return setsockopt(sock, level, option, &on, sizeof(on)) == 0;
 }
 
+/*!
+ * \brief Enable receiving of coalesced datagrams (UDP GRO).
+ */
+static int enable_udp_gro(int sock)
+{
+#ifdef ENABLE_UDP_SEGMENTATION
+	const int on = 1;
+	if (setsockopt(sock, IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) != 0) {
+		return knot_map_errno();
+	}
+	return KNOT_EOK;
+#else
+	return KNOT_ENOTSUP;
+#endif
+}
+
 /*!
  * Linux 3.15 has IP_PMTUDISC_OMIT which makes sockets
  * ignore PMTU information and send packets with DF=0.
@@ -347,13 +364,15 @@ static iface_t *server_init_xdp_iface(struct sockaddr_storage *addr, bool route_
  * \param tcp_thread_count  Number of created TCP workers.
  * \param tcp_reuseport     Indication if reuseport on TCP is enabled.
  * \param socket_affinity   Indication if CBPF should be attached.
+ * \param udp_gro           Indication if UDP GRO should be enabled.
  *
  * \retval Pointer to a new initialized interface.
  * \retval NULL if error.
  */
 static iface_t *server_init_iface(struct sockaddr_storage *addr, bool tls,
                                   int udp_thread_count, int tcp_thread_count,
-                                  bool tcp_reuseport, bool socket_affinity)
+                                  bool tcp_reuseport, bool socket_affinity,
+                                  bool udp_gro)
 {
 	iface_t *new_if = calloc(1, sizeof(*new_if));
 	if (new_if == NULL) {
@@ -398,6 +417,7 @@ static iface_t *server_init_iface(struct sockaddr_storage *addr, bool tls,
 	bool warn_bufsize = true;
 	bool warn_pktinfo = true;
 	bool warn_ecn = true;
+	bool warn_gro = true;
 	bool warn_flag_misc = true;
 
 	/* Create bound UDP sockets. */
@@ -449,6 +469,14 @@ static iface_t *server_init_iface(struct sockaddr_storage *addr, bool tls,
 			warn_flag_misc = false;
 		}
 
+		if (udp_gro && addr->ss_family != AF_UNIX) {
+			ret = enable_udp_gro(sock);
+			if (ret != KNOT_EOK && warn_gro) {
+				log_warning("failed to enable UDP GRO (%s)", knot_strerror(ret));
+				warn_gro = false;
+			}
+		}
+
 		if (tls) {
 			ret = net_cmsg_ecn_enable(sock, addr->ss_family);
 			if (ret != KNOT_EOK && ret != KNOT_ENOTSUP && warn_ecn) {
@@ -716,6 +744,7 @@ static int configure_sockets(conf_t *conf, server_t *s)
 	unsigned size_tcp = s->handlers[IO_TCP].handler.unit->size;
 	bool tcp_reuseport = conf->cache.srv_tcp_reuseport;
 	bool socket_affinity = conf->cache.srv_socket_affinity;
+	bool udp_gro = conf->cache.srv_udp_segmentation;
 	char *rundir = conf_abs_path(&rundir_val, NULL);
 	while (listen_val.code == KNOT_EOK) {
 		struct sockaddr_storage addr = conf_addr(&listen_val, rundir);
@@ -724,7 +753,7 @@ static int configure_sockets(conf_t *conf, server_t *s)
 		log_info("binding to interface %s", addr_str);
 
 		iface_t *new_if = server_init_iface(&addr, false, size_udp, size_tcp,
-		                                    tcp_reuseport, socket_affinity);
+		                                    tcp_reuseport, socket_affinity, udp_gro);
 		if (new_if == NULL) {
 			server_deinit_iface_list(newlist, nifs);
 			free(rundir);
@@ -742,7 +771,7 @@ static int configure_sockets(conf_t *conf, server_t *s)
 		log_info("binding to QUIC interface %s", addr_str);
 
 		iface_t *new_if = server_init_iface(&addr, true, size_udp, 0,
-		                                    false, socket_affinity);
+		                                    false, socket_affinity, false);
 		if (new_if == NULL) {
 			server_deinit_iface_list(newlist, nifs);
 			free(rundir);
@@ -761,7 +790,7 @@ static int configure_sockets(conf_t *conf, server_t *s)
 		log_info("binding to TLS interface %s", addr_str);
 
 		iface_t *new_if = server_init_iface(&addr, true, 0, size_tcp,
-		                                    tcp_reuseport, socket_affinity);
+		                                    tcp_reuseport, socket_affinity, false);
 		if (new_if == NULL) {
 			server_deinit_iface_list(newlist, nifs);
 			free(rundir);
@@ -854,8 +883,16 @@ int server_init(server_t *server, int bg_workers)
 		return KNOT_ENOMEM;
 	}
 
+	server->reverse_pending = trie_create(NULL);
+	if (server->reverse_pending == NULL) {
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return KNOT_ENOMEM;
+	}
+
 	int ret = catalog_update_init(&server->catalog_upd);
 	if (ret != KNOT_EOK) {
+		trie_free(server->reverse_pending);
 		worker_pool_destroy(server->workers);
 		evsched_deinit(&server->sched);
 		return ret;
@@ -911,9 +948,15 @@ void server_deinit(server_t *server)
 
 	/* Free threads and event handlers. */
 	worker_pool_destroy(server->workers);
+	free(server->stats.udp);
+
+	/* Drop pending SOA checks, the refresh timers are stored already. */
+	soa_check_free(server->soa_check);
+	server->soa_check = NULL;
 
 	/* Free zone database. */
 	knot_zonedb_deep_free(&server->zone_db, true);
+	trie_free(server->reverse_pending);
 
 	/* Free remaining events. */
 	evsched_deinit(&server->sched);
@@ -1002,7 +1045,7 @@ static void worker_wait_cb(worker_pool_t *pool)
 	/* Too frequent worker_pool_status() call with many zones is expensive. */
 	if (now_ns - last_ns > 1000000000) {
 		int running, queued;
-		worker_pool_status(pool, true, &running, &queued);
+		worker_pool_status(pool, &running, &queued);
 		systemd_tasks_status_notify(running + queued);
 		last_ns = now_ns;
 	}
@@ -1209,6 +1252,8 @@ static void warn_server_reconfigure(conf_t *conf, server_t *server)
 
 	static bool warn_tcp_reuseport = true;
 	static bool warn_socket_affinity = true;
+	static bool warn_udp_segmentation = true;
+	static bool warn_io_uring = true;
 	static bool warn_udp = true;
 	static bool warn_tcp = true;
 	static bool warn_bg = true;
@@ -1232,6 +1277,16 @@ static void warn_server_reconfigure(conf_t *conf, server_t *server)
 		warn_socket_affinity = false;
 	}
 
+	if (warn_udp_segmentation && conf->cache.srv_udp_segmentation != conf_get_bool(conf, C_SRV, C_UDP_SEGMENTATION)) {
+		log_warning(msg, &C_UDP_SEGMENTATION[1]);
+		warn_udp_segmentation = false;
+	}
+
+	if (warn_io_uring && conf->cache.srv_io_uring != conf_get_bool(conf, C_SRV, C_IO_URING)) {
+		log_warning(msg, &C_IO_URING[1]);
+		warn_io_uring = false;
+	}
+
 	if (warn_udp && server->handlers[IO_UDP].size != conf_udp_threads(conf)) {
 		log_warning(msg, &C_UDP_WORKERS[1]);
 		warn_udp = false;
@@ -1357,6 +1412,12 @@ int server_reload(server_t *server, reload_t mode)
 		upd_flags |= CONF_UPD_FMODULES;
 	}
 
+	/* Cache the compiled zone ACLs, fall back to the direct evaluation if failed. */
+	new_conf->acl_cache = acl_cache_new(new_conf);
+	if (new_conf->acl_cache == NULL) {
+		log_warning("failed to prepare ACL cache");
+	}
+
 	/* Update to the new config. */
 	conf_t *old_conf = conf_update(new_conf, upd_flags);
 
@@ -1420,6 +1481,16 @@ static int set_handler(server_t *server, int index, unsigned size, runnable_t ru
 
 static int configure_threads(conf_t *conf, server_t *server)
 {
+	/* Per-thread UDP counters, indexed by the UDP thread IDs which come first.
+	 * The XDP threads don't use them. */
+	unsigned udp_count = conf->cache.srv_udp_threads;
+	if (posix_memalign((void **)&server->stats.udp, 64,
+	                   udp_count * sizeof(*server->stats.udp)) != 0) {
+		return KNOT_ENOMEM;
+	}
+	memset(server->stats.udp, 0, udp_count * sizeof(*server->stats.udp));
+	server->stats.udp_count = udp_count;
+
 	int ret = set_handler(server, IO_UDP, conf->cache.srv_udp_threads, udp_master);
 	if (ret != KNOT_EOK) {
 		return ret;
@@ -1479,6 +1550,22 @@ static void free_sess_ticket(intptr_t ptr)
 	}
 }
 
+static int reconfigure_soa_check(conf_t *conf, server_t *server)
+{
+	size_t limit = conf->cache.srv_refresh_inflight;
+	if (server->soa_check == NULL && limit > 0) {
+		server->soa_check = soa_check_new(limit);
+		if (server->soa_check == NULL) {
+			return KNOT_ENOMEM;
+		}
+	} else if (limit > 0) {
+		soa_check_set_limit(server->soa_check, limit);
+	}
+	// If disabled, the checker only finishes the checks in flight.
+
+	return KNOT_EOK;
+}
+
 static int reconfigure_remote_pool(conf_t *conf, server_t *server)
 {
 	conf_val_t val = conf_get(conf, C_SRV, C_RMT_POOL_LIMIT);
@@ -1598,6 +1685,12 @@ int server_reconfigure(conf_t *conf, server_t *server)
 		          knot_strerror(ret));
 	}
 
+	/* Reconfigure SOA checker. */
+	if ((ret = reconfigure_soa_check(conf, server)) != KNOT_EOK) {
+		log_error("failed to reconfigure SOA checker (%s)",
+		          knot_strerror(ret));
+	}
+
 	return KNOT_EOK;
 }
 
@@ -77,6 +77,28 @@ enum {
 	IO_XDP = 2,
 };
 
+/*!
+ * \brief Number of NOTIFY latency histogram buckets.
+ *
+ * The first bucket counts latencies below 1 ms, each next one up to twice
+ * the previous bound, and the last one all the longer latencies.
+ */
+#define SERVER_NOTIFY_LATENCY_BUCKETS	16
+
+/*!
+ * \brief UDP I/O counters of one UDP worker.
+ *
+ * Only the worker updates its counters, they are summed when dumped.
+ */
+typedef struct {
+	_Alignas(64) knot_atomic_uint64_t recv_batches;
+	knot_atomic_uint64_t recv_full_batches;
+	knot_atomic_uint64_t recv_msgs;
+	knot_atomic_uint64_t gro_segments;
+	knot_atomic_uint64_t gso_sends;
+	knot_atomic_uint64_t gso_segments;
+} server_udp_stats_t;
+
 /*!
  * \brief Main server structure.
  *
@@ -89,10 +111,18 @@ typedef struct server {
 	struct {
 		knot_atomic_uint64_t tcp_io_timeout;
 		knot_atomic_uint64_t tcp_idle_timeout;
+		/*! \brief Counters of the UDP workers indexed by thread ID. */
+		server_udp_stats_t *udp;
+		unsigned udp_count;
+		knot_atomic_uint64_t io_uring_submits;
+		/*! \brief Latencies of acknowledged NOTIFYs, see SERVER_NOTIFY_LATENCY_BUCKETS. */
+		knot_atomic_uint64_t notify_latency[SERVER_NOTIFY_LATENCY_BUCKETS];
 
 	} stats;
 
 	knot_zonedb_t *zone_db;
+	/*! \brief Reverse zones missing some zones to reverse (names as keys). */
+	trie_t *reverse_pending;
 	knot_lmdb_db_t timerdb;
 	knot_lmdb_db_t journaldb;
 	knot_lmdb_db_t kaspdb;
@@ -110,6 +140,9 @@ typedef struct server {
 	/*! \brief Event scheduler. */
 	evsched_t sched;
 
+	/*! \brief Non-blocking SOA checker of zone refreshes (NULL if disabled). */
+	struct soa_check *soa_check;
+
 	/*! \brief List of interfaces. */
 	iface_t *ifaces;
 	size_t n_ifaces;
@@ -23,6 +23,9 @@
 #include "knot/server/tcp-handler.h"
 #include "knot/common/log.h"
 #include "knot/common/fdset.h"
+#ifdef ENABLE_IO_URING
+#include "knot/common/uring.h"
+#endif // ENABLE_IO_URING
 #include "knot/nameserver/process_query.h"
 #include "knot/query/layer.h"
 #include "libknot/quic/tls.h"
@@ -50,7 +53,26 @@ typedef struct tcp_context {
 	struct knot_tls_ctx *tls_ctx;    /*!< DoT answering context. */
 } tcp_context_t;
 
+/*! \brief Growable byte buffer. */
+typedef struct {
+	uint8_t *data;
+	size_t len;
+	size_t size;
+} tcp_buf_t;
+
+/*! \brief TCP client connection state, the fdset context of client sockets. */
+typedef struct {
+	const iface_t *iface;            /*!< Interface the connection was accepted on. */
+	sockaddr_t remote;               /*!< Remote address resolved at accept. */
+	sockaddr_t local;                /*!< Local address resolved at accept. */
+	tcp_buf_t rx;                    /*!< Incomplete received message. */
+	tcp_buf_t tx;                    /*!< Queued output. */
+	size_t tx_sent;                  /*!< Already sent bytes of the queued output. */
+} tcp_conn_t;
+
 #define TCP_SWEEP_INTERVAL 2 /*!< [secs] granularity of connection sweeping. */
+#define TCP_TX_FLUSH (64 * 1024)   /*!< Queued output size to be sent before producing more. */
+#define TCP_TX_MAX   (1024 * 1024) /*!< Queued output size to wait for being sent. */
 
 static void update_sweep_timer(struct timespec *timer)
 {
@@ -73,6 +95,240 @@ static void update_tcp_conf(tcp_context_t *tcp)
 	}
 }
 
+static void tcp_log_error(const struct sockaddr_storage *ss, const char *operation,
+                          int ret, server_t *server)
+{
+	/* Don't log ECONN as it usually means client closed the connection. */
+	if (ret != KNOT_ETIMEOUT) {
+		return;
+	}
+
+	ATOMIC_ADD(server->stats.tcp_io_timeout, 1);
+
+	if (log_enabled_debug()) {
+		char addr_str[SOCKADDR_STRLEN];
+		sockaddr_tostr(addr_str, sizeof(addr_str), ss);
+		log_debug("TCP, failed to %s due to IO timeout, closing connection, address %s",
+		          operation, addr_str);
+	}
+}
+
+static int tcp_buf_reserve(tcp_buf_t *buf, size_t len)
+{
+	if (buf->len + len <= buf->size) {
+		return KNOT_EOK;
+	}
+
+	size_t size = MAX(buf->len + len, 2 * buf->size);
+	uint8_t *data = realloc(buf->data, size);
+	if (data == NULL) {
+		return KNOT_ENOMEM;
+	}
+	buf->data = data;
+	buf->size = size;
+
+	return KNOT_EOK;
+}
+
+/*! \brief Move data to the buffer until it contains 'need' bytes. */
+static int tcp_buf_append(tcp_buf_t *buf, uint8_t **data, size_t *len, size_t need)
+{
+	if (buf->len >= need) {
+		return KNOT_EOK;
+	}
+
+	size_t take = MIN(need - buf->len, *len);
+	int ret = tcp_buf_reserve(buf, take);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	memcpy(buf->data + buf->len, *data, take);
+	buf->len += take;
+	*data += take;
+	*len -= take;
+
+	return KNOT_EOK;
+}
+
+static void tcp_conn_init(tcp_conn_t *conn, const iface_t *iface, int fd,
+                          const struct sockaddr_storage *remote)
+{
+	memset(conn, 0, sizeof(*conn));
+	conn->iface = iface;
+
+	/* Resolve the addresses once per connection. */
+	memcpy(&conn->local, &iface->addr, sizeof(conn->local));
+	if (iface->anyaddr) {
+		socklen_t local_len = sizeof(conn->local);
+		(void)getsockname(fd, &conn->local.ip, &local_len);
+	}
+	memcpy(&conn->remote, &iface->addr, sizeof(conn->remote));
+	if (iface->addr.ss_family != AF_UNIX) {
+		if (remote != NULL) {
+			memcpy(&conn->remote, remote, sizeof(conn->remote));
+		} else {
+			socklen_t remote_len = sizeof(conn->remote);
+			(void)getpeername(fd, &conn->remote.ip, &remote_len);
+		}
+	}
+}
+
+static void tcp_conn_clear(tcp_conn_t *conn)
+{
+	free(conn->rx.data);
+	free(conn->tx.data);
+	memset(conn, 0, sizeof(*conn));
+}
+
+static void tcp_conn_free(tcp_conn_t *conn)
+{
+	if (conn != NULL) {
+		tcp_conn_clear(conn);
+		free(conn);
+	}
+}
+
+/*! \brief Check if the connection waits for the rest of a message or for sending. */
+static bool tcp_conn_pending(const tcp_conn_t *conn)
+{
+	return conn->rx.len > 0 || conn->tx_sent < conn->tx.len;
+}
+
+/*!
+ * \brief Send the queued output.
+ *
+ * If not waiting, send just what the socket accepts without blocking.
+ */
+static int tcp_conn_send(tcp_context_t *tcp, int fd, tcp_conn_t *conn, bool wait)
+{
+	uint8_t *data = conn->tx.data + conn->tx_sent;
+	size_t len = conn->tx.len - conn->tx_sent;
+	if (len == 0) {
+		return KNOT_EOK;
+	}
+
+	ssize_t ret = wait ? net_stream_send(fd, data, len, tcp->io_timeout)
+	                   : net_stream_send_nowait(fd, data, len);
+	if (ret < 0) {
+		return ret;
+	}
+	conn->tx_sent += ret;
+
+	/* Reuse the buffer if sent, drop the sent part if it prevails. */
+	len -= ret;
+	if (len == 0) {
+		conn->tx.len = 0;
+		conn->tx_sent = 0;
+	} else if (conn->tx_sent >= len) {
+		memmove(conn->tx.data, conn->tx.data + conn->tx_sent, len);
+		conn->tx.len = len;
+		conn->tx_sent = 0;
+	}
+
+	return KNOT_EOK;
+}
+
+/*! \brief Queue the length-prefixed message for sending. */
+static int tcp_conn_queue(tcp_conn_t *conn, const knot_pkt_t *msg)
+{
+	int ret = tcp_buf_reserve(&conn->tx, sizeof(uint16_t) + msg->size);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	uint8_t *out = conn->tx.data + conn->tx.len;
+	knot_wire_write_u16(out, msg->size);
+	memcpy(out + sizeof(uint16_t), msg->wire, msg->size);
+	conn->tx.len += sizeof(uint16_t) + msg->size;
+
+	return KNOT_EOK;
+}
+
+/*!
+ * \brief Answer one query, queue the length-prefixed answers for sending.
+ *
+ * The growing output is sent during answering and a large output
+ * (e.g. zone transfer) is waited for.
+ */
+static int tcp_answer(tcp_context_t *tcp, knotd_qdata_params_t *params,
+                      tcp_conn_t *conn, uint8_t *query, size_t query_len)
+{
+	struct iovec rx = { .iov_base = query, .iov_len = query_len };
+	handle_query(params, &tcp->layer, &rx, NULL);
+
+	/* Resolve until NOOP or finished. */
+	int ret = KNOT_EOK;
+	struct iovec *tx = &tcp->iov[1];
+	knot_pkt_t *ans = knot_pkt_new(tx->iov_base, KNOT_WIRE_MAX_PKTSIZE, tcp->layer.mm);
+	while (active_state(tcp->layer.state)) {
+		knot_layer_produce(&tcp->layer, ans);
+		/* Queue, if response generation passed and wasn't ignored. */
+		if (ans->size > 0 && send_state(tcp->layer.state)) {
+			ret = tcp_conn_queue(conn, ans);
+			if (ret != KNOT_EOK) {
+				break;
+			}
+
+			size_t queued = conn->tx.len - conn->tx_sent;
+			if (queued >= TCP_TX_FLUSH) {
+				ret = tcp_conn_send(tcp, params->socket, conn, queued >= TCP_TX_MAX);
+				if (ret != KNOT_EOK) {
+					tcp_log_error(params->remote, "send", ret, tcp->server);
+					break;
+				}
+			}
+		}
+	}
+
+	handle_finish(&tcp->layer);
+
+	return ret;
+}
+
+/*! \brief Process received data, answer all complete messages. */
+static int tcp_conn_consume(tcp_context_t *tcp, const knotd_qdata_params_t *params,
+                            tcp_conn_t *conn, uint8_t *data, size_t len)
+{
+	tcp_buf_t *rx = &conn->rx;
+
+	while (len > 0) {
+		uint8_t *msg = data;
+
+		/* Reassemble the message unless it's complete in the received data. */
+		if (rx->len > 0 || len < sizeof(uint16_t) ||
+		    len < sizeof(uint16_t) + knot_wire_read_u16(data)) {
+			int ret = tcp_buf_append(rx, &data, &len, sizeof(uint16_t));
+			if (ret != KNOT_EOK || rx->len < sizeof(uint16_t)) {
+				return ret;
+			}
+			size_t need = sizeof(uint16_t) + knot_wire_read_u16(rx->data);
+			ret = tcp_buf_append(rx, &data, &len, need);
+			if (ret != KNOT_EOK || rx->len < need) {
+				return ret;
+			}
+			msg = rx->data;
+		}
+
+		size_t msg_len = knot_wire_read_u16(msg);
+		if (msg_len == 0) {
+			return KNOT_EMALF;
+		}
+		knotd_qdata_params_t msg_params = *params;
+		int ret = tcp_answer(tcp, &msg_params, conn, msg + sizeof(uint16_t),
+		                     msg_len);
+		if (msg == rx->data) {
+			rx->len = 0;
+		} else {
+			data += sizeof(uint16_t) + msg_len;
+			len -= sizeof(uint16_t) + msg_len;
+		}
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
 static void free_tls_ctx(fdset_t *set, int idx)
 {
 	void **tls_conn = fdset_ctx2(set, idx);
@@ -84,46 +340,32 @@ static void free_tls_ctx(fdset_t *set, int idx)
 
 static fdset_sweep_state_t tcp_sweep(fdset_t *set, int idx, void *data)
 {
-	const int fd = fdset_get_fd(set, idx);
-	assert(set && fd >= 0);
+	assert(set && fdset_get_fd(set, idx) >= 0);
 
 	server_t *server = data;
-	ATOMIC_ADD(server->stats.tcp_idle_timeout, 1);
+	tcp_conn_t *conn = set->ctx[idx];
 
-	if (log_enabled_debug()) {
-		/* Best-effort, name and shame. */
-		struct sockaddr_storage ss = { 0 };
-		socklen_t len = sizeof(struct sockaddr_storage);
-		if (getpeername(fd, (struct sockaddr *)&ss, &len) == 0) {
+	if (tcp_conn_pending(conn)) {
+		/* Stuck in the middle of a message. */
+		tcp_log_error((struct sockaddr_storage *)&conn->remote,
+		              (conn->rx.len > 0) ? "receive" : "send", KNOT_ETIMEOUT, server);
+	} else {
+		ATOMIC_ADD(server->stats.tcp_idle_timeout, 1);
+
+		if (log_enabled_debug()) {
 			char addr_str[SOCKADDR_STRLEN];
-			sockaddr_tostr(addr_str, sizeof(addr_str), &ss);
+			sockaddr_tostr(addr_str, sizeof(addr_str),
+			               (struct sockaddr_storage *)&conn->remote);
 			log_debug("TCP, terminated inactive client, address %s", addr_str);
 		}
 	}
 
 	free_tls_ctx(set, idx);
+	tcp_conn_free(conn);
 
 	return FDSET_SWEEP;
 }
 
-static void tcp_log_error(const struct sockaddr_storage *ss, const char *operation,
-                          int ret, server_t *server)
-{
-	/* Don't log ECONN as it usually means client closed the connection. */
-	if (ret != KNOT_ETIMEOUT) {
-		return;
-	}
-
-	ATOMIC_ADD(server->stats.tcp_io_timeout, 1);
-
-	if (log_enabled_debug()) {
-		char addr_str[SOCKADDR_STRLEN];
-		sockaddr_tostr(addr_str, sizeof(addr_str), ss);
-		log_debug("TCP, failed to %s due to IO timeout, closing connection, address %s",
-		          operation, addr_str);
-	}
-}
-
 static unsigned tcp_set_ifaces(const iface_t *ifaces, size_t n_ifaces,
                                fdset_t *fds, int thread_id, bool *tls)
 {
@@ -158,29 +400,25 @@ static unsigned tcp_set_ifaces(const iface_t *ifaces, size_t n_ifaces,
 	return fdset_get_length(fds);
 }
 
-static int tcp_handle(tcp_context_t *tcp, knotd_qdata_params_t *params,
-                      struct iovec *rx, struct iovec *tx)
+static int tcp_handle_tls(tcp_context_t *tcp, knotd_qdata_params_t *params,
+                          struct iovec *rx, struct iovec *tx)
 {
 	rx->iov_len = KNOT_WIRE_MAX_PKTSIZE;
 	tx->iov_len = KNOT_WIRE_MAX_PKTSIZE;
 
 	/* Receive data. */
 	int recv;
-	if (params->tls_conn != NULL) {
-		int ret = knot_tls_handshake(params->tls_conn, true);
-		switch (ret) {
-		case KNOT_NET_EAGAIN: // Unfinished handshake, continue later.
-			return KNOT_EOK;
-		case KNOT_EOK:        // Finished handshake, continue with receiving message.
-			recv = knot_tls_recv(params->tls_conn, rx->iov_base, rx->iov_len);
-			break;
-		default:              // E.g. handshake timeout.
-			assert(ret < 0);
-			recv = ret;
-			break;
-		}
-	} else {
-		recv = net_dns_tcp_recv(params->socket, rx->iov_base, rx->iov_len, tcp->io_timeout);
+	int ret = knot_tls_handshake(params->tls_conn, true);
+	switch (ret) {
+	case KNOT_NET_EAGAIN: // Unfinished handshake, continue later.
+		return KNOT_EOK;
+	case KNOT_EOK:        // Finished handshake, continue with receiving message.
+		recv = knot_tls_recv(params->tls_conn, rx->iov_base, rx->iov_len);
+		break;
+	default:              // E.g. handshake timeout.
+		assert(ret < 0);
+		recv = ret;
+		break;
 	}
 	if (recv > 0) {
 		rx->iov_len = recv;
@@ -197,13 +435,7 @@ static int tcp_handle(tcp_context_t *tcp, knotd_qdata_params_t *params,
 		knot_layer_produce(&tcp->layer, ans);
 		/* Send, if response generation passed and wasn't ignored. */
 		if (ans->size > 0 && send_state(tcp->layer.state)) {
-			int sent;
-			if (params->tls_conn != NULL) {
-				sent = knot_tls_send(params->tls_conn, ans->wire, ans->size);
-			} else {
-				sent = net_dns_tcp_send(params->socket, ans->wire, ans->size,
-				                        tcp->io_timeout, NULL);
-			}
+			int sent = knot_tls_send(params->tls_conn, ans->wire, ans->size);
 			if (sent != ans->size) {
 				tcp_log_error(params->remote, "send", sent, tcp->server);
 				handle_finish(&tcp->layer);
@@ -214,27 +446,60 @@ static int tcp_handle(tcp_context_t *tcp, knotd_qdata_params_t *params,
 
 	handle_finish(&tcp->layer);
 
-	if (params->tls_conn != NULL) {
-		// Store the qdata params AUTH flag to the connection.
-		if (params->flags & KNOTD_QUERY_FLAG_AUTHORIZED) {
-			params->tls_conn->flags |= KNOT_TLS_CONN_AUTHORIZED;
-		} else {
-			params->tls_conn->flags &= ~KNOT_TLS_CONN_AUTHORIZED;
-		}
+	// Store the qdata params AUTH flag to the connection.
+	if (params->flags & KNOTD_QUERY_FLAG_AUTHORIZED) {
+		params->tls_conn->flags |= KNOT_TLS_CONN_AUTHORIZED;
+	} else {
+		params->tls_conn->flags &= ~KNOT_TLS_CONN_AUTHORIZED;
 	}
 
 	return KNOT_EOK;
 }
 
+/*!
+ * \brief Answer the messages received on a plain TCP connection.
+ *
+ * Reads just the available data, complete messages are answered at once
+ * and the answers are sent without waiting for the client.
+ */
+static int tcp_handle(tcp_context_t *tcp, knotd_qdata_params_t *params,
+                      tcp_conn_t *conn)
+{
+	struct iovec *rx = &tcp->iov[0];
+	ssize_t recv = net_stream_recv(params->socket, rx->iov_base,
+	                               KNOT_WIRE_MAX_PKTSIZE, 0);
+	if (recv == KNOT_ETIMEOUT) {
+		return KNOT_EOK; // Nothing to read.
+	} else if (recv <= 0) {
+		return KNOT_EOF;
+	}
+
+	int ret = tcp_conn_consume(tcp, params, conn, rx->iov_base, recv);
+	if (ret == KNOT_EOK) {
+		ret = tcp_conn_send(tcp, params->socket, conn, false);
+	}
+
+	return (ret == KNOT_EOK) ? KNOT_EOK : KNOT_EOF;
+}
+
 static void tcp_event_accept(tcp_context_t *tcp, unsigned i, const iface_t *iface)
 {
 	/* Accept client. */
 	int fd = fdset_get_fd(&tcp->set, i);
-	int client = net_accept(fd, NULL);
+	struct sockaddr_storage remote;
+	int client = net_accept(fd, &remote);
 	if (client >= 0) {
+		tcp_conn_t *conn = malloc(sizeof(*conn));
+		if (conn == NULL) {
+			close(client);
+			return;
+		}
+		tcp_conn_init(conn, iface, client, &remote);
+
 		/* Assign to fdset. */
-		int idx = fdset_add(&tcp->set, client, FDSET_POLLIN, (void *)iface);
+		int idx = fdset_add(&tcp->set, client, FDSET_POLLIN, conn);
 		if (idx < 0) {
+			tcp_conn_free(conn);
 			close(client);
 			return;
 		}
@@ -244,67 +509,74 @@ static void tcp_event_accept(tcp_context_t *tcp, unsigned i, const iface_t *ifac
 	}
 }
 
-static int tcp_event_serve(tcp_context_t *tcp, unsigned i, const iface_t *iface)
+static int tcp_event_serve(tcp_context_t *tcp, unsigned i, tcp_conn_t *conn,
+                           bool writable)
 {
 	int fd = fdset_get_fd(&tcp->set, i);
+	bool pending = tcp_conn_pending(conn);
+	int ret;
 
-	/* Get local address. */
-	sockaddr_t *local = (sockaddr_t *)&iface->addr;
-	sockaddr_t local_buf;
-	if (iface->anyaddr) {
-		socklen_t local_len = sizeof(local_buf);
-		if (getsockname(fd, &local_buf.ip, &local_len) == 0) {
-			local = &local_buf;
+	if (writable) {
+		/* Only sending of the queued output is awaited. */
+		ret = tcp_conn_send(tcp, fd, conn, false);
+		if (ret != KNOT_EOK) {
+			return ret;
 		}
-	}
+	} else {
+		const iface_t *iface = conn->iface;
+		knotd_qdata_params_t params = params_init(iface->tls ? KNOTD_QUERY_PROTO_TLS
+		                                                     : KNOTD_QUERY_PROTO_TCP,
+		                                          &conn->remote, &conn->local, fd,
+		                                          tcp->server, tcp->thread_id);
 
-	/* Get remote address. */
-	sockaddr_t *remote = (sockaddr_t *)&iface->addr;
-	sockaddr_t remote_buf;
-	if (iface->addr.ss_family != AF_UNIX) {
-		socklen_t remote_len = sizeof(remote_buf);
-		if (getpeername(fd, &remote_buf.ip, &remote_len) == 0) {
-			remote = &remote_buf;
+		// NOTE there is no way to avoid calling accept() on unwanted connections:
+		// - it's not possible to read out the remote IP beforehand
+		// - there is no way to pull it out of the queue
+		// So we just accept() those connection (possibly going ahead with the handshake)
+		// and close it immediately.
+		if (process_query_proto(&params, KNOTD_STAGE_PROTO_BEGIN) == KNOTD_PROTO_STATE_BLOCK) {
+			return KNOT_EDENIED; // results in closing connection
 		}
-	}
 
-	knotd_qdata_params_t params = params_init(iface->tls ? KNOTD_QUERY_PROTO_TLS
-	                                                     : KNOTD_QUERY_PROTO_TCP,
-	                                          remote, local, fd, tcp->server,
-	                                          tcp->thread_id);
-
-	// NOTE there is no way to avoid calling accept() on unwanted connections:
-	// - it's not possible to read out the remote IP beforehand
-	// - there is no way to pull it out of the queue
-	// So we just accept() those connection (possibly going ahead with the handshake)
-	// and close it immediately.
-	if (process_query_proto(&params, KNOTD_STAGE_PROTO_BEGIN) == KNOTD_PROTO_STATE_BLOCK) {
-		return KNOT_EDENIED; // results in closing connection
-	}
-
-	/* Establish a TLS session. */
-	if (iface->tls) {
-		assert(tcp->tls_ctx != NULL);
-		knot_tls_conn_t *tls_conn = *fdset_ctx2(&tcp->set, i);
-		if (tls_conn == NULL) {
-			tls_conn = knot_tls_conn_new(tcp->tls_ctx, fd);
+		/* Establish a TLS session. */
+		if (iface->tls) {
+			assert(tcp->tls_ctx != NULL);
+			knot_tls_conn_t *tls_conn = *fdset_ctx2(&tcp->set, i);
 			if (tls_conn == NULL) {
-				return KNOT_ENOMEM;
+				tls_conn = knot_tls_conn_new(tcp->tls_ctx, fd);
+				if (tls_conn == NULL) {
+					return KNOT_ENOMEM;
+				}
+				*fdset_ctx2(&tcp->set, i) = tls_conn;
 			}
-			*fdset_ctx2(&tcp->set, i) = tls_conn;
+			params_update_tls(&params, tls_conn);
+			ret = tcp_handle_tls(tcp, &params, &tcp->iov[0], &tcp->iov[1]);
+		} else {
+			ret = tcp_handle(tcp, &params, conn);
+		}
+
+		(void)process_query_proto(&params, KNOTD_STAGE_PROTO_END);
+
+		if (ret != KNOT_EOK) {
+			return ret;
 		}
-		params_update_tls(&params, tls_conn);
 	}
 
-	int ret = tcp_handle(tcp, &params, &tcp->iov[0], &tcp->iov[1]);
-	if (ret == KNOT_EOK) {
-		/* Update socket activity timer. */
-		(void)fdset_set_watchdog(&tcp->set, i, tcp->idle_timeout);
+	/* Don't read more until the queued output is sent. */
+	bool sending = (conn->tx_sent < conn->tx.len);
+	ret = fdset_set_events(&tcp->set, i, sending ? FDSET_POLLOUT : FDSET_POLLIN);
+	if (ret != KNOT_EOK) {
+		return ret;
 	}
 
-	(void)process_query_proto(&params, KNOTD_STAGE_PROTO_END);
+	/* Update socket activity timer, the rest of a message is awaited shorter. */
+	if (!tcp_conn_pending(conn)) {
+		(void)fdset_set_watchdog(&tcp->set, i, tcp->idle_timeout);
+	} else if (!pending) {
+		(void)fdset_set_watchdog(&tcp->set, i, (tcp->io_timeout + 999) / 1000);
+	}
 
-	return ret;
+	return KNOT_EOK;
 }
 
 static void tcp_wait_for_events(tcp_context_t *tcp)
@@ -331,18 +603,21 @@ static void tcp_wait_for_events(tcp_context_t *tcp)
 		unsigned int idx = fdset_it_get_idx(&it);
 		if (fdset_it_is_error(&it)) {
 			should_close = (idx >= tcp->client_threshold);
-		} else if (fdset_it_is_pollin(&it)) {
+		} else if (idx < tcp->client_threshold) {
+			/* Master sockets - new connection to accept. */
 			const iface_t *iface = fdset_it_get_ctx(&it);
 			assert(iface);
-			/* Master sockets - new connection to accept. */
-			if (idx < tcp->client_threshold) {
-				/* Don't accept more clients than configured. */
-				if (fdset_get_length(set) < tcp->max_worker_fds) {
-					tcp_event_accept(tcp, idx, iface);
-				}
+			/* Don't accept more clients than configured. */
+			if (fdset_it_is_pollin(&it) &&
+			    fdset_get_length(set) < tcp->max_worker_fds) {
+				tcp_event_accept(tcp, idx, iface);
+			}
+		} else if (fdset_it_is_pollin(&it) || fdset_it_is_pollout(&it)) {
 			/* Client sockets - already accepted connection or
 			   closed connection :-( */
-			} else if (tcp_event_serve(tcp, idx, iface) != KNOT_EOK) {
+			tcp_conn_t *conn = fdset_it_get_ctx(&it);
+			assert(conn);
+			if (tcp_event_serve(tcp, idx, conn, fdset_it_is_pollout(&it)) != KNOT_EOK) {
 				should_close = true;
 			}
 		}
@@ -350,12 +625,658 @@ static void tcp_wait_for_events(tcp_context_t *tcp)
 		/* Evaluate. */
 		if (should_close) {
 			free_tls_ctx(set, idx);
+			tcp_conn_free(fdset_it_get_ctx(&it));
 			fdset_it_remove(&it);
 		}
 	}
 	fdset_it_commit(&it);
 }
 
+#ifdef ENABLE_IO_URING
+#define URING_TCP_ENTRIES	256  /*!< Submission queue size. */
+#define URING_TCP_RX_BUFS	256  /*!< Number of provided receive buffers. */
+#define URING_TCP_RX_BUFSIZE	4096 /*!< Size of one receive buffer. */
+
+/* Completion types. */
+enum {
+	URING_TCP_ACCEPT = 1,
+	URING_TCP_RECV   = 2,
+	URING_TCP_SEND   = 3,
+	URING_TCP_CANCEL = 4,
+};
+
+/*! \brief Answer being produced, kept while the connection output is full. */
+typedef struct uring_answer {
+	struct uring_answer *next;     /*!< Next unused answer context. */
+	knot_mm_t mm;                  /*!< Memory of the answer including the query. */
+	knot_layer_t layer;            /*!< Query processing layer. */
+	knotd_qdata_params_t params;   /*!< Query parameters referenced by the layer. */
+} uring_answer_t;
+
+/*! \brief TCP connection served by io_uring. */
+typedef struct {
+	tcp_conn_t conn;               /*!< Connection state with the input and output queue. */
+	int fd;
+	tcp_buf_t out;                 /*!< Output being sent. */
+	size_t out_sent;               /*!< Sent bytes of the output being sent. */
+	uring_answer_t *answer;        /*!< Answer suspended until the output is sent. */
+	struct timespec last_active;   /*!< Time of the last received message. */
+	struct timespec send_start;    /*!< Start of the current send. */
+	unsigned refs;                 /*!< Number of requests in flight. */
+	bool receiving;                /*!< Receive is armed. */
+	bool recv_canceled;            /*!< Cancellation of the receive is in flight. */
+	bool sending;
+	bool closing;
+} uring_conn_t;
+
+typedef struct {
+	uring_t ring;
+	tcp_context_t *tcp;
+	uring_conn_t **conns;          /*!< Connection slots. */
+	unsigned conns_size;
+	unsigned *free;                /*!< Stack of free connection slots. */
+	unsigned nfree;
+	unsigned active;               /*!< Number of open connections. */
+	unsigned sends;                /*!< Number of sends in flight. */
+	uring_answer_t *answers;       /*!< Unused answer contexts. */
+	bool accepting;                /*!< Multishot accepts are armed. */
+	unsigned accepts_armed;
+} tcp_uring_ctx_t;
+
+static void tcp_uring_arm_accept(tcp_uring_ctx_t *ur, unsigned idx)
+{
+	struct io_uring_sqe *sqe = uring_sqe(&ur->ring);
+	io_uring_prep_multishot_accept(sqe, fdset_get_fd(&ur->tcp->set, idx),
+	                               NULL, NULL, SOCK_CLOEXEC);
+	io_uring_sqe_set_data64(sqe, uring_data(URING_TCP_ACCEPT, idx));
+	ur->accepts_armed++;
+}
+
+/*! \brief Stop or resume accepting according to the number of open connections. */
+static void tcp_uring_throttle(tcp_uring_ctx_t *ur)
+{
+	tcp_context_t *tcp = ur->tcp;
+	bool throttled = ur->active >= tcp->max_worker_fds - tcp->client_threshold;
+	if (throttled && ur->accepting) {
+		for (unsigned i = 0; i < tcp->client_threshold; ++i) {
+			struct io_uring_sqe *sqe = uring_sqe(&ur->ring);
+			io_uring_prep_cancel64(sqe, uring_data(URING_TCP_ACCEPT, i), 0);
+			io_uring_sqe_set_data64(sqe, uring_data(URING_TCP_CANCEL, i));
+		}
+		ur->accepting = false;
+	} else if (!throttled && !ur->accepting && ur->accepts_armed == 0) {
+		for (unsigned i = 0; i < tcp->client_threshold; ++i) {
+			tcp_uring_arm_accept(ur, i);
+		}
+		ur->accepting = true;
+	}
+	tcp->is_throttled = throttled;
+}
+
+static void tcp_uring_arm_recv(tcp_uring_ctx_t *ur, unsigned idx)
+{
+	uring_conn_t *uc = ur->conns[idx];
+
+	struct io_uring_sqe *sqe = uring_sqe(&ur->ring);
+	io_uring_prep_recv_multishot(sqe, uc->fd, NULL, 0, 0);
+	sqe->flags |= IOSQE_BUFFER_SELECT;
+	sqe->buf_group = URING_BGID;
+	io_uring_sqe_set_data64(sqe, uring_data(URING_TCP_RECV, idx));
+	uc->refs++;
+	uc->receiving = true;
+}
+
+static void tcp_uring_arm_send(tcp_uring_ctx_t *ur, unsigned idx)
+{
+	uring_conn_t *uc = ur->conns[idx];
+	assert(uc->out_sent < uc->out.len);
+
+	struct io_uring_sqe *sqe = uring_sqe(&ur->ring);
+	io_uring_prep_send(sqe, uc->fd, uc->out.data + uc->out_sent,
+	                   uc->out.len - uc->out_sent, MSG_NOSIGNAL);
+	io_uring_sqe_set_data64(sqe, uring_data(URING_TCP_SEND, idx));
+	uc->refs++;
+	uc->sending = true;
+	ur->sends++;
+}
+
+/*! \brief Get the size of the output not sent yet. */
+static size_t tcp_uring_queued(const uring_conn_t *uc)
+{
+	return uc->conn.tx.len + uc->out.len - uc->out_sent;
+}
+
+/*! \brief Check if the connection waits for its output to be sent. */
+static bool tcp_uring_blocked(const uring_conn_t *uc)
+{
+	return uc->answer != NULL || tcp_uring_queued(uc) >= TCP_TX_MAX;
+}
+
+/*! \brief Send the queued output unless a send is already in flight. */
+static void tcp_uring_flush(tcp_uring_ctx_t *ur, unsigned idx)
+{
+	uring_conn_t *uc = ur->conns[idx];
+	if (uc->sending || uc->closing || uc->conn.tx.len == 0) {
+		return;
+	}
+
+	tcp_buf_t tmp = uc->out;
+	uc->out = uc->conn.tx;
+	uc->conn.tx = tmp;
+	uc->conn.tx.len = 0;
+	uc->out_sent = 0;
+	uc->send_start = time_now();
+	tcp_uring_arm_send(ur, idx);
+}
+
+/*!
+ * \brief Stop receiving while the output is full, resume once it's sent.
+ *
+ * The data received before the receive is canceled are kept for later.
+ */
+static void tcp_uring_backpressure(tcp_uring_ctx_t *ur, unsigned idx)
+{
+	uring_conn_t *uc = ur->conns[idx];
+	bool blocked = tcp_uring_blocked(uc);
+	if (blocked && uc->receiving && !uc->recv_canceled) {
+		struct io_uring_sqe *sqe = uring_sqe(&ur->ring);
+		io_uring_prep_cancel64(sqe, uring_data(URING_TCP_RECV, idx), 0);
+		io_uring_sqe_set_data64(sqe, uring_data(URING_TCP_CANCEL, idx));
+		uc->recv_canceled = true;
+	} else if (!blocked && !uc->receiving) {
+		tcp_uring_arm_recv(ur, idx);
+	}
+}
+
+static uring_answer_t *tcp_uring_answer_get(tcp_uring_ctx_t *ur)
+{
+	uring_answer_t *answer = ur->answers;
+	if (answer != NULL) {
+		ur->answers = answer->next;
+		return answer;
+	}
+
+	answer = calloc(1, sizeof(*answer));
+	if (answer == NULL) {
+		return NULL;
+	}
+	mm_ctx_mempool(&answer->mm, MM_DEFAULT_BLKSIZE);
+	if (answer->mm.ctx == NULL) {
+		free(answer);
+		return NULL;
+	}
+	knot_layer_init(&answer->layer, &answer->mm, process_query_layer());
+
+	return answer;
+}
+
+static void tcp_uring_answer_put(tcp_uring_ctx_t *ur, uring_answer_t *answer)
+{
+	answer->next = ur->answers;
+	ur->answers = answer;
+}
+
+static void tcp_uring_answer_free(uring_answer_t *answer)
+{
+	mp_delete(answer->mm.ctx);
+	free(answer);
+}
+
+static void tcp_uring_close(tcp_uring_ctx_t *ur, unsigned idx)
+{
+	uring_conn_t *uc = ur->conns[idx];
+	if (!uc->closing) {
+		/* Terminate the requests in flight. */
+		uc->closing = true;
+		(void)shutdown(uc->fd, SHUT_RDWR);
+	}
+	if (uc->refs > 0) {
+		return;
+	}
+
+	if (uc->answer != NULL) {
+		handle_finish(&uc->answer->layer);
+		tcp_uring_answer_put(ur, uc->answer);
+	}
+	close(uc->fd);
+	tcp_conn_clear(&uc->conn);
+	free(uc->out.data);
+	memset(uc, 0, sizeof(*uc));
+	ur->free[ur->nfree++] = idx;
+	ur->active--;
+	tcp_uring_throttle(ur);
+}
+
+/*! \brief Returns true if the accept failed just for the connection being accepted. */
+static bool tcp_uring_accept_temporary(int res)
+{
+	return uring_res_temporary(res) || res == -ECONNABORTED || res == -EMFILE ||
+	       res == -ENFILE || res == -EPERM || res == -EPROTO;
+}
+
+/*!
+ * \brief Set up the accepted connection, re-arm the terminated accept.
+ *
+ * \return Error code if the accept failed permanently (e.g. multishot accept
+ *         not supported by the kernel), KNOT_EOK otherwise.
+ */
+static int tcp_uring_accept(tcp_uring_ctx_t *ur, struct io_uring_cqe *cqe)
+{
+	tcp_context_t *tcp = ur->tcp;
+	unsigned listen_idx = uring_data_idx(io_uring_cqe_get_data64(cqe));
+
+	if (!uring_cqe_more(cqe)) {
+		ur->accepts_armed--;
+		if (ur->accepting) {
+			if (!tcp_uring_accept_temporary(cqe->res)) {
+				return knot_map_errno_code(-cqe->res);
+			}
+			tcp_uring_arm_accept(ur, listen_idx);
+		} else {
+			tcp_uring_throttle(ur);
+		}
+	}
+	if (cqe->res < 0) {
+		return KNOT_EOK;
+	}
+	int fd = cqe->res;
+
+	/* Get a connection slot. */
+	if (ur->nfree == 0) {
+		unsigned size = MAX(2 * ur->conns_size, FDSET_RESIZE_STEP);
+		uring_conn_t **conns = realloc(ur->conns, size * sizeof(*conns));
+		if (conns != NULL) {
+			ur->conns = conns;
+		}
+		unsigned *free_slots = realloc(ur->free, size * sizeof(*free_slots));
+		if (free_slots != NULL) {
+			ur->free = free_slots;
+		}
+		if (conns == NULL || free_slots == NULL) {
+			close(fd);
+			return KNOT_EOK;
+		}
+		for (unsigned i = ur->conns_size; i < size; ++i) {
+			ur->conns[i] = NULL;
+		}
+		for (unsigned i = size; i > ur->conns_size; --i) {
+			ur->free[ur->nfree++] = i - 1;
+		}
+		ur->conns_size = size;
+	}
+	unsigned idx = ur->free[ur->nfree - 1];
+	if (ur->conns[idx] == NULL) {
+		ur->conns[idx] = calloc(1, sizeof(uring_conn_t));
+		if (ur->conns[idx] == NULL) {
+			close(fd);
+			return KNOT_EOK;
+		}
+	}
+	ur->nfree--;
+	ur->active++;
+
+	uring_conn_t *uc = ur->conns[idx];
+	uc->fd = fd;
+	uc->last_active = time_now();
+	tcp_conn_init(&uc->conn, tcp->set.ctx[listen_idx], fd, NULL);
+
+	tcp_uring_arm_recv(ur, idx);
+	tcp_uring_throttle(ur);
+
+	return KNOT_EOK;
+}
+
+/*! \brief Start answering the query, the query is copied to the answer memory. */
+static int tcp_uring_begin(tcp_uring_ctx_t *ur, uring_conn_t *uc,
+                           const knotd_qdata_params_t *params,
+                           const uint8_t *msg, size_t msg_len)
+{
+	uring_answer_t *answer = tcp_uring_answer_get(ur);
+	if (answer == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	uint8_t *query = mm_alloc(&answer->mm, msg_len);
+	if (query == NULL) {
+		tcp_uring_answer_put(ur, answer);
+		return KNOT_ENOMEM;
+	}
+	memcpy(query, msg, msg_len);
+
+	answer->params = *params;
+	struct iovec rx = { .iov_base = query, .iov_len = msg_len };
+	handle_query(&answer->params, &answer->layer, &rx, NULL);
+	uc->answer = answer;
+
+	return KNOT_EOK;
+}
+
+/*! \brief Queue the answer messages until finished or the output is full. */
+static int tcp_uring_produce(tcp_uring_ctx_t *ur, uring_conn_t *uc)
+{
+	knot_layer_t *layer = &uc->answer->layer;
+	knot_pkt_t *ans = knot_pkt_new(ur->tcp->iov[1].iov_base, KNOT_WIRE_MAX_PKTSIZE,
+	                               layer->mm);
+	while (active_state(layer->state)) {
+		if (tcp_uring_queued(uc) >= TCP_TX_MAX) {
+			return KNOT_EOK; // Suspended.
+		}
+		knot_layer_produce(layer, ans);
+		/* Queue, if response generation passed and wasn't ignored. */
+		if (ans->size > 0 && send_state(layer->state)) {
+			int ret = tcp_conn_queue(&uc->conn, ans);
+			if (ret != KNOT_EOK) {
+				return ret;
+			}
+		}
+	}
+
+	handle_finish(layer);
+	tcp_uring_answer_put(ur, uc->answer);
+	uc->answer = NULL;
+
+	return KNOT_EOK;
+}
+
+/*! \brief Answer the received messages while the output isn't full. */
+static int tcp_uring_process(tcp_uring_ctx_t *ur, unsigned idx)
+{
+	tcp_context_t *tcp = ur->tcp;
+	uring_conn_t *uc = ur->conns[idx];
+	tcp_buf_t *rx = &uc->conn.rx;
+
+	knotd_qdata_params_t params = params_init(KNOTD_QUERY_PROTO_TCP,
+	                                          &uc->conn.remote, &uc->conn.local,
+	                                          uc->fd, tcp->server, tcp->thread_id);
+	if (process_query_proto(&params, KNOTD_STAGE_PROTO_BEGIN) == KNOTD_PROTO_STATE_BLOCK) {
+		return KNOT_EDENIED;
+	}
+
+	int ret = KNOT_EOK;
+	size_t used = 0;
+	while (ret == KNOT_EOK) {
+		if (uc->answer != NULL) {
+			ret = tcp_uring_produce(ur, uc);
+			if (uc->answer != NULL) {
+				break; // Output full or failed.
+			}
+			continue;
+		}
+
+		size_t avail = rx->len - used;
+		if (avail < sizeof(uint16_t) ||
+		    avail < sizeof(uint16_t) + knot_wire_read_u16(rx->data + used)) {
+			break; // Incomplete message.
+		}
+		size_t msg_len = knot_wire_read_u16(rx->data + used);
+		if (msg_len == 0) {
+			ret = KNOT_EMALF;
+			break;
+		}
+		ret = tcp_uring_begin(ur, uc, &params, rx->data + used + sizeof(uint16_t),
+		                      msg_len);
+		used += sizeof(uint16_t) + msg_len;
+	}
+
+	/* Keep the unprocessed data. */
+	if (used > 0) {
+		memmove(rx->data, rx->data + used, rx->len - used);
+		rx->len -= used;
+	}
+
+	(void)process_query_proto(&params, KNOTD_STAGE_PROTO_END);
+
+	return ret;
+}
+
+/*!
+ * \brief Answer the received queries.
+ *
+ * \return Error code if the receive isn't supported by the kernel, KNOT_EOK
+ *         otherwise (other failures just close the connection).
+ */
+static int tcp_uring_recv(tcp_uring_ctx_t *ur, struct io_uring_cqe *cqe)
+{
+	unsigned idx = uring_data_idx(io_uring_cqe_get_data64(cqe));
+	uring_conn_t *uc = ur->conns[idx];
+
+	if (!uring_cqe_more(cqe)) {
+		uc->refs--;
+		uc->receiving = false;
+		uc->recv_canceled = false;
+	}
+	int ret = (cqe->res == -EINVAL || cqe->res == -EOPNOTSUPP) ?
+	          knot_map_errno_code(-cqe->res) : KNOT_EOK;
+
+	bool close = uc->closing;
+	uint8_t *buf = uring_cqe_buf(&ur->ring, cqe);
+	if (cqe->res > 0 && buf != NULL) {
+		if (!close) {
+			/* Answer at once unless waiting for the output to be sent. */
+			uc->last_active = time_now();
+			size_t len = cqe->res;
+			close = (tcp_buf_append(&uc->conn.rx, &buf, &len,
+			                        uc->conn.rx.len + len) != KNOT_EOK);
+			if (!close && !tcp_uring_blocked(uc)) {
+				close = (tcp_uring_process(ur, idx) != KNOT_EOK);
+			}
+		}
+	} else if (cqe->res != -ENOBUFS && cqe->res != -ECANCELED) {
+		close = true; // EOF or error.
+	}
+	uring_cqe_buf_recycle(&ur->ring, cqe);
+
+	if (close) {
+		tcp_uring_close(ur, idx);
+	} else {
+		tcp_uring_flush(ur, idx);
+		tcp_uring_backpressure(ur, idx); // Also re-arms if out of buffers.
+	}
+
+	return ret;
+}
+
+static void tcp_uring_send(tcp_uring_ctx_t *ur, struct io_uring_cqe *cqe)
+{
+	unsigned idx = uring_data_idx(io_uring_cqe_get_data64(cqe));
+	uring_conn_t *uc = ur->conns[idx];
+
+	uc->refs--;
+	uc->sending = false;
+	ur->sends--;
+
+	if (cqe->res <= 0 || uc->closing) {
+		tcp_uring_close(ur, idx);
+		return;
+	}
+
+	uc->out_sent += cqe->res;
+	if (uc->out_sent < uc->out.len) {
+		tcp_uring_arm_send(ur, idx); // Partial send.
+		return;
+	}
+	uc->out.len = 0;
+	uc->out_sent = 0;
+
+	/* Resume the answering suspended by the full output. */
+	if (uc->answer != NULL || uc->conn.rx.len > 0) {
+		if (tcp_uring_process(ur, idx) != KNOT_EOK) {
+			tcp_uring_close(ur, idx);
+			return;
+		}
+	}
+	tcp_uring_flush(ur, idx);
+	tcp_uring_backpressure(ur, idx);
+}
+
+/*! \brief Close inactive connections and those with stuck sends. */
+static void tcp_uring_sweep(tcp_uring_ctx_t *ur)
+{
+	tcp_context_t *tcp = ur->tcp;
+	struct timespec now = time_now();
+
+	for (unsigned i = 0; i < ur->conns_size; ++i) {
+		uring_conn_t *uc = ur->conns[i];
+		if (uc == NULL || uc->conn.iface == NULL || uc->closing) {
+			continue;
+		}
+		if (uc->sending) {
+			if (time_diff_ms(&uc->send_start, &now) >= tcp->io_timeout) {
+				tcp_log_error((struct sockaddr_storage *)&uc->conn.remote, "send",
+				              KNOT_ETIMEOUT, tcp->server);
+				tcp_uring_close(ur, i);
+			}
+		} else if (now.tv_sec - uc->last_active.tv_sec >= tcp->idle_timeout) {
+			ATOMIC_ADD(tcp->server->stats.tcp_idle_timeout, 1);
+			if (log_enabled_debug()) {
+				char addr_str[SOCKADDR_STRLEN];
+				sockaddr_tostr(addr_str, sizeof(addr_str),
+				               (struct sockaddr_storage *)&uc->conn.remote);
+				log_debug("TCP, terminated inactive client, address %s", addr_str);
+			}
+			tcp_uring_close(ur, i);
+		}
+	}
+}
+
+/*! \brief Cancel the requests in flight and wait for the sends using the buffers. */
+static void tcp_uring_drain(tcp_uring_ctx_t *ur)
+{
+	uring_cancel_all(&ur->ring);
+
+	struct io_uring_cqe *cqes[URING_MAX_CQES];
+	while (ur->sends > 0) {
+		int count = uring_wait(&ur->ring, cqes, 1000);
+		if (count <= 0) {
+			break;
+		}
+		for (int i = 0; i < count; ++i) {
+			uint64_t data = io_uring_cqe_get_data64(cqes[i]);
+			if (uring_data_type(data) == URING_TCP_SEND) {
+				ur->conns[uring_data_idx(data)]->sending = false;
+				ur->sends--;
+			}
+		}
+		uring_seen(&ur->ring, count);
+	}
+}
+
+static void tcp_uring_deinit(tcp_uring_ctx_t *ur)
+{
+	for (unsigned i = 0; i < ur->conns_size; ++i) {
+		uring_conn_t *uc = ur->conns[i];
+		if (uc != NULL) {
+			if (uc->conn.iface != NULL) {
+				close(uc->fd);
+			}
+			if (uc->answer != NULL) {
+				handle_finish(&uc->answer->layer);
+				tcp_uring_answer_free(uc->answer);
+			}
+			tcp_conn_clear(&uc->conn);
+			free(uc->out.data);
+			free(uc);
+		}
+	}
+	while (ur->answers != NULL) {
+		uring_answer_t *next = ur->answers->next;
+		tcp_uring_answer_free(ur->answers);
+		ur->answers = next;
+	}
+	free(ur->conns);
+	free(ur->free);
+	uring_deinit(&ur->ring);
+}
+
+/*!
+ * \brief Serve the TCP sockets using io_uring until cancelled.
+ *
+ * Connections are accepted by multishot accepts, data is received
+ * by multishot receives into the provided buffers, and answers
+ * are queued per connection and sent without blocking the worker.
+ * If the queued output of a connection is full, its answering is
+ * suspended and receiving stopped until the output is sent.
+ */
+static int tcp_uring_serve(tcp_context_t *tcp, dthread_t *thread)
+{
+	tcp_uring_ctx_t ur = { .tcp = tcp };
+	int ret = uring_init(&ur.ring, URING_TCP_ENTRIES, URING_TCP_RX_BUFS,
+	                     URING_TCP_RX_BUFSIZE);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	static const int ops[] = { IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND,
+	                           IORING_OP_ASYNC_CANCEL };
+	ret = uring_probe(&ur.ring, ops, sizeof(ops) / sizeof(*ops));
+	if (ret != KNOT_EOK) {
+		uring_deinit(&ur.ring);
+		return ret;
+	}
+
+	tcp_uring_throttle(&ur);
+
+	struct timespec next_sweep;
+	update_sweep_timer(&next_sweep);
+
+	uint64_t submits = 0;
+	struct io_uring_cqe *cqes[URING_MAX_CQES];
+	while (!dt_is_cancelled(thread)) {
+		int count = uring_wait(&ur.ring, cqes, TCP_SWEEP_INTERVAL * 1000);
+		if (count < 0) {
+			log_error("TCP, io_uring failed (%s)", knot_strerror(count));
+			ret = count;
+			break;
+		}
+
+		for (int i = 0; i < count; ++i) {
+			int err = KNOT_EOK;
+			switch (uring_data_type(io_uring_cqe_get_data64(cqes[i]))) {
+			case URING_TCP_ACCEPT:
+				err = tcp_uring_accept(&ur, cqes[i]);
+				break;
+			case URING_TCP_RECV:
+				err = tcp_uring_recv(&ur, cqes[i]);
+				break;
+			case URING_TCP_SEND:
+				tcp_uring_send(&ur, cqes[i]);
+				break;
+			case URING_TCP_CANCEL:
+				break;
+			default:
+				assert(0);
+			}
+			if (ret == KNOT_EOK) {
+				ret = err;
+			}
+		}
+		uring_seen(&ur.ring, count);
+
+		if (ret != KNOT_EOK) {
+			log_error("TCP, io_uring request failed (%s)", knot_strerror(ret));
+			break;
+		}
+
+		ATOMIC_ADD(tcp->server->stats.io_uring_submits, ur.ring.submits - submits);
+		submits = ur.ring.submits;
+
+		/* Sweep inactive clients and refresh TCP configuration. */
+		tcp->last_poll_time = time_now();
+		if (tcp->last_poll_time.tv_sec >= next_sweep.tv_sec) {
+			tcp_uring_sweep(&ur);
+			update_sweep_timer(&next_sweep);
+			update_tcp_conf(tcp);
+			tcp_uring_throttle(&ur);
+		}
+	}
+
+	tcp_uring_drain(&ur);
+	tcp_uring_deinit(&ur);
+
+	return ret;
+}
+#endif // ENABLE_IO_URING
+
 int tcp_master(dthread_t *thread)
 {
 	if (thread == NULL || thread->data == NULL) {
@@ -420,6 +1341,19 @@ int tcp_master(dthread_t *thread)
 	update_sweep_timer(&next_sweep);
 	update_tcp_conf(&tcp);
 
+#ifdef ENABLE_IO_URING
+	/* Use io_uring if configured, fall back to polling if not operational. */
+	if (conf()->cache.srv_io_uring && !tls) {
+		ret = tcp_uring_serve(&tcp, thread);
+		if (ret == KNOT_EOK) {
+			goto finish;
+		}
+		log_warning("TCP, io_uring not operational, using polling (%s)",
+		            knot_strerror(ret));
+		ret = KNOT_EOK;
+	}
+#endif // ENABLE_IO_URING
+
 	/* Initialize TLS context. */
 	if (tls) {
 		// Set the HS timeout to 8x the RMT IO one as the HS duration can be up to 4*roundtrip.
@@ -455,8 +1389,10 @@ finish:
 	free(tcp.iov[1].iov_base);
 	mp_delete(mm.ctx);
 
-	for (int i = 0; i < tcp.set.n; i++) {
+	/* Listening sockets (all of them if failed to set) have no connection state. */
+	for (int i = tcp.client_threshold; tcp.client_threshold > 0 && i < tcp.set.n; i++) {
 		free_tls_ctx(&tcp.set, i);
+		tcp_conn_free(tcp.set.ctx[i]);
 	}
 	fdset_clear(&tcp.set);
 
@@ -27,6 +27,9 @@
 #include "contrib/ucw/mempool.h"
 #include "knot/common/fdset.h"
 #include "knot/common/log.h"
+#ifdef ENABLE_IO_URING
+#include "knot/common/uring.h"
+#endif // ENABLE_IO_URING
 #include "knot/nameserver/process_query.h"
 #include "knot/query/layer.h"
 #include "knot/server/handler.h"
@@ -51,6 +54,8 @@ typedef struct {
 	server_t *server;   /*!< Name server structure. */
 	unsigned thread_id; /*!< Thread identifier. */
 	sockaddr_t local;   /*!< Storage for local any address for currently processed query. */
+	size_t bufsize;     /*!< Size of one reply buffer. */
+	bool segmentation;  /*!< Use UDP GRO and GSO if available. */
 
 #ifdef ENABLE_QUIC
 	knot_quic_table_t *quic_table;  /*!< QUIC connection table if active. */
@@ -156,6 +161,9 @@ void cmsg_handle(const struct msghdr *rx, struct msghdr *tx,
 			cmsg = CMSG_NXTHDR(tx, cmsg);
 		}
 	} else {
+		if (cmsg != NULL && cmsg->cmsg_level == IPPROTO_UDP) {
+			cmsg = CMSG_NXTHDR(tx, cmsg); // Skip UDP_GRO segment size.
+		}
 		if (cmsg != NULL) {
 			cmsg_handle_pktinfo(local, iface, cmsg);
 		}
@@ -278,27 +286,78 @@ static udp_api_t udp_msg_api = {
 };
 
 #ifdef ENABLE_RECVMMSG
+/*! \brief Update a UDP counter of the thread (no other thread writes it). */
+#define UDP_STATS_ADD(ctr, val) ATOMIC_SET(ctr, ATOMIC_GET(ctr) + (val))
+
+#ifdef ENABLE_UDP_SEGMENTATION
+#define UDP_GSO_MAXSEGS	64    /*!< Maximum number of segments in one send. */
+#define UDP_GSO_MAXSIZE	65000 /*!< Maximum total payload of one send. */
+
+/*! \brief Control message buffer for a send with the GSO segment size. */
+typedef union {
+	struct cmsghdr cmsg;
+	uint8_t buf[sizeof(cmsg_buf_t) + CMSG_SPACE(sizeof(uint16_t))];
+} cmsg_gso_buf_t;
+#endif // ENABLE_UDP_SEGMENTATION
+
 typedef struct {
 	int fd;
 	unsigned rcvd;
+	size_t rx_bufsize;
+	size_t tx_bufsize;
+	server_udp_stats_t *stats;
 	struct mmsghdr msgs[NBUFS][RECVMMSG_BATCHLEN];
 	struct iovec iov[NBUFS][RECVMMSG_BATCHLEN];
-	uint8_t iobuf[NBUFS][RECVMMSG_BATCHLEN][KNOT_WIRE_MAX_PKTSIZE];
+	uint8_t *iobuf[NBUFS];
 	sockaddr_t addrs[RECVMMSG_BATCHLEN];
 	cmsg_buf_t cmsgs[RECVMMSG_BATCHLEN];
+#ifdef ENABLE_UDP_SEGMENTATION
+	unsigned gso_maxsegs; /*!< Zero if segmentation is disabled. */
+	struct mmsghdr gso_msgs[RECVMMSG_BATCHLEN];
+	cmsg_gso_buf_t gso_cmsgs[RECVMMSG_BATCHLEN];
+#endif // ENABLE_UDP_SEGMENTATION
 } udp_mmsg_ctx_t;
 
-static void *udp_mmsg_init(_unused_ udp_context_t *ctx, _unused_ void *xdp_sock)
+static void udp_mmsg_deinit(void *d)
+{
+	udp_mmsg_ctx_t *rq = d;
+
+	if (rq != NULL) {
+		free(rq->iobuf[RX]);
+		free(rq->iobuf[TX]);
+		free(rq);
+	}
+}
+
+static void *udp_mmsg_init(udp_context_t *ctx, _unused_ void *xdp_sock)
 {
 	udp_mmsg_ctx_t *rq = calloc(1, sizeof(*rq));
 	if (rq == NULL) {
 		return NULL;
 	}
 
+	rq->stats = &ctx->server->stats.udp[ctx->thread_id];
+	/* Queries (e.g. UPDATE) may exceed the maximum UDP payload of replies. */
+	rq->rx_bufsize = KNOT_WIRE_MAX_PKTSIZE;
+	rq->tx_bufsize = ctx->bufsize;
+#ifdef ENABLE_UDP_SEGMENTATION
+	if (ctx->segmentation) {
+		rq->gso_maxsegs = UDP_GSO_MAXSEGS;
+	}
+#endif // ENABLE_UDP_SEGMENTATION
+
+	rq->iobuf[RX] = malloc(RECVMMSG_BATCHLEN * rq->rx_bufsize);
+	rq->iobuf[TX] = malloc(RECVMMSG_BATCHLEN * rq->tx_bufsize);
+	if (rq->iobuf[RX] == NULL || rq->iobuf[TX] == NULL) {
+		udp_mmsg_deinit(rq);
+		return NULL;
+	}
+
+	const size_t bufsize[NBUFS] = { rq->rx_bufsize, rq->tx_bufsize };
 	for (unsigned i = 0; i < NBUFS; ++i) {
 		for (unsigned k = 0; k < RECVMMSG_BATCHLEN; ++k) {
-			rq->iov[i][k].iov_base = rq->iobuf[i][k];
-			rq->iov[i][k].iov_len = sizeof(rq->iobuf[i][k]);
+			rq->iov[i][k].iov_base = rq->iobuf[i] + k * bufsize[i];
+			rq->iov[i][k].iov_len = bufsize[i];
 			rq->msgs[i][k].msg_hdr.msg_iov = &rq->iov[i][k];
 			rq->msgs[i][k].msg_hdr.msg_iovlen = 1;
 			rq->msgs[i][k].msg_hdr.msg_name = &rq->addrs[k];
@@ -311,13 +370,6 @@ static void *udp_mmsg_init(_unused_ udp_context_t *ctx, _unused_ void *xdp_sock)
 	return rq;
 }
 
-static void udp_mmsg_deinit(void *d)
-{
-	udp_mmsg_ctx_t *rq = d;
-
-	free(rq);
-}
-
 static int udp_mmsg_recv(int fd, void *d)
 {
 	udp_mmsg_ctx_t *rq = d;
@@ -326,10 +378,204 @@ static int udp_mmsg_recv(int fd, void *d)
 	if (n > 0) {
 		rq->fd = fd;
 		rq->rcvd = n;
+
+		UDP_STATS_ADD(rq->stats->recv_batches, 1);
+		UDP_STATS_ADD(rq->stats->recv_msgs, n);
+		if (n == RECVMMSG_BATCHLEN) {
+			UDP_STATS_ADD(rq->stats->recv_full_batches, 1);
+		}
 	}
 	return n;
 }
 
+#ifdef ENABLE_UDP_SEGMENTATION
+/*! \brief Get the size of datagrams coalesced by UDP GRO, zero if not coalesced. */
+static size_t udp_gro_segment_size(struct msghdr *rx)
+{
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(rx); cmsg != NULL;
+	     cmsg = CMSG_NXTHDR(rx, cmsg)) {
+		if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+			int size;
+			memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+			return (size > 0) ? size : 0;
+		}
+	}
+
+	return 0;
+}
+
+static bool udp_gso_same_dest(const struct msghdr *a, const struct msghdr *b)
+{
+	return a->msg_namelen == b->msg_namelen &&
+	       a->msg_controllen == b->msg_controllen &&
+	       (a->msg_name == b->msg_name ||
+	        memcmp(a->msg_name, b->msg_name, a->msg_namelen) == 0) &&
+	       (a->msg_control == b->msg_control ||
+	        memcmp(a->msg_control, b->msg_control, a->msg_controllen) == 0);
+}
+
+/*!
+ * \brief Copy the reply control messages except for the UDP level ones
+ *        (e.g. received UDP_GRO) and optionally append UDP_SEGMENT.
+ */
+static void udp_gso_cmsg(const struct msghdr *tx, struct msghdr *out,
+                         cmsg_gso_buf_t *buf, uint16_t seg_size)
+{
+	out->msg_control = buf->buf;
+	out->msg_controllen = sizeof(buf->buf);
+
+	size_t len = 0;
+	struct cmsghdr *dst = CMSG_FIRSTHDR(out);
+	if (tx->msg_controllen > 0) {
+		for (struct cmsghdr *src = CMSG_FIRSTHDR(tx); src != NULL && dst != NULL;
+		     src = CMSG_NXTHDR((struct msghdr *)tx, src)) {
+			if (src->cmsg_level == IPPROTO_UDP) {
+				continue;
+			}
+			memcpy(dst, src, src->cmsg_len);
+			len += CMSG_ALIGN(src->cmsg_len);
+			dst = CMSG_NXTHDR(out, dst);
+		}
+	}
+
+	if (seg_size > 0 && dst != NULL) {
+		dst->cmsg_level = IPPROTO_UDP;
+		dst->cmsg_type = UDP_SEGMENT;
+		dst->cmsg_len = CMSG_LEN(sizeof(seg_size));
+		memcpy(CMSG_DATA(dst), &seg_size, sizeof(seg_size));
+		len += CMSG_SPACE(sizeof(seg_size));
+	}
+
+	out->msg_controllen = len;
+	if (len == 0) {
+		// BSD has problem with zero length and not-null pointer
+		out->msg_control = NULL;
+	}
+}
+
+/*!
+ * \brief Merge runs of replies to the same destination into GSO sends.
+ *
+ * All segments of one send must have the same size except for the last one,
+ * which can be shorter. The reply iovecs are adjacent so a run is sent
+ * as one message with multiple iovecs.
+ */
+static unsigned udp_gso_coalesce(udp_mmsg_ctx_t *rq, unsigned count)
+{
+	unsigned n = 0;
+	for (unsigned i = 0; i < count; n++) {
+		struct msghdr *first = &rq->msgs[TX][i].msg_hdr;
+		size_t seg_size = first->msg_iov->iov_len;
+		size_t total = seg_size;
+		unsigned run = 1;
+		while (i + run < count && run < rq->gso_maxsegs) {
+			struct msghdr *next = &rq->msgs[TX][i + run].msg_hdr;
+			size_t len = next->msg_iov->iov_len;
+			if (len > seg_size || total + len > UDP_GSO_MAXSIZE ||
+			    !udp_gso_same_dest(first, next)) {
+				break;
+			}
+			total += len;
+			run++;
+			if (len < seg_size) {
+				break;
+			}
+		}
+
+		struct msghdr *out = &rq->gso_msgs[n].msg_hdr;
+		out->msg_name = first->msg_name;
+		out->msg_namelen = first->msg_namelen;
+		out->msg_iov = first->msg_iov;
+		out->msg_iovlen = run;
+		out->msg_flags = 0;
+		udp_gso_cmsg(first, out, &rq->gso_cmsgs[n], (run > 1) ? seg_size : 0);
+
+		if (run > 1) {
+			UDP_STATS_ADD(rq->stats->gso_sends, 1);
+			UDP_STATS_ADD(rq->stats->gso_segments, run);
+		}
+		i += run;
+	}
+
+	return n;
+}
+#endif // ENABLE_UDP_SEGMENTATION
+
+/*! \brief Send the first 'count' prepared replies and reset their buffers. */
+static void udp_mmsg_flush(udp_mmsg_ctx_t *rq, unsigned count)
+{
+	if (count == 0) {
+		return;
+	}
+
+	int ret;
+#ifdef ENABLE_UDP_SEGMENTATION
+	if (rq->gso_maxsegs > 0) {
+		unsigned n = udp_gso_coalesce(rq, count);
+		ret = sendmmsg(rq->fd, rq->gso_msgs, n, 0);
+		if (ret == -1 && errno == EIO && rq->gso_maxsegs > 1) {
+			/* Segmentation offload not supported by the device. */
+			log_debug("UDP, segmentation offload failed, disabling");
+			rq->gso_maxsegs = 1;
+			n = udp_gso_coalesce(rq, count);
+			ret = sendmmsg(rq->fd, rq->gso_msgs, n, 0);
+		}
+	} else
+#endif // ENABLE_UDP_SEGMENTATION
+	ret = sendmmsg(rq->fd, rq->msgs[TX], count, 0);
+	if (ret == -1 && log_enabled_debug()) {
+		log_debug("UDP, failed to send some packets (%s)", strerror(errno));
+	}
+
+	for (unsigned i = 0; i < count; ++i) {
+		struct msghdr *tx = &rq->msgs[TX][i].msg_hdr;
+
+		/* Reset output context. */
+		tx->msg_iov->iov_len = rq->tx_bufsize;
+	}
+}
+
+/*! \brief Handle one query, return true if a reply was prepared in TX slot 'j'. */
+static bool udp_mmsg_handle_one(udp_context_t *ctx, const iface_t *iface,
+                                udp_mmsg_ctx_t *rq, unsigned i, unsigned j,
+                                struct iovec *query)
+{
+	struct msghdr *rx = &rq->msgs[RX][i].msg_hdr;
+	struct msghdr *tx = &rq->msgs[TX][j].msg_hdr;
+
+	/* Update mapping of address buffer. */
+	tx->msg_name = rx->msg_name;
+	tx->msg_namelen = rx->msg_namelen;
+
+	/* Update output message control buffer. */
+	int *p_ecn;
+	cmsg_handle(rx, tx, &ctx->local, &p_ecn, iface);
+	const sockaddr_t *local = local_addr(&ctx->local, iface);
+
+	knotd_qdata_params_t params = params_init(
+		iface->tls ? KNOTD_QUERY_PROTO_QUIC : KNOTD_QUERY_PROTO_UDP,
+		&rq->addrs[i], local, rq->fd, ctx->server, ctx->thread_id);
+	if (iface->tls) {
+#ifdef ENABLE_QUIC
+		quic_handler(&params, &ctx->layer, ctx->quic_idle_close,
+		             ctx->quic_table, query, tx, p_ecn);
+#else
+		assert(0);
+#endif // ENABLE_QUIC
+	} else {
+		udp_handler(ctx, &params, query, tx->msg_iov);
+	}
+
+	if (tx->msg_iov->iov_len > 0) {
+		rq->msgs[TX][j].msg_len = tx->msg_iov->iov_len;
+		return true;
+	} else {
+		/* Reset tainted output context. */
+		tx->msg_iov->iov_len = rq->tx_bufsize;
+		return false;
+	}
+}
+
 static void udp_mmsg_handle(udp_context_t *ctx, const iface_t *iface, void *d)
 {
 	udp_mmsg_ctx_t *rq = d;
@@ -338,43 +584,36 @@ static void udp_mmsg_handle(udp_context_t *ctx, const iface_t *iface, void *d)
 	unsigned j = 0;
 	for (unsigned i = 0; i < rq->rcvd; ++i) {
 		struct msghdr *rx = &rq->msgs[RX][i].msg_hdr;
-		struct msghdr *tx = &rq->msgs[TX][j].msg_hdr;
 
 		/* Set received bytes. */
 		rx->msg_iov->iov_len = rq->msgs[RX][i].msg_len;
-		/* Update mapping of address buffer. */
-		tx->msg_name = rx->msg_name;
-		tx->msg_namelen = rx->msg_namelen;
-
-		/* Update output message control buffer. */
-		int *p_ecn;
-		cmsg_handle(rx, tx, &ctx->local, &p_ecn, iface);
-		const sockaddr_t *local = local_addr(&ctx->local, iface);
-
-		knotd_qdata_params_t params = params_init(
-			iface->tls ? KNOTD_QUERY_PROTO_QUIC : KNOTD_QUERY_PROTO_UDP,
-			&rq->addrs[i], local, rq->fd, ctx->server, ctx->thread_id);
-		if (iface->tls) {
-#ifdef ENABLE_QUIC
-			quic_handler(&params, &ctx->layer, ctx->quic_idle_close,
-			             ctx->quic_table, rx->msg_iov, tx, p_ecn);
-#else
-		assert(0);
-#endif // ENABLE_QUIC
-		} else {
-			udp_handler(ctx, &params, rx->msg_iov, tx->msg_iov);
-		}
 
-		if (tx->msg_iov->iov_len > 0) {
-			rq->msgs[TX][j].msg_len = tx->msg_iov->iov_len;
-			j++;
-		} else {
-			/* Reset tainted output context. */
-			tx->msg_iov->iov_len = sizeof(rq->iobuf[TX][i]);
+#ifdef ENABLE_UDP_SEGMENTATION
+		/* Split datagrams coalesced by UDP GRO. */
+		size_t seg_size = udp_gro_segment_size(rx);
+		if (seg_size > 0 && seg_size < rx->msg_iov->iov_len) {
+			uint8_t *data = rx->msg_iov->iov_base;
+			size_t len = rx->msg_iov->iov_len;
+			for (size_t off = 0; off < len; off += seg_size) {
+				if (j == RECVMMSG_BATCHLEN) {
+					udp_mmsg_flush(rq, j);
+					j = 0;
+				}
+				struct iovec query = {
+					.iov_base = data + off,
+					.iov_len = MIN(seg_size, len - off)
+				};
+				j += udp_mmsg_handle_one(ctx, iface, rq, i, j, &query);
+				UDP_STATS_ADD(rq->stats->gro_segments, 1);
+			}
+		} else
+#endif // ENABLE_UDP_SEGMENTATION
+		{
+			j += udp_mmsg_handle_one(ctx, iface, rq, i, j, rx->msg_iov);
 		}
 
 		/* Reset input context. */
-		rx->msg_iov->iov_len = sizeof(rq->iobuf[RX][i]);
+		rx->msg_iov->iov_len = rq->rx_bufsize;
 		rx->msg_namelen = sizeof(rq->addrs[i]);
 		rx->msg_controllen = sizeof(rq->cmsgs[i]);
 	}
@@ -385,16 +624,7 @@ static void udp_mmsg_send(void *d)
 {
 	udp_mmsg_ctx_t *rq = d;
 
-	int ret = sendmmsg(rq->fd, rq->msgs[TX], rq->rcvd, 0);
-	if (ret == -1 && log_enabled_debug()) {
-		log_debug("UDP, failed to send some packets (%s)", strerror(errno));
-	}
-	for (unsigned i = 0; i < rq->rcvd; ++i) {
-		struct msghdr *tx = &rq->msgs[TX][i].msg_hdr;
-
-		/* Reset output context. */
-		tx->msg_iov->iov_len = sizeof(rq->iobuf[TX][i]);
-	}
+	udp_mmsg_flush(rq, rq->rcvd);
 }
 
 static udp_api_t udp_mmsg_api = {
@@ -405,6 +635,323 @@ static udp_api_t udp_mmsg_api = {
 	udp_mmsg_send,
 	udp_sweep,
 };
+
+#ifdef ENABLE_IO_URING
+#define URING_UDP_ENTRIES	256 /*!< Submission queue size. */
+#define URING_UDP_RX_BUFS	64  /*!< Number of provided receive buffers (of maximum size). */
+#define URING_UDP_TX_SLOTS	512 /*!< Maximum number of replies in flight. */
+
+/* Completion types. */
+enum {
+	URING_UDP_RECV = 1,
+	URING_UDP_SEND = 2,
+};
+
+/*! \brief Reply being sent. */
+typedef struct {
+	struct msghdr msg;
+	struct iovec iov;
+	sockaddr_t addr;
+	cmsg_buf_t cmsgs;
+} uring_tx_t;
+
+typedef struct {
+	uring_t ring;
+	struct msghdr rx_hdr;     /*!< Receive template with the name and control sizes. */
+	size_t tx_bufsize;
+	uint8_t *tx_bufs;
+	uring_tx_t *tx;           /*!< Reply slots, the last one is for synchronous sends. */
+	unsigned *tx_free;        /*!< Stack of free reply slots. */
+	unsigned tx_nfree;
+	server_udp_stats_t *stats;
+} udp_uring_ctx_t;
+
+static void udp_uring_deinit(udp_uring_ctx_t *ur)
+{
+	uring_deinit(&ur->ring);
+	free(ur->tx_bufs);
+	free(ur->tx);
+	free(ur->tx_free);
+}
+
+static int udp_uring_init(udp_uring_ctx_t *ur, udp_context_t *ctx)
+{
+	memset(ur, 0, sizeof(*ur));
+	ur->stats = &ctx->server->stats.udp[ctx->thread_id];
+	ur->tx_bufsize = ctx->bufsize;
+
+	/* Each receive buffer holds the header, address, control data, and payload. */
+	ur->rx_hdr.msg_namelen = sizeof(sockaddr_t);
+	ur->rx_hdr.msg_controllen = sizeof(cmsg_buf_t);
+	size_t rx_bufsize = sizeof(struct io_uring_recvmsg_out) + sizeof(sockaddr_t) +
+	                    sizeof(cmsg_buf_t) + KNOT_WIRE_MAX_PKTSIZE;
+
+	int ret = uring_init(&ur->ring, URING_UDP_ENTRIES, URING_UDP_RX_BUFS, rx_bufsize);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	static const int ops[] = { IORING_OP_RECVMSG, IORING_OP_SENDMSG, IORING_OP_ASYNC_CANCEL };
+	ret = uring_probe(&ur->ring, ops, sizeof(ops) / sizeof(*ops));
+	if (ret != KNOT_EOK) {
+		uring_deinit(&ur->ring);
+		return ret;
+	}
+
+	ur->tx_bufs = malloc((URING_UDP_TX_SLOTS + 1) * ur->tx_bufsize);
+	ur->tx = calloc(URING_UDP_TX_SLOTS + 1, sizeof(*ur->tx));
+	ur->tx_free = malloc(URING_UDP_TX_SLOTS * sizeof(*ur->tx_free));
+	if (ur->tx_bufs == NULL || ur->tx == NULL || ur->tx_free == NULL) {
+		udp_uring_deinit(ur);
+		return KNOT_ENOMEM;
+	}
+
+	for (unsigned i = 0; i <= URING_UDP_TX_SLOTS; ++i) {
+		uring_tx_t *tx = &ur->tx[i];
+		tx->iov.iov_base = ur->tx_bufs + i * ur->tx_bufsize;
+		tx->msg.msg_iov = &tx->iov;
+		tx->msg.msg_iovlen = 1;
+		tx->msg.msg_name = &tx->addr;
+	}
+	for (unsigned i = 0; i < URING_UDP_TX_SLOTS; ++i) {
+		ur->tx_free[ur->tx_nfree++] = URING_UDP_TX_SLOTS - 1 - i;
+	}
+
+	return KNOT_EOK;
+}
+
+/*! \brief Arm the multishot receive on the socket 'idx' of the set. */
+static void udp_uring_arm(udp_uring_ctx_t *ur, fdset_t *fds, unsigned idx)
+{
+	struct io_uring_sqe *sqe = uring_sqe(&ur->ring);
+	io_uring_prep_recvmsg_multishot(sqe, fdset_get_fd(fds, idx), &ur->rx_hdr, 0);
+	sqe->flags |= IOSQE_BUFFER_SELECT;
+	sqe->buf_group = URING_BGID;
+	io_uring_sqe_set_data64(sqe, uring_data(URING_UDP_RECV, idx));
+}
+
+/*! \brief Copy the reply control messages to the slot, drop the UDP level ones. */
+static void udp_uring_cmsg(uring_tx_t *tx)
+{
+	struct msghdr *msg = &tx->msg;
+	if (msg->msg_controllen == 0) {
+		return;
+	}
+
+	size_t len = 0;
+	for (struct cmsghdr *src = CMSG_FIRSTHDR(msg); src != NULL;
+	     src = CMSG_NXTHDR(msg, src)) {
+		if (src->cmsg_level == IPPROTO_UDP ||
+		    len + CMSG_ALIGN(src->cmsg_len) > sizeof(tx->cmsgs)) {
+			continue;
+		}
+		memcpy(tx->cmsgs.buf + len, src, src->cmsg_len);
+		len += CMSG_ALIGN(src->cmsg_len);
+	}
+
+	msg->msg_control = (len > 0) ? tx->cmsgs.buf : NULL;
+	msg->msg_controllen = len;
+}
+
+static void udp_uring_handle_one(udp_context_t *ctx, udp_uring_ctx_t *ur,
+                                 const iface_t *iface, int fd,
+                                 struct msghdr *rx, struct iovec *query)
+{
+	/* Use the spare slot for a synchronous send if all slots are in flight. */
+	bool sync = (ur->tx_nfree == 0);
+	unsigned slot = sync ? URING_UDP_TX_SLOTS : ur->tx_free[--ur->tx_nfree];
+	uring_tx_t *tx = &ur->tx[slot];
+
+	/* The receive buffer is recycled before the send completes. */
+	memcpy(&tx->addr, rx->msg_name, MIN(rx->msg_namelen, sizeof(tx->addr)));
+	tx->msg.msg_namelen = rx->msg_namelen;
+	tx->iov.iov_len = ur->tx_bufsize;
+
+	int *p_ecn;
+	cmsg_handle(rx, &tx->msg, &ctx->local, &p_ecn, iface);
+	udp_uring_cmsg(tx);
+	const sockaddr_t *local = local_addr(&ctx->local, iface);
+
+	knotd_qdata_params_t params = params_init(KNOTD_QUERY_PROTO_UDP, &tx->addr,
+	                                          local, fd, ctx->server, ctx->thread_id);
+	udp_handler(ctx, &params, query, &tx->iov);
+
+	if (tx->iov.iov_len == 0) {
+		if (!sync) {
+			ur->tx_free[ur->tx_nfree++] = slot;
+		}
+	} else if (sync) {
+		if (sendmsg(fd, &tx->msg, 0) == -1 && log_enabled_debug()) {
+			log_debug("UDP, failed to send a packet (%s)", strerror(errno));
+		}
+	} else {
+		struct io_uring_sqe *sqe = uring_sqe(&ur->ring);
+		io_uring_prep_sendmsg(sqe, fd, &tx->msg, 0);
+		io_uring_sqe_set_data64(sqe, uring_data(URING_UDP_SEND, slot));
+	}
+}
+
+/*!
+ * \brief Handle the received queries, re-arm the terminated receive.
+ *
+ * \return Error code if the receive failed permanently (e.g. multishot receive
+ *         not supported by the kernel), KNOT_EOK otherwise.
+ */
+static int udp_uring_recv(udp_context_t *ctx, udp_uring_ctx_t *ur, fdset_t *fds,
+                          struct io_uring_cqe *cqe)
+{
+	unsigned idx = uring_data_idx(io_uring_cqe_get_data64(cqe));
+	const iface_t *iface = fds->ctx[idx];
+	int fd = fdset_get_fd(fds, idx);
+
+	uint8_t *buf = uring_cqe_buf(&ur->ring, cqe);
+	struct io_uring_recvmsg_out *out = NULL;
+	if (cqe->res >= 0 && buf != NULL) {
+		out = io_uring_recvmsg_validate(buf, cqe->res, &ur->rx_hdr);
+	} else if (cqe->res != -ENOBUFS && log_enabled_debug()) {
+		log_debug("UDP, failed to receive a packet (%s)", strerror(-cqe->res));
+	}
+
+	if (out != NULL) {
+		uint8_t *name = io_uring_recvmsg_name(out);
+		struct msghdr rx = {
+			.msg_name = name,
+			.msg_namelen = MIN(out->namelen, ur->rx_hdr.msg_namelen),
+			.msg_control = name + ur->rx_hdr.msg_namelen,
+			.msg_controllen = out->controllen,
+		};
+		uint8_t *data = io_uring_recvmsg_payload(out, &ur->rx_hdr);
+		size_t len = io_uring_recvmsg_payload_length(out, cqe->res, &ur->rx_hdr);
+		UDP_STATS_ADD(ur->stats->recv_msgs, 1);
+
+		size_t seg_size = len;
+#ifdef ENABLE_UDP_SEGMENTATION
+		/* Split datagrams coalesced by UDP GRO. */
+		size_t gro_size = udp_gro_segment_size(&rx);
+		if (gro_size > 0 && gro_size < len) {
+			seg_size = gro_size;
+		}
+#endif // ENABLE_UDP_SEGMENTATION
+		for (size_t off = 0; off < len; off += seg_size) {
+			struct iovec query = {
+				.iov_base = data + off,
+				.iov_len = MIN(seg_size, len - off)
+			};
+			udp_uring_handle_one(ctx, ur, iface, fd, &rx, &query);
+			if (seg_size < len) {
+				UDP_STATS_ADD(ur->stats->gro_segments, 1);
+			}
+		}
+	}
+
+	uring_cqe_buf_recycle(&ur->ring, cqe);
+
+	/* Re-arm the receive if terminated for a temporary reason (e.g. out of buffers). */
+	if (!uring_cqe_more(cqe)) {
+		if (!uring_res_temporary(cqe->res)) {
+			return knot_map_errno_code(-cqe->res);
+		}
+		udp_uring_arm(ur, fds, idx);
+	}
+
+	return KNOT_EOK;
+}
+
+static void udp_uring_sent(udp_uring_ctx_t *ur, struct io_uring_cqe *cqe)
+{
+	if (cqe->res < 0 && log_enabled_debug()) {
+		log_debug("UDP, failed to send a packet (%s)", strerror(-cqe->res));
+	}
+	ur->tx_free[ur->tx_nfree++] = uring_data_idx(io_uring_cqe_get_data64(cqe));
+}
+
+/*! \brief Cancel the receives and wait for the replies in flight. */
+static void udp_uring_drain(udp_uring_ctx_t *ur)
+{
+	uring_cancel_all(&ur->ring);
+
+	struct io_uring_cqe *cqes[URING_MAX_CQES];
+	while (ur->tx_nfree < URING_UDP_TX_SLOTS) {
+		int count = uring_wait(&ur->ring, cqes, 1000);
+		if (count <= 0) {
+			break;
+		}
+		for (int i = 0; i < count; ++i) {
+			struct io_uring_cqe *cqe = cqes[i];
+			if (uring_data_type(io_uring_cqe_get_data64(cqe)) == URING_UDP_SEND) {
+				udp_uring_sent(ur, cqe);
+			}
+		}
+		uring_seen(&ur->ring, count);
+	}
+}
+
+/*!
+ * \brief Serve the sockets using io_uring until cancelled.
+ *
+ * Queries are received by multishot receives into the provided buffers,
+ * replies are submitted in a batch together with waiting for the next queries.
+ */
+static int udp_uring_serve(udp_context_t *ctx, fdset_t *fds, dthread_t *thread)
+{
+	udp_uring_ctx_t ur;
+	int ret = udp_uring_init(&ur, ctx);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	for (unsigned i = 0; i < fdset_get_length(fds); ++i) {
+		udp_uring_arm(&ur, fds, i);
+	}
+
+	uint64_t submits = 0;
+	struct io_uring_cqe *cqes[URING_MAX_CQES];
+	while (!dt_is_cancelled(thread)) {
+		int count = uring_wait(&ur.ring, cqes, 1000);
+		if (count < 0) {
+			log_error("UDP, io_uring failed (%s)", knot_strerror(count));
+			ret = count;
+			break;
+		}
+
+		bool received = false;
+		for (int i = 0; i < count; ++i) {
+			struct io_uring_cqe *cqe = cqes[i];
+			uint64_t data = io_uring_cqe_get_data64(cqe);
+			switch (uring_data_type(data)) {
+			case URING_UDP_RECV:
+				if (ret == KNOT_EOK) {
+					ret = udp_uring_recv(ctx, &ur, fds, cqe);
+				}
+				received = true;
+				break;
+			case URING_UDP_SEND:
+				udp_uring_sent(&ur, cqe);
+				break;
+			default:
+				assert(0);
+			}
+		}
+		uring_seen(&ur.ring, count);
+
+		if (received) {
+			UDP_STATS_ADD(ur.stats->recv_batches, 1);
+		}
+		ATOMIC_ADD(ctx->server->stats.io_uring_submits, ur.ring.submits - submits);
+		submits = ur.ring.submits;
+
+		if (ret != KNOT_EOK) {
+			log_error("UDP, io_uring receive failed (%s)", knot_strerror(ret));
+			break;
+		}
+	}
+
+	udp_uring_drain(&ur);
+	udp_uring_deinit(&ur);
+
+	return ret;
+}
+#endif // ENABLE_IO_URING
 #endif /* ENABLE_RECVMMSG */
 
 #ifdef ENABLE_XDP
@@ -596,6 +1143,27 @@ int udp_master(dthread_t *thread)
 	}
 #endif // ENABLE_QUIC
 
+	/* Size the reply buffers to the largest possible reply, QUIC needs full size. */
+	if (quic) {
+		udp.bufsize = KNOT_WIRE_MAX_PKTSIZE;
+	} else {
+		udp.bufsize = MAX(conf()->cache.srv_udp_max_payload_ipv4,
+		                  conf()->cache.srv_udp_max_payload_ipv6);
+	}
+	udp.segmentation = conf()->cache.srv_udp_segmentation;
+
+#if defined(ENABLE_RECVMMSG) && defined(ENABLE_IO_URING)
+	/* Use io_uring if configured, fall back to polling if not operational. */
+	if (conf()->cache.srv_io_uring && !quic && xdp_socket == NULL) {
+		int ret = udp_uring_serve(&udp, &fds, thread);
+		if (ret == KNOT_EOK) {
+			goto finish;
+		}
+		log_warning("UDP, io_uring not operational, using polling (%s)",
+		            knot_strerror(ret));
+	}
+#endif
+
 	/* Initialize the networking API. */
 	api_ctx = api->udp_init(&udp, xdp_socket);
 	if (api_ctx == NULL) {
@@ -13,10 +13,16 @@
 
 #pragma once
 
+#include <netinet/udp.h>
+
 #include "knot/server/dthreads.h"
 
 #define RECVMMSG_BATCHLEN 10 /*!< Default recvmmsg() batch size. */
 
+#if defined(UDP_GRO) && defined(UDP_SEGMENT)
+#define ENABLE_UDP_SEGMENTATION /*!< UDP GRO and GSO are available. */
+#endif
+
 /*!
  * \brief UDP handler thread runnable.
  *
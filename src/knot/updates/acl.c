@@ -3,9 +3,17 @@
  *  For more information, see <https://www.knot-dns.cz/>
  */
 
+#include <pthread.h>
+#include <sys/un.h>
+
 #include "knot/updates/acl.h"
 
+#include "contrib/macros.h"
+#include "contrib/mempattern.h"
+#include "contrib/qp-trie/trie.h"
+#include "contrib/sockaddr.h"
 #include "contrib/string.h"
+#include "contrib/ucw/mempool.h"
 #include "contrib/wire_ctx.h"
 
 static bool cert_pin_check(const uint8_t *session_pin, size_t session_pin_size,
@@ -49,18 +57,31 @@ static bool cert_check(struct gnutls_session_int *tls_session, conf_val_t *hostn
 	return knot_tls_cert_check_hostnames(tls_session, hostnames) == KNOT_EOK;
 }
 
-static bool match_type(uint16_t type, conf_val_t *types)
+typedef struct {
+	const uint8_t *data;
+	size_t len;
+} acl_bin_t;
+
+/*! \brief Update rules of an ACL, loaded from the configuration or compiled. */
+typedef struct {
+	acl_update_owner_t owner;
+	acl_update_owner_match_t match;
+	uint16_t *types;
+	size_t types_count;
+	acl_bin_t *names;
+	size_t names_count;
+} update_rule_t;
+
+static bool match_type(uint16_t type, const uint16_t *types, size_t count)
 {
-	if (types == NULL) {
+	if (count == 0) {
 		return true;
 	}
 
-	conf_val_reset(types);
-	while (types->code == KNOT_EOK) {
-		if (type == knot_wire_read_u64(types->data)) {
+	for (size_t i = 0; i < count; i++) {
+		if (type == types[i]) {
 			return true;
 		}
-		conf_val_next(types);
 	}
 
 	return false;
@@ -115,17 +136,17 @@ static bool match_name(const knot_dname_t *rr_owner, const knot_dname_t *name,
 }
 
 static bool match_names(const knot_dname_t *rr_owner, const knot_dname_t *zone_name,
-                        conf_val_t *names, acl_update_owner_match_t match)
+                        const acl_bin_t *names, size_t count,
+                        acl_update_owner_match_t match)
 {
-	if (names == NULL) {
+	if (count == 0) {
 		return true;
 	}
 
-	conf_val_reset(names);
-	while (names->code == KNOT_EOK) {
+	for (size_t i = 0; i < count; i++) {
 		knot_dname_storage_t full_name;
-		size_t len;
-		const uint8_t *name = conf_data(names, &len);
+		size_t len = names[i].len;
+		const uint8_t *name = names[i].data;
 		if (name[len - 1] != '\0') {
 			// Append zone name if non-FQDN.
 			wire_ctx_t ctx = wire_ctx_init(full_name, sizeof(full_name));
@@ -139,45 +160,23 @@ static bool match_names(const knot_dname_t *rr_owner, const knot_dname_t *zone_n
 		if (match_name(rr_owner, name, match)) {
 			return true;
 		}
-		conf_val_next(names);
 	}
 
 	return false;
 }
 
-static bool update_match(conf_t *conf, conf_val_t *acl, knot_dname_t *key_name,
-                         const knot_dname_t *zone_name, knot_pkt_t *query)
+static bool update_rule_match(const update_rule_t *rule, knot_dname_t *key_name,
+                              const knot_dname_t *zone_name, knot_pkt_t *query)
 {
 	if (query == NULL) {
 		return true;
 	}
 
-	conf_val_t val_types = conf_id_get(conf, C_ACL, C_UPDATE_TYPE, acl);
-	conf_val_t *types = (conf_val_count(&val_types) > 0) ? &val_types : NULL;
-
-	conf_val_t val = conf_id_get(conf, C_ACL, C_UPDATE_OWNER, acl);
-	acl_update_owner_t owner = conf_opt(&val);
-
 	/* Return if no specific requirements configured. */
-	if (types == NULL && owner == ACL_UPDATE_OWNER_NONE) {
+	if (rule->types_count == 0 && rule->owner == ACL_UPDATE_OWNER_NONE) {
 		return true;
 	}
 
-	acl_update_owner_match_t match = ACL_UPDATE_MATCH_SUBEQ;
-	if (owner != ACL_UPDATE_OWNER_NONE) {
-		val = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_MATCH, acl);
-		match = conf_opt(&val);
-	}
-
-	conf_val_t *names = NULL;
-	conf_val_t val_names;
-	if (owner == ACL_UPDATE_OWNER_NAME) {
-		val_names = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_NAME, acl);
-		if (conf_val_count(&val_names) > 0) {
-			names = &val_names;
-		}
-	}
-
 	/* Updated RRs are contained in the Authority section of the query
 	 * (RFC 2136 Section 2.2)
 	 */
@@ -186,23 +185,24 @@ static bool update_match(conf_t *conf, conf_val_t *acl, knot_dname_t *key_name,
 
 	for (int i = pos; i < pos + count; i++) {
 		knot_rrset_t *rr = &query->rr[i];
-		if (!match_type(rr->type, types)) {
+		if (!match_type(rr->type, rule->types, rule->types_count)) {
 			return false;
 		}
 
-		switch (owner) {
+		switch (rule->owner) {
 		case ACL_UPDATE_OWNER_NAME:
-			if (!match_names(rr->owner, zone_name, names, match)) {
+			if (!match_names(rr->owner, zone_name, rule->names,
+			                 rule->names_count, rule->match)) {
 				return false;
 			}
 			break;
 		case ACL_UPDATE_OWNER_KEY:
-			if (!match_name(rr->owner, key_name, match)) {
+			if (!match_name(rr->owner, key_name, rule->match)) {
 				return false;
 			}
 			break;
 		case ACL_UPDATE_OWNER_ZONE:
-			if (!match_name(rr->owner, zone_name, match)) {
+			if (!match_name(rr->owner, zone_name, rule->match)) {
 				return false;
 			}
 			break;
@@ -214,6 +214,56 @@ static bool update_match(conf_t *conf, conf_val_t *acl, knot_dname_t *key_name,
 	return true;
 }
 
+/*!
+ * Fills the update rule of the ACL, the arrays must be large enough to hold
+ * all the configured types and names.
+ */
+static void update_rule_load(conf_t *conf, conf_val_t *acl, update_rule_t *rule,
+                             conf_val_t *types, conf_val_t *names)
+{
+	rule->types_count = 0;
+	while (types->code == KNOT_EOK) {
+		rule->types[rule->types_count++] = knot_wire_read_u64(types->data);
+		conf_val_next(types);
+	}
+
+	conf_val_t val = conf_id_get(conf, C_ACL, C_UPDATE_OWNER, acl);
+	rule->owner = conf_opt(&val);
+
+	rule->match = ACL_UPDATE_MATCH_SUBEQ;
+	if (rule->owner != ACL_UPDATE_OWNER_NONE) {
+		val = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_MATCH, acl);
+		rule->match = conf_opt(&val);
+	}
+
+	rule->names_count = 0;
+	if (rule->owner == ACL_UPDATE_OWNER_NAME) {
+		while (names->code == KNOT_EOK) {
+			acl_bin_t *name = &rule->names[rule->names_count++];
+			name->data = conf_data(names, &name->len);
+			conf_val_next(names);
+		}
+	}
+}
+
+static bool update_match(conf_t *conf, conf_val_t *acl, knot_dname_t *key_name,
+                         const knot_dname_t *zone_name, knot_pkt_t *query)
+{
+	if (query == NULL) {
+		return true;
+	}
+
+	conf_val_t types = conf_id_get(conf, C_ACL, C_UPDATE_TYPE, acl);
+	conf_val_t names = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_NAME, acl);
+
+	uint16_t types_buf[conf_val_count(&types) + 1];
+	acl_bin_t names_buf[conf_val_count(&names) + 1];
+	update_rule_t rule = { .types = types_buf, .names = names_buf };
+	update_rule_load(conf, acl, &rule, &types, &names);
+
+	return update_rule_match(&rule, key_name, zone_name, query);
+}
+
 static bool check_proto_rmt(conf_t *conf, knotd_query_proto_t proto, conf_val_t *rmt_id)
 {
 	conf_val_t quic_val = conf_id_get(conf, C_RMT, C_QUIC, rmt_id);
@@ -330,6 +380,17 @@ static bool check_addr_key(conf_t *conf, conf_val_t *addr_val, conf_val_t *key_v
 	return true;
 }
 
+bool acl_update_forwarded(conf_t *conf, const knot_dname_t *zone_name)
+{
+	conf_val_t val = conf_zone_get(conf, C_MASTER, zone_name);
+	if (val.code != KNOT_EOK) {
+		return false;
+	}
+
+	val = conf_zone_get(conf, C_DDNS_MASTER, zone_name);
+	return val.code != KNOT_EOK || *conf_str(&val) != '\0';
+}
+
 bool acl_allowed(conf_t *conf, conf_val_t *acl, acl_action_t action,
                  const struct sockaddr_storage *addr, knot_tsig_key_t *tsig,
                  const knot_dname_t *zone_name, knot_pkt_t *query,
@@ -344,16 +405,8 @@ bool acl_allowed(conf_t *conf, conf_val_t *acl, acl_action_t action,
 	size_t session_pin_size = sizeof(session_pin);
 	knot_tls_pin(tls_session, session_pin, &session_pin_size, false);
 
-	bool forward = false;
-	if (action == ACL_ACTION_UPDATE) {
-		conf_val_t val = conf_zone_get(conf, C_MASTER, zone_name);
-		if (val.code == KNOT_EOK) {
-			val = conf_zone_get(conf, C_DDNS_MASTER, zone_name);
-			if (val.code != KNOT_EOK || *conf_str(&val) != '\0') {
-				forward = true;
-			}
-		}
-	}
+	bool forward = (action == ACL_ACTION_UPDATE) &&
+	               acl_update_forwarded(conf, zone_name);
 
 	while (acl->code == KNOT_EOK) {
 		conf_val_t rmt_val = conf_id_get(conf, C_ACL, C_RMT, acl);
@@ -522,3 +575,860 @@ next_remote:
 
 	return false;
 }
+
+#define ACL_PROTOS	(KNOTD_QUERY_PROTO_TLS + 1)
+#define ACL_ACTIONS	(ACL_ACTION_UPDATE + 1)
+
+/*! \brief Node of a binary trie of address prefixes. */
+typedef struct addr_node {
+	struct addr_node *child[2];
+	uint64_t *bits;
+} addr_node_t;
+
+/*! \brief TSIG key used by the compiled entries. */
+typedef struct {
+	dnssec_tsig_algorithm_t alg;
+	dnssec_binary_t secret;
+	uint64_t *bits;
+} acl_key_t;
+
+/*! \brief ACL properties shared by all the entries of the ACL. */
+typedef struct {
+	bool deny;
+	bool no_action;
+	update_rule_t update;
+} acl_rule_t;
+
+/*!
+ * \brief Single address/key matching unit.
+ *
+ * An ACL without remotes is compiled into one entry, an ACL with remotes
+ * into one entry per remote. The entries keep the configuration order.
+ */
+typedef struct {
+	const acl_rule_t *rule;
+	acl_bin_t *pins;
+	size_t pins_count;
+	const char **hostnames; // NULL-terminated or NULL if not required.
+} acl_entry_t;
+
+struct acl_set {
+	knot_mm_t mm;
+	size_t count;                  // Number of entries.
+	size_t words;                  // Length of the entry bitmaps.
+	acl_entry_t *entries;
+	uint64_t *any_addr;            // Entries without address restriction.
+	addr_node_t *nets[2];          // IPv4 and IPv6 prefixes.
+	trie_t *addrs;                 // Exact addresses (family + address).
+	trie_t *keys;                  // Key name -> acl_key_t.
+	uint64_t *nokey;               // Entries without a key.
+	uint64_t *deny;                // Entries of denying ACLs.
+	uint64_t *actions[ACL_ACTIONS];
+	uint64_t *protos[ACL_PROTOS];
+};
+
+struct acl_cache {
+	conf_t *conf;                  // Configuration the lists are compiled from.
+	pthread_rwlock_t lock;         // Lock for the compilation on the first lookup.
+	trie_t *acls;                  // ACL list value -> acl_set_t.
+	trie_t *rmts;                  // Remote list value -> acl_set_t.
+};
+
+/*! \brief Properties of remote lists, every action is allowed. */
+static const acl_rule_t rmt_rule = { 0 };
+
+#define BIT_SET(bits, i)	((bits)[(i) / 64] |= (uint64_t)1 << ((i) % 64))
+#define BIT_GET(bits, i)	((bits)[(i) / 64] & ((uint64_t)1 << ((i) % 64)))
+
+static uint64_t *bitmap_new(acl_set_t *set)
+{
+	return mm_calloc(&set->mm, set->words, sizeof(uint64_t));
+}
+
+static void bitmap_or(uint64_t *dst, const uint64_t *src, size_t words)
+{
+	for (size_t i = 0; i < words; i++) {
+		dst[i] |= src[i];
+	}
+}
+
+static void bitmap_and(uint64_t *dst, const uint64_t *src, size_t words)
+{
+	for (size_t i = 0; i < words; i++) {
+		dst[i] &= src[i];
+	}
+}
+
+static int addr_family_idx(int family)
+{
+	return (family == AF_INET6) ? 1 : 0;
+}
+
+static size_t addr_key(const struct sockaddr_storage *ss, uint8_t *key, size_t max_len)
+{
+	const uint8_t *raw;
+	size_t raw_len;
+	if (ss->ss_family == AF_UNIX) {
+		raw = (const uint8_t *)((const struct sockaddr_un *)ss)->sun_path;
+		raw_len = strnlen((const char *)raw, sizeof(((struct sockaddr_un *)0)->sun_path));
+	} else {
+		raw = sockaddr_raw(ss, &raw_len);
+		if (raw == NULL) {
+			return 0;
+		}
+	}
+
+	assert(1 + raw_len <= max_len);
+	key[0] = ss->ss_family;
+	memcpy(key + 1, raw, raw_len);
+
+	return 1 + raw_len;
+}
+
+static int insert_exact(acl_set_t *set, const struct sockaddr_storage *ss, size_t idx)
+{
+	uint8_t key[1 + sizeof(struct sockaddr_storage)];
+	size_t key_len = addr_key(ss, key, sizeof(key));
+	if (key_len == 0) {
+		return KNOT_EOK; // Unsupported family never matches.
+	}
+
+	trie_val_t *val = trie_get_ins(set->addrs, key, key_len);
+	if (val == NULL) {
+		return KNOT_ENOMEM;
+	}
+	if (*val == NULL) {
+		*val = bitmap_new(set);
+		if (*val == NULL) {
+			return KNOT_ENOMEM;
+		}
+	}
+	BIT_SET((uint64_t *)*val, idx);
+
+	return KNOT_EOK;
+}
+
+static int insert_net(acl_set_t *set, const struct sockaddr_storage *ss,
+                      unsigned prefix, size_t idx)
+{
+	size_t raw_len;
+	const uint8_t *raw = sockaddr_raw(ss, &raw_len);
+	if (raw == NULL) {
+		return KNOT_EOK;
+	}
+
+	prefix = MIN(prefix, raw_len * 8);
+	if (prefix == raw_len * 8) {
+		return insert_exact(set, ss, idx);
+	}
+
+	addr_node_t **node = &set->nets[addr_family_idx(ss->ss_family)];
+	for (unsigned i = 0; ; i++) {
+		if (*node == NULL) {
+			*node = mm_calloc(&set->mm, 1, sizeof(addr_node_t));
+			if (*node == NULL) {
+				return KNOT_ENOMEM;
+			}
+		}
+		if (i == prefix) {
+			break;
+		}
+		node = &(*node)->child[(raw[i / 8] >> (7 - i % 8)) & 1];
+	}
+
+	if ((*node)->bits == NULL) {
+		(*node)->bits = bitmap_new(set);
+		if ((*node)->bits == NULL) {
+			return KNOT_ENOMEM;
+		}
+	}
+	BIT_SET((*node)->bits, idx);
+
+	return KNOT_EOK;
+}
+
+#define RAW_BIT(raw, len, b)	((raw)[(len) - 1 - (b) / 8] & (1 << ((b) % 8)))
+
+/*! \brief Covers the address range with the smallest set of prefixes. */
+static int insert_range(acl_set_t *set, const struct sockaddr_storage *min,
+                        const struct sockaddr_storage *max, size_t idx)
+{
+	if (min->ss_family != max->ss_family || min->ss_family == AF_UNIX) {
+		return KNOT_EOK; // Never matches.
+	}
+
+	struct sockaddr_storage cur = *min;
+	size_t len;
+	uint8_t *raw = (uint8_t *)sockaddr_raw(&cur, &len);
+	const uint8_t *raw_max = sockaddr_raw(max, &len);
+	if (raw == NULL) {
+		return KNOT_EOK;
+	}
+
+	while (memcmp(raw, raw_max, len) <= 0) {
+		/* Find the largest aligned block starting at cur, not exceeding max. */
+		unsigned host = 0;
+		while (host < len * 8 && !RAW_BIT(raw, len, host)) {
+			uint8_t end[len];
+			memcpy(end, raw, len);
+			for (unsigned b = 0; b <= host; b++) {
+				end[len - 1 - b / 8] |= 1 << (b % 8);
+			}
+			if (memcmp(end, raw_max, len) > 0) {
+				break;
+			}
+			host++;
+		}
+
+		int ret = insert_net(set, &cur, len * 8 - host, idx);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+
+		/* Move behind the block, stop on overflow. */
+		for (unsigned b = 0; b < host; b++) {
+			raw[len - 1 - b / 8] |= 1 << (b % 8);
+		}
+		size_t i = len;
+		while (i > 0 && ++raw[i - 1] == 0) {
+			i--;
+		}
+		if (i == 0) {
+			break;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static int compile_addrs(acl_set_t *set, conf_val_t *addr_val, bool remote, size_t idx)
+{
+	if (addr_val->code == KNOT_ENOENT) {
+		BIT_SET(set->any_addr, idx);
+		return KNOT_EOK;
+	}
+
+	while (addr_val->code == KNOT_EOK) {
+		int ret;
+		if (remote) {
+			struct sockaddr_storage addr = conf_addr(addr_val, NULL);
+			ret = insert_exact(set, &addr, idx);
+		} else {
+			int prefix;
+			struct sockaddr_storage min, max;
+			min = conf_addr_range(addr_val, &max, &prefix);
+			if (max.ss_family != AF_UNSPEC) {
+				ret = insert_range(set, &min, &max, idx);
+			} else if (min.ss_family == AF_UNIX) {
+				ret = insert_exact(set, &min, idx);
+			} else {
+				ret = insert_net(set, &min, prefix, idx);
+			}
+		}
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+		if (!(addr_val->item->flags & YP_FMULTI)) {
+			break;
+		}
+		conf_val_next(addr_val);
+	}
+
+	return KNOT_EOK;
+}
+
+static int compile_keys(conf_t *conf, acl_set_t *set, conf_val_t *key_val, size_t idx)
+{
+	if (key_val->code == KNOT_ENOENT) {
+		BIT_SET(set->nokey, idx);
+		return KNOT_EOK;
+	}
+
+	while (key_val->code == KNOT_EOK) {
+		const knot_dname_t *key_name = conf_dname(key_val);
+		trie_val_t *val = trie_get_ins(set->keys, key_name, knot_dname_size(key_name));
+		if (val == NULL) {
+			return KNOT_ENOMEM;
+		}
+		if (*val == NULL) {
+			acl_key_t *key = mm_calloc(&set->mm, 1, sizeof(*key));
+			if (key == NULL) {
+				return KNOT_ENOMEM;
+			}
+			conf_val_t alg_val = conf_id_get(conf, C_KEY, C_ALG, key_val);
+			key->alg = conf_opt(&alg_val);
+
+			size_t secret_len;
+			conf_val_t secret_val = conf_id_get(conf, C_KEY, C_SECRET, key_val);
+			const uint8_t *secret = conf_bin(&secret_val, &secret_len);
+			key->secret.data = mm_alloc(&set->mm, MAX(secret_len, 1U));
+			key->bits = bitmap_new(set);
+			if (key->secret.data == NULL || key->bits == NULL) {
+				return KNOT_ENOMEM;
+			}
+			memcpy(key->secret.data, secret, secret_len);
+			key->secret.size = secret_len;
+			*val = key;
+		}
+		BIT_SET(((acl_key_t *)*val)->bits, idx);
+
+		if (!(key_val->item->flags & YP_FMULTI)) {
+			break;
+		}
+		conf_val_next(key_val);
+	}
+
+	return KNOT_EOK;
+}
+
+static int compile_cert(acl_set_t *set, acl_entry_t *entry, conf_val_t *pin_val,
+                        conf_val_t *hostname_val)
+{
+	size_t count = conf_val_count(pin_val);
+	if (count > 0) {
+		entry->pins = mm_calloc(&set->mm, count, sizeof(acl_bin_t));
+		if (entry->pins == NULL) {
+			return KNOT_ENOMEM;
+		}
+		while (pin_val->code == KNOT_EOK) {
+			size_t len;
+			const uint8_t *pin = conf_bin(pin_val, &len);
+			uint8_t *copy = mm_alloc(&set->mm, MAX(len, 1U));
+			if (copy == NULL) {
+				return KNOT_ENOMEM;
+			}
+			memcpy(copy, pin, len);
+			entry->pins[entry->pins_count++] = (acl_bin_t){ copy, len };
+			conf_val_next(pin_val);
+		}
+	}
+
+	count = conf_val_count(hostname_val);
+	if (count > 0) {
+		entry->hostnames = mm_calloc(&set->mm, count + 1, sizeof(char *));
+		if (entry->hostnames == NULL) {
+			return KNOT_ENOMEM;
+		}
+		const char **hostname = entry->hostnames;
+		while (hostname_val->code == KNOT_EOK) {
+			*hostname = mm_strdup(&set->mm, conf_str(hostname_val));
+			if (*hostname++ == NULL) {
+				return KNOT_ENOMEM;
+			}
+			conf_val_next(hostname_val);
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static void compile_rmt_proto(conf_t *conf, acl_set_t *set, conf_val_t *rmt_id, size_t idx)
+{
+	conf_val_t quic_val = conf_id_get(conf, C_RMT, C_QUIC, rmt_id);
+	conf_val_t tls_val = conf_id_get(conf, C_RMT, C_TLS, rmt_id);
+	if (conf_bool(&quic_val)) {
+		BIT_SET(set->protos[KNOTD_QUERY_PROTO_QUIC], idx);
+	} else if (conf_bool(&tls_val)) {
+		BIT_SET(set->protos[KNOTD_QUERY_PROTO_TLS], idx);
+	} else {
+		BIT_SET(set->protos[KNOTD_QUERY_PROTO_UDP], idx);
+		BIT_SET(set->protos[KNOTD_QUERY_PROTO_TCP], idx);
+	}
+}
+
+static int compile_rmt_entry(conf_t *conf, acl_set_t *set, const acl_rule_t *rule,
+                             conf_val_t *rmt_id)
+{
+	size_t idx = set->count++;
+	acl_entry_t *entry = &set->entries[idx];
+	entry->rule = rule;
+
+	conf_val_t val = conf_id_get(conf, C_RMT, C_ADDR, rmt_id);
+	int ret = compile_addrs(set, &val, true, idx);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	val = conf_id_get(conf, C_RMT, C_KEY, rmt_id);
+	ret = compile_keys(conf, set, &val, idx);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	conf_val_t pin_val = conf_id_get(conf, C_RMT, C_CERT_KEY, rmt_id);
+	conf_val_t hostname_val = conf_id_get(conf, C_RMT, C_CERT_HOSTNAME, rmt_id);
+	ret = compile_cert(set, entry, &pin_val, &hostname_val);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	compile_rmt_proto(conf, set, rmt_id, idx);
+
+	return KNOT_EOK;
+}
+
+static int compile_acl_entry(conf_t *conf, acl_set_t *set, const acl_rule_t *rule,
+                             conf_val_t *acl)
+{
+	size_t idx = set->count++;
+	acl_entry_t *entry = &set->entries[idx];
+	entry->rule = rule;
+
+	conf_val_t val = conf_id_get(conf, C_ACL, C_ADDR, acl);
+	int ret = compile_addrs(set, &val, false, idx);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	val = conf_id_get(conf, C_ACL, C_KEY, acl);
+	ret = compile_keys(conf, set, &val, idx);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	conf_val_t pin_val = conf_id_get(conf, C_ACL, C_CERT_KEY, acl);
+	conf_val_t hostname_val = conf_id_get(conf, C_ACL, C_CERT_HOSTNAME, acl);
+	ret = compile_cert(set, entry, &pin_val, &hostname_val);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	val = conf_id_get(conf, C_ACL, C_PROTOCOL, acl);
+	for (int proto = 0; proto < ACL_PROTOS; proto++) {
+		if (val.code != KNOT_EOK || check_proto(proto, val)) {
+			BIT_SET(set->protos[proto], idx);
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static acl_rule_t *compile_rule(conf_t *conf, acl_set_t *set, conf_val_t *acl)
+{
+	acl_rule_t *rule = mm_calloc(&set->mm, 1, sizeof(*rule));
+	if (rule == NULL) {
+		return NULL;
+	}
+
+	conf_val_t val = conf_id_get(conf, C_ACL, C_DENY, acl);
+	rule->deny = conf_bool(&val);
+
+	val = conf_id_get(conf, C_ACL, C_ACTION, acl);
+	rule->no_action = (val.code == KNOT_ENOENT);
+
+	conf_val_t types = conf_id_get(conf, C_ACL, C_UPDATE_TYPE, acl);
+	conf_val_t names = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_NAME, acl);
+	rule->update.types = mm_calloc(&set->mm, conf_val_count(&types) + 1, sizeof(uint16_t));
+	rule->update.names = mm_calloc(&set->mm, conf_val_count(&names) + 1, sizeof(acl_bin_t));
+	if (rule->update.types == NULL || rule->update.names == NULL) {
+		return NULL;
+	}
+	update_rule_load(conf, acl, &rule->update, &types, &names);
+
+	/* Keep own copies of the names, the configuration may go away. */
+	for (size_t i = 0; i < rule->update.names_count; i++) {
+		acl_bin_t *name = &rule->update.names[i];
+		uint8_t *copy = mm_alloc(&set->mm, name->len);
+		if (copy == NULL) {
+			return NULL;
+		}
+		memcpy(copy, name->data, name->len);
+		name->data = copy;
+	}
+
+	return rule;
+}
+
+static void compile_rule_bits(conf_t *conf, acl_set_t *set, const acl_rule_t *rule,
+                              conf_val_t *acl, size_t from, size_t to)
+{
+	for (size_t idx = from; idx < to; idx++) {
+		if (rule->deny) {
+			BIT_SET(set->deny, idx);
+		}
+		if (rule == &rmt_rule || rule->no_action) {
+			for (int action = 0; action < ACL_ACTIONS; action++) {
+				BIT_SET(set->actions[action], idx);
+			}
+			continue;
+		}
+		conf_val_t val = conf_id_get(conf, C_ACL, C_ACTION, acl);
+		while (val.code == KNOT_EOK) {
+			unsigned action = conf_opt(&val);
+			if (action < ACL_ACTIONS) {
+				BIT_SET(set->actions[action], idx);
+			}
+			conf_val_next(&val);
+		}
+	}
+}
+
+static acl_set_t *set_new(size_t count)
+{
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+
+	acl_set_t *set = mm_calloc(&mm, 1, sizeof(*set));
+	if (set == NULL) {
+		mp_delete(mm.ctx);
+		return NULL;
+	}
+	set->mm = mm;
+	set->words = MAX((count + 63) / 64, 1U);
+	set->entries = mm_calloc(&set->mm, MAX(count, 1U), sizeof(acl_entry_t));
+	set->any_addr = bitmap_new(set);
+	set->nokey = bitmap_new(set);
+	set->deny = bitmap_new(set);
+	set->addrs = trie_create(NULL);
+	set->keys = trie_create(NULL);
+	bool ok = set->entries != NULL && set->any_addr != NULL &&
+	          set->nokey != NULL && set->deny != NULL &&
+	          set->addrs != NULL && set->keys != NULL;
+	for (int i = 0; i < ACL_ACTIONS; i++) {
+		set->actions[i] = bitmap_new(set);
+		ok = ok && set->actions[i] != NULL;
+	}
+	for (int i = 0; i < ACL_PROTOS; i++) {
+		set->protos[i] = bitmap_new(set);
+		ok = ok && set->protos[i] != NULL;
+	}
+	if (!ok) {
+		acl_set_free(set);
+		return NULL;
+	}
+
+	return set;
+}
+
+acl_set_t *acl_compile(conf_t *conf, conf_val_t *acl)
+{
+	if (conf == NULL || acl == NULL) {
+		return NULL;
+	}
+
+	/* Count the entries first to size the bitmaps. */
+	size_t count = 0;
+	conf_val_t acl_it = *acl;
+	while (acl_it.code == KNOT_EOK) {
+		conf_val_t rmt_val = conf_id_get(conf, C_ACL, C_RMT, &acl_it);
+		if (rmt_val.code == KNOT_EOK) {
+			conf_mix_iter_t iter;
+			conf_mix_iter_init(conf, &rmt_val, &iter);
+			while (iter.id->code == KNOT_EOK) {
+				count++;
+				conf_mix_iter_next(&iter);
+			}
+		} else {
+			count++;
+		}
+		conf_val_next(&acl_it);
+	}
+
+	acl_set_t *set = set_new(count);
+	if (set == NULL) {
+		return NULL;
+	}
+
+	while (acl->code == KNOT_EOK) {
+		acl_rule_t *rule = compile_rule(conf, set, acl);
+		if (rule == NULL) {
+			goto failed;
+		}
+
+		size_t from = set->count;
+		conf_val_t rmt_val = conf_id_get(conf, C_ACL, C_RMT, acl);
+		if (rmt_val.code == KNOT_EOK) {
+			conf_mix_iter_t iter;
+			conf_mix_iter_init(conf, &rmt_val, &iter);
+			while (iter.id->code == KNOT_EOK) {
+				if (set->count == count ||
+				    compile_rmt_entry(conf, set, rule, iter.id) != KNOT_EOK) {
+					goto failed;
+				}
+				conf_mix_iter_next(&iter);
+			}
+		} else if (set->count == count ||
+		           compile_acl_entry(conf, set, rule, acl) != KNOT_EOK) {
+			goto failed;
+		}
+		compile_rule_bits(conf, set, rule, acl, from, set->count);
+
+		conf_val_next(acl);
+	}
+
+	return set;
+failed:
+	acl_set_free(set);
+	return NULL;
+}
+
+acl_set_t *rmt_compile(conf_t *conf, conf_val_t *rmts)
+{
+	if (conf == NULL || rmts == NULL) {
+		return NULL;
+	}
+
+	size_t count = 0;
+	conf_mix_iter_t iter;
+	conf_mix_iter_init(conf, rmts, &iter);
+	while (iter.id->code == KNOT_EOK) {
+		conf_val_t val = conf_id_get(conf, C_RMT, C_AUTO_ACL, iter.id);
+		count += conf_bool(&val) ? 1 : 0;
+		conf_mix_iter_next(&iter);
+	}
+
+	acl_set_t *set = set_new(count);
+	if (set == NULL) {
+		return NULL;
+	}
+
+	conf_mix_iter_init(conf, rmts, &iter);
+	while (iter.id->code == KNOT_EOK) {
+		conf_val_t val = conf_id_get(conf, C_RMT, C_AUTO_ACL, iter.id);
+		if (conf_bool(&val)) {
+			size_t from = set->count;
+			if (set->count == count ||
+			    compile_rmt_entry(conf, set, &rmt_rule, iter.id) != KNOT_EOK) {
+				acl_set_free(set);
+				return NULL;
+			}
+			compile_rule_bits(conf, set, &rmt_rule, NULL, from, set->count);
+		}
+		conf_mix_iter_next(&iter);
+	}
+
+	return set;
+}
+
+void acl_set_free(acl_set_t *set)
+{
+	if (set == NULL) {
+		return;
+	}
+
+	trie_free(set->addrs);
+	trie_free(set->keys);
+	mp_delete(set->mm.ctx);
+}
+
+static void addr_bits(const acl_set_t *set, const struct sockaddr_storage *addr,
+                      uint64_t *bits)
+{
+	memcpy(bits, set->any_addr, set->words * sizeof(uint64_t));
+
+	uint8_t key[1 + sizeof(struct sockaddr_storage)];
+	size_t key_len = addr_key(addr, key, sizeof(key));
+	if (key_len == 0) {
+		return;
+	}
+
+	trie_val_t *val = trie_get_try(set->addrs, key, key_len);
+	if (val != NULL) {
+		bitmap_or(bits, *val, set->words);
+	}
+
+	if (addr->ss_family != AF_INET && addr->ss_family != AF_INET6) {
+		return;
+	}
+
+	/* Collect all the covering prefixes along the path. */
+	const uint8_t *raw = key + 1;
+	unsigned raw_bits = (key_len - 1) * 8;
+	const addr_node_t *node = set->nets[addr_family_idx(addr->ss_family)];
+	for (unsigned i = 0; node != NULL; i++) {
+		if (node->bits != NULL) {
+			bitmap_or(bits, node->bits, set->words);
+		}
+		if (i == raw_bits) {
+			break;
+		}
+		node = node->child[(raw[i / 8] >> (7 - i % 8)) & 1];
+	}
+}
+
+static bool pins_match(const uint8_t *session_pin, size_t session_pin_size,
+                       const acl_bin_t *pins, size_t count)
+{
+	if (count == 0) { // No certificate pin authentication required.
+		return true;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (pins[i].len == session_pin_size &&
+		    const_time_memcmp(pins[i].data, session_pin, session_pin_size) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool acl_set_allowed(const acl_set_t *set, acl_action_t action,
+                     const struct sockaddr_storage *addr, knot_tsig_key_t *tsig,
+                     const knot_dname_t *zone_name, knot_pkt_t *query,
+                     struct gnutls_session_int *tls_session,
+                     knotd_query_proto_t proto, bool forward)
+{
+	if (set == NULL || addr == NULL || tsig == NULL || set->count == 0 ||
+	    proto >= ACL_PROTOS || action >= ACL_ACTIONS) {
+		return false;
+	}
+
+	const size_t words = set->words;
+	uint64_t bits[words];
+	addr_bits(set, addr, bits);
+	bitmap_and(bits, set->protos[proto], words);
+	if (action != ACL_ACTION_QUERY) {
+		bitmap_and(bits, set->actions[action], words);
+	}
+
+	/* Entries with the key, or without any key if no key provided, the DDNS
+	 * is forwarded, or the entry denies. */
+	const acl_key_t *key = NULL;
+	if (tsig->name != NULL) {
+		trie_val_t *val = trie_get_try(set->keys, tsig->name,
+		                               knot_dname_size(tsig->name));
+		if (val != NULL && ((acl_key_t *)*val)->alg == tsig->algorithm) {
+			key = *val;
+		}
+		for (size_t i = 0; i < words; i++) {
+			uint64_t nokey = set->nokey[i] & (forward ? UINT64_MAX : set->deny[i]);
+			bits[i] &= ((key != NULL) ? key->bits[i] : 0) | nokey;
+		}
+	} else {
+		bitmap_and(bits, set->nokey, words);
+	}
+
+	uint8_t session_pin[KNOT_TLS_PIN_LEN];
+	size_t session_pin_size = sizeof(session_pin);
+	knot_tls_pin(tls_session, session_pin, &session_pin_size, false);
+
+	for (size_t i = 0; i < words; i++) {
+		for (uint64_t word = bits[i]; word != 0; word &= word - 1) {
+			size_t idx = i * 64 + __builtin_ctzll(word);
+			const acl_entry_t *entry = &set->entries[idx];
+			const acl_rule_t *rule = entry->rule;
+
+			if (!pins_match(session_pin, session_pin_size, entry->pins,
+			                entry->pins_count) ||
+			    (entry->hostnames != NULL &&
+			     knot_tls_cert_check_hostnames(tls_session, entry->hostnames) != KNOT_EOK)) {
+				continue;
+			}
+
+			/* Empty action list allowed with deny only. */
+			if (action != ACL_ACTION_QUERY && rule->no_action) {
+				return false;
+			}
+
+			if (action == ACL_ACTION_UPDATE &&
+			    !update_rule_match(&rule->update, tsig->name, zone_name, query)) {
+				continue;
+			}
+
+			if (rule->deny) {
+				return false;
+			}
+
+			/* Fill the output with tsig secret if provided. */
+			if (key != NULL && BIT_GET(key->bits, idx)) {
+				tsig->secret.data = key->secret.data;
+				tsig->secret.size = key->secret.size;
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int set_free_cb(trie_val_t *val, _unused_ void *ctx)
+{
+	acl_set_free(*val);
+	return KNOT_EOK;
+}
+
+acl_cache_t *acl_cache_new(conf_t *conf)
+{
+	if (conf == NULL) {
+		return NULL;
+	}
+
+	acl_cache_t *cache = calloc(1, sizeof(*cache));
+	if (cache == NULL) {
+		return NULL;
+	}
+	cache->conf = conf;
+	cache->acls = trie_create(NULL);
+	cache->rmts = trie_create(NULL);
+	if (cache->acls == NULL || cache->rmts == NULL ||
+	    pthread_rwlock_init(&cache->lock, NULL) != 0) {
+		trie_free(cache->acls);
+		trie_free(cache->rmts);
+		free(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+void acl_cache_free(acl_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	trie_apply(cache->acls, set_free_cb, NULL);
+	trie_free(cache->acls);
+	trie_apply(cache->rmts, set_free_cb, NULL);
+	trie_free(cache->rmts);
+	pthread_rwlock_destroy(&cache->lock);
+	free(cache);
+}
+
+static const acl_set_t *cache_get(acl_cache_t *cache, trie_t *sets, const conf_val_t *val,
+                                  acl_set_t *(*compile)(conf_t *, conf_val_t *))
+{
+	if (val->code != KNOT_EOK) {
+		return NULL;
+	}
+
+	pthread_rwlock_rdlock(&cache->lock);
+	trie_val_t *set = trie_get_try(sets, val->blob, val->blob_len);
+	const acl_set_t *found = (set != NULL) ? *set : NULL;
+	pthread_rwlock_unlock(&cache->lock);
+	if (found != NULL) {
+		return found;
+	}
+
+	/* Compile on the first lookup unless another thread was faster. */
+	pthread_rwlock_wrlock(&cache->lock);
+	set = trie_get_ins(sets, val->blob, val->blob_len);
+	if (set != NULL && *set == NULL) {
+		conf_val_t copy = *val;
+		*set = compile(cache->conf, &copy);
+	}
+	found = (set != NULL) ? *set : NULL;
+	pthread_rwlock_unlock(&cache->lock);
+
+	return found;
+}
+
+const acl_set_t *acl_cache_acl(acl_cache_t *cache, const conf_val_t *acl)
+{
+	if (cache == NULL || acl == NULL) {
+		return NULL;
+	}
+
+	return cache_get(cache, cache->acls, acl, acl_compile);
+}
+
+const acl_set_t *acl_cache_rmt(acl_cache_t *cache, const conf_val_t *rmts)
+{
+	if (cache == NULL || rmts == NULL || !cache->conf->cache.srv_auto_acl) {
+		return NULL;
+	}
+
+	return cache_get(cache, cache->rmts, rmts, rmt_compile);
+}
@@ -45,6 +45,12 @@ typedef enum {
 	ACL_PROTOCOL_QUIC = (1 << 3),
 } acl_protocol_t;
 
+/*! \brief Compiled ACL list or automatic ACL remote list. */
+typedef struct acl_set acl_set_t;
+
+/*! \brief Compiled ACL and remote lists of the configured zones and templates. */
+typedef struct acl_cache acl_cache_t;
+
 /*!
  * \brief Checks if the address and/or tsig key matches given ACL list.
  *
@@ -88,3 +94,100 @@ bool acl_allowed(conf_t *conf, conf_val_t *acl, acl_action_t action,
 bool rmt_allowed(conf_t *conf, conf_val_t *rmts, const struct sockaddr_storage *addr,
                  knot_tsig_key_t *tsig, struct gnutls_session_int *tls_session,
                  knotd_query_proto_t proto);
+
+/*!
+ * \brief Checks if DDNS to the zone is forwarded to its primary server.
+ *
+ * \param conf       Configuration.
+ * \param zone_name  Zone name.
+ *
+ * \retval True if forwarded.
+ */
+bool acl_update_forwarded(conf_t *conf, const knot_dname_t *zone_name);
+
+/*!
+ * \brief Compiles the ACL list into a lookup structure.
+ *
+ * The result is independent of the configuration database, the address and
+ * key matching is done by the lookup tables instead of walking the list.
+ *
+ * \param conf  Configuration.
+ * \param acl   Pointer to ACL config multivalued identifier.
+ *
+ * \return Compiled ACL list or NULL if an error occurred.
+ */
+acl_set_t *acl_compile(conf_t *conf, conf_val_t *acl);
+
+/*!
+ * \brief Compiles the automatic ACL of the remote list into a lookup structure.
+ *
+ * \param conf  Configuration.
+ * \param rmts  Pointer to REMOTE config multivalued identifier.
+ *
+ * \return Compiled remote list or NULL if an error occurred.
+ */
+acl_set_t *rmt_compile(conf_t *conf, conf_val_t *rmts);
+
+/*!
+ * \brief Frees the compiled ACL list.
+ */
+void acl_set_free(acl_set_t *set);
+
+/*!
+ * \brief Compiled variant of acl_allowed() and rmt_allowed().
+ *
+ * \param set          Compiled ACL list or remote list.
+ * \param action       ACL action.
+ * \param addr         IP address.
+ * \param tsig         TSIG parameters.
+ * \param zone_name    Zone name.
+ * \param query        Update query.
+ * \param tls_session  Possible TLS session.
+ * \param proto        Transport protocol.
+ * \param forward      DDNS is forwarded (see acl_update_forwarded()).
+ *
+ * \retval True if authenticated.
+ */
+bool acl_set_allowed(const acl_set_t *set, acl_action_t action,
+                     const struct sockaddr_storage *addr, knot_tsig_key_t *tsig,
+                     const knot_dname_t *zone_name, knot_pkt_t *query,
+                     struct gnutls_session_int *tls_session,
+                     knotd_query_proto_t proto, bool forward);
+
+/*!
+ * \brief Creates the cache of the ACL and remote lists used by the configured zones.
+ *
+ * The lists are compiled on their first lookup, so a configuration reload
+ * doesn't compile the lists of all the zones in advance.
+ *
+ * \param conf  Configuration the cache belongs to.
+ *
+ * \return ACL cache or NULL if an error occurred.
+ */
+acl_cache_t *acl_cache_new(conf_t *conf);
+
+/*!
+ * \brief Frees the ACL cache.
+ */
+void acl_cache_free(acl_cache_t *cache);
+
+/*!
+ * \brief Looks up the compiled ACL list, compiles it if not cached yet.
+ *
+ * \param cache  ACL cache.
+ * \param acl    ACL config multivalued identifier (e.g. zone ACL).
+ *
+ * \return Compiled ACL list or NULL if not available.
+ */
+const acl_set_t *acl_cache_acl(acl_cache_t *cache, const conf_val_t *acl);
+
+/*!
+ * \brief Looks up the compiled automatic ACL of the remote list, compiles it
+ *        if not cached yet.
+ *
+ * \param cache  ACL cache.
+ * \param rmts   REMOTE config multivalued identifier (e.g. zone primaries).
+ *
+ * \return Compiled remote list or NULL if not available or automatic ACL disabled.
+ */
+const acl_set_t *acl_cache_rmt(acl_cache_t *cache, const conf_val_t *rmts);
@@ -11,11 +11,15 @@
 #include "knot/common/dbus.h"
 #include "knot/common/log.h"
 #include "knot/dnssec/zone-events.h"
+#include "knot/nameserver/answer_cache.h"
+#include "knot/nameserver/axfr_cache.h"
+#include "knot/nameserver/ixfr_cache.h"
 #include "knot/server/server.h"
 #include "knot/updates/zone-update.h"
 #include "knot/zone/adds_tree.h"
 #include "knot/zone/adjust.h"
 #include "knot/zone/digest.h"
+#include "knot/zone/nsec3_cache.h"
 #include "knot/zone/serial.h"
 #include "knot/zone/zone-diff.h"
 #include "knot/zone/zonefile.h"
@@ -885,7 +889,8 @@ int zone_update_semcheck(conf_t *conf, zone_update_t *update)
 	semcheck_optional_t mode = (conf_opt(&val) == SEMCHECKS_SOFT) ?
 	                           SEMCHECK_MANDATORY_SOFT : SEMCHECK_MANDATORY_ONLY;
 
-	ret = sem_checks_process(update->new_cont, mode, &handler, time(NULL), 0);
+	val = conf_zone_get(conf, C_ADJUST_THR, update->zone->name);
+	ret = sem_checks_process(update->new_cont, mode, &handler, time(NULL), conf_int(&val));
 	if (ret != KNOT_EOK) {
 		// error is logged by the error handler
 		return ret;
@@ -999,6 +1004,23 @@ int zone_update_commit(conf_t *conf, zone_update_t *update)
 		}
 	}
 
+	/* Attach fresh answer, AXFR, IXFR, and NSEC3 hash caches to the new contents. */
+	val = conf_zone_get(conf, C_ANSWER_CACHE, update->zone->name);
+	if (update->new_cont->answer_cache == NULL) {
+		update->new_cont->answer_cache = answer_cache_new(conf_int(&val));
+	}
+	val = conf_zone_get(conf, C_AXFR_CACHE, update->zone->name);
+	if (update->new_cont->axfr_cache == NULL && conf_bool(&val)) {
+		update->new_cont->axfr_cache = axfr_cache_new(update->new_cont);
+	}
+	val = conf_zone_get(conf, C_IXFR_CACHE, update->zone->name);
+	if (update->new_cont->ixfr_cache == NULL) {
+		update->new_cont->ixfr_cache = ixfr_cache_new(conf_int(&val));
+	}
+	if (update->new_cont->nsec3_cache == NULL && knot_is_nsec3_enabled(update->new_cont)) {
+		update->new_cont->nsec3_cache = nsec3_cache_new(NSEC3_CACHE_SLOTS);
+	}
+
 	/* Switch zone contents. */
 	zone_contents_t *old_contents;
 	old_contents = zone_switch_contents(update->zone, update->new_cont);
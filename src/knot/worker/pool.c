@@ -10,28 +10,137 @@
 #include <string.h>
 
 #include "libknot/libknot.h"
+#include "contrib/atomic.h"
+#include "contrib/time.h"
 #include "knot/server/dthreads.h"
 #include "knot/worker/pool.h"
 
+/*! \brief Interval of checking for finished tasks while waiting with a callback. */
+#define WAIT_CB_INTERVAL_MS	100
+
+/*!
+ * \brief Task queues of one worker thread, one queue per priority class.
+ *
+ * Tasks are taken from the own queues first, idle threads steal from the
+ * queues of the other threads.
+ */
+typedef struct {
+	pthread_mutex_t lock;
+	worker_queue_t tasks[WORKER_PRIO_COUNT];
+	knot_atomic_size_t length[WORKER_PRIO_COUNT]; /*!< Lock-free length hint. */
+} worker_queues_t;
+
 /*!
  * \brief Worker pool state.
  */
 struct worker_pool {
 	dt_unit_t *threads;
+	worker_queues_t *queues;	/*!< Task queues, one per thread. */
+	unsigned count;			/*!< Number of threads and queues. */
+
+	pthread_mutex_t lock;		/*!< Protects sleeping and state changes. */
+	pthread_cond_t wake;		/*!< New task or state change for sleeping threads. */
+	pthread_cond_t done;		/*!< All tasks have been processed. */
+
+	knot_atomic_bool terminating;	/*!< Is the pool terminating? .*/
+	knot_atomic_bool suspended;	/*!< Is execution temporarily suspended? .*/
+	knot_atomic_size_t idle;	/*!< Number of sleeping threads. */
+	knot_atomic_size_t pending;	/*!< Number of queued and running tasks. */
+	knot_atomic_size_t running;	/*!< Number of running tasks. */
+	knot_atomic_size_t finished;	/*!< Number of finished tasks. */
+	knot_atomic_size_t next;	/*!< Next queue for tasks assigned from outside. */
+
+	knot_atomic_uint64_t wait_hist[WORKER_PRIO_COUNT][WORKER_WAIT_BUCKETS];
+};
 
-	pthread_mutex_t lock;
-	pthread_cond_t wake;
+/*! \brief Pool and queue index of the current worker thread. */
+static _Thread_local worker_pool_t *local_pool = NULL;
+static _Thread_local unsigned local_idx = 0;
 
-	bool terminating;	/*!< Is the pool terminating? .*/
-	bool suspended;		/*!< Is execution temporarily suspended? .*/
-	int running;		/*!< Number of running threads. */
-	worker_queue_t tasks;
-};
+static void record_wait(worker_pool_t *pool, worker_prio_t prio,
+                        const struct timespec *since)
+{
+	struct timespec now = time_now();
+	double wait_ms = time_diff_ms(since, &now);
+
+	unsigned bucket = 0;
+	for (double limit = 1.0; bucket < WORKER_WAIT_BUCKETS - 1; limit *= 10) {
+		if (wait_ms < limit) {
+			break;
+		}
+		bucket++;
+	}
+
+	ATOMIC_ADD(pool->wait_hist[prio][bucket], 1);
+}
+
+/*!
+ * \brief Take a task, the highest priority first, own queue first.
+ */
+static worker_task_t *take_task(worker_pool_t *pool, unsigned self)
+{
+	for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+		for (unsigned i = 0; i < pool->count; i++) {
+			worker_queues_t *queues = &pool->queues[(self + i) % pool->count];
+			if (ATOMIC_GET(queues->length[prio]) == 0) {
+				continue;
+			}
+
+			struct timespec since;
+			pthread_mutex_lock(&queues->lock);
+			worker_task_t *task = worker_queue_dequeue(&queues->tasks[prio], &since);
+			ATOMIC_SET(queues->length[prio], worker_queue_length(&queues->tasks[prio]));
+			pthread_mutex_unlock(&queues->lock);
+
+			if (task != NULL) {
+				record_wait(pool, prio, &since);
+				return task;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/*!
+ * \brief Check all queues for a task, taking the queue locks.
+ *
+ * \note Together with the idle counter update before this check, taking
+ *       the locks guarantees the assigning thread notices a sleeping thread.
+ */
+static bool has_task(worker_pool_t *pool)
+{
+	for (unsigned i = 0; i < pool->count; i++) {
+		worker_queues_t *queues = &pool->queues[i];
+		pthread_mutex_lock(&queues->lock);
+		for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+			if (worker_queue_length(&queues->tasks[prio]) > 0) {
+				pthread_mutex_unlock(&queues->lock);
+				return true;
+			}
+		}
+		pthread_mutex_unlock(&queues->lock);
+	}
+
+	return false;
+}
+
+static void worker_sleep(worker_pool_t *pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	ATOMIC_ADD(pool->idle, 1);
+	while (!ATOMIC_GET(pool->terminating) &&
+	       (ATOMIC_GET(pool->suspended) || !has_task(pool))) {
+		pthread_cond_wait(&pool->wake, &pool->lock);
+	}
+	ATOMIC_SUB(pool->idle, 1);
+	pthread_mutex_unlock(&pool->lock);
+}
 
 /*!
  * \brief Worker thread.
  *
- * The thread takes a task from the tasks queue and runs it, while checking
+ * The thread takes a task from the task queues and runs it, while checking
  * if the dispatching of new tasks is allowed by the thread pool.
  *
  * An execution of a running thread cannot be enforced.
@@ -42,36 +151,37 @@ static int worker_main(dthread_t *thread)
 	assert(thread);
 
 	worker_pool_t *pool = thread->data;
+	unsigned self = dt_get_id(thread);
 
-	pthread_mutex_lock(&pool->lock);
-
-	for (;;) {
-		if (pool->terminating) {
-			break;
-		}
+	local_pool = pool;
+	local_idx = self;
 
+	while (!ATOMIC_GET(pool->terminating)) {
 		worker_task_t *task = NULL;
-		if (!pool->suspended) {
-			task = worker_queue_dequeue(&pool->tasks);
+		if (!ATOMIC_GET(pool->suspended)) {
+			task = take_task(pool, self);
 		}
 
 		if (task == NULL) {
-			pthread_cond_wait(&pool->wake, &pool->lock);
+			worker_sleep(pool);
 			continue;
 		}
 
 		assert(task->run);
-		pool->running += 1;
-
-		pthread_mutex_unlock(&pool->lock);
+		ATOMIC_ADD(pool->running, 1);
 		task->run(task);
-		pthread_mutex_lock(&pool->lock);
-
-		pool->running -= 1;
-		pthread_cond_broadcast(&pool->wake);
+		ATOMIC_SUB(pool->running, 1);
+		ATOMIC_ADD(pool->finished, 1);
+
+		ATOMIC_SUB(pool->pending, 1);
+		if (ATOMIC_GET(pool->pending) == 0) {
+			pthread_mutex_lock(&pool->lock);
+			pthread_cond_broadcast(&pool->done);
+			pthread_mutex_unlock(&pool->lock);
+		}
 	}
 
-	pthread_mutex_unlock(&pool->lock);
+	local_pool = NULL;
 
 	return KNOT_EOK;
 }
@@ -91,20 +201,46 @@ worker_pool_t *worker_pool_create(unsigned threads)
 		goto fail;
 	}
 
+	pool->queues = calloc(threads, sizeof(*pool->queues));
+	if (pool->queues == NULL) {
+		goto fail;
+	}
+	for (unsigned i = 0; i < threads; i++) {
+		pthread_mutex_init(&pool->queues[i].lock, NULL);
+		for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+			worker_queue_init(&pool->queues[i].tasks[prio]);
+			ATOMIC_INIT(pool->queues[i].length[prio], 0);
+		}
+	}
+	pool->count = threads;
+
 	if (pthread_mutex_init(&pool->lock, NULL) != 0) {
 		goto fail;
 	}
 
-	if (pthread_cond_init(&pool->wake, NULL) != 0) {
+	if (pthread_cond_init(&pool->wake, NULL) != 0 ||
+	    pthread_cond_init(&pool->done, NULL) != 0) {
 		goto fail;
 	}
 
-	worker_queue_init(&pool->tasks);
+	ATOMIC_INIT(pool->terminating, false);
+	ATOMIC_INIT(pool->suspended, false);
+	ATOMIC_INIT(pool->idle, 0);
+	ATOMIC_INIT(pool->pending, 0);
+	ATOMIC_INIT(pool->running, 0);
+	ATOMIC_INIT(pool->finished, 0);
+	ATOMIC_INIT(pool->next, 0);
+	for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+		for (unsigned i = 0; i < WORKER_WAIT_BUCKETS; i++) {
+			ATOMIC_INIT(pool->wait_hist[prio][i], 0);
+		}
+	}
 
 	return pool;
 
 fail:
 	dt_delete(&pool->threads);
+	free(pool->queues);
 	free(pool);
 	return NULL;
 }
@@ -119,8 +255,29 @@ void worker_pool_destroy(worker_pool_t *pool)
 
 	pthread_mutex_destroy(&pool->lock);
 	pthread_cond_destroy(&pool->wake);
+	pthread_cond_destroy(&pool->done);
 
-	worker_queue_deinit(&pool->tasks);
+	for (unsigned i = 0; i < pool->count; i++) {
+		pthread_mutex_destroy(&pool->queues[i].lock);
+		for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+			worker_queue_deinit(&pool->queues[i].tasks[prio]);
+			ATOMIC_DEINIT(pool->queues[i].length[prio]);
+		}
+	}
+	free(pool->queues);
+
+	ATOMIC_DEINIT(pool->terminating);
+	ATOMIC_DEINIT(pool->suspended);
+	ATOMIC_DEINIT(pool->idle);
+	ATOMIC_DEINIT(pool->pending);
+	ATOMIC_DEINIT(pool->running);
+	ATOMIC_DEINIT(pool->finished);
+	ATOMIC_DEINIT(pool->next);
+	for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+		for (unsigned i = 0; i < WORKER_WAIT_BUCKETS; i++) {
+			ATOMIC_DEINIT(pool->wait_hist[prio][i]);
+		}
+	}
 
 	free(pool);
 }
@@ -141,7 +298,7 @@ void worker_pool_stop(worker_pool_t *pool)
 	}
 
 	pthread_mutex_lock(&pool->lock);
-	pool->terminating = true;
+	ATOMIC_SET(pool->terminating, true);
 	pthread_cond_broadcast(&pool->wake);
 	pthread_mutex_unlock(&pool->lock);
 
@@ -155,7 +312,7 @@ void worker_pool_suspend(worker_pool_t *pool)
 	}
 
 	pthread_mutex_lock(&pool->lock);
-	pool->suspended = true;
+	ATOMIC_SET(pool->suspended, true);
 	pthread_mutex_unlock(&pool->lock);
 }
 
@@ -166,7 +323,7 @@ void worker_pool_resume(worker_pool_t *pool)
 	}
 
 	pthread_mutex_lock(&pool->lock);
-	pool->suspended = false;
+	ATOMIC_SET(pool->suspended, false);
 	pthread_cond_broadcast(&pool->wake);
 	pthread_mutex_unlock(&pool->lock);
 }
@@ -186,12 +343,32 @@ void worker_pool_wait_cb(worker_pool_t *pool, wait_callback_t cb)
 		return;
 	}
 
+	bool first = true;
+	size_t finished = 0;
+
 	pthread_mutex_lock(&pool->lock);
-	while (!EMPTY_LIST(pool->tasks.list) || pool->running > 0) {
-		if (cb != NULL) {
+	while (ATOMIC_GET(pool->pending) > 0) {
+		if (cb == NULL) {
+			pthread_cond_wait(&pool->done, &pool->lock);
+			continue;
+		}
+
+		// Emit the callback initially and whenever some task has finished.
+		size_t now_finished = ATOMIC_GET(pool->finished);
+		if (first || now_finished != finished) {
+			first = false;
+			finished = now_finished;
 			cb(pool);
 		}
-		pthread_cond_wait(&pool->wake, &pool->lock);
+
+		struct timespec timeout;
+		clock_gettime(CLOCK_REALTIME, &timeout);
+		timeout.tv_nsec += WAIT_CB_INTERVAL_MS * 1000000L;
+		if (timeout.tv_nsec >= 1000000000L) {
+			timeout.tv_sec += 1;
+			timeout.tv_nsec -= 1000000000L;
+		}
+		pthread_cond_timedwait(&pool->done, &pool->lock, &timeout);
 	}
 	pthread_mutex_unlock(&pool->lock);
 }
@@ -201,16 +378,42 @@ void worker_pool_wait(worker_pool_t *pool)
 	worker_pool_wait_cb(pool, NULL);
 }
 
-void worker_pool_assign(worker_pool_t *pool, struct task *task)
+int worker_pool_assign(worker_pool_t *pool, struct task *task, worker_prio_t prio)
 {
-	if (!pool || !task) {
-		return;
+	if (!pool || !task || prio >= WORKER_PRIO_COUNT) {
+		return KNOT_EINVAL;
 	}
 
-	pthread_mutex_lock(&pool->lock);
-	worker_queue_enqueue(&pool->tasks, task);
-	pthread_cond_signal(&pool->wake);
-	pthread_mutex_unlock(&pool->lock);
+	// Keep tasks assigned by a worker local, spread the other ones.
+	unsigned idx;
+	if (local_pool == pool) {
+		idx = local_idx;
+	} else {
+		// A race may only skew the distribution.
+		idx = ATOMIC_GET(pool->next);
+		ATOMIC_SET(pool->next, idx + 1);
+	}
+	worker_queues_t *queues = &pool->queues[idx % pool->count];
+
+	ATOMIC_ADD(pool->pending, 1);
+
+	pthread_mutex_lock(&queues->lock);
+	int ret = worker_queue_enqueue(&queues->tasks[prio], task);
+	ATOMIC_SET(queues->length[prio], worker_queue_length(&queues->tasks[prio]));
+	pthread_mutex_unlock(&queues->lock);
+
+	if (ret != KNOT_EOK) {
+		ATOMIC_SUB(pool->pending, 1);
+		return ret;
+	}
+
+	if (ATOMIC_GET(pool->idle) > 0) {
+		pthread_mutex_lock(&pool->lock);
+		pthread_cond_signal(&pool->wake);
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	return KNOT_EOK;
 }
 
 void worker_pool_clear(worker_pool_t *pool)
@@ -219,25 +422,48 @@ void worker_pool_clear(worker_pool_t *pool)
 		return;
 	}
 
-	pthread_mutex_lock(&pool->lock);
-	worker_queue_deinit(&pool->tasks);
-	worker_queue_init(&pool->tasks);
-	pthread_mutex_unlock(&pool->lock);
+	size_t cleared = 0;
+	for (unsigned i = 0; i < pool->count; i++) {
+		worker_queues_t *queues = &pool->queues[i];
+		pthread_mutex_lock(&queues->lock);
+		for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+			cleared += worker_queue_length(&queues->tasks[prio]);
+			worker_queue_deinit(&queues->tasks[prio]);
+			worker_queue_init(&queues->tasks[prio]);
+			ATOMIC_SET(queues->length[prio], 0);
+		}
+		pthread_mutex_unlock(&queues->lock);
+	}
+
+	ATOMIC_SUB(pool->pending, cleared);
+	if (ATOMIC_GET(pool->pending) == 0) {
+		pthread_mutex_lock(&pool->lock);
+		pthread_cond_broadcast(&pool->done);
+		pthread_mutex_unlock(&pool->lock);
+	}
 }
 
-void worker_pool_status(worker_pool_t *pool, bool locked, int *running, int *queued)
+void worker_pool_status(worker_pool_t *pool, int *running, int *queued)
 {
 	if (!pool) {
 		*running = *queued = 0;
 		return;
 	}
 
-	if (!locked) {
-		pthread_mutex_lock(&pool->lock);
+	*running = ATOMIC_GET(pool->running);
+	*queued = 0;
+	for (unsigned i = 0; i < pool->count; i++) {
+		for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+			*queued += ATOMIC_GET(pool->queues[i].length[prio]);
+		}
 	}
-	*running = pool->running;
-	*queued = worker_queue_length(&pool->tasks);
-	if (!locked) {
-		pthread_mutex_unlock(&pool->lock);
+}
+
+void worker_pool_wait_hist(worker_pool_t *pool, worker_prio_t prio,
+                           uint64_t hist[WORKER_WAIT_BUCKETS])
+{
+	for (unsigned i = 0; i < WORKER_WAIT_BUCKETS; i++) {
+		hist[i] = (pool != NULL && prio < WORKER_PRIO_COUNT) ?
+		          ATOMIC_GET(pool->wait_hist[prio][i]) : 0;
 	}
 }
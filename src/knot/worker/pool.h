@@ -6,9 +6,27 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "knot/worker/queue.h"
 
+/*!
+ * \brief Task priority classes, higher priority tasks are taken first.
+ */
+typedef enum {
+	WORKER_PRIO_HIGH = 0,
+	WORKER_PRIO_NORMAL,
+	WORKER_PRIO_COUNT
+} worker_prio_t;
+
+/*!
+ * \brief Number of queue wait time histogram buckets.
+ *
+ * The bucket i counts waits shorter than 10^i milliseconds (not counted
+ * in lower buckets), the last bucket counts all longer waits.
+ */
+#define WORKER_WAIT_BUCKETS	6
+
 struct worker_pool;
 typedef struct worker_pool worker_pool_t;
 
@@ -59,15 +77,23 @@ void worker_pool_join(worker_pool_t *pool);
 void worker_pool_wait(worker_pool_t *pool);
 
 /*!
- * \brief Wait till the number of pending tasks is zero. Callback emitted on
- *  thread wakeup can be specified.
+ * \brief Wait till the number of pending tasks is zero. Callback emitted
+ *  periodically while waiting can be specified.
  */
 void worker_pool_wait_cb(worker_pool_t *pool, wait_callback_t cb);
 
 /*!
  * \brief Assign a task to be performed by a worker in the pool.
+ *
+ * \param pool  Worker pool.
+ * \param task  Task to be performed.
+ * \param prio  Priority class of the task.
+ *
+ * \retval KNOT_EOK if the task was enqueued.
+ * \retval KNOT_EINVAL
+ * \retval KNOT_ENOMEM if the queue can't grow, the task won't be performed.
  */
-void worker_pool_assign(worker_pool_t *pool, struct task *task);
+int worker_pool_assign(worker_pool_t *pool, struct task *task, worker_prio_t prio);
 
 /*!
  * \brief Clear all tasks enqueued in pool processing queue.
@@ -76,7 +102,15 @@ void worker_pool_clear(worker_pool_t *pool);
 
 /*!
  * \brief Obtain info regarding how the pool is busy.
+ */
+void worker_pool_status(worker_pool_t *pool, int *running, int *queued);
+
+/*!
+ * \brief Obtain the histogram of task queue wait times.
  *
- * \note Locked means if the mutex `pool->lock` is locked.
+ * \param pool  Worker pool.
+ * \param prio  Priority class.
+ * \param hist  Output histogram, see WORKER_WAIT_BUCKETS.
  */
-void worker_pool_status(worker_pool_t *pool, bool locked, int *running, int *queued);
+void worker_pool_wait_hist(worker_pool_t *pool, worker_prio_t prio,
+                           uint64_t hist[WORKER_WAIT_BUCKETS]);
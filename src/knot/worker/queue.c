@@ -3,8 +3,14 @@
  *  For more information, see <https://www.knot-dns.cz/>
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "knot/worker/queue.h"
-#include "contrib/mempattern.h"
+#include "contrib/time.h"
+#include "libknot/errcode.h"
+
+#define QUEUE_MIN_CAPACITY	16
 
 void worker_queue_init(worker_queue_t *queue)
 {
@@ -13,44 +19,75 @@ void worker_queue_init(worker_queue_t *queue)
 	}
 
 	memset(queue, 0, sizeof(worker_queue_t));
-
-	init_list(&queue->list);
-	mm_ctx_init(&queue->mm_ctx);
 }
 
 void worker_queue_deinit(worker_queue_t *queue)
 {
-	ptrlist_free(&queue->list, &queue->mm_ctx);
+	if (!queue) {
+		return;
+	}
+
+	free(queue->items);
+	memset(queue, 0, sizeof(worker_queue_t));
 }
 
-void worker_queue_enqueue(worker_queue_t *queue, worker_task_t *task)
+static int queue_grow(worker_queue_t *queue)
+{
+	size_t capacity = queue->capacity > 0 ? 2 * queue->capacity : QUEUE_MIN_CAPACITY;
+	worker_queue_item_t *items = malloc(capacity * sizeof(*items));
+	if (items == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	// Unwrap the ring into the new array.
+	for (size_t i = 0; i < queue->count; i++) {
+		items[i] = queue->items[(queue->head + i) % queue->capacity];
+	}
+
+	free(queue->items);
+	queue->items = items;
+	queue->capacity = capacity;
+	queue->head = 0;
+
+	return KNOT_EOK;
+}
+
+int worker_queue_enqueue(worker_queue_t *queue, worker_task_t *task)
 {
 	if (!queue || !task) {
-		return;
+		return KNOT_EINVAL;
+	}
+
+	if (queue->count == queue->capacity && queue_grow(queue) != KNOT_EOK) {
+		return KNOT_ENOMEM;
 	}
 
-	ptrlist_add(&queue->list, task, &queue->mm_ctx);
+	worker_queue_item_t *item = &queue->items[(queue->head + queue->count) % queue->capacity];
+	item->task = task;
+	item->since = time_now();
+	queue->count++;
+
+	return KNOT_EOK;
 }
 
-worker_task_t *worker_queue_dequeue(worker_queue_t *queue)
+worker_task_t *worker_queue_dequeue(worker_queue_t *queue, struct timespec *since)
 {
-	if (!queue) {
+	if (!queue || queue->count == 0) {
 		return NULL;
 	}
 
-	worker_task_t *task = NULL;
+	worker_queue_item_t *item = &queue->items[queue->head];
+	queue->head = (queue->head + 1) % queue->capacity;
+	queue->count--;
 
-	if (!EMPTY_LIST(queue->list)) {
-		ptrnode_t *node = HEAD(queue->list);
-		task = (void *)node->d;
-		rem_node(&node->n);
-		queue->mm_ctx.free(&node->n);
+	if (since != NULL) {
+		*since = item->since;
 	}
 
-	return task;
+	return item->task;
 }
 
 size_t worker_queue_length(worker_queue_t *queue)
 {
-	return queue ? list_size(&queue->list) : 0;
+	return queue ? queue->count : 0;
 }
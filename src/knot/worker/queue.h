@@ -5,7 +5,8 @@
 
 #pragma once
 
-#include "contrib/ucw/lists.h"
+#include <stddef.h>
+#include <time.h>
 
 struct task;
 typedef void (*task_cb)(struct task *);
@@ -19,11 +20,21 @@ typedef struct task {
 } worker_task_t;
 
 /*!
- * \brief Worker queue.
+ * \brief Queued task with its enqueue time.
+ */
+typedef struct {
+	worker_task_t *task;
+	struct timespec since;
+} worker_queue_item_t;
+
+/*!
+ * \brief Worker queue (FIFO ring buffer growing on demand).
  */
 typedef struct worker_queue {
-	knot_mm_t mm_ctx;
-	list_t list;
+	worker_queue_item_t *items;
+	size_t capacity;
+	size_t head;
+	size_t count;
 } worker_queue_t;
 
 /*!
@@ -38,15 +49,20 @@ void worker_queue_deinit(worker_queue_t *queue);
 
 /*!
  * \brief Insert new item into the queue.
+ *
+ * \return KNOT_EOK, KNOT_ENOMEM.
  */
-void worker_queue_enqueue(worker_queue_t *queue, worker_task_t *task);
+int worker_queue_enqueue(worker_queue_t *queue, worker_task_t *task);
 
 /*!
  * \brief Remove item from the queue.
  *
+ * \param queue  Queue.
+ * \param since  Optional output of the time the task was enqueued.
+ *
  * \return Task or NULL if the queue is empty.
  */
-worker_task_t *worker_queue_dequeue(worker_queue_t *queue);
+worker_task_t *worker_queue_dequeue(worker_queue_t *queue, struct timespec *since);
 
 /*!
  * \brief Return number of tasks in worker queue.
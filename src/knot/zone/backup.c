@@ -326,7 +326,7 @@ static int backup_zonefile(conf_t *conf, zone_t *zone, zone_backup_ctx_t *ctx)
 		if (ret == KNOT_EOK) {
 			if (can_flush) {
 				if (zone->contents != NULL) {
-					ret = zonefile_write_skip(backup_zf, zone->contents, conf);
+					ret = zonefile_write_skip(backup_zf, zone->contents, conf, NULL);
 				} else {
 					log_zone_notice(zone->name,
 					                "empty zone, skipping a zone file backup");
@@ -11,6 +11,10 @@
 #include "knot/zone/contents.h"
 #include "knot/common/log.h"
 #include "knot/dnssec/zone-nsec.h"
+#include "knot/nameserver/answer_cache.h"
+#include "knot/nameserver/axfr_cache.h"
+#include "knot/nameserver/ixfr_cache.h"
+#include "knot/zone/nsec3_cache.h"
 #include "libknot/libknot.h"
 #include "contrib/qp-trie/trie.h"
 
@@ -344,11 +348,52 @@ const zone_node_t *zone_contents_find_nsec3_node(const zone_contents_t *zone,
 	return get_nsec3_node(zone, name);
 }
 
+static int nsec3_owner(const zone_contents_t *zone, const knot_dname_t *name,
+                       uint8_t *out, size_t out_size, bool *cache_hit)
+{
+	if (zone->nsec3_cache == NULL) {
+		return knot_create_nsec3_owner(out, out_size, name, zone->apex->owner,
+		                               &zone->nsec3_params);
+	}
+
+	uint8_t hash[NSEC3_CACHE_MAX_HASH];
+	size_t hash_len = nsec3_cache_get(zone->nsec3_cache, name, hash, sizeof(hash));
+	if (hash_len > 0) {
+		if (cache_hit != NULL) {
+			*cache_hit = true;
+		}
+		return knot_nsec3_hash_to_dname(out, out_size, hash, hash_len,
+		                                zone->apex->owner);
+	}
+
+	dnssec_binary_t data = {
+		.data = (uint8_t *)name,
+		.size = knot_dname_size(name)
+	};
+	dnssec_binary_t computed = { 0 };
+	int ret = dnssec_nsec3_hash(&data, &zone->nsec3_params, &computed);
+	if (ret != DNSSEC_EOK) {
+		return knot_error_from_libdnssec(ret);
+	}
+
+	nsec3_cache_put(zone->nsec3_cache, name, computed.data, computed.size);
+	ret = knot_nsec3_hash_to_dname(out, out_size, computed.data, computed.size,
+	                               zone->apex->owner);
+	dnssec_binary_free(&computed);
+
+	return ret;
+}
+
 int zone_contents_find_nsec3_for_name(const zone_contents_t *zone,
                                       const knot_dname_t *name,
                                       const zone_node_t **nsec3_node,
-                                      const zone_node_t **nsec3_previous)
+                                      const zone_node_t **nsec3_previous,
+                                      bool *cache_hit)
 {
+	if (cache_hit != NULL) {
+		*cache_hit = false;
+	}
+
 	if (name == NULL || nsec3_node == NULL || nsec3_previous == NULL) {
 		return KNOT_EINVAL;
 	}
@@ -366,8 +411,7 @@ int zone_contents_find_nsec3_for_name(const zone_contents_t *zone,
 	}
 
 	knot_dname_storage_t nsec3_name;
-	int ret = knot_create_nsec3_owner(nsec3_name, sizeof(nsec3_name),
-	                                  name, zone->apex->owner, &zone->nsec3_params);
+	int ret = nsec3_owner(zone, name, nsec3_name, sizeof(nsec3_name), cache_hit);
 	if (ret != KNOT_EOK) {
 		return ret;
 	}
@@ -506,12 +550,18 @@ void zone_contents_free(zone_contents_t *contents)
 		return;
 	}
 
+	// the cached messages refer to the zone trees
+	axfr_cache_unref(contents->axfr_cache);
+
 	// free the zone tree, but only the structure
 	zone_tree_free(&contents->nodes);
 	zone_tree_free(&contents->nsec3_nodes);
 
 	dnssec_nsec3_params_free(&contents->nsec3_params);
 	additionals_tree_free(contents->adds_tree);
+	answer_cache_free(contents->answer_cache);
+	ixfr_cache_free(contents->ixfr_cache);
+	nsec3_cache_free(contents->nsec3_cache);
 
 	ATOMIC_DEINIT(contents->dnssec_expire);
 	pthread_rwlock_destroy(&contents->xfrout_lock);
@@ -574,6 +624,10 @@ int zone_contents_load_nsec3param(zone_contents_t *contents)
 		return KNOT_EINVAL;
 	}
 
+	// Cached NSEC3 hashes are bound to the parameters.
+	nsec3_cache_free(contents->nsec3_cache);
+	contents->nsec3_cache = NULL;
+
 	const knot_rdataset_t *rrs = NULL;
 	rrs = node_rdataset(contents->apex, KNOT_RRTYPE_NSEC3PARAM);
 	if (rrs == NULL) {
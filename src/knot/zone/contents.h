@@ -26,6 +26,11 @@ typedef struct zone_contents {
 
 	trie_t *adds_tree; // "additionals tree" for reverse lookup of nodes affected by additionals
 
+	struct answer_cache *answer_cache; /*!< Optional cache of rendered answers. */
+	struct axfr_cache *axfr_cache;     /*!< Optional cache of rendered AXFR messages. */
+	struct ixfr_cache *ixfr_cache;     /*!< Optional cache of rendered IXFR messages. */
+	struct nsec3_cache *nsec3_cache;   /*!< Optional cache of NSEC3 hashes. */
+
 	// Responding normal queries is protected by rcu_read_lock, but for long
 	// outgoing XFRs, zone-specific lock is better.
 	pthread_rwlock_t xfrout_lock;
@@ -149,7 +154,8 @@ const zone_node_t *zone_contents_find_nsec3_node(const zone_contents_t *contents
  *        corresponding to the given domain name.
  *
  * This functions creates a NSEC3 hash of \a name and tries to find NSEC3 node
- * with the hashed domain name as owner.
+ * with the hashed domain name as owner. If the contents have an NSEC3 hash
+ * cache, the hash is looked up there first.
  *
  * \param[in] contents Zone to search in.
  * \param[in] name Domain name to get the corresponding NSEC3 nodes for.
@@ -157,6 +163,7 @@ const zone_node_t *zone_contents_find_nsec3_node(const zone_contents_t *contents
  *                        otherwise this may be an arbitrary NSEC3 node).
  * \param[out] nsec3_previous The NSEC3 node immediately preceding hashed domain
  *                            name corresponding to \a name in canonical order.
+ * \param[out] cache_hit Optional indication whether the hash was cached.
  *
  * \retval ZONE_NAME_FOUND if the corresponding NSEC3 node was found.
  * \retval ZONE_NAME_NOT_FOUND if it was not found.
@@ -169,7 +176,8 @@ const zone_node_t *zone_contents_find_nsec3_node(const zone_contents_t *contents
 int zone_contents_find_nsec3_for_name(const zone_contents_t *contents,
                                       const knot_dname_t *name,
                                       const zone_node_t **nsec3_node,
-                                      const zone_node_t **nsec3_previous);
+                                      const zone_node_t **nsec3_previous,
+                                      bool *cache_hit);
 
 /*!
  * \brief Finds NSEC3 node and previous NSEC3 node to specified NSEC3 name.
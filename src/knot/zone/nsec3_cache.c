@@ -0,0 +1,124 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/zone/nsec3_cache.h"
+#include "libdnssec/random.h"
+#include "contrib/openbsd/siphash.h"
+#include "contrib/spinlock.h"
+
+typedef struct {
+	uint8_t name_len;
+	uint8_t hash_len;
+	uint8_t data[]; // Name followed by the hash.
+} cache_entry_t;
+
+typedef struct {
+	knot_spin_t lock;
+	cache_entry_t *entry;
+} cache_slot_t;
+
+struct nsec3_cache {
+	SIPHASH_KEY hash_key;
+	size_t size;
+	cache_slot_t slots[];
+};
+
+static cache_slot_t *get_slot(nsec3_cache_t *cache, const knot_dname_t *name,
+                              size_t name_len)
+{
+	SIPHASH_CTX hash;
+	SipHash24_Init(&hash, &cache->hash_key);
+	SipHash24_Update(&hash, name, name_len);
+	uint64_t idx = SipHash24_End(&hash) % cache->size;
+
+	return &cache->slots[idx];
+}
+
+nsec3_cache_t *nsec3_cache_new(size_t slots)
+{
+	if (slots == 0) {
+		return NULL;
+	}
+
+	nsec3_cache_t *cache = calloc(1, sizeof(*cache) + slots * sizeof(cache_slot_t));
+	if (cache == NULL) {
+		return NULL;
+	}
+
+	(void)dnssec_random_buffer((uint8_t *)&cache->hash_key, sizeof(cache->hash_key));
+	cache->size = slots;
+	for (size_t i = 0; i < slots; i++) {
+		knot_spin_init(&cache->slots[i].lock);
+	}
+
+	return cache;
+}
+
+void nsec3_cache_free(nsec3_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < cache->size; i++) {
+		knot_spin_destroy(&cache->slots[i].lock);
+		free(cache->slots[i].entry);
+	}
+	free(cache);
+}
+
+size_t nsec3_cache_get(nsec3_cache_t *cache, const knot_dname_t *name,
+                       uint8_t *hash, size_t max_len)
+{
+	assert(cache && name && hash);
+
+	size_t name_len = knot_dname_size(name);
+	cache_slot_t *slot = get_slot(cache, name, name_len);
+	size_t len = 0;
+
+	knot_spin_lock(&slot->lock);
+	cache_entry_t *entry = slot->entry;
+	if (entry != NULL && entry->name_len == name_len && entry->hash_len <= max_len &&
+	    memcmp(entry->data, name, name_len) == 0) {
+		len = entry->hash_len;
+		memcpy(hash, entry->data + name_len, len);
+	}
+	knot_spin_unlock(&slot->lock);
+
+	return len;
+}
+
+void nsec3_cache_put(nsec3_cache_t *cache, const knot_dname_t *name,
+                     const uint8_t *hash, size_t hash_len)
+{
+	assert(cache && name && hash);
+
+	size_t name_len = knot_dname_size(name);
+	if (name_len > KNOT_DNAME_MAXLEN || hash_len > NSEC3_CACHE_MAX_HASH) {
+		return;
+	}
+
+	cache_entry_t *entry = malloc(sizeof(*entry) + name_len + hash_len);
+	if (entry == NULL) {
+		return;
+	}
+	entry->name_len = name_len;
+	entry->hash_len = hash_len;
+	memcpy(entry->data, name, name_len);
+	memcpy(entry->data + name_len, hash, hash_len);
+
+	cache_slot_t *slot = get_slot(cache, name, name_len);
+
+	knot_spin_lock(&slot->lock);
+	cache_entry_t *old = slot->entry;
+	slot->entry = entry;
+	knot_spin_unlock(&slot->lock);
+
+	free(old);
+}
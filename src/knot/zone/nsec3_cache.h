@@ -0,0 +1,64 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libknot/dname.h"
+
+/*! \brief Default number of slots of the per-contents NSEC3 hash cache. */
+#define NSEC3_CACHE_SLOTS 1024
+
+/*! \brief Maximal size of a cached NSEC3 hash. */
+#define NSEC3_CACHE_MAX_HASH 64
+
+/*!
+ * \brief Cache of NSEC3 hashes of domain names bound to one version of zone
+ *        contents (and thus to one set of NSEC3 parameters).
+ *
+ * The cache is a fixed-size hash table, a colliding entry replaces the
+ * previous one. Concurrent readers and writers are allowed.
+ */
+typedef struct nsec3_cache nsec3_cache_t;
+
+/*!
+ * \brief Create an NSEC3 hash cache.
+ *
+ * \param slots  Number of cache slots.
+ *
+ * \return New cache or NULL if no memory.
+ */
+nsec3_cache_t *nsec3_cache_new(size_t slots);
+
+/*!
+ * \brief Free the NSEC3 hash cache.
+ */
+void nsec3_cache_free(nsec3_cache_t *cache);
+
+/*!
+ * \brief Look up a cached NSEC3 hash.
+ *
+ * \param cache    NSEC3 hash cache.
+ * \param name     Hashed domain name.
+ * \param hash     Output buffer for the raw hash.
+ * \param max_len  Output buffer size.
+ *
+ * \return Hash size, 0 if not found or doesn't fit.
+ */
+size_t nsec3_cache_get(nsec3_cache_t *cache, const knot_dname_t *name,
+                       uint8_t *hash, size_t max_len);
+
+/*!
+ * \brief Store an NSEC3 hash into the cache.
+ *
+ * \param cache     NSEC3 hash cache.
+ * \param name      Hashed domain name.
+ * \param hash      Raw hash to be stored.
+ * \param hash_len  Hash size.
+ */
+void nsec3_cache_put(nsec3_cache_t *cache, const knot_dname_t *name,
+                     const uint8_t *hash, size_t hash_len);
@@ -3,18 +3,24 @@
  *  For more information, see <https://www.knot-dns.cz/>
  */
 
+#include <pthread.h>
 #include <stdio.h>
 
 #include "knot/zone/semantic-check.h"
 
 #include "libdnssec/error.h"
 #include "libdnssec/key.h"
+#include "contrib/spinlock.h"
 #include "contrib/string.h"
 #include "libknot/libknot.h"
 #include "knot/dnssec/key-events.h"
 #include "knot/dnssec/zone-keys.h"
+#include "knot/server/dthreads.h"
 #include "knot/updates/zone-update.h"
 
+#define CHECK_PARTS_PER_THREAD 8
+#define CHECK_PART_NODES_MIN 4096 // Don't bother with threads for smaller zones.
+
 static const char *error_messages[SEM_ERR_UNKNOWN + 1] = {
 	[SEM_ERR_SOA_NONE] =
 	"missing SOA at the zone apex",
@@ -482,6 +488,207 @@ static int do_checks_in_tree(zone_node_t *node, void *data)
 	return ret;
 }
 
+/*! \brief Error reported by a check, kept until it's passed to the handler. */
+typedef struct {
+	knot_dname_t *owner;
+	sem_error_t code;
+	bool error;
+	char *data;
+} check_record_t;
+
+/*! \brief Errors found in one part of the zone tree, in the node order. */
+typedef struct {
+	check_record_t *records;
+	size_t count;
+	size_t capacity;
+	int ret;
+} check_part_t;
+
+/*! \brief Per-thread handler buffering the errors of the part being checked. */
+typedef struct {
+	sem_handler_t handler; // Must be the first member.
+	check_part_t *part;
+} check_buffer_t;
+
+typedef struct {
+	semchecks_data_t data;
+	check_buffer_t buffer;
+	zone_tree_t *tree;
+	trie_part_t **tree_parts;
+	check_part_t *parts;
+	size_t count;
+	size_t *next;
+	knot_spin_t *lock;
+	pthread_t thread;
+	int thread_ret;
+} check_thread_t;
+
+static void buffer_error(sem_handler_t *handler, const zone_contents_t *zone,
+                         const knot_dname_t *node, sem_error_t error, const char *data)
+{
+	check_buffer_t *buffer = (check_buffer_t *)handler;
+	check_part_t *part = buffer->part;
+
+	bool error_flag = handler->error;
+	handler->error = false;
+
+	if (part->count == part->capacity) {
+		size_t capacity = (part->capacity == 0) ? 16 : 2 * part->capacity;
+		check_record_t *records = realloc(part->records, capacity * sizeof(*records));
+		if (records == NULL) {
+			part->ret = KNOT_ENOMEM;
+			return;
+		}
+		part->records = records;
+		part->capacity = capacity;
+	}
+
+	check_record_t *rec = &part->records[part->count];
+	rec->owner = (node != NULL) ? knot_dname_copy(node, NULL) : NULL;
+	rec->data = (data != NULL) ? strdup(data) : NULL;
+	if ((node != NULL && rec->owner == NULL) || (data != NULL && rec->data == NULL)) {
+		knot_dname_free(rec->owner, NULL);
+		free(rec->data);
+		part->ret = KNOT_ENOMEM;
+		return;
+	}
+	rec->code = error;
+	rec->error = error_flag;
+	part->count++;
+}
+
+static bool take_part(check_thread_t *thr, size_t *part)
+{
+	knot_spin_lock(thr->lock);
+	*part = (*thr->next)++;
+	knot_spin_unlock(thr->lock);
+
+	return *part < thr->count;
+}
+
+static void *check_thread(void *ctx)
+{
+	check_thread_t *thr = ctx;
+
+	size_t idx;
+	while (take_part(thr, &idx)) {
+		check_part_t *part = &thr->parts[idx];
+		thr->buffer.part = part;
+		int ret = zone_tree_part_apply(thr->tree, thr->tree_parts[idx],
+		                               do_checks_in_tree, &thr->data);
+		if (part->ret == KNOT_EOK) {
+			part->ret = ret;
+		}
+	}
+
+	return NULL;
+}
+
+/*!
+ * \brief Run the node checks over parts of the zone tree in parallel.
+ *
+ * The errors are buffered per part and passed to the handler afterwards in
+ * the order of the parts, so the handler sees exactly the same sequence of
+ * errors as with the sequential checks.
+ */
+static int check_nodes_parallel(semchecks_data_t *data, trie_part_t **tree_parts,
+                                size_t count, size_t threads)
+{
+	check_part_t *parts = calloc(count, sizeof(*parts));
+	check_thread_t *thrs = calloc(threads, sizeof(*thrs));
+	if (parts == NULL || thrs == NULL) {
+		free(parts);
+		free(thrs);
+		return KNOT_ENOMEM;
+	}
+
+	size_t next = 0;
+	knot_spin_t lock;
+	knot_spin_init(&lock);
+
+	for (size_t i = 0; i < threads; i++) {
+		check_thread_t *thr = &thrs[i];
+		thr->buffer.handler.cb = buffer_error;
+		thr->buffer.handler.soft_check = data->handler->soft_check;
+		thr->data = *data;
+		thr->data.handler = &thr->buffer.handler;
+		thr->tree = data->zone->nodes;
+		thr->tree_parts = tree_parts;
+		thr->parts = parts;
+		thr->count = count;
+		thr->next = &next;
+		thr->lock = &lock;
+		thr->thread_ret = pthread_create(&thr->thread, NULL, check_thread, thr);
+	}
+
+	int ret = KNOT_EOK;
+	for (size_t i = 0; i < threads; i++) {
+		if (thrs[i].thread_ret == 0) {
+			thrs[i].thread_ret = pthread_join(thrs[i].thread, NULL);
+		}
+		if (thrs[i].thread_ret != 0 && ret == KNOT_EOK) {
+			ret = knot_map_errno_code(thrs[i].thread_ret);
+		}
+	}
+
+	sem_handler_t *handler = data->handler;
+	for (size_t i = 0; i < count; i++) {
+		check_part_t *part = &parts[i];
+		for (size_t j = 0; j < part->count; j++) {
+			check_record_t *rec = &part->records[j];
+			if (ret == KNOT_EOK) {
+				handler->error = handler->error || rec->error;
+				handler->cb(handler, data->zone, rec->owner, rec->code, rec->data);
+			}
+			knot_dname_free(rec->owner, NULL);
+			free(rec->data);
+		}
+		free(part->records);
+		if (ret == KNOT_EOK) {
+			ret = part->ret; // The sequential checks would stop here too.
+		}
+	}
+
+	// Errors of the soft checks aren't fatal, see do_checks_in_tree().
+	if (data->level & SOFT) {
+		handler->fatal_error = false;
+	}
+
+	knot_spin_destroy(&lock);
+	free(parts);
+	free(thrs);
+
+	return ret;
+}
+
+static int check_nodes(semchecks_data_t *data, uint16_t threads)
+{
+	zone_tree_t *tree = data->zone->nodes;
+	size_t nthreads = (threads == 0) ? dt_optimal_size() : threads;
+	nthreads = MIN(nthreads, zone_tree_count(tree) / CHECK_PART_NODES_MIN);
+	if (nthreads <= 1) {
+		return zone_contents_apply(data->zone, do_checks_in_tree, data);
+	}
+
+	size_t max_parts = nthreads * CHECK_PARTS_PER_THREAD * 2;
+	trie_part_t **tree_parts = malloc(max_parts * sizeof(*tree_parts));
+	if (tree_parts == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	int ret;
+	size_t count = zone_tree_split(tree, tree_parts, max_parts,
+	                               nthreads * CHECK_PARTS_PER_THREAD);
+	if (count <= 1) {
+		ret = zone_contents_apply(data->zone, do_checks_in_tree, data);
+	} else {
+		ret = check_nodes_parallel(data, tree_parts, count, MIN(nthreads, count));
+	}
+	free(tree_parts);
+
+	return ret;
+}
+
 static sem_error_t err_dnssec2sem(int ret, uint16_t rrtype, char *info, size_t len)
 {
 	char type_str[16];
@@ -572,7 +779,7 @@ int sem_checks_process(zone_contents_t *zone, semcheck_optional_t optional, sem_
 		break;
 	}
 
-	int ret = zone_contents_apply(zone, do_checks_in_tree, &data);
+	int ret = check_nodes(&data, threads);
 	if (ret != KNOT_EOK) {
 		return ret;
 	}
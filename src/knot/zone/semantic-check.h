@@ -100,7 +100,7 @@ struct sem_handler {
  * \param optional  To do also optional check.
  * \param handler   Semantic error handler.
  * \param time      Check zone at given time (rrsig expiration).
- * \param threads   The number of threads used for DNSSEC validation.
+ * \param threads   The number of threads used for the checks (0 for automatic).
  *
  * \retval KNOT_EOK         no error found
  * \retval KNOT_ESEMCHECK   found semantic error
@@ -96,13 +96,14 @@ int zone_skip_from_conf(zone_skip_t *skip, conf_val_t *val)
 	return ret;
 }
 
-int zonefile_write_skip(const char *path, struct zone_contents *zone, conf_t *conf)
+int zonefile_write_skip(const char *path, struct zone_contents *zone, conf_t *conf,
+                        uint64_t *written)
 {
 	conf_val_t skip_val = conf_zone_get(conf, C_ZONEFILE_SKIP, zone->apex->owner);
 	zone_skip_t skip = { 0 };
 	int ret = zone_skip_from_conf(&skip, &skip_val);
 	if (ret == KNOT_EOK) {
-		ret = zonefile_write(path, zone, &skip);
+		ret = zonefile_write(path, zone, &skip, written);
 	}
 	zone_skip_free(&skip);
 	return ret;
@@ -49,5 +49,8 @@ inline static void zone_skip_free(zone_skip_t *skip)
 
 /*!
  * \brief Read from conf what should be skipped and write zone file to given path.
+ *
+ * \param written  Optional output of the zone file size.
  */
-int zonefile_write_skip(const char *path, struct zone_contents *zone, conf_t *conf);
+int zonefile_write_skip(const char *path, struct zone_contents *zone, conf_t *conf,
+                        uint64_t *written);
@@ -0,0 +1,374 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "knot/zone/snapshot.h"
+#include "contrib/files.h"
+#include "contrib/openbsd/siphash.h"
+#include "contrib/string.h"
+#include "libknot/libknot.h"
+
+#define SNAPSHOT_MAGIC    "KNOTSNAP"
+#define SNAPSHOT_VERSION  1
+#define SNAPSHOT_BOM      0x01020304
+#define SNAPSHOT_ALIGN    8
+
+/*! \brief Snapshot file header (host byte order). */
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t bom;             /*!< Byte order mark. */
+	uint64_t source_size;     /*!< Size of the zone file. */
+	int64_t source_sec;       /*!< Mtime of the zone file. */
+	int64_t source_nsec;
+	uint32_t serial;          /*!< SOA serial (informative). */
+	uint32_t reserved;
+	uint64_t payload_size;    /*!< Size of data following the header. */
+	uint64_t checksum;        /*!< SipHash of the payload. */
+} snapshot_hdr_t;
+
+/*
+ * The payload is a sequence of nodes:
+ *   owner (wire format), RR set count (uint16_t), RR sets
+ * Each RR set is stored as:
+ *   type (uint16_t), TTL (uint32_t), rdata count (uint16_t),
+ *   rdata size (uint32_t), padding to SNAPSHOT_ALIGN, knot_rdata_t array,
+ *   padding to SNAPSHOT_ALIGN
+ */
+
+static const SIPHASH_KEY checksum_key = { 0 };
+
+static uint64_t payload_checksum(const uint8_t *data, size_t size)
+{
+	SIPHASH_CTX ctx;
+	SipHash24_Init(&ctx, &checksum_key);
+	SipHash24_Update(&ctx, data, size);
+	return SipHash24_End(&ctx);
+}
+
+static size_t pad_size(size_t offset)
+{
+	return (SNAPSHOT_ALIGN - (offset % SNAPSHOT_ALIGN)) % SNAPSHOT_ALIGN;
+}
+
+char *zone_snapshot_path(const char *zonefile)
+{
+	if (zonefile == NULL) {
+		return NULL;
+	}
+
+	return sprintf_alloc("%s%s", zonefile, ZONE_SNAPSHOT_SUFFIX);
+}
+
+bool zone_snapshot_probe(const char *path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	// Don't consume data from non-seekable inputs like stdin.
+	struct stat st;
+	char magic[sizeof(SNAPSHOT_MAGIC) - 1];
+	bool match = (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+	              read(fd, magic, sizeof(magic)) == sizeof(magic) &&
+	              memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0);
+	close(fd);
+
+	return match;
+}
+
+typedef struct {
+	FILE *file;
+	zone_skip_t *skip;
+	SIPHASH_CTX checksum;
+	uint64_t size;
+} snapshot_writer_t;
+
+static bool write_data(snapshot_writer_t *w, const void *data, size_t size)
+{
+	if (size == 0) {
+		return true;
+	}
+
+	SipHash24_Update(&w->checksum, data, size);
+	w->size += size;
+
+	return fwrite(data, size, 1, w->file) == 1;
+}
+
+static bool write_padding(snapshot_writer_t *w)
+{
+	static const uint8_t zero[SNAPSHOT_ALIGN] = { 0 };
+
+	return write_data(w, zero, pad_size(sizeof(snapshot_hdr_t) + w->size));
+}
+
+static int write_node(zone_node_t *node, void *data)
+{
+	snapshot_writer_t *w = data;
+
+	uint16_t count = 0;
+	for (uint16_t i = 0; i < node->rrset_count; i++) {
+		if (!zone_skip_type(w->skip, node->rrs[i].type)) {
+			count++;
+		}
+	}
+	if (count == 0) {
+		return KNOT_EOK;
+	}
+
+	if (!write_data(w, node->owner, knot_dname_size(node->owner)) ||
+	    !write_data(w, &count, sizeof(count))) {
+		return KNOT_EFILE;
+	}
+
+	for (uint16_t i = 0; i < node->rrset_count; i++) {
+		knot_rrset_t rrset = node_rrset_at(node, i);
+		if (zone_skip_type(w->skip, rrset.type)) {
+			continue;
+		}
+
+		if (!write_data(w, &rrset.type, sizeof(rrset.type)) ||
+		    !write_data(w, &rrset.ttl, sizeof(rrset.ttl)) ||
+		    !write_data(w, &rrset.rrs.count, sizeof(rrset.rrs.count)) ||
+		    !write_data(w, &rrset.rrs.size, sizeof(rrset.rrs.size)) ||
+		    !write_padding(w) ||
+		    !write_data(w, rrset.rrs.rdata, rrset.rrs.size) ||
+		    !write_padding(w)) {
+			return KNOT_EFILE;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+int zone_snapshot_write(const char *path, zone_contents_t *contents,
+                        zone_skip_t *skip, const char *zonefile)
+{
+	if (path == NULL || contents == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	snapshot_hdr_t hdr = {
+		.magic = SNAPSHOT_MAGIC,
+		.version = SNAPSHOT_VERSION,
+		.bom = SNAPSHOT_BOM,
+		.serial = zone_contents_serial(contents),
+	};
+
+	if (zonefile != NULL) {
+		struct stat st;
+		if (stat(zonefile, &st) != 0) {
+			return knot_map_errno();
+		}
+		hdr.source_size = st.st_size;
+		hdr.source_sec = st.st_mtim.tv_sec;
+		hdr.source_nsec = st.st_mtim.tv_nsec;
+	}
+
+	snapshot_writer_t w = { .skip = skip };
+	char *tmp_name = NULL;
+	int ret = open_tmp_file(path, &tmp_name, &w.file, S_IRUSR | S_IWUSR |
+	                                                  S_IRGRP | S_IWGRP);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	SipHash24_Init(&w.checksum, &checksum_key);
+
+	// Placeholder header, rewritten when the payload is complete.
+	if (fwrite(&hdr, sizeof(hdr), 1, w.file) != 1) {
+		ret = KNOT_EFILE;
+	}
+	if (ret == KNOT_EOK) {
+		ret = zone_tree_apply(contents->nodes, write_node, &w);
+	}
+	if (ret == KNOT_EOK) {
+		ret = zone_tree_apply(contents->nsec3_nodes, write_node, &w);
+	}
+	if (ret == KNOT_EOK) {
+		hdr.payload_size = w.size;
+		hdr.checksum = SipHash24_End(&w.checksum);
+		if (fseek(w.file, 0, SEEK_SET) != 0 ||
+		    fwrite(&hdr, sizeof(hdr), 1, w.file) != 1 ||
+		    fflush(w.file) != 0) {
+			ret = KNOT_EFILE;
+		}
+	}
+
+	fclose(w.file);
+	if (ret == KNOT_EOK && rename(tmp_name, path) != 0) {
+		ret = knot_map_errno();
+	}
+	if (ret != KNOT_EOK) {
+		unlink(tmp_name);
+	}
+	free(tmp_name);
+
+	return ret;
+}
+
+static int load_payload(zone_contents_t *contents, zone_skip_t *skip,
+                        const uint8_t *pos, const uint8_t *end)
+{
+	const uint8_t *base = pos - sizeof(snapshot_hdr_t);
+
+	while (pos < end) {
+		int owner_len = knot_dname_wire_check(pos, end, NULL);
+		if (owner_len <= 0 || end - pos < owner_len + sizeof(uint16_t)) {
+			return KNOT_EMALF;
+		}
+		const knot_dname_t *owner = pos;
+		pos += owner_len;
+
+		uint16_t count;
+		memcpy(&count, pos, sizeof(count));
+		pos += sizeof(count);
+
+		for (uint16_t i = 0; i < count; i++) {
+			knot_rrset_t rrset;
+			knot_rrset_init(&rrset, (knot_dname_t *)owner, 0, KNOT_CLASS_IN, 0);
+
+			const size_t meta_len = sizeof(rrset.type) + sizeof(rrset.ttl) +
+			                        sizeof(rrset.rrs.count) + sizeof(rrset.rrs.size);
+			if (end - pos < meta_len) {
+				return KNOT_EMALF;
+			}
+			memcpy(&rrset.type, pos, sizeof(rrset.type));
+			pos += sizeof(rrset.type);
+			memcpy(&rrset.ttl, pos, sizeof(rrset.ttl));
+			pos += sizeof(rrset.ttl);
+			memcpy(&rrset.rrs.count, pos, sizeof(rrset.rrs.count));
+			pos += sizeof(rrset.rrs.count);
+			memcpy(&rrset.rrs.size, pos, sizeof(rrset.rrs.size));
+			pos += sizeof(rrset.rrs.size);
+			pos += pad_size(pos - base);
+
+			// The rdata array is aligned and can be used in place.
+			if (rrset.rrs.count == 0 || pos > end || end - pos < rrset.rrs.size) {
+				return KNOT_EMALF;
+			}
+			rrset.rrs.rdata = (knot_rdata_t *)pos;
+
+			const uint8_t *rdata_end = pos + rrset.rrs.size;
+			knot_rdata_t *rdata = rrset.rrs.rdata;
+			for (uint16_t j = 0; j < rrset.rrs.count; j++) {
+				if ((uint8_t *)rdata + sizeof(rdata->len) > rdata_end ||
+				    (uint8_t *)rdata + knot_rdata_size(rdata->len) > rdata_end) {
+					return KNOT_EMALF;
+				}
+				rdata = knot_rdataset_next(rdata);
+			}
+			if ((uint8_t *)rdata != rdata_end) {
+				return KNOT_EMALF;
+			}
+			pos = rdata_end + pad_size(rdata_end - base);
+
+			if (zone_skip_type(skip, rrset.type)) {
+				continue;
+			}
+
+			zone_node_t *unused = NULL;
+			int ret = zone_contents_add_rr(contents, &rrset, &unused);
+			if (ret != KNOT_EOK) {
+				return ret;
+			}
+		}
+	}
+
+	return (pos == end) ? KNOT_EOK : KNOT_EMALF;
+}
+
+int zone_snapshot_load(const char *path, const knot_dname_t *origin,
+                       const char *zonefile, zone_skip_t *skip,
+                       zone_contents_t **contents)
+{
+	if (path == NULL || contents == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return knot_map_errno();
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		int ret = knot_map_errno();
+		close(fd);
+		return ret;
+	}
+	if (st.st_size < sizeof(snapshot_hdr_t)) {
+		close(fd);
+		return KNOT_EMALF;
+	}
+
+	uint8_t *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return knot_map_errno();
+	}
+	(void)madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+	const snapshot_hdr_t *hdr = (const snapshot_hdr_t *)data;
+	const uint8_t *payload = data + sizeof(*hdr);
+	const uint8_t *end = data + st.st_size;
+
+	int ret = KNOT_EOK;
+	if (memcmp(hdr->magic, SNAPSHOT_MAGIC, sizeof(hdr->magic)) != 0 ||
+	    hdr->version != SNAPSHOT_VERSION || hdr->bom != SNAPSHOT_BOM ||
+	    hdr->payload_size != end - payload) {
+		ret = KNOT_EMALF;
+		goto done;
+	}
+
+	if (zonefile != NULL) {
+		struct stat zf_st;
+		if (stat(zonefile, &zf_st) != 0 ||
+		    hdr->source_size != zf_st.st_size ||
+		    hdr->source_sec != zf_st.st_mtim.tv_sec ||
+		    hdr->source_nsec != zf_st.st_mtim.tv_nsec) {
+			ret = KNOT_ENOENT;
+			goto done;
+		}
+	}
+
+	if (payload_checksum(payload, hdr->payload_size) != hdr->checksum) {
+		ret = KNOT_EMALF;
+		goto done;
+	}
+
+	// The apex is stored first.
+	int apex_len = knot_dname_wire_check(payload, end, NULL);
+	if (apex_len <= 0 ||
+	    (origin != NULL && !knot_dname_is_equal(origin, payload))) {
+		ret = KNOT_EMALF;
+		goto done;
+	}
+
+	*contents = zone_contents_new(payload, true);
+	if (*contents == NULL) {
+		ret = KNOT_ENOMEM;
+		goto done;
+	}
+
+	ret = load_payload(*contents, skip, payload, end);
+	if (ret != KNOT_EOK) {
+		zone_contents_deep_free(*contents);
+		*contents = NULL;
+	}
+done:
+	munmap(data, st.st_size);
+
+	return ret;
+}
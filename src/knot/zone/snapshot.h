@@ -0,0 +1,67 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+/*!
+ * \brief Binary zone contents snapshot.
+ *
+ * The snapshot holds the zone nodes in the canonical order with rdatasets
+ * stored in the in-memory knot_rdata_t layout, so loading it is just a matter
+ * of mmap() and copying the rdatasets into new zone contents. The file is
+ * bound to the zone file it was written along with (by its size and mtime)
+ * and protected by a checksum. As the layout is host-specific, a snapshot
+ * from a different architecture is refused.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "knot/zone/contents.h"
+#include "knot/zone/skip.h"
+
+/*! \brief Snapshot file name suffix appended to the zone file path. */
+#define ZONE_SNAPSHOT_SUFFIX ".snap"
+
+/*!
+ * \brief Get the snapshot file path for the given zone file.
+ *
+ * \return Allocated path or NULL if no memory.
+ */
+char *zone_snapshot_path(const char *zonefile);
+
+/*!
+ * \brief Check if the file looks like a zone snapshot.
+ */
+bool zone_snapshot_probe(const char *path);
+
+/*!
+ * \brief Write the zone contents snapshot.
+ *
+ * \param path      Snapshot file path.
+ * \param contents  Zone contents to be stored.
+ * \param skip      RR types to be omitted (can be NULL).
+ * \param zonefile  Zone file the snapshot is bound to (can be NULL).
+ *
+ * \return KNOT_E*
+ */
+int zone_snapshot_write(const char *path, zone_contents_t *contents,
+                        zone_skip_t *skip, const char *zonefile);
+
+/*!
+ * \brief Load zone contents from the snapshot.
+ *
+ * \param path      Snapshot file path.
+ * \param origin    Zone name, NULL to take it from the snapshot.
+ * \param zonefile  Zone file the snapshot must match, NULL to skip the check.
+ * \param skip      RR types to be omitted (can be NULL).
+ * \param contents  Output zone contents.
+ *
+ * \retval KNOT_ENOENT  Snapshot doesn't exist or doesn't match the zone file.
+ * \retval KNOT_EMALF   Snapshot is damaged or incompatible.
+ * \return KNOT_E*      Other error.
+ */
+int zone_snapshot_load(const char *path, const knot_dname_t *origin,
+                       const char *zonefile, zone_skip_t *skip,
+                       zone_contents_t **contents);
@@ -4,6 +4,7 @@
  */
 
 #include <inttypes.h>
+#include <string.h>
 
 #include "knot/dnssec/zone-nsec.h"
 #include "knot/zone/skip.h"
@@ -15,7 +16,8 @@
 
 /*! \brief Dump parameters. */
 typedef struct {
-	FILE     *file;
+	zone_dump_write_t write;
+	void     *ctx;
 	char     *buf;
 	size_t   buflen;
 	uint64_t rr_count;
@@ -39,8 +41,10 @@ static int apex_node_dump_text(zone_node_t *node, dump_params_t *params)
 			return ret;
 		}
 		params->rr_count += soa.rrs.count;
-		fprintf(params->file, "%s", params->buf);
-		params->buf[0] = '\0';
+		ret = params->write(params->buf, ret, params->ctx);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
 	}
 
 	// Dump other records.
@@ -66,8 +70,10 @@ static int apex_node_dump_text(zone_node_t *node, dump_params_t *params)
 			return ret;
 		}
 		params->rr_count +=  rrset.rrs.count;
-		fprintf(params->file, "%s", params->buf);
-		params->buf[0] = '\0';
+		ret = params->write(params->buf, ret, params->ctx);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
 	}
 
 	return KNOT_EOK;
@@ -80,8 +86,7 @@ static int node_dump_text(zone_node_t *node, void *data)
 	// Zone apex rrsets.
 	if (node->owner == params->origin && !params->dump_rrsig &&
 	    !params->dump_nsec) {
-		apex_node_dump_text(node, params);
-		return KNOT_EOK;
+		return apex_node_dump_text(node, params);
 	}
 
 	// Dump non-apex rrsets.
@@ -115,7 +120,11 @@ static int node_dump_text(zone_node_t *node, void *data)
 
 		// Dump block comment if available.
 		if (params->first_comment != NULL) {
-			fprintf(params->file, "%s", params->first_comment);
+			int ret = params->write(params->first_comment,
+			                        strlen(params->first_comment), params->ctx);
+			if (ret != KNOT_EOK) {
+				return ret;
+			}
 			params->first_comment = NULL;
 		}
 
@@ -125,8 +134,19 @@ static int node_dump_text(zone_node_t *node, void *data)
 			return ret;
 		}
 		params->rr_count += rrset.rrs.count;
-		fprintf(params->file, "%s", params->buf);
-		params->buf[0] = '\0';
+		ret = params->write(params->buf, ret, params->ctx);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static int file_write(const char *data, size_t len, void *ctx)
+{
+	if (fwrite(data, 1, len, ctx) != len) {
+		return knot_map_errno();
 	}
 
 	return KNOT_EOK;
@@ -138,6 +158,16 @@ int zone_dump_text(zone_contents_t *zone, zone_skip_t *skip, FILE *file, bool co
 		return KNOT_EINVAL;
 	}
 
+	return zone_dump_text_cb(zone, skip, file_write, file, comments, color);
+}
+
+int zone_dump_text_cb(zone_contents_t *zone, zone_skip_t *skip, zone_dump_write_t write,
+                      void *ctx, bool comments, const char *color)
+{
+	if (write == NULL) {
+		return KNOT_EINVAL;
+	}
+
 	if (zone == NULL) {
 		return KNOT_EEMPTYZONE;
 	}
@@ -148,8 +178,14 @@ int zone_dump_text(zone_contents_t *zone, zone_skip_t *skip, FILE *file, bool co
 		return KNOT_ENOMEM;
 	}
 
+	int ret = KNOT_EOK;
 	if (comments) {
-		fprintf(file, ";; Zone dump (Knot DNS %s)\n", PACKAGE_VERSION);
+		ret = snprintf(buf, DUMP_BUF_LEN, ";; Zone dump (Knot DNS %s)\n", PACKAGE_VERSION);
+		ret = write(buf, ret, ctx);
+		if (ret != KNOT_EOK) {
+			free(buf);
+			return ret;
+		}
 	}
 
 	// Set structure with parameters.
@@ -157,7 +193,8 @@ int zone_dump_text(zone_contents_t *zone, zone_skip_t *skip, FILE *file, bool co
 	style.color = color;
 	style.now = knot_time();
 	dump_params_t params = {
-		.file = file,
+		.write = write,
+		.ctx = ctx,
 		.buf = buf,
 		.buflen = DUMP_BUF_LEN,
 		.rr_count = 0,
@@ -169,7 +206,7 @@ int zone_dump_text(zone_contents_t *zone, zone_skip_t *skip, FILE *file, bool co
 	};
 
 	// Dump standard zone records without RRSIGS.
-	int ret = zone_contents_apply(zone, node_dump_text, &params);
+	ret = zone_contents_apply(zone, node_dump_text, &params);
 	if (ret != KNOT_EOK) {
 		free(params.buf);
 		return ret;
@@ -223,12 +260,13 @@ int zone_dump_text(zone_contents_t *zone, zone_skip_t *skip, FILE *file, bool co
 		strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S %Z", &tm);
 
 		// Dump trailing statistics.
-		fprintf(file, ";; Written %"PRIu64" records\n"
-		              ";; Time %s\n",
-		        params.rr_count, date);
+		ret = snprintf(params.buf, params.buflen, ";; Written %"PRIu64" records\n"
+		                                          ";; Time %s\n",
+		               params.rr_count, date);
+		ret = write(params.buf, ret, ctx);
 	}
 
 	free(params.buf); // params.buf may be != buf because of knot_rrset_txt_dump_dynamic()
 
-	return KNOT_EOK;
+	return ret;
 }
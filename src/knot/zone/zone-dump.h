@@ -8,6 +8,17 @@
 #include "knot/zone/skip.h"
 #include "knot/zone/zone.h"
 
+/*!
+ * \brief Zone dump output callback.
+ *
+ * \param data  Text to be written.
+ * \param len   Length of the text.
+ * \param ctx   Callback context.
+ *
+ * \return KNOT_E*
+ */
+typedef int (*zone_dump_write_t)(const char *data, size_t len, void *ctx);
+
 /*!
  * \brief Dumps given zone to text file.
  *
@@ -21,3 +32,19 @@
  * \retval < 0 if error.
  */
 int zone_dump_text(zone_contents_t *zone, zone_skip_t *skip, FILE *file, bool comments, const char *color);
+
+/*!
+ * \brief Dumps given zone in text format through the output callback.
+ *
+ * \param zone      Zone to be saved.
+ * \param skip      RRRTypes to be skipped.
+ * \param write     Output callback.
+ * \param ctx       Output callback context.
+ * \param comments  Add separating comments indicator.
+ * \param color     Optional color control sequence.
+ *
+ * \retval KNOT_EOK on success.
+ * \retval < 0 if error.
+ */
+int zone_dump_text_cb(zone_contents_t *zone, zone_skip_t *skip, zone_dump_write_t write,
+                      void *ctx, bool comments, const char *color);
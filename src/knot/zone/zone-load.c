@@ -6,6 +6,7 @@
 #include "knot/common/log.h"
 #include "knot/journal/journal_metadata.h"
 #include "knot/journal/journal_read.h"
+#include "knot/zone/snapshot.h"
 #include "knot/zone/zone-diff.h"
 #include "knot/zone/zone-load.h"
 #include "knot/zone/zonefile.h"
@@ -13,6 +14,45 @@
 #include "knot/dnssec/zone-events.h"
 #include "libknot/libknot.h"
 
+int zone_load_snapshot(conf_t *conf, const knot_dname_t *zone_name,
+                       zone_skip_t *skip, zone_contents_t **contents)
+{
+	if (conf == NULL || zone_name == NULL || contents == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	conf_val_t val = conf_zone_get(conf, C_ZONEFILE_SNAPSHOT, zone_name);
+	if (!conf_bool(&val)) {
+		return KNOT_ENOENT;
+	}
+
+	char *zonefile = conf_zonefile(conf, zone_name);
+	char *path = zone_snapshot_path(zonefile);
+	if (path == NULL) {
+		free(zonefile);
+		return KNOT_ENOMEM;
+	}
+
+	int ret = zone_snapshot_load(path, zone_name, zonefile, skip, contents);
+	switch (ret) {
+	case KNOT_EOK:
+		log_zone_info(zone_name, "zone file snapshot loaded, serial %u",
+		              zone_contents_serial(*contents));
+		break;
+	case KNOT_ENOENT:
+		break;
+	default:
+		log_zone_warning(zone_name, "ignoring zone file snapshot '%s' (%s)",
+		                 path, knot_strerror(ret));
+		ret = KNOT_ENOENT;
+	}
+
+	free(path);
+	free(zonefile);
+
+	return ret;
+}
+
 int zone_load_contents(conf_t *conf, const knot_dname_t *zone_name,
                        zone_contents_t **contents, semcheck_optional_t semcheck_mode,
                        bool fail_on_warning)
@@ -7,10 +7,26 @@
 
 #include "knot/conf/conf.h"
 #include "knot/zone/semantic-check.h"
+#include "knot/zone/skip.h"
 #include "knot/zone/zone.h"
 
 #define DEFAULT_TTL 3600
 
+/*!
+ * \brief Load zone contents from the zone file snapshot if enabled and valid.
+ *
+ * \param conf       Configuration.
+ * \param zone_name  Zone name.
+ * \param skip       RR types to be omitted.
+ * \param contents   Output zone contents.
+ *
+ * \retval KNOT_EOK     if success.
+ * \retval KNOT_ENOENT  if no usable snapshot.
+ * \retval KNOT_E*      if error.
+ */
+int zone_load_snapshot(conf_t *conf, const knot_dname_t *zone_name,
+                       zone_skip_t *skip, zone_contents_t **contents);
+
 /*!
  * \brief Load zone contents according to the configuration.
  *
@@ -291,6 +291,32 @@ int zone_tree_apply(zone_tree_t *tree, zone_tree_apply_cb_t function, void *data
 	return trie_apply(tree->trie, tree_apply_cb, &f);
 }
 
+size_t zone_tree_split(zone_tree_t *tree, trie_part_t **parts,
+                       size_t max_parts, size_t min_parts)
+{
+	if (zone_tree_is_empty(tree)) {
+		return 0;
+	}
+
+	return trie_split(tree->trie, parts, max_parts, min_parts);
+}
+
+int zone_tree_part_apply(zone_tree_t *tree, trie_part_t *part,
+                         zone_tree_apply_cb_t function, void *data)
+{
+	if (tree == NULL || part == NULL || function == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	zone_tree_func_t f = {
+		.func = function,
+		.data = data,
+		.binode_second = ((tree->flags & ZONE_TREE_BINO_SECOND) ? 1 : 0),
+	};
+
+	return trie_part_apply(part, tree_apply_cb, &f);
+}
+
 int zone_tree_sub_apply(zone_tree_t *tree, const knot_dname_t *sub_root,
                         bool excl_root, zone_tree_apply_cb_t function, void *data)
 {
@@ -224,6 +224,32 @@ int zone_tree_apply(zone_tree_t *tree, zone_tree_apply_cb_t function, void *data
 int zone_tree_sub_apply(zone_tree_t *tree, const knot_dname_t *sub_root,
                         bool excl_root, zone_tree_apply_cb_t function, void *data);
 
+/*!
+ * \brief Splits the zone tree into disjoint parts for parallel processing.
+ *
+ * \param tree       Zone tree.
+ * \param parts      Out: parts of the tree, ordered by owner.
+ * \param max_parts  Capacity of the parts array.
+ * \param min_parts  Requested number of parts (if the tree is big enough).
+ *
+ * \return Number of parts stored.
+ */
+size_t zone_tree_split(zone_tree_t *tree, trie_part_t **parts,
+                       size_t max_parts, size_t min_parts);
+
+/*!
+ * \brief Applies the given function to each node in a part of the tree in order.
+ *
+ * \param tree       Zone tree the part belongs to.
+ * \param part       Part of the tree obtained from zone_tree_split().
+ * \param function   Callback to be applied.
+ * \param data       Callback context.
+ *
+ * \return KNOT_E*
+ */
+int zone_tree_part_apply(zone_tree_t *tree, trie_part_t *part,
+                         zone_tree_apply_cb_t function, void *data);
+
 /*!
  * \brief Start zone tree iteration.
  *
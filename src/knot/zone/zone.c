@@ -3,6 +3,7 @@
  *  For more information, see <https://www.knot-dns.cz/>
  */
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -13,6 +14,7 @@
 #include "knot/conf/module.h"
 #include "knot/dnssec/kasp/kasp_db.h"
 #include "knot/events/replan.h"
+#include "knot/events/soa_check.h"
 #include "knot/journal/journal_read.h"
 #include "knot/journal/journal_write.h"
 #include "knot/nameserver/process_query.h"
@@ -21,10 +23,13 @@
 #include "knot/server/server.h"
 #include "knot/zone/contents.h"
 #include "knot/zone/serial.h"
+#include "knot/zone/snapshot.h"
 #include "knot/zone/zone.h"
 #include "knot/zone/zonefile.h"
 #include "libknot/libknot.h"
+#include "contrib/macros.h"
 #include "contrib/sockaddr.h"
+#include "contrib/time.h"
 #include "contrib/mempattern.h"
 #include "contrib/ucw/lists.h"
 #include "contrib/ucw/mempool.h"
@@ -44,6 +49,31 @@ static void free_ddns_queue(zone_t *zone)
 	ptrlist_free(&zone->ddns_queue, NULL);
 }
 
+static void write_snapshot(conf_t *conf, const knot_dname_t *zone_name,
+                           zone_contents_t *contents, const char *zonefile)
+{
+	conf_val_t val = conf_zone_get(conf, C_ZONEFILE_SNAPSHOT, zone_name);
+	if (!conf_bool(&val)) {
+		return;
+	}
+
+	val = conf_zone_get(conf, C_ZONEFILE_SKIP, zone_name);
+	zone_skip_t skip = { 0 };
+	int ret = zone_skip_from_conf(&skip, &val);
+	if (ret == KNOT_EOK) {
+		char *path = zone_snapshot_path(zonefile);
+		ret = (path != NULL) ? zone_snapshot_write(path, contents, &skip, zonefile)
+		                     : KNOT_ENOMEM;
+		free(path);
+	}
+	zone_skip_free(&skip);
+
+	if (ret != KNOT_EOK) {
+		log_zone_warning(zone_name, "failed to update zone file snapshot (%s)",
+		                 knot_strerror(ret));
+	}
+}
+
 /*!
  * \param allow_empty_zone useful when need to flush journal but zone is not yet loaded
  * ...in this case we actually don't have to do anything because the zonefile is current,
@@ -94,11 +124,22 @@ static int flush_journal(conf_t *conf, zone_t *zone, bool allow_empty_zone, bool
 		goto flush_journal_replan;
 	}
 
+	/* Pin the contents like an outgoing transfer does, so that the possibly
+	   long write doesn't block RCU synchronization of other updates. */
+	pthread_rwlock_rdlock(&contents->xfrout_lock);
+	rcu_read_unlock();
+
 	char *zonefile = conf_zonefile(conf, zone->name);
 
 	/* Synchronize journal. */
-	ret = zonefile_write_skip(zonefile, contents, conf);
-	rcu_read_unlock();
+	uint64_t written = 0;
+	struct timespec t_start = time_now();
+	ret = zonefile_write_skip(zonefile, contents, conf, &written);
+	struct timespec t_end = time_now();
+	if (ret == KNOT_EOK) {
+		write_snapshot(conf, zone->name, contents, zonefile);
+	}
+	pthread_rwlock_unlock(&contents->xfrout_lock);
 	if (ret != KNOT_EOK) {
 		log_zone_warning(zone->name, "failed to update zone file (%s)",
 		                 knot_strerror(ret));
@@ -106,12 +147,16 @@ static int flush_journal(conf_t *conf, zone_t *zone, bool allow_empty_zone, bool
 		goto flush_journal_replan;
 	}
 
+	double duration = MAX(time_diff_ms(&t_start, &t_end), 1) / 1000.0;
+	double rate = written / duration / (1024 * 1024);
 	if (zone->zonefile.exists) {
-		log_zone_info(zone->name, "zone file updated, serial %u -> %u",
-		              zone->zonefile.serial, serial_to);
+		log_zone_info(zone->name, "zone file updated, serial %u -> %u, "
+		              "%"PRIu64" bytes, %.02f seconds, %.02f MiB/s",
+		              zone->zonefile.serial, serial_to, written, duration, rate);
 	} else {
-		log_zone_info(zone->name, "zone file updated, serial %u",
-		              serial_to);
+		log_zone_info(zone->name, "zone file updated, serial %u, "
+		              "%"PRIu64" bytes, %.02f seconds, %.02f MiB/s",
+		              serial_to, written, duration, rate);
 	}
 
 	/* Update zone version. */
@@ -208,6 +253,11 @@ void zone_free(zone_t **zone_ptr)
 
 	zone_t *zone = *zone_ptr;
 
+	if (zone->server != NULL) {
+		soa_check_cancel(zone->server->soa_check, zone);
+	}
+	soa_check_result_free(zone->soa_check_result);
+
 	zone_events_deinit(zone);
 
 	if (zone->update_clear_thr) {
@@ -786,7 +836,7 @@ int zone_dump_to_dir(conf_t *conf, zone_t *zone, const char *dir)
 	}
 	free(zonefile);
 
-	return zonefile_write_skip(target, zone->contents, conf);
+	return zonefile_write_skip(target, zone->contents, conf, NULL);
 }
 
 void zone_local_notify_subscribe(zone_t *zone, zone_t *subscribe)
@@ -133,6 +133,11 @@ typedef struct zone
 	/*! \brief Preferred master for remote operation. */
 	struct sockaddr_storage *preferred_master;
 
+	/*! \brief Pending non-blocking SOA check (owned by the SOA checker). */
+	struct soa_check_item *soa_check_item;
+	/*! \brief Finished SOA check for the refresh event, protected by preferred_lock. */
+	struct soa_check_result *soa_check_result;
+
 	/*! \brief Query modules. */
 	list_t query_modules;
 	struct query_plan *query_plan;
@@ -20,6 +20,7 @@
 #include "knot/zone/zonedb.h"
 #include "knot/zone/zonefile.h"
 #include "libknot/libknot.h"
+#include "contrib/time.h"
 
 static bool zone_file_updated(conf_t *conf, const zone_t *old_zone,
                               const knot_dname_t *zone_name)
@@ -216,6 +217,32 @@ static zone_t *create_zone(conf_t *conf, const knot_dname_t *name, server_t *ser
 	return z;
 }
 
+/*!
+ * \brief Create a configured zone and activate its query modules.
+ */
+static zone_t *create_conf_zone(conf_t *conf, const knot_dname_t *name,
+                                server_t *server, zone_t *old_zone)
+{
+	zone_t *zone = create_zone(conf, name, server, old_zone);
+	if (zone == NULL) {
+		log_zone_error(name, "zone cannot be created");
+		return NULL;
+	}
+
+	int ret = conf_activate_modules(conf, server, zone->name,
+	                                &zone->query_modules,
+	                                &zone->query_plan);
+	if (ret != KNOT_EOK) {
+		log_zone_error(zone->name, "zone cannot be activated (%s)",
+		               knot_strerror(ret));
+		zone->contents = NULL;
+		zone_free(&zone);
+		return NULL;
+	}
+
+	return zone;
+}
+
 static void mark_changed_zones(knot_zonedb_t *zonedb, trie_t *changed)
 {
 	if (changed == NULL) {
@@ -406,6 +433,76 @@ static zone_t *add_member_zone(catalog_upd_val_t *val, knot_zonedb_t *check,
 	return zone;
 }
 
+static void purge_removed_members(conf_t *conf, server_t *server, knot_zonedb_t *db_old)
+{
+	catalog_it_t *cat_it = catalog_it_begin(&server->catalog_upd);
+	while (!catalog_it_finished(cat_it)) {
+		catalog_upd_val_t *upd = catalog_it_val(cat_it);
+		if (upd->type == CAT_UPD_REM) {
+			zone_t *zone = knot_zonedb_find(db_old, upd->member);
+			if (zone != NULL) {
+				zone->change_type = CONF_IO_TUNSET;
+				zone_purge(conf, zone);
+			}
+		}
+		catalog_it_next(cat_it);
+	}
+	catalog_it_free(cat_it);
+}
+
+static bool reverse_linked(zone_t *z, zone_t *forw)
+{
+	ptrnode_t *n;
+	WALK_LIST(n, z->reverse_from) {
+		if (n->d == forw) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*!
+ * \brief Link the reverse zone with the zones it's generated from.
+ *
+ * If some of them don't exist, the reverse zone is remembered in the server
+ * so that an incremental update adding them links it too.
+ *
+ * \param conf    Server configuration.
+ * \param server  Server instance.
+ * \param db_new  New zone database.
+ * \param z       Reverse zone (or any zone).
+ * \param warn    Log a warning about the non-existent zones.
+ */
+static void subscribe_reverse(conf_t *conf, server_t *server, knot_zonedb_t *db_new,
+                              zone_t *z, bool warn)
+{
+	bool missing = false;
+	conf_val_t val = conf_zone_get(conf, C_REVERSE_GEN, z->name);
+	while (val.code == KNOT_EOK) {
+		const knot_dname_t *forw_name = conf_dname(&val);
+		zone_t *forw = knot_zonedb_find(db_new, forw_name);
+		if (forw == NULL) {
+			if (warn) {
+				knot_dname_txt_storage_t forw_str;
+				(void)knot_dname_to_str(forw_str, forw_name, sizeof(forw_str));
+				log_zone_warning(z->name, "zone to reverse %s does not exist",
+				                 forw_str);
+			}
+			missing = true;
+		} else if (!reverse_linked(z, forw)) {
+			ptrlist_add(&z->reverse_from, forw, NULL);
+			zone_local_notify_subscribe(forw, z);
+		}
+		conf_val_next(&val);
+	}
+
+	if (missing) {
+		(void)trie_get_ins(server->reverse_pending, z->name, knot_dname_size(z->name));
+	} else {
+		(void)trie_del(server->reverse_pending, z->name, knot_dname_size(z->name), NULL);
+	}
+}
+
 /*!
  * \brief Create new zone database.
  *
@@ -451,40 +548,16 @@ static knot_zonedb_t *create_zonedb(conf_t *conf, server_t *server, reload_t mod
 			}
 		}
 
-		zone_t *zone = create_zone(conf, name, server, old_zone);
+		zone_t *zone = create_conf_zone(conf, name, server, old_zone);
 		if (zone == NULL) {
-			log_zone_error(name, "zone cannot be created");
 			continue;
-		} else {
-			int ret = conf_activate_modules(conf, server, zone->name,
-			                                &zone->query_modules,
-			                                &zone->query_plan);
-			if (ret != KNOT_EOK) {
-				log_zone_error(zone->name, "zone cannot be activated (%s)",
-				               knot_strerror(ret));
-				zone->contents = NULL;
-				zone_free(&zone);
-				continue;
-			}
 		}
 
 		knot_zonedb_insert(db_new, zone);
 	}
 
 	/* Purge decataloged zones before catalog removals are commited. */
-	catalog_it_t *cat_it = catalog_it_begin(&server->catalog_upd);
-	while (!catalog_it_finished(cat_it)) {
-		catalog_upd_val_t *upd = catalog_it_val(cat_it);
-		if (upd->type == CAT_UPD_REM) {
-			zone_t *zone = knot_zonedb_find(db_old, upd->member);
-			if (zone != NULL) {
-				zone->change_type = CONF_IO_TUNSET;
-				zone_purge(conf, zone);
-			}
-		}
-		catalog_it_next(cat_it);
-	}
-	catalog_it_free(cat_it);
+	purge_removed_members(conf, server, db_old);
 
 	int ret = catalog_update_commit(&server->catalog_upd, &server->catalog);
 	if (ret != KNOT_EOK) {
@@ -525,27 +598,216 @@ static knot_zonedb_t *create_zonedb(conf_t *conf, server_t *server, reload_t mod
 	}
 	catalog_it_free(it);
 
+	trie_clear(server->reverse_pending);
 	it = knot_zonedb_iter_begin(db_new);
 	while (!knot_zonedb_iter_finished(it)) {
-		zone_t *z = knot_zonedb_iter_val(it);
-		conf_val_t val = conf_zone_get(conf, C_REVERSE_GEN, z->name);
-		while (val.code == KNOT_EOK) {
-			const knot_dname_t *forw_name = conf_dname(&val);
-			zone_t *forw = knot_zonedb_find(db_new, forw_name);
-			if (forw == NULL) {
-				knot_dname_txt_storage_t forw_str;
-				(void)knot_dname_to_str(forw_str, forw_name, sizeof(forw_str));
-				log_zone_warning(z->name, "zone to reverse %s does not exist",
-				                 forw_str);
+		subscribe_reverse(conf, server, db_new, knot_zonedb_iter_val(it), true);
+		knot_zonedb_iter_next(it);
+	}
+	knot_zonedb_iter_free(it);
+
+	return db_new;
+}
+
+/*!
+ * \brief Move the links between the reused and the replaced or removed zone.
+ *
+ * \param server    Server instance.
+ * \param db_new    New zone database.
+ * \param old_zone  Replaced or removed zone.
+ * \param zone      Replacing zone (can be NULL).
+ */
+static void relink_reverse(server_t *server, knot_zonedb_t *db_new,
+                           zone_t *old_zone, zone_t *zone)
+{
+	ptrnode_t *n, *m, *next;
+
+	/* Reused reverse zones generated from the old zone. */
+	WALK_LIST(n, old_zone->internal_notify) {
+		zone_t *rev = n->d;
+		if (knot_zonedb_find(db_new, rev->name) != rev) {
+			continue;
+		}
+		WALK_LIST_DELSAFE(m, next, rev->reverse_from) {
+			if (m->d != old_zone) {
+				continue;
+			}
+			if (zone != NULL) {
+				m->d = zone;
+				zone_local_notify_subscribe(zone, rev);
 			} else {
-				ptrlist_add(&z->reverse_from, forw, NULL);
-				zone_local_notify_subscribe(forw, z);
+				ptrlist_rem(m, NULL);
+				(void)trie_get_ins(server->reverse_pending, rev->name,
+				                   knot_dname_size(rev->name));
 			}
-			conf_val_next(&val);
 		}
-		knot_zonedb_iter_next(it);
 	}
-	knot_zonedb_iter_free(it);
+
+	/* Reused zones the old reverse zone was generated from. */
+	WALK_LIST(n, old_zone->reverse_from) {
+		zone_t *forw = n->d;
+		if (knot_zonedb_find(db_new, forw->name) != forw) {
+			continue;
+		}
+		WALK_LIST_DELSAFE(m, next, forw->internal_notify) {
+			if (m->d == old_zone) {
+				ptrlist_rem(m, NULL);
+			}
+		}
+	}
+
+	if (zone == NULL) {
+		(void)trie_del(server->reverse_pending, old_zone->name,
+		               knot_dname_size(old_zone->name), NULL);
+	}
+}
+
+/*!
+ * \brief Link the reused reverse zones with the added zones they're generated from.
+ */
+static void subscribe_pending(conf_t *conf, server_t *server, knot_zonedb_t *db_old,
+                              knot_zonedb_t *db_new)
+{
+	list_t reused;
+	init_list(&reused);
+
+	/* The pending set is modified when subscribing, collect the zones first. */
+	trie_it_t *it = trie_it_begin(server->reverse_pending);
+	for (; !trie_it_finished(it); trie_it_next(it)) {
+		const knot_dname_t *name = (const knot_dname_t *)trie_it_key(it, NULL);
+		zone_t *rev = knot_zonedb_find(db_new, name);
+		if (rev != NULL && rev == knot_zonedb_find(db_old, name)) {
+			ptrlist_add(&reused, rev, NULL);
+		}
+	}
+	trie_it_free(it);
+
+	ptrnode_t *n;
+	WALK_LIST(n, reused) {
+		subscribe_reverse(conf, server, db_new, n->d, false);
+	}
+	ptrlist_free(&reused, NULL);
+}
+
+static void changed_add(trie_t *changed, const knot_dname_t *name)
+{
+	(void)trie_get_ins(changed, name, knot_dname_size(name));
+}
+
+/*!
+ * \brief Update the zone database with the changed zones only.
+ *
+ * Unlike create_zonedb(), the unchanged zones aren't visited at all. The new
+ * database is a copy-on-write clone of the current one, so the cost depends
+ * on the number of changes only.
+ *
+ * \param conf              New server configuration.
+ * \param server            Server instance.
+ * \param mode              Reload mode (RELOAD_COMMIT or RELOAD_CATALOG).
+ * \param expired_contents  Out: ptrlist of zone_contents_t to be deep freed after sync RCU.
+ * \param changed           Out: names (as keys) of the added, replaced, and removed zones.
+ *
+ * \return New zone database.
+ */
+static knot_zonedb_t *update_zonedb(conf_t *conf, server_t *server, reload_t mode,
+                                    list_t *expired_contents, trie_t *changed)
+{
+	assert(conf);
+	assert(server);
+	assert(mode & (RELOAD_COMMIT | RELOAD_CATALOG));
+
+	knot_zonedb_t *db_old = server->zone_db;
+	knot_zonedb_t *db_new = knot_zonedb_cow(db_old);
+	if (!db_new) {
+		return NULL;
+	}
+
+	/* Process changed zones from the configuration. */
+	if (mode == RELOAD_COMMIT && conf->io.zones != NULL) {
+		mark_changed_zones(db_old, conf->io.zones);
+
+		trie_it_t *it = trie_it_begin(conf->io.zones);
+		for (; !trie_it_finished(it); trie_it_next(it)) {
+			const knot_dname_t *name = (const knot_dname_t *)trie_it_key(it, NULL);
+			conf_io_type_t type = conf_io_trie_val(it);
+
+			zone_t *old_zone = knot_zonedb_find(db_old, name);
+			if (old_zone != NULL && !(type & (CONF_IO_TRELOAD | CONF_IO_TUNSET))) {
+				/* Reuse unchanged zone. */
+				continue;
+			}
+			changed_add(changed, name);
+
+			zone_t *zone = NULL;
+			if (!(type & CONF_IO_TUNSET)) {
+				zone = create_conf_zone(conf, name, server, old_zone);
+			}
+			if (zone != NULL) {
+				knot_zonedb_insert(db_new, zone);
+			} else {
+				(void)knot_zonedb_del(db_new, name);
+			}
+		}
+		trie_it_free(it);
+	}
+
+	/* Purge decataloged zones before catalog removals are commited. */
+	purge_removed_members(conf, server, db_old);
+
+	int ret = catalog_update_commit(&server->catalog_upd, &server->catalog);
+	if (ret != KNOT_EOK) {
+		log_error("catalog, failed to apply changes (%s)", knot_strerror(ret));
+		return db_new;
+	}
+
+	/* Process changed and new catalog member zones. */
+	catalog_it_t *it = catalog_it_begin(&server->catalog_upd);
+	while (!catalog_it_finished(it)) {
+		catalog_upd_val_t *val = catalog_it_val(it);
+		zone_t *old_zone = knot_zonedb_find(db_old, val->member);
+		if (old_zone != NULL && zone_get_flag(old_zone, ZONE_IS_CAT_MEMBER, false)) {
+			zone_t *zone = reuse_member_zone(old_zone, server, conf, mode,
+			                                 expired_contents);
+			if (zone != old_zone) {
+				changed_add(changed, val->member);
+				if (zone != NULL) {
+					knot_zonedb_insert(db_new, zone);
+				} else {
+					(void)knot_zonedb_del(db_new, val->member);
+				}
+			}
+		} else {
+			zone_t *zone = add_member_zone(val, db_new, server, conf);
+			if (zone != NULL) {
+				changed_add(changed, val->member);
+				knot_zonedb_insert(db_new, zone);
+			}
+		}
+		catalog_it_next(it);
+	}
+	catalog_it_free(it);
+
+	/* Link the reverse zones, the reused ones are already linked. */
+	bool added = false;
+	trie_it_t *ch_it = trie_it_begin(changed);
+	for (; !trie_it_finished(ch_it); trie_it_next(ch_it)) {
+		const knot_dname_t *name = (const knot_dname_t *)trie_it_key(ch_it, NULL);
+		zone_t *old_zone = knot_zonedb_find(db_old, name);
+		zone_t *zone = knot_zonedb_find(db_new, name);
+		if (old_zone != NULL && old_zone != zone) {
+			relink_reverse(server, db_new, old_zone, zone);
+		}
+		if (zone != NULL && zone != old_zone) {
+			subscribe_reverse(conf, server, db_new, zone, true);
+			added |= (old_zone == NULL);
+		}
+	}
+	trie_it_free(ch_it);
+
+	/* Unless added, the zones missing to the reused reverse zones are still missing. */
+	if (added && trie_weight(server->reverse_pending) > 0) {
+		subscribe_pending(conf, server, db_old, db_new);
+	}
 
 	return db_new;
 }
@@ -613,6 +875,46 @@ catalog_only:
 	}
 }
 
+/*!
+ * \brief Free the replaced and removed zones after an incremental update.
+ *
+ * \param conf     New server configuration.
+ * \param db_old   Old zone database to remove.
+ * \param server   Server context.
+ * \param changed  Names (as keys) of the added, replaced, and removed zones.
+ */
+static void remove_changed_zones(conf_t *conf, knot_zonedb_t *db_old,
+                                 server_t *server, trie_t *changed)
+{
+	catalog_commit_cleanup(&server->catalog);
+
+	knot_zonedb_t *db_new = server->zone_db;
+
+	trie_it_t *it = trie_it_begin(changed);
+	for (; !trie_it_finished(it); trie_it_next(it)) {
+		const knot_dname_t *name = (const knot_dname_t *)trie_it_key(it, NULL);
+		zone_t *zone = knot_zonedb_find(db_old, name);
+		zone_t *new_zone = knot_zonedb_find(db_new, name);
+		if (zone == NULL || zone == new_zone) {
+			continue;
+		}
+
+		/* Check if reloaded (reused contents). */
+		if ((zone->change_type & CONF_IO_TRELOAD) && new_zone != NULL) {
+			replan_events(conf, new_zone, zone);
+			zone->contents = NULL;
+		}
+		zone_free(&zone);
+	}
+	trie_it_free(it);
+
+	/* Clear catalog changes. No need to use mutex as this is done from main
+	 * thread while all zone events are paused. */
+	catalog_update_clear(&server->catalog_upd);
+
+	knot_zonedb_cow_commit(db_new, &db_old);
+}
+
 // UBSAN type punning workaround
 static void zone_contents_deep_free_wrap(void *contents)
 {
@@ -632,9 +934,17 @@ void zonedb_reload(conf_t *conf, server_t *server, reload_t mode)
 		}
 	}
 
+	/* Only the changed zones are processed if the others are reused. */
+	trie_t *changed = NULL;
+	if (server->zone_db != NULL && (mode == RELOAD_COMMIT || mode == RELOAD_CATALOG)) {
+		changed = trie_create(NULL);
+	}
+
 	list_t contents_tofree;
 	init_list(&contents_tofree);
 
+	struct timespec t_begin = time_now();
+
 	catalog_update_finalize(&server->catalog_upd, &server->catalog, conf);
 	size_t cat_upd_size = trie_weight(server->catalog_upd.upd);
 	if (cat_upd_size > 0) {
@@ -642,13 +952,24 @@ void zonedb_reload(conf_t *conf, server_t *server, reload_t mode)
 	}
 
 	/* Insert all required zones to the new zone DB. */
-	knot_zonedb_t *db_new = create_zonedb(conf, server, mode, &contents_tofree);
+	knot_zonedb_t *db_new = (changed != NULL) ?
+	                        update_zonedb(conf, server, mode, &contents_tofree, changed) :
+	                        create_zonedb(conf, server, mode, &contents_tofree);
 	if (db_new == NULL) {
 		log_error("failed to create new zone database");
+		trie_free(changed);
 		return;
 	}
 
-	catalogs_generate(db_new, server->zone_db);
+	struct timespec t_zones = time_now();
+
+	if (changed != NULL) {
+		catalogs_generate_changed(db_new, server->zone_db, changed);
+	} else {
+		catalogs_generate(db_new, server->zone_db);
+	}
+
+	struct timespec t_catalogs = time_now();
 
 	/* Switch the databases. */
 	knot_zonedb_t **db_current = &server->zone_db;
@@ -657,10 +978,33 @@ void zonedb_reload(conf_t *conf, server_t *server, reload_t mode)
 	/* Wait for readers to finish reading old zone database. */
 	synchronize_rcu();
 
+	struct timespec t_switch = time_now();
+
 	ptrlist_free_custom(&contents_tofree, NULL, zone_contents_deep_free_wrap);
 
 	/* Remove old zone DB. */
-	remove_old_zonedb(conf, db_old, server, mode);
+	size_t changes = 0;
+	if (changed != NULL) {
+		changes = trie_weight(changed);
+		remove_changed_zones(conf, db_old, server, changed);
+		trie_free(changed);
+	} else {
+		remove_old_zonedb(conf, db_old, server, mode);
+	}
+
+	struct timespec t_end = time_now();
+
+	char changes_str[32] = "";
+	if (mode & (RELOAD_COMMIT | RELOAD_CATALOG)) {
+		(void)snprintf(changes_str, sizeof(changes_str), ", %zu changes", changes);
+	}
+	log_info("zone database %s, %zu zones%s, took %.1f ms (zones %.1f ms, "
+	         "catalogs %.1f ms, switch %.1f ms, cleanup %.1f ms)",
+	         (mode & (RELOAD_COMMIT | RELOAD_CATALOG)) ? "updated" : "reloaded",
+	         knot_zonedb_size(db_new), changes_str,
+	         time_diff_ms(&t_begin, &t_end), time_diff_ms(&t_begin, &t_zones),
+	         time_diff_ms(&t_zones, &t_catalogs), time_diff_ms(&t_catalogs, &t_switch),
+	         time_diff_ms(&t_switch, &t_end));
 }
 
 int zone_reload_modules(conf_t *conf, server_t *server, const knot_dname_t *zone_name)
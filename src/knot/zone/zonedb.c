@@ -9,8 +9,6 @@
 #include "knot/journal/journal_metadata.h"
 #include "knot/zone/zonedb.h"
 #include "libknot/packet/wire.h"
-#include "contrib/mempattern.h"
-#include "contrib/ucw/mempool.h"
 
 /*! \brief Discard zone in zone database. */
 static void discard_zone(zone_t *zone, bool abort_txn)
@@ -42,11 +40,9 @@ knot_zonedb_t *knot_zonedb_new(void)
 		return NULL;
 	}
 
-	mm_ctx_mempool(&db->mm, MM_DEFAULT_BLKSIZE);
-
-	db->trie = trie_create(&db->mm);
+	// No mempool, the nodes replaced by copy-on-write updates are freed.
+	db->trie = trie_create(NULL);
 	if (db->trie == NULL) {
-		mp_delete(db->mm.ctx);
 		free(db);
 		return NULL;
 	}
@@ -54,6 +50,42 @@ knot_zonedb_t *knot_zonedb_new(void)
 	return db;
 }
 
+knot_zonedb_t *knot_zonedb_cow(knot_zonedb_t *db)
+{
+	if (db == NULL || db->cow != NULL) {
+		return NULL;
+	}
+
+	knot_zonedb_t *db_new = calloc(1, sizeof(knot_zonedb_t));
+	if (db_new == NULL) {
+		return NULL;
+	}
+
+	db->cow = trie_cow(db->trie, NULL, NULL);
+	if (db->cow == NULL) {
+		free(db_new);
+		return NULL;
+	}
+	db_new->cow = db->cow;
+	db_new->trie = trie_cow_new(db_new->cow);
+
+	return db_new;
+}
+
+void knot_zonedb_cow_commit(knot_zonedb_t *db_new, knot_zonedb_t **db_old)
+{
+	if (db_new == NULL || db_old == NULL || *db_old == NULL) {
+		return;
+	}
+	assert(db_new->cow != NULL && db_new->cow == (*db_old)->cow);
+
+	db_new->trie = trie_cow_commit(db_new->cow, NULL, NULL);
+	db_new->cow = NULL;
+
+	free(*db_old);
+	*db_old = NULL;
+}
+
 int knot_zonedb_insert(knot_zonedb_t *db, zone_t *zone)
 {
 	if (db == NULL || zone == NULL) {
@@ -65,7 +97,12 @@ int knot_zonedb_insert(knot_zonedb_t *db, zone_t *zone)
 	uint8_t *lf = knot_dname_lf(zone->name, lf_storage);
 	assert(lf);
 
-	*trie_get_ins(db->trie, lf + 1, *lf) = zone;
+	trie_val_t *val = (db->cow != NULL) ? trie_get_cow(db->cow, lf + 1, *lf) :
+	                                      trie_get_ins(db->trie, lf + 1, *lf);
+	if (val == NULL) {
+		return KNOT_ENOMEM;
+	}
+	*val = zone;
 
 	return KNOT_EOK;
 }
@@ -85,7 +122,11 @@ int knot_zonedb_del(knot_zonedb_t *db, const knot_dname_t *zone_name)
 		return KNOT_ENOENT;
 	}
 
-	return trie_del(db->trie, lf + 1, *lf, NULL);
+	if (db->cow != NULL) {
+		return trie_del_cow(db->cow, lf + 1, *lf, NULL);
+	} else {
+		return trie_del(db->trie, lf + 1, *lf, NULL);
+	}
 }
 
 zone_t *knot_zonedb_find(knot_zonedb_t *db, const knot_dname_t *zone_name)
@@ -130,12 +171,26 @@ zone_t *knot_zonedb_find_suffix(knot_zonedb_t *db, const knot_dname_t *zone_name
 		return NULL;
 	}
 
+	knot_dname_storage_t lf_storage;
+	uint8_t *lf = knot_dname_lf(zone_name, lf_storage);
+	assert(lf);
+
+	trie_val_t *val = trie_get_longest_prefix(db->trie, lf + 1, *lf);
+	if (val == NULL) {
+		return NULL;
+	}
+
+	zone_t *zone = *val;
+	if (knot_dname_in_bailiwick(zone_name, zone->name) >= 0) {
+		return zone;
+	}
+
+	// Fallback for names with a zero byte inside a label.
 	while (true) {
-		knot_dname_storage_t lf_storage;
-		uint8_t *lf = knot_dname_lf(zone_name, lf_storage);
+		lf = knot_dname_lf(zone_name, lf_storage);
 		assert(lf);
 
-		trie_val_t *val = trie_get_try(db->trie, lf + 1, *lf);
+		val = trie_get_try(db->trie, lf + 1, *lf);
 		if (val != NULL) {
 			return *val;
 		} else if (zone_name[0] == 0) {
@@ -161,7 +216,8 @@ void knot_zonedb_free(knot_zonedb_t **db)
 		return;
 	}
 
-	mp_delete((*db)->mm.ctx);
+	assert((*db)->cow == NULL);
+	trie_free((*db)->trie);
 	free(*db);
 	*db = NULL;
 }
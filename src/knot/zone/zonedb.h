@@ -17,7 +17,7 @@
 
 struct knot_zonedb {
 	trie_t *trie;
-	knot_mm_t mm;
+	trie_cow_t *cow;
 };
 
 /*
@@ -51,6 +51,31 @@ typedef trie_it_t knot_zonedb_iter_t;
  */
 knot_zonedb_t *knot_zonedb_new(void);
 
+/*!
+ * \brief Starts a copy-on-write update of the zone database.
+ *
+ * The returned database shares the unchanged parts with the original one,
+ * which can still be read while the new one is being modified.
+ *
+ * \param db  Zone database to be updated.
+ *
+ * \return New zone database or NULL if an error occurred.
+ */
+knot_zonedb_t *knot_zonedb_cow(knot_zonedb_t *db);
+
+/*!
+ * \brief Finishes the copy-on-write update of the zone database.
+ *
+ * Frees the parts of the original database not shared with the new one and
+ * the original database structure (but not the zones within).
+ *
+ * \note The original database must not be accessed by readers anymore.
+ *
+ * \param db_new  Updated zone database.
+ * \param db_old  Original zone database to be freed.
+ */
+void knot_zonedb_cow_commit(knot_zonedb_t *db_new, knot_zonedb_t **db_old);
+
 /*!
  * \brief Adds new zone to the database.
  *
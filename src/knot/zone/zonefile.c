@@ -7,6 +7,7 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <libgen.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,7 +18,10 @@
 
 #include "libknot/libknot.h"
 #include "contrib/files.h"
+#include "contrib/macros.h"
+#include "contrib/stream_writer.h"
 #include "knot/common/log.h"
+#include "knot/server/dthreads.h"
 #include "knot/dnssec/zone-nsec.h"
 #include "knot/zone/semantic-check.h"
 #include "knot/zone/adjust.h"
@@ -29,6 +33,9 @@
 #define WARNING(zone, fmt, ...) log_zone_warning(zone, "zone loader, " fmt, ##__VA_ARGS__)
 #define NOTICE(zone, fmt, ...) log_zone_notice(zone, "zone loader, " fmt, ##__VA_ARGS__)
 
+/*! \brief Default minimal zone file part size worth parsing in a separate thread. */
+#define ZONEFILE_CHUNK_MIN (32 * 1024 * 1024)
+
 static void process_error(zs_scanner_t *s)
 {
 	zcreator_t *zc = s->process.data;
@@ -218,71 +225,306 @@ int zonefile_open(zloader_t *loader, const char *source, const knot_dname_t *ori
 	loader->creator = zc;
 	loader->semantic_checks = semantic_checks;
 	loader->time = time;
+	loader->chunk_min = ZONEFILE_CHUNK_MIN;
 
 	return KNOT_EOK;
 }
 
-zone_contents_t *zonefile_load(zloader_t *loader, uint16_t threads)
+typedef struct {
+	pthread_t thread;
+	zs_scanner_t *scanner;
+	zcreator_t creator;
+	int ret;
+} parse_chunk_t;
+
+static void *parse_chunk_thread(void *arg)
 {
-	if (!loader) {
-		return NULL;
+	parse_chunk_t *chunk = arg;
+	chunk->ret = zs_parse_all(chunk->scanner);
+	return NULL;
+}
+
+static void chunk_node_free(zone_node_t *node)
+{
+	binode_unify(node, false, NULL);
+	node_free_rrsets(node, NULL);
+	node_free(node, NULL);
+}
+
+typedef struct {
+	zone_contents_t *z;  //!< Loader contents.
+	zone_tree_t *tree;   //!< Tree of the loader contents the nodes are merged into.
+	int ret;
+} merge_ctx_t;
+
+/*!
+ * \brief Moves the chunk node into the loader contents.
+ *
+ * The nodes are visited in the canonical order, so the parent is already
+ * there. Only if the node exists in the loader contents (e.g. the apex or
+ * records of an owner spread over more chunks), its records are added one
+ * by one. Either way, the chunk tree no longer owns the node.
+ */
+static int merge_node(zone_node_t *node, void *data)
+{
+	merge_ctx_t *ctx = data;
+
+	zone_node_t *target = (ctx->ret == KNOT_EOK) ? zone_tree_get(ctx->tree, node->owner) : NULL;
+	if (target != NULL || ctx->ret != KNOT_EOK) {
+		for (uint16_t i = 0; i < node->rrset_count && ctx->ret == KNOT_EOK; i++) {
+			knot_rrset_t rr = node_rrset_at(node, i);
+			ctx->ret = zcreator_step(ctx->z, &rr, NULL);
+		}
+		chunk_node_free(node);
+		return KNOT_EOK;
 	}
 
+	const knot_dname_t *parent_name = knot_dname_next_label(node->owner);
+	zone_node_t *parent = knot_dname_is_equal(parent_name, ctx->z->apex->owner) ?
+	                      ctx->z->apex : zone_tree_get(ctx->z->nodes, parent_name);
+	assert(parent != NULL);
+
+	ctx->ret = zone_tree_insert(ctx->tree, &node);
+	if (ctx->ret != KNOT_EOK) {
+		chunk_node_free(node);
+		return KNOT_EOK;
+	}
+
+	// The children are counted again as they are moved.
+	node->children = 0;
+	node->flags &= ~NODE_FLAGS_WILDCARD_CHILD;
+	node->parent = parent;
+	parent->children++;
+	if (knot_dname_is_wildcard(node->owner)) {
+		parent->flags |= NODE_FLAGS_WILDCARD_CHILD;
+	}
+
+	return KNOT_EOK;
+}
+
+/*!
+ * \brief Merges the chunk contents into the loader contents and frees them.
+ */
+static int merge_chunk(zone_contents_t *z, zone_contents_t *chunk)
+{
+	merge_ctx_t ctx = { .z = z, .tree = z->nodes };
+	(void)zone_tree_apply(chunk->nodes, merge_node, &ctx);
+
+	if (!zone_tree_is_empty(chunk->nsec3_nodes)) {
+		if (z->nsec3_nodes == NULL) {
+			z->nsec3_nodes = zone_tree_create(z->nodes->flags & ZONE_TREE_USE_BINODES);
+			if (z->nsec3_nodes != NULL) {
+				z->nsec3_nodes->flags = z->nodes->flags;
+			} else if (ctx.ret == KNOT_EOK) {
+				ctx.ret = KNOT_ENOMEM;
+			}
+		}
+		ctx.tree = z->nsec3_nodes;
+		(void)zone_tree_apply(chunk->nsec3_nodes, merge_node, &ctx);
+	}
+
+	// All the nodes incl. the apex were moved or freed.
+	zone_contents_free(chunk);
+
+	return ctx.ret;
+}
+
+/*!
+ * \brief Parses the zone file in parallel chunks.
+ *
+ * The first chunk is parsed directly into the loader contents, the other ones
+ * into temporary contents. Their nodes are then moved into the loader
+ * contents chunk after chunk, each chunk in the canonical order.
+ * The results are reported via the loader scanner and creator like with
+ * the sequential parsing.
+ */
+static int parse_parallel(zloader_t *loader, zs_chunk_t *inputs, size_t count)
+{
 	zcreator_t *zc = loader->creator;
+	zs_scanner_t *s = &loader->scanner;
 	const knot_dname_t *zname = zc->z->apex->owner;
 
-	assert(zc);
-	int ret = zs_parse_all(&loader->scanner);
-	if (ret != 0 && loader->scanner.error.counter == 0) {
-		ERROR(zname, "failed to load zone, file '%s' (%s)",
-		      loader->source, zs_strerror(loader->scanner.error.code));
-		goto fail;
+	parse_chunk_t *chunks = calloc(count, sizeof(*chunks));
+	if (chunks == NULL) {
+		s->error.code = ZS_ENOMEM;
+		return -1;
+	}
+
+	int ret = 0;
+	size_t started = 0;
+	for (; started < count; started++) {
+		parse_chunk_t *chunk = &chunks[started];
+		chunk->creator.skip = zc->skip;
+		chunk->creator.z = (started == 0) ? zc->z : zone_contents_new(zname, true);
+		chunk->scanner = malloc(sizeof(*chunk->scanner));
+		if (chunk->creator.z == NULL || chunk->scanner == NULL) {
+			s->error.code = ZS_ENOMEM;
+			ret = -1;
+			break;
+		}
+
+		if (zs_init(chunk->scanner, NULL, s->default_class, s->default_ttl) != 0 ||
+		    zs_set_input_chunk(chunk->scanner, &inputs[started]) != 0 ||
+		    zs_set_processing(chunk->scanner, process_data, process_error,
+		                      &chunk->creator) != 0) {
+			s->error.code = chunk->scanner->error.code;
+			ret = -1;
+			break;
+		}
+
+		if (pthread_create(&chunk->thread, NULL, parse_chunk_thread, chunk) != 0) {
+			s->error.code = ZS_ENOMEM;
+			ret = -1;
+			break;
+		}
 	}
 
-	if (zc->ret != KNOT_EOK) {
-		ERROR(zname, "failed to load zone, file '%s' (%s)",
-		      loader->source, knot_strerror(zc->ret));
-		goto fail;
+	for (size_t i = 0; i < started; i++) {
+		parse_chunk_t *chunk = &chunks[i];
+		(void)pthread_join(chunk->thread, NULL);
+
+		s->error.counter += chunk->scanner->error.counter;
+		if (chunk->ret != 0 && chunk->scanner->error.counter == 0 && ret == 0) {
+			s->error.code = chunk->scanner->error.code;
+			ret = -1;
+		}
+		if (chunk->creator.ret != KNOT_EOK && zc->ret == KNOT_EOK) {
+			zc->ret = chunk->creator.ret;
+		}
 	}
 
-	if (loader->scanner.error.counter > 0) {
-		ERROR(zname, "failed to load zone, file '%s', %"PRIu64" errors",
-		      loader->source, loader->scanner.error.counter);
-		goto fail;
+	for (size_t i = 0; i < count; i++) {
+		parse_chunk_t *chunk = &chunks[i];
+		if (i > 0 && chunk->creator.z != NULL) {
+			if (ret == 0 && zc->ret == KNOT_EOK && s->error.counter == 0) {
+				zc->ret = merge_chunk(zc->z, chunk->creator.z);
+			} else {
+				zone_contents_deep_free(chunk->creator.z);
+			}
+		}
+		if (chunk->scanner != NULL) {
+			zs_deinit(chunk->scanner);
+			free(chunk->scanner);
+		}
+	}
+	free(chunks);
+
+	if (s->error.counter > 0) {
+		return -1;
 	}
 
-	knot_rdataset_t *soa = node_rdataset(zc->z->apex, KNOT_RRTYPE_SOA);
+	return ret;
+}
+
+static int parse_all(zloader_t *loader, uint16_t threads)
+{
+	zs_scanner_t *s = &loader->scanner;
+
+	size_t size = s->input.end - s->input.current;
+	size_t count = MIN(threads == 0 ? dt_optimal_size() : threads,
+	                   size / MAX(loader->chunk_min, 1));
+	if (count <= 1) {
+		return zs_parse_all(s);
+	}
+
+	zs_chunk_t *inputs = malloc(count * sizeof(*inputs));
+	if (inputs == NULL) {
+		return zs_parse_all(s);
+	}
+
+	int ret;
+	if (zs_split_input(s, inputs, &count) != 0 || count <= 1) {
+		s->error.code = ZS_OK;
+		s->error.fatal = false;
+		ret = zs_parse_all(s);
+	} else {
+		ret = parse_parallel(loader, inputs, count);
+	}
+	free(inputs);
+
+	return ret;
+}
+
+int zonefile_check(zone_contents_t *contents, semcheck_optional_t semantic_checks,
+                   sem_handler_t *err_handler, time_t time, uint16_t threads,
+                   const char *source)
+{
+	if (contents == NULL || err_handler == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	const knot_dname_t *zname = contents->apex->owner;
+
+	const knot_rdataset_t *soa = node_rdataset(contents->apex, KNOT_RRTYPE_SOA);
 	if (soa == NULL || soa->count != 1) {
 		sem_error_t code = (soa == NULL) ? SEM_ERR_SOA_NONE : SEM_ERR_SOA_MULTIPLE;
-		loader->err_handler->error = true;
-		loader->err_handler->cb(loader->err_handler, zc->z, NULL, code, NULL);
-		goto fail;
+		err_handler->error = true;
+		err_handler->cb(err_handler, contents, NULL, code, NULL);
+		return KNOT_ESOAINVAL;
 	}
 
-	ret = zone_adjust_contents(zc->z, adjust_cb_flags_and_nsec3, adjust_cb_nsec3_flags,
+	int ret = zone_adjust_contents(contents, adjust_cb_flags_and_nsec3, adjust_cb_nsec3_flags,
 	                           true, true, 1, NULL);
 	if (ret != KNOT_EOK) {
 		ERROR(zname, "failed to finalize zone contents (%s)",
 		      knot_strerror(ret));
-		goto fail;
+		return ret;
 	}
 
-	ret = sem_checks_process(zc->z, loader->semantic_checks,
-	                         loader->err_handler, loader->time, threads);
+	ret = sem_checks_process(contents, semantic_checks,
+	                         err_handler, time, threads);
 
 	if (ret != KNOT_EOK) {
 		ERROR(zname, "failed to load zone, file '%s' (%s)",
-		      loader->source, knot_strerror(ret));
-		goto fail;
+		      source, knot_strerror(ret));
+		return ret;
 	}
 
 	/* The contents will now change possibly messing up NSEC3 tree, it will
 	   be adjusted again at zone_update_commit. */
-	ret = zone_adjust_contents(zc->z, unadjust_cb_point_to_nsec3, NULL,
+	ret = zone_adjust_contents(contents, unadjust_cb_point_to_nsec3, NULL,
 	                           false, false, 1, NULL);
 	if (ret != KNOT_EOK) {
 		ERROR(zname, "failed to finalize zone contents (%s)",
 		      knot_strerror(ret));
+		return ret;
+	}
+
+	return KNOT_EOK;
+}
+
+zone_contents_t *zonefile_load(zloader_t *loader, uint16_t threads)
+{
+	if (!loader) {
+		return NULL;
+	}
+
+	zcreator_t *zc = loader->creator;
+	const knot_dname_t *zname = zc->z->apex->owner;
+
+	assert(zc);
+	int ret = parse_all(loader, threads);
+	if (ret != 0 && loader->scanner.error.counter == 0) {
+		ERROR(zname, "failed to load zone, file '%s' (%s)",
+		      loader->source, zs_strerror(loader->scanner.error.code));
+		goto fail;
+	}
+
+	if (zc->ret != KNOT_EOK) {
+		ERROR(zname, "failed to load zone, file '%s' (%s)",
+		      loader->source, knot_strerror(zc->ret));
+		goto fail;
+	}
+
+	if (loader->scanner.error.counter > 0) {
+		ERROR(zname, "failed to load zone, file '%s', %"PRIu64" errors",
+		      loader->source, loader->scanner.error.counter);
+		goto fail;
+	}
+
+	ret = zonefile_check(zc->z, loader->semantic_checks, loader->err_handler,
+	                     loader->time, threads, loader->source);
+	if (ret != KNOT_EOK) {
 		goto fail;
 	}
 
@@ -311,7 +553,13 @@ int zonefile_exists(const char *path, struct timespec *mtime)
 	return KNOT_EOK;
 }
 
-int zonefile_write(const char *path, zone_contents_t *zone, zone_skip_t *skip)
+static int stream_write(const char *data, size_t len, void *ctx)
+{
+	return stream_writer_write(ctx, data, len);
+}
+
+int zonefile_write(const char *path, zone_contents_t *zone, zone_skip_t *skip,
+                   uint64_t *written)
 {
 	if (path == NULL) {
 		return KNOT_EINVAL;
@@ -335,8 +583,24 @@ int zonefile_write(const char *path, zone_contents_t *zone, zone_skip_t *skip)
 		return ret;
 	}
 
-	ret = zone_dump_text(zone, skip, file, true, NULL);
-	fclose(file);
+	/* Format here and write the output in the background. */
+	stream_writer_t *writer = stream_writer_new(fileno(file), STREAM_WRITER_BUF_SIZE,
+	                                            STREAM_WRITER_BUF_COUNT, true);
+	if (writer == NULL) {
+		fclose(file);
+		unlink(tmp_name);
+		free(tmp_name);
+		return KNOT_ENOMEM;
+	}
+
+	ret = zone_dump_text_cb(zone, skip, stream_write, writer, true, NULL);
+	int ret_write = stream_writer_finish(writer, written);
+	if (ret == KNOT_EOK) {
+		ret = ret_write;
+	}
+	if (fclose(file) != 0 && ret == KNOT_EOK) {
+		ret = knot_map_errno();
+	}
 	if (ret != KNOT_EOK) {
 		unlink(tmp_name);
 		free(tmp_name);
@@ -32,6 +32,7 @@ typedef struct {
 	zcreator_t *creator;         /*!< Loader context. */
 	zs_scanner_t scanner;        /*!< Zone scanner. */
 	time_t time;                 /*!< time for zone check. */
+	size_t chunk_min;            /*!< Minimal file part size parsed in a separate thread. */
 } zloader_t;
 
 void err_handler_logger(sem_handler_t *handler, const zone_contents_t *zone,
@@ -53,11 +54,30 @@ void err_handler_logger(sem_handler_t *handler, const zone_contents_t *zone,
 int zonefile_open(zloader_t *loader, const char *source, const knot_dname_t *origin,
                   uint32_t dflt_ttl, semcheck_optional_t semantic_checks, time_t time);
 
+/*!
+ * \brief Checks loaded zone contents for a SOA record and runs semantic checks.
+ *
+ * \param contents Zone contents.
+ * \param semantic_checks Perform semantic checks.
+ * \param err_handler Semantic checks error handler.
+ * \param time Time for semantic check.
+ * \param threads The number of threads to use for semantic checks (0 for auto).
+ * \param source Source file name for logging.
+ *
+ * \return KNOT_E*
+ */
+int zonefile_check(zone_contents_t *contents, semcheck_optional_t semantic_checks,
+                   sem_handler_t *err_handler, time_t time, uint16_t threads,
+                   const char *source);
+
 /*!
  * \brief Loads zone from a zone file.
  *
+ * Large zone files are split into parts parsed in parallel.
+ *
  * \param loader Zone loader instance.
- * \param threads The number of threads to use for semantic checks (0 for auto).
+ * \param threads The number of threads to use for parsing and semantic checks
+ *                (0 for auto).
  *
  * \retval Loaded zone contents on success.
  * \retval NULL otherwise.
@@ -80,10 +100,12 @@ int zonefile_exists(const char *path, struct timespec *mtime);
  * \param path    Zonefile path.
  * \param zone    Zone contents.
  * \param skip    RRTypes to be skipped.
+ * \param written Optional output of the zone file size.
  *
  * \return KNOT_E*
  */
-int zonefile_write(const char *path, zone_contents_t *zone, zone_skip_t *skip);
+int zonefile_write(const char *path, zone_contents_t *zone, zone_skip_t *skip,
+                   uint64_t *written);
 
 /*!
  * \brief Close zone file loader.
@@ -95,6 +95,26 @@ int dnssec_nsec3_hash(const dnssec_binary_t *data,
 		      const dnssec_nsec3_params_t *params,
 		      dnssec_binary_t *hash);
 
+/*!
+ * Compute NSEC3 hashes for several data items at once.
+ *
+ * The hashes are computed in parallel using SIMD instructions (AVX2 or
+ * AVX-512) if the CPU supports them, otherwise one by one.
+ *
+ * \todo Input data must be converted to lowercase!
+ *
+ * \param[in]  data    Data items to be hashed (usually domain names).
+ * \param[in]  count   Number of data items.
+ * \param[in]  params  NSEC3 parameters.
+ * \param[out] hashes  Output buffer for count raw hashes, each of
+ *                     dnssec_nsec3_hash_length() bytes, stored consecutively.
+ *
+ * \return Error code, DNSSEC_EOK if successful.
+ */
+int dnssec_nsec3_hash_many(const dnssec_binary_t *data, size_t count,
+			   const dnssec_nsec3_params_t *params,
+			   uint8_t *hashes);
+
 /*!
  * Get length of raw NSEC3 hash for a given algorithm.
  *
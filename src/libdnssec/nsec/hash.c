@@ -10,15 +10,68 @@
 
 #include "libdnssec/error.h"
 #include "libdnssec/nsec.h"
+#include "libdnssec/nsec/sha1mb.h"
 #include "libdnssec/shared/shared.h"
 
 /*!
- * Compute NSEC3 hash for given data and algorithm.
+ * Multi-buffer SHA-1 selected by CPU detection, NULL for the GnuTLS path.
+ */
+sha1mb_nsec3_t SHA1MB = NULL;
+
+/*
+ * The explicit references of the SIMD variants ensure the optimized code isn't
+ * removed by linker if linking statically.
+ */
+__attribute__((constructor))
+static void sha1mb_detect(void)
+{
+#if defined(__x86_64__) && (__clang_major__ >= 5 || __GNUC__ >= 6) && !defined(__APPLE__)
+	__builtin_cpu_init();
+	if (SHA1MB_AVX512 != NULL && __builtin_cpu_supports("avx512f")) {
+		SHA1MB = SHA1MB_AVX512;
+	} else if (SHA1MB_AVX2 != NULL && __builtin_cpu_supports("avx2")) {
+		SHA1MB = SHA1MB_AVX2;
+	}
+#endif
+}
+
+/*!
+ * Compute NSEC3 hash using an initialized digest context.
  *
  * \see RFC 5155
  *
  * \todo Input data should be converted to lowercase.
  */
+static int nsec3_hash_digest(gnutls_hash_hd_t digest, size_t hash_size,
+			     int iterations, const dnssec_binary_t *salt,
+			     const dnssec_binary_t *data, uint8_t *hash)
+{
+	const uint8_t *in = data->data;
+	size_t in_size = data->size;
+
+	for (int i = 0; i <= iterations; i++) {
+		int result = gnutls_hash(digest, in, in_size);
+		if (result < 0) {
+			return DNSSEC_NSEC3_HASHING_ERROR;
+		}
+
+		result = gnutls_hash(digest, salt->data, salt->size);
+		if (result < 0) {
+			return DNSSEC_NSEC3_HASHING_ERROR;
+		}
+
+		gnutls_hash_output(digest, hash);
+
+		in = hash;
+		in_size = hash_size;
+	}
+
+	return DNSSEC_EOK;
+}
+
+/*!
+ * Compute NSEC3 hash for given data and algorithm.
+ */
 static int nsec3_hash(gnutls_digest_algorithm_t algorithm, int iterations,
 		      const dnssec_binary_t *salt, const dnssec_binary_t *data,
 		      dnssec_binary_t *hash)
@@ -43,27 +96,28 @@ static int nsec3_hash(gnutls_digest_algorithm_t algorithm, int iterations,
 		return DNSSEC_NSEC3_HASHING_ERROR;
 	}
 
-	const uint8_t *in = data->data;
-	size_t in_size = data->size;
+	return nsec3_hash_digest(digest, hash_size, iterations, salt, data, hash->data);
+}
 
-	for (int i = 0; i <= iterations; i++) {
-		result = gnutls_hash(digest, in, in_size);
-		if (result < 0) {
-			return DNSSEC_NSEC3_HASHING_ERROR;
-		}
+/*!
+ * Check if the inputs fit the multi-buffer SHA-1 implementation.
+ */
+static bool sha1mb_usable(gnutls_digest_algorithm_t algorithm,
+			  const dnssec_binary_t *salt,
+			  const dnssec_binary_t *data, size_t count)
+{
+	if (SHA1MB == NULL || algorithm != GNUTLS_DIG_SHA1 ||
+	    salt->size > SHA1MB_MAX_INPUT) {
+		return false;
+	}
 
-		result = gnutls_hash(digest, salt->data, salt->size);
-		if (result < 0) {
-			return DNSSEC_NSEC3_HASHING_ERROR;
+	for (size_t i = 0; i < count; i++) {
+		if (data[i].size > SHA1MB_MAX_INPUT) {
+			return false;
 		}
-
-		gnutls_hash_output(digest, hash->data);
-
-		in = hash->data;
-		in_size = hash->size;
 	}
 
-	return DNSSEC_EOK;
+	return true;
 }
 
 /*!
@@ -99,6 +153,51 @@ int dnssec_nsec3_hash(const dnssec_binary_t *data,
 	return nsec3_hash(algorithm, params->iterations, &params->salt, data, hash);
 }
 
+/*!
+ * Compute NSEC3 hashes for several data items at once.
+ */
+_public_
+int dnssec_nsec3_hash_many(const dnssec_binary_t *data, size_t count,
+			   const dnssec_nsec3_params_t *params,
+			   uint8_t *hashes)
+{
+	if ((!data && count > 0) || !params || !hashes) {
+		return DNSSEC_EINVAL;
+	}
+
+	gnutls_digest_algorithm_t algorithm = algorithm_d2g(params->algorithm);
+	if (algorithm == GNUTLS_DIG_UNKNOWN) {
+		return DNSSEC_INVALID_NSEC3_ALGORITHM;
+	}
+
+	if (sha1mb_usable(algorithm, &params->salt, data, count)) {
+		SHA1MB(data, count, &params->salt, params->iterations, hashes);
+		return DNSSEC_EOK;
+	}
+
+	// Scalar fallback, at least the digest context is shared.
+	int hash_size = gnutls_hash_get_len(algorithm);
+	if (hash_size <= 0) {
+		return DNSSEC_NSEC3_HASHING_ERROR;
+	}
+
+	_cleanup_hash_ gnutls_hash_hd_t digest = NULL;
+	if (gnutls_hash_init(&digest, algorithm) < 0) {
+		return DNSSEC_NSEC3_HASHING_ERROR;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		int result = nsec3_hash_digest(digest, hash_size, params->iterations,
+					       &params->salt, &data[i],
+					       hashes + i * hash_size);
+		if (result != DNSSEC_EOK) {
+			return result;
+		}
+	}
+
+	return DNSSEC_EOK;
+}
+
 /*!
  * Get length of raw NSEC3 hash for a given algorithm.
  */
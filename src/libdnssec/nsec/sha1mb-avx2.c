@@ -0,0 +1,40 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include "libdnssec/nsec/sha1mb.h"
+
+// Same compiler requirements as for the AVX2 variant of KRU.
+#if defined(__x86_64__) && (__clang_major__ >= 5 || __GNUC__ >= 6) && !defined(__APPLE__)
+
+#ifdef __clang__
+	#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+	#pragma GCC push_options
+	#pragma GCC target("avx2")
+	#pragma GCC optimize("O3")
+#endif
+
+// Eight 32-bit lanes in a 256-bit register.
+#define LANES		8
+#define SHA1MB_FUNC	sha1mb_avx2
+
+void SHA1MB_FUNC(const dnssec_binary_t *data, size_t count,
+                 const dnssec_binary_t *salt, unsigned iterations,
+                 uint8_t *out);
+
+#include "./sha1mb.inc.c"
+const sha1mb_nsec3_t SHA1MB_AVX2 = sha1mb_avx2;
+
+#ifdef __clang__
+	#pragma clang attribute pop
+#else
+	#pragma GCC pop_options
+#endif
+
+#else
+
+const sha1mb_nsec3_t SHA1MB_AVX2 = NULL;
+
+#endif
@@ -0,0 +1,43 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libdnssec/binary.h"
+
+/*! \brief Length of SHA-1 output. */
+#define SHA1MB_HASH_SIZE	20
+/*! \brief Maximum name or salt length handled by the multi-buffer hashing. */
+#define SHA1MB_MAX_INPUT	255
+/*! \brief Maximum number of SHA-1 blocks of the initial NSEC3 hash input. */
+#define SHA1MB_MAX_BLOCKS	((2 * SHA1MB_MAX_INPUT + 8) / 64 + 1)
+
+/*!
+ * \brief Compute NSEC3 SHA-1 hashes of several names at once.
+ *
+ * \param data        Names (each at most SHA1MB_MAX_INPUT bytes).
+ * \param count       Number of names.
+ * \param salt        NSEC3 salt (at most SHA1MB_MAX_INPUT bytes).
+ * \param iterations  Number of additional iterations.
+ * \param out         Output of count * SHA1MB_HASH_SIZE bytes.
+ */
+typedef void (*sha1mb_nsec3_t)(const dnssec_binary_t *data, size_t count,
+                               const dnssec_binary_t *salt, unsigned iterations,
+                               uint8_t *out);
+
+/*!
+ * \brief Multi-buffer implementations, NULL if not built for this platform.
+ */
+extern const sha1mb_nsec3_t SHA1MB_AVX2, SHA1MB_AVX512;
+
+/*!
+ * \brief The best implementation for this CPU, NULL if none is usable.
+ *
+ * Selected by CPU detection in hash.c.
+ */
+extern sha1mb_nsec3_t SHA1MB;
@@ -0,0 +1,182 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+/*
+ * Multi-buffer SHA-1 for NSEC3 hashing.
+ *
+ * Each vector lane computes the NSEC3 hash of one name, so LANES names are
+ * hashed at once. The including file defines LANES and SHA1MB_FUNC and sets
+ * the target instruction set, the compiler maps the vector operations onto it.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libdnssec/nsec/sha1mb.h"
+
+typedef uint32_t vec_t __attribute__((vector_size(4 * LANES)));
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define ROUND(f, k) { \
+	vec_t tmp = ROL(a, 5) + (f) + e + (k) + w[t & 15]; \
+	e = d; d = c; c = ROL(b, 30); b = a; a = tmp; \
+}
+
+#define SCHEDULE() if (t >= 16) { \
+	vec_t x = w[(t - 3) & 15] ^ w[(t - 8) & 15] ^ w[(t - 14) & 15] ^ w[t & 15]; \
+	w[t & 15] = ROL(x, 1); \
+}
+
+static const uint32_t sha1_init[5] = {
+	0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+};
+
+static inline uint32_t read_be32(const uint8_t *p)
+{
+	return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static inline void write_be32(uint8_t *p, uint32_t v)
+{
+	p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static inline vec_t broadcast(uint32_t v)
+{
+	vec_t r;
+	for (int i = 0; i < LANES; i++) {
+		r[i] = v;
+	}
+	return r;
+}
+
+static void compress(vec_t st[5], const vec_t msg[16])
+{
+	vec_t w[16];
+	memcpy(w, msg, sizeof(w));
+
+	vec_t a = st[0], b = st[1], c = st[2], d = st[3], e = st[4];
+	int t = 0;
+	for (; t < 20; t++) {
+		SCHEDULE();
+		ROUND(d ^ (b & (c ^ d)), 0x5A827999);
+	}
+	for (; t < 40; t++) {
+		SCHEDULE();
+		ROUND(b ^ c ^ d, 0x6ED9EBA1);
+	}
+	for (; t < 60; t++) {
+		SCHEDULE();
+		ROUND((b & c) | (d & (b | c)), 0x8F1BBCDC);
+	}
+	for (; t < 80; t++) {
+		SCHEDULE();
+		ROUND(b ^ c ^ d, 0xCA62C1D6);
+	}
+
+	st[0] += a; st[1] += b; st[2] += c; st[3] += d; st[4] += e;
+}
+
+/*! \brief Pad the message in place, return the number of blocks. */
+static size_t pad(uint8_t *msg, size_t len)
+{
+	size_t blocks = (len + 8) / 64 + 1;
+	memset(msg + len, 0, blocks * 64 - len);
+	msg[len] = 0x80;
+	uint64_t bits = (uint64_t)len * 8;
+	write_be32(msg + blocks * 64 - 8, bits >> 32);
+	write_be32(msg + blocks * 64 - 4, bits);
+	return blocks;
+}
+
+/*!
+ * \brief Hash up to LANES names, the first iteration with different lengths.
+ */
+static void sha1mb_lanes(const dnssec_binary_t *data, size_t count,
+                         const dnssec_binary_t *salt, unsigned iterations,
+                         uint8_t *out)
+{
+	uint8_t msg[LANES][SHA1MB_MAX_BLOCKS * 64];
+	size_t blocks[LANES] = { 0 };
+	size_t max_blocks = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		memcpy(msg[i], data[i].data, data[i].size);
+		memcpy(msg[i] + data[i].size, salt->data, salt->size);
+		blocks[i] = pad(msg[i], data[i].size + salt->size);
+		if (blocks[i] > max_blocks) {
+			max_blocks = blocks[i];
+		}
+	}
+
+	vec_t st[5];
+	for (int j = 0; j < 5; j++) {
+		st[j] = broadcast(sha1_init[j]);
+	}
+
+	// Initial hash, lanes with a shorter message keep their state.
+	for (size_t blk = 0; blk < max_blocks; blk++) {
+		vec_t w[16], mask;
+		for (int lane = 0; lane < LANES; lane++) {
+			bool active = blk < blocks[lane];
+			mask[lane] = active ? UINT32_MAX : 0;
+			for (int j = 0; j < 16; j++) {
+				w[j][lane] = active ? read_be32(msg[lane] + blk * 64 + j * 4) : 0;
+			}
+		}
+
+		vec_t prev[5];
+		memcpy(prev, st, sizeof(prev));
+		compress(st, w);
+		for (int j = 0; j < 5; j++) {
+			st[j] = (st[j] & mask) | (prev[j] & ~mask);
+		}
+	}
+
+	// Iterations over the previous hash and salt, equal for all lanes.
+	if (iterations > 0) {
+		uint8_t tail[SHA1MB_MAX_BLOCKS * 64];
+		memset(tail, 0, SHA1MB_HASH_SIZE);
+		memcpy(tail + SHA1MB_HASH_SIZE, salt->data, salt->size);
+		size_t tail_blocks = pad(tail, SHA1MB_HASH_SIZE + salt->size);
+
+		vec_t tail_w[SHA1MB_MAX_BLOCKS * 16];
+		for (size_t j = 0; j < tail_blocks * 16; j++) {
+			tail_w[j] = broadcast(read_be32(tail + j * 4));
+		}
+
+		for (unsigned it = 0; it < iterations; it++) {
+			// The previous hash makes up the first five message words.
+			memcpy(tail_w, st, sizeof(st));
+			for (int j = 0; j < 5; j++) {
+				st[j] = broadcast(sha1_init[j]);
+			}
+			for (size_t blk = 0; blk < tail_blocks; blk++) {
+				compress(st, tail_w + blk * 16);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		for (int j = 0; j < 5; j++) {
+			write_be32(out + i * SHA1MB_HASH_SIZE + j * 4, st[j][i]);
+		}
+	}
+}
+
+void SHA1MB_FUNC(const dnssec_binary_t *data, size_t count,
+                 const dnssec_binary_t *salt, unsigned iterations,
+                 uint8_t *out)
+{
+	while (count > 0) {
+		size_t batch = (count < LANES) ? count : LANES;
+		sha1mb_lanes(data, batch, salt, iterations, out);
+		data += batch;
+		count -= batch;
+		out += batch * SHA1MB_HASH_SIZE;
+	}
+}
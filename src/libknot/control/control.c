@@ -34,6 +34,10 @@
 /*! The first data item code. */
 #define DATA_CODE_OFFSET	16
 
+/*! Maximum binary unit payload size, limited by the buffer size too. */
+#define BIN_MAX_SIZE		(KNOT_CTL_BIN_MAX < CTL_BUFF_SIZE ? \
+				 KNOT_CTL_BIN_MAX : CTL_BUFF_SIZE)
+
 /*! Control context structure. */
 struct knot_ctl {
 	/*! Memory pool context. */
@@ -47,6 +51,10 @@ struct knot_ctl {
 
 	/*! The latter read data. */
 	knot_ctl_data_t data;
+	/*! The latter read binary data (points to the read buffer). */
+	const uint8_t *bin;
+	/*! The latter read binary data length. */
+	size_t bin_len;
 
 	/*! Write wire context. */
 	wire_ctx_t wire_out;
@@ -66,6 +74,7 @@ static int type_to_code(knot_ctl_type_t type)
 	case KNOT_CTL_TYPE_DATA:  return  1;
 	case KNOT_CTL_TYPE_EXTRA: return  2;
 	case KNOT_CTL_TYPE_BLOCK: return  3;
+	case KNOT_CTL_TYPE_BIN:   return  4;
 	default:                  return -1;
 	}
 }
@@ -77,6 +86,7 @@ static int code_to_type(uint8_t code)
 	case 1:  return KNOT_CTL_TYPE_DATA;
 	case 2:  return KNOT_CTL_TYPE_EXTRA;
 	case 3:  return KNOT_CTL_TYPE_BLOCK;
+	case 4:  return KNOT_CTL_TYPE_BIN;
 	default: return -1;
 	}
 }
@@ -121,6 +131,8 @@ static void clean_data(knot_ctl_t *ctx)
 {
 	mp_flush(ctx->mm.ctx);
 	memzero(ctx->data, sizeof(ctx->data));
+	ctx->bin = NULL;
+	ctx->bin_len = 0;
 }
 
 static void close_sock(int *sock)
@@ -305,7 +317,7 @@ void knot_ctl_close(knot_ctl_t *ctx)
 	close_sock(&ctx->sock);
 }
 
-static int ensure_output(knot_ctl_t *ctx, uint16_t len)
+static int ensure_output(knot_ctl_t *ctx, size_t len)
 {
 	wire_ctx_t *w = &ctx->wire_out;
 
@@ -391,9 +403,9 @@ int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data)
 		return KNOT_EINVAL;
 	}
 
-	// Get the type code.
+	// Get the type code, binary units must be sent with knot_ctl_send_bin().
 	int code = type_to_code(type);
-	if (code == -1) {
+	if (code == -1 || type == KNOT_CTL_TYPE_BIN) {
 		return KNOT_EINVAL;
 	}
 
@@ -422,7 +434,46 @@ int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data)
 	return KNOT_EOK;
 }
 
-static int ensure_input(knot_ctl_t *ctx, uint16_t len)
+_public_
+int knot_ctl_send_bin(knot_ctl_t *ctx, const uint8_t *data, size_t len)
+{
+	if (ctx == NULL || (data == NULL && len > 0)) {
+		return KNOT_EINVAL;
+	}
+
+	if (len > BIN_MAX_SIZE) {
+		return KNOT_ERANGE;
+	}
+
+	wire_ctx_t *w = &ctx->wire_out;
+
+	// Send unit type.
+	int ret = send_item(ctx, type_to_code(KNOT_CTL_TYPE_BIN), NULL, false);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	// Write the payload length.
+	ret = ensure_output(ctx, sizeof(uint32_t));
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	wire_ctx_write_u32(w, len);
+	if (w->error != KNOT_EOK) {
+		return w->error;
+	}
+
+	// Write the payload.
+	ret = ensure_output(ctx, len);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	wire_ctx_write(w, data, len);
+
+	return w->error;
+}
+
+static int ensure_input(knot_ctl_t *ctx, size_t len)
 {
 	wire_ctx_t *w = &ctx->wire_in;
 
@@ -501,6 +552,35 @@ static int receive_item_value(knot_ctl_t *ctx, char **value)
 	return KNOT_EOK;
 }
 
+static int receive_bin(knot_ctl_t *ctx)
+{
+	wire_ctx_t *w = &ctx->wire_in;
+
+	// Read payload length.
+	int ret = ensure_input(ctx, sizeof(uint32_t));
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	uint32_t len = wire_ctx_read_u32(w);
+	if (w->error != KNOT_EOK) {
+		return w->error;
+	}
+	if (len > BIN_MAX_SIZE) {
+		return KNOT_EMALF;
+	}
+
+	// Keep the payload in the input buffer until the next receive.
+	ret = ensure_input(ctx, len);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	ctx->bin = w->position;
+	ctx->bin_len = len;
+	wire_ctx_skip(w, len);
+
+	return w->error;
+}
+
 _public_
 int knot_ctl_receive(knot_ctl_t *ctx, knot_ctl_type_t *type, knot_ctl_data_t *data)
 {
@@ -539,6 +619,12 @@ int knot_ctl_receive(knot_ctl_t *ctx, knot_ctl_type_t *type, knot_ctl_data_t *da
 			if (is_data_type(current_type)) {
 				have_type = true;
 				continue;
+			} else if (current_type == KNOT_CTL_TYPE_BIN) {
+				ret = receive_bin(ctx);
+				if (ret != KNOT_EOK) {
+					return ret;
+				}
+				break;
 			} else {
 				break;
 			}
@@ -564,3 +650,15 @@ int knot_ctl_receive(knot_ctl_t *ctx, knot_ctl_type_t *type, knot_ctl_data_t *da
 
 	return KNOT_EOK;
 }
+
+_public_
+const uint8_t *knot_ctl_bin(knot_ctl_t *ctx, size_t *len)
+{
+	if (ctx == NULL || len == NULL) {
+		return NULL;
+	}
+
+	*len = ctx->bin_len;
+
+	return ctx->bin;
+}
@@ -14,6 +14,12 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+/*! Maximum payload size of a binary control unit. */
+#define KNOT_CTL_BIN_MAX	(128 * 1024)
+
 /*! Control data item indexes. */
 typedef enum {
 	KNOT_CTL_IDX_CMD = 0, /*!< Control command name. */
@@ -37,6 +43,7 @@ typedef enum {
 	KNOT_CTL_TYPE_DATA,  /*!< Data unit, cached. */
 	KNOT_CTL_TYPE_EXTRA, /*!< Extra value data unit, cached. */
 	KNOT_CTL_TYPE_BLOCK, /*!< End of data block, cache flushed. */
+	KNOT_CTL_TYPE_BIN,   /*!< Binary data unit, cached. */
 } knot_ctl_type_t;
 
 /*! Control input/output string data. */
@@ -149,6 +156,17 @@ void knot_ctl_close(knot_ctl_t *ctx);
  */
 int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data);
 
+/*!
+ * Sends one binary data unit.
+ *
+ * \param[in] ctx   Control context.
+ * \param[in] data  Unit payload.
+ * \param[in] len   Payload length (at most KNOT_CTL_BIN_MAX).
+ *
+ * \return Error code, KNOT_EOK if successful.
+ */
+int knot_ctl_send_bin(knot_ctl_t *ctx, const uint8_t *data, size_t len);
+
 /*!
  * Receives one control unit.
  *
@@ -160,4 +178,14 @@ int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data);
  */
 int knot_ctl_receive(knot_ctl_t *ctx, knot_ctl_type_t *type, knot_ctl_data_t *data);
 
+/*!
+ * Returns the payload of the latter received binary data unit.
+ *
+ * \param[in] ctx   Control context.
+ * \param[out] len  Payload length.
+ *
+ * \return Payload valid until the next receive, NULL if no binary unit received.
+ */
+const uint8_t *knot_ctl_bin(knot_ctl_t *ctx, size_t *len);
+
 /*! @} */
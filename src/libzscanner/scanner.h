@@ -79,6 +79,32 @@ typedef enum {
 	ZS_STATE_STOP      /*!< Early stop (possibly set from a callback). */
 } zs_state_t;
 
+/*!
+ * \brief Independently parsable part of the scanner input.
+ *
+ * Each chunk starts at a line with an explicit owner outside of a multi-line
+ * record and carries the parser state ($ORIGIN, $TTL, line number) valid
+ * at its beginning.
+ */
+typedef struct {
+	/*! Start of the chunk data. */
+	const char *start;
+	/*! End of the chunk data. */
+	const char *end;
+	/*! Line number of the chunk start. */
+	uint64_t line_counter;
+	/*! Value of the default ttl at the chunk start. */
+	uint32_t default_ttl;
+	/*! Length of the origin at the chunk start. */
+	uint32_t zone_origin_length;
+	/*! Wire format of the origin at the chunk start. */
+	uint8_t  zone_origin[ZS_MAX_DNAME_LENGTH + ZS_MAX_LABEL_LENGTH];
+	/*! Path for relative includes (owned by the splitting scanner). */
+	const char *path;
+	/*! Zone file name (owned by the splitting scanner). */
+	const char *file_name;
+} zs_chunk_t;
+
 /*!
  * \brief Context structure for zone scanner.
  *
@@ -322,6 +348,46 @@ int zs_set_input_file(
 	const char *file_name
 );
 
+/*!
+ * \brief Splits the remaining scanner input into chunks for parallel parsing.
+ *
+ * The input is split into at most *count parts of similar size. Quoted
+ * strings, comments, and parentheses are followed so that no record is cut,
+ * and $ORIGIN and $TTL directives are evaluated to set up the chunk states.
+ * The scanner input itself is not consumed.
+ *
+ * \note The chunks refer to the scanner input, which must stay valid
+ *       while the chunks are in use.
+ *
+ * \param scanner  Scanner context with the input set.
+ * \param chunks   Output array of chunks.
+ * \param count    Size of the array on input, number of chunks on output.
+ *
+ * \retval  0  if success.
+ * \retval -1  if error.
+ */
+int zs_split_input(
+	zs_scanner_t *scanner,
+	zs_chunk_t *chunks,
+	size_t *count
+);
+
+/*!
+ * \brief Sets the scanner to parse a chunk obtained from zs_split_input.
+ *
+ * \note Error code is stored in the scanner context.
+ *
+ * \param scanner  Scanner context.
+ * \param chunk    Input chunk to parse.
+ *
+ * \retval  0  if success.
+ * \retval -1  if error.
+ */
+int zs_set_input_chunk(
+	zs_scanner_t *scanner,
+	const zs_chunk_t *chunk
+);
+
 /*!
  * \brief Sets the scanner processing callbacks for automatic processing.
  *
@@ -0,0 +1,249 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "libzscanner/scanner.h"
+#include "libknot/attribute.h"
+
+/*! \brief Parser state at a possible chunk boundary. */
+typedef struct {
+	uint64_t line_counter;
+	uint32_t default_ttl;
+	uint32_t zone_origin_length;
+	uint8_t  zone_origin[ZS_MAX_DNAME_LENGTH + ZS_MAX_LABEL_LENGTH];
+} split_state_t;
+
+static void set_error(
+	zs_scanner_t *s,
+	int code)
+{
+	s->error.code = code;
+	s->error.fatal = true;
+}
+
+static bool is_directive(
+	const char *line,
+	const char *end,
+	const char *name)
+{
+	size_t len = strlen(name);
+	if (end - line <= len || strncasecmp(line, name, len) != 0) {
+		return false;
+	}
+
+	return line[len] == ' ' || line[len] == '\t';
+}
+
+/*!
+ * \brief Replays an $ORIGIN or $TTL directive line to update the state.
+ *
+ * Invalid directives are ignored here, they are reported by the chunk parser.
+ */
+static int replay_directive(
+	zs_scanner_t *tmp,
+	uint16_t rclass,
+	split_state_t *state,
+	const char *line,
+	size_t line_len)
+{
+	if (zs_init(tmp, NULL, rclass, state->default_ttl) != 0) {
+		zs_deinit(tmp);
+		return -1;
+	}
+	memcpy(tmp->zone_origin, state->zone_origin, state->zone_origin_length);
+	tmp->zone_origin_length = state->zone_origin_length;
+
+	if (zs_set_input_string(tmp, line, line_len) == 0 &&
+	    zs_parse_all(tmp) == 0) {
+		memcpy(state->zone_origin, tmp->zone_origin, tmp->zone_origin_length);
+		state->zone_origin_length = tmp->zone_origin_length;
+		state->default_ttl = tmp->default_ttl;
+	}
+
+	zs_deinit(tmp);
+
+	return 0;
+}
+
+static void chunk_open(
+	zs_chunk_t *chunk,
+	const char *start,
+	const split_state_t *state,
+	const zs_scanner_t *s)
+{
+	chunk->start = start;
+	chunk->end = NULL;
+	chunk->line_counter = state->line_counter;
+	chunk->default_ttl = state->default_ttl;
+	chunk->zone_origin_length = state->zone_origin_length;
+	memcpy(chunk->zone_origin, state->zone_origin, state->zone_origin_length);
+	chunk->path = s->path;
+	chunk->file_name = s->file.name;
+}
+
+_public_
+int zs_split_input(
+	zs_scanner_t *s,
+	zs_chunk_t *chunks,
+	size_t *count)
+{
+	if (s == NULL) {
+		return -1;
+	}
+
+	if (chunks == NULL || count == NULL || *count == 0 ||
+	    s->input.current == NULL) {
+		set_error(s, ZS_EINVAL);
+		return -1;
+	}
+
+	const char *begin = s->input.current;
+	const char *end = s->input.end;
+	size_t total = end - begin;
+	size_t max = *count;
+	size_t n = 0;
+
+	split_state_t state = {
+		.line_counter = s->line_counter,
+		.default_ttl = s->default_ttl,
+		.zone_origin_length = s->zone_origin_length,
+	};
+	memcpy(state.zone_origin, s->zone_origin, s->zone_origin_length);
+
+	chunk_open(&chunks[0], begin, &state, s);
+
+	zs_scanner_t *tmp = NULL;
+	unsigned parentheses = 0;
+	bool quoted = false;
+	bool line_start = true;
+
+	for (const char *p = begin; p < end; p++) {
+		if (line_start && parentheses == 0) {
+			line_start = false;
+			if (*p == '$' && (is_directive(p, end, "$ORIGIN") ||
+			                  is_directive(p, end, "$TTL"))) {
+				const char *eol = memchr(p, '\n', end - p);
+				eol = (eol != NULL) ? eol + 1 : end;
+
+				if (tmp == NULL && (tmp = malloc(sizeof(*tmp))) == NULL) {
+					set_error(s, ZS_ENOMEM);
+					return -1;
+				}
+				if (replay_directive(tmp, s->default_class, &state,
+				                     p, eol - p) != 0) {
+					free(tmp);
+					set_error(s, ZS_ENOMEM);
+					return -1;
+				}
+			} else if (n + 1 < max && strchr(" \t\r\n;$()\"", *p) == NULL &&
+			           (size_t)(p - begin) >= (n + 1) * (total / max)) {
+				// Only a line with an explicit owner can start a chunk.
+				chunks[n].end = p;
+				chunk_open(&chunks[++n], p, &state, s);
+			}
+		}
+
+		if (quoted) {
+			switch (*p) {
+			case '\\':
+				if (p + 1 < end && *(++p) == '\n') {
+					state.line_counter++;
+				}
+				break;
+			case '"':
+				quoted = false;
+				break;
+			case '\n':
+				state.line_counter++;
+				break;
+			}
+			continue;
+		}
+
+		switch (*p) {
+		case '\\':
+			if (p + 1 < end && *(++p) == '\n') {
+				state.line_counter++;
+			}
+			break;
+		case '"':
+			quoted = true;
+			break;
+		case ';':
+			while (p + 1 < end && *(p + 1) != '\n') {
+				p++;
+			}
+			break;
+		case '(':
+			parentheses++;
+			break;
+		case ')':
+			if (parentheses > 0) {
+				parentheses--;
+			}
+			break;
+		case '\n':
+			state.line_counter++;
+			line_start = true;
+			break;
+		}
+	}
+
+	free(tmp);
+
+	chunks[n].end = end;
+	*count = n + 1;
+
+	return 0;
+}
+
+_public_
+int zs_set_input_chunk(
+	zs_scanner_t *s,
+	const zs_chunk_t *chunk)
+{
+	if (s == NULL) {
+		return -1;
+	}
+
+	if (chunk == NULL || chunk->start == NULL || chunk->end < chunk->start) {
+		set_error(s, ZS_EINVAL);
+		return -1;
+	}
+
+	if (zs_set_input_string(s, chunk->start, chunk->end - chunk->start) != 0) {
+		return -1;
+	}
+
+	memcpy(s->zone_origin, chunk->zone_origin, chunk->zone_origin_length);
+	s->zone_origin_length = chunk->zone_origin_length;
+	s->default_ttl = chunk->default_ttl;
+	s->line_counter = chunk->line_counter;
+
+	if (chunk->path != NULL) {
+		char *path = strdup(chunk->path);
+		if (path == NULL) {
+			set_error(s, ZS_ENOMEM);
+			return -1;
+		}
+		free(s->path);
+		s->path = path;
+	}
+
+	if (chunk->file_name != NULL) {
+		s->file.name = strdup(chunk->file_name);
+		if (s->file.name == NULL) {
+			set_error(s, ZS_ENOMEM);
+			return -1;
+		}
+	}
+
+	return 0;
+}
@@ -276,6 +276,15 @@ int print_journal(char *path, knot_dname_t *name, print_params_t *params)
 		printf("Total number of changesets:  %zu\n", params->changes);
 		printf("Occupied this zone (approx): %"PRIu64" KiB\n", occupied / 1024);
 		printf("Occupied all zones together: %"PRIu64" KiB\n", occupied_all / 1024);
+
+		bool compressed;
+		uint64_t stored, raw;
+		ret = journal_chunk_sizes(j, &compressed, &stored, &raw);
+		if (ret == KNOT_EOK) {
+			printf("Compression:                 %s\n", compressed ? "zstd" : "none");
+			printf("Changesets stored size:      %"PRIu64" KiB\n", stored / 1024);
+			printf("Changesets uncompressed:     %"PRIu64" KiB\n", raw / 1024);
+		}
 	}
 
 	changeset_free(params->merged);
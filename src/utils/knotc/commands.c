@@ -384,7 +384,25 @@ static void format_block(ctl_cmd_t cmd, bool failed, bool empty)
 	}
 }
 
-static int ctl_receive(cmd_args_t *args)
+static int write_bin(cmd_args_t *args, FILE *bin_out)
+{
+	if (bin_out == NULL) {
+		log_error(CTL_LOG_STR" (%s)", knot_strerror(KNOT_EMALF));
+		return KNOT_EMALF;
+	}
+
+	size_t len;
+	const uint8_t *bin = knot_ctl_bin(args->ctl, &len);
+	if (fwrite(bin, 1, len, bin_out) != len) {
+		int ret = knot_map_errno();
+		log_error("failed to write records (%s)", knot_strerror(ret));
+		return ret;
+	}
+
+	return KNOT_EOK;
+}
+
+static int ctl_receive_bin(cmd_args_t *args, FILE *bin_out)
 {
 	bool failed = false;
 	bool empty = true;
@@ -410,6 +428,12 @@ static int ctl_receive(cmd_args_t *args)
 		case KNOT_CTL_TYPE_EXTRA:
 			format_data(args, type, &data, &empty);
 			break;
+		case KNOT_CTL_TYPE_BIN:
+			ret = write_bin(args, bin_out);
+			if (ret != KNOT_EOK) {
+				return ret;
+			}
+			break;
 		default:
 			assert(0);
 			return KNOT_EINVAL;
@@ -423,6 +447,11 @@ static int ctl_receive(cmd_args_t *args)
 	return KNOT_EOK;
 }
 
+static int ctl_receive(cmd_args_t *args)
+{
+	return ctl_receive_bin(args, NULL);
+}
+
 static int cmd_ctl(cmd_args_t *args)
 {
 	int ret = check_args(args, 0, (args->desc->cmd == CTL_STATUS ? 1 : 0));
@@ -651,6 +680,16 @@ const filter_desc_t zone_purge_filters[] = {
 	{ NULL },
 };
 
+const filter_desc_t zone_export_filters[] = {
+	{ "+export", NULL, true },
+	{ NULL },
+};
+
+const filter_desc_t zone_import_filters[] = {
+	{ "+import", NULL, true },
+	{ NULL },
+};
+
 const filter_desc_t null_filter = { NULL };
 
 #define MAX_FILTERS sizeof(zone_backup_filters) / sizeof(filter_desc_t) - 1
@@ -845,8 +884,128 @@ static int set_node_items(cmd_args_t *args, knot_ctl_data_t *data, char *rdata,
 	return KNOT_EOK;
 }
 
+/*! \brief Remove the binary import/export filter and its file name from the arguments. */
+static int get_bin_file(cmd_args_t *args, const char **file_name)
+{
+	const filter_desc_t *fd;
+	switch (args->desc->cmd) {
+	case CTL_ZONE_READ:
+	case CTL_ZONE_GET:
+		fd = zone_export_filters;
+		break;
+	case CTL_ZONE_SET:
+	case CTL_ZONE_UNSET:
+		fd = zone_import_filters;
+		break;
+	default:
+		return KNOT_EOK;
+	}
+
+	for (int i = 0; i < args->argc; i++) {
+		if (strcmp(args->argv[i], fd[0].name) != 0) {
+			continue;
+		}
+		if (i + 1 >= args->argc) {
+			log_error("missing file name for %s", fd[0].name);
+			return KNOT_EINVAL;
+		}
+		*file_name = args->argv[i + 1];
+
+		memmove(&args->argv[i], &args->argv[i + 2],
+		        (args->argc - i - 2) * sizeof(*args->argv));
+		args->argc -= 2;
+		break;
+	}
+
+	return KNOT_EOK;
+}
+
+/*! \brief Length of the leading complete records in the buffer. */
+static size_t bin_records_len(const uint8_t *wire, size_t len)
+{
+	size_t pos = 0;
+	while (pos < len) {
+		// Owner, type, class, TTL, rdata length, and rdata.
+		int owner_len = knot_dname_wire_check(wire + pos, wire + len, NULL);
+		if (owner_len <= 0) {
+			break;
+		}
+		size_t rr_len = owner_len + 10;
+		if (pos + rr_len > len) {
+			break;
+		}
+		rr_len += knot_wire_read_u16(wire + pos + rr_len - 2);
+		if (pos + rr_len > len) {
+			break;
+		}
+		pos += rr_len;
+	}
+
+	return pos;
+}
+
+static int send_bin_file(cmd_args_t *args, const char *file_name)
+{
+	FILE *file = fopen(file_name, "r");
+	if (file == NULL) {
+		int ret = knot_map_errno();
+		log_error("failed to open file '%s' (%s)", file_name, knot_strerror(ret));
+		return ret;
+	}
+
+	uint8_t *buff = malloc(KNOT_CTL_BIN_MAX);
+	if (buff == NULL) {
+		fclose(file);
+		return KNOT_ENOMEM;
+	}
+
+	// Send as many complete records as fit in each binary unit. Any record
+	// fits into an empty unit, so no progress means malformed input.
+	int ret = KNOT_EOK;
+	size_t len = 0;
+	while (ret == KNOT_EOK) {
+		len += fread(buff + len, 1, KNOT_CTL_BIN_MAX - len, file);
+		if (ferror(file)) {
+			ret = KNOT_EFILE;
+			break;
+		}
+
+		size_t unit_len = bin_records_len(buff, len);
+		if (unit_len == 0) {
+			if (len > 0) {
+				ret = KNOT_EMALF;
+			}
+			break;
+		}
+
+		ret = knot_ctl_send_bin(args->ctl, buff, unit_len);
+		memmove(buff, buff + unit_len, len - unit_len);
+		len -= unit_len;
+	}
+
+	free(buff);
+	fclose(file);
+
+	if (ret != KNOT_EOK) {
+		log_error("failed to import file '%s' (%s)", file_name, knot_strerror(ret));
+	}
+
+	return ret;
+}
+
 static int cmd_zone_node_ctl(cmd_args_t *args)
 {
+	const char *bin_file = NULL;
+	int ret = get_bin_file(args, &bin_file);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	bool import = (bin_file != NULL) && (args->desc->cmd == CTL_ZONE_SET ||
+	                                     args->desc->cmd == CTL_ZONE_UNSET);
+	if (bin_file != NULL) {
+		strlcat(args->flags, CTL_FLAG_BINARY, sizeof(args->flags));
+	}
+
 	knot_ctl_data_t data = {
 		[KNOT_CTL_IDX_CMD] = ctl_cmd_to_str(args->desc->cmd),
 		[KNOT_CTL_IDX_FLAGS] = *args->flags ? args->flags : NULL,
@@ -854,15 +1013,49 @@ static int cmd_zone_node_ctl(cmd_args_t *args)
 
 	char rdata[65536]; // Maximum item size in libknot control interface.
 
-	int ret = set_node_items(args, &data, rdata, sizeof(rdata));
-	if (ret != KNOT_EOK) {
-		return ret;
+	if (import) {
+		// The records are imported into one zone.
+		ret = check_args(args, 1, 1);
+		if (ret != KNOT_EOK) {
+			return ret;
+		} else if (strcmp(args->argv[0], "--") == 0) {
+			log_error("zone must be specified");
+			return KNOT_EINVAL;
+		}
+		data[KNOT_CTL_IDX_ZONE] = args->argv[0];
+	} else {
+		ret = set_node_items(args, &data, rdata, sizeof(rdata));
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
 	}
 
 	CTL_SEND_DATA
+	if (import) {
+		ret = send_bin_file(args, bin_file);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
 	CTL_SEND_BLOCK
 
-	return ctl_receive(args);
+	if (bin_file == NULL || import) {
+		return ctl_receive(args);
+	}
+
+	FILE *file = fopen(bin_file, "w");
+	if (file == NULL) {
+		ret = knot_map_errno();
+		log_error("failed to open file '%s' (%s)", bin_file, knot_strerror(ret));
+		return ret;
+	}
+	ret = ctl_receive_bin(args, file);
+	if (fclose(file) != 0 && ret == KNOT_EOK) {
+		ret = knot_map_errno();
+		log_error("failed to write file '%s' (%s)", bin_file, knot_strerror(ret));
+	}
+
+	return ret;
 }
 
 static int cmd_conf_init(cmd_args_t *args)
@@ -1217,14 +1410,14 @@ const cmd_desc_t cmd_table[] = {
 	{ CMD_ZONE_XFR_FREEZE, cmd_zone_ctl,          CTL_ZONE_XFR_FREEZE, CMD_FOPT_ZONE },
 	{ CMD_ZONE_XFR_THAW,   cmd_zone_ctl,          CTL_ZONE_XFR_THAW,   CMD_FOPT_ZONE },
 
-	{ CMD_ZONE_READ,       cmd_zone_node_ctl,   CTL_ZONE_READ,       CMD_FREQ_ZONE },
+	{ CMD_ZONE_READ,       cmd_zone_node_ctl,   CTL_ZONE_READ,       CMD_FREQ_ZONE | CMD_FOPT_FILTER },
 	{ CMD_ZONE_BEGIN,      cmd_zone_ctl,        CTL_ZONE_BEGIN,      CMD_FREQ_ZONE | CMD_FOPT_ZONE | CMD_FOPT_FILTER },
 	{ CMD_ZONE_COMMIT,     cmd_zone_ctl,        CTL_ZONE_COMMIT,     CMD_FREQ_ZONE | CMD_FOPT_ZONE },
 	{ CMD_ZONE_ABORT,      cmd_zone_ctl,        CTL_ZONE_ABORT,      CMD_FREQ_ZONE | CMD_FOPT_ZONE },
 	{ CMD_ZONE_DIFF,       cmd_zone_node_ctl,   CTL_ZONE_DIFF,       CMD_FREQ_ZONE },
-	{ CMD_ZONE_GET,        cmd_zone_node_ctl,   CTL_ZONE_GET,        CMD_FREQ_ZONE },
-	{ CMD_ZONE_SET,        cmd_zone_node_ctl,   CTL_ZONE_SET,        CMD_FREQ_ZONE },
-	{ CMD_ZONE_UNSET,      cmd_zone_node_ctl,   CTL_ZONE_UNSET,      CMD_FREQ_ZONE },
+	{ CMD_ZONE_GET,        cmd_zone_node_ctl,   CTL_ZONE_GET,        CMD_FREQ_ZONE | CMD_FOPT_FILTER },
+	{ CMD_ZONE_SET,        cmd_zone_node_ctl,   CTL_ZONE_SET,        CMD_FREQ_ZONE | CMD_FOPT_FILTER },
+	{ CMD_ZONE_UNSET,      cmd_zone_node_ctl,   CTL_ZONE_UNSET,      CMD_FREQ_ZONE | CMD_FOPT_FILTER },
 	{ CMD_ZONE_PURGE,      cmd_zone_ctl,        CTL_ZONE_PURGE,      CMD_FREQ_ZONE | CMD_FOPT_ZONE | CMD_FOPT_FILTER },
 	{ CMD_ZONE_STATS,      cmd_stats_ctl,       CTL_ZONE_STATS,      CMD_FREQ_ZONE },
 
@@ -1271,14 +1464,14 @@ static const cmd_help_t cmd_help_table[] = {
 	{ CMD_ZONE_XFR_FREEZE, "[<zone>...]",                                "Temporarily disable outgoing AXFR/IXFR. (#)" },
 	{ CMD_ZONE_XFR_THAW,   "[<zone>...]",                                "Dismiss outgoing XFR freeze. (#)" },
 	{ "",                  "",                                           "" },
-	{ CMD_ZONE_READ,       "<zone> [<owner> [<type>]]",                  "Get zone data that are currently being presented." },
+	{ CMD_ZONE_READ,       "<zone> [<owner> [<type>]] [+export <file>]", "Get zone data that are currently being presented." },
 	{ CMD_ZONE_BEGIN,      "<zone>... [+benevolent]",                    "Begin a zone transaction." },
 	{ CMD_ZONE_COMMIT,     "<zone>...",                                  "Commit the zone transaction." },
 	{ CMD_ZONE_ABORT,      "<zone>...",                                  "Abort the zone transaction." },
 	{ CMD_ZONE_DIFF,       "<zone>",                                     "Get zone changes within the transaction." },
-	{ CMD_ZONE_GET,        "<zone> [<owner> [<type>]]",                  "Get zone data within the transaction." },
-	{ CMD_ZONE_SET,        "<zone>  <owner> [<ttl>] <type> <rdata>",     "Add zone record within the transaction." },
-	{ CMD_ZONE_UNSET,      "<zone>  <owner> [<type> [<rdata>]]",         "Remove zone data within the transaction." },
+	{ CMD_ZONE_GET,        "<zone> [<owner> [<type>]] [+export <file>]", "Get zone data within the transaction." },
+	{ CMD_ZONE_SET,        "<zone>  <owner> [<ttl>] <type> <rdata> | +import <file>", "Add zone records within the transaction." },
+	{ CMD_ZONE_UNSET,      "<zone>  <owner> [<type> [<rdata>]] | +import <file>", "Remove zone data within the transaction." },
 	{ CMD_ZONE_PURGE,      "<zone>... [<filter>...]",                    "Purge zone data, zone file, journal, timers, and KASP data. (#)" },
 	{ CMD_ZONE_STATS,      "<zone> [<module>[.<counter>]]",              "Show zone statistics counter(s)."},
 	{ "",                  "",                                           "" },
@@ -124,6 +124,8 @@ extern const filter_desc_t zone_flush_filters[];
 extern const filter_desc_t zone_backup_filters[];
 extern const filter_desc_t zone_status_filters[];
 extern const filter_desc_t zone_purge_filters[];
+extern const filter_desc_t zone_export_filters[];
+extern const filter_desc_t zone_import_filters[];
 
 /*! \brief Table of commands. */
 extern const cmd_desc_t cmd_table[];
@@ -285,6 +285,10 @@ static void filter_lookup(EditLine *el, const char *str, const cmd_desc_t *cmd,
 	    lookup_insert(&lookup, CMD_ZONE_PURGE, (void *)zone_purge_filters) != KNOT_EOK ||
 	    lookup_insert(&lookup, CMD_ZONE_BEGIN, (void *)zone_begin_filters) != KNOT_EOK ||
 	    lookup_insert(&lookup, CMD_ZONE_FLUSH, (void *)zone_flush_filters) != KNOT_EOK ||
+	    lookup_insert(&lookup, CMD_ZONE_READ, (void *)zone_export_filters) != KNOT_EOK ||
+	    lookup_insert(&lookup, CMD_ZONE_GET, (void *)zone_export_filters) != KNOT_EOK ||
+	    lookup_insert(&lookup, CMD_ZONE_SET, (void *)zone_import_filters) != KNOT_EOK ||
+	    lookup_insert(&lookup, CMD_ZONE_UNSET, (void *)zone_import_filters) != KNOT_EOK ||
 	    lookup_insert(&lookup, CMD_CONF_IMPORT, (void *)conf_import_filters) != KNOT_EOK ||
 	    lookup_insert(&lookup, CMD_CONF_EXPORT, (void *)conf_export_filters) != KNOT_EOK) {
 		goto cmds_lookup_finish;
@@ -462,6 +466,20 @@ static unsigned char complete(EditLine *el, int ch)
 				goto complete_exit;
 			}
 			break;
+		case CTL_ZONE_READ:
+		case CTL_ZONE_GET:
+			if (!strcmp(zone_export_filters[0].name, argv[token - 1])) {
+				path_lookup(el, argv[token], false);
+				goto complete_exit;
+			}
+			break;
+		case CTL_ZONE_SET:
+		case CTL_ZONE_UNSET:
+			if (!strcmp(zone_import_filters[0].name, argv[token - 1])) {
+				path_lookup(el, argv[token], false);
+				goto complete_exit;
+			}
+			break;
 		default:
 			break;
 		}
@@ -521,6 +539,7 @@ static unsigned char complete(EditLine *el, int ch)
 		}
 		if (lookup_insert(&lookup, CMD_STATUS_VERSION, NULL) == KNOT_EOK &&
 		    lookup_insert(&lookup, CMD_STATUS_WORKERS, NULL) == KNOT_EOK &&
+		    lookup_insert(&lookup, CMD_STATUS_QUEUE, NULL) == KNOT_EOK &&
 		    lookup_insert(&lookup, CMD_STATUS_CONFIG, NULL) == KNOT_EOK &&
 		    lookup_insert(&lookup, CMD_STATUS_CERT, NULL) == KNOT_EOK) {
 			(void)lookup_complete(&lookup, argv[1], pos, el, true);
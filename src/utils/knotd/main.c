@@ -36,6 +36,7 @@
 #include "knot/server/server.h"
 #include "knot/server/signals.h"
 #include "knot/server/tcp-handler.h"
+#include "knot/updates/acl.h"
 #include "utils/common/params.h"
 
 #define PROGRAM_NAME "knotd"
@@ -358,6 +359,12 @@ static int set_config(const char *confdb, const char *config, size_t max_conf_si
 		log_error("failed to migrate configuration (%s)", knot_strerror(ret));
 	}
 
+	/* Cache the compiled zone ACLs, fall back to the direct evaluation if failed. */
+	new_conf->acl_cache = acl_cache_new(new_conf);
+	if (new_conf->acl_cache == NULL) {
+		log_warning("failed to prepare ACL cache");
+	}
+
 	/* Update to the new config. */
 	conf_update(new_conf, CONF_UPD_FNONE);
 
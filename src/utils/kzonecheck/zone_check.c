@@ -11,6 +11,7 @@
 #include "knot/common/log.h"
 #include "knot/zone/contents.h"
 #include "knot/zone/digest.h"
+#include "knot/zone/snapshot.h"
 #include "knot/zone/zonefile.h"
 #include "knot/zone/zone-dump.h"
 #include "utils/common/msg.h"
@@ -53,14 +54,11 @@ static void print_statistics(err_handler_stats_t *stats)
 	}
 }
 
-int zone_check(const char *zone_file, const knot_dname_t *zone_name, bool zonemd,
-               uint32_t dflt_ttl, semcheck_optional_t optional, time_t time,
-               bool print, uint16_t threads)
+static int load_zonefile(const char *zone_file, const knot_dname_t *zone_name,
+                         uint32_t dflt_ttl, semcheck_optional_t optional, time_t time,
+                         uint16_t threads, sem_handler_t *handler,
+                         zone_contents_t **contents)
 {
-	err_handler_stats_t stats = {
-		.handler = { .cb = err_callback },
-	};
-
 	zloader_t zl;
 	int ret = zonefile_open(&zl, zone_file, zone_name, dflt_ttl, optional, time);
 	switch (ret) {
@@ -77,7 +75,7 @@ int zone_check(const char *zone_file, const knot_dname_t *zone_name, bool zonemd
 		ERR2("failed to run semantic checks (%s)", knot_strerror(ret));
 		return ret;
 	}
-	zl.err_handler = (sem_handler_t *)&stats;
+	zl.err_handler = handler;
 
 	if (zone_name == NULL) {
 		knot_dname_txt_storage_t origin;
@@ -86,12 +84,48 @@ int zone_check(const char *zone_file, const knot_dname_t *zone_name, bool zonemd
 		}
 	}
 
-	zone_contents_t *contents = zonefile_load(&zl, threads);
+	*contents = zonefile_load(&zl, threads);
 	zonefile_close(&zl);
+
+	return KNOT_EOK;
+}
+
+int zone_check(const char *zone_file, const knot_dname_t *zone_name, bool zonemd,
+               uint32_t dflt_ttl, semcheck_optional_t optional, time_t time,
+               bool print, uint16_t threads)
+{
+	err_handler_stats_t stats = {
+		.handler = { .cb = err_callback },
+	};
+
+	zone_contents_t *contents = NULL;
+	int ret = KNOT_EOK;
+	if (zone_snapshot_probe(zone_file)) {
+		ret = zone_snapshot_load(zone_file, zone_name, NULL, NULL, &contents);
+		if (ret != KNOT_EOK) {
+			ERR2("invalid zone file snapshot (%s)", knot_strerror(ret));
+			return ret;
+		}
+
+		ret = zonefile_check(contents, optional, &stats.handler, time, threads,
+		                     zone_file);
+		if (ret != KNOT_EOK) {
+			zone_contents_deep_free(contents);
+			contents = NULL;
+		}
+	} else {
+		ret = load_zonefile(zone_file, zone_name, dflt_ttl, optional, time,
+		                    threads, &stats.handler, &contents);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
 	if (contents == NULL && !stats.handler.error) {
 		ERR2("failed to run semantic checks");
 		return KNOT_ERROR;
 	}
+	ret = KNOT_EOK;
 
 	if (stats.error_count > 0) {
 		print_statistics(&stats);
@@ -146,7 +146,7 @@ static int zonesign(sign_params_t *params)
 
 	if (params->outdir == NULL) {
 		zonefile = conf_zonefile(conf(), params->zone_name);
-		ret = zonefile_write_skip(zonefile, up.new_cont, conf());
+		ret = zonefile_write_skip(zonefile, up.new_cont, conf(), NULL);
 	} else {
 		zone_contents_t *temp = zone_struct->contents;
 		zone_struct->contents = up.new_cont;
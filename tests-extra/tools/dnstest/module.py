@@ -276,6 +276,7 @@ class ModStats(KnotModule):
         self._bool(conf, "query-type", True)
         self._bool(conf, "query-size", True)
         self._bool(conf, "reply-size", True)
+        self._bool(conf, "nsec3-cache", True)
         conf.end()
 
         return conf
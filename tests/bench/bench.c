@@ -0,0 +1,183 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench/bench.h"
+#include "contrib/json.h"
+#include "contrib/time.h"
+
+#define DEFAULT_ROUND_MS	100
+#define DEFAULT_ROUNDS		5
+#define MAX_ROUNDS		64
+#define MAX_RESULTS		64
+#define MAX_METRICS		4
+
+typedef struct {
+	const char *name;
+	double value;
+} bench_metric_t;
+
+typedef struct {
+	const char *name;
+	size_t iterations;
+	double ns_median;
+	double ns_min;
+	double ns_max;
+	bench_metric_t metrics[MAX_METRICS];
+	unsigned metric_count;
+} bench_result_t;
+
+static struct {
+	const char *suite;
+	double round_ms;
+	unsigned rounds;
+	unsigned count;
+	bench_result_t results[MAX_RESULTS];
+} bench = {
+	.round_ms = DEFAULT_ROUND_MS,
+	.rounds = DEFAULT_ROUNDS,
+};
+
+static volatile uintptr_t bench_sink_value;
+
+void bench_sink(uintptr_t value)
+{
+	bench_sink_value += value;
+}
+
+void bench_init(const char *suite, int argc, char *argv[])
+{
+	bench.suite = suite;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "t:r:h")) != -1) {
+		switch (opt) {
+		case 't':
+			bench.round_ms = atof(optarg);
+			break;
+		case 'r':
+			bench.rounds = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-t <round-ms>] [-r <rounds>]\n", argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (bench.round_ms <= 0) {
+		bench.round_ms = DEFAULT_ROUND_MS;
+	}
+	if (bench.rounds == 0 || bench.rounds > MAX_ROUNDS) {
+		bench.rounds = DEFAULT_ROUNDS;
+	}
+}
+
+static double measure_ms(bench_fn_t fn, void *ctx, size_t iterations)
+{
+	struct timespec begin = time_now();
+	fn(ctx, iterations);
+	struct timespec end = time_now();
+
+	return time_diff_ms(&begin, &end);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+void bench_run(const char *name, bench_fn_t fn, void *ctx)
+{
+	if (bench.count == MAX_RESULTS) {
+		fprintf(stderr, "too many benchmarks, skipping '%s'\n", name);
+		return;
+	}
+
+	/* Grow the iteration count until a run is long enough to extrapolate. */
+	size_t iterations = 1;
+	double elapsed = measure_ms(fn, ctx, iterations);
+	while (elapsed < bench.round_ms / 10) {
+		iterations *= (elapsed > 0) ? 2 : 10;
+		elapsed = measure_ms(fn, ctx, iterations);
+	}
+	iterations = iterations * (bench.round_ms / elapsed);
+	if (iterations == 0) {
+		iterations = 1;
+	}
+
+	double ns[MAX_ROUNDS];
+	for (unsigned i = 0; i < bench.rounds; i++) {
+		ns[i] = measure_ms(fn, ctx, iterations) * 1e6 / iterations;
+	}
+	qsort(ns, bench.rounds, sizeof(*ns), cmp_double);
+
+	bench_result_t *res = &bench.results[bench.count++];
+	res->name = name;
+	res->iterations = iterations;
+	res->ns_median = ns[bench.rounds / 2];
+	res->ns_min = ns[0];
+	res->ns_max = ns[bench.rounds - 1];
+	res->metric_count = 0;
+
+	fprintf(stderr, "%s/%s: %.1f ns/op\n", bench.suite, name, res->ns_median);
+}
+
+void bench_metric(const char *name, double value)
+{
+	if (bench.count == 0) {
+		return;
+	}
+
+	bench_result_t *res = &bench.results[bench.count - 1];
+	if (res->metric_count == MAX_METRICS) {
+		fprintf(stderr, "too many metrics, skipping '%s'\n", name);
+		return;
+	}
+
+	res->metrics[res->metric_count].name = name;
+	res->metrics[res->metric_count].value = value;
+	res->metric_count++;
+
+	fprintf(stderr, "%s/%s: %s %.2f\n", bench.suite, res->name, name, value);
+}
+
+int bench_finish(void)
+{
+	jsonw_t *w = jsonw_new(stdout, "  ");
+	if (w == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	jsonw_object(w, NULL);
+	jsonw_str(w, "suite", bench.suite);
+	jsonw_str(w, "version", PACKAGE_VERSION);
+	jsonw_ulong(w, "rounds", bench.rounds);
+	jsonw_list(w, "results");
+	for (unsigned i = 0; i < bench.count; i++) {
+		const bench_result_t *res = &bench.results[i];
+		jsonw_object(w, NULL);
+		jsonw_str(w, "name", res->name);
+		jsonw_ulong(w, "iterations", res->iterations);
+		jsonw_double(w, "ns_per_op", res->ns_median);
+		jsonw_double(w, "ns_per_op_min", res->ns_min);
+		jsonw_double(w, "ns_per_op_max", res->ns_max);
+		jsonw_double(w, "ops_per_sec", 1e9 / res->ns_median);
+		for (unsigned j = 0; j < res->metric_count; j++) {
+			jsonw_double(w, res->metrics[j].name, res->metrics[j].value);
+		}
+		jsonw_end(w);
+	}
+	jsonw_end(w);
+	jsonw_end(w);
+	jsonw_free(&w);
+
+	bench.count = 0;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+/*!
+ * \brief Minimal microbenchmark harness.
+ *
+ * Each benchmark program registers its cases with bench_run() and prints
+ * one JSON object with the results for the whole suite to stdout:
+ *
+ * { "suite": ..., "version": ..., "rounds": ..., "results": [
+ *   { "name": ..., "iterations": ..., "ns_per_op": ..., "ns_per_op_min": ...,
+ *     "ns_per_op_max": ..., "ops_per_sec": ..., <metric>: ... }, ... ] }
+ *
+ * The reported ns_per_op is the median over all rounds.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * \brief Benchmarked operation.
+ *
+ * \param ctx         Benchmark context passed to bench_run().
+ * \param iterations  Number of operations to perform.
+ */
+typedef void (*bench_fn_t)(void *ctx, size_t iterations);
+
+/*!
+ * \brief Initializes the suite, parses common command line options.
+ *
+ * Options: -t <ms> target duration of one round, -r <count> number of rounds.
+ */
+void bench_init(const char *suite, int argc, char *argv[]);
+
+/*!
+ * \brief Calibrates the iteration count, measures the operation, stores the result.
+ */
+void bench_run(const char *name, bench_fn_t fn, void *ctx);
+
+/*!
+ * \brief Attaches an additional named value to the last stored result.
+ */
+void bench_metric(const char *name, double value);
+
+/*!
+ * \brief Prints the suite results as JSON.
+ *
+ * \return Process exit code.
+ */
+int bench_finish(void);
+
+/*!
+ * \brief Makes a value observable so that the compiler can't drop its computation.
+ */
+void bench_sink(uintptr_t value);
@@ -0,0 +1,150 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "knot/test_conf.h"
+#include "knot/updates/acl.h"
+#include "contrib/sockaddr.h"
+#include "libknot/libknot.h"
+
+#define ZONE		"example.com."
+#define KEY		"key."
+#define ADDR_COUNT	256
+
+static const size_t acl_lengths[] = { 1, 10, 100, 1000 };
+
+typedef struct {
+	struct sockaddr_storage addrs[ADDR_COUNT];
+	knot_dname_t *zone;
+	knot_dname_t *key_name;
+	size_t next;
+} acl_ctx_t;
+
+/*!
+ * ACLs 'aclN' with a /24 prefix each, alternating deny and TSIG-secured
+ * transfer rules. The queried addresses hit the last ACL.
+ */
+static char *gen_conf(size_t count)
+{
+	size_t max = 256 + count * 160;
+	char *txt = malloc(max);
+	if (txt == NULL) {
+		return NULL;
+	}
+
+	int len = snprintf(txt, max, "key:\n  - id: " KEY "\n"
+	                   "    algorithm: hmac-sha256\n    secret: Zm9v\n"
+	                   "acl:\n");
+	for (size_t i = 0; i < count; i++) {
+		len += snprintf(txt + len, max - len,
+		                "  - id: acl%zu\n    address: 10.%zu.%zu.0/24\n%s",
+		                i, i / 256, i % 256,
+		                (i % 2 == 0 && i + 1 < count) ?
+		                "    deny: on\n" :
+		                "    key: " KEY "\n    action: transfer\n");
+	}
+	len += snprintf(txt + len, max - len, "zone:\n  - domain: " ZONE "\n    acl: [ ");
+	for (size_t i = 0; i < count; i++) {
+		len += snprintf(txt + len, max - len, "%sacl%zu", (i > 0) ? ", " : "", i);
+	}
+	snprintf(txt + len, max - len, " ]\n");
+
+	return txt;
+}
+
+static void bench_acl_allowed(void *data, size_t iterations)
+{
+	acl_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		knot_tsig_key_t tsig = { DNSSEC_TSIG_HMAC_SHA256, ctx->key_name };
+		conf_val_t acl = conf_zone_get(conf(), C_ACL, ctx->zone);
+		bool ret = acl_allowed(conf(), &acl, ACL_ACTION_TRANSFER,
+		                       &ctx->addrs[ctx->next++ % ADDR_COUNT], &tsig,
+		                       ctx->zone, NULL, NULL, KNOTD_QUERY_PROTO_TCP);
+		bench_sink(ret);
+	}
+}
+
+static void bench_acl_set_allowed(void *data, size_t iterations)
+{
+	acl_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		knot_tsig_key_t tsig = { DNSSEC_TSIG_HMAC_SHA256, ctx->key_name };
+		conf_val_t acl = conf_zone_get(conf(), C_ACL, ctx->zone);
+		const acl_set_t *set = acl_cache_acl(conf()->acl_cache, &acl);
+		bool ret = acl_set_allowed(set, ACL_ACTION_TRANSFER,
+		                           &ctx->addrs[ctx->next++ % ADDR_COUNT], &tsig,
+		                           ctx->zone, NULL, NULL, KNOTD_QUERY_PROTO_TCP,
+		                           false);
+		bench_sink(ret);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("acl", argc, argv);
+
+	acl_ctx_t ctx = {
+		.zone = knot_dname_from_str_alloc(ZONE),
+		.key_name = knot_dname_from_str_alloc(KEY),
+	};
+
+	for (size_t i = 0; i < sizeof(acl_lengths) / sizeof(*acl_lengths); i++) {
+		size_t count = acl_lengths[i];
+		char *txt = gen_conf(count);
+		if (txt == NULL || test_conf(txt, NULL) != KNOT_EOK) {
+			fprintf(stderr, "failed to prepare configuration\n");
+			return EXIT_FAILURE;
+		}
+		free(txt);
+
+		conf()->acl_cache = acl_cache_new(conf());
+		if (conf()->acl_cache == NULL) {
+			fprintf(stderr, "failed to compile ACLs\n");
+			return EXIT_FAILURE;
+		}
+
+		size_t last = count - 1;
+		for (size_t j = 0; j < ADDR_COUNT; j++) {
+			char addr[32];
+			snprintf(addr, sizeof(addr), "10.%zu.%zu.%zu",
+			         last / 256, last % 256, j);
+			sockaddr_set(&ctx.addrs[j], AF_INET, addr, 0);
+		}
+
+		/* Verify both evaluations agree before measuring. */
+		for (size_t j = 0; j < ADDR_COUNT; j++) {
+			knot_tsig_key_t tsig1 = { DNSSEC_TSIG_HMAC_SHA256, ctx.key_name };
+			knot_tsig_key_t tsig2 = tsig1;
+			conf_val_t acl = conf_zone_get(conf(), C_ACL, ctx.zone);
+			const acl_set_t *set = acl_cache_acl(conf()->acl_cache, &acl);
+			if (!acl_allowed(conf(), &acl, ACL_ACTION_TRANSFER, &ctx.addrs[j],
+			                 &tsig1, ctx.zone, NULL, NULL, KNOTD_QUERY_PROTO_TCP) ||
+			    !acl_set_allowed(set, ACL_ACTION_TRANSFER, &ctx.addrs[j],
+			                     &tsig2, ctx.zone, NULL, NULL,
+			                     KNOTD_QUERY_PROTO_TCP, false)) {
+				fprintf(stderr, "evaluation mismatch\n");
+				return EXIT_FAILURE;
+			}
+		}
+
+		char name[64];
+		snprintf(name, sizeof(name), "acl_allowed-%zu-acls", count);
+		bench_run(name, bench_acl_allowed, &ctx);
+		snprintf(name, sizeof(name), "acl_set_allowed-%zu-acls", count);
+		bench_run(name, bench_acl_set_allowed, &ctx);
+
+		test_conf_free();
+	}
+
+	knot_dname_free(ctx.zone, NULL);
+	knot_dname_free(ctx.key_name, NULL);
+
+	return bench_finish();
+}
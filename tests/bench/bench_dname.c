@@ -0,0 +1,153 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "libknot/dname.h"
+
+#define NAME_COUNT	1024
+
+typedef struct {
+	knot_dname_storage_t names[NAME_COUNT];
+	knot_dname_storage_t upper[NAME_COUNT];
+	knot_dname_txt_storage_t txt[NAME_COUNT];
+	knot_dname_storage_t zone;
+	size_t next;
+} dname_ctx_t;
+
+#define NEXT(ctx) ((ctx)->next++ % NAME_COUNT)
+
+static void bench_lf(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	knot_dname_storage_t lf;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_sink((uintptr_t)knot_dname_lf(ctx->names[NEXT(ctx)], lf));
+	}
+}
+
+static void bench_cmp(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = NEXT(ctx);
+		bench_sink(knot_dname_cmp(ctx->names[k], ctx->names[(k + 1) % NAME_COUNT]));
+	}
+}
+
+static void bench_is_equal(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = NEXT(ctx);
+		bench_sink(knot_dname_is_equal(ctx->names[k], ctx->names[k]));
+	}
+}
+
+static void bench_is_case_equal(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = NEXT(ctx);
+		bench_sink(knot_dname_is_case_equal(ctx->names[k], ctx->upper[k]));
+	}
+}
+
+static void bench_size(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_sink(knot_dname_size(ctx->names[NEXT(ctx)]));
+	}
+}
+
+static void bench_labels(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_sink(knot_dname_labels(ctx->names[NEXT(ctx)], NULL));
+	}
+}
+
+static void bench_in_bailiwick(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_sink(knot_dname_in_bailiwick(ctx->names[NEXT(ctx)], ctx->zone));
+	}
+}
+
+static void bench_copy_lower(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	knot_dname_storage_t lower;
+	for (size_t i = 0; i < iterations; i++) {
+		knot_dname_copy_lower(lower, ctx->upper[NEXT(ctx)]);
+		bench_sink(lower[1]);
+	}
+}
+
+static void bench_from_str(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	knot_dname_storage_t name;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_sink((uintptr_t)knot_dname_from_str(name, ctx->txt[NEXT(ctx)],
+		                                          sizeof(name)));
+	}
+}
+
+static void bench_to_str(void *data, size_t iterations)
+{
+	dname_ctx_t *ctx = data;
+	knot_dname_txt_storage_t txt;
+	for (size_t i = 0; i < iterations; i++) {
+		bench_sink((uintptr_t)knot_dname_to_str(txt, ctx->names[NEXT(ctx)],
+		                                        sizeof(txt)));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("dname", argc, argv);
+
+	dname_ctx_t *ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	/* Names with 3-8 labels below a common zone. */
+	knot_dname_from_str(ctx->zone, "example.com.", sizeof(ctx->zone));
+	for (unsigned i = 0; i < NAME_COUNT; i++) {
+		char *txt = ctx->txt[i];
+		txt[0] = '\0';
+		for (unsigned l = 0; l < 1 + i % 6; l++) {
+			char label[16];
+			snprintf(label, sizeof(label), "lbl%u-%u.", i, l);
+			strcat(txt, label);
+		}
+		strcat(txt, "Example.COM.");
+		knot_dname_from_str(ctx->upper[i], txt, sizeof(ctx->upper[i]));
+		knot_dname_copy_lower(ctx->names[i], ctx->upper[i]);
+	}
+
+	bench_run("knot_dname_lf", bench_lf, ctx);
+	bench_run("knot_dname_cmp", bench_cmp, ctx);
+	bench_run("knot_dname_is_equal", bench_is_equal, ctx);
+	bench_run("knot_dname_is_case_equal", bench_is_case_equal, ctx);
+	bench_run("knot_dname_size", bench_size, ctx);
+	bench_run("knot_dname_labels", bench_labels, ctx);
+	bench_run("knot_dname_in_bailiwick", bench_in_bailiwick, ctx);
+	bench_run("knot_dname_copy_lower", bench_copy_lower, ctx);
+	bench_run("knot_dname_from_str", bench_from_str, ctx);
+	bench_run("knot_dname_to_str", bench_to_str, ctx);
+
+	free(ctx);
+
+	return bench_finish();
+}
@@ -0,0 +1,201 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "bench/bench.h"
+#include "knot/common/evsched.h"
+#include "contrib/macros.h"
+#include "contrib/ucw/heap.h"
+
+#define EVENTS		1000000
+#define MAX_DELAY_MS	(86400 * 1000)
+
+typedef struct {
+	evsched_t sched;
+	event_t *events[EVENTS];
+	uint32_t delays[EVENTS];
+	size_t next;
+
+	pthread_mutex_t mx;
+	pthread_cond_t cond;
+	size_t fired;
+} sched_ctx_t;
+
+/*! \brief Heap entry of the former binary heap scheduler, as a baseline. */
+typedef struct {
+	struct heap_val hpos;
+	uint64_t when;
+} heap_event_t;
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t notify;
+	struct heap heap;
+	heap_event_t *events;
+	uint32_t *delays;
+	size_t next;
+} heap_ctx_t;
+
+static void fire_cb(event_t *ev)
+{
+	sched_ctx_t *ctx = ev->data;
+	pthread_mutex_lock(&ctx->mx);
+	if (++ctx->fired % 1024 == 0) {
+		pthread_cond_signal(&ctx->cond);
+	}
+	pthread_mutex_unlock(&ctx->mx);
+}
+
+static void bench_schedule(void *data, size_t iterations)
+{
+	sched_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t idx = ctx->next++ % EVENTS;
+		evsched_schedule(ctx->events[idx], ctx->delays[(idx * 7) % EVENTS]);
+	}
+}
+
+static void bench_cancel(void *data, size_t iterations)
+{
+	sched_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t idx = ctx->next++ % EVENTS;
+		evsched_cancel(ctx->events[idx]);
+		evsched_schedule(ctx->events[idx], ctx->delays[idx]);
+	}
+}
+
+static void bench_dispatch(void *data, size_t iterations)
+{
+	sched_ctx_t *ctx = data;
+
+	pthread_mutex_lock(&ctx->mx);
+	ctx->fired = 0;
+	pthread_mutex_unlock(&ctx->mx);
+
+	// Schedule bursts expiring within a few ticks, wait for each of them.
+	size_t done = 0;
+	while (done < iterations) {
+		size_t count = MIN(iterations - done, EVENTS);
+		for (size_t i = 0; i < count; i++) {
+			evsched_schedule(ctx->events[ctx->next++ % EVENTS], i % 4);
+		}
+		done += count;
+
+		pthread_mutex_lock(&ctx->mx);
+		while (ctx->fired < done) {
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += 1000000;
+			if (ts.tv_nsec >= 1000000000L) {
+				ts.tv_sec += 1;
+				ts.tv_nsec -= 1000000000L;
+			}
+			pthread_cond_timedwait(&ctx->cond, &ctx->mx, &ts);
+		}
+		pthread_mutex_unlock(&ctx->mx);
+	}
+}
+
+static int heap_cmp(void *e1, void *e2)
+{
+	uint64_t w1 = ((heap_event_t *)e1)->when, w2 = ((heap_event_t *)e2)->when;
+	return (w1 > w2) - (w1 < w2);
+}
+
+static void bench_heap_schedule(void *data, size_t iterations)
+{
+	heap_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t idx = ctx->next++ % EVENTS;
+		heap_event_t *ev = &ctx->events[idx];
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		pthread_mutex_lock(&ctx->lock);
+		ev->when = tv.tv_sec * 1000 + tv.tv_usec / 1000 + ctx->delays[(idx * 7) % EVENTS];
+		heap_replace(&ctx->heap, heap_find(&ctx->heap, (heap_val_t *)ev),
+		             (heap_val_t *)ev);
+		pthread_cond_signal(&ctx->notify);
+		pthread_mutex_unlock(&ctx->lock);
+	}
+}
+
+static void interrupt_handle(int s)
+{
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("evsched", argc, argv);
+
+	struct sigaction sa = { .sa_handler = interrupt_handle };
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGALRM, &sa, NULL); // Scheduler thread stop.
+
+	sched_ctx_t *ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL || evsched_init(&ctx->sched, NULL) != 0) {
+		return EXIT_FAILURE;
+	}
+	pthread_mutex_init(&ctx->mx, NULL);
+	pthread_cond_init(&ctx->cond, NULL);
+
+	srandom(1);
+	for (size_t i = 0; i < EVENTS; i++) {
+		// Keep at least a second, only the dispatch case may fire events.
+		ctx->delays[i] = 1000 + random() % MAX_DELAY_MS;
+		ctx->events[i] = evsched_event_create(&ctx->sched, fire_cb, ctx);
+		evsched_schedule(ctx->events[i], ctx->delays[i]);
+	}
+
+	/* Every operation is one event (re)scheduled among a million zones. */
+	bench_run("evsched_schedule", bench_schedule, ctx);
+	bench_metric("events", EVENTS);
+	bench_run("evsched_cancel_schedule", bench_cancel, ctx);
+	bench_metric("events", EVENTS);
+
+	/* Former binary heap scheduler with the same load. */
+	heap_ctx_t *heap_ctx = calloc(1, sizeof(*heap_ctx));
+	if (heap_ctx == NULL) {
+		return EXIT_FAILURE;
+	}
+	heap_ctx->events = calloc(EVENTS, sizeof(heap_event_t));
+	heap_ctx->delays = ctx->delays;
+	pthread_mutex_init(&heap_ctx->lock, NULL);
+	pthread_cond_init(&heap_ctx->notify, NULL);
+	heap_init(&heap_ctx->heap, heap_cmp, EVENTS);
+	for (size_t i = 0; i < EVENTS; i++) {
+		heap_ctx->events[i].when = ctx->delays[i];
+		heap_insert(&heap_ctx->heap, (heap_val_t *)&heap_ctx->events[i]);
+	}
+	bench_run("heap_schedule", bench_heap_schedule, heap_ctx);
+	bench_metric("events", EVENTS);
+	heap_deinit(&heap_ctx->heap);
+	pthread_mutex_destroy(&heap_ctx->lock);
+	pthread_cond_destroy(&heap_ctx->notify);
+	free(heap_ctx->events);
+	free(heap_ctx);
+
+	/* Every operation is one event scheduled and dispatched. */
+	evsched_start(&ctx->sched);
+	bench_run("evsched_dispatch", bench_dispatch, ctx);
+	bench_metric("events", EVENTS);
+	evsched_stop(&ctx->sched);
+	evsched_join(&ctx->sched);
+
+	for (size_t i = 0; i < EVENTS; i++) {
+		evsched_cancel(ctx->events[i]);
+		evsched_event_free(ctx->events[i]);
+	}
+	evsched_deinit(&ctx->sched);
+	pthread_mutex_destroy(&ctx->mx);
+	pthread_cond_destroy(&ctx->cond);
+	free(ctx);
+
+	return bench_finish();
+}
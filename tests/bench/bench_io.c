@@ -0,0 +1,291 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bench/bench.h"
+#include "knot/common/uring.h"
+#include "contrib/macros.h"
+#include "libknot/errcode.h"
+
+#define WINDOW		32  /*!< Queries in flight per client round trip. */
+#define MSG_SIZE	64  /*!< Size of the echoed message, close to a DNS query. */
+#define RX_BUFS		256
+#define SERVER_WAIT_MS	100
+
+typedef enum {
+	BACKEND_EPOLL,
+	BACKEND_URING,
+} backend_t;
+
+typedef struct {
+	backend_t backend;
+	int server_fd;
+	int client_fd;
+	pthread_t thread;
+	volatile bool stop;
+	volatile bool failed;
+	/* Updated by the server thread only. */
+	volatile uint64_t syscalls;
+	volatile uint64_t queries;
+} io_ctx_t;
+
+/*! \brief Echo loop with epoll + recvmmsg + sendmmsg, as the polling UDP handler. */
+static void serve_epoll(io_ctx_t *ctx)
+{
+	int ep = epoll_create1(0);
+	struct epoll_event ev = { .events = EPOLLIN };
+	if (ep < 0 || epoll_ctl(ep, EPOLL_CTL_ADD, ctx->server_fd, &ev) != 0) {
+		ctx->failed = true;
+		return;
+	}
+
+	static uint8_t bufs[WINDOW][MSG_SIZE];
+	struct sockaddr_storage addrs[WINDOW];
+	struct iovec iovs[WINDOW];
+	struct mmsghdr msgs[WINDOW];
+
+	while (!ctx->stop) {
+		int ret = epoll_wait(ep, &ev, 1, SERVER_WAIT_MS);
+		ctx->syscalls++;
+		if (ret <= 0) {
+			continue;
+		}
+
+		for (unsigned i = 0; i < WINDOW; i++) {
+			iovs[i].iov_base = bufs[i];
+			iovs[i].iov_len = MSG_SIZE;
+			msgs[i].msg_hdr = (struct msghdr) {
+				.msg_name = &addrs[i],
+				.msg_namelen = sizeof(addrs[i]),
+				.msg_iov = &iovs[i],
+				.msg_iovlen = 1,
+			};
+		}
+		int count = recvmmsg(ctx->server_fd, msgs, WINDOW, MSG_DONTWAIT, NULL);
+		ctx->syscalls++;
+		if (count <= 0) {
+			continue;
+		}
+		for (int i = 0; i < count; i++) {
+			iovs[i].iov_len = msgs[i].msg_len;
+		}
+		(void)sendmmsg(ctx->server_fd, msgs, count, 0);
+		ctx->syscalls++;
+		ctx->queries += count;
+	}
+
+	close(ep);
+}
+
+/*! \brief Echo loop with multishot receives and batched sends, as the io_uring UDP handler. */
+static void serve_uring(io_ctx_t *ctx)
+{
+	struct msghdr rx_hdr = { .msg_namelen = sizeof(struct sockaddr_storage) };
+	size_t bufsize = sizeof(struct io_uring_recvmsg_out) + rx_hdr.msg_namelen + MSG_SIZE;
+
+	uring_t ring;
+	if (uring_init(&ring, 2 * RX_BUFS, RX_BUFS, bufsize) != KNOT_EOK) {
+		ctx->failed = true;
+		return;
+	}
+
+	/* Each reply is sent from its own slot; at most one per receive buffer. */
+	static uint8_t bufs[RX_BUFS][MSG_SIZE];
+	static struct sockaddr_storage addrs[RX_BUFS];
+	static struct iovec iovs[RX_BUFS];
+	static struct msghdr msgs[RX_BUFS];
+	unsigned free_slots[RX_BUFS], nfree = 0;
+	for (unsigned i = 0; i < RX_BUFS; i++) {
+		free_slots[nfree++] = i;
+	}
+
+	bool armed = false;
+	uint64_t submits = 0;
+	struct io_uring_cqe *cqes[URING_MAX_CQES];
+	while (!ctx->stop) {
+		if (!armed) {
+			struct io_uring_sqe *sqe = uring_sqe(&ring);
+			io_uring_prep_recvmsg_multishot(sqe, ctx->server_fd, &rx_hdr, 0);
+			sqe->flags |= IOSQE_BUFFER_SELECT;
+			sqe->buf_group = URING_BGID;
+			io_uring_sqe_set_data64(sqe, uring_data(1, 0));
+			armed = true;
+		}
+
+		int count = uring_wait(&ring, cqes, SERVER_WAIT_MS);
+		if (count < 0) {
+			ctx->failed = true;
+			break;
+		}
+		for (int i = 0; i < count; i++) {
+			struct io_uring_cqe *cqe = cqes[i];
+			uint64_t data = io_uring_cqe_get_data64(cqe);
+			if (uring_data_type(data) == 2) {
+				free_slots[nfree++] = uring_data_idx(data);
+				continue;
+			}
+
+			uint8_t *buf = uring_cqe_buf(&ring, cqe);
+			struct io_uring_recvmsg_out *out = NULL;
+			if (cqe->res >= 0 && buf != NULL) {
+				out = io_uring_recvmsg_validate(buf, cqe->res, &rx_hdr);
+			}
+			if (out != NULL && nfree > 0) {
+				unsigned slot = free_slots[--nfree];
+				size_t len = io_uring_recvmsg_payload_length(out, cqe->res, &rx_hdr);
+				memcpy(bufs[slot], io_uring_recvmsg_payload(out, &rx_hdr),
+				       MIN(len, MSG_SIZE));
+				memcpy(&addrs[slot], io_uring_recvmsg_name(out),
+				       MIN(out->namelen, sizeof(addrs[slot])));
+				iovs[slot].iov_base = bufs[slot];
+				iovs[slot].iov_len = MIN(len, MSG_SIZE);
+				msgs[slot] = (struct msghdr) {
+					.msg_name = &addrs[slot],
+					.msg_namelen = out->namelen,
+					.msg_iov = &iovs[slot],
+					.msg_iovlen = 1,
+				};
+				struct io_uring_sqe *sqe = uring_sqe(&ring);
+				io_uring_prep_sendmsg(sqe, ctx->server_fd, &msgs[slot], 0);
+				io_uring_sqe_set_data64(sqe, uring_data(2, slot));
+				ctx->queries++;
+			}
+			uring_cqe_buf_recycle(&ring, cqe);
+			if (!uring_cqe_more(cqe)) {
+				armed = false;
+			}
+		}
+		uring_seen(&ring, count);
+
+		ctx->syscalls += ring.submits - submits;
+		submits = ring.submits;
+	}
+
+	uring_deinit(&ring);
+}
+
+static void *server_thread(void *data)
+{
+	io_ctx_t *ctx = data;
+	if (ctx->backend == BACKEND_EPOLL) {
+		serve_epoll(ctx);
+	} else {
+		serve_uring(ctx);
+	}
+
+	return NULL;
+}
+
+/*! \brief Client sending windows of queries and waiting for all the echoes. */
+static void bench_echo(void *data, size_t iterations)
+{
+	io_ctx_t *ctx = data;
+
+	static uint8_t bufs[WINDOW][MSG_SIZE];
+	struct iovec iovs[WINDOW];
+	struct mmsghdr msgs[WINDOW];
+
+	for (size_t done = 0; done < iterations && !ctx->failed; ) {
+		unsigned window = MIN(WINDOW, iterations - done);
+		for (unsigned i = 0; i < window; i++) {
+			iovs[i].iov_base = bufs[i];
+			iovs[i].iov_len = MSG_SIZE;
+			msgs[i].msg_hdr = (struct msghdr) { .msg_iov = &iovs[i], .msg_iovlen = 1 };
+		}
+		int sent = sendmmsg(ctx->client_fd, msgs, window, 0);
+		if (sent <= 0) {
+			ctx->failed = true;
+			break;
+		}
+
+		/* Lost replies are given up on after the receive timeout. */
+		for (int recvd = 0; recvd < sent; ) {
+			int ret = recvmmsg(ctx->client_fd, msgs, sent - recvd, MSG_WAITFORONE, NULL);
+			if (ret <= 0) {
+				break;
+			}
+			recvd += ret;
+		}
+		done += sent;
+	}
+}
+
+static int udp_socket(struct sockaddr_in *addr)
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		return -1;
+	}
+
+	int bufsize = 1 << 20;
+	(void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+	struct timeval timeout = { .tv_sec = 1 };
+	(void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	socklen_t addr_len = sizeof(*addr);
+	addr->sin_family = AF_INET;
+	addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(fd, (struct sockaddr *)addr, sizeof(*addr)) != 0 ||
+	    getsockname(fd, (struct sockaddr *)addr, &addr_len) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static void run_backend(const char *name, backend_t backend)
+{
+	io_ctx_t ctx = { .backend = backend };
+
+	struct sockaddr_in server_addr = { 0 }, client_addr = { 0 };
+	ctx.server_fd = udp_socket(&server_addr);
+	ctx.client_fd = udp_socket(&client_addr);
+	if (ctx.server_fd < 0 || ctx.client_fd < 0 ||
+	    connect(ctx.client_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) != 0 ||
+	    pthread_create(&ctx.thread, NULL, server_thread, &ctx) != 0) {
+		fprintf(stderr, "%s: failed to set up sockets (%s)\n", name, strerror(errno));
+		goto cleanup;
+	}
+
+	bench_run(name, bench_echo, &ctx);
+
+	ctx.stop = true;
+	pthread_join(ctx.thread, NULL);
+
+	if (ctx.failed) {
+		fprintf(stderr, "%s: backend not operational\n", name);
+	} else if (ctx.queries > 0) {
+		bench_metric("syscalls_per_query", (double)ctx.syscalls / ctx.queries);
+	}
+
+cleanup:
+	if (ctx.server_fd >= 0) {
+		close(ctx.server_fd);
+	}
+	if (ctx.client_fd >= 0) {
+		close(ctx.client_fd);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("io", argc, argv);
+
+	run_backend("udp_echo_epoll", BACKEND_EPOLL);
+	run_backend("udp_echo_io_uring", BACKEND_URING);
+
+	return bench_finish();
+}
@@ -0,0 +1,241 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <tap/files.h>
+
+#include "bench/bench.h"
+#include "knot/journal/journal_write.h"
+#include "knot/nameserver/ixfr_cache.h"
+#include "knot/nameserver/process_query.h"
+#include "knot/server/handler.h"
+#include "knot/test_server.h"
+#include "knot/updates/changesets.h"
+#include "contrib/sockaddr.h"
+#include "contrib/ucw/mempool.h"
+#include "libknot/libknot.h"
+
+#define CHANGESETS	8
+#define CHANGE_RRS	500
+
+typedef struct {
+	server_t server;
+	zone_t *zone;
+	knot_layer_t layer;
+	knotd_qdata_params_t params;
+	struct sockaddr_storage remote;
+	uint8_t query[KNOT_WIRE_MAX_PKTSIZE];
+	size_t query_len;
+	uint8_t answer[KNOT_WIRE_MAX_PKTSIZE];
+	size_t bytes;
+	size_t messages;
+} ixfr_ctx_t;
+
+static int init_server(ixfr_ctx_t *ctx, knot_mm_t *mm, const char *db_storage)
+{
+	char conf_str[4096 + 512];
+	(void)snprintf(conf_str, sizeof(conf_str),
+		"database:\n"
+		"    storage: %s\n"
+		"acl:\n"
+		"  - id: xfr\n"
+		"    address: 127.0.0.1\n"
+		"    action: transfer\n"
+		"zone:\n"
+		"  - domain: .\n"
+		"    zonefile-sync: -1\n"
+		"    acl: xfr\n",
+		db_storage);
+
+	int ret = test_conf(conf_str, NULL);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	ret = server_init(&ctx->server, 1);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	create_root_zone(&ctx->server, mm);
+	ctx->zone = knot_zonedb_find(ctx->server.zone_db, ROOT_DNAME);
+
+	return KNOT_EOK;
+}
+
+static knot_rrset_t *soa_with_serial(const zone_t *zone, uint32_t serial)
+{
+	knot_rrset_t soa = node_rrset(zone->contents->apex, KNOT_RRTYPE_SOA);
+	knot_rrset_t *copy = knot_rrset_copy(&soa, NULL);
+	if (copy != NULL) {
+		knot_soa_serial_set(copy->rrs.rdata, serial);
+	}
+
+	return copy;
+}
+
+static int add_host(changeset_t *ch, unsigned idx, bool addition)
+{
+	char txt[32];
+	(void)snprintf(txt, sizeof(txt), "host%u.", idx);
+	knot_dname_t *owner = knot_dname_from_str_alloc(txt);
+	if (owner == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	knot_rrset_t rr;
+	knot_rrset_init(&rr, owner, KNOT_RRTYPE_A, KNOT_CLASS_IN, 3600);
+	uint8_t addr[4] = { 192, 0, idx >> 8, idx };
+	int ret = knot_rrset_add_rdata(&rr, addr, sizeof(addr), NULL);
+	if (ret == KNOT_EOK) {
+		ret = addition ? changeset_add_addition(ch, &rr, 0) :
+		                 changeset_add_removal(ch, &rr, 0);
+	}
+	knot_rrset_clear(&rr, NULL);
+
+	return ret;
+}
+
+/* Store changesets leading to the zone serial, each replacing some hosts. */
+static int fill_journal(zone_t *zone, uint32_t *serial_from)
+{
+	zone_journal_t j = { zone_journaldb(zone), zone->name, conf() };
+	uint32_t serial_to = zone_contents_serial(zone->contents);
+	*serial_from = serial_to - CHANGESETS;
+
+	for (unsigned i = 0; i < CHANGESETS; i++) {
+		changeset_t ch;
+		int ret = changeset_init(&ch, zone->name);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+		ch.soa_from = soa_with_serial(zone, *serial_from + i);
+		ch.soa_to = soa_with_serial(zone, *serial_from + i + 1);
+		if (ch.soa_from == NULL || ch.soa_to == NULL) {
+			ret = KNOT_ENOMEM;
+		}
+		for (unsigned k = 0; ret == KNOT_EOK && k < CHANGE_RRS; k++) {
+			ret = add_host(&ch, i * CHANGE_RRS + k, true);
+			if (ret == KNOT_EOK && i > 0) {
+				ret = add_host(&ch, (i - 1) * CHANGE_RRS + k, false);
+			}
+		}
+		if (ret == KNOT_EOK) {
+			ret = journal_insert(j, &ch, NULL, NULL);
+		}
+		changeset_clear(&ch);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static void make_query(ixfr_ctx_t *ctx, uint32_t serial_from)
+{
+	knot_pkt_t *pkt = knot_pkt_new(ctx->query, sizeof(ctx->query), NULL);
+	knot_wire_set_id(pkt->wire, 0x1234);
+	knot_pkt_put_question(pkt, ROOT_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_IXFR);
+	knot_pkt_begin(pkt, KNOT_AUTHORITY);
+	knot_rrset_t *soa = soa_with_serial(ctx->zone, serial_from);
+	knot_pkt_put(pkt, 0, soa, 0);
+	knot_rrset_free(soa, NULL);
+	ctx->query_len = pkt->size;
+	knot_pkt_free(pkt);
+}
+
+static void bench_ixfr_out(void *data, size_t iterations)
+{
+	ixfr_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		struct iovec rx = { ctx->query, ctx->query_len };
+		handle_query(&ctx->params, &ctx->layer, &rx, NULL);
+
+		knot_pkt_t *ans = knot_pkt_new(ctx->answer, sizeof(ctx->answer), ctx->layer.mm);
+		ctx->bytes = 0;
+		ctx->messages = 0;
+		while (active_state(ctx->layer.state)) {
+			knot_layer_produce(&ctx->layer, ans);
+			ctx->bytes += ans->size;
+			ctx->messages++;
+		}
+		bench_sink(ctx->layer.state);
+
+		handle_finish(&ctx->layer);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("ixfr", argc, argv);
+
+	ixfr_ctx_t *ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+	knot_layer_init(&ctx->layer, &mm, process_query_layer());
+
+	char *temp_dir = test_mkdtemp();
+	if (temp_dir == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	uint32_t serial_from = 0;
+	int ret = init_server(ctx, &mm, temp_dir);
+	if (ret == KNOT_EOK) {
+		ret = fill_journal(ctx->zone, &serial_from);
+	}
+	if (ret != KNOT_EOK) {
+		fprintf(stderr, "failed to create server (%s)\n", knot_strerror(ret));
+		return EXIT_FAILURE;
+	}
+
+	sockaddr_set(&ctx->remote, AF_INET, "127.0.0.1", 53);
+	ctx->params = params_init(KNOTD_QUERY_PROTO_TCP, &ctx->remote, NULL, -1,
+	                          &ctx->server, 0);
+
+	/* The whole history and only the last changeset. */
+	const struct {
+		const char *name;
+		uint32_t serial;
+	} ranges[] = {
+		{ "all", serial_from },
+		{ "last", serial_from + CHANGESETS - 1 },
+	};
+
+	for (size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+		char name[32];
+		make_query(ctx, ranges[i].serial);
+
+		(void)snprintf(name, sizeof(name), "ixfr-out-%s", ranges[i].name);
+		bench_run(name, bench_ixfr_out, ctx);
+		bench_metric("messages", ctx->messages);
+		bench_metric("bytes", ctx->bytes);
+
+		ctx->zone->contents->ixfr_cache = ixfr_cache_new(1);
+		(void)snprintf(name, sizeof(name), "ixfr-out-%s-cached", ranges[i].name);
+		bench_run(name, bench_ixfr_out, ctx);
+		bench_metric("messages", ctx->messages);
+		bench_metric("bytes", ctx->bytes);
+		ixfr_cache_free(ctx->zone->contents->ixfr_cache);
+		ctx->zone->contents->ixfr_cache = NULL;
+	}
+
+	server_deinit(&ctx->server);
+	conf_free(conf());
+	mp_delete(mm.ctx);
+	test_rm_rf(temp_dir);
+	free(temp_dir);
+	free(ctx);
+
+	return bench_finish();
+}
@@ -0,0 +1,95 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "contrib/macros.h"
+#include "libdnssec/nsec.h"
+#include "libknot/dname.h"
+
+#define NAME_COUNT	1024
+#define BATCH		16
+
+typedef struct {
+	knot_dname_storage_t names[NAME_COUNT];
+	dnssec_binary_t data[NAME_COUNT];
+	dnssec_nsec3_params_t params;
+	size_t next;
+} nsec3_ctx_t;
+
+static void bench_hash(void *data, size_t iterations)
+{
+	nsec3_ctx_t *ctx = data;
+	dnssec_binary_t hash = { 0 };
+	for (size_t i = 0; i < iterations; i++) {
+		(void)dnssec_nsec3_hash(&ctx->data[ctx->next++ % NAME_COUNT],
+		                        &ctx->params, &hash);
+		bench_sink(hash.data[0]);
+		dnssec_binary_free(&hash);
+	}
+}
+
+static void bench_hash_many(void *data, size_t iterations)
+{
+	nsec3_ctx_t *ctx = data;
+	uint8_t hashes[BATCH * 20];
+	size_t done = 0;
+	while (done < iterations) {
+		size_t first = ctx->next % NAME_COUNT;
+		size_t left = MIN(iterations - done, NAME_COUNT - first);
+		size_t count = MIN(BATCH, left);
+		(void)dnssec_nsec3_hash_many(&ctx->data[first], count, &ctx->params,
+		                             hashes);
+		bench_sink(hashes[0]);
+		ctx->next += count;
+		done += count;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("nsec3_hash", argc, argv);
+
+	nsec3_ctx_t *ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	/* Names with 2-5 labels below a common zone. */
+	for (unsigned i = 0; i < NAME_COUNT; i++) {
+		char txt[128] = "";
+		for (unsigned l = 0; l < 1 + i % 4; l++) {
+			char label[16];
+			snprintf(label, sizeof(label), "lbl%u-%u.", i, l);
+			strcat(txt, label);
+		}
+		strcat(txt, "example.com.");
+		knot_dname_from_str(ctx->names[i], txt, sizeof(ctx->names[i]));
+		ctx->data[i].data = ctx->names[i];
+		ctx->data[i].size = knot_dname_size(ctx->names[i]);
+	}
+
+	ctx->params.algorithm = DNSSEC_NSEC3_ALGORITHM_SHA1;
+	ctx->params.salt.data = (uint8_t *)"\x12\x34\x56\x78\x9a\xbc\xde\xf0";
+	ctx->params.salt.size = 8;
+
+	/* Every operation is one name hashed. */
+	ctx->params.iterations = 0;
+	bench_run("dnssec_nsec3_hash", bench_hash, ctx);
+	bench_run("dnssec_nsec3_hash_many", bench_hash_many, ctx);
+	bench_metric("batch", BATCH);
+
+	ctx->params.iterations = 10;
+	bench_run("dnssec_nsec3_hash_10_iterations", bench_hash, ctx);
+	bench_run("dnssec_nsec3_hash_many_10_iterations", bench_hash_many, ctx);
+	bench_metric("batch", BATCH);
+
+	free(ctx);
+
+	return bench_finish();
+}
@@ -0,0 +1,198 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "contrib/mempattern.h"
+#include "contrib/ucw/mempool.h"
+#include "libknot/libknot.h"
+
+typedef struct {
+	knot_mm_t mm;
+	uint8_t query[KNOT_WIRE_MAX_PKTSIZE];
+	size_t query_len;
+	uint8_t resp[KNOT_WIRE_MAX_PKTSIZE];
+	size_t resp_len;
+	knot_pkt_t *out;
+	knot_rrset_t *mx;
+} pkt_ctx_t;
+
+static knot_rrset_t *make_rrset(const char *owner, uint16_t type,
+                                const char *rdata_names[], unsigned count)
+{
+	knot_dname_t *name = knot_dname_from_str_alloc(owner);
+	knot_rrset_t *rrset = knot_rrset_new(name, type, KNOT_CLASS_IN, 3600, NULL);
+	knot_dname_free(name, NULL);
+
+	for (unsigned i = 0; i < count; i++) {
+		uint8_t rdata[2 + KNOT_DNAME_MAXLEN];
+		size_t rdlen = 0;
+		if (type == KNOT_RRTYPE_A) {
+			uint8_t addr[4] = { 192, 0, 2, i + 1 };
+			memcpy(rdata, addr, sizeof(addr));
+			rdlen = sizeof(addr);
+		} else {
+			if (type == KNOT_RRTYPE_MX) {
+				knot_wire_write_u16(rdata, 10 * (i + 1));
+				rdlen = 2;
+			}
+			knot_dname_t *target = knot_dname_from_str(rdata + rdlen, rdata_names[i],
+			                                           sizeof(rdata) - rdlen);
+			rdlen += knot_dname_size(target);
+		}
+		knot_rrset_add_rdata(rrset, rdata, rdlen, NULL);
+	}
+
+	return rrset;
+}
+
+static int put_rrset(knot_pkt_t *pkt, knot_section_t section, knot_rrset_t *rrset)
+{
+	int ret = knot_pkt_begin(pkt, section);
+	if (ret == KNOT_EOK) {
+		ret = knot_pkt_put(pkt, KNOT_COMPR_HINT_NONE, rrset, 0);
+	}
+	return ret;
+}
+
+/* Typical referral-like response with compressible names and EDNS. */
+static int make_packets(pkt_ctx_t *ctx)
+{
+	const char *ns[] = { "ns1.example.com.", "ns2.example.com." };
+	const char *mx[] = { "mx1.example.com.", "mx2.example.com.",
+	                     "mx3.example.com.", "mx4.example.com." };
+
+	knot_pkt_t *query = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	knot_dname_t *qname = knot_dname_from_str_alloc("example.com.");
+	knot_pkt_put_question(query, qname, KNOT_CLASS_IN, KNOT_RRTYPE_MX);
+	knot_dname_free(qname, NULL);
+
+	knot_rrset_t opt;
+	knot_edns_init(&opt, 1232, 0, 0, NULL);
+	knot_pkt_begin(query, KNOT_ADDITIONAL);
+	knot_pkt_put(query, KNOT_COMPR_HINT_NONE, &opt, KNOT_PF_FREE);
+	memcpy(ctx->query, query->wire, query->size);
+	ctx->query_len = query->size;
+
+	knot_pkt_t *pkt = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	int ret = knot_pkt_init_response(pkt, query);
+	knot_pkt_free(query);
+	if (ret != KNOT_EOK) {
+		knot_pkt_free(pkt);
+		return ret;
+	}
+
+	knot_rrset_t *rr_mx = make_rrset("example.com.", KNOT_RRTYPE_MX, mx, 4);
+	knot_rrset_t *rr_ns = make_rrset("example.com.", KNOT_RRTYPE_NS, ns, 2);
+	knot_rrset_t *rr_a1 = make_rrset("mx1.example.com.", KNOT_RRTYPE_A, NULL, 2);
+	knot_rrset_t *rr_a2 = make_rrset("ns1.example.com.", KNOT_RRTYPE_A, NULL, 1);
+
+	ret = put_rrset(pkt, KNOT_ANSWER, rr_mx);
+	if (ret == KNOT_EOK) {
+		ret = put_rrset(pkt, KNOT_AUTHORITY, rr_ns);
+	}
+	if (ret == KNOT_EOK) {
+		ret = put_rrset(pkt, KNOT_ADDITIONAL, rr_a1);
+	}
+	if (ret == KNOT_EOK) {
+		ret = put_rrset(pkt, KNOT_ADDITIONAL, rr_a2);
+	}
+	memcpy(ctx->resp, pkt->wire, pkt->size);
+	ctx->resp_len = pkt->size;
+	knot_pkt_free(pkt);
+
+	/* Check the response parses back. */
+	pkt = knot_pkt_new(ctx->resp, ctx->resp_len, NULL);
+	if (ret == KNOT_EOK) {
+		ret = knot_pkt_parse(pkt, 0);
+	}
+	if (ret == KNOT_EOK && knot_pkt_section(pkt, KNOT_ANSWER)->count != 4) {
+		ret = KNOT_EMALF;
+	}
+	knot_pkt_free(pkt);
+
+	knot_rrset_free(rr_ns, NULL);
+	knot_rrset_free(rr_a1, NULL);
+	knot_rrset_free(rr_a2, NULL);
+	ctx->mx = rr_mx;
+
+	return ret;
+}
+
+static void bench_parse(pkt_ctx_t *ctx, uint8_t *wire, size_t len, size_t iterations)
+{
+	for (size_t i = 0; i < iterations; i++) {
+		knot_pkt_t *pkt = knot_pkt_new(wire, len, &ctx->mm);
+		bench_sink(knot_pkt_parse(pkt, 0));
+		knot_pkt_free(pkt);
+		mp_flush(ctx->mm.ctx);
+	}
+}
+
+static void bench_parse_query(void *data, size_t iterations)
+{
+	pkt_ctx_t *ctx = data;
+	bench_parse(ctx, ctx->query, ctx->query_len, iterations);
+}
+
+static void bench_parse_response(void *data, size_t iterations)
+{
+	pkt_ctx_t *ctx = data;
+	bench_parse(ctx, ctx->resp, ctx->resp_len, iterations);
+}
+
+static void bench_rrset_to_wire(void *data, size_t iterations)
+{
+	pkt_ctx_t *ctx = data;
+	knot_pkt_t *out = ctx->out;
+
+	for (size_t i = 0; i < iterations; i++) {
+		knot_rrinfo_t info = { 0 };
+		knot_compr_t compr = {
+			.wire = out->wire,
+			.rrinfo = &info,
+			.suffix = {
+				.pos = KNOT_WIRE_HEADER_SIZE,
+				.labels = knot_dname_labels(out->wire + KNOT_WIRE_HEADER_SIZE, NULL)
+			}
+		};
+		bench_sink(knot_rrset_to_wire_extra(ctx->mx, out->wire + out->size,
+		                                    out->max_size - out->size, 0, &compr, 0));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("pkt", argc, argv);
+
+	pkt_ctx_t *ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return EXIT_FAILURE;
+	}
+	mm_ctx_mempool(&ctx->mm, MM_DEFAULT_BLKSIZE);
+
+	if (make_packets(ctx) != KNOT_EOK) {
+		fprintf(stderr, "failed to prepare packets\n");
+		return EXIT_FAILURE;
+	}
+
+	/* Output packet with the question only, RRSet written after it. */
+	ctx->out = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	knot_pkt_put_question(ctx->out, ctx->mx->owner, KNOT_CLASS_IN, KNOT_RRTYPE_MX);
+
+	bench_run("knot_pkt_parse-query", bench_parse_query, ctx);
+	bench_run("knot_pkt_parse-response", bench_parse_response, ctx);
+	bench_run("knot_rrset_to_wire_extra-compr", bench_rrset_to_wire, ctx);
+
+	knot_pkt_free(ctx->out);
+	knot_rrset_free(ctx->mx, NULL);
+	mp_delete(ctx->mm.ctx);
+	free(ctx);
+
+	return bench_finish();
+}
@@ -0,0 +1,136 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <tap/files.h>
+
+#include "bench/bench.h"
+#include "knot/nameserver/process_query.h"
+#include "knot/server/handler.h"
+#include "knot/test_server.h"
+#include "contrib/sockaddr.h"
+#include "contrib/ucw/mempool.h"
+#include "libknot/libknot.h"
+
+#define HOST_COUNT	256
+#define QUERY_COUNT	64
+
+typedef struct {
+	server_t server;
+	knot_layer_t layer;
+	knotd_qdata_params_t params;
+	struct sockaddr_storage remote;
+	uint8_t queries[QUERY_COUNT][KNOT_WIRE_MAX_PKTSIZE];
+	size_t query_lens[QUERY_COUNT];
+	uint8_t answer[KNOT_WIRE_MAX_PKTSIZE];
+	size_t next;
+} pq_ctx_t;
+
+/* Add 'hostN.' A records to the fake root zone. */
+static int populate_zone(zone_t *zone)
+{
+	for (unsigned i = 0; i < HOST_COUNT; i++) {
+		char txt[32];
+		snprintf(txt, sizeof(txt), "host%u.", i);
+		knot_dname_t *owner = knot_dname_from_str_alloc(txt);
+		knot_rrset_t *rr = knot_rrset_new(owner, KNOT_RRTYPE_A, KNOT_CLASS_IN,
+		                                  3600, NULL);
+		knot_dname_free(owner, NULL);
+		if (rr == NULL) {
+			return KNOT_ENOMEM;
+		}
+		uint8_t addr[4] = { 192, 0, 2, i % 256 };
+		knot_rrset_add_rdata(rr, addr, sizeof(addr), NULL);
+
+		zone_node_t *node = NULL;
+		int ret = zone_contents_add_rr(zone->contents, rr, &node);
+		knot_rrset_free(rr, NULL);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return zone_adjust_full(zone->contents, 1);
+}
+
+/* Prepare queries; every fourth one is for a non-existent name. */
+static void make_queries(pq_ctx_t *ctx, uint16_t qtype)
+{
+	for (unsigned i = 0; i < QUERY_COUNT; i++) {
+		char txt[32];
+		snprintf(txt, sizeof(txt), "%s%u.", (i % 4 == 3) ? "missing" : "host",
+		         (i * 37) % HOST_COUNT);
+		knot_dname_t *qname = knot_dname_from_str_alloc(txt);
+
+		knot_pkt_t *pkt = knot_pkt_new(ctx->queries[i], sizeof(ctx->queries[i]), NULL);
+		knot_wire_set_id(pkt->wire, i);
+		knot_pkt_put_question(pkt, qname, KNOT_CLASS_IN, qtype);
+		ctx->query_lens[i] = pkt->size;
+		knot_pkt_free(pkt);
+		knot_dname_free(qname, NULL);
+	}
+}
+
+static void bench_udp_query(void *data, size_t iterations)
+{
+	pq_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = ctx->next++ % QUERY_COUNT;
+		struct iovec rx = { ctx->queries[k], ctx->query_lens[k] };
+		struct iovec tx = { ctx->answer, sizeof(ctx->answer) };
+		handle_udp_reply(&ctx->params, &ctx->layer, &rx, &tx, NULL);
+		bench_sink(tx.iov_len);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("process_query", argc, argv);
+
+	pq_ctx_t *ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+	knot_layer_init(&ctx->layer, &mm, process_query_layer());
+
+	char *temp_dir = test_mkdtemp();
+	if (temp_dir == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	int ret = create_fake_server(&ctx->server, &mm, temp_dir);
+	if (ret == KNOT_EOK) {
+		ret = populate_zone(knot_zonedb_find(ctx->server.zone_db, ROOT_DNAME));
+	}
+	if (ret != KNOT_EOK) {
+		fprintf(stderr, "failed to create server (%s)\n", knot_strerror(ret));
+		return EXIT_FAILURE;
+	}
+
+	sockaddr_set(&ctx->remote, AF_INET, "127.0.0.1", 53);
+	ctx->params = params_init(KNOTD_QUERY_PROTO_UDP, &ctx->remote, NULL, -1,
+	                          &ctx->server, 0);
+
+	make_queries(ctx, KNOT_RRTYPE_A);
+	bench_run("udp-a", bench_udp_query, ctx);
+
+	make_queries(ctx, KNOT_RRTYPE_AAAA);
+	bench_run("udp-nodata", bench_udp_query, ctx);
+
+	server_deinit(&ctx->server);
+	conf_free(conf());
+	mp_delete(mm.ctx);
+	test_rm_rf(temp_dir);
+	free(temp_dir);
+	free(ctx);
+
+	return bench_finish();
+}
@@ -0,0 +1,139 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "contrib/qp-trie/trie.h"
+#include "libknot/dname.h"
+
+#define KEY_COUNT	100000
+#define KEY_MAXLEN	KNOT_DNAME_MAXLEN
+
+typedef struct {
+	trie_t *trie;
+	uint8_t (*keys)[KEY_MAXLEN];
+	uint32_t *lens;
+	uint8_t (*misses)[KEY_MAXLEN];
+	uint32_t *miss_lens;
+	size_t next;
+} trie_ctx_t;
+
+/* Lookup-format keys of names like 'hostN.subM.zoneK.'. */
+static uint32_t make_key(uint8_t *key, unsigned i, const char *prefix)
+{
+	char txt[128];
+	snprintf(txt, sizeof(txt), "%s%u.sub%u.zone%u.", prefix, i, i % 97, i % 13);
+
+	knot_dname_storage_t name, lf;
+	knot_dname_from_str(name, txt, sizeof(name));
+	knot_dname_lf(name, lf);
+	memcpy(key, lf + 1, lf[0]);
+
+	return lf[0];
+}
+
+static void bench_get(void *data, size_t iterations)
+{
+	trie_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = (ctx->next++ * 7919) % KEY_COUNT;
+		bench_sink((uintptr_t)trie_get_try(ctx->trie, ctx->keys[k], ctx->lens[k]));
+	}
+}
+
+static void bench_get_miss(void *data, size_t iterations)
+{
+	trie_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = (ctx->next++ * 7919) % KEY_COUNT;
+		bench_sink((uintptr_t)trie_get_try(ctx->trie, ctx->misses[k], ctx->miss_lens[k]));
+	}
+}
+
+static void bench_get_leq(void *data, size_t iterations)
+{
+	trie_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = (ctx->next++ * 7919) % KEY_COUNT;
+		trie_val_t *val = NULL;
+		bench_sink(trie_get_leq(ctx->trie, ctx->misses[k], ctx->miss_lens[k], &val));
+		bench_sink((uintptr_t)val);
+	}
+}
+
+static void bench_get_longest_prefix(void *data, size_t iterations)
+{
+	trie_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = (ctx->next++ * 7919) % KEY_COUNT;
+		bench_sink((uintptr_t)trie_get_longest_prefix(ctx->trie, ctx->misses[k],
+		                                              ctx->miss_lens[k]));
+	}
+}
+
+static void bench_cow_update(void *data, size_t iterations)
+{
+	trie_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = (ctx->next++ * 7919) % KEY_COUNT;
+		trie_cow_t *cow = trie_cow(ctx->trie, NULL, NULL);
+		trie_val_t *val = trie_get_cow(cow, ctx->keys[k], ctx->lens[k]);
+		*val = (void *)(uintptr_t)(k + 1);
+		ctx->trie = trie_cow_commit(cow, NULL, NULL);
+	}
+}
+
+static void bench_ins_del(void *data, size_t iterations)
+{
+	trie_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		size_t k = (ctx->next++ * 7919) % KEY_COUNT;
+		trie_val_t *val = trie_get_ins(ctx->trie, ctx->misses[k], ctx->miss_lens[k]);
+		*val = (void *)(uintptr_t)(k + 1);
+		trie_del(ctx->trie, ctx->misses[k], ctx->miss_lens[k], NULL);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("qp-trie", argc, argv);
+
+	trie_ctx_t ctx = {
+		.trie = trie_create(NULL),
+		.keys = calloc(KEY_COUNT, KEY_MAXLEN),
+		.lens = calloc(KEY_COUNT, sizeof(uint32_t)),
+		.misses = calloc(KEY_COUNT, KEY_MAXLEN),
+		.miss_lens = calloc(KEY_COUNT, sizeof(uint32_t)),
+	};
+	if (ctx.trie == NULL || ctx.keys == NULL || ctx.lens == NULL ||
+	    ctx.misses == NULL || ctx.miss_lens == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	for (unsigned i = 0; i < KEY_COUNT; i++) {
+		ctx.lens[i] = make_key(ctx.keys[i], i, "host");
+		*trie_get_ins(ctx.trie, ctx.keys[i], ctx.lens[i]) = (void *)(uintptr_t)(i + 1);
+		/* Missing names sharing the zone suffixes. */
+		ctx.miss_lens[i] = make_key(ctx.misses[i], i, "www.host");
+	}
+
+	bench_run("get", bench_get, &ctx);
+	bench_run("get-miss", bench_get_miss, &ctx);
+	bench_run("get_leq", bench_get_leq, &ctx);
+	bench_run("get_longest_prefix", bench_get_longest_prefix, &ctx);
+	bench_run("get_ins+del", bench_ins_del, &ctx);
+	bench_run("cow-update", bench_cow_update, &ctx);
+
+	trie_free(ctx.trie);
+	free(ctx.keys);
+	free(ctx.lens);
+	free(ctx.misses);
+	free(ctx.miss_lens);
+
+	return bench_finish();
+}
@@ -0,0 +1,123 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "knot/zone/zone.h"
+#include "knot/zone/zonedb.h"
+#include "libknot/libknot.h"
+
+#define ZONE_COUNT	500000
+#define QNAME_COUNT	65536
+
+typedef struct {
+	knot_zonedb_t *db;
+	zone_t **zones;
+	knot_dname_t **qnames;
+	size_t next;
+} zonedb_ctx_t;
+
+/*! \brief Reference suffix lookup, one exact lookup per stripped label. */
+static zone_t *find_suffix_per_label(knot_zonedb_t *db, const knot_dname_t *name)
+{
+	while (true) {
+		zone_t *zone = knot_zonedb_find(db, name);
+		if (zone != NULL || name[0] == '\0') {
+			return zone;
+		}
+		name = knot_dname_next_label(name);
+	}
+}
+
+static void bench_find_suffix(void *data, size_t iterations)
+{
+	zonedb_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		const knot_dname_t *qname = ctx->qnames[ctx->next++ % QNAME_COUNT];
+		bench_sink((uintptr_t)knot_zonedb_find_suffix(ctx->db, qname));
+	}
+}
+
+static void bench_find_suffix_per_label(void *data, size_t iterations)
+{
+	zonedb_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		const knot_dname_t *qname = ctx->qnames[ctx->next++ % QNAME_COUNT];
+		bench_sink((uintptr_t)find_suffix_per_label(ctx->db, qname));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("zonedb", argc, argv);
+
+	srandom(42);
+
+	/* Zones 'zN.tldM.' with an occasional delegated 'sub.zN.tldM.'. */
+	zonedb_ctx_t ctx = {
+		.db = knot_zonedb_new(),
+		.zones = calloc(ZONE_COUNT, sizeof(zone_t *)),
+		.qnames = calloc(QNAME_COUNT, sizeof(knot_dname_t *)),
+	};
+	if (ctx.db == NULL || ctx.zones == NULL || ctx.qnames == NULL) {
+		return EXIT_FAILURE;
+	}
+	for (unsigned i = 0; i < ZONE_COUNT; ++i) {
+		char txt[64];
+		snprintf(txt, sizeof(txt), "%sz%u.tld%u.", (i % 8 == 0) ? "sub." : "",
+		         i, i % 64);
+		knot_dname_t *name = knot_dname_from_str_alloc(txt);
+		ctx.zones[i] = zone_new(name);
+		knot_dname_free(name, NULL);
+		if (ctx.zones[i] == NULL ||
+		    knot_zonedb_insert(ctx.db, ctx.zones[i]) != KNOT_EOK) {
+			fprintf(stderr, "failed to insert zone '%s'\n", txt);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* Query names with 6-10 labels below a random zone. */
+	for (unsigned i = 0; i < QNAME_COUNT; ++i) {
+		char txt[256] = "";
+		unsigned labels = 6 + random() % 5;
+		unsigned zone = random() % ZONE_COUNT;
+		for (unsigned l = 0; l < labels - 2; ++l) {
+			char label[16];
+			snprintf(label, sizeof(label), "l%ld.", random() % 1000);
+			strcat(txt, label);
+		}
+		char suffix[32];
+		snprintf(suffix, sizeof(suffix), "z%u.tld%u.", zone, zone % 64);
+		strcat(txt, suffix);
+		ctx.qnames[i] = knot_dname_from_str_alloc(txt);
+	}
+
+	/* Verify both lookups agree before measuring. */
+	for (unsigned i = 0; i < QNAME_COUNT; ++i) {
+		if (knot_zonedb_find_suffix(ctx.db, ctx.qnames[i]) !=
+		    find_suffix_per_label(ctx.db, ctx.qnames[i])) {
+			fprintf(stderr, "lookup mismatch\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	bench_run("find_suffix-500k-zones", bench_find_suffix, &ctx);
+	bench_run("find_suffix-per-label-500k-zones", bench_find_suffix_per_label, &ctx);
+
+	for (unsigned i = 0; i < QNAME_COUNT; ++i) {
+		knot_dname_free(ctx.qnames[i], NULL);
+	}
+	knot_zonedb_free(&ctx.db);
+	for (unsigned i = 0; i < ZONE_COUNT; ++i) {
+		zone_free(&ctx.zones[i]);
+	}
+	free(ctx.qnames);
+	free(ctx.zones);
+
+	return bench_finish();
+}
@@ -0,0 +1,96 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "libzscanner/scanner.h"
+
+#define NAME_COUNT	2000
+
+typedef struct {
+	char *zone;
+	size_t zone_len;
+	size_t records;
+} zs_ctx_t;
+
+static void count_record(zs_scanner_t *s)
+{
+	(*(size_t *)s->process.data)++;
+}
+
+/* Synthetic zone with a typical mix of record types. */
+static char *make_zone(size_t *len)
+{
+	size_t size = 256 + NAME_COUNT * 512;
+	char *zone = malloc(size);
+	if (zone == NULL) {
+		return NULL;
+	}
+
+	int pos = snprintf(zone, size,
+		"$ORIGIN example.com.\n"
+		"$TTL 3600\n"
+		"@ SOA ns1 hostmaster 2024010101 3600 900 604800 300\n"
+		"@ NS ns1\n"
+		"@ NS ns2.example.net.\n"
+		"@ MX 10 mx1\n"
+		"@ TXT \"v=spf1 mx -all\"\n");
+	for (unsigned i = 0; i < NAME_COUNT; i++) {
+		pos += snprintf(zone + pos, size - pos,
+			"host%u A 192.0.%u.%u\n"
+			"host%u AAAA 2001:db8::%x:%x\n"
+			"www%u 300 CNAME host%u\n"
+			"_srv%u._tcp SRV 0 5 443 host%u\n"
+			"txt%u TXT \"record %u\" \"with two strings\"\n",
+			i, (i / 256) % 256, i % 256,
+			i, i / 65536, i % 65536,
+			i, i,
+			i, i,
+			i, i);
+	}
+	*len = pos;
+
+	return zone;
+}
+
+static void bench_parse_all(void *data, size_t iterations)
+{
+	zs_ctx_t *ctx = data;
+	for (size_t i = 0; i < iterations; i++) {
+		zs_scanner_t s;
+		size_t records = 0;
+		if (zs_init(&s, ".", 1, 3600) != 0 ||
+		    zs_set_input_string(&s, ctx->zone, ctx->zone_len) != 0 ||
+		    zs_set_processing(&s, count_record, NULL, &records) != 0 ||
+		    zs_parse_all(&s) != 0) {
+			fprintf(stderr, "zone parsing failed (%s)\n", zs_strerror(s.error.code));
+			exit(EXIT_FAILURE);
+		}
+		zs_deinit(&s);
+		ctx->records = records;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bench_init("zscanner", argc, argv);
+
+	zs_ctx_t ctx = { 0 };
+	ctx.zone = make_zone(&ctx.zone_len);
+	if (ctx.zone == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	bench_run("zs_parse_all-10k-records", bench_parse_all, &ctx);
+	fprintf(stderr, "zscanner: %zu records, %zu bytes per zone\n",
+	        ctx.records, ctx.zone_len);
+
+	free(ctx.zone);
+
+	return bench_finish();
+}
@@ -92,6 +92,40 @@ static bool str_key_get_leq(trie_t *trie, char **keys, size_t i, size_t size)
 
 }
 
+typedef struct {
+	const char *prev;
+	size_t count;
+} split_ctx_t;
+
+/* Check that the values are visited in ascending order and count them. */
+static int split_check_cb(trie_val_t *val, void *data)
+{
+	split_ctx_t *ctx = data;
+	if (ctx->prev != NULL && strcmp(ctx->prev, *val) > 0) {
+		diag("'%s' > '%s' FAIL", ctx->prev, (char *)*val);
+		return KNOT_ERROR;
+	}
+	ctx->prev = *val;
+	ctx->count++;
+	return KNOT_EOK;
+}
+
+static void test_split(trie_t *trie, size_t min_parts, size_t max_parts)
+{
+	trie_part_t *parts[max_parts];
+	size_t count = trie_split(trie, parts, max_parts, min_parts);
+	ok(count >= min_parts && count <= max_parts,
+	   "trie: split into %zu parts (min %zu, max %zu)", count, min_parts, max_parts);
+
+	split_ctx_t ctx = { 0 };
+	bool passed = true;
+	for (size_t i = 0; i < count && passed; ++i) {
+		passed = (trie_part_apply(parts[i], split_check_cb, &ctx) == KNOT_EOK);
+	}
+	ok(passed && ctx.count == trie_weight(trie),
+	   "trie: split parts are disjoint, ordered, and complete");
+}
+
 static void test_wildcards(void)
 {
 	/* Test zone. */
@@ -167,6 +201,75 @@ static void test_wildcards(void)
 	ok(true, "trie: wildcard searches");
 }
 
+static void test_longest_prefix(void)
+{
+	/* Stored names. */
+	const char *names[] = {
+		"example.cz",
+		"a.b.example.cz",
+		"c.a.b.example.cz",
+		"exampld.cz",
+		"net",
+	};
+	/* Query-answer pairs for the longest prefix search. */
+	const char *qa_pairs[][2] = {
+		{ ".", NULL },
+		{ "cz", NULL },
+		{ "example.cz", "example.cz" },
+		{ "www.example.cz", "example.cz" },
+		{ "b.example.cz", "example.cz" },
+		{ "a.b.example.cz", "a.b.example.cz" },
+		{ "x.a.b.example.cz", "a.b.example.cz" },
+		{ "c.a.b.example.cz", "c.a.b.example.cz" },
+		{ "d.c.a.b.example.cz", "c.a.b.example.cz" },
+		{ "aa.b.example.cz", "example.cz" },
+		{ "examplf.cz", NULL },
+		{ "a.exampld.cz", "exampld.cz" },
+		{ "f.e.d.c.b.a.net", "net" },
+		{ "org", NULL },
+	};
+
+	trie_t *trie = trie_create(NULL);
+	if (!trie) ok(false, "trie: create");
+
+	for (int i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+		knot_dname_storage_t dname_st, lf_st;
+		const knot_dname_t
+			*dname = knot_dname_from_str(dname_st, names[i], sizeof(dname_st)),
+			*lf = knot_dname_lf(dname, lf_st);
+		trie_val_t *val = trie_get_ins(trie, lf + 1, lf[0]);
+		if (!val || *val != NULL) {
+			ok(false, "trie: inserting '%s' (as dname_lf)", names[i]);
+			return;
+		}
+		*val = (void *)names[i];
+	}
+
+	bool passed = true;
+	for (int i = 0; i < sizeof(qa_pairs) / sizeof(qa_pairs[0]); ++i) {
+		knot_dname_storage_t q_dname_st, q_lf_st;
+		const knot_dname_t *q_dname =
+			knot_dname_from_str(q_dname_st, qa_pairs[i][0], sizeof(q_dname_st));
+		const knot_dname_t *q_lf = knot_dname_lf(q_dname, q_lf_st);
+
+		const char **ans = (const char **)trie_get_longest_prefix(trie, q_lf + 1, q_lf[0]);
+		if (!!ans != !!qa_pairs[i][1] || (ans && strcmp(*ans, qa_pairs[i][1]) != 0)) {
+			diag("trie: longest prefix for '%s' -> '%s'",
+			     qa_pairs[i][0], ans ? *ans : "<null>");
+			passed = false;
+		}
+	}
+
+	/* The root (empty key) is a prefix of everything. */
+	trie_val_t *val = trie_get_ins(trie, NULL, 0);
+	*val = ".";
+	const char **ans = (const char **)trie_get_longest_prefix(trie, (uint8_t *)"org", 4);
+	passed = passed && ans && strcmp(*ans, ".") == 0;
+
+	trie_free(trie);
+	ok(passed, "trie: longest prefix searches");
+}
+
 int main(int argc, char *argv[])
 {
 	plan_lazy();
@@ -259,6 +362,11 @@ int main(int argc, char *argv[])
 	is_int(inserted, iterated, "trie: sorted iteration");
 	trie_it_free(it);
 
+	/* Split into parts. */
+	test_split(trie, 1, 1);
+	test_split(trie, 16, 32);
+	test_split(trie, 1000, 1100);
+
 	/* Cleanup */
 	for (unsigned i = 0; i < key_count; ++i) {
 		free(keys[i]);
@@ -269,5 +377,8 @@ int main(int argc, char *argv[])
 	/* Test trie_get_try_wildcard(). */
 	test_wildcards();
 
+	/* Test trie_get_longest_prefix(). */
+	test_longest_prefix();
+
 	return 0;
 }
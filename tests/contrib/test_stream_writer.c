@@ -0,0 +1,99 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <tap/basic.h>
+#include <tap/files.h>
+
+#include "contrib/stream_writer.h"
+#include "contrib/string.h"
+#include "libknot/errcode.h"
+
+#define DATA_LEN	(100 * 1000 + 7)
+
+static bool check_file(const char *path, const uint8_t *data, size_t len)
+{
+	uint8_t *buf = malloc(len + 1);
+	int fd = open(path, O_RDONLY);
+	ssize_t ret = read(fd, buf, len + 1);
+	close(fd);
+
+	bool match = (ret == len && memcmp(buf, data, len) == 0);
+	free(buf);
+	return match;
+}
+
+static void test_write(const char *path, const uint8_t *data, bool direct)
+{
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	stream_writer_t *w = stream_writer_new(fd, 4096, 3, direct);
+	ok(w != NULL, "direct %u: create writer", direct);
+
+	// Pieces of varying sizes, some larger than one buffer.
+	int ret = KNOT_EOK;
+	size_t pos = 0, piece = 1;
+	while (pos < DATA_LEN && ret == KNOT_EOK) {
+		size_t len = (piece < DATA_LEN - pos) ? piece : DATA_LEN - pos;
+		ret = stream_writer_write(w, data + pos, len);
+		pos += len;
+		piece = (piece * 7) % 10007;
+	}
+	is_int(KNOT_EOK, ret, "direct %u: write data", direct);
+
+	uint64_t written = 0;
+	ret = stream_writer_finish(w, &written);
+	is_int(KNOT_EOK, ret, "direct %u: finish", direct);
+	ok(written == DATA_LEN, "direct %u: written size", direct);
+	close(fd);
+
+	ok(check_file(path, data, DATA_LEN), "direct %u: file contents", direct);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	char *tmp_dir = test_mkdtemp();
+	ok(tmp_dir != NULL, "create temporary directory");
+	char *path = sprintf_alloc("%s/stream", tmp_dir);
+
+	uint8_t *data = malloc(DATA_LEN);
+	for (size_t i = 0; i < DATA_LEN; i++) {
+		data[i] = i % 251;
+	}
+
+	ok(stream_writer_new(-1, 4096, 3, false) == NULL, "invalid descriptor");
+	ok(stream_writer_new(1, 4096, 1, false) == NULL, "too few buffers");
+
+	test_write(path, data, false);
+	test_write(path, data, true);
+
+	// Empty stream.
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	stream_writer_t *w = stream_writer_new(fd, 4096, 2, true);
+	uint64_t written = 1;
+	int ret = stream_writer_finish(w, &written);
+	ok(ret == KNOT_EOK && written == 0, "empty stream");
+	close(fd);
+
+	// Write error is reported.
+	fd = open(path, O_RDONLY);
+	w = stream_writer_new(fd, 4096, 2, false);
+	(void)stream_writer_write(w, data, DATA_LEN);
+	ret = stream_writer_finish(w, NULL);
+	ok(ret != KNOT_EOK, "write error");
+	close(fd);
+
+	free(data);
+	free(path);
+	test_rm_rf(tmp_dir);
+	free(tmp_dir);
+
+	return 0;
+}
@@ -47,6 +47,14 @@ void check_update(conf_t *conf, knot_rrset_t *authority, knot_tsig_key_t *key,
 	                       zone_name, parsed, NULL, KNOTD_QUERY_PROTO_TCP);
 	ok(ret == allowed, "%s", desc);
 
+	acl = conf_zone_get(conf, C_ACL, zone_name);
+	acl_set_t *set = acl_compile(conf, &acl);
+	ok(set != NULL, "Compile zone ACL");
+	ret = acl_set_allowed(set, ACL_ACTION_UPDATE, &addr, key, zone_name,
+	                      parsed, NULL, KNOTD_QUERY_PROTO_TCP, false);
+	ok(ret == allowed, "compiled, %s", desc);
+	acl_set_free(set);
+
 	knot_pkt_free(parsed);
 	knot_pkt_free(query);
 }
@@ -245,6 +253,53 @@ static void test_acl_allowed(void)
 	ret = acl_allowed(conf(), &acl, ACL_ACTION_NOTIFY, &addr, &key1, zone2_name, NULL, NULL, KNOTD_QUERY_PROTO_TCP);
 	ok(ret == true, "Address, key, action, match");
 
+	const struct {
+		knot_dname_t *zone;
+		const char *addr;
+		int family;
+		knot_tsig_key_t *key;
+		acl_action_t action;
+		knotd_query_proto_t proto;
+		bool allowed;
+	} cases[] = {
+		{ zone_name,  "2001::1",   AF_INET6, &key1, ACL_ACTION_QUERY,    KNOTD_QUERY_PROTO_TLS, true },
+		{ zone_name,  "2001::1",   AF_INET6, &key1, ACL_ACTION_TRANSFER, KNOTD_QUERY_PROTO_TLS, true },
+		{ zone_name,  "2001::2",   AF_INET6, &key1, ACL_ACTION_TRANSFER, KNOTD_QUERY_PROTO_TCP, false },
+		{ zone_name,  "2001::1",   AF_INET6, &key0, ACL_ACTION_TRANSFER, KNOTD_QUERY_PROTO_TCP, false },
+		{ zone_name,  "2001::1",   AF_INET6, &key2, ACL_ACTION_TRANSFER, KNOTD_QUERY_PROTO_TCP, false },
+		{ zone_name,  "2001::1",   AF_INET6, &key1, ACL_ACTION_NOTIFY,   KNOTD_QUERY_PROTO_TCP, false },
+		{ zone_name,  "240.0.0.1", AF_INET,  &key0, ACL_ACTION_NOTIFY,   KNOTD_QUERY_PROTO_UDP, true },
+		{ zone_name,  "240.0.0.1", AF_INET,  &key1, ACL_ACTION_NOTIFY,   KNOTD_QUERY_PROTO_TCP, false },
+		{ zone_name,  "240.0.0.2", AF_INET,  &key0, ACL_ACTION_NOTIFY,   KNOTD_QUERY_PROTO_TCP, false },
+		{ zone_name,  "240.0.0.2", AF_INET,  &key0, ACL_ACTION_UPDATE,   KNOTD_QUERY_PROTO_TLS, true },
+		{ zone_name,  "240.0.0.3", AF_INET,  &key0, ACL_ACTION_UPDATE,   KNOTD_QUERY_PROTO_TCP, false },
+		{ zone_name,  "1.1.1.1",   AF_INET,  &key3, ACL_ACTION_UPDATE,   KNOTD_QUERY_PROTO_TCP, true },
+		{ zone_name,  "100.0.0.1", AF_INET,  &key0, ACL_ACTION_TRANSFER, KNOTD_QUERY_PROTO_TCP, true },
+		{ zone_name,  "100.0.0.6", AF_INET,  &key0, ACL_ACTION_TRANSFER, KNOTD_QUERY_PROTO_TCP, false },
+		{ zone_name,  "::1",       AF_INET6, &key0, ACL_ACTION_TRANSFER, KNOTD_QUERY_PROTO_TCP, true },
+		{ zone2_name, "240.0.0.4", AF_INET,  &key1, ACL_ACTION_NOTIFY,   KNOTD_QUERY_PROTO_TCP, false },
+		{ zone2_name, "240.0.0.1", AF_INET,  &key1, ACL_ACTION_NOTIFY,   KNOTD_QUERY_PROTO_TCP, true },
+	};
+
+	acl_cache_t *cache = acl_cache_new(conf());
+	ok(cache != NULL, "Create ACL cache");
+	for (size_t i = 0; i < sizeof(cases) / sizeof(*cases); i++) {
+		acl = conf_zone_get(conf(), C_ACL, cases[i].zone);
+		const acl_set_t *set = acl_cache_acl(cache, &acl);
+		ok(set != NULL, "Get compiled zone ACL");
+		check_sockaddr_set(&addr, cases[i].family, cases[i].addr, 0);
+		knot_tsig_key_t key = *cases[i].key;
+		ret = acl_set_allowed(set, cases[i].action, &addr, &key, cases[i].zone,
+		                      NULL, NULL, cases[i].proto, false);
+		ok(ret == cases[i].allowed, "compiled, case %zu", i);
+		ok((ret && key.name != NULL) == (key.secret.size > 0),
+		   "compiled, case %zu, secret", i);
+	}
+	acl = conf_zone_get(conf(), C_ACL, zone_name);
+	ok(acl_cache_acl(cache, &acl) == acl_cache_acl(cache, &acl),
+	   "Compiled zone ACL reused");
+	acl_cache_free(cache);
+
 	knot_rrset_t A;
 	knot_rrset_init(&A, key1_name, KNOT_RRTYPE_A, KNOT_CLASS_IN, 3600);
 	knot_rrset_add_rdata(&A, (uint8_t *)"\x00\x00\x00\x00", 4, NULL);
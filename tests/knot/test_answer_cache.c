@@ -0,0 +1,192 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <string.h>
+#include <tap/basic.h>
+#include <tap/files.h>
+
+#include "knot/nameserver/answer_cache.h"
+#include "knot/nameserver/process_query.h"
+#include "libknot/rrtype/soa.h"
+#include "test_server.h"
+#include "contrib/sockaddr.h"
+#include "contrib/ucw/mempool.h"
+
+#define CACHE_SLOTS	16
+
+static void test_cache(void)
+{
+	const uint8_t key1[] = "\x03""www""\x07""example""\x00""\x00\x01";
+	const uint8_t key2[] = "\x04""mail""\x07""example""\x00""\x00\x01";
+	const uint8_t wire1[] = "first answer";
+	const uint8_t wire2[] = "second answer";
+	uint8_t buf[ANSWER_CACHE_MAX_WIRE];
+
+	ok(answer_cache_new(0) == NULL, "no cache without slots");
+
+	answer_cache_t *cache = answer_cache_new(1);
+	ok(cache != NULL, "create cache");
+
+	size_t len = answer_cache_get(cache, key1, sizeof(key1), buf, sizeof(buf));
+	is_int(0, len, "miss in empty cache");
+
+	answer_cache_put(cache, key1, sizeof(key1), wire1, sizeof(wire1));
+	len = answer_cache_get(cache, key1, sizeof(key1), buf, sizeof(buf));
+	ok(len == sizeof(wire1) && memcmp(buf, wire1, len) == 0, "hit stored answer");
+
+	len = answer_cache_get(cache, key1, sizeof(key1), buf, sizeof(wire1) - 1);
+	is_int(0, len, "miss if answer doesn't fit");
+
+	len = answer_cache_get(cache, key2, sizeof(key2), buf, sizeof(buf));
+	is_int(0, len, "miss for different key");
+
+	answer_cache_put(cache, key2, sizeof(key2), wire2, sizeof(wire2));
+	len = answer_cache_get(cache, key2, sizeof(key2), buf, sizeof(buf));
+	ok(len == sizeof(wire2) && memcmp(buf, wire2, len) == 0, "hit colliding answer");
+
+	len = answer_cache_get(cache, key1, sizeof(key1), buf, sizeof(buf));
+	is_int(0, len, "colliding answer replaced previous one");
+
+	answer_cache_put(cache, key1, sizeof(key1), buf, ANSWER_CACHE_MAX_WIRE + 1);
+	len = answer_cache_get(cache, key1, sizeof(key1), buf, sizeof(buf));
+	is_int(0, len, "too large answer not stored");
+
+	answer_cache_free(cache);
+}
+
+typedef struct {
+	knot_layer_t layer;
+	knotd_qdata_params_t params;
+	struct sockaddr_storage remote;
+	knot_pkt_t *query;
+	knot_pkt_t *answer;
+} env_t;
+
+/*! \brief Resolve the query, return the SOA serial from the answer or 0 if failed. */
+static uint32_t exec_query(env_t *env, const knot_dname_t *qname, uint16_t qtype,
+                           uint16_t id, knotd_query_proto_t proto)
+{
+	knot_pkt_clear(env->query);
+	knot_pkt_put_question(env->query, qname, KNOT_CLASS_IN, qtype);
+	knot_wire_set_id(env->query->wire, id);
+	knot_pkt_parse(env->query, 0);
+
+	env->params.proto = proto;
+	knot_layer_begin(&env->layer, &env->params);
+	knot_layer_consume(&env->layer, env->query);
+
+	knot_pkt_clear(env->answer);
+	knot_layer_produce(&env->layer, env->answer);
+	bool done = (env->layer.state == KNOT_STATE_DONE);
+	knot_layer_finish(&env->layer);
+	mp_flush(env->layer.mm->ctx);
+
+	/* Parse a copy as the answer wire is only rendered. */
+	knot_pkt_t *parsed = knot_pkt_new(env->answer->wire, env->answer->size, NULL);
+	if (!done || parsed == NULL || knot_pkt_parse(parsed, 0) != KNOT_EOK ||
+	    knot_wire_get_id(parsed->wire) != id ||
+	    memcmp(parsed->wire + KNOT_WIRE_HEADER_SIZE, env->query->wire + KNOT_WIRE_HEADER_SIZE,
+	           env->query->qname_size) != 0) {
+		knot_pkt_free(parsed);
+		return 0;
+	}
+
+	uint32_t serial = 0;
+	for (uint16_t i = 0; i < parsed->rrset_count; i++) {
+		if (parsed->rr[i].type == KNOT_RRTYPE_SOA) {
+			serial = knot_soa_serial(parsed->rr[i].rrs.rdata);
+			break;
+		}
+	}
+	knot_pkt_free(parsed);
+
+	return serial;
+}
+
+static void set_serial(zone_contents_t *contents, uint32_t serial)
+{
+	knot_soa_serial_set(node_rdataset(contents->apex, KNOT_RRTYPE_SOA)->rdata, serial);
+}
+
+static void test_process_query(server_t *server, knot_mm_t *mm)
+{
+	const knot_dname_t *nxname = (const knot_dname_t *)"\x07""example";
+	const knot_dname_t *nxname_case = (const knot_dname_t *)"\x07""ExAmPlE";
+
+	env_t env = { 0 };
+	knot_layer_init(&env.layer, mm, process_query_layer());
+	sockaddr_set(&env.remote, AF_INET, "127.0.0.1", 53);
+	env.params.remote = &env.remote;
+	env.params.server = server;
+	env.query = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	env.answer = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+
+	zone_t *zone = knot_zonedb_find(server->zone_db, ROOT_DNAME);
+	zone->contents->answer_cache = answer_cache_new(CACHE_SLOTS);
+	uint32_t serial = zone_contents_serial(zone->contents);
+
+	/* Answers rendered with the original serial are cached. */
+	ok(exec_query(&env, ROOT_DNAME, KNOT_RRTYPE_SOA, 1, KNOTD_QUERY_PROTO_UDP) == serial,
+	   "query: SOA answer");
+	ok(exec_query(&env, nxname, KNOT_RRTYPE_A, 2, KNOTD_QUERY_PROTO_UDP) == serial,
+	   "query: NXDOMAIN answer");
+
+	/* Changing the contents in place reveals the cached answers. */
+	set_serial(zone->contents, serial + 1);
+	ok(exec_query(&env, ROOT_DNAME, KNOT_RRTYPE_SOA, 3, KNOTD_QUERY_PROTO_UDP) == serial,
+	   "query: cache hit with patched ID");
+	ok(exec_query(&env, nxname_case, KNOT_RRTYPE_A, 4, KNOTD_QUERY_PROTO_UDP) == serial,
+	   "query: cache hit with patched QNAME case");
+	ok(exec_query(&env, nxname, KNOT_RRTYPE_AAAA, 5, KNOTD_QUERY_PROTO_UDP) == serial + 1,
+	   "query: cache miss for different QTYPE");
+	ok(exec_query(&env, ROOT_DNAME, KNOT_RRTYPE_SOA, 6, KNOTD_QUERY_PROTO_TCP) == serial + 1,
+	   "query: no cache for TCP");
+
+	/* New contents come with an empty cache. */
+	answer_cache_free(zone->contents->answer_cache);
+	zone->contents->answer_cache = answer_cache_new(CACHE_SLOTS);
+	ok(exec_query(&env, ROOT_DNAME, KNOT_RRTYPE_SOA, 7, KNOTD_QUERY_PROTO_UDP) == serial + 1,
+	   "query: new contents answered");
+	set_serial(zone->contents, serial + 2);
+	ok(exec_query(&env, ROOT_DNAME, KNOT_RRTYPE_SOA, 8, KNOTD_QUERY_PROTO_UDP) == serial + 1,
+	   "query: new contents cached");
+
+	/* Disabled cache. */
+	answer_cache_free(zone->contents->answer_cache);
+	zone->contents->answer_cache = NULL;
+	ok(exec_query(&env, ROOT_DNAME, KNOT_RRTYPE_SOA, 9, KNOTD_QUERY_PROTO_UDP) == serial + 2,
+	   "query: no cache if disabled");
+
+	knot_pkt_free(env.query);
+	knot_pkt_free(env.answer);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	test_cache();
+
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+
+	char *temp_dir = test_mkdtemp();
+	ok(temp_dir != NULL, "make temporary directory");
+
+	server_t server;
+	int ret = create_fake_server(&server, &mm, temp_dir);
+	is_int(KNOT_EOK, ret, "fake server initialization");
+	if (ret == KNOT_EOK) {
+		test_process_query(&server, &mm);
+	}
+
+	mp_delete(mm.ctx);
+	server_deinit(&server);
+	conf_free(conf());
+	test_rm_rf(temp_dir);
+	free(temp_dir);
+
+	return 0;
+}
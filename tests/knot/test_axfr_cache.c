@@ -0,0 +1,139 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <tap/basic.h>
+
+#include "knot/nameserver/axfr_cache.h"
+#include "knot/zone/contents.h"
+#include "libknot/libknot.h"
+
+#define HOSTS 3000
+
+static const knot_dname_t *apex = (const knot_dname_t *)"\x07""example""\x00";
+static const knot_dname_t *qname = (const knot_dname_t *)"\x07""ExAmPlE""\x00";
+
+static void add_rr(zone_contents_t *contents, const knot_dname_t *owner,
+                   uint16_t type, const void *rdata, uint16_t len)
+{
+	knot_rrset_t rr;
+	knot_rrset_init(&rr, (knot_dname_t *)owner, type, KNOT_CLASS_IN, 3600);
+	knot_rrset_add_rdata(&rr, rdata, len, NULL);
+	zone_node_t *unused = NULL;
+	zone_contents_add_rr(contents, &rr, &unused);
+	knot_rdataset_clear(&rr.rrs, NULL);
+}
+
+static zone_contents_t *create_contents(void)
+{
+	zone_contents_t *contents = zone_contents_new(apex, false);
+
+	const uint8_t soa[] = "\x02ns\x07""example\x00\x05""admin\x07""example\x00"
+	                      "\x00\x00\x00\x01\x00\x00\x0e\x10\x00\x00\x02\x58"
+	                      "\x00\x01\x51\x80\x00\x00\x01\x2c";
+	add_rr(contents, apex, KNOT_RRTYPE_SOA, soa, sizeof(soa) - 1);
+	add_rr(contents, apex, KNOT_RRTYPE_NS, "\x02ns\x07""example\x00", 12);
+
+	for (int i = 0; i < HOSTS; i++) {
+		char name[32];
+		(void)snprintf(name, sizeof(name), "host%d.example.", i);
+		knot_dname_t *owner = knot_dname_from_str_alloc(name);
+		uint8_t addr[4] = { 192, 0, i >> 8, i };
+		add_rr(contents, owner, KNOT_RRTYPE_A, addr, sizeof(addr));
+		knot_dname_free(owner, NULL);
+	}
+
+	return contents;
+}
+
+static knot_pkt_t *init_response(uint16_t id, size_t max_size, size_t reserve)
+{
+	knot_pkt_t *pkt = knot_pkt_new(NULL, max_size, NULL);
+	knot_wire_set_id(pkt->wire, id);
+	knot_pkt_put_question(pkt, qname, KNOT_CLASS_IN, KNOT_RRTYPE_AXFR);
+	knot_pkt_reserve(pkt, reserve);
+
+	return pkt;
+}
+
+/*! \brief Run a transfer, return the number of RRs or -1 if malformed. */
+static int transfer(axfr_cache_t *cache, unsigned *rendered_count, unsigned *msg_count)
+{
+	int rrs = 0;
+	int ret = KNOT_ESPACE;
+	*rendered_count = 0;
+	*msg_count = 0;
+
+	for (size_t idx = 0; ret == KNOT_ESPACE; idx++) {
+		knot_pkt_t *pkt = init_response(0x1234, KNOT_WIRE_MAX_PKTSIZE, 100);
+		if (!axfr_cache_usable(cache, pkt)) {
+			knot_pkt_free(pkt);
+			return -1;
+		}
+
+		bool rendered = false;
+		ret = axfr_cache_write(cache, idx, pkt, &rendered);
+		*rendered_count += rendered ? 1 : 0;
+		*msg_count += 1;
+
+		knot_pkt_t *parsed = knot_pkt_new(pkt->wire, pkt->size, NULL);
+		if ((ret != KNOT_EOK && ret != KNOT_ESPACE) ||
+		    knot_pkt_parse(parsed, 0) != KNOT_EOK ||
+		    knot_wire_get_id(parsed->wire) != 0x1234 ||
+		    memcmp(pkt->wire + KNOT_WIRE_HEADER_SIZE, qname, knot_dname_size(qname)) != 0) {
+			rrs = -1;
+		} else {
+			const knot_pktsection_t *answer = knot_pkt_section(parsed, KNOT_ANSWER);
+			const knot_rrset_t *first = knot_pkt_rr(answer, 0);
+			const knot_rrset_t *last = knot_pkt_rr(answer, answer->count - 1);
+			if ((idx == 0 && first->type != KNOT_RRTYPE_SOA) ||
+			    (ret == KNOT_EOK && last->type != KNOT_RRTYPE_SOA)) {
+				rrs = -1;
+			} else if (rrs >= 0) {
+				rrs += knot_wire_get_ancount(parsed->wire);
+			}
+		}
+
+		knot_pkt_free(parsed);
+		knot_pkt_free(pkt);
+	}
+
+	return rrs;
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	zone_contents_t *contents = create_contents();
+	axfr_cache_t *cache = axfr_cache_new(contents);
+	ok(cache != NULL, "create cache");
+
+	unsigned rendered = 0, messages = 0;
+	int rrs = transfer(cache, &rendered, &messages);
+	is_int(HOSTS + 3, rrs, "first transfer complete");
+	ok(messages > 1, "multiple messages");
+	is_int(messages, rendered, "first transfer rendered all messages");
+
+	axfr_cache_t *ref = axfr_cache_ref(cache);
+	rrs = transfer(ref, &rendered, &messages);
+	is_int(HOSTS + 3, rrs, "second transfer complete");
+	is_int(0, rendered, "second transfer reused all messages");
+	axfr_cache_unref(ref);
+
+	knot_pkt_t *pkt = init_response(0, KNOT_WIRE_MAX_PKTSIZE, AXFR_CACHE_RESERVE + 1);
+	ok(!axfr_cache_usable(cache, pkt), "not usable with large reserve");
+	knot_pkt_free(pkt);
+
+	pkt = init_response(0, KNOT_WIRE_MIN_PKTSIZE, 0);
+	ok(!axfr_cache_usable(cache, pkt), "not usable with small message");
+	knot_pkt_free(pkt);
+
+	axfr_cache_unref(cache);
+	zone_contents_deep_free(contents);
+
+	return 0;
+}
@@ -898,6 +898,7 @@ static void test_conf_io_list(void)
 	      "server.tcp-idle-timeout\n"
 	      "server.tcp-io-timeout\n"
 	      "server.tcp-remote-io-timeout\n"
+	      "server.refresh-inflight\n"
 	      "server.tcp-max-clients\n"
 	      "server.tcp-reuseport\n"
 	      "server.tcp-fastopen\n"
@@ -905,6 +906,8 @@ static void test_conf_io_list(void)
 	      "server.quic-idle-close-timeout\n"
 	      "server.quic-outbuf-max-size\n"
 	      "server.socket-affinity\n"
+	      "server.udp-segmentation\n"
+	      "server.io-uring\n"
 	      "server.udp-workers\n"
 	      "server.tcp-workers\n"
 	      "server.background-workers\n"
@@ -965,6 +968,7 @@ static const yp_item_t desc_server[] = {
 	{ C_TCP_IDLE_TIMEOUT,	  YP_TINT,  YP_VNONE },
 	{ C_TCP_IO_TIMEOUT,	  YP_TINT,  YP_VNONE },
 	{ C_TCP_RMT_IO_TIMEOUT,	  YP_TINT,  YP_VNONE },
+	{ C_REFRESH_INFLIGHT,	  YP_TINT,  YP_VNONE },
 	{ C_TCP_MAX_CLIENTS,	  YP_TINT,  YP_VNONE },
 	{ C_TCP_REUSEPORT,	  YP_TBOOL, YP_VNONE },
 	{ C_TCP_FASTOPEN,	  YP_TBOOL, YP_VNONE },
@@ -972,6 +976,8 @@ static const yp_item_t desc_server[] = {
 	{ C_QUIC_IDLE_CLOSE,	  YP_TINT,  YP_VNONE },
 	{ C_QUIC_OUTBUF_MAX_SIZE, YP_TINT,  YP_VNONE },
 	{ C_SOCKET_AFFINITY,	  YP_TBOOL, YP_VNONE },
+	{ C_UDP_SEGMENTATION,	  YP_TBOOL, YP_VNONE },
+	{ C_IO_URING,		  YP_TBOOL, YP_VNONE },
 	{ C_UDP_WORKERS,	  YP_TINT,  YP_VNONE },
 	{ C_TCP_WORKERS,	  YP_TINT,  YP_VNONE },
 	{ C_BG_WORKERS,		  YP_TINT,  YP_VNONE },
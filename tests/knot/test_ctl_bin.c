@@ -0,0 +1,302 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+#include <tap/files.h>
+#include <pthread.h>
+
+#include "knot/ctl/commands.h"
+#include "knot/ctl/process.h"
+#include "libknot/libknot.h"
+#include "contrib/ucw/mempool.h"
+#include "test_server.h"
+
+#define MAX_RRSETS	16
+#define BIG_COUNT	600	// Enough TXT records to exceed one binary unit.
+
+typedef struct {
+	server_t *server;
+	knot_ctl_t *ctl;
+	int ret;
+} ctl_server_t;
+
+/*! \brief Records exported from the server, merged into rrsets. */
+typedef struct {
+	knot_rrset_t rrsets[MAX_RRSETS];
+	size_t count;
+	size_t units;
+	bool error;
+} export_t;
+
+static void *ctl_server(void *arg)
+{
+	ctl_server_t *ctx = arg;
+
+	bool exclusive = false;
+	ctx->ret = knot_ctl_accept(ctx->ctl);
+	if (ctx->ret == KNOT_EOK) {
+		ctx->ret = ctl_process(ctx->ctl, ctx->server, 0, &exclusive);
+		knot_ctl_close(ctx->ctl);
+	}
+
+	return NULL;
+}
+
+static void export_clear(export_t *out)
+{
+	for (size_t i = 0; i < out->count; i++) {
+		knot_rrset_clear(&out->rrsets[i], NULL);
+	}
+	memset(out, 0, sizeof(*out));
+}
+
+static knot_rrset_t *export_find(export_t *out, const knot_dname_t *owner, uint16_t type)
+{
+	for (size_t i = 0; i < out->count; i++) {
+		knot_rrset_t *rrset = &out->rrsets[i];
+		if (rrset->type == type && knot_dname_is_equal(rrset->owner, owner)) {
+			return rrset;
+		}
+	}
+	return NULL;
+}
+
+static int export_add(export_t *out, const uint8_t *wire, size_t len)
+{
+	size_t pos = 0;
+	while (pos < len) {
+		knot_rrset_t rr;
+		knot_rrset_init_empty(&rr);
+		int ret = knot_rrset_rr_from_wire(wire, &pos, len, &rr, NULL, true);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+
+		knot_rrset_t *rrset = export_find(out, rr.owner, rr.type);
+		if (rrset != NULL) {
+			ret = knot_rdataset_merge(&rrset->rrs, &rr.rrs, NULL);
+			knot_rrset_clear(&rr, NULL);
+		} else if (out->count < MAX_RRSETS) {
+			out->rrsets[out->count++] = rr;
+		} else {
+			knot_rrset_clear(&rr, NULL);
+			ret = KNOT_ESPACE;
+		}
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+/*! \brief Send the rrsets in wire format as binary units with whole records. */
+static int send_rrsets(knot_ctl_t *ctl, knot_rrset_t **rrsets, size_t count)
+{
+	static uint8_t unit[KNOT_CTL_BIN_MAX];
+	size_t len = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		knot_rrset_t rr = *rrsets[i];
+		rr.rrs.count = 1;
+		for (size_t j = 0; j < rrsets[i]->rrs.count; j++) {
+			rr.rrs.size = knot_rdata_size(rr.rrs.rdata->len);
+			int ret = knot_rrset_to_wire(&rr, unit + len, sizeof(unit) - len, NULL);
+			if (ret == KNOT_ESPACE) {
+				ret = knot_ctl_send_bin(ctl, unit, len);
+				len = 0;
+				if (ret != KNOT_EOK) {
+					return ret;
+				}
+				ret = knot_rrset_to_wire(&rr, unit, sizeof(unit), NULL);
+			}
+			if (ret < 0) {
+				return ret;
+			}
+			len += ret;
+			rr.rrs.rdata = knot_rdataset_next(rr.rrs.rdata);
+		}
+	}
+
+	return (len > 0) ? knot_ctl_send_bin(ctl, unit, len) : KNOT_EOK;
+}
+
+/*! \brief Execute one control command on the server, collect the binary reply. */
+static int exec(server_t *server, knot_ctl_t *srv_ctl, const char *path,
+                const char *cmd, const char *flags,
+                knot_rrset_t **rrsets, size_t count, export_t *out)
+{
+	ctl_server_t srv = { .server = server, .ctl = srv_ctl };
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, ctl_server, &srv) != 0) {
+		return KNOT_ERROR;
+	}
+
+	knot_ctl_t *ctl = knot_ctl_alloc();
+	int ret = knot_ctl_connect(ctl, path);
+	if (ret != KNOT_EOK) {
+		goto finish;
+	}
+
+	knot_ctl_data_t data = {
+		[KNOT_CTL_IDX_CMD] = cmd,
+		[KNOT_CTL_IDX_FLAGS] = flags,
+		[KNOT_CTL_IDX_ZONE] = ".",
+	};
+	ret = knot_ctl_send(ctl, KNOT_CTL_TYPE_DATA, &data);
+	if (ret == KNOT_EOK) {
+		ret = send_rrsets(ctl, rrsets, count);
+	}
+	if (ret == KNOT_EOK) {
+		ret = knot_ctl_send(ctl, KNOT_CTL_TYPE_BLOCK, NULL);
+	}
+	if (ret == KNOT_EOK) {
+		ret = knot_ctl_send(ctl, KNOT_CTL_TYPE_END, NULL);
+	}
+
+	knot_ctl_type_t type = KNOT_CTL_TYPE_DATA;
+	while (ret == KNOT_EOK && (ret = knot_ctl_receive(ctl, &type, &data)) == KNOT_EOK) {
+		if (type == KNOT_CTL_TYPE_BLOCK) {
+			break;
+		} else if (type == KNOT_CTL_TYPE_BIN) {
+			size_t len;
+			const uint8_t *bin = knot_ctl_bin(ctl, &len);
+			out->units++;
+			ret = export_add(out, bin, len);
+		} else if (type == KNOT_CTL_TYPE_DATA && data[KNOT_CTL_IDX_ERROR] != NULL) {
+			out->error = true;
+		}
+	}
+	knot_ctl_close(ctl);
+finish:
+	knot_ctl_free(ctl);
+	pthread_join(thread, NULL);
+
+	return (ret == KNOT_EOK && srv.ret != KNOT_EOF) ? srv.ret : ret;
+}
+
+static knot_rrset_t *rrset_new(const char *owner, uint16_t type, uint32_t ttl)
+{
+	knot_dname_storage_t dname;
+	(void)knot_dname_from_str(dname, owner, sizeof(dname));
+	return knot_rrset_new(dname, type, KNOT_CLASS_IN, ttl, NULL);
+}
+
+static bool exported(export_t *out, const knot_rrset_t *rrset)
+{
+	const knot_rrset_t *found = export_find(out, rrset->owner, rrset->type);
+	return found != NULL && knot_rrset_equal(found, rrset, true);
+}
+
+static void test_roundtrip(server_t *server, knot_ctl_t *srv_ctl, const char *path)
+{
+	export_t out = { 0 };
+
+	/* Two records joined into one rrset, another type at the same node. */
+	knot_rrset_t *a = rrset_new("a.", KNOT_RRTYPE_A, 3600);
+	knot_rrset_add_rdata(a, (const uint8_t *)"\xc0\x00\x02\x01", 4, NULL);
+	knot_rrset_add_rdata(a, (const uint8_t *)"\xc0\x00\x02\x02", 4, NULL);
+	knot_rrset_t *aaaa = rrset_new("a.", KNOT_RRTYPE_AAAA, 300);
+	knot_rrset_add_rdata(aaaa, (const uint8_t *)"\x20\x01\x0d\xb8\0\0\0\0\0\0\0\0\0\0\0\1", 16, NULL);
+
+	/* An rrset larger than one binary unit. */
+	knot_rrset_t *big = rrset_new("big.", KNOT_RRTYPE_TXT, 60);
+	uint8_t txt[256] = { 255 };
+	for (unsigned i = 0; i < BIG_COUNT; i++) {
+		memset(txt + 1, 'a' + i % 26, 254);
+		txt[255] = i / 26;
+		knot_rrset_add_rdata(big, txt, sizeof(txt), NULL);
+	}
+
+	knot_rrset_t *rrsets[] = { a, aaaa, big };
+	knot_rrset_t *soa = node_create_rrset(
+		knot_zonedb_find(server->zone_db, ROOT_DNAME)->contents->apex, KNOT_RRTYPE_SOA);
+
+	int ret = exec(server, srv_ctl, path, "zone-begin", NULL, NULL, 0, &out);
+	ok(ret == KNOT_EOK && !out.error, "begin transaction");
+
+	ret = exec(server, srv_ctl, path, "zone-set", CTL_FLAG_BINARY, rrsets, 3, &out);
+	ok(ret == KNOT_EOK && !out.error && out.units == 0, "import records");
+
+	ret = exec(server, srv_ctl, path, "zone-get", CTL_FLAG_BINARY, NULL, 0, &out);
+	ok(ret == KNOT_EOK && !out.error, "export records");
+	ok(out.count == 4 && exported(&out, soa) && exported(&out, a) &&
+	   exported(&out, aaaa) && exported(&out, big), "exported records match");
+	ok(out.units > 1, "large rrset split into more binary units");
+	export_clear(&out);
+
+	/* Remove one record. */
+	knot_rrset_t *rem = rrset_new("a.", KNOT_RRTYPE_A, 3600);
+	knot_rrset_add_rdata(rem, (const uint8_t *)"\xc0\x00\x02\x01", 4, NULL);
+	ret = exec(server, srv_ctl, path, "zone-unset", CTL_FLAG_BINARY, &rem, 1, &out);
+	ok(ret == KNOT_EOK && !out.error, "remove record");
+
+	(void)knot_rdataset_subtract(&a->rrs, &rem->rrs, NULL);
+	ret = exec(server, srv_ctl, path, "zone-get", CTL_FLAG_BINARY, NULL, 0, &out);
+	ok(ret == KNOT_EOK && out.count == 4 && exported(&out, a) &&
+	   exported(&out, big), "record removed");
+	export_clear(&out);
+
+	/* A non-IN record fails the import. */
+	knot_rrset_t *ch = rrset_new("c.", KNOT_RRTYPE_A, 3600);
+	ch->rclass = KNOT_CLASS_CH;
+	knot_rrset_add_rdata(ch, (const uint8_t *)"\xc0\x00\x02\x03", 4, NULL);
+	ret = exec(server, srv_ctl, path, "zone-set", CTL_FLAG_BINARY, &ch, 1, &out);
+	ok(ret == KNOT_EOK && out.error, "non-IN record refused");
+
+	ret = exec(server, srv_ctl, path, "zone-get", CTL_FLAG_BINARY, NULL, 0, &out);
+	ok(ret == KNOT_EOK && out.count == 4, "transaction unchanged");
+	export_clear(&out);
+
+	ret = exec(server, srv_ctl, path, "zone-abort", NULL, NULL, 0, &out);
+	ok(ret == KNOT_EOK && !out.error, "abort transaction");
+
+	knot_rrset_free(soa, NULL);
+	knot_rrset_free(a, NULL);
+	knot_rrset_free(aaaa, NULL);
+	knot_rrset_free(big, NULL);
+	knot_rrset_free(rem, NULL);
+	knot_rrset_free(ch, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+
+	char *temp_dir = test_mkdtemp();
+	ok(temp_dir != NULL, "make temporary directory");
+
+	char path[4096 + 32];
+	(void)snprintf(path, sizeof(path), "%s/knot.sock", temp_dir);
+
+	server_t server;
+	int ret = create_fake_server(&server, &mm, temp_dir);
+	is_int(KNOT_EOK, ret, "fake server initialization");
+	if (ret != KNOT_EOK) {
+		goto fatal;
+	}
+
+	knot_ctl_t *ctl = knot_ctl_alloc();
+	ret = knot_ctl_bind(ctl, path, 5);
+	is_int(KNOT_EOK, ret, "bind control socket");
+	if (ret == KNOT_EOK) {
+		test_roundtrip(&server, ctl, path);
+	}
+
+	knot_ctl_unbind(ctl);
+	knot_ctl_free(ctl);
+fatal:
+	server_deinit(&server);
+	conf_free(conf());
+
+	test_rm_rf(temp_dir);
+	free(temp_dir);
+	mp_delete(mm.ctx);
+
+	return 0;
+}
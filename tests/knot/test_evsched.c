@@ -0,0 +1,219 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "knot/common/evsched.h"
+#include "libknot/errcode.h"
+#include "contrib/time.h"
+
+#define BATCH	100
+
+/*!
+ * Dispatch log, records the order of fired events.
+ */
+typedef struct {
+	pthread_mutex_t mx;
+	pthread_cond_t cond;
+	int order[BATCH + 8];
+	unsigned count;
+} fire_log_t;
+
+static fire_log_t fire_log = {
+	.mx = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void fire_cb(event_t *ev)
+{
+	pthread_mutex_lock(&fire_log.mx);
+	fire_log.order[fire_log.count++] = (int)(intptr_t)ev->data;
+	pthread_cond_broadcast(&fire_log.cond);
+	pthread_mutex_unlock(&fire_log.mx);
+}
+
+/*!
+ * Wait until the given number of events fired, at most 5 seconds.
+ */
+static unsigned wait_fired(unsigned count)
+{
+	pthread_mutex_lock(&fire_log.mx);
+	for (int i = 0; i < 50 && fire_log.count < count; i++) {
+		pthread_mutex_unlock(&fire_log.mx);
+		usleep(100000);
+		pthread_mutex_lock(&fire_log.mx);
+	}
+	unsigned fired = fire_log.count;
+	pthread_mutex_unlock(&fire_log.mx);
+
+	return fired;
+}
+
+static void reset_fired(void)
+{
+	pthread_mutex_lock(&fire_log.mx);
+	fire_log.count = 0;
+	pthread_mutex_unlock(&fire_log.mx);
+}
+
+static uint64_t now_ms(void)
+{
+	struct timespec ts = time_now();
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*!
+ * Let the scheduler advance the wheel to the current time.
+ */
+static void sync_wheel(event_t *ev)
+{
+	pthread_mutex_lock(&fire_log.mx);
+	unsigned count = fire_log.count;
+	pthread_mutex_unlock(&fire_log.mx);
+
+	evsched_schedule(ev, 0);
+	for (int i = 0; i < 1000; i++) {
+		pthread_mutex_lock(&fire_log.mx);
+		bool fired = (fire_log.count > count);
+		pthread_mutex_unlock(&fire_log.mx);
+		if (fired) {
+			break;
+		}
+		usleep(1000);
+	}
+}
+
+/*!
+ * Fire the event three times, rescheduled from its callback.
+ */
+static void again_cb(event_t *ev)
+{
+	fire_cb(ev);
+	if (fire_log.count < 3) {
+		evsched_schedule_again(ev, 10);
+	}
+}
+
+static void interrupt_handle(int s)
+{
+}
+
+int main(void)
+{
+	plan_lazy();
+
+	struct sigaction sa;
+	sa.sa_handler = interrupt_handle;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGALRM, &sa, NULL); // Interrupt
+
+	evsched_t sched;
+	ok(evsched_init(&sched, NULL) == KNOT_EOK, "init scheduler");
+	evsched_start(&sched);
+
+	// events in different wheel levels fire in time order
+
+	event_t *ev[5];
+	for (int i = 0; i < 5; i++) {
+		ev[i] = evsched_event_create(&sched, fire_cb, (void *)(intptr_t)i);
+	}
+	ok(evsched_schedule(ev[0], 300) == KNOT_EOK, "schedule to second level");
+	ok(evsched_schedule(ev[1], 10) == KNOT_EOK, "schedule to first level");
+	ok(evsched_schedule(ev[2], 2000) == KNOT_EOK, "schedule far");
+	evsched_schedule(ev[3], 30);
+	evsched_schedule(ev[4], 20);
+
+	// cancel and reschedule
+
+	ok(evsched_cancel(ev[4]) == KNOT_EOK, "cancel event");
+	evsched_schedule(ev[2], 100);
+
+	ok(wait_fired(4) == 4, "all events fired");
+	usleep(50000);
+	ok(fire_log.count == 4, "canceled event not fired");
+	ok(fire_log.order[0] == 1 && fire_log.order[1] == 3 &&
+	   fire_log.order[2] == 2 && fire_log.order[3] == 0, "events fired in order");
+
+	// events of different levels reaching the same slot boundary
+
+	reset_fired();
+	event_t *sync = evsched_event_create(&sched, fire_cb, (void *)(intptr_t)-1);
+	event_t *tie[9];
+	for (int i = 0; i < 9; i++) {
+		tie[i] = evsched_event_create(&sched, fire_cb, (void *)(intptr_t)i);
+	}
+	sync_wheel(sync);
+	uint64_t now = now_ms();
+	uint64_t boundary = ((now + 300) / EVSCHED_SLOTS + 1) * EVSCHED_SLOTS;
+	evsched_schedule(tie[8], boundary + 10 - now); // Second level.
+	while ((now = now_ms()) + 100 < boundary) {
+		usleep(1000);
+	}
+	sync_wheel(sync);
+	now = now_ms();
+	for (int i = 0; i < 8; i++) {
+		evsched_schedule(tie[i], boundary + i - 4 - now); // First level.
+	}
+	ok(wait_fired(2 + 9) == 2 + 9, "events on the same boundary fired");
+	ok(now_ms() < boundary + 1000, "events on the same boundary not delayed");
+	for (int i = 0; i < 9; i++) {
+		evsched_cancel(tie[i]);
+		evsched_event_free(tie[i]);
+	}
+	evsched_cancel(sync);
+	evsched_event_free(sync);
+
+	// events expiring at once are dispatched together
+
+	reset_fired();
+	event_t *batch[BATCH];
+	for (int i = 0; i < BATCH; i++) {
+		batch[i] = evsched_event_create(&sched, fire_cb, (void *)(intptr_t)i);
+		evsched_schedule(batch[i], 0);
+	}
+	ok(wait_fired(BATCH) == BATCH, "immediate events fired");
+
+	// event rescheduled from its callback
+
+	reset_fired();
+	event_t *again = evsched_event_create(&sched, again_cb, NULL);
+	evsched_schedule(again, 0);
+	ok(wait_fired(3) == 3, "event rescheduled from callback");
+	usleep(50000);
+	ok(fire_log.count == 3, "rescheduled event fired once per schedule");
+	evsched_cancel(again);
+	evsched_event_free(again);
+
+	// paused scheduler keeps the events
+
+	reset_fired();
+	evsched_pause(&sched);
+	evsched_schedule(batch[0], 0);
+	usleep(50000);
+	ok(fire_log.count == 0, "no event fired while paused");
+	evsched_resume(&sched);
+	ok(wait_fired(1) == 1, "event fired after resume");
+
+	// scheduled events are freed by the scheduler
+
+	evsched_stop(&sched);
+	evsched_join(&sched);
+	for (int i = 0; i < BATCH; i++) {
+		evsched_schedule(batch[i], 100000);
+	}
+	for (int i = 0; i < 5; i++) {
+		evsched_event_free(ev[i]);
+	}
+	evsched_deinit(&sched);
+	ok(1, "deinit scheduler");
+
+	return 0;
+}
@@ -128,6 +128,34 @@ int main(int argc, char *argv[])
 	ret = fdset_poll(&fdset, &it, 0, 100);
 	ok(ret == 0, "fdset_poll return 3");
 
+	/* Switch between waiting for reading and writing. */
+	int fds3[2];
+	ret = pipe(fds3);
+	ok(ret >= 0, "create pipe 3");
+	int idx = fdset_add(&fdset, fds3[1], FDSET_POLLIN, NULL);
+	ok(idx >= 0, "add pipe 3 write end to fdset");
+	ret = fdset_poll(&fdset, &it, 0, 100);
+	ok(ret == 0, "fdset_poll not readable");
+
+	ret = fdset_set_events(&fdset, idx, FDSET_POLLOUT);
+	ok(ret == KNOT_EOK, "fdset_set_events pollout");
+	ret = fdset_poll(&fdset, &it, 0, 100);
+	ok(ret == 1 && fdset_it_is_pollout(&it) && !fdset_it_is_pollin(&it),
+	   "fdset can write");
+	fdset_it_commit(&it);
+
+	ret = fdset_set_events(&fdset, idx, FDSET_POLLIN);
+	ok(ret == KNOT_EOK, "fdset_set_events pollin");
+	ret = fdset_poll(&fdset, &it, 0, 100);
+	ok(ret == 0, "fdset_poll not readable again");
+
+	ret = fdset_set_events(&fdset, idx + 1, FDSET_POLLOUT);
+	ok(ret == KNOT_EINVAL, "fdset_set_events out of range");
+
+	ret = fdset_remove(&fdset, idx);
+	ok(ret == KNOT_EOK, "fdset remove pipe 3");
+	close(fds3[0]);
+
 
 	close(fds2[1]);
 	if (fd2_dup >= 0) {
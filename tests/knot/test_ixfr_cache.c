@@ -0,0 +1,155 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <string.h>
+#include <tap/basic.h>
+
+#include "knot/nameserver/ixfr_cache.h"
+#include "libknot/libknot.h"
+
+#define MESSAGES 3
+
+static const knot_dname_t *apex = (const knot_dname_t *)"\x07""example""\x00";
+static const knot_dname_t *qname = (const knot_dname_t *)"\x07""ExAmPlE""\x00";
+
+static knot_pkt_t *init_response(const knot_dname_t *name, uint16_t id,
+                                 size_t max_size, size_t reserve)
+{
+	knot_pkt_t *pkt = knot_pkt_new(NULL, max_size, NULL);
+	knot_wire_set_id(pkt->wire, id);
+	knot_pkt_put_question(pkt, name, KNOT_CLASS_IN, KNOT_RRTYPE_IXFR);
+	knot_pkt_reserve(pkt, reserve);
+
+	return pkt;
+}
+
+/*! \brief Render messages with 'idx' A records each. */
+static int render(ixfr_stream_t *stream)
+{
+	for (int idx = 1; idx <= MESSAGES; idx++) {
+		knot_pkt_t *pkt = init_response(apex, 0, KNOT_WIRE_MAX_PKTSIZE,
+		                                IXFR_CACHE_RESERVE);
+		knot_pkt_begin(pkt, KNOT_ANSWER);
+
+		knot_rrset_t rr;
+		knot_rrset_init(&rr, (knot_dname_t *)apex, KNOT_RRTYPE_A, KNOT_CLASS_IN, 3600);
+		for (int i = 0; i < idx; i++) {
+			uint8_t addr[4] = { 192, 0, 2, i };
+			knot_rrset_add_rdata(&rr, addr, sizeof(addr), NULL);
+		}
+		int ret = knot_pkt_put(pkt, 0, &rr, 0);
+		knot_rdataset_clear(&rr.rrs, NULL);
+		if (ret == KNOT_EOK) {
+			ret = ixfr_stream_add(stream, pkt);
+		}
+		knot_pkt_free(pkt);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+/*! \brief Write all messages, return the number of RRs or -1 if malformed. */
+static int transfer(const ixfr_stream_t *stream)
+{
+	int rrs = 0;
+	int ret = KNOT_ESPACE;
+
+	for (size_t idx = 0; ret == KNOT_ESPACE; idx++) {
+		knot_pkt_t *pkt = init_response(qname, 0x1234, KNOT_WIRE_MAX_PKTSIZE, 100);
+		if (!ixfr_stream_usable(stream, pkt)) {
+			knot_pkt_free(pkt);
+			return -1;
+		}
+		ret = ixfr_stream_write(stream, idx, pkt);
+
+		knot_pkt_t *parsed = knot_pkt_new(pkt->wire, pkt->size, NULL);
+		if ((ret != KNOT_EOK && ret != KNOT_ESPACE) ||
+		    knot_pkt_parse(parsed, 0) != KNOT_EOK ||
+		    knot_wire_get_id(parsed->wire) != 0x1234 ||
+		    memcmp(pkt->wire + KNOT_WIRE_HEADER_SIZE, qname, knot_dname_size(qname)) != 0 ||
+		    knot_wire_get_ancount(parsed->wire) != idx + 1) {
+			rrs = -1;
+		} else if (rrs >= 0) {
+			rrs += knot_wire_get_ancount(parsed->wire);
+		}
+
+		knot_pkt_free(parsed);
+		knot_pkt_free(pkt);
+	}
+
+	return rrs;
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	ok(ixfr_cache_new(0) == NULL, "disabled cache");
+
+	ixfr_cache_t *cache = ixfr_cache_new(2);
+	ok(cache != NULL, "create cache");
+
+	bool render_flag = false;
+	ok(ixfr_cache_get(cache, 1) == NULL, "empty cache");
+	ixfr_stream_t *stream = ixfr_cache_add(cache, 1, &render_flag);
+	ok(stream != NULL && render_flag, "first transfer renders");
+	int ret = render(stream);
+	is_int(KNOT_EOK, ret, "render stream");
+	ixfr_cache_done(cache, stream, ret);
+	is_int(1 + 2 + 3, transfer(stream), "first transfer complete");
+
+	ixfr_stream_t *hit = ixfr_cache_get(cache, 1);
+	ok(hit == stream, "second transfer reuses stream");
+	is_int(1 + 2 + 3, transfer(hit), "second transfer complete");
+	ixfr_stream_unref(hit);
+	hit = ixfr_cache_add(cache, 1, &render_flag);
+	ok(hit == stream && !render_flag, "stream added meanwhile reused");
+	ixfr_stream_unref(hit);
+
+	knot_pkt_t *pkt = init_response(qname, 0, KNOT_WIRE_MAX_PKTSIZE, IXFR_CACHE_RESERVE + 1);
+	ok(!ixfr_stream_usable(stream, pkt), "not usable with large reserve");
+	knot_pkt_free(pkt);
+	ixfr_stream_unref(stream);
+
+	/* Failed rendering isn't cached. */
+	stream = ixfr_cache_add(cache, 2, &render_flag);
+	ok(stream != NULL && render_flag, "render another serial");
+	ixfr_cache_done(cache, stream, KNOT_ENOMEM);
+	ixfr_stream_unref(stream);
+	ok(ixfr_cache_get(cache, 2) == NULL, "failed stream not cached");
+	stream = ixfr_cache_add(cache, 2, &render_flag);
+	ok(stream != NULL && render_flag, "failed stream rendered again");
+	ixfr_cache_done(cache, stream, render(stream));
+	ixfr_stream_unref(stream);
+
+	/* Lookups of other serials don't replace anything. */
+	ok(ixfr_cache_get(cache, 9) == NULL, "unknown serial not cached");
+	stream = ixfr_cache_get(cache, 1);
+	ok(stream != NULL, "stream kept after unknown serial lookup");
+	ixfr_stream_unref(stream);
+	stream = ixfr_cache_get(cache, 2);
+	ok(stream != NULL, "recent stream kept after unknown serial lookup");
+	ixfr_stream_unref(stream);
+
+	/* Serial 3 replaces the least recently used serial 1. */
+	stream = ixfr_cache_add(cache, 3, &render_flag);
+	ixfr_cache_done(cache, stream, render(stream));
+	ixfr_stream_unref(stream);
+	stream = ixfr_cache_get(cache, 2);
+	ok(stream != NULL, "recent stream kept");
+	ixfr_stream_unref(stream);
+	ok(ixfr_cache_get(cache, 1) == NULL, "least recent stream replaced");
+	stream = ixfr_cache_add(cache, 1, &render_flag);
+	ok(stream != NULL && render_flag, "replaced stream rendered again");
+	ixfr_cache_done(cache, stream, render(stream));
+	ixfr_stream_unref(stream);
+
+	ixfr_cache_free(cache);
+
+	return 0;
+}
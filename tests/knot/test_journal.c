@@ -7,6 +7,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -787,6 +788,144 @@ static void test_merge(const knot_dname_t *apex)
 	unset_conf();
 }
 
+/*! \brief Rewrite the chunk headers as older versions did, with the # of chunks set. */
+static int set_old_header(const knot_dname_t *apex, uint32_t serial)
+{
+	knot_lmdb_txn_t txn = { 0 };
+	knot_lmdb_begin(jj.db, &txn, true);
+	uint32_t count = 0;
+	bool found = true;
+	while (found && txn.ret == KNOT_EOK) {
+		MDB_val key = journal_make_chunk_key(apex, serial, false, count);
+		found = knot_lmdb_find(&txn, &key, KNOT_LMDB_EXACT);
+		free(key.mv_data);
+		count += found ? 1 : 0;
+	}
+	for (uint32_t i = 0; i < count && txn.ret == KNOT_EOK; i++) {
+		MDB_val key = journal_make_chunk_key(apex, serial, false, i);
+		if (knot_lmdb_find(&txn, &key, KNOT_LMDB_EXACT)) {
+			MDB_val val = { txn.cur_val.mv_size, malloc(txn.cur_val.mv_size) };
+			if (val.mv_data == NULL) {
+				txn.ret = KNOT_ENOMEM;
+			} else {
+				memcpy(val.mv_data, txn.cur_val.mv_data, val.mv_size);
+				knot_wire_write_u32(val.mv_data + sizeof(uint32_t), count);
+				knot_lmdb_insert(&txn, &key, &val);
+				free(val.mv_data);
+			}
+		}
+		free(key.mv_data);
+	}
+	knot_lmdb_commit(&txn);
+	return (txn.ret == KNOT_EOK && count == 0) ? KNOT_ENOENT : txn.ret;
+}
+
+static void test_old_header(const knot_dname_t *apex)
+{
+	set_conf(1000, 512 * 1024, apex);
+	jj.zone = apex;
+
+	list_t l, k;
+	init_list(&k);
+
+	changeset_t *ch = changeset_new(apex);
+	init_random_changeset(ch, 1, 2, 400, apex, false);
+	int ret = journal_insert(jj, ch, NULL, NULL);
+	is_int(KNOT_EOK, ret, "journal: store changeset (%s)", knot_strerror(ret));
+	add_tail(&k, &ch->n);
+
+	ret = set_old_header(apex, 1);
+	is_int(KNOT_EOK, ret, "journal: rewrite to old chunk header (%s)", knot_strerror(ret));
+
+	journal_read_t *read = NULL;
+	ret = load_j_list(&jj, false, 1, &read, &l);
+	is_int(KNOT_EOK, ret, "journal: read old chunk header (%s)", knot_strerror(ret));
+	ok(changesets_list_eq(&l, &k), "journal: changeset with old chunk header equal after read");
+	changesets_free(&l);
+	journal_read_end(read);
+
+	changesets_free(&k);
+	unset_conf();
+}
+
+#ifdef ENABLE_JOURNAL_COMPRESSION
+static void set_conf_compression(const char *compression)
+{
+	char conf_str[512];
+	snprintf(conf_str, sizeof(conf_str),
+	         "template:\n"
+	         " - id: default\n"
+	         "   zonefile-sync: -1\n"
+	         "   journal-max-usage: 1M\n"
+	         "   journal-compression: %s\n",
+	         compression);
+	_unused_ int ret = test_conf(conf_str, NULL);
+	assert(ret == KNOT_EOK);
+	jj.conf = conf();
+}
+
+static void test_compression(const knot_dname_t *apex)
+{
+	set_conf_compression("zstd");
+	jj.zone = apex;
+
+	list_t l, k;
+	init_list(&k);
+
+	changeset_t *ch = changeset_new(apex);
+	init_random_changeset(ch, 1, 2, 400, apex, false);
+	int ret = journal_insert(jj, ch, NULL, NULL);
+	is_int(KNOT_EOK, ret, "journal: store compressed changeset (%s)", knot_strerror(ret));
+	add_tail(&k, &ch->n);
+
+	bool compressed = false;
+	uint64_t stored = 0, raw = 0;
+	ret = journal_chunk_sizes(jj, &compressed, &stored, &raw);
+	ok(ret == KNOT_EOK && compressed && stored < raw,
+	   "journal: changeset stored compressed (%"PRIu64" < %"PRIu64")", stored, raw);
+
+	// Mixed compressed and uncompressed changesets are readable.
+	set_conf_compression("none");
+	ch = changeset_new(apex);
+	init_random_changeset(ch, 2, 3, 400, apex, false);
+	ret = journal_insert(jj, ch, NULL, NULL);
+	is_int(KNOT_EOK, ret, "journal: store uncompressed changeset (%s)", knot_strerror(ret));
+	add_tail(&k, &ch->n);
+
+	uint64_t stored2 = 0, raw2 = 0;
+	ret = journal_chunk_sizes(jj, &compressed, &stored2, &raw2);
+	ok(ret == KNOT_EOK && stored2 - stored == raw2 - raw,
+	   "journal: changeset stored uncompressed");
+
+	journal_read_t *read = NULL;
+	ret = load_j_list(&jj, false, 1, &read, &l);
+	is_int(KNOT_EOK, ret, "journal: read mixed changesets (%s)", knot_strerror(ret));
+	ok(changesets_list_eq(&l, &k), "journal: mixed changesets equal after read");
+	changesets_free(&l);
+	journal_read_end(read);
+
+	ret = journal_sem_check(jj);
+	is_int(KNOT_EOK, ret, "journal: check mixed changesets (%s)", knot_strerror(ret));
+
+	// Zone-in-journal.
+	set_conf_compression("zstd");
+	changeset_t *zij = changeset_new(apex);
+	init_random_changeset(zij, 0, 3, 400, apex, true);
+	ret = journal_insert_zone(jj, zij->add);
+	is_int(KNOT_EOK, ret, "journal: store compressed zone-in-journal (%s)", knot_strerror(ret));
+	ret = load_j_list(&jj, true, 0, &read, &l);
+	is_int(KNOT_EOK, ret, "journal: read compressed zone-in-journal (%s)", knot_strerror(ret));
+	ok(list_size(&l) == 1 && changesets_eq(zij, HEAD(l)),
+	   "journal: zone-in-journal equal after read");
+	changesets_free(&l);
+	journal_read_end(read);
+	changeset_free(zij);
+
+	changesets_free(&k);
+	unset_conf();
+}
+#endif
+
 static void test_stress_base(const knot_dname_t *apex,
                              size_t update_size, size_t file_size)
 {
@@ -858,6 +997,12 @@ int main(int argc, char *argv[])
 
 	test_merge(apex);
 
+	test_old_header((const uint8_t *)"\3old");
+
+#ifdef ENABLE_JOURNAL_COMPRESSION
+	test_compression((const uint8_t *)"\4comp");
+#endif
+
 	test_stress(apex);
 
 	knot_lmdb_deinit(&jdb);
@@ -0,0 +1,205 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "knot/events/handlers/notify.c"
+#include "test_conf.h"
+
+#define TIMEOUT_MS	300
+#define MAX_TARGETS	8
+
+static atomic_int answered;
+
+/*!
+ * Answers the NOTIFYs of the accepted connections until the socket is shut down.
+ */
+static void *responder_thread(void *arg)
+{
+	int fd = *(int *)arg;
+
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	uint8_t ans_buf[KNOT_WIRE_MAX_PKTSIZE];
+
+	int client;
+	while ((client = accept(fd, NULL, NULL)) >= 0) {
+		ssize_t len = net_dns_tcp_recv(client, buf, sizeof(buf), 2000);
+		knot_pkt_t *query = knot_pkt_new(buf, MAX(len, 0), NULL);
+		knot_pkt_t *ans = knot_pkt_new(ans_buf, sizeof(ans_buf), NULL);
+		if (len > 0 && knot_pkt_parse(query, 0) == KNOT_EOK &&
+		    knot_wire_get_opcode(query->wire) == KNOT_OPCODE_NOTIFY &&
+		    knot_pkt_init_response(ans, query) == KNOT_EOK &&
+		    net_dns_tcp_send(client, ans->wire, ans->size, 2000, NULL) > 0) {
+			atomic_fetch_add(&answered, 1);
+		}
+		knot_pkt_free(query);
+		knot_pkt_free(ans);
+		close(client);
+	}
+
+	return NULL;
+}
+
+/*!
+ * Bind a loopback TCP socket, listening if requested (connections refused otherwise).
+ */
+static int tcp_socket(struct sockaddr_storage *addr, bool listening)
+{
+	sockaddr_set(addr, AF_INET, "127.0.0.1", 0);
+	int fd = net_bound_socket(SOCK_STREAM, addr, 0, 0);
+	socklen_t addr_len = sockaddr_len(addr);
+	if (fd < 0 || getsockname(fd, (struct sockaddr *)addr, &addr_len) != 0 ||
+	    (listening && listen(fd, 16) != 0)) {
+		return -1;
+	}
+	return fd;
+}
+
+static int set_conf(const struct sockaddr_storage *server,
+                    const struct sockaddr_storage *silent,
+                    const struct sockaddr_storage *refused)
+{
+	char conf_str[1024];
+	(void)snprintf(conf_str, sizeof(conf_str),
+		"remote:\n"
+		"  - id: silent1\n"
+		"    address: 127.0.0.1@%1$d\n"
+		"  - id: silent2\n"
+		"    address: 127.0.0.1@%1$d\n"
+		"  - id: server\n"
+		"    address: 127.0.0.1@%2$d\n"
+		"  - id: timeout-fallback\n"
+		"    address: [ 127.0.0.1@%1$d, 127.0.0.1@%2$d ]\n"
+		"  - id: refused-fallback\n"
+		"    address: [ 127.0.0.1@%3$d, 127.0.0.1@%2$d ]\n"
+		"zone:\n"
+		"  - domain: example.\n"
+		"    notify: [ silent1, silent2, server, timeout-fallback, refused-fallback ]\n",
+		sockaddr_port(silent), sockaddr_port(server), sockaddr_port(refused));
+
+	return test_conf(conf_str, NULL);
+}
+
+/*! \brief Prepare the targets as event_notify() does. */
+static size_t make_targets(conf_t *conf, const zone_t *zone, notify_target_t *targets)
+{
+	size_t count = 0;
+	conf_val_t notify = conf_zone_get(conf, C_NOTIFY, zone->name);
+	conf_mix_iter_t iter;
+	conf_mix_iter_init(conf, &notify, &iter);
+	for (; iter.id->code == KNOT_EOK && count < MAX_TARGETS; conf_mix_iter_next(&iter)) {
+		conf_val_t addr = conf_id_get(conf, C_RMT, C_ADDR, iter.id);
+		targets[count++] = (notify_target_t) {
+			.id = *iter.id,
+			.addr_count = conf_val_count(&addr),
+			.state = NOTIFY_DONE,
+			.ret = KNOT_ENOMASTER,
+		};
+	}
+	return count;
+}
+
+static knot_rrset_t *make_soa(const knot_dname_t *apex)
+{
+	static const uint8_t soa_rdata[] = {
+		0, 0,                      // MNAME, RNAME
+		0, 0, 0, 42,               // SERIAL
+		0, 0, 0x0e, 0x10,          // REFRESH
+		0, 0, 0x02, 0x58,          // RETRY
+		0, 0x01, 0x51, 0x80,       // EXPIRE
+		0, 0, 0x01, 0x2c,          // MINIMUM
+	};
+	knot_rrset_t *soa = knot_rrset_new(apex, KNOT_RRTYPE_SOA, KNOT_CLASS_IN, 3600, NULL);
+	knot_rrset_add_rdata(soa, soa_rdata, sizeof(soa_rdata), NULL);
+	return soa;
+}
+
+static void test_fanout(server_t *server)
+{
+	zone_t *zone = zone_new((const uint8_t *)"\x07""example");
+	zone->server = server;
+	knot_rrset_t *soa = make_soa(zone->name);
+
+	notify_target_t targets[MAX_TARGETS];
+	size_t count = make_targets(conf(), zone, targets);
+	is_int(5, count, "notify: all remotes prepared");
+
+	notify_fanout_t fanout = {
+		.conf = conf(),
+		.zone = zone,
+		.soa = soa,
+		.timeout = TIMEOUT_MS,
+		.begin = time_now(),
+	};
+	notify_fanout(&fanout, targets, count);
+
+	struct timespec end = time_now();
+	uint64_t elapsed = time_diff_ms(&fanout.begin, &end);
+
+	is_int(KNOT_ETIMEOUT, targets[0].ret, "notify: silent remote timed out");
+	is_int(KNOT_ETIMEOUT, targets[1].ret, "notify: another silent remote timed out");
+	is_int(KNOT_EOK, targets[2].ret, "notify: responding remote notified");
+	is_int(KNOT_EOK, targets[3].ret, "notify: next address used after timeout");
+	ok(targets[3].addr_idx == 1, "notify: timed out remote answered by its second address");
+	is_int(KNOT_EOK, targets[4].ret, "notify: next address used after refused connection");
+	ok(targets[4].addr_idx == 1, "notify: refused remote answered by its second address");
+
+	ok(elapsed >= TIMEOUT_MS, "notify: timeout applied (%"PRIu64" ms)", elapsed);
+	ok(elapsed < 2 * TIMEOUT_MS, "notify: remotes notified concurrently, "
+	   "timeout applied per remote (%"PRIu64" ms)", elapsed);
+
+	ok(atomic_load(&answered) == 3, "notify: responder got all the NOTIFYs");
+	uint64_t latencies = 0;
+	for (unsigned i = 0; i < SERVER_NOTIFY_LATENCY_BUCKETS; i++) {
+		latencies += ATOMIC_GET(server->stats.notify_latency[i]);
+	}
+	ok(latencies == 3, "notify: latencies of answered NOTIFYs counted");
+	ok(zone->timers.last_notified_serial == (42 | LAST_NOTIFIED_SERIAL_VALID),
+	   "notify: notified serial stored");
+
+	for (size_t i = 0; i < count; i++) {
+		ok(targets[i].req == NULL && targets[i].state == NOTIFY_DONE,
+		   "notify: remote %zu finished", i);
+	}
+
+	knot_rrset_free(soa, NULL);
+	zone_free(&zone);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	struct sockaddr_storage server_addr, silent_addr, refused_addr;
+	int server_fd = tcp_socket(&server_addr, true);
+	int silent_fd = tcp_socket(&silent_addr, true);
+	int refused_fd = tcp_socket(&refused_addr, false);
+	ok(server_fd >= 0 && silent_fd >= 0 && refused_fd >= 0, "bind sockets");
+
+	int ret = set_conf(&server_addr, &silent_addr, &refused_addr);
+	is_int(KNOT_EOK, ret, "load configuration");
+
+	pthread_t thread;
+	ret = pthread_create(&thread, NULL, responder_thread, &server_fd);
+	ok(ret == 0, "start responder");
+
+	server_t server = { 0 };
+	if (ret == 0) {
+		test_fanout(&server);
+
+		shutdown(server_fd, SHUT_RDWR);
+		pthread_join(thread, NULL);
+	}
+
+	test_conf_free();
+	close(server_fd);
+	close(silent_fd);
+	close(refused_fd);
+
+	return 0;
+}
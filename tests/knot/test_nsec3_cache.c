@@ -0,0 +1,53 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <string.h>
+#include <tap/basic.h>
+
+#include "knot/zone/nsec3_cache.h"
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	const knot_dname_t *name1 = (const knot_dname_t *)"\x03""www""\x07""example""\x00";
+	const knot_dname_t *name2 = (const knot_dname_t *)"\x04""mail""\x07""example""\x00";
+	const uint8_t hash1[20] = { 0x01, 0x02, 0x03 };
+	const uint8_t hash2[20] = { 0xfd, 0xfe, 0xff };
+	uint8_t buf[NSEC3_CACHE_MAX_HASH];
+
+	ok(nsec3_cache_new(0) == NULL, "no cache without slots");
+
+	nsec3_cache_t *cache = nsec3_cache_new(1);
+	ok(cache != NULL, "create cache");
+
+	size_t len = nsec3_cache_get(cache, name1, buf, sizeof(buf));
+	is_int(0, len, "miss in empty cache");
+
+	nsec3_cache_put(cache, name1, hash1, sizeof(hash1));
+	len = nsec3_cache_get(cache, name1, buf, sizeof(buf));
+	ok(len == sizeof(hash1) && memcmp(buf, hash1, len) == 0, "hit stored hash");
+
+	len = nsec3_cache_get(cache, name1, buf, sizeof(hash1) - 1);
+	is_int(0, len, "miss if hash doesn't fit");
+
+	len = nsec3_cache_get(cache, name2, buf, sizeof(buf));
+	is_int(0, len, "miss for different name");
+
+	nsec3_cache_put(cache, name2, hash2, sizeof(hash2));
+	len = nsec3_cache_get(cache, name2, buf, sizeof(buf));
+	ok(len == sizeof(hash2) && memcmp(buf, hash2, len) == 0, "hit colliding hash");
+
+	len = nsec3_cache_get(cache, name1, buf, sizeof(buf));
+	is_int(0, len, "colliding hash replaced previous one");
+
+	nsec3_cache_put(cache, name1, buf, NSEC3_CACHE_MAX_HASH + 1);
+	len = nsec3_cache_get(cache, name1, buf, sizeof(buf));
+	is_int(0, len, "too large hash not stored");
+
+	nsec3_cache_free(cache);
+
+	return 0;
+}
@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <netinet/in.h>
+#include <sys/socket.h>
+
 #include "test_conf.h"
 #include "knot/server/server.h"
 #include "knot/zone/adjust.h"
@@ -15,6 +18,22 @@
 #define EXAMPLE_DNAME ((const uint8_t *)"\x7""example")
 #define IDSERVER_DNAME ((const uint8_t *)"\2""id""\6""server")
 
+/* Create a UDP socket bound to a free loopback port. */
+static inline int udp_socket(struct sockaddr_storage *addr)
+{
+	struct sockaddr_in sin = {
+		.sin_family = AF_INET,
+		.sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+	};
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	socklen_t len = sizeof(*addr);
+	if (fd < 0 || bind(fd, (struct sockaddr *)&sin, sizeof(sin)) != 0 ||
+	    getsockname(fd, (struct sockaddr *)addr, &len) != 0) {
+		return -1;
+	}
+	return fd;
+}
+
 /* Create fake root zone. */
 static inline void create_root_zone(server_t *server, knot_mm_t *mm)
 {
@@ -0,0 +1,430 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "knot/events/handlers/refresh.c"
+#include "libknot/libknot.h"
+#include "contrib/net.h"
+#include "contrib/sockaddr.h"
+#include "test_conf.h"
+
+#define ZONES		100
+#define SOURCES		300	// More than the checker sockets.
+#define SERIAL		42
+#define TIMEOUT_MS	200
+
+#define MAX_PORTS	64
+
+static in_port_t ports[MAX_PORTS];
+static atomic_int nports;
+
+static const uint8_t soa_rdata[] = {
+	0, 0,                      // MNAME, RNAME
+	0, 0, 0, SERIAL,           // SERIAL
+	0, 0, 0x0e, 0x10,          // REFRESH
+	0, 0, 0x02, 0x58,          // RETRY
+	0, 0x01, 0x51, 0x80,       // EXPIRE
+	0, 0, 0x01, 0x2c,          // MINIMUM
+};
+
+/*!
+ * Answers SOA queries with a fixed serial, ignores the zones named "silent*".
+ */
+static void *responder_thread(void *arg)
+{
+	int fd = *(int *)arg;
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	uint8_t ans_buf[KNOT_WIRE_MAX_PKTSIZE];
+
+	while (true) {
+		struct sockaddr_storage from;
+		socklen_t from_len = sizeof(from);
+		ssize_t len = recvfrom(fd, buf, sizeof(buf), 0,
+		                       (struct sockaddr *)&from, &from_len);
+		if (len <= 1) {
+			break;
+		}
+
+		knot_pkt_t *query = knot_pkt_new(buf, len, NULL);
+		knot_pkt_t *ans = knot_pkt_new(ans_buf, sizeof(ans_buf), NULL);
+		if (knot_pkt_parse(query, 0) != KNOT_EOK ||
+		    memcmp(knot_pkt_qname(query) + 1, "silent", 6) == 0) {
+			knot_pkt_free(query);
+			knot_pkt_free(ans);
+			continue;
+		}
+
+		in_port_t port = ((struct sockaddr_in *)&from)->sin_port;
+		int known = atomic_load(&nports), i = 0;
+		while (i < known && ports[i] != port) {
+			i++;
+		}
+		if (i == known && known < MAX_PORTS) {
+			ports[known] = port;
+			atomic_store(&nports, known + 1);
+		}
+
+		knot_pkt_init_response(ans, query);
+		knot_pkt_begin(ans, KNOT_ANSWER);
+		knot_rrset_t *soa = knot_rrset_new(knot_pkt_qname(query),
+		                                   KNOT_RRTYPE_SOA, KNOT_CLASS_IN,
+		                                   3600, NULL);
+		knot_rrset_add_rdata(soa, soa_rdata, sizeof(soa_rdata), NULL);
+		knot_pkt_put(ans, 0, soa, 0);
+		(void)sendto(fd, ans->wire, ans->size, 0, (struct sockaddr *)&from, from_len);
+
+		knot_rrset_free(soa, NULL);
+		knot_pkt_free(query);
+		knot_pkt_free(ans);
+	}
+
+	return NULL;
+}
+
+static int bound_socket(struct sockaddr_storage *addr, const char *ip)
+{
+	sockaddr_set(addr, AF_INET, ip, 0);
+	int fd = net_bound_socket(SOCK_DGRAM, addr, 0, 0);
+	socklen_t addr_len = sockaddr_len(addr);
+	(void)getsockname(fd, (struct sockaddr *)addr, &addr_len);
+	return fd;
+}
+
+static soa_check_target_t make_target(const char *id, const struct sockaddr_storage *addr)
+{
+	soa_check_target_t target = { .id = id };
+	memcpy(&target.remote.addr, addr, sizeof(*addr));
+	target.edns.max_payload = 1232;
+	return target;
+}
+
+static zone_t *make_zone(const char *name)
+{
+	knot_dname_storage_t dname;
+	knot_dname_from_str(dname, name, sizeof(dname));
+	return zone_new(dname);
+}
+
+static zone_contents_t *make_contents(const knot_dname_t *apex, uint32_t serial)
+{
+	uint8_t rdata[sizeof(soa_rdata)];
+	memcpy(rdata, soa_rdata, sizeof(rdata));
+	knot_wire_write_u32(rdata + 2, serial); // After the root MNAME and RNAME.
+
+	knot_rrset_t soa;
+	knot_rrset_init(&soa, (knot_dname_t *)apex, KNOT_RRTYPE_SOA, KNOT_CLASS_IN, 3600);
+	knot_rrset_add_rdata(&soa, rdata, sizeof(rdata), NULL);
+
+	zone_contents_t *contents = zone_contents_new(apex, false);
+	zone_node_t *unused = NULL;
+	(void)zone_contents_add_rr(contents, &soa, &unused);
+	knot_rdataset_clear(&soa.rrs, NULL);
+
+	return contents;
+}
+
+/*!
+ * Wait for the result of the zone check, at most 5 seconds.
+ */
+static soa_check_result_t *wait_result(zone_t *zone)
+{
+	soa_check_result_t *result = NULL;
+	for (int i = 0; i < 500 && result == NULL; i++) {
+		result = soa_check_take(zone);
+		if (result == NULL) {
+			usleep(10000);
+		}
+	}
+	return result;
+}
+
+static bool answered_serial(const soa_check_result_t *result, const zone_t *zone)
+{
+	if (result == NULL || result->ret != KNOT_EOK || result->wire == NULL) {
+		return false;
+	}
+
+	knot_pkt_t *pkt = knot_pkt_new(result->wire, result->size, NULL);
+	bool ok = knot_pkt_parse(pkt, 0) == KNOT_EOK &&
+	          knot_dname_is_equal(knot_pkt_qname(pkt), zone->name) &&
+	          pkt->sections[KNOT_ANSWER].count == 1 &&
+	          knot_soa_serial(knot_pkt_rr(&pkt->sections[KNOT_ANSWER], 0)->rrs.rdata) == SERIAL;
+	knot_pkt_free(pkt);
+
+	return ok;
+}
+
+static void test_answered(soa_check_t *checker, const soa_check_target_t *target)
+{
+	zone_t *zones[ZONES];
+	int submitted = 0;
+	for (int i = 0; i < ZONES; i++) {
+		char name[32];
+		(void)snprintf(name, sizeof(name), "z%d.example.", i);
+		zones[i] = make_zone(name);
+		submitted += (soa_check_submit(checker, zones[i], target, 1, 2000) == KNOT_EOK);
+	}
+	ok(submitted == ZONES, "submit zones");
+
+	int answered = 0;
+	for (int i = 0; i < ZONES; i++) {
+		soa_check_result_t *result = wait_result(zones[i]);
+		answered += answered_serial(result, zones[i]);
+		soa_check_result_free(result);
+		zone_free(&zones[i]);
+	}
+	ok(answered == ZONES, "all zones answered with the remote serial");
+	ok(atomic_load(&nports) > ZONES / 20, "source ports of the queries vary");
+}
+
+static void test_sources(soa_check_t *checker, const struct sockaddr_storage *server)
+{
+	zone_t *zones[SOURCES];
+	int submitted = 0;
+	for (int i = 0; i < SOURCES; i++) {
+		char name[32];
+		(void)snprintf(name, sizeof(name), "s%d.example.", i);
+		zones[i] = make_zone(name);
+
+		char via[32];
+		(void)snprintf(via, sizeof(via), "127.1.%d.%d", i / 200, i % 200 + 1);
+		soa_check_target_t target = make_target("server", server);
+		sockaddr_set(&target.remote.via, AF_INET, via, 0);
+		submitted += (soa_check_submit(checker, zones[i], &target, 1, 2000) == KNOT_EOK);
+	}
+	ok(submitted == SOURCES, "submit zones from distinct sources");
+
+	int answered = 0;
+	for (int i = 0; i < SOURCES; i++) {
+		soa_check_result_t *result = wait_result(zones[i]);
+		answered += answered_serial(result, zones[i]);
+		soa_check_result_free(result);
+		zone_free(&zones[i]);
+	}
+	ok(answered == SOURCES, "sources beyond the socket limit wait for a free socket");
+}
+
+static int refresh_conf(const struct sockaddr_storage *server,
+                        const struct sockaddr_storage *second)
+{
+	char conf_str[512];
+	(void)snprintf(conf_str, sizeof(conf_str),
+		"server:\n"
+		"  refresh-inflight: 100\n"
+		"remote:\n"
+		"  - id: server\n"
+		"    address: 127.0.0.1@%1$d\n"
+		"  - id: second\n"
+		"    address: 127.0.0.2@%2$d\n"
+		"  - id: tls\n"
+		"    address: 127.0.0.1@%1$d\n"
+		"    tls: on\n"
+		"zone:\n"
+		"  - domain: refresh.example.\n"
+		"    master: [ server, second ]\n"
+		"  - domain: tls.example.\n"
+		"    master: tls\n",
+		sockaddr_port(server), sockaddr_port(second));
+
+	return test_conf(conf_str, NULL);
+}
+
+static void test_refresh(soa_check_t *checker, const struct sockaddr_storage *server_addr,
+                         const struct sockaddr_storage *second_addr)
+{
+	is_int(KNOT_EOK, refresh_conf(server_addr, second_addr), "refresh: load configuration");
+
+	server_t server = { .soa_check = checker };
+	zone_t *zone = make_zone("refresh.example.");
+	zone->server = &server;
+	try_refresh_ctx_t trctx = { 0 };
+
+	// zones and remotes not checked by the checker
+
+	is_int(KNOT_ENOTSUP, refresh_soa_check_start(conf(), zone, &trctx),
+	       "refresh: no check without zone contents");
+	zone->contents = make_contents(zone->name, SERIAL);
+
+	server.soa_check = NULL;
+	is_int(KNOT_ENOTSUP, refresh_soa_check_start(conf(), zone, &trctx),
+	       "refresh: no check without checker");
+	server.soa_check = checker;
+
+	trctx.force_axfr = true;
+	is_int(KNOT_ENOTSUP, refresh_soa_check_start(conf(), zone, &trctx),
+	       "refresh: no check if AXFR forced");
+	trctx.force_axfr = false;
+
+	zone_t *tls_zone = make_zone("tls.example.");
+	tls_zone->server = &server;
+	tls_zone->contents = make_contents(tls_zone->name, SERIAL);
+	is_int(KNOT_ENOTSUP, refresh_soa_check_start(conf(), tls_zone, &trctx),
+	       "refresh: no check of TLS remote");
+	zone_free(&tls_zone);
+
+	// the notifying remote is queried first
+
+	zone_set_preferred_master(zone, second_addr);
+	is_int(KNOT_EOK, refresh_soa_check_start(conf(), zone, &trctx),
+	       "refresh: check submitted");
+	is_int(KNOT_EEXIST, refresh_soa_check_start(conf(), zone, &trctx),
+	       "refresh: pending check not submitted again");
+	zone_clear_preferred_master(zone);
+	soa_check_result_t *result = wait_result(zone);
+	ok(answered_serial(result, zone) &&
+	   sockaddr_cmp(&result->remote, second_addr, false) == 0,
+	   "refresh: preferred remote queried first");
+	if (result == NULL) {
+		zone_free(&zone);
+		test_conf_free();
+		return;
+	}
+
+	// up-to-date zone
+
+	int ret = KNOT_ERROR;
+	ok(refresh_soa_check_finish(conf(), zone, result, &trctx, &ret) &&
+	   ret == KNOT_EOK && zone->timers.last_refresh_ok &&
+	   zone->timers.next_refresh > time(NULL), "refresh: up-to-date zone refreshed");
+
+	// outdated zone is transferred from the answering remote
+
+	zone_contents_deep_free(zone->contents);
+	zone->contents = make_contents(zone->name, SERIAL - 1);
+	ok(!refresh_soa_check_finish(conf(), zone, result, &trctx, &ret) &&
+	   trctx.checked_xfr == XFR_TYPE_IXFR &&
+	   sockaddr_cmp(&trctx.checked_remote, second_addr, false) == 0 &&
+	   zone->preferred_master != NULL &&
+	   sockaddr_cmp(zone->preferred_master, second_addr, false) == 0,
+	   "refresh: outdated zone transferred from the checked remote");
+	zone_clear_preferred_master(zone);
+	soa_check_result_free(result);
+
+	// truncated answer, the regular refresh follows
+
+	trctx = (try_refresh_ctx_t){ 0 };
+	soa_check_result_t truncated = { .fallback = true };
+	ok(!refresh_soa_check_finish(conf(), zone, &truncated, &trctx, &ret) &&
+	   trctx.checked_xfr == XFR_TYPE_UNDETERMINED,
+	   "refresh: truncated answer followed by regular refresh");
+
+	// no remote answered
+
+	soa_check_result_t failed = { .ret = KNOT_ENOMASTER };
+	ok(refresh_soa_check_finish(conf(), zone, &failed, &trctx, &ret) &&
+	   ret == KNOT_ENOMASTER, "refresh: failed check finishes the refresh");
+
+	zone_free(&zone);
+	test_conf_free();
+}
+
+int main(void)
+{
+	plan_lazy();
+
+	struct sockaddr_storage server, second, silent;
+	int server_fd = bound_socket(&server, "127.0.0.1");
+	int second_fd = bound_socket(&second, "127.0.0.2");
+	int silent_fd = bound_socket(&silent, "127.0.0.1");
+	ok(server_fd >= 0 && second_fd >= 0 && silent_fd >= 0, "bind responders");
+
+	pthread_t thread, second_thread;
+	pthread_create(&thread, NULL, responder_thread, &server_fd);
+	pthread_create(&second_thread, NULL, responder_thread, &second_fd);
+
+	soa_check_t *checker = soa_check_new(1000);
+	ok(checker != NULL, "create checker");
+
+	// many zones in flight at once
+
+	soa_check_target_t target = make_target("server", &server);
+	test_answered(checker, &target);
+
+	// queries beyond the limit wait for a free slot
+
+	soa_check_set_limit(checker, 1);
+	test_answered(checker, &target);
+	soa_check_set_limit(checker, 1000);
+
+	// more sources than sockets
+
+	test_sources(checker, &server);
+
+	// refresh event side
+
+	test_refresh(checker, &server, &second);
+
+	// silent remote times out, the next one answers
+
+	soa_check_target_t targets[] = {
+		make_target("silent", &silent),
+		make_target("server", &server),
+	};
+	zone_t *zone = make_zone("example.");
+	ok(soa_check_submit(checker, zone, targets, 2, TIMEOUT_MS) == KNOT_EOK,
+	   "submit with a silent remote first");
+	soa_check_result_t *result = wait_result(zone);
+	ok(answered_serial(result, zone) &&
+	   sockaddr_cmp(&result->remote, &server, false) == 0, "next remote answered");
+	soa_check_result_free(result);
+
+	// no remote answers
+
+	ok(soa_check_submit(checker, zone, targets, 1, TIMEOUT_MS) == KNOT_EOK,
+	   "submit with a silent remote only");
+	result = wait_result(zone);
+	ok(result != NULL && result->ret == KNOT_ENOMASTER && result->wire == NULL,
+	   "no usable remote");
+	soa_check_result_free(result);
+
+	// pending zone isn't submitted again
+
+	zone_t *silent_zone = make_zone("silent.example.");
+	ok(soa_check_submit(checker, silent_zone, &target, 1, 2000) == KNOT_EOK,
+	   "submit silent zone");
+	ok(soa_check_submit(checker, silent_zone, &target, 1, 2000) == KNOT_EEXIST,
+	   "pending zone not submitted again");
+
+	// canceled check never finishes
+
+	soa_check_cancel(checker, silent_zone);
+	ok(silent_zone->soa_check_item == NULL, "cancel check");
+	usleep(100000);
+	ok(soa_check_take(silent_zone) == NULL, "no result after cancel");
+
+	// pending checks are dropped with the checker
+
+	ok(soa_check_submit(checker, silent_zone, &target, 1, 2000) == KNOT_EOK,
+	   "submit silent zone again");
+	soa_check_free(checker);
+	ok(silent_zone->soa_check_item == NULL, "free checker with pending check");
+
+	zone_free(&zone);
+	zone_free(&silent_zone);
+
+	// stop the responders
+	struct sockaddr_storage client;
+	int client_fd = bound_socket(&client, "127.0.0.1");
+	(void)sendto(client_fd, "", 1, 0, (struct sockaddr *)&server, sockaddr_len(&server));
+	(void)sendto(client_fd, "", 1, 0, (struct sockaddr *)&second, sockaddr_len(&second));
+	pthread_join(thread, NULL);
+	pthread_join(second_thread, NULL);
+	close(client_fd);
+	close(server_fd);
+	close(second_fd);
+	close(silent_fd);
+
+	return 0;
+}
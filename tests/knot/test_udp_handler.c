@@ -0,0 +1,270 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+#include <tap/files.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "knot/server/udp-handler.c"
+#include "test_server.h"
+
+#if defined(ENABLE_RECVMMSG) && defined(ENABLE_UDP_SEGMENTATION)
+
+#define QUERIES	8
+
+/*! \brief Send equally sized messages as one GSO datagram. */
+static bool send_gso(int fd, const struct sockaddr_storage *to,
+                     uint8_t *data, size_t seg_size, unsigned count)
+{
+	cmsg_gso_buf_t cbuf = { 0 };
+	struct iovec iov = { .iov_base = data, .iov_len = seg_size * count };
+	struct msghdr msg = {
+		.msg_name = (void *)to,
+		.msg_namelen = sockaddr_len(to),
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = cbuf.buf,
+		.msg_controllen = CMSG_SPACE(sizeof(uint16_t)),
+	};
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = IPPROTO_UDP;
+	cmsg->cmsg_type = UDP_SEGMENT;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+	uint16_t size = seg_size;
+	memcpy(CMSG_DATA(cmsg), &size, sizeof(size));
+
+	return sendmsg(fd, &msg, 0) == iov.iov_len;
+}
+
+static void test_roundtrip(server_t *server)
+{
+	struct sockaddr_storage server_addr, client_addr;
+	int sfd = udp_socket(&server_addr);
+	int cfd = udp_socket(&client_addr);
+	int on = 1;
+	if (sfd < 0 || cfd < 0 ||
+	    setsockopt(sfd, IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) != 0) {
+		skip_block(7, "UDP GRO not available");
+		goto cleanup;
+	}
+
+	/* Prepare a batch of queries differing in the message ID. */
+	knot_pkt_t *query = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	knot_pkt_put_question(query, ROOT_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
+	uint8_t batch[QUERIES * KNOT_WIRE_MIN_PKTSIZE];
+	for (unsigned i = 0; i < QUERIES; i++) {
+		knot_wire_set_id(query->wire, i);
+		memcpy(batch + i * query->size, query->wire, query->size);
+	}
+	size_t qsize = query->size;
+	knot_pkt_free(query);
+
+	if (!send_gso(cfd, &server_addr, batch, qsize, QUERIES)) {
+		skip_block(7, "UDP GSO not available");
+		goto cleanup;
+	}
+
+	udp_context_t ctx = {
+		.server = server,
+		.bufsize = KNOT_WIRE_MIN_PKTSIZE,
+		.segmentation = true,
+	};
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+	knot_layer_init(&ctx.layer, &mm, process_query_layer());
+	iface_t iface = { .addr = server_addr };
+
+	udp_mmsg_ctx_t *rq = udp_mmsg_init(&ctx, NULL);
+	ok(rq != NULL, "udp: init context");
+
+	struct pollfd pfd = { .fd = sfd, .events = POLLIN };
+	(void)poll(&pfd, 1, 1000);
+	ok(udp_mmsg_recv(sfd, rq) == 1 &&
+	   rq->msgs[RX][0].msg_len == QUERIES * qsize &&
+	   udp_gro_segment_size(&rq->msgs[RX][0].msg_hdr) == qsize,
+	   "udp: queries received as one GRO datagram");
+
+	udp_mmsg_handle(&ctx, &iface, rq);
+	server_udp_stats_t *stats = &server->stats.udp[0];
+	ok(rq->rcvd == QUERIES && stats->gro_segments == QUERIES,
+	   "udp: GRO datagram split into queries");
+
+	udp_mmsg_send(rq);
+	ok(stats->gso_sends == 1 && stats->gso_segments == QUERIES,
+	   "udp: replies batched into one GSO send");
+
+	/* The client without GRO receives separate replies. */
+	unsigned replies = 0;
+	bool valid = true;
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	while (poll(&(struct pollfd){ .fd = cfd, .events = POLLIN }, 1, 1000) == 1) {
+		ssize_t len = recv(cfd, buf, sizeof(buf), 0);
+		if (len < KNOT_WIRE_HEADER_SIZE || !knot_wire_get_qr(buf) ||
+		    knot_wire_get_id(buf) != replies ||
+		    knot_wire_get_rcode(buf) != KNOT_RCODE_NOERROR) {
+			valid = false;
+		}
+		if (++replies == QUERIES) {
+			break;
+		}
+	}
+	ok(replies == QUERIES && valid, "udp: all replies received in order");
+
+	/* Queries up to the maximum message size fit the receive buffer. */
+	ok(rq->rx_bufsize == KNOT_WIRE_MAX_PKTSIZE &&
+	   rq->msgs[RX][0].msg_hdr.msg_iov->iov_len == KNOT_WIRE_MAX_PKTSIZE,
+	   "udp: receive buffers of the maximum message size");
+	ok(rq->tx_bufsize == KNOT_WIRE_MIN_PKTSIZE, "udp: reply buffers of the configured size");
+
+	udp_mmsg_deinit(rq);
+	mp_delete(mm.ctx);
+cleanup:
+	close(sfd);
+	close(cfd);
+}
+
+/*! \brief Prepare a reply of the given size to the given destination. */
+static void set_reply(udp_mmsg_ctx_t *rq, unsigned i, size_t len, unsigned dest)
+{
+	struct msghdr *tx = &rq->msgs[TX][i].msg_hdr;
+	tx->msg_iov->iov_len = len;
+	tx->msg_name = &rq->addrs[dest];
+	tx->msg_namelen = sizeof(struct sockaddr_in);
+	tx->msg_control = NULL;
+	tx->msg_controllen = 0;
+}
+
+static uint16_t gso_size(const struct msghdr *msg)
+{
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+	if (cmsg == NULL || cmsg->cmsg_level != IPPROTO_UDP ||
+	    cmsg->cmsg_type != UDP_SEGMENT) {
+		return 0;
+	}
+	uint16_t size;
+	memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+	return size;
+}
+
+static void test_coalesce(server_t *server)
+{
+	udp_context_t ctx = {
+		.server = server,
+		.bufsize = KNOT_WIRE_MIN_PKTSIZE,
+		.segmentation = true,
+	};
+	udp_mmsg_ctx_t *rq = udp_mmsg_init(&ctx, NULL);
+	server_udp_stats_t *stats = &server->stats.udp[0];
+	memset(stats, 0, sizeof(*stats));
+
+	sockaddr_set((struct sockaddr_storage *)&rq->addrs[0], AF_INET, "127.0.0.1", 53);
+	sockaddr_set((struct sockaddr_storage *)&rq->addrs[1], AF_INET, "127.0.0.2", 53);
+	sockaddr_set((struct sockaddr_storage *)&rq->addrs[2], AF_INET, "127.0.0.1", 53);
+
+	/* Equal replies, a shorter one ends the run. */
+	set_reply(rq, 0, 100, 0);
+	set_reply(rq, 1, 100, 0);
+	set_reply(rq, 2, 60, 0);
+	set_reply(rq, 3, 100, 0);
+	/* A different destination starts a new run, an equal address joins it. */
+	set_reply(rq, 4, 100, 1);
+	set_reply(rq, 5, 100, 1);
+	set_reply(rq, 6, 100, 2);
+	set_reply(rq, 7, 100, 0);
+	/* A longer reply can't join the run. */
+	set_reply(rq, 8, 200, 0);
+
+	unsigned n = udp_gso_coalesce(rq, 9);
+	struct msghdr *out[RECVMMSG_BATCHLEN];
+	for (unsigned i = 0; i < n; i++) {
+		out[i] = &rq->gso_msgs[i].msg_hdr;
+	}
+	ok(n == 5, "gso: number of sends");
+	ok(n == 5 && out[0]->msg_iovlen == 3 && gso_size(out[0]) == 100 &&
+	   out[0]->msg_iov == rq->msgs[TX][0].msg_hdr.msg_iov,
+	   "gso: shorter last segment");
+	ok(n == 5 && out[1]->msg_iovlen == 1 && gso_size(out[1]) == 0,
+	   "gso: run broken by a different destination");
+	ok(n == 5 && out[2]->msg_iovlen == 2 && gso_size(out[2]) == 100 &&
+	   out[2]->msg_name == &rq->addrs[1],
+	   "gso: run to another destination");
+	ok(n == 5 && out[3]->msg_iovlen == 2 && out[4]->msg_iovlen == 1 &&
+	   gso_size(out[4]) == 0,
+	   "gso: run broken by a longer reply");
+	ok(stats->gso_sends == 3 && stats->gso_segments == 7, "gso: counters");
+
+	/* Segment count limit. */
+	rq->gso_maxsegs = 2;
+	for (unsigned i = 0; i < RECVMMSG_BATCHLEN; i++) {
+		set_reply(rq, i, 100, 0);
+	}
+	n = udp_gso_coalesce(rq, RECVMMSG_BATCHLEN);
+	ok(n == RECVMMSG_BATCHLEN / 2 && rq->gso_msgs[0].msg_hdr.msg_iovlen == 2,
+	   "gso: segment limit");
+
+	/* Disabled segmentation sends each reply separately. */
+	rq->gso_maxsegs = 1;
+	n = udp_gso_coalesce(rq, RECVMMSG_BATCHLEN);
+	ok(n == RECVMMSG_BATCHLEN && gso_size(&rq->gso_msgs[0].msg_hdr) == 0,
+	   "gso: no segmentation");
+
+	udp_mmsg_deinit(rq);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+
+	char *temp_dir = test_mkdtemp();
+	ok(temp_dir != NULL, "make temporary directory");
+
+	server_t server;
+	int ret = create_fake_server(&server, &mm, temp_dir);
+	is_int(KNOT_EOK, ret, "fake server initialization");
+	if (ret != KNOT_EOK) {
+		goto fatal;
+	}
+
+	/* Counters of one UDP thread. */
+	ret = posix_memalign((void **)&server.stats.udp, 64, sizeof(*server.stats.udp));
+	ok(ret == 0, "allocate counters");
+	if (ret != 0) {
+		goto fatal;
+	}
+	memset(server.stats.udp, 0, sizeof(*server.stats.udp));
+	server.stats.udp_count = 1;
+
+	test_roundtrip(&server);
+	test_coalesce(&server);
+
+fatal:
+	server_deinit(&server);
+	conf_free(conf());
+
+	test_rm_rf(temp_dir);
+	free(temp_dir);
+	mp_delete(mm.ctx);
+
+	return 0;
+}
+
+#else
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	skip_all("UDP segmentation not supported");
+
+	return 0;
+}
+
+#endif
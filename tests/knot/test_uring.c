@@ -0,0 +1,275 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+#include <tap/files.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "knot/server/udp-handler.c"
+#include "knot/server/tcp-handler.c"
+#include "test_server.h"
+
+#if defined(ENABLE_IO_URING) && defined(ENABLE_RECVMMSG)
+
+#define QUERIES	4
+
+typedef struct {
+	server_t *server;
+	int fd;                  // Server socket.
+	iface_t iface;
+	int ret;                 // Result of the io_uring serving.
+} serve_ctx_t;
+
+static int tcp_listen_socket(struct sockaddr_storage *addr)
+{
+	struct sockaddr_in sin = {
+		.sin_family = AF_INET,
+		.sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+	};
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	socklen_t len = sizeof(*addr);
+	if (fd < 0 || bind(fd, (struct sockaddr *)&sin, sizeof(sin)) != 0 ||
+	    listen(fd, 16) != 0 ||
+	    getsockname(fd, (struct sockaddr *)addr, &len) != 0) {
+		return -1;
+	}
+	return fd;
+}
+
+static int udp_serve(dthread_t *thread)
+{
+	serve_ctx_t *ctx = thread->data;
+
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+	udp_context_t udp = {
+		.server = ctx->server,
+		.bufsize = KNOT_WIRE_MIN_PKTSIZE,
+	};
+	knot_layer_init(&udp.layer, &mm, process_query_layer());
+
+	fdset_t fds;
+	ctx->ret = fdset_init(&fds, 1);
+	if (ctx->ret == KNOT_EOK && fdset_add(&fds, ctx->fd, FDSET_POLLIN, &ctx->iface) >= 0) {
+		ctx->ret = udp_uring_serve(&udp, &fds, thread);
+	}
+
+	fdset_clear(&fds);
+	mp_delete(mm.ctx);
+
+	return KNOT_EOK;
+}
+
+static int tcp_serve(dthread_t *thread)
+{
+	serve_ctx_t *ctx = thread->data;
+
+	tcp_context_t tcp = {
+		.server = ctx->server,
+		.client_threshold = 1,
+	};
+	tcp.iov[1].iov_len = KNOT_WIRE_MAX_PKTSIZE;
+	tcp.iov[1].iov_base = malloc(tcp.iov[1].iov_len);
+	update_tcp_conf(&tcp);
+
+	ctx->ret = fdset_init(&tcp.set, FDSET_RESIZE_STEP);
+	if (ctx->ret == KNOT_EOK && tcp.iov[1].iov_base != NULL &&
+	    fdset_add(&tcp.set, ctx->fd, FDSET_POLLIN, &ctx->iface) >= 0) {
+		ctx->ret = tcp_uring_serve(&tcp, thread);
+	}
+
+	fdset_clear(&tcp.set);
+	free(tcp.iov[1].iov_base);
+
+	return KNOT_EOK;
+}
+
+/*! \brief Check if the serving failed due to an older kernel, polling is used then. */
+static bool unsupported(int ret)
+{
+	return ret == KNOT_ENOTSUP || ret == KNOT_EINVAL;
+}
+
+/*! \brief Run the serving in a thread, let the client do its part meanwhile. */
+static bool serve(serve_ctx_t *ctx, runnable_t run,
+                  bool (*client)(const struct sockaddr_storage *),
+                  const struct sockaddr_storage *addr)
+{
+	dt_unit_t *unit = dt_create(1, run, NULL, ctx);
+	if (unit == NULL || dt_start(unit) != KNOT_EOK) {
+		dt_delete(&unit);
+		ctx->ret = KNOT_ERROR;
+		return false;
+	}
+
+	bool valid = client(addr);
+
+	dt_stop(unit);
+	dt_join(unit);
+	dt_delete(&unit);
+
+	return valid;
+}
+
+static size_t make_query(uint8_t *buf, uint16_t id)
+{
+	knot_pkt_t *query = knot_pkt_new(buf, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	knot_wire_set_id(query->wire, id);
+	knot_pkt_put_question(query, ROOT_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
+	size_t size = query->size;
+	knot_pkt_free(query);
+	return size;
+}
+
+static bool valid_reply(const uint8_t *buf, ssize_t len, uint16_t id)
+{
+	return len > KNOT_WIRE_HEADER_SIZE && knot_wire_get_qr(buf) &&
+	       knot_wire_get_id(buf) == id &&
+	       knot_wire_get_rcode(buf) == KNOT_RCODE_NOERROR &&
+	       knot_wire_get_ancount(buf) == 1;
+}
+
+static bool udp_client(const struct sockaddr_storage *server_addr)
+{
+	struct sockaddr_storage addr;
+	int fd = udp_socket(&addr);
+	if (fd < 0) {
+		return false;
+	}
+
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	bool valid = true;
+	for (uint16_t id = 0; id < QUERIES && valid; id++) {
+		size_t len = make_query(buf, id);
+		valid = sendto(fd, buf, len, 0, (struct sockaddr *)server_addr,
+		               sockaddr_len(server_addr)) == (ssize_t)len &&
+		        poll(&(struct pollfd){ .fd = fd, .events = POLLIN }, 1, 2000) == 1 &&
+		        valid_reply(buf, recv(fd, buf, sizeof(buf), 0), id);
+	}
+	close(fd);
+
+	return valid;
+}
+
+static bool tcp_client(const struct sockaddr_storage *server_addr)
+{
+	int fd = net_connected_socket(SOCK_STREAM, server_addr, NULL, false);
+	if (fd < 0) {
+		return false;
+	}
+
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	bool valid = true;
+	for (uint16_t id = 0; id < QUERIES && valid; id++) {
+		size_t len = make_query(buf, id);
+		valid = net_dns_tcp_send(fd, buf, len, 2000, NULL) == (ssize_t)len &&
+		        valid_reply(buf, net_dns_tcp_recv(fd, buf, sizeof(buf), 2000), id);
+	}
+	close(fd);
+
+	return valid;
+}
+
+static void test_udp(server_t *server)
+{
+	serve_ctx_t ctx = { .server = server };
+	ctx.fd = udp_socket(&ctx.iface.addr);
+	if (ctx.fd < 0) {
+		skip_block(2, "no loopback UDP socket");
+		return;
+	}
+
+	bool valid = serve(&ctx, udp_serve, udp_client, &ctx.iface.addr);
+	if (unsupported(ctx.ret)) {
+		skip_block(2, "io_uring features not supported (%s)", knot_strerror(ctx.ret));
+	} else {
+		ok(ctx.ret == KNOT_EOK, "UDP: served by io_uring");
+		ok(valid && server->stats.udp[0].recv_msgs == QUERIES,
+		   "UDP: queries answered");
+	}
+	close(ctx.fd);
+}
+
+static void test_tcp(server_t *server)
+{
+	serve_ctx_t ctx = { .server = server };
+	ctx.fd = tcp_listen_socket(&ctx.iface.addr);
+	if (ctx.fd < 0) {
+		skip_block(2, "no loopback TCP socket");
+		return;
+	}
+
+	bool valid = serve(&ctx, tcp_serve, tcp_client, &ctx.iface.addr);
+	if (unsupported(ctx.ret)) {
+		skip_block(2, "io_uring features not supported (%s)", knot_strerror(ctx.ret));
+	} else {
+		ok(ctx.ret == KNOT_EOK, "TCP: served by io_uring");
+		ok(valid, "TCP: queries answered");
+	}
+	close(ctx.fd);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	uring_t ring;
+	if (uring_init(&ring, 1, 0, 0) != KNOT_EOK) {
+		skip_all("io_uring not available");
+		return 0;
+	}
+	uring_deinit(&ring);
+
+	knot_mm_t mm;
+	mm_ctx_mempool(&mm, MM_DEFAULT_BLKSIZE);
+
+	char *temp_dir = test_mkdtemp();
+	ok(temp_dir != NULL, "make temporary directory");
+
+	server_t server;
+	int ret = create_fake_server(&server, &mm, temp_dir);
+	is_int(KNOT_EOK, ret, "fake server initialization");
+	if (ret != KNOT_EOK) {
+		goto fatal;
+	}
+
+	/* Counters of one UDP thread. */
+	ret = posix_memalign((void **)&server.stats.udp, 64, sizeof(*server.stats.udp));
+	ok(ret == 0, "allocate counters");
+	if (ret != 0) {
+		goto fatal;
+	}
+	memset(server.stats.udp, 0, sizeof(*server.stats.udp));
+	server.stats.udp_count = 1;
+
+	test_udp(&server);
+	test_tcp(&server);
+
+fatal:
+	server_deinit(&server);
+	conf_free(conf());
+
+	test_rm_rf(temp_dir);
+	free(temp_dir);
+	mp_delete(mm.ctx);
+
+	return 0;
+}
+
+#else
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	skip_all("io_uring not supported");
+
+	return 0;
+}
+
+#endif
@@ -9,10 +9,13 @@
 #include <pthread.h>
 #include <sched.h>
 #include <signal.h>
+#include <stdbool.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "knot/worker/pool.h"
 #include "knot/worker/queue.h"
+#include "libknot/errcode.h"
 
 #define THREADS 4
 #define TASKS_BATCH 40
@@ -50,10 +53,99 @@ static void task_counting(worker_task_t *task)
 	pthread_mutex_unlock(&log->mx);
 }
 
+/*!
+ * Ordering task, records its priority class into the order log.
+ */
+typedef struct {
+	worker_prio_t order[2 * TASKS_BATCH];
+	unsigned count;
+} order_log_t;
+
+static order_log_t order_log;
+
+static void task_high(worker_task_t *task)
+{
+	order_log.order[order_log.count++] = WORKER_PRIO_HIGH;
+}
+
+static void task_normal(worker_task_t *task)
+{
+	order_log.order[order_log.count++] = WORKER_PRIO_NORMAL;
+}
+
+/*!
+ * Task assigning more tasks to its own worker queue and waiting for them
+ * to be stolen and executed by the other workers.
+ */
+typedef struct {
+	worker_pool_t *pool;
+	worker_task_t *task;
+	bool stolen;
+} steal_ctx_t;
+
+static void task_spawning(worker_task_t *task)
+{
+	steal_ctx_t *ctx = task->ctx;
+	task_log_t *log = ctx->task->ctx;
+
+	for (int i = 0; i < TASKS_BATCH; i++) {
+		worker_pool_assign(ctx->pool, ctx->task, WORKER_PRIO_NORMAL);
+	}
+
+	for (int i = 0; i < 1000 && !ctx->stolen; i++) {
+		pthread_mutex_lock(&log->mx);
+		ctx->stolen = (log->executed == TASKS_BATCH);
+		pthread_mutex_unlock(&log->mx);
+		usleep(10000);
+	}
+}
+
 static void interrupt_handle(int s)
 {
 }
 
+static void test_priority(void)
+{
+	worker_pool_t *pool = worker_pool_create(1);
+	if (pool == NULL) {
+		ok(0, "create single thread pool");
+		return;
+	}
+
+	worker_task_t high = { .run = task_high };
+	worker_task_t normal = { .run = task_normal };
+	for (int i = 0; i < TASKS_BATCH; i++) {
+		worker_pool_assign(pool, &normal, WORKER_PRIO_NORMAL);
+		worker_pool_assign(pool, &high, WORKER_PRIO_HIGH);
+	}
+
+	worker_pool_start(pool);
+	worker_pool_wait(pool);
+
+	bool ordered = (order_log.count == 2 * TASKS_BATCH);
+	for (unsigned i = 0; i < order_log.count; i++) {
+		worker_prio_t expected = (i < TASKS_BATCH) ? WORKER_PRIO_HIGH : WORKER_PRIO_NORMAL;
+		ordered = ordered && (order_log.order[i] == expected);
+	}
+	ok(ordered, "high priority tasks executed first");
+
+	uint64_t hist[WORKER_WAIT_BUCKETS];
+	bool counted = true;
+	for (worker_prio_t prio = 0; prio < WORKER_PRIO_COUNT; prio++) {
+		worker_pool_wait_hist(pool, prio, hist);
+		uint64_t sum = 0;
+		for (unsigned i = 0; i < WORKER_WAIT_BUCKETS; i++) {
+			sum += hist[i];
+		}
+		counted = counted && (sum == TASKS_BATCH);
+	}
+	ok(counted, "queue wait histograms");
+
+	worker_pool_stop(pool);
+	worker_pool_join(pool);
+	worker_pool_destroy(pool);
+}
+
 int main(void)
 {
 	plan_lazy();
@@ -79,9 +171,13 @@ int main(void)
 	// schedule jobs while pool is stopped
 
 	worker_task_t task = { .run = task_counting, .ctx = &log };
-	for (int i = 0; i < TASKS_BATCH; i++) {
-		worker_pool_assign(pool, &task);
+	int ret = KNOT_EOK;
+	for (int i = 0; i < TASKS_BATCH && ret == KNOT_EOK; i++) {
+		ret = worker_pool_assign(pool, &task, WORKER_PRIO_NORMAL);
 	}
+	is_int(KNOT_EOK, ret, "assign tasks");
+	is_int(KNOT_EINVAL, worker_pool_assign(pool, &task, WORKER_PRIO_COUNT),
+	       "assign task with invalid priority");
 
 	sched_yield();
 	ok(executed_reset(&log) == 0, "executed count before start");
@@ -95,7 +191,7 @@ int main(void)
 	// add additional jobs while pool is running
 
 	for (int i = 0; i < TASKS_BATCH; i++) {
-		worker_pool_assign(pool, &task);
+		worker_pool_assign(pool, &task, WORKER_PRIO_NORMAL);
 	}
 
 	worker_pool_wait(pool);
@@ -106,7 +202,7 @@ int main(void)
 	worker_pool_suspend(pool);
 
 	for (int i = 0; i < TASKS_BATCH; i++) {
-		worker_pool_assign(pool, &task);
+		worker_pool_assign(pool, &task, WORKER_PRIO_NORMAL);
 	}
 
 	sched_yield();
@@ -116,11 +212,19 @@ int main(void)
 	worker_pool_wait(pool);
 	ok(executed_reset(&log) == TASKS_BATCH, "executed count after resume");
 
+	// work stealing from a blocked worker
+
+	steal_ctx_t steal = { .pool = pool, .task = &task };
+	worker_task_t spawning = { .run = task_spawning, .ctx = &steal };
+	worker_pool_assign(pool, &spawning, WORKER_PRIO_NORMAL);
+	worker_pool_wait(pool);
+	ok(steal.stolen && executed_reset(&log) == TASKS_BATCH, "executed count after steal");
+
 	// try clean
 
 	pthread_mutex_lock(&log.mx);
 	for (int i = 0; i < THREADS + TASKS_BATCH; i++) {
-		worker_pool_assign(pool, &task);
+		worker_pool_assign(pool, &task, WORKER_PRIO_NORMAL);
 	}
 	sched_yield();
 	worker_pool_clear(pool);
@@ -137,5 +241,9 @@ int main(void)
 
 	pthread_mutex_destroy(&log.mx);
 
+	// priority classes
+
+	test_priority();
+
 	return 0;
 }
@@ -30,9 +30,9 @@ int main(void)
 
 	// dequeue
 
-	ok(worker_queue_dequeue(&queue) == &task_one, "dequeue first");
-	ok(worker_queue_dequeue(&queue) == &task_two, "dequeue second");
-	ok(worker_queue_dequeue(&queue) == NULL, "dequeue from empty");
+	ok(worker_queue_dequeue(&queue, NULL) == &task_one, "dequeue first");
+	ok(worker_queue_dequeue(&queue, NULL) == &task_two, "dequeue second");
+	ok(worker_queue_dequeue(&queue, NULL) == NULL, "dequeue from empty");
 
 	// deinit
 
@@ -0,0 +1,163 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <tap/basic.h>
+#include <tap/files.h>
+
+#include "knot/zone/snapshot.h"
+#include "contrib/string.h"
+#include "libknot/libknot.h"
+
+static const knot_dname_t *apex = (const knot_dname_t *)"\x07""example""\x00";
+static const knot_dname_t *www = (const knot_dname_t *)"\x03""www""\x07""example""\x00";
+
+static void add_rr(zone_contents_t *contents, const knot_dname_t *owner,
+                   uint16_t type, uint32_t ttl, const void *rdata, uint16_t len)
+{
+	knot_rrset_t rr;
+	knot_rrset_init(&rr, (knot_dname_t *)owner, type, KNOT_CLASS_IN, ttl);
+	knot_rrset_add_rdata(&rr, rdata, len, NULL);
+	zone_node_t *unused = NULL;
+	zone_contents_add_rr(contents, &rr, &unused);
+	knot_rdataset_clear(&rr.rrs, NULL);
+}
+
+static zone_contents_t *create_contents(void)
+{
+	zone_contents_t *contents = zone_contents_new(apex, true);
+
+	const uint8_t soa[] = "\x02ns\x07""example\x00\x05""admin\x07""example\x00"
+	                      "\x00\x00\x00\x01\x00\x00\x0e\x10\x00\x00\x02\x58"
+	                      "\x00\x01\x51\x80\x00\x00\x01\x2c";
+	add_rr(contents, apex, KNOT_RRTYPE_SOA, 3600, soa, sizeof(soa) - 1);
+	add_rr(contents, apex, KNOT_RRTYPE_NS, 3600, "\x02ns\x07""example\x00", 12);
+	add_rr(contents, www, KNOT_RRTYPE_A, 300, "\xc0\x00\x02\x01", 4);
+	add_rr(contents, www, KNOT_RRTYPE_A, 300, "\xc0\x00\x02\x02", 4);
+	add_rr(contents, www, KNOT_RRTYPE_TXT, 60, "\x04odd", 4);
+	add_rr(contents, www, KNOT_RRTYPE_TXT, 60, "\x05""even!", 6);
+
+	return contents;
+}
+
+static bool node_equal(zone_node_t *node, zone_contents_t *other)
+{
+	const zone_node_t *other_node = zone_contents_find_node(other, node->owner);
+	if (other_node == NULL || other_node->rrset_count != node->rrset_count) {
+		return false;
+	}
+
+	for (uint16_t i = 0; i < node->rrset_count; i++) {
+		knot_rrset_t rrset = node_rrset_at(node, i);
+		knot_rrset_t other_rrset = node_rrset(other_node, rrset.type);
+		if (!knot_rrset_equal(&rrset, &other_rrset, true)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int node_cmp_cb(zone_node_t *node, void *data)
+{
+	return node_equal(node, data) ? KNOT_EOK : KNOT_ENORECORD;
+}
+
+static bool contents_equal(zone_contents_t *a, zone_contents_t *b)
+{
+	return zone_tree_count(a->nodes) == zone_tree_count(b->nodes) &&
+	       zone_tree_apply(a->nodes, node_cmp_cb, b) == KNOT_EOK;
+}
+
+static void corrupt_byte(const char *path, off_t offset)
+{
+	int fd = open(path, O_RDWR);
+	uint8_t byte;
+	if (pread(fd, &byte, 1, offset) == 1) {
+		byte ^= 0xff;
+		(void)pwrite(fd, &byte, 1, offset);
+	}
+	close(fd);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	char *tmp_dir = test_mkdtemp();
+	ok(tmp_dir != NULL, "create temporary directory");
+
+	char *zonefile = sprintf_alloc("%s/example.zone", tmp_dir);
+	char *path = zone_snapshot_path(zonefile);
+	ok(path != NULL && strcmp(path + strlen(path) - strlen(ZONE_SNAPSHOT_SUFFIX),
+	                          ZONE_SNAPSHOT_SUFFIX) == 0, "snapshot path");
+
+	FILE *file = fopen(zonefile, "w");
+	fprintf(file, "; placeholder\n");
+	fclose(file);
+
+	zone_contents_t *contents = create_contents();
+	zone_contents_t *loaded = NULL;
+
+	int ret = zone_snapshot_load(path, apex, zonefile, NULL, &loaded);
+	is_int(KNOT_ENOENT, ret, "load missing snapshot");
+	ok(!zone_snapshot_probe(zonefile), "zone file not probed as snapshot");
+
+	ret = zone_snapshot_write(path, contents, NULL, zonefile);
+	is_int(KNOT_EOK, ret, "write snapshot");
+	ok(zone_snapshot_probe(path), "probe snapshot");
+
+	ret = zone_snapshot_load(path, apex, zonefile, NULL, &loaded);
+	is_int(KNOT_EOK, ret, "load snapshot");
+	ok(loaded != NULL && contents_equal(contents, loaded), "loaded contents match");
+	zone_contents_deep_free(loaded);
+	loaded = NULL;
+
+	ret = zone_snapshot_load(path, www, NULL, NULL, &loaded);
+	is_int(KNOT_EMALF, ret, "refuse different origin");
+
+	// Omitted types.
+	zone_skip_t skip = { 0 };
+	zone_skip_add(&skip, "TXT");
+	ret = zone_snapshot_load(path, NULL, NULL, &skip, &loaded);
+	is_int(KNOT_EOK, ret, "load snapshot with omitted type");
+	const zone_node_t *node = (loaded != NULL) ? zone_contents_find_node(loaded, www) : NULL;
+	ok(node != NULL && node_rdataset(node, KNOT_RRTYPE_TXT) == NULL &&
+	   node_rdataset(node, KNOT_RRTYPE_A) != NULL, "omitted type not loaded");
+	zone_contents_deep_free(loaded);
+	loaded = NULL;
+	zone_skip_free(&skip);
+
+	// Zone file changed.
+	file = fopen(zonefile, "a");
+	fprintf(file, "; changed\n");
+	fclose(file);
+	ret = zone_snapshot_load(path, apex, zonefile, NULL, &loaded);
+	is_int(KNOT_ENOENT, ret, "ignore outdated snapshot");
+	ret = zone_snapshot_load(path, apex, NULL, NULL, &loaded);
+	is_int(KNOT_EOK, ret, "load snapshot without zone file check");
+	zone_contents_deep_free(loaded);
+	loaded = NULL;
+
+	// Damaged snapshot.
+	struct stat st;
+	stat(path, &st);
+	corrupt_byte(path, st.st_size - 1);
+	ret = zone_snapshot_load(path, apex, NULL, NULL, &loaded);
+	is_int(KNOT_EMALF, ret, "refuse damaged snapshot");
+	ok(loaded == NULL, "no contents from damaged snapshot");
+
+	zone_contents_deep_free(contents);
+	free(path);
+	free(zonefile);
+	test_rm_rf(tmp_dir);
+	free(tmp_dir);
+
+	return 0;
+}
@@ -84,6 +84,32 @@ int main(int argc, char *argv[])
 	}
 	ok(nr_passed == ZONE_COUNT, "zonedb: find zones for subnames");
 
+	/* Copy-on-write update. */
+	knot_dname_t *com = knot_dname_from_str_alloc("com");
+	knot_dname_t *org = knot_dname_from_str_alloc("org");
+	zone_t *org_zone = zone_new(org);
+	knot_zonedb_t *db_new = knot_zonedb_cow(db);
+	ok(db_new != NULL, "zonedb: copy-on-write");
+	ok(knot_zonedb_del(db_new, com) == KNOT_EOK &&
+	   knot_zonedb_insert(db_new, org_zone) == KNOT_EOK, "zonedb: update copy");
+	ok(knot_zonedb_find(db_new, com) == NULL &&
+	   knot_zonedb_find(db_new, org) == org_zone &&
+	   knot_zonedb_size(db_new) == ZONE_COUNT, "zonedb: copy updated");
+	ok(knot_zonedb_find(db, com) == zones[1] &&
+	   knot_zonedb_find(db, org) == NULL &&
+	   knot_zonedb_size(db) == ZONE_COUNT, "zonedb: original unchanged");
+	knot_zonedb_cow_commit(db_new, &db);
+	ok(db == NULL, "zonedb: original freed after commit");
+	db = db_new;
+	ok(knot_zonedb_find(db, org) == org_zone &&
+	   knot_zonedb_find(db, com) == NULL &&
+	   knot_zonedb_size(db) == ZONE_COUNT, "zonedb: commit");
+	ok(knot_zonedb_del(db, org) == KNOT_EOK &&
+	   knot_zonedb_insert(db, zones[1]) == KNOT_EOK, "zonedb: update after commit");
+	zone_free(&org_zone);
+	knot_dname_free(org, NULL);
+	knot_dname_free(com, NULL);
+
 	/* Remove all zones. */
 	nr_passed = 0;
 	for (unsigned i = 0; i < ZONE_COUNT; ++i) {
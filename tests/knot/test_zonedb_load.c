@@ -0,0 +1,147 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+#include <tap/files.h>
+
+#include "knot/conf/confio.h"
+#include "knot/server/server.h"
+#include "knot/zone/zonedb-load.h"
+#include "test_conf.h"
+
+#define FORW	"a.test."
+#define REV	"0.10.in-addr.arpa."
+
+static zone_t *find(server_t *server, const char *name)
+{
+	knot_dname_storage_t dname;
+	if (knot_dname_from_str(dname, name, sizeof(dname)) == NULL) {
+		return NULL;
+	}
+	return knot_zonedb_find(server->zone_db, dname);
+}
+
+static size_t list_count(list_t *list, void *data)
+{
+	size_t count = 0;
+	ptrnode_t *n;
+	WALK_LIST(n, *list) {
+		count += (n->d == data);
+	}
+	return count;
+}
+
+/*! \brief Check that the reverse zone is linked with the forward zone only. */
+static bool linked(zone_t *rev, zone_t *forw)
+{
+	return list_size(&rev->reverse_from) == 1 &&
+	       list_count(&rev->reverse_from, forw) == 1 &&
+	       list_count(&forw->internal_notify, rev) == 1;
+}
+
+/*! \brief Commit the configuration transaction and update the zones as a server reload. */
+static void commit(server_t *server)
+{
+	(void)conf_io_commit(false);
+	zonedb_reload(conf(), server, RELOAD_COMMIT);
+
+	conf()->io.flags = YP_FNONE;
+	if (conf()->io.zones != NULL) {
+		trie_clear(conf()->io.zones);
+	}
+}
+
+static void test_reverse(server_t *server)
+{
+	zone_t *rev = find(server, REV);
+	ok(rev != NULL && find(server, FORW) == NULL &&
+	   EMPTY_LIST(rev->reverse_from), "reverse: zone to reverse missing");
+
+	/* Add the zone to reverse, the reverse zone is reused. */
+	(void)conf_io_begin(false);
+	(void)conf_io_set("zone", "domain", NULL, FORW);
+	commit(server);
+	zone_t *forw = find(server, FORW);
+	ok(forw != NULL && find(server, REV) == rev && linked(rev, forw),
+	   "reverse: added zone linked to reused reverse zone");
+
+	/* Replace the zone to reverse. */
+	(void)conf_io_begin(false);
+	(void)conf_io_set("zone", "file", FORW, "a.zone");
+	commit(server);
+	zone_t *forw2 = find(server, FORW);
+	ok(forw2 != NULL && forw2 != forw && find(server, REV) == rev &&
+	   linked(rev, forw2), "reverse: replaced zone relinked");
+
+	/* Remove the zone to reverse. */
+	(void)conf_io_begin(false);
+	(void)conf_io_unset("zone", NULL, FORW, NULL);
+	commit(server);
+	ok(find(server, FORW) == NULL && find(server, REV) == rev &&
+	   EMPTY_LIST(rev->reverse_from), "reverse: removed zone unlinked");
+
+	/* Add the zone to reverse again. */
+	(void)conf_io_begin(false);
+	(void)conf_io_set("zone", "domain", NULL, FORW);
+	commit(server);
+	forw = find(server, FORW);
+	ok(forw != NULL && find(server, REV) == rev && linked(rev, forw),
+	   "reverse: re-added zone linked");
+	ok(trie_weight(server->reverse_pending) == 0, "reverse: nothing pending");
+
+	/* Replace the reverse zone. */
+	(void)conf_io_begin(false);
+	(void)conf_io_set("zone", "file", REV, "rev.zone");
+	commit(server);
+	zone_t *rev2 = find(server, REV);
+	ok(rev2 != NULL && rev2 != rev && find(server, FORW) == forw &&
+	   linked(rev2, forw) && list_count(&forw->internal_notify, rev) == 0,
+	   "reverse: replaced reverse zone relinked");
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	char *temp_dir = test_mkdtemp();
+	ok(temp_dir != NULL, "make temporary directory");
+
+	char conf_str[4096 + 512];
+	(void)snprintf(conf_str, sizeof(conf_str),
+		"database:\n"
+		"    storage: %s\n"
+		"template:\n"
+		"  - id: default\n"
+		"    storage: %s\n"
+		"zone:\n"
+		"  - domain: " REV "\n"
+		"    reverse-generate: " FORW "\n"
+		"  - domain: b.test.\n",
+		temp_dir, temp_dir);
+	int ret = test_conf(conf_str, NULL);
+	is_int(KNOT_EOK, ret, "load configuration");
+
+	server_t server;
+	ret = server_init(&server, 1);
+	is_int(KNOT_EOK, ret, "server initialization");
+	if (ret != KNOT_EOK) {
+		goto fatal;
+	}
+
+	zonedb_reload(conf(), &server, RELOAD_FULL);
+	ok(server.zone_db != NULL && knot_zonedb_size(server.zone_db) == 2,
+	   "initial zone database");
+
+	test_reverse(&server);
+
+	server_deinit(&server);
+fatal:
+	conf_free(conf());
+
+	test_rm_rf(temp_dir);
+	free(temp_dir);
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+#include <tap/files.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "knot/zone/zone-dump.h"
+#include "knot/zone/zonefile.h"
+#include "libknot/libknot.h"
+
+#define ORIGIN		((const uint8_t *)"\x07""example")
+#define RECORDS		4000
+#define CHUNK_MIN	4096
+#define THREADS		4
+
+/*!
+ * Write a zone file with directives, comments, quoted strings, multi-line
+ * records, owner-less records, and nodes and rrsets spread over the file.
+ */
+static bool write_zone(const char *path)
+{
+	FILE *f = fopen(path, "w");
+	if (f == NULL) {
+		return false;
+	}
+
+	fprintf(f, "$ORIGIN example.\n"
+	           "$TTL 3600\n"
+	           "@ SOA ns admin (\n"
+	           "      1     ; serial\n"
+	           "      3600 600 86400 300 )\n"
+	           "@ NS ns\n"
+	           "ns A 192.0.2.1\n");
+
+	for (int i = 0; i < RECORDS; i++) {
+		switch (i % 8) {
+		case 0:
+			fprintf(f, "a%d A 192.0.2.%d\n", i, i % 256);
+			break;
+		case 1:
+			fprintf(f, "b%d TXT \"quoted ; ( %d\" ; comment (\n", i, i);
+			break;
+		case 2:
+			fprintf(f, "c%d MX ( 10 ; comment )\n"
+			           "          mail%d ) ; multi-line\n", i, i);
+			break;
+		case 3:
+			fprintf(f, "$TTL %d\n"
+			           "d%d AAAA 2001:db8::%x\n", 60 + i, i, i);
+			break;
+		case 4:
+			fprintf(f, "$ORIGIN sub%d.example.\n"
+			           "e A 192.0.2.3\n"
+			           "  AAAA 2001:db8::1\n"
+			           "$ORIGIN example.\n", i);
+			break;
+		case 5:
+			fprintf(f, "dup 300 TXT \"part %d\"\n", i);
+			break;
+		case 6:
+			fprintf(f, "%032d.example. 300 NSEC3 1 0 0 - %032d A\n", i, i + 1);
+			break;
+		default:
+			fprintf(f, "f%d.dup 300 A 192.0.2.%d\n", i, i % 256);
+			break;
+		}
+	}
+
+	return fclose(f) == 0;
+}
+
+static size_t split_count(const char *path)
+{
+	zs_scanner_t s;
+	zs_chunk_t chunks[THREADS];
+	size_t count = THREADS;
+	if (zs_init(&s, "example.", KNOT_CLASS_IN, 3600) != 0 ||
+	    zs_set_input_file(&s, path) != 0 ||
+	    zs_split_input(&s, chunks, &count) != 0) {
+		count = 0;
+	}
+	zs_deinit(&s);
+
+	return count;
+}
+
+/*! \brief Load the zone file and dump the contents in the canonical order. */
+static char *load_dump(const char *path, uint16_t threads, size_t chunk_min)
+{
+	zloader_t zl;
+	if (zonefile_open(&zl, path, ORIGIN, 3600, SEMCHECK_MANDATORY_ONLY,
+	                  time(NULL)) != KNOT_EOK) {
+		return NULL;
+	}
+
+	sem_handler_t handler = { .cb = err_handler_logger };
+	zl.err_handler = &handler;
+	zl.chunk_min = chunk_min;
+
+	zone_contents_t *contents = zonefile_load(&zl, threads);
+	zonefile_close(&zl);
+	if (contents == NULL) {
+		return NULL;
+	}
+
+	char *dump = NULL;
+	size_t size = 0;
+	FILE *f = open_memstream(&dump, &size);
+	if (f != NULL) {
+		(void)zone_dump_text(contents, NULL, f, false, NULL);
+		fclose(f);
+	}
+	zone_contents_deep_free(contents);
+
+	return dump;
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	char *temp_dir = test_mkdtemp();
+	ok(temp_dir != NULL, "make temporary directory");
+
+	char path[4096 + 32];
+	(void)snprintf(path, sizeof(path), "%s/example.zone", temp_dir);
+	ok(write_zone(path), "write zone file");
+	ok(split_count(path) == THREADS, "zone file can be split");
+
+	char *serial = load_dump(path, 1, CHUNK_MIN);
+	ok(serial != NULL && strstr(serial, "NSEC3") != NULL, "parse sequentially");
+
+	char *parallel = load_dump(path, THREADS, CHUNK_MIN);
+	ok(parallel != NULL, "parse in parallel chunks");
+	ok(serial != NULL && parallel != NULL && strcmp(serial, parallel) == 0,
+	   "parallel parsing gives the same contents");
+	free(parallel);
+
+	parallel = load_dump(path, THREADS - 1, 1);
+	ok(serial != NULL && parallel != NULL && strcmp(serial, parallel) == 0,
+	   "parsing in odd number of chunks gives the same contents");
+	free(parallel);
+
+	char *unsplit = load_dump(path, THREADS, SIZE_MAX);
+	ok(serial != NULL && unsplit != NULL && strcmp(serial, unsplit) == 0,
+	   "chunk threshold above the file size");
+	free(unsplit);
+	free(serial);
+
+	test_rm_rf(temp_dir);
+	free(temp_dir);
+
+	return 0;
+}
@@ -73,6 +73,75 @@ static void test_hashing(void)
 	dnssec_binary_free(&hash);
 }
 
+static bool check_many(const dnssec_binary_t *names, size_t count,
+                       const dnssec_nsec3_params_t *params)
+{
+	uint8_t hashes[count * 20 + 1];
+	hashes[count * 20] = 0xaa;
+	if (dnssec_nsec3_hash_many(names, count, params, hashes) != DNSSEC_EOK ||
+	    hashes[count * 20] != 0xaa) {
+		return false;
+	}
+
+	bool match = true;
+	for (size_t i = 0; i < count && match; i++) {
+		dnssec_binary_t hash = { 0 };
+		match = dnssec_nsec3_hash(&names[i], params, &hash) == DNSSEC_EOK &&
+		        memcmp(hash.data, hashes + i * 20, 20) == 0;
+		dnssec_binary_free(&hash);
+	}
+
+	return match;
+}
+
+static void test_hashing_many(void)
+{
+	// Names of various lengths, crossing the SHA-1 block boundaries.
+	const size_t count = 40;
+	uint8_t storage[count][256];
+	dnssec_binary_t names[count];
+	for (size_t i = 0; i < count; i++) {
+		names[i].size = 1 + (i * 37) % 255;
+		names[i].data = storage[i];
+		for (size_t j = 0; j < names[i].size; j++) {
+			storage[i][j] = i + j;
+		}
+	}
+
+	uint8_t salt[255];
+	memset(salt, 0x5a, sizeof(salt));
+
+	const size_t counts[] = { 1, 5, 8, 17, 40 };
+	const uint16_t iterations[] = { 0, 1, 7 };
+	const size_t salt_sizes[] = { 0, 14, 255 };
+
+	bool match = true;
+	for (int s = 0; s < 3; s++) {
+		for (int it = 0; it < 3; it++) {
+			dnssec_nsec3_params_t params = {
+				.algorithm = DNSSEC_NSEC3_ALGORITHM_SHA1,
+				.iterations = iterations[it],
+				.salt = { .size = salt_sizes[s], .data = salt }
+			};
+			for (int c = 0; c < 5; c++) {
+				match &= check_many(names, counts[c], &params);
+			}
+		}
+	}
+	ok(match, "dnssec_nsec3_hash_many() matches dnssec_nsec3_hash()");
+
+	const dnssec_nsec3_params_t params = {
+		.algorithm = DNSSEC_NSEC3_ALGORITHM_SHA1,
+	};
+	uint8_t hash[20];
+	ok(dnssec_nsec3_hash_many(names, 0, &params, hash) == DNSSEC_EOK,
+	   "dnssec_nsec3_hash_many() no data");
+
+	const dnssec_nsec3_params_t unknown = { .algorithm = 0 };
+	ok(dnssec_nsec3_hash_many(names, 1, &unknown, hash) == DNSSEC_INVALID_NSEC3_ALGORITHM,
+	   "dnssec_nsec3_hash_many() unknown algorithm");
+}
+
 static void test_clear(void)
 {
 	const dnssec_nsec3_params_t empty = { 0 };
@@ -97,6 +166,7 @@ int main(void)
 	test_length();
 	test_parsing();
 	test_hashing();
+	test_hashing_many();
 	test_clear();
 
 	return 0;
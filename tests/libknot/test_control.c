@@ -13,6 +13,14 @@
 #define CTL_BUFF_SIZE	18
 #include "libknot/control/control.c"
 
+// Data unit with this command means a binary unit in this test!
+#define BIN_MARK	"\x01"
+
+static const uint8_t bin_data[] = {
+	0x00, 0x01, 0x02, 0x00, 'b', 'i', 'n', 0x00,
+	0xff, 0xfe, 0x00, 0x00, 0x10, 0x20, 0x30, 0x40
+};
+
 #define fake_ok(condition, msg, ...) \
 	if (!(condition)) { \
 		if (msg != NULL) { \
@@ -44,6 +52,10 @@ static void ctl_client(const char *socket, size_t argc, knot_ctl_data_t *argv)
 			    argv[i][KNOT_CTL_IDX_CMD][0] == '\0') {
 				ret = knot_ctl_send(ctl, KNOT_CTL_TYPE_BLOCK, NULL);
 				fake_ok(ret == KNOT_EOK, "Client send data block end type");
+			} else if (argv[i][KNOT_CTL_IDX_CMD] != NULL &&
+			           strcmp(argv[i][KNOT_CTL_IDX_CMD], BIN_MARK) == 0) {
+				ret = knot_ctl_send_bin(ctl, bin_data, sizeof(bin_data));
+				fake_ok(ret == KNOT_EOK, "Client send binary data");
 			} else {
 				ret = knot_ctl_send(ctl, KNOT_CTL_TYPE_DATA, &argv[i]);
 				fake_ok(ret == KNOT_EOK, "Client send data %zu", i);
@@ -67,6 +79,13 @@ static void ctl_client(const char *socket, size_t argc, knot_ctl_data_t *argv)
 		if (argv[count][KNOT_CTL_IDX_CMD] != NULL &&
 		    argv[count][KNOT_CTL_IDX_CMD][0] == '\0') {
 			fake_ok(type == KNOT_CTL_TYPE_BLOCK, "Receive block end type");
+		} else if (argv[count][KNOT_CTL_IDX_CMD] != NULL &&
+		           strcmp(argv[count][KNOT_CTL_IDX_CMD], BIN_MARK) == 0) {
+			fake_ok(type == KNOT_CTL_TYPE_BIN, "Check binary type");
+			size_t len;
+			const uint8_t *bin = knot_ctl_bin(ctl, &len);
+			fake_ok(bin != NULL && len == sizeof(bin_data) &&
+			        memcmp(bin, bin_data, len) == 0, "Client compare binary data");
 		} else {
 			fake_ok(type == KNOT_CTL_TYPE_DATA, "Check data type");
 			for (size_t i = 0; i < KNOT_CTL_IDX__COUNT; i++) {
@@ -116,6 +135,13 @@ static void ctl_server(const char *socket, size_t argc, knot_ctl_data_t *argv)
 		if (argv[count][KNOT_CTL_IDX_CMD] != NULL &&
 		    argv[count][KNOT_CTL_IDX_CMD][0] == '\0') {
 			ok(type == KNOT_CTL_TYPE_BLOCK, "Receive block end type");
+		} else if (argv[count][KNOT_CTL_IDX_CMD] != NULL &&
+		           strcmp(argv[count][KNOT_CTL_IDX_CMD], BIN_MARK) == 0) {
+			ok(type == KNOT_CTL_TYPE_BIN, "Check binary type");
+			size_t len;
+			const uint8_t *bin = knot_ctl_bin(ctl, &len);
+			ok(bin != NULL && len == sizeof(bin_data) &&
+			   memcmp(bin, bin_data, len) == 0, "Server compare binary data");
 		} else {
 			ok(type == KNOT_CTL_TYPE_DATA, "Check data type");
 			for (size_t i = 0; i < KNOT_CTL_IDX__COUNT; i++) {
@@ -145,6 +171,10 @@ static void ctl_server(const char *socket, size_t argc, knot_ctl_data_t *argv)
 			    argv[i][KNOT_CTL_IDX_CMD][0] == '\0') {
 				ret = knot_ctl_send(ctl, KNOT_CTL_TYPE_BLOCK, NULL);
 				is_int(KNOT_EOK, ret, "Client send data block end type");
+			} else if (argv[i][KNOT_CTL_IDX_CMD] != NULL &&
+			           strcmp(argv[i][KNOT_CTL_IDX_CMD], BIN_MARK) == 0) {
+				ret = knot_ctl_send_bin(ctl, bin_data, sizeof(bin_data));
+				is_int(KNOT_EOK, ret, "Server send binary data");
 			} else {
 				ret = knot_ctl_send(ctl, KNOT_CTL_TYPE_DATA, &argv[i]);
 				is_int(KNOT_EOK, ret, "Server send data %zu", i);
@@ -167,11 +197,13 @@ static void test_client_server_client(void)
 	char *socket = test_mktemp();
 	ok(socket != NULL, "Make a temporary socket file '%s'", socket);
 
-	size_t data_len = 5;
+	size_t data_len = 7;
 	knot_ctl_data_t data[] = {
 		{ "command", "error", "section", "item", "identifier",
 		  "zone", "owner", "ttl", "type", "data" },
 		{ [KNOT_CTL_IDX_DATA] = "\x01\x02" },
+		{ [KNOT_CTL_IDX_CMD] = BIN_MARK },
+		{ [KNOT_CTL_IDX_CMD] = BIN_MARK },
 		{ [KNOT_CTL_IDX_CMD] = "\0" }, // This means block end in this test!
 		{ NULL },
 		{ [KNOT_CTL_IDX_ERROR] = "Ultra long message" }
@@ -199,10 +231,31 @@ static void test_client_server_client(void)
 	free(socket);
 }
 
+static void test_bin_limits(void)
+{
+	knot_ctl_t *ctl = knot_ctl_alloc();
+	ok(ctl != NULL, "Allocate control");
+
+	int ret = knot_ctl_send(ctl, KNOT_CTL_TYPE_BIN, NULL);
+	is_int(KNOT_EINVAL, ret, "Binary unit without payload");
+
+	uint8_t buff[CTL_BUFF_SIZE + 1] = { 0 };
+	ret = knot_ctl_send_bin(ctl, buff, sizeof(buff));
+	is_int(KNOT_ERANGE, ret, "Too long binary unit");
+
+	size_t len = 1;
+	ok(knot_ctl_bin(ctl, &len) == NULL && len == 0, "No binary unit received");
+
+	knot_ctl_free(ctl);
+}
+
 int main(int argc, char *argv[])
 {
 	plan_lazy();
 
+	diag("Binary unit limits");
+	test_bin_limits();
+
 	diag("Client -> Server -> Client");
 	test_client_server_client();
 
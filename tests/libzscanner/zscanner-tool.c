@@ -35,6 +35,7 @@ static void help(void)
 	       "     2        Test output.\n"
 	       " -b <num>     Divide hex string to blocks of length <num>.\n"
 	       " -s           State parsing mode.\n"
+	       " -c <num>     Parse the input split into <num> chunks.\n"
 	       " -t           Launch unit tests.\n"
 	       " -h           Print this help.\n");
 }
@@ -127,15 +128,57 @@ static int include(zs_scanner_t *s)
 	return ret;
 }
 
+static int chunk_parsing(zs_scanner_t *s, size_t count)
+{
+	zs_chunk_t *chunks = malloc(count * sizeof(zs_chunk_t));
+	if (chunks == NULL) {
+		s->error.code = ZS_ENOMEM;
+		return -1;
+	}
+
+	if (zs_split_input(s, chunks, &count) != 0) {
+		free(chunks);
+		return -1;
+	}
+
+	int ret = 0;
+	for (size_t i = 0; i < count; i++) {
+		zs_scanner_t *ss = malloc(sizeof(zs_scanner_t));
+		if (ss == NULL) {
+			s->error.code = ZS_ENOMEM;
+			ret = -1;
+			break;
+		}
+
+		if (zs_init(ss, NULL, s->default_class, s->default_ttl) != 0 ||
+		    zs_set_input_chunk(ss, &chunks[i]) != 0 ||
+		    zs_set_processing(ss, s->process.record, s->process.error,
+		                      s->process.data) != 0 ||
+		    zs_parse_all(ss) != 0) {
+			s->error.counter += ss->error.counter;
+			s->error.code = ss->error.code;
+			ret = -1;
+		}
+
+		zs_deinit(ss);
+		free(ss);
+	}
+
+	free(chunks);
+
+	return ret;
+}
+
 int main(int argc, char *argv[])
 {
-	int mode = DEFAULT_MODE, block = 0, state = 0, test = 0;
+	int mode = DEFAULT_MODE, block = 0, state = 0, test = 0, chunks = 0;
 
 	// Command line long options.
 	struct option opts[] = {
 		{ "mode",  required_argument, NULL, 'm' },
 		{ "block", required_argument, NULL, 'b' },
 		{ "state", no_argument,       NULL, 's' },
+		{ "chunks", required_argument, NULL, 'c' },
 		{ "test",  no_argument,       NULL, 't' },
 		{ "help",  no_argument,       NULL, 'h' },
 		{ NULL }
@@ -143,7 +186,7 @@ int main(int argc, char *argv[])
 
 	// Parsed command line arguments.
 	int opt = 0, li = 0;
-	while ((opt = getopt_long(argc, argv, "m:b:sth", opts, &li)) != -1) {
+	while ((opt = getopt_long(argc, argv, "m:b:sc:th", opts, &li)) != -1) {
 		switch (opt) {
 		case 'm':
 			mode = atoi(optarg);
@@ -154,6 +197,9 @@ int main(int argc, char *argv[])
 		case 's':
 			state = 1;
 			break;
+		case 'c':
+			chunks = atoi(optarg);
+			break;
 		case 't':
 			test = 1;
 			break;
@@ -221,7 +267,11 @@ int main(int argc, char *argv[])
 	}
 
 	// Parse the file.
-	ret = state ? state_parsing(s) : zs_parse_all(s);
+	if (chunks > 1) {
+		ret = chunk_parsing(s, chunks);
+	} else {
+		ret = state ? state_parsing(s) : zs_parse_all(s);
+	}
 	if (ret == 0) {
 		if (mode == DEFAULT_MODE) {
 			printf("Zone file has been processed successfully\n");
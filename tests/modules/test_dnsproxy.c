@@ -0,0 +1,243 @@
+/*  Copyright (C) CZ.NIC, z.s.p.o. and contributors
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  For more information, see <https://www.knot-dns.cz/>
+ */
+
+#include <tap/basic.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "knot/modules/dnsproxy/fwd.c"
+#include "knot/test_server.h"
+
+#define TIMEOUT_MS	200
+
+typedef struct {
+	int upstream[2];                  // Upstream servers.
+	int server;                       // Worker socket.
+	int client;
+	struct sockaddr_storage server_addr;
+	struct sockaddr_storage client_addr;
+	knotd_conf_val_t remote_vals[2];
+	knotd_conf_t remote;
+	knotd_conf_t via;
+	knotd_qdata_params_t params;
+	knot_pkt_t *query;
+	knotd_qdata_t qdata;
+} env_t;
+
+/*! \brief Receive a message, return its size or -1 if nothing came in time. */
+static ssize_t recv_wait(int fd, uint8_t *buf, size_t size, int timeout_ms,
+                         struct sockaddr_storage *from)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	if (poll(&pfd, 1, timeout_ms) != 1) {
+		return -1;
+	}
+	socklen_t len = sizeof(*from);
+	return recvfrom(fd, buf, size, 0, (struct sockaddr *)from, &len);
+}
+
+static bool env_init(env_t *env)
+{
+	memset(env, 0, sizeof(*env));
+	for (int i = 0; i < 2; i++) {
+		env->upstream[i] = udp_socket(&env->remote_vals[i].addr);
+	}
+	env->server = udp_socket(&env->server_addr);
+	env->client = udp_socket(&env->client_addr);
+	env->remote.multi = env->remote_vals;
+	env->remote.count = 2;
+
+	env->params.proto = KNOTD_QUERY_PROTO_UDP;
+	env->params.remote = &env->client_addr;
+	env->params.local = &env->server_addr;
+	env->params.socket = env->server;
+
+	env->query = knot_pkt_new(NULL, KNOT_WIRE_MAX_PKTSIZE, NULL);
+	if (env->query == NULL ||
+	    knot_pkt_put_question(env->query, (const uint8_t *)"\x07""example""\x03""com",
+	                          KNOT_CLASS_IN, KNOT_RRTYPE_A) != KNOT_EOK) {
+		return false;
+	}
+	env->qdata.query = env->query;
+	env->qdata.params = &env->params;
+
+	return env->upstream[0] >= 0 && env->upstream[1] >= 0 &&
+	       env->server >= 0 && env->client >= 0;
+}
+
+static void env_deinit(env_t *env)
+{
+	knot_pkt_free(env->query);
+	close(env->upstream[0]);
+	close(env->upstream[1]);
+	close(env->server);
+	close(env->client);
+}
+
+/*! \brief Forward a query and let the upstream answer it, return the upstream ID. */
+static int roundtrip(fwd_engine_t *engine, env_t *env, uint16_t client_id,
+                     in_port_t *port)
+{
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	struct sockaddr_storage from;
+
+	knot_wire_set_id(env->query->wire, client_id);
+	if (fwd_engine_query(engine, &env->qdata) != KNOT_EOK) {
+		return -1;
+	}
+	ssize_t len = recv_wait(env->upstream[0], buf, sizeof(buf), 1000, &from);
+	if (len != env->query->size) {
+		return -1;
+	}
+	uint16_t id = knot_wire_get_id(buf);
+	*port = ((struct sockaddr_in *)&from)->sin_port;
+
+	knot_wire_set_qr(buf);
+	if (sendto(env->upstream[0], buf, len, 0, (struct sockaddr *)&from,
+	           sockaddr_len(&from)) != len) {
+		return -1;
+	}
+	len = recv_wait(env->client, buf, sizeof(buf), 1000, &from);
+	if (len != env->query->size || knot_wire_get_id(buf) != client_id ||
+	    !knot_wire_get_qr(buf)) {
+		return -1;
+	}
+
+	return id;
+}
+
+static void test_forward(env_t *env)
+{
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	struct sockaddr_storage from;
+
+	fwd_engine_t *engine = fwd_engine_new(NULL, &env->remote, &env->via, 5000, 1);
+	ok(engine != NULL, "forward: create engine");
+
+	knot_wire_set_id(env->query->wire, 0x1234);
+	ok(fwd_engine_query(engine, &env->qdata) == KNOT_EOK, "forward: query sent");
+	ssize_t len = recv_wait(env->upstream[0], buf, sizeof(buf), 1000, &from);
+	ok(len == env->query->size &&
+	   memcmp(buf + 2, env->query->wire + 2, len - 2) == 0,
+	   "forward: upstream got the query");
+
+	/* Responses with a wrong ID or a wrong question are dropped. */
+	knot_wire_set_qr(buf);
+	knot_wire_set_id(buf, knot_wire_get_id(buf) ^ 1);
+	(void)sendto(env->upstream[0], buf, len, 0, (struct sockaddr *)&from, sockaddr_len(&from));
+	knot_wire_set_id(buf, knot_wire_get_id(buf) ^ 1);
+	buf[KNOT_WIRE_HEADER_SIZE + 1] ^= 0x20;
+	(void)sendto(env->upstream[0], buf, len, 0, (struct sockaddr *)&from, sockaddr_len(&from));
+	buf[KNOT_WIRE_HEADER_SIZE + 1] ^= 0x20;
+	ok(recv_wait(env->client, buf + len, sizeof(buf) - len, 100, &from) < 0,
+	   "forward: spoofed responses dropped");
+
+	(void)sendto(env->upstream[0], buf, len, 0, (struct sockaddr *)&from, sockaddr_len(&from));
+	len = recv_wait(env->client, buf, sizeof(buf), 1000, &from);
+	ok(len == env->query->size && knot_wire_get_id(buf) == 0x1234 &&
+	   sockaddr_cmp(&from, &env->server_addr, false) == 0,
+	   "forward: response relayed to the client");
+
+	/* The whole ID is random, the source port changes. */
+	uint16_t id_bits = 0, first_id = 0;
+	in_port_t first_port = 0;
+	bool port_changed = false, valid = true;
+	for (int i = 0; i < 4 * FWD_SOCK_QUERIES; i++) {
+		in_port_t port;
+		int id = roundtrip(engine, env, i, &port);
+		if (id < 0) {
+			valid = false;
+			break;
+		}
+		if (i == 0) {
+			first_id = id;
+			first_port = port;
+		}
+		id_bits |= id ^ first_id;
+		port_changed |= (port != first_port);
+		if (i % 16 == 0) {
+			usleep(2 * FWD_POLL_MS * 1000);
+		}
+	}
+	ok(valid, "forward: queries relayed");
+	ok((id_bits & (FWD_SLOTS - 1)) != 0 && (id_bits & ~(FWD_SLOTS - 1)) != 0,
+	   "forward: random upstream IDs");
+	ok(port_changed, "forward: upstream sockets rotated");
+
+	/* Non-UDP queries aren't handled. */
+	env->params.proto = KNOTD_QUERY_PROTO_TCP;
+	ok(fwd_engine_query(engine, &env->qdata) == KNOT_ENOTSUP, "forward: TCP not supported");
+	env->params.proto = KNOTD_QUERY_PROTO_UDP;
+
+	fwd_engine_free(engine);
+}
+
+static void test_timeout(env_t *env)
+{
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	struct sockaddr_storage from;
+
+	fwd_engine_t *engine = fwd_engine_new(NULL, &env->remote, &env->via, TIMEOUT_MS, 1);
+	ok(engine != NULL, "timeout: create engine");
+
+	/* The first upstream doesn't answer, the second one does. */
+	knot_wire_set_id(env->query->wire, 0x4321);
+	ok(fwd_engine_query(engine, &env->qdata) == KNOT_EOK, "timeout: query sent");
+	ssize_t len = recv_wait(env->upstream[0], buf, sizeof(buf), 1000, &from);
+	ok(len == env->query->size, "timeout: first upstream got the query");
+	len = recv_wait(env->upstream[1], buf, sizeof(buf), 2 * TIMEOUT_MS + 1000, &from);
+	ok(len == env->query->size, "timeout: query retried on the second upstream");
+	knot_wire_set_qr(buf);
+	(void)sendto(env->upstream[1], buf, len, 0, (struct sockaddr *)&from, sockaddr_len(&from));
+	len = recv_wait(env->client, buf, sizeof(buf), 1000, &from);
+	ok(len == env->query->size && knot_wire_get_id(buf) == 0x4321 &&
+	   knot_wire_get_rcode(buf) == KNOT_RCODE_NOERROR,
+	   "timeout: response from the second upstream relayed");
+
+	/* No upstream answers. */
+	ok(fwd_engine_query(engine, &env->qdata) == KNOT_EOK, "timeout: query sent");
+	len = recv_wait(env->client, buf, sizeof(buf), 3 * TIMEOUT_MS + 1000, &from);
+	ok(len > KNOT_WIRE_HEADER_SIZE && knot_wire_get_id(buf) == 0x4321 &&
+	   knot_wire_get_rcode(buf) == KNOT_RCODE_SERVFAIL,
+	   "timeout: SERVFAIL if no upstream answers");
+
+	fwd_engine_free(engine);
+}
+
+static void test_limit(env_t *env)
+{
+	fwd_engine_t *engine = fwd_engine_new(NULL, &env->remote, &env->via, 60000, 1);
+	ok(engine != NULL, "limit: create engine");
+
+	int ret = KNOT_EOK;
+	for (int i = 0; i < FWD_SLOTS && ret == KNOT_EOK; i++) {
+		ret = fwd_engine_query(engine, &env->qdata);
+	}
+	ok(ret == KNOT_EOK, "limit: table filled");
+	ok(fwd_engine_query(engine, &env->qdata) == KNOT_ELIMIT, "limit: table full");
+
+	fwd_engine_free(engine);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	env_t env;
+	if (!env_init(&env)) {
+		skip_all("no loopback UDP sockets");
+		return 0;
+	}
+
+	test_forward(&env);
+	test_timeout(&env);
+	test_limit(&env);
+
+	env_deinit(&env);
+
+	return 0;
+}
@@ -7,9 +7,11 @@
 #include <assert.h>
 
 #include "knot/modules/onlinesign/nsec_next.h"
+#include "knot/modules/onlinesign/rrsig_cache.h"
 #include "libknot/consts.h"
 #include "libknot/dname.h"
 #include "libknot/errcode.h"
+#include "libknot/rrset.h"
 
 /*!
  * \brief Assert that a domain name in a static buffer is valid.
@@ -47,10 +49,69 @@ static void _test_nsec_next(const char *msg,
 	_test_nsec_next(msg, input, apex, expected); \
 }
 
+static void test_rrsig_cache(void)
+{
+	rrsig_cache_t *cache = rrsig_cache_new(3);
+	ok(cache != NULL, "rrsig_cache: create");
+
+	const knot_dname_t *owner = (const knot_dname_t *)"\x03""www""\x07""example""\x03""com";
+	const knot_dname_t *other = (const knot_dname_t *)"\x03""ftp""\x07""example""\x03""com";
+	const uint8_t addr1[] = { 192, 0, 2, 1 };
+	const uint8_t addr2[] = { 192, 0, 2, 2 };
+	const uint8_t sig[] = "fake rrsig";
+
+	knot_rrset_t *cover = knot_rrset_new(owner, KNOT_RRTYPE_A, KNOT_CLASS_IN, 3600, NULL);
+	knot_rrset_t *rrsig = knot_rrset_new(owner, KNOT_RRTYPE_RRSIG, KNOT_CLASS_IN, 3600, NULL);
+	assert(cover && rrsig);
+	int ret = knot_rrset_add_rdata(cover, addr1, sizeof(addr1), NULL);
+	ret |= knot_rrset_add_rdata(rrsig, sig, sizeof(sig), NULL);
+	assert(ret == KNOT_EOK);
+
+	knot_rdataset_t out = { 0 };
+	ret = rrsig_cache_get(cache, owner, cover, 1, 100, &out, NULL);
+	ok(ret == KNOT_ENOENT, "rrsig_cache: empty miss");
+
+	ret = rrsig_cache_put(cache, owner, cover, 1, 200, &rrsig->rrs);
+	ok(ret == KNOT_EOK, "rrsig_cache: put");
+
+	ret = rrsig_cache_get(cache, owner, cover, 1, 100, &out, NULL);
+	ok(ret == KNOT_EOK && knot_rdataset_eq(&out, &rrsig->rrs), "rrsig_cache: hit");
+	knot_rdataset_clear(&out, NULL);
+
+	ret = rrsig_cache_get(cache, other, cover, 1, 100, &out, NULL);
+	ok(ret == KNOT_ENOENT, "rrsig_cache: other owner miss");
+
+	ret = rrsig_cache_get(cache, owner, cover, 2, 100, &out, NULL);
+	ok(ret == KNOT_ENOENT, "rrsig_cache: new generation miss");
+
+	cover->ttl = 60;
+	ret = rrsig_cache_get(cache, owner, cover, 1, 100, &out, NULL);
+	ok(ret == KNOT_ENOENT, "rrsig_cache: other TTL miss");
+	cover->ttl = 3600;
+
+	ret = knot_rrset_add_rdata(cover, addr2, sizeof(addr2), NULL);
+	assert(ret == KNOT_EOK);
+	ret = rrsig_cache_get(cache, owner, cover, 1, 100, &out, NULL);
+	ok(ret == KNOT_ENOENT, "rrsig_cache: other rdata miss");
+	ret = rrsig_cache_put(cache, owner, cover, 1, 200, &rrsig->rrs);
+	ok(ret == KNOT_EOK, "rrsig_cache: put other rdata");
+
+	ret = rrsig_cache_get(cache, owner, cover, 1, 200, &out, NULL);
+	ok(ret == KNOT_ENOENT, "rrsig_cache: expired miss");
+	ret = rrsig_cache_get(cache, owner, cover, 1, 100, &out, NULL);
+	ok(ret == KNOT_ENOENT, "rrsig_cache: expired entry dropped");
+
+	knot_rrset_free(cover, NULL);
+	knot_rrset_free(rrsig, NULL);
+	rrsig_cache_free(cache);
+}
+
 int main(int argc, char *argv[])
 {
 	plan_lazy();
 
+	test_rrsig_cache();
+
 	// adding a single zero-byte label
 
 	test_nsec_next(